@@ -0,0 +1,285 @@
+#include "AssetCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using namespace Engine::Core;
+
+namespace
+{
+    const uint32_t ENTRY_MAGIC = 0x4341584C;   // "LXAC"
+    const uint32_t ENTRY_VERSION = 1;
+
+    struct EntryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint64_t payloadSize;
+        uint64_t payloadHash;
+    };
+
+    struct IndexEntry
+    {
+        uint64_t size = 0;          // file size, header included
+        uint64_t lastAccess = 0;    // ordering only, larger is newer
+        uint64_t generation = 0;    // bumped by every Store, tells a reader the file was replaced
+    };
+
+    std::mutex s_mutex;
+    bool s_enabled = false;
+    std::filesystem::path s_directory;
+    uint64_t s_maxBytes = 0;
+    uint64_t s_accessCounter = 0;
+    uint64_t s_generationCounter = 0;
+    std::unordered_map<uint64_t, IndexEntry> s_index;
+    AssetCacheStats s_stats;
+    std::atomic<uint32_t> s_tempCounter{ 0 };
+
+    std::filesystem::path EntryPath(uint64_t key)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return s_directory / name;
+    }
+
+    uint64_t HashPayload(const void* data, size_t size)
+    {
+        return ContentHash().Append(data, size).Get();
+    }
+
+    void RemoveEntryLocked(uint64_t key)
+    {
+        auto it = s_index.find(key);
+        if (it == s_index.end())
+            return;
+
+        std::error_code ec;
+        std::filesystem::remove(EntryPath(key), ec);
+        s_stats.totalBytes -= it->second.size;
+        s_index.erase(it);
+    }
+
+    void EvictLocked(uint64_t keep)
+    {
+        if (s_stats.totalBytes <= s_maxBytes)
+            return;
+
+        std::vector<std::pair<uint64_t, uint64_t>> order;   // lastAccess, key
+        order.reserve(s_index.size());
+        for (const auto& [key, entry] : s_index)
+            order.push_back({ entry.lastAccess, key });
+        std::sort(order.begin(), order.end());
+
+        for (const auto& [access, key] : order)
+        {
+            if (s_stats.totalBytes <= s_maxBytes)
+                break;
+            if (key == keep)
+                continue;
+
+            RemoveEntryLocked(key);
+            s_stats.evictions++;
+        }
+    }
+}
+
+bool AssetCache::Initialize(const std::filesystem::path& directory, uint64_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (!std::filesystem::is_directory(directory, ec))
+        return false;
+
+    s_directory = directory;
+    s_maxBytes = maxBytes;
+    s_index.clear();
+    s_stats = AssetCacheStats{};
+
+    // Rebuild the index from disk. Modification times carry the LRU order
+    // across runs (reads touch them), temp files are leftovers of a crash.
+    std::vector<std::pair<std::filesystem::file_time_type, uint64_t>> found;
+    for (const auto& item : std::filesystem::directory_iterator(directory, ec))
+    {
+        const std::filesystem::path& path = item.path();
+        if (path.extension() == ".tmp")
+        {
+            std::filesystem::remove(path, ec);
+            continue;
+        }
+        if (path.extension() != ".bin")
+            continue;
+
+        std::string stem = path.stem().string();
+        char* end = nullptr;
+        uint64_t key = strtoull(stem.c_str(), &end, 16);
+        if (stem.size() != 16 || *end != '\0')
+            continue;
+
+        IndexEntry entry;
+        entry.size = item.file_size(ec);
+        entry.generation = ++s_generationCounter;
+        s_index[key] = entry;
+        s_stats.totalBytes += entry.size;
+        found.push_back({ item.last_write_time(ec), key });
+    }
+
+    std::sort(found.begin(), found.end());
+    for (const auto& [time, key] : found)
+        s_index[key].lastAccess = ++s_accessCounter;
+
+    s_enabled = true;
+    EvictLocked(0);
+    return true;
+}
+
+void AssetCache::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_enabled = false;
+    s_index.clear();
+}
+
+bool AssetCache::IsEnabled()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_enabled;
+}
+
+bool AssetCache::Load(uint64_t key, std::vector<uint8_t>& out)
+{
+    std::filesystem::path path;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (!s_enabled)
+            return false;
+
+        auto it = s_index.find(key);
+        if (it == s_index.end())
+        {
+            s_stats.misses++;
+            return false;
+        }
+        path = EntryPath(key);
+        generation = it->second.generation;
+    }
+
+    // -----------------------------
+    // Read + integrity check outside the lock
+    // -----------------------------
+    bool valid = false;
+    {
+        // The payload must fill the rest of the file exactly, so a damaged size
+        // field cannot make us allocate more than is on disk
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(path, ec);
+
+        std::ifstream file(path, std::ios::binary);
+        EntryHeader header = {};
+        if (!ec && fileSize >= sizeof(header) && file && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            header.magic == ENTRY_MAGIC && header.version == ENTRY_VERSION && header.key == key &&
+            header.payloadSize == fileSize - sizeof(header))
+        {
+            out.resize((size_t)header.payloadSize);
+            valid = file.read(reinterpret_cast<char*>(out.data()), (std::streamsize)out.size()) &&
+                file.peek() == std::char_traits<char>::eof() &&
+                HashPayload(out.data(), out.size()) == header.payloadHash;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!valid)
+    {
+        // A Store may have renamed a fresh file over the one we read, leave that alone
+        out.clear();
+        auto it = s_index.find(key);
+        if (it != s_index.end() && it->second.generation == generation)
+            RemoveEntryLocked(key);
+        s_stats.corrupt++;
+        s_stats.misses++;
+        return false;
+    }
+
+    auto it = s_index.find(key);
+    if (it != s_index.end())
+        it->second.lastAccess = ++s_accessCounter;
+    s_stats.hits++;
+
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return true;
+}
+
+bool AssetCache::Store(uint64_t key, const void* data, size_t size)
+{
+    std::filesystem::path finalPath;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (!s_enabled)
+            return false;
+        finalPath = EntryPath(key);
+
+        // Before the rename: a reader of the old file must not delete the new one
+        auto it = s_index.find(key);
+        if (it != s_index.end())
+            it->second.generation = ++s_generationCounter;
+    }
+
+    // Unique temp name per writer, then an atomic rename into place so readers
+    // never observe a partially written entry
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), ".%zx.%u.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()),
+        s_tempCounter.fetch_add(1));
+    std::filesystem::path tempPath = finalPath;
+    tempPath += suffix;
+
+    EntryHeader header = { ENTRY_MAGIC, ENTRY_VERSION, key, size, HashPayload(data, size) };
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(static_cast<const char*>(data), (std::streamsize)size);
+        if (!file.flush())
+        {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, finalPath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    IndexEntry& entry = s_index[key];
+    s_stats.totalBytes -= entry.size;
+    entry.size = sizeof(header) + size;
+    entry.lastAccess = ++s_accessCounter;
+    entry.generation = ++s_generationCounter;
+    s_stats.totalBytes += entry.size;
+    s_stats.stores++;
+
+    EvictLocked(key);
+    return true;
+}
+
+AssetCacheStats AssetCache::GetStats()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    AssetCacheStats stats = s_stats;
+    stats.entryCount = (uint32_t)s_index.size();
+    return stats;
+}
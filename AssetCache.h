@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Engine::Core
+{
+    // 64-bit FNV-1a, built up from everything that affects a cooked artifact
+    class ContentHash
+    {
+    public:
+        ContentHash& Append(const void* data, size_t size)
+        {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                m_hash ^= p[i];
+                m_hash *= 1099511628211ull;
+            }
+            return *this;
+        }
+
+        ContentHash& Append(std::string_view text)
+        {
+            // Length first so ("ab","c") and ("a","bc") differ
+            AppendValue((uint64_t)text.size());
+            return Append(text.data(), text.size());
+        }
+
+        ContentHash& Append(const std::vector<uint8_t>& bytes)
+        {
+            AppendValue((uint64_t)bytes.size());
+            return Append(bytes.data(), bytes.size());
+        }
+
+        template <typename T>
+        ContentHash& AppendValue(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "hash raw values only");
+            return Append(&value, sizeof(T));
+        }
+
+        uint64_t Get() const { return m_hash; }
+
+    private:
+        uint64_t m_hash = 14695981039346656037ull;
+    };
+
+    // Flat little-endian serialization for cache payloads
+    class BinaryWriter
+    {
+    public:
+        void Write(const void* data, size_t size)
+        {
+            if (size == 0)
+                return;
+            size_t offset = m_data.size();
+            m_data.resize(offset + size);
+            memcpy(m_data.data() + offset, data, size);
+        }
+
+        template <typename T>
+        void WriteValue(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "raw values only");
+            Write(&value, sizeof(T));
+        }
+
+        template <typename T>
+        void WriteVector(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "raw values only");
+            WriteValue((uint64_t)values.size());
+            Write(values.data(), values.size() * sizeof(T));
+        }
+
+        void WriteString(const std::string& text)
+        {
+            WriteValue((uint64_t)text.size());
+            Write(text.data(), text.size());
+        }
+
+        const std::vector<uint8_t>& GetData() const { return m_data; }
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const std::vector<uint8_t>& data) : m_data(data) {}
+
+        bool Read(void* out, size_t size)
+        {
+            if (m_pos + size > m_data.size())
+                return false;
+            memcpy(out, m_data.data() + m_pos, size);
+            m_pos += size;
+            return true;
+        }
+
+        template <typename T>
+        bool ReadValue(T& out)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "raw values only");
+            return Read(&out, sizeof(T));
+        }
+
+        template <typename T>
+        bool ReadVector(std::vector<T>& out)
+        {
+            uint64_t count = 0;
+            if (!ReadValue(count) || count > (m_data.size() - m_pos) / sizeof(T))
+                return false;
+            out.resize((size_t)count);
+            return Read(out.data(), (size_t)count * sizeof(T));
+        }
+
+        bool ReadString(std::string& out)
+        {
+            uint64_t count = 0;
+            if (!ReadValue(count) || count > m_data.size() - m_pos)
+                return false;
+            out.assign(reinterpret_cast<const char*>(m_data.data() + m_pos), (size_t)count);
+            m_pos += (size_t)count;
+            return true;
+        }
+
+        bool IsAtEnd() const { return m_pos == m_data.size(); }
+
+    private:
+        const std::vector<uint8_t>& m_data;
+        size_t m_pos = 0;
+    };
+
+    struct AssetCacheStats
+    {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t stores = 0;
+        uint32_t evictions = 0;
+        uint32_t corrupt = 0;       // failed the integrity check, deleted
+        uint64_t totalBytes = 0;
+        uint32_t entryCount = 0;
+    };
+
+    // Persistent, content-addressed store: key = hash of the source bytes plus
+    // importer version and settings, value = the cooked artifact. Writes go to a
+    // temp file and are renamed into place, every read is verified against the
+    // stored payload hash, and the directory is kept under a size cap by evicting
+    // the least recently used entries. Thread-safe; a no-op until initialized.
+    class AssetCache
+    {
+    public:
+        static const uint64_t DEFAULT_MAX_BYTES = 512ull * 1024 * 1024;
+
+        static bool Initialize(const std::filesystem::path& directory, uint64_t maxBytes = DEFAULT_MAX_BYTES);
+        static void Shutdown();
+        static bool IsEnabled();
+
+        static bool Load(uint64_t key, std::vector<uint8_t>& out);
+        static bool Store(uint64_t key, const void* data, size_t size);
+
+        static AssetCacheStats GetStats();
+    };
+
+} // namespace Engine::Core
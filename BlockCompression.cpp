@@ -0,0 +1,798 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+namespace
+{
+    // -----------------------------
+    // Shared helpers
+    // -----------------------------
+
+    // Principal axis of a point set (power iteration on the covariance matrix)
+    template <int N>
+    void PrincipalAxis(const float (*points)[4], int count, float* mean, float* axis)
+    {
+        for (int c = 0; c < N; ++c)
+        {
+            mean[c] = 0.0f;
+            for (int i = 0; i < count; ++i)
+                mean[c] += points[i][c];
+            mean[c] /= count;
+        }
+
+        float cov[N][N] = {};
+        for (int i = 0; i < count; ++i)
+        {
+            for (int a = 0; a < N; ++a)
+                for (int b = 0; b < N; ++b)
+                    cov[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+        }
+
+        // Start from the channel with the largest variance
+        int start = 0;
+        for (int c = 1; c < N; ++c)
+            if (cov[c][c] > cov[start][start])
+                start = c;
+
+        for (int c = 0; c < N; ++c)
+            axis[c] = cov[start][c];
+
+        for (int iter = 0; iter < 8; ++iter)
+        {
+            float next[N] = {};
+            for (int a = 0; a < N; ++a)
+                for (int b = 0; b < N; ++b)
+                    next[a] += cov[a][b] * axis[b];
+
+            float len = 0.0f;
+            for (int c = 0; c < N; ++c)
+                len += next[c] * next[c];
+            len = sqrtf(len);
+
+            if (len < 1e-6f)
+                break;
+            for (int c = 0; c < N; ++c)
+                axis[c] = next[c] / len;
+        }
+    }
+
+    inline int Clamp255(float v)
+    {
+        return std::clamp((int)(v + 0.5f), 0, 255);
+    }
+
+    // -----------------------------
+    // BC1 color
+    // -----------------------------
+    uint16_t Pack565(const int* c)
+    {
+        int r = (c[0] * 31 + 127) / 255;
+        int g = (c[1] * 63 + 127) / 255;
+        int b = (c[2] * 31 + 127) / 255;
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void Unpack565(uint16_t v, int* c)
+    {
+        int r = (v >> 11) & 31;
+        int g = (v >> 5) & 63;
+        int b = v & 31;
+        c[0] = (r << 3) | (r >> 2);
+        c[1] = (g << 2) | (g >> 4);
+        c[2] = (b << 3) | (b >> 2);
+    }
+
+    void BC1Palette(uint16_t c0, uint16_t c1, int palette[4][4], bool allowThreeColor)
+    {
+        Unpack565(c0, palette[0]);
+        Unpack565(c1, palette[1]);
+        palette[0][3] = palette[1][3] = 255;
+
+        if (c0 > c1 || !allowThreeColor)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+            }
+            palette[2][3] = palette[3][3] = 255;
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+            palette[2][3] = 255;
+            palette[3][3] = 0;
+        }
+    }
+
+    // Picks indices for fixed endpoints, returns squared RGB error
+    int BC1Indices(const float (*px)[4], uint16_t c0, uint16_t c1, uint8_t* indices)
+    {
+        int palette[4][4];
+        BC1Palette(c0, c1, palette, false);
+
+        int total = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            int bestErr = INT32_MAX;
+            for (int p = 0; p < 4; ++p)
+            {
+                int err = 0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    int d = (int)px[i][c] - palette[p][c];
+                    err += d * d;
+                }
+                if (err < bestErr)
+                {
+                    bestErr = err;
+                    best = p;
+                }
+            }
+            indices[i] = (uint8_t)best;
+            total += bestErr;
+        }
+        return total;
+    }
+
+    void WriteBC1(uint16_t c0, uint16_t c1, const uint8_t* indices, uint8_t* out)
+    {
+        // Four color mode requires c0 > c1
+        uint8_t remapped[16];
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            static const uint8_t SWAP[4] = { 1, 0, 3, 2 };
+            for (int i = 0; i < 16; ++i)
+                remapped[i] = SWAP[indices[i]];
+        }
+        else if (c0 == c1)
+        {
+            memset(remapped, 0, sizeof(remapped));
+        }
+        else
+        {
+            memcpy(remapped, indices, sizeof(remapped));
+        }
+
+        out[0] = (uint8_t)(c0 & 0xFF);
+        out[1] = (uint8_t)(c0 >> 8);
+        out[2] = (uint8_t)(c1 & 0xFF);
+        out[3] = (uint8_t)(c1 >> 8);
+
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; ++i)
+            bits |= (uint32_t)remapped[i] << (i * 2);
+        memcpy(out + 4, &bits, 4);
+    }
+
+    void EncodeBC1Color(const uint8_t* texels, uint8_t* out)
+    {
+        float px[16][4];
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < 4; ++c)
+                px[i][c] = texels[i * 4 + c];
+
+        float mean[3], axis[3];
+        PrincipalAxis<3>(px, 16, mean, axis);
+
+        float minT = 0.0f, maxT = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < 3; ++c)
+                t += (px[i][c] - mean[c]) * axis[c];
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        // Inset the extremes slightly, the interpolated colors cover the range better
+        float inset = (maxT - minT) / 16.0f;
+        int e0[3], e1[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            e0[c] = Clamp255(mean[c] + axis[c] * (maxT - inset));
+            e1[c] = Clamp255(mean[c] + axis[c] * (minT + inset));
+        }
+
+        uint16_t c0 = Pack565(e0);
+        uint16_t c1 = Pack565(e1);
+        uint8_t indices[16];
+        int err = BC1Indices(px, c0, c1, indices);
+
+        // One least-squares pass over the chosen indices
+        {
+            static const float WEIGHT0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+            float aa = 0, ab = 0, bb = 0;
+            float ax[3] = {}, bx[3] = {};
+            for (int i = 0; i < 16; ++i)
+            {
+                float a = WEIGHT0[indices[i]];
+                float b = 1.0f - a;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (int c = 0; c < 3; ++c)
+                {
+                    ax[c] += a * px[i][c];
+                    bx[c] += b * px[i][c];
+                }
+            }
+
+            float det = aa * bb - ab * ab;
+            if (fabsf(det) > 1e-6f)
+            {
+                int r0[3], r1[3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    r0[c] = Clamp255((ax[c] * bb - bx[c] * ab) / det);
+                    r1[c] = Clamp255((bx[c] * aa - ax[c] * ab) / det);
+                }
+
+                uint16_t n0 = Pack565(r0);
+                uint16_t n1 = Pack565(r1);
+                uint8_t refined[16];
+                int refinedErr = BC1Indices(px, n0, n1, refined);
+                if (refinedErr < err)
+                {
+                    c0 = n0;
+                    c1 = n1;
+                    memcpy(indices, refined, sizeof(indices));
+                }
+            }
+        }
+
+        WriteBC1(c0, c1, indices, out);
+    }
+
+    void DecodeBC1Color(const uint8_t* block, uint8_t* texels, bool allowThreeColor)
+    {
+        uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+        uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+
+        int palette[4][4];
+        BC1Palette(c0, c1, palette, allowThreeColor);
+
+        uint32_t bits;
+        memcpy(&bits, block + 4, 4);
+        for (int i = 0; i < 16; ++i)
+        {
+            const int* p = palette[(bits >> (i * 2)) & 3];
+            for (int c = 0; c < 4; ++c)
+                texels[i * 4 + c] = (uint8_t)p[c];
+        }
+    }
+
+    // -----------------------------
+    // BC4 single channel
+    // -----------------------------
+    void BC4Palette(int a0, int a1, int palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int i = 1; i < 7; ++i)
+                palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+        }
+        else
+        {
+            for (int i = 1; i < 5; ++i)
+                palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    int BC4Indices(const uint8_t* values, int a0, int a1, uint8_t* indices)
+    {
+        int palette[8];
+        BC4Palette(a0, a1, palette);
+
+        int total = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            int bestErr = INT32_MAX;
+            for (int p = 0; p < 8; ++p)
+            {
+                int d = values[i] - palette[p];
+                if (d * d < bestErr)
+                {
+                    bestErr = d * d;
+                    best = p;
+                }
+            }
+            indices[i] = (uint8_t)best;
+            total += bestErr;
+        }
+        return total;
+    }
+
+    void EncodeBC4(const uint8_t* values, uint8_t* out)
+    {
+        int lo = 255, hi = 0;
+        int innerLo = 255, innerHi = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            lo = std::min(lo, (int)values[i]);
+            hi = std::max(hi, (int)values[i]);
+            if (values[i] != 0 && values[i] != 255)
+            {
+                innerLo = std::min(innerLo, (int)values[i]);
+                innerHi = std::max(innerHi, (int)values[i]);
+            }
+        }
+
+        uint8_t indices[16];
+        int a0 = hi, a1 = lo;
+        int err = BC4Indices(values, a0, a1, indices);
+
+        // Six value mode keeps exact 0 and 255, which helps blocks with hard extremes
+        if (innerLo <= innerHi && (lo == 0 || hi == 255))
+        {
+            uint8_t alt[16];
+            int altErr = BC4Indices(values, innerLo, innerHi, alt);
+            if (altErr < err)
+            {
+                a0 = innerLo;
+                a1 = innerHi;
+                err = altErr;
+                memcpy(indices, alt, sizeof(indices));
+            }
+        }
+
+        // Equal endpoints select the six value mode, palette[0] still matches
+        out[0] = (uint8_t)a0;
+        out[1] = (uint8_t)a1;
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 16; ++i)
+            bits |= (uint64_t)indices[i] << (i * 3);
+        for (int i = 0; i < 6; ++i)
+            out[2 + i] = (uint8_t)(bits >> (i * 8));
+    }
+
+    void DecodeBC4(const uint8_t* block, uint8_t* values)
+    {
+        int palette[8];
+        BC4Palette(block[0], block[1], palette);
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 6; ++i)
+            bits |= (uint64_t)block[2 + i] << (i * 8);
+
+        for (int i = 0; i < 16; ++i)
+            values[i] = (uint8_t)palette[(bits >> (i * 3)) & 7];
+    }
+
+    // -----------------------------
+    // BC7 mode 6: one subset, RGBA 7.7.7.7 endpoints + p-bit, 4-bit indices
+    // -----------------------------
+    const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct BC7Endpoints
+    {
+        int c7[2][4];   // 7-bit components
+        int p[2];       // p-bits
+    };
+
+    void ExpandBC7(const BC7Endpoints& e, int out[2][4])
+    {
+        for (int k = 0; k < 2; ++k)
+            for (int c = 0; c < 4; ++c)
+                out[k][c] = (e.c7[k][c] << 1) | e.p[k];
+    }
+
+    int BC7Indices(const float (*px)[4], const BC7Endpoints& e, uint8_t* indices)
+    {
+        int ep[2][4];
+        ExpandBC7(e, ep);
+
+        int palette[16][4];
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < 4; ++c)
+                palette[i][c] = ((64 - BC7_WEIGHTS4[i]) * ep[0][c] + BC7_WEIGHTS4[i] * ep[1][c] + 32) >> 6;
+
+        int total = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            int bestErr = INT32_MAX;
+            for (int p = 0; p < 16; ++p)
+            {
+                int err = 0;
+                for (int c = 0; c < 4; ++c)
+                {
+                    int d = (int)px[i][c] - palette[p][c];
+                    err += d * d;
+                }
+                if (err < bestErr)
+                {
+                    bestErr = err;
+                    best = p;
+                }
+            }
+            indices[i] = (uint8_t)best;
+            total += bestErr;
+        }
+        return total;
+    }
+
+    // Quantizes both endpoints for all four p-bit combinations and keeps the best
+    int BC7Quantize(const float (*px)[4], const float e0[4], const float e1[4],
+        BC7Endpoints& best, uint8_t* bestIndices)
+    {
+        int bestErr = INT32_MAX;
+        for (int pbits = 0; pbits < 4; ++pbits)
+        {
+            BC7Endpoints e;
+            e.p[0] = pbits & 1;
+            e.p[1] = pbits >> 1;
+            for (int c = 0; c < 4; ++c)
+            {
+                e.c7[0][c] = std::clamp((int)((e0[c] - e.p[0]) * 0.5f + 0.5f), 0, 127);
+                e.c7[1][c] = std::clamp((int)((e1[c] - e.p[1]) * 0.5f + 0.5f), 0, 127);
+            }
+
+            uint8_t indices[16];
+            int err = BC7Indices(px, e, indices);
+            if (err < bestErr)
+            {
+                bestErr = err;
+                best = e;
+                memcpy(bestIndices, indices, 16);
+            }
+        }
+        return bestErr;
+    }
+
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8_t* out) : m_out(out) { memset(m_out, 0, 16); }
+
+        void Write(uint32_t value, int bits)
+        {
+            for (int i = 0; i < bits; ++i, ++m_pos)
+                m_out[m_pos >> 3] |= (uint8_t)(((value >> i) & 1) << (m_pos & 7));
+        }
+
+    private:
+        uint8_t* m_out;
+        int m_pos = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* in) : m_in(in) {}
+
+        uint32_t Read(int bits)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < bits; ++i, ++m_pos)
+                value |= (uint32_t)((m_in[m_pos >> 3] >> (m_pos & 7)) & 1) << i;
+            return value;
+        }
+
+    private:
+        const uint8_t* m_in;
+        int m_pos = 0;
+    };
+
+    void EncodeBC7(const uint8_t* texels, uint8_t* out)
+    {
+        float px[16][4];
+        for (int i = 0; i < 16; ++i)
+            for (int c = 0; c < 4; ++c)
+                px[i][c] = texels[i * 4 + c];
+
+        float mean[4], axis[4];
+        PrincipalAxis<4>(px, 16, mean, axis);
+
+        float minT = 0.0f, maxT = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < 4; ++c)
+                t += (px[i][c] - mean[c]) * axis[c];
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        float e0[4], e1[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            e0[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+            e1[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        }
+
+        BC7Endpoints endpoints;
+        uint8_t indices[16];
+        int err = BC7Quantize(px, e0, e1, endpoints, indices);
+
+        // Least-squares refit of the endpoints to the chosen weights
+        {
+            float aa = 0, ab = 0, bb = 0;
+            float ax[4] = {}, bx[4] = {};
+            for (int i = 0; i < 16; ++i)
+            {
+                float b = BC7_WEIGHTS4[indices[i]] / 64.0f;
+                float a = 1.0f - b;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (int c = 0; c < 4; ++c)
+                {
+                    ax[c] += a * px[i][c];
+                    bx[c] += b * px[i][c];
+                }
+            }
+
+            float det = aa * bb - ab * ab;
+            if (fabsf(det) > 1e-6f)
+            {
+                float r0[4], r1[4];
+                for (int c = 0; c < 4; ++c)
+                {
+                    r0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+                    r1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+                }
+
+                BC7Endpoints refined;
+                uint8_t refinedIndices[16];
+                if (BC7Quantize(px, r0, r1, refined, refinedIndices) < err)
+                {
+                    endpoints = refined;
+                    memcpy(indices, refinedIndices, sizeof(indices));
+                }
+            }
+        }
+
+        // The anchor index is stored without its top bit
+        if (indices[0] & 8)
+        {
+            for (int c = 0; c < 4; ++c)
+                std::swap(endpoints.c7[0][c], endpoints.c7[1][c]);
+            std::swap(endpoints.p[0], endpoints.p[1]);
+            for (int i = 0; i < 16; ++i)
+                indices[i] = (uint8_t)(15 - indices[i]);
+        }
+
+        BitWriter bw(out);
+        bw.Write(1 << 6, 7);
+        for (int c = 0; c < 4; ++c)
+        {
+            bw.Write((uint32_t)endpoints.c7[0][c], 7);
+            bw.Write((uint32_t)endpoints.c7[1][c], 7);
+        }
+        bw.Write((uint32_t)endpoints.p[0], 1);
+        bw.Write((uint32_t)endpoints.p[1], 1);
+        bw.Write(indices[0], 3);
+        for (int i = 1; i < 16; ++i)
+            bw.Write(indices[i], 4);
+    }
+
+    void DecodeBC7(const uint8_t* block, uint8_t* texels)
+    {
+        // Only mode 6 is produced by the encoder, anything else decodes as magenta
+        if ((block[0] & 0x7F) != (1 << 6))
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                texels[i * 4 + 0] = 255;
+                texels[i * 4 + 1] = 0;
+                texels[i * 4 + 2] = 255;
+                texels[i * 4 + 3] = 255;
+            }
+            return;
+        }
+
+        BitReader br(block);
+        br.Read(7);
+
+        BC7Endpoints e;
+        for (int c = 0; c < 4; ++c)
+        {
+            e.c7[0][c] = (int)br.Read(7);
+            e.c7[1][c] = (int)br.Read(7);
+        }
+        e.p[0] = (int)br.Read(1);
+        e.p[1] = (int)br.Read(1);
+
+        int ep[2][4];
+        ExpandBC7(e, ep);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            int index = (int)br.Read(i == 0 ? 3 : 4);
+            int w = BC7_WEIGHTS4[index];
+            for (int c = 0; c < 4; ++c)
+                texels[i * 4 + c] = (uint8_t)(((64 - w) * ep[0][c] + w * ep[1][c] + 32) >> 6);
+        }
+    }
+
+    void ExtractChannel(const uint8_t* texels, int channel, uint8_t* out)
+    {
+        for (int i = 0; i < 16; ++i)
+            out[i] = texels[i * 4 + channel];
+    }
+}
+
+uint32_t BlockCompression::GetBlockBytes(BlockFormat format)
+{
+    return (format == BlockFormat::BC1 || format == BlockFormat::BC4) ? 8 : 16;
+}
+
+size_t BlockCompression::GetSurfaceBytes(BlockFormat format, uint32_t width, uint32_t height)
+{
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+}
+
+uint32_t BlockCompression::GetDxgiFormat(BlockFormat format, bool srgb)
+{
+    // DXGI_FORMAT values, kept numeric so the cooker does not need the Windows SDK
+    switch (format)
+    {
+    case BlockFormat::BC1: return srgb ? 72 : 71;
+    case BlockFormat::BC3: return srgb ? 78 : 77;
+    case BlockFormat::BC4: return 80;
+    case BlockFormat::BC5: return 83;
+    case BlockFormat::BC7: return srgb ? 99 : 98;
+    }
+    return 0;
+}
+
+const char* BlockCompression::GetName(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1: return "BC1";
+    case BlockFormat::BC3: return "BC3";
+    case BlockFormat::BC4: return "BC4";
+    case BlockFormat::BC5: return "BC5";
+    case BlockFormat::BC7: return "BC7";
+    }
+    return "?";
+}
+
+void BlockCompression::EncodeBlock(BlockFormat format, const uint8_t* texels, uint8_t* out)
+{
+    uint8_t channel[16];
+
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        EncodeBC1Color(texels, out);
+        break;
+    case BlockFormat::BC3:
+        ExtractChannel(texels, 3, channel);
+        EncodeBC4(channel, out);
+        EncodeBC1Color(texels, out + 8);
+        break;
+    case BlockFormat::BC4:
+        ExtractChannel(texels, 0, channel);
+        EncodeBC4(channel, out);
+        break;
+    case BlockFormat::BC5:
+        ExtractChannel(texels, 0, channel);
+        EncodeBC4(channel, out);
+        ExtractChannel(texels, 1, channel);
+        EncodeBC4(channel, out + 8);
+        break;
+    case BlockFormat::BC7:
+        EncodeBC7(texels, out);
+        break;
+    }
+}
+
+void BlockCompression::DecodeBlock(BlockFormat format, const uint8_t* block, uint8_t* texels)
+{
+    uint8_t channel[16];
+
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        DecodeBC1Color(block, texels, true);
+        break;
+    case BlockFormat::BC3:
+        DecodeBC1Color(block + 8, texels, false);
+        DecodeBC4(block, channel);
+        for (int i = 0; i < 16; ++i)
+            texels[i * 4 + 3] = channel[i];
+        break;
+    case BlockFormat::BC4:
+        DecodeBC4(block, channel);
+        for (int i = 0; i < 16; ++i)
+        {
+            texels[i * 4 + 0] = channel[i];
+            texels[i * 4 + 1] = 0;
+            texels[i * 4 + 2] = 0;
+            texels[i * 4 + 3] = 255;
+        }
+        break;
+    case BlockFormat::BC5:
+        DecodeBC4(block, channel);
+        for (int i = 0; i < 16; ++i)
+            texels[i * 4 + 0] = channel[i];
+        DecodeBC4(block + 8, channel);
+        for (int i = 0; i < 16; ++i)
+        {
+            texels[i * 4 + 1] = channel[i];
+            texels[i * 4 + 2] = 0;
+            texels[i * 4 + 3] = 255;
+        }
+        break;
+    case BlockFormat::BC7:
+        DecodeBC7(block, texels);
+        break;
+    }
+}
+
+void BlockCompression::EncodeSurface(BlockFormat format, const TextureMipLevel& src, std::vector<uint8_t>& out)
+{
+    uint32_t blocksX = (src.width + 3) / 4;
+    uint32_t blocksY = (src.height + 3) / 4;
+    uint32_t blockBytes = GetBlockBytes(format);
+    out.resize((size_t)blocksX * blocksY * blockBytes);
+
+    JobContext ctx;
+    JobSystem::Dispatch(ctx, blocksY, 1, [&](uint32_t by)
+        {
+            uint8_t texels[64];
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    uint32_t sy = std::min(by * 4 + y, src.height - 1);
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        uint32_t sx = std::min(bx * 4 + x, src.width - 1);
+                        memcpy(&texels[(y * 4 + x) * 4], &src.pixels[((size_t)sy * src.width + sx) * 4], 4);
+                    }
+                }
+                EncodeBlock(format, texels, &out[((size_t)by * blocksX + bx) * blockBytes]);
+            }
+        });
+    JobSystem::Wait(ctx);
+}
+
+void BlockCompression::DecodeSurface(BlockFormat format, const uint8_t* blocks, uint32_t width, uint32_t height,
+    TextureMipLevel& out)
+{
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    uint32_t blockBytes = GetBlockBytes(format);
+
+    out.width = width;
+    out.height = height;
+    out.pixels.resize((size_t)width * height * 4);
+
+    uint8_t texels[64];
+    for (uint32_t by = 0; by < blocksY; ++by)
+    {
+        for (uint32_t bx = 0; bx < blocksX; ++bx)
+        {
+            DecodeBlock(format, blocks + ((size_t)by * blocksX + bx) * blockBytes, texels);
+
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+            {
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                {
+                    memcpy(&out.pixels[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], &texels[(y * 4 + x) * 4], 4);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "TextureStreamer.h"
+
+namespace Engine::Graphics
+{
+    enum class BlockFormat
+    {
+        BC1,    // RGB, 4 bpp
+        BC3,    // RGBA (BC1 color + BC4 alpha), 8 bpp
+        BC4,    // R, 4 bpp
+        BC5,    // RG (normal maps), 8 bpp
+        BC7     // RGBA, 8 bpp, mode 6 only
+    };
+
+    // CPU block encoder for the texture cooker. Surfaces are split into rows of
+    // 4x4 blocks and encoded on the job system; edge blocks replicate the last texel.
+    class BlockCompression
+    {
+    public:
+        static uint32_t GetBlockBytes(BlockFormat format);
+        static size_t GetSurfaceBytes(BlockFormat format, uint32_t width, uint32_t height);
+        static uint32_t GetDxgiFormat(BlockFormat format, bool srgb);
+        static const char* GetName(BlockFormat format);
+
+        static void EncodeSurface(BlockFormat format, const TextureMipLevel& src, std::vector<uint8_t>& out);
+        static void DecodeSurface(BlockFormat format, const uint8_t* blocks, uint32_t width, uint32_t height,
+            TextureMipLevel& out);
+
+        // 16 RGBA8 texels in row order
+        static void EncodeBlock(BlockFormat format, const uint8_t* texels, uint8_t* out);
+        static void DecodeBlock(BlockFormat format, const uint8_t* block, uint8_t* texels);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,21 @@
+#pragma once
+#include <DirectXMath.h>
+#include "GpuCulling.h"
+
+using namespace DirectX;
+
+// One CullView as CullCS.hlsl reads it
+struct CBCullView
+{
+    XMFLOAT4 Planes[6];
+    XMFLOAT4X4 ViewProj;    // transposed
+    XMUINT4 Params;         // x flags, y filter mask, z filter value
+};
+
+// CullCS.hlsl, one update per dispatch
+struct alignas(16) CBCull
+{
+    CBCullView Views[Engine::Graphics::MAX_CULL_VIEWS];
+    XMUINT4 CullCounts;     // x objects, y buckets, z first view, w view count
+    XMUINT4 PyramidSize;    // x width, y height, z levels (0: no pyramid)
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// Deferred light pass, rebuilds positions from the G-buffer depth
+struct alignas(16) CBDeferred
+{
+    XMFLOAT4X4 InvViewProj;
+    XMFLOAT4X4 View;
+};
@@ -0,0 +1,12 @@
+#pragma once
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// EVSM prefilter passes (Evsm.hlsli), one update per cascade slice
+struct alignas(16) CBEvsm
+{
+    XMFLOAT4 EvsmExponents;       // x = positive, y = negative, already clamped
+    XMFLOAT4 EvsmBlurWeights[2];  // weight of offset +-i is EvsmBlurWeights[i / 4][i % 4]
+    XMUINT4 EvsmBlurParams;       // x = cascade slice, y = radius in moment texels
+};
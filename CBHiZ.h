@@ -0,0 +1,10 @@
+#pragma once
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+// HiZBuildCS.hlsl, one update per pyramid level
+struct alignas(16) CBHiZ
+{
+    XMUINT4 HiZSource;      // x = source width, y = source height, z = 1 copies level 0 from the depth buffer
+};
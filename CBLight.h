@@ -1,7 +1,7 @@
 #pragma once
 #include "Light.h"
 #include <DirectXMath.h>
-#define MAX_LIGHTS 8
+#define MAX_LIGHTS 8 // cbuffer lights (the sun); local point lights go through the clusters
 
 using namespace DirectX;
 
@@ -10,4 +10,6 @@ struct alignas(16) CBLight
 	int LightCount;
 	XMFLOAT3 CameraPosition;
 	Light Lights[MAX_LIGHTS];
+	XMUINT4 ClusterDims;      // tiles x, tiles y, depth slices, clustered light count
+	XMFLOAT4 ClusterParams;   // xy = tiles per pixel, z = depth scale, w = depth bias
 };
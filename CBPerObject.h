@@ -10,4 +10,5 @@ struct alignas(16) CBPerObject
     XMFLOAT4X4 View;
     XMFLOAT4X4 Projection;
 	XMFLOAT4X4 LightViewProj;
+    XMUINT4 CascadeRange;   // single-pass shadows: x first cascade, y instance count
 };
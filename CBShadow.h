@@ -7,4 +7,8 @@ struct CBShadow
 {
     XMFLOAT4X4 LightViewProj[NUM_CASCADES];
     XMFLOAT4 CascadeSplits; // xyz = split depths
+    XMFLOAT4 CascadeFilterRadius; // kernel radius in texels per cascade
+    XMFLOAT4 ShadowFilterParams;  // x = cascade blend band (0 off), y = early-out
+    XMFLOAT4 EvsmParams;          // x = positive exponent, y = negative exponent, z = light bleeding reduction, w = min variance
+    XMFLOAT4 EvsmLodScale;        // per cascade: moment mip = log2(view depth * scale)
 };
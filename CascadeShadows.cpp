@@ -0,0 +1,218 @@
+#include "CascadeShadows.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    ShadowVector Add(const ShadowVector& a, const ShadowVector& b)
+    {
+        return { a.x + b.x, a.y + b.y, a.z + b.z };
+    }
+
+    ShadowVector Scale(const ShadowVector& v, float s)
+    {
+        return { v.x * s, v.y * s, v.z * s };
+    }
+
+    float Dot(const ShadowVector& a, const ShadowVector& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    ShadowVector Cross(const ShadowVector& a, const ShadowVector& b)
+    {
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+    ShadowVector Normalize(const ShadowVector& v)
+    {
+        return Scale(v, 1.0f / sqrtf(Dot(v, v)));
+    }
+
+    // Depth range of the slice corners along the light, padded toward and away from it
+    void FitDepth(const LightBasis& basis, const ShadowVector corners[8], float depthPadding, CascadeBounds& bounds)
+    {
+        float minZ = FLT_MAX;
+        float maxZ = -FLT_MAX;
+        for (int i = 0; i < 8; ++i)
+        {
+            float z = Dot(corners[i], basis.forward);
+            minZ = (std::min)(minZ, z);
+            maxZ = (std::max)(maxZ, z);
+        }
+        bounds.minZ = minZ - depthPadding;
+        bounds.maxZ = maxZ + depthPadding;
+    }
+}
+
+void CascadeShadows::ComputeSplits(float nearZ, float farZ, float lambda, uint32_t count, float* outSplits)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        float p = (i + 1) / (float)count;
+        float logSplit = nearZ * powf(farZ / nearZ, p);
+        float linearSplit = nearZ + (farZ - nearZ) * p;
+        outSplits[i] = lambda * logSplit + (1.0f - lambda) * linearSplit;
+    }
+}
+
+LightBasis CascadeShadows::MakeLightBasis(const ShadowVector& lightDirection)
+{
+    // Same axes as XMMatrixLookToLH, with a fallback up for lights straight up or down
+    LightBasis basis;
+    basis.forward = Normalize(lightDirection);
+    ShadowVector worldUp = fabsf(basis.forward.y) > 0.99f ? ShadowVector{ 0.0f, 0.0f, 1.0f } : ShadowVector{ 0.0f, 1.0f, 0.0f };
+    basis.right = Normalize(Cross(worldUp, basis.forward));
+    basis.up = Cross(basis.forward, basis.right);
+    return basis;
+}
+
+ShadowVector CascadeShadows::ToLightSpace(const LightBasis& basis, const ShadowVector& worldPosition)
+{
+    return { Dot(worldPosition, basis.right), Dot(worldPosition, basis.up), Dot(worldPosition, basis.forward) };
+}
+
+void CascadeShadows::GetSliceCorners(const CascadeCamera& camera, float sliceNear, float sliceFar, ShadowVector outCorners[8])
+{
+    const float tanY = tanf(camera.fovY * 0.5f);
+    const float tanX = tanY * camera.aspect;
+    const float distances[2] = { sliceNear, sliceFar };
+
+    for (int d = 0; d < 2; ++d)
+    {
+        ShadowVector center = Add(camera.position, Scale(camera.forward, distances[d]));
+        ShadowVector right = Scale(camera.right, tanX * distances[d]);
+        ShadowVector up = Scale(camera.up, tanY * distances[d]);
+
+        outCorners[d * 4 + 0] = Add(Add(center, Scale(right, -1.0f)), up);
+        outCorners[d * 4 + 1] = Add(Add(center, right), up);
+        outCorners[d * 4 + 2] = Add(Add(center, right), Scale(up, -1.0f));
+        outCorners[d * 4 + 3] = Add(Add(center, Scale(right, -1.0f)), Scale(up, -1.0f));
+    }
+}
+
+CascadeBounds CascadeShadows::Fit(CascadeFitMode mode, const CascadeCamera& camera, const LightBasis& basis,
+    float sliceNear, float sliceFar, uint32_t resolution, float depthPadding)
+{
+    if (mode == CASCADE_FIT_STABLE)
+        return FitStable(camera, basis, sliceNear, sliceFar, resolution, depthPadding);
+    return FitTight(camera, basis, sliceNear, sliceFar, resolution, depthPadding);
+}
+
+CascadeBounds CascadeShadows::FitTight(const CascadeCamera& camera, const LightBasis& basis,
+    float sliceNear, float sliceFar, uint32_t resolution, float depthPadding)
+{
+    ShadowVector corners[8];
+    GetSliceCorners(camera, sliceNear, sliceFar, corners);
+
+    CascadeBounds bounds;
+    bounds.minX = bounds.minY = FLT_MAX;
+    bounds.maxX = bounds.maxY = -FLT_MAX;
+    for (const ShadowVector& corner : corners)
+    {
+        ShadowVector p = ToLightSpace(basis, corner);
+        bounds.minX = (std::min)(bounds.minX, p.x);
+        bounds.maxX = (std::max)(bounds.maxX, p.x);
+        bounds.minY = (std::min)(bounds.minY, p.y);
+        bounds.maxY = (std::max)(bounds.maxY, p.y);
+    }
+
+    FitDepth(basis, corners, depthPadding, bounds);
+    bounds.texelSize = (std::max)(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY) / resolution;
+    return bounds;
+}
+
+float CascadeShadows::GetSliceSphere(const CascadeCamera& camera, float sliceNear, float sliceFar, float& outCenterDistance)
+{
+    // Corners at distance z lie sqrt(k) * z off the view axis. The center
+    // equidistant from the near and far corners is (n + f)(1 + k) / 2 along
+    // it; past the far plane the far corners alone bound the slice.
+    const float tanY = tanf(camera.fovY * 0.5f);
+    const float tanX = tanY * camera.aspect;
+    const float k = tanX * tanX + tanY * tanY;
+
+    float center = (std::min)(0.5f * (sliceNear + sliceFar) * (1.0f + k), sliceFar);
+    float toNear = (center - sliceNear) * (center - sliceNear) + k * sliceNear * sliceNear;
+    float toFar = (sliceFar - center) * (sliceFar - center) + k * sliceFar * sliceFar;
+
+    outCenterDistance = center;
+    return sqrtf((std::max)(toNear, toFar));
+}
+
+CascadeBounds CascadeShadows::FitStable(const CascadeCamera& camera, const LightBasis& basis,
+    float sliceNear, float sliceFar, uint32_t resolution, float depthPadding)
+{
+    float centerDistance = 0.0f;
+    float radius = GetSliceSphere(camera, sliceNear, sliceFar, centerDistance);
+
+    // The sphere is the same for every orientation, so is the texel size.
+    // One spare texel per side covers the snap below.
+    CascadeBounds bounds;
+    bounds.texelSize = 2.0f * radius / (resolution - 2);
+    float halfExtent = 0.5f * resolution * bounds.texelSize;
+
+    // Move in whole texels only: every world point keeps its spot inside its texel
+    ShadowVector center = ToLightSpace(basis, Add(camera.position, Scale(camera.forward, centerDistance)));
+    float x = floorf(center.x / bounds.texelSize) * bounds.texelSize;
+    float y = floorf(center.y / bounds.texelSize) * bounds.texelSize;
+
+    bounds.minX = x - halfExtent;
+    bounds.maxX = x + halfExtent;
+    bounds.minY = y - halfExtent;
+    bounds.maxY = y + halfExtent;
+
+    // Depth is the sphere's extent, not the corners', so it does not pulse
+    // with rotation either. Snapped too (with a texel of slack), so a cached
+    // cascade stays valid until the camera moves a whole texel.
+    float z = floorf(center.z / bounds.texelSize) * bounds.texelSize;
+    bounds.minZ = z - radius - bounds.texelSize - depthPadding;
+    bounds.maxZ = z + radius + bounds.texelSize + depthPadding;
+    return bounds;
+}
+
+ShadowAabb CascadeShadows::ToLightSpaceBounds(const LightBasis& basis, const ShadowAabb& worldBounds)
+{
+    ShadowAabb bounds;
+    bounds.min = { FLT_MAX, FLT_MAX, FLT_MAX };
+    bounds.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int i = 0; i < 8; ++i)
+    {
+        ShadowVector corner = {
+            (i & 1) ? worldBounds.max.x : worldBounds.min.x,
+            (i & 2) ? worldBounds.max.y : worldBounds.min.y,
+            (i & 4) ? worldBounds.max.z : worldBounds.min.z };
+        ShadowVector p = ToLightSpace(basis, corner);
+        bounds.min = { (std::min)(bounds.min.x, p.x), (std::min)(bounds.min.y, p.y), (std::min)(bounds.min.z, p.z) };
+        bounds.max = { (std::max)(bounds.max.x, p.x), (std::max)(bounds.max.y, p.y), (std::max)(bounds.max.z, p.z) };
+    }
+    return bounds;
+}
+
+void CascadeShadows::FitDepthToScene(const ShadowAabb& sceneLightBounds, float depthSnap, CascadeBounds& bounds)
+{
+    bool overlaps =
+        sceneLightBounds.min.x <= bounds.maxX && sceneLightBounds.max.x >= bounds.minX &&
+        sceneLightBounds.min.y <= bounds.maxY && sceneLightBounds.max.y >= bounds.minY &&
+        sceneLightBounds.min.z <= bounds.maxZ;
+    if (!overlaps)
+        return;
+
+    // Receivers past the scene's far side do not exist, casters in front of the slice do
+    float minZ = floorf(sceneLightBounds.min.z / depthSnap) * depthSnap;
+    float maxZ = ceilf(sceneLightBounds.max.z / depthSnap) * depthSnap;
+    bounds.minZ = minZ;
+    bounds.maxZ = (std::min)(bounds.maxZ, maxZ);
+    if (bounds.maxZ <= bounds.minZ)
+        bounds.maxZ = bounds.minZ + depthSnap;
+}
+
+bool CascadeShadows::IsCasterVisible(const CascadeBounds& bounds, const ShadowAabb& casterLightBounds)
+{
+    return casterLightBounds.min.x <= bounds.maxX && casterLightBounds.max.x >= bounds.minX &&
+        casterLightBounds.min.y <= bounds.maxY && casterLightBounds.max.y >= bounds.minY &&
+        casterLightBounds.min.z <= bounds.maxZ;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine::Graphics
+{
+    struct ShadowVector
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+    };
+
+    // The main camera as the cascade fit sees it: position and an orthonormal
+    // left-handed basis (forward into the screen)
+    struct CascadeCamera
+    {
+        ShadowVector position;
+        ShadowVector right = { 1.0f, 0.0f, 0.0f };
+        ShadowVector up = { 0.0f, 1.0f, 0.0f };
+        ShadowVector forward = { 0.0f, 0.0f, 1.0f };
+        float fovY = 0.0f;
+        float aspect = 1.0f;
+    };
+
+    // Rotation-only light view, forward along the light. It depends on the
+    // light alone, so the texel grid never turns with the camera.
+    struct LightBasis
+    {
+        ShadowVector right;
+        ShadowVector up;
+        ShadowVector forward;
+    };
+
+    // Orthographic box of one cascade in light space
+    struct CascadeBounds
+    {
+        float minX = 0.0f;
+        float maxX = 0.0f;
+        float minY = 0.0f;
+        float maxY = 0.0f;
+        float minZ = 0.0f;
+        float maxZ = 0.0f;
+        float texelSize = 0.0f;     // world units per shadow map texel (the larger axis for tight fits)
+    };
+
+    // Axis-aligned box, in world or light space depending on where it came from
+    struct ShadowAabb
+    {
+        ShadowVector min;
+        ShadowVector max;
+    };
+
+    enum CascadeFitMode : uint32_t
+    {
+        CASCADE_FIT_TIGHT = 0,      // light-space AABB of the slice: sharpest, but shimmers as the camera turns
+        CASCADE_FIT_STABLE = 1      // bounding sphere snapped to whole texels: fixed texel size, no shimmer
+    };
+
+    // Cascade placement for directional light shadows. Plain math with no
+    // graphics API, so it can be checked anywhere.
+    class CascadeShadows
+    {
+    public:
+        // Practical split scheme, lambda blends logarithmic (1) and linear (0).
+        // outSplits[i] is the far distance of cascade i.
+        static void ComputeSplits(float nearZ, float farZ, float lambda, uint32_t count, float* outSplits);
+
+        static LightBasis MakeLightBasis(const ShadowVector& lightDirection);
+        static ShadowVector ToLightSpace(const LightBasis& basis, const ShadowVector& worldPosition);
+
+        // World-space corners of the view frustum between two view distances, near four first
+        static void GetSliceCorners(const CascadeCamera& camera, float sliceNear, float sliceFar, ShadowVector outCorners[8]);
+
+        // depthPadding extends the box along the light so casters outside the slice still land in the map
+        static CascadeBounds Fit(CascadeFitMode mode, const CascadeCamera& camera, const LightBasis& basis,
+            float sliceNear, float sliceFar, uint32_t resolution, float depthPadding);
+        static CascadeBounds FitTight(const CascadeCamera& camera, const LightBasis& basis,
+            float sliceNear, float sliceFar, uint32_t resolution, float depthPadding);
+        static CascadeBounds FitStable(const CascadeCamera& camera, const LightBasis& basis,
+            float sliceNear, float sliceFar, uint32_t resolution, float depthPadding);
+
+        // Radius of the slice's bounding sphere. Only depends on the projection
+        // and the distances, never on the camera's orientation or position.
+        static float GetSliceSphere(const CascadeCamera& camera, float sliceNear, float sliceFar, float& outCenterDistance);
+
+        // Light-space box around a world-space box
+        static ShadowAabb ToLightSpaceBounds(const LightBasis& basis, const ShadowAabb& worldBounds);
+
+        // Depth range from the scene instead of the slice: the near plane goes back
+        // to the scene's nearest point toward the light, so no caster is clipped,
+        // and the far plane stops where the scene ends. Both snap outward to
+        // multiples of depthSnap, so small scene changes keep the range (and a
+        // cached cascade) unchanged. No-op if the scene misses the cascade.
+        static void FitDepthToScene(const ShadowAabb& sceneLightBounds, float depthSnap, CascadeBounds& bounds);
+
+        // Extruded toward the light: a caster anywhere between the light and the
+        // far plane over the cascade's rectangle can shadow something in it
+        static bool IsCasterVisible(const CascadeBounds& bounds, const ShadowAabb& casterLightBounds);
+    };
+
+} // namespace Engine::Graphics
@@ -1,4 +1,5 @@
 #include "ConstantBuffer.h"
+#include <algorithm>
 #include <cstring>
 
 using namespace Engine::Graphics;
@@ -10,16 +11,45 @@ bool ConstantBuffer::Create(ID3D11Device* device, size_t size)
     D3D11_BUFFER_DESC desc = {};
     desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
     desc.ByteWidth = (UINT)((size + 15) / 16 * 16);
-    desc.CPUAccessFlags = 0;
-    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    desc.Usage = D3D11_USAGE_DYNAMIC;
 
+    m_size = size;
     return SUCCEEDED(device->CreateBuffer(&desc, nullptr, m_buffer.GetAddressOf()));
 }
 
 void ConstantBuffer::Update(ID3D11DeviceContext* context, const void* data)
+{
+    Update(context, data, nullptr);
+}
+
+void ConstantBuffer::Update(ID3D11DeviceContext* context, const void* data, const ConstantBufferBinding* binding)
 {
     if (!context || !m_buffer) return;
-    context->UpdateSubresource(m_buffer.Get(), 0, nullptr, data, 0, 0);
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(context->Map(m_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        return;
+
+    if (!binding)
+    {
+        memcpy(mapped.pData, data, m_size);
+        m_uploadedBytes += m_size;
+    }
+    else
+    {
+        for (const ByteRange& range : binding->usedRanges)
+        {
+            // Reflection rounds to whole registers, the C++ struct may end mid-register
+            if (range.offset >= m_size)
+                continue;
+            size_t size = (std::min)((size_t)range.size, m_size - range.offset);
+            memcpy(static_cast<uint8_t*>(mapped.pData) + range.offset, static_cast<const uint8_t*>(data) + range.offset, size);
+            m_uploadedBytes += size;
+        }
+    }
+
+    context->Unmap(m_buffer.Get(), 0);
 }
 
 void ConstantBuffer::Release()
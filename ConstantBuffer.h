@@ -3,22 +3,36 @@
 #include <d3d11.h>
 #include <wrl/client.h>
 #include <DirectXMath.h>
+#include <cstdint>
+#include "ShaderReflection.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 
 namespace Engine::Graphics
 {
+    // Dynamic buffer, every update maps with DISCARD
     class ConstantBuffer
     {
     public:
         bool Create(ID3D11Device* device, size_t size);
         void Update(ID3D11DeviceContext* context, const void* data);
+
+        // Writes only the ranges the binding's shader reads, the rest of the
+        // renamed buffer is left undefined. A null binding writes everything.
+        void Update(ID3D11DeviceContext* context, const void* data, const ConstantBufferBinding* binding);
+
         void Release();
         ID3D11Buffer* Get() const { return m_buffer.Get(); }
+        size_t GetSize() const { return m_size; }
+
+        // Bytes written by every update so far
+        uint64_t GetUploadedBytes() const { return m_uploadedBytes; }
 
     private:
         ComPtr<ID3D11Buffer> m_buffer;
+        size_t m_size = 0;
+        uint64_t m_uploadedBytes = 0;
     };
 
 } // namespace Engine::Graphics
@@ -0,0 +1,163 @@
+// GPU-driven culling: one thread per (object, view). An object that passes
+// the view's filter, its frustum and, for CULL_VIEW_HIZ views, the depth
+// pyramid bumps the instance count of its bucket's draw and writes its index
+// into the draw's instance range. The CPU then issues one
+// DrawIndexedInstancedIndirect per (view, bucket).
+// Two-phase occlusion culling keeps one visibility word per object: a
+// CULL_VIEW_EARLY view draws what was visible last frame, the Hi-Z pyramid is
+// built from that depth, then a CULL_VIEW_LATE view tests everything against
+// it, records the new visibility and draws only what the early pass missed.
+// CullKernel (GpuCulling.cpp) is the CPU reference, test for test.
+#define MAX_CULL_VIEWS 16
+#define CULL_VIEW_SKIP_NEAR 1
+#define CULL_VIEW_HIZ 2
+#define CULL_VIEW_EARLY 4
+#define CULL_VIEW_LATE 8
+#define GROUP_SIZE 64
+
+struct CullObject
+{
+    float3 boundsMin;
+    uint bucket;
+    float3 boundsMax;
+    uint flags;
+};
+
+struct CullView
+{
+    float4 planes[6];       // left, right, bottom, top, near, far
+    float4x4 viewProj;
+    uint4 params;           // x flags, y filter mask, z filter value
+};
+
+cbuffer CBCull : register(b0)
+{
+    CullView Views[MAX_CULL_VIEWS];
+    uint4 CullCounts;       // x objects, y buckets, z first view, w view count
+    uint4 PyramidSize;      // x width, y height, z levels
+};
+
+StructuredBuffer<CullObject> Objects : register(t0);
+Texture2D<float> Pyramid : register(t1);
+
+// Five uints per draw: index count, instance count, start index, base vertex, start instance
+RWBuffer<uint> Args : register(u0);
+RWBuffer<uint> Instances : register(u1);
+RWBuffer<uint> Visibility : register(u2);
+
+bool IsInFrustum(CullObject object, CullView view)
+{
+    [unroll]
+    for (uint p = 0; p < 6; ++p)
+    {
+        if (p == 4 && (view.params.x & CULL_VIEW_SKIP_NEAR))
+            continue;
+
+        // The corner farthest along the plane normal
+        float4 plane = view.planes[p];
+        float3 corner = plane.xyz >= 0.0f ? object.boundsMax : object.boundsMin;
+        if (dot(plane.xyz, corner) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool IsOccluded(CullObject object, CullView view)
+{
+    if (PyramidSize.z == 0)
+        return false;
+
+    float2 minXY = 3.402823466e+38f;
+    float2 maxXY = -3.402823466e+38f;
+    float minZ = 3.402823466e+38f;
+
+    [unroll]
+    for (uint corner = 0; corner < 8; ++corner)
+    {
+        float3 position = float3(
+            (corner & 1) ? object.boundsMax.x : object.boundsMin.x,
+            (corner & 2) ? object.boundsMax.y : object.boundsMin.y,
+            (corner & 4) ? object.boundsMax.z : object.boundsMin.z);
+
+        float4 clip = mul(float4(position, 1.0f), view.viewProj);
+
+        // Behind or at the camera: the projected rect is meaningless
+        if (clip.w <= 1e-5f)
+            return false;
+
+        float invW = 1.0f / clip.w;
+        minXY = min(minXY, clip.xy * invW);
+        maxXY = max(maxXY, clip.xy * invW);
+        minZ = min(minZ, clip.z * invW);
+    }
+
+    // Crossing the near plane
+    if (minZ <= 0.0f)
+        return false;
+
+    // Level 0 texels, y down, clamped to the viewport
+    float2 size = float2(PyramidSize.xy);
+    float x0 = max((minXY.x * 0.5f + 0.5f) * size.x, 0.0f);
+    float x1 = min((maxXY.x * 0.5f + 0.5f) * size.x, size.x - 1.0f);
+    float y0 = max((0.5f - maxXY.y * 0.5f) * size.y, 0.0f);
+    float y1 = min((0.5f - minXY.y * 0.5f) * size.y, size.y - 1.0f);
+    if (x0 > x1 || y0 > y1)
+        return false;
+
+    // The level where the rect spans at most two texels each way
+    float extent = max(x1 - x0, y1 - y0);
+    uint level = extent > 1.0f ? (uint)ceil(log2(extent)) : 0;
+    if (level >= PyramidSize.z)
+        return false;
+
+    float scale = 1.0f / (float)(1u << level);
+    uint2 levelSize = max(PyramidSize.xy >> level, 1u);
+    uint2 t0 = min(uint2(float2(x0, y0) * scale), levelSize - 1);
+    uint2 t1 = min(uint2(float2(x1, y1) * scale), levelSize - 1);
+
+    float farthest = max(
+        max(Pyramid.Load(int3(t0.x, t0.y, level)), Pyramid.Load(int3(t1.x, t0.y, level))),
+        max(Pyramid.Load(int3(t0.x, t1.y, level)), Pyramid.Load(int3(t1.x, t1.y, level))));
+    return minZ > farthest;
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    uint index = id.x;
+    uint viewIndex = CullCounts.z + id.y;
+    if (index >= CullCounts.x || id.y >= CullCounts.w)
+        return;
+
+    CullObject object = Objects[index];
+    CullView view = Views[viewIndex];
+    uint flags = view.params.x;
+
+    if ((flags & CULL_VIEW_EARLY) && Visibility[index] == 0)
+        return;
+
+    // Nested: HLSL evaluates both sides of &&
+    bool visible = (object.flags & view.params.y) == view.params.z;
+    if (visible)
+    {
+        visible = IsInFrustum(object, view);
+        if (visible && (flags & CULL_VIEW_HIZ))
+            visible = !IsOccluded(object, view);
+    }
+
+    if (flags & CULL_VIEW_LATE)
+    {
+        // Drawn by the early pass already
+        bool wasVisible = Visibility[index] != 0;
+        Visibility[index] = visible ? 1 : 0;
+        if (wasVisible)
+            return;
+    }
+    if (!visible)
+        return;
+
+    uint draw = (viewIndex * CullCounts.y + object.bucket) * 5;
+    uint slot;
+    InterlockedAdd(Args[draw + 1], 1, slot);
+    Instances[Args[draw + 4] + slot] = index;
+}
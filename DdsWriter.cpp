@@ -0,0 +1,102 @@
+#include "DdsWriter.h"
+
+#include <cstring>
+#include <fstream>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+    const uint32_t DDSD_CAPS = 0x1;
+    const uint32_t DDSD_HEIGHT = 0x2;
+    const uint32_t DDSD_WIDTH = 0x4;
+    const uint32_t DDSD_PIXELFORMAT = 0x1000;
+    const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    const uint32_t DDSD_LINEARSIZE = 0x80000;
+    const uint32_t DDPF_FOURCC = 0x4;
+    const uint32_t DDSCAPS_COMPLEX = 0x8;
+    const uint32_t DDSCAPS_TEXTURE = 0x1000;
+    const uint32_t DDSCAPS_MIPMAP = 0x400000;
+    const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+    struct DdsPixelFormat
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t rgbBitCount;
+        uint32_t rBitMask;
+        uint32_t gBitMask;
+        uint32_t bBitMask;
+        uint32_t aBitMask;
+    };
+
+    struct DdsHeader
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        DdsPixelFormat ddspf;
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+
+    struct DdsHeaderDx10
+    {
+        uint32_t dxgiFormat;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+
+    static_assert(sizeof(DdsHeader) == 124, "DDS header layout");
+    static_assert(sizeof(DdsHeaderDx10) == 20, "DDS DX10 header layout");
+}
+
+bool DdsWriter::Write(const std::filesystem::path& path, uint32_t dxgiFormat, uint32_t width, uint32_t height,
+    const std::vector<std::vector<uint8_t>>& levels)
+{
+    if (levels.empty() || width == 0 || height == 0)
+        return false;
+
+    DdsHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(DdsHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.height = height;
+    header.width = width;
+    header.pitchOrLinearSize = (uint32_t)levels[0].size();
+    header.mipMapCount = (uint32_t)levels.size();
+    header.ddspf.size = sizeof(DdsPixelFormat);
+    header.ddspf.flags = DDPF_FOURCC;
+    header.ddspf.fourCC = '0' << 24 | '1' << 16 | 'X' << 8 | 'D'; // "DX10"
+    header.caps = DDSCAPS_TEXTURE | (levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    DdsHeaderDx10 dx10 = {};
+    dx10.dxgiFormat = dxgiFormat;
+    dx10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+    dx10.arraySize = 1;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file.write((const char*)&DDS_MAGIC, sizeof(DDS_MAGIC));
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)&dx10, sizeof(dx10));
+    for (const std::vector<uint8_t>& level : levels)
+        file.write((const char*)level.data(), (std::streamsize)level.size());
+
+    return (bool)file;
+}
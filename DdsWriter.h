@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Engine::Graphics
+{
+    // Writes 2D textures as DDS with the DX10 extension header, readable by
+    // DirectXTK's DDSTextureLoader. levels[0] is the top mip, data tightly packed.
+    class DdsWriter
+    {
+    public:
+        static bool Write(const std::filesystem::path& path, uint32_t dxgiFormat, uint32_t width, uint32_t height,
+            const std::vector<std::vector<uint8_t>>& levels);
+    };
+
+} // namespace Engine::Graphics
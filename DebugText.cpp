@@ -0,0 +1,130 @@
+#include "DebugText.h"
+#include <algorithm>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const char FIRST_GLYPH = ' ';
+    const char LAST_GLYPH = '_';
+
+    // ASCII 32..95, blank where no glyph was drawn
+    const uint8_t GLYPHS[LAST_GLYPH - FIRST_GLYPH + 1][DebugText::GLYPH_HEIGHT] =
+    {
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // ' '
+        { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },   // !
+        { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 },   // "
+        { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A },   // #
+        { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 },   // $
+        { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },   // %
+        { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D },   // &
+        { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '
+        { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },   // (
+        { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },   // )
+        { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 },   // *
+        { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },   // +
+        { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },   // ,
+        { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },   // -
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },   // .
+        { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },   // /
+        { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },   // 0
+        { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },   // 1
+        { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },   // 2
+        { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },   // 3
+        { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },   // 4
+        { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },   // 5
+        { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },   // 6
+        { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },   // 7
+        { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },   // 8
+        { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },   // 9
+        { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },   // :
+        { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 },   // ;
+        { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },   // <
+        { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },   // =
+        { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },   // >
+        { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },   // ?
+        { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E },   // @
+        { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 },   // A
+        { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },   // B
+        { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },   // C
+        { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },   // D
+        { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },   // E
+        { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },   // F
+        { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },   // G
+        { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // H
+        { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },   // I
+        { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },   // J
+        { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },   // K
+        { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },   // L
+        { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },   // M
+        { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },   // N
+        { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // O
+        { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },   // P
+        { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },   // Q
+        { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },   // R
+        { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },   // S
+        { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },   // T
+        { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // U
+        { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },   // V
+        { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },   // W
+        { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },   // X
+        { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },   // Y
+        { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },   // Z
+        { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E },   // [
+        { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 },   // backslash
+        { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E },   // ]
+        { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 },   // ^
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }    // _
+    };
+}
+
+const uint8_t* DebugText::GetGlyph(char c)
+{
+    if (c >= 'a' && c <= 'z')
+        c = (char)(c - 'a' + 'A');
+    if (c < FIRST_GLYPH || c > LAST_GLYPH)
+        c = '?';
+    return GLYPHS[c - FIRST_GLYPH];
+}
+
+void DebugText::Rasterize(const std::vector<std::string>& lines, std::vector<uint8_t>& outPixels,
+    uint32_t& outWidth, uint32_t& outHeight)
+{
+    size_t columns = 0;
+    for (const std::string& line : lines)
+        columns = (std::max)(columns, line.size());
+
+    if (!columns)
+    {
+        outPixels.clear();
+        outWidth = 0;
+        outHeight = 0;
+        return;
+    }
+
+    // The last cell's spacing stands in for the right and bottom margins' first pixel
+    outWidth = (uint32_t)columns * CELL_WIDTH + 2 * MARGIN - (CELL_WIDTH - GLYPH_WIDTH);
+    outHeight = (uint32_t)lines.size() * CELL_HEIGHT + 2 * MARGIN - (CELL_HEIGHT - GLYPH_HEIGHT);
+    outPixels.assign((size_t)outWidth * outHeight, 0);
+
+    for (size_t row = 0; row < lines.size(); ++row)
+    {
+        const std::string& line = lines[row];
+        for (size_t column = 0; column < line.size(); ++column)
+        {
+            if (line[column] == ' ')
+                continue;
+
+            const uint8_t* glyph = GetGlyph(line[column]);
+            uint8_t* cell = &outPixels[(MARGIN + row * CELL_HEIGHT) * outWidth + MARGIN + column * CELL_WIDTH];
+            for (uint32_t y = 0; y < GLYPH_HEIGHT; ++y)
+            {
+                for (uint32_t x = 0; x < GLYPH_WIDTH; ++x)
+                {
+                    if (glyph[y] & (0x10 >> x))
+                        cell[y * outWidth + x] = 255;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine::Graphics
+{
+    // Text for debug overlays in a built-in 5x7 font, ASCII 32..95: lowercase
+    // prints as uppercase, anything else as '?'. Lines are rasterized on the
+    // CPU into an 8-bit image, 255 on glyph pixels, 0 elsewhere.
+    class DebugText
+    {
+    public:
+        static const uint32_t GLYPH_WIDTH = 5;
+        static const uint32_t GLYPH_HEIGHT = 7;
+        static const uint32_t CELL_WIDTH = 6;       // a column of spacing
+        static const uint32_t CELL_HEIGHT = 9;      // two rows of spacing
+        static const uint32_t MARGIN = 2;           // pixels around the text
+
+        // Seven rows, bit 4 the leftmost pixel
+        static const uint8_t* GetGlyph(char c);
+
+        // Sized to the longest line; 0x0 without text
+        static void Rasterize(const std::vector<std::string>& lines, std::vector<uint8_t>& outPixels,
+            uint32_t& outWidth, uint32_t& outHeight);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,48 @@
+#include "DebugTextD3D11.h"
+
+using namespace Engine::Graphics;
+
+DebugTextTexture::DebugTextTexture(ID3D11Device* device)
+    : m_device(device)
+{
+}
+
+bool DebugTextTexture::Update(ID3D11DeviceContext* context, const std::vector<std::string>& lines)
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    DebugText::Rasterize(lines, m_pixels, width, height);
+    if (!width || !height)
+        return false;
+
+    if (!m_texture || width != m_width || height != m_height)
+    {
+        m_texture.Reset();
+        m_srv.Reset();
+        m_width = 0;
+        m_height = 0;
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        if (FAILED(m_device->CreateTexture2D(&desc, nullptr, m_texture.GetAddressOf())) ||
+            FAILED(m_device->CreateShaderResourceView(m_texture.Get(), nullptr, m_srv.GetAddressOf())))
+        {
+            m_texture.Reset();
+            m_srv.Reset();
+            return false;
+        }
+
+        m_width = width;
+        m_height = height;
+    }
+
+    context->UpdateSubresource(m_texture.Get(), 0, nullptr, m_pixels.data(), width, 0);
+    return true;
+}
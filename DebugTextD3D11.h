@@ -0,0 +1,37 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DebugText.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // GPU side of DebugText: the rasterized lines in an R8_UNORM texture.
+    // DebugTextPS.hlsl draws it over a viewport of its size (or a multiple).
+    class DebugTextTexture
+    {
+    public:
+        DebugTextTexture(ID3D11Device* device);
+
+        // Rasterizes and uploads the lines, recreating the texture when the size changed
+        bool Update(ID3D11DeviceContext* context, const std::vector<std::string>& lines);
+
+        ID3D11ShaderResourceView* GetSRV() const { return m_srv.Get(); }
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+
+    private:
+        ComPtr<ID3D11Device> m_device;
+        ComPtr<ID3D11Texture2D> m_texture;
+        ComPtr<ID3D11ShaderResourceView> m_srv;
+        std::vector<uint8_t> m_pixels;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,21 @@
+// Debug text: the glyphs come rasterized on the CPU (DebugText.cpp), one
+// texel per font pixel. The viewport covers the text at a whole multiple of
+// its size, so each texel maps to a block of screen pixels.
+Texture2D<float> Text : register(t0);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float2 uv : TEXCOORD;
+};
+
+float4 main(PSInput input) : SV_TARGET
+{
+    uint width, height;
+    Text.GetDimensions(width, height);
+    uint2 texel = min(uint2(input.uv * float2(width, height)), uint2(width, height) - 1);
+
+    // Opaque panel, no blend state needed
+    float coverage = Text.Load(int3(texel, 0));
+    return lerp(float4(0.02f, 0.02f, 0.03f, 1.0f), float4(0.9f, 1.0f, 0.6f, 1.0f), coverage);
+}
@@ -0,0 +1,14 @@
+// Deferred composite: the HDR light buffer onto the back buffer. Sky pixels
+// hold the clear color the light buffer was cleared to.
+Texture2D<float4> LightBuffer : register(t0);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float2 uv : TEXCOORD;
+};
+
+float4 main(PSInput input) : SV_TARGET
+{
+    return float4(LightBuffer.Load(int3(input.position.xy, 0)).rgb, 1.0f);
+}
@@ -0,0 +1,38 @@
+// Deferred light pass: the same lighting as the forward pass (Lighting.hlsli),
+// run once per covered pixel from the G-buffer instead of once per fragment.
+// Keywords: SHADOW_QUALITY, LIGHT_MIX, CLUSTERED_LIGHTS (Lighting.hlsli).
+#include "Lighting.hlsli"
+#include "GBuffer.hlsli"
+
+cbuffer CBDeferred : register(b3)
+{
+    float4x4 InvViewProj;
+    float4x4 View;
+};
+
+Texture2D<float4> GBufferAlbedo : register(t6);
+Texture2D<float2> GBufferNormal : register(t7);
+Texture2D<float> GBufferDepth : register(t8);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float2 uv : TEXCOORD;
+};
+
+float4 main(PSInput input) : SV_TARGET
+{
+    int3 texel = int3(input.position.xy, 0);
+    float4 albedoRoughness = GBufferAlbedo.Load(texel);
+    float3 N = DecodeOctahedral(GBufferNormal.Load(texel));
+    float depth = GBufferDepth.Load(texel);
+
+    // Back to world space through the inverse view-projection
+    float2 ndc = float2(input.uv.x * 2.0f - 1.0f, 1.0f - input.uv.y * 2.0f);
+    float4 posWS = mul(float4(ndc, depth, 1.0f), InvViewProj);
+    posWS.xyz /= posWS.w;
+    float viewDepth = mul(float4(posWS.xyz, 1.0f), View).z;
+
+    float3 color = ComputeLighting(posWS.xyz, viewDepth, input.position.xy, N, albedoRoughness.rgb, albedoRoughness.a);
+    return float4(color, 1.0f);
+}
@@ -0,0 +1,33 @@
+// DepthPrepassVS.hlsl for indirect draws. The main pass tests EQUAL against
+// this depth, so the position math must stay identical to
+// SimpleInstancedVS.hlsl, operation for operation, and precise in both.
+#include "Instancing.hlsli"
+
+cbuffer CBPerObject : register(b0)
+{
+    float4x4 View : packoffset(c8);
+    float4x4 Projection : packoffset(c12);
+};
+
+struct VSInput
+{
+    float3 position : POSITION;
+    uint object : INSTANCE;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+};
+
+VSOutput main(VSInput input)
+{
+    VSOutput output;
+
+    precise float4 posWorld = mul(float4(input.position, 1.0f), InstanceTransforms[input.object].World);
+    precise float4 posView = mul(posWorld, View);
+    precise float4 posClip = mul(posView, Projection);
+    output.position = posClip;
+
+    return output;
+}
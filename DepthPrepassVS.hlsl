@@ -0,0 +1,33 @@
+// Depth prepass: position only, no pixel shader. The main pass tests EQUAL
+// against this depth, so the position math must stay identical to
+// SimpleVS.hlsl, operation for operation, and precise in both.
+cbuffer CBPerObject : register(b0)
+{
+    float4x4 World;
+    float4x4 WorldInvTranspose;
+    float4x4 View;
+    float4x4 Projection;
+    float4x4 LightViewProj;
+};
+
+struct VSInput
+{
+    float3 position : POSITION;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+};
+
+VSOutput main(VSInput input)
+{
+    VSOutput output;
+
+    precise float4 posWorld = mul(float4(input.position, 1.0f), World);
+    precise float4 posView = mul(posWorld, View);
+    precise float4 posClip = mul(posView, Projection);
+    output.position = posClip;
+
+    return output;
+}
@@ -0,0 +1,74 @@
+#include "DepthReduction.h"
+#include "CascadeShadows.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+using namespace Engine::Graphics;
+
+float DepthReduction::LinearizeDepth(float deviceDepth, float nearZ, float farZ)
+{
+    // d = f / (f - n) * (1 - n / z), solved for z
+    return nearZ * farZ / (farZ - deviceDepth * (farZ - nearZ));
+}
+
+DepthRange DepthReduction::Reduce(const float* deviceDepth, uint32_t width, uint32_t height, float nearZ, float farZ)
+{
+    // Device depth grows with view depth, so the extremes linearize to the extremes
+    float minDepth = FLT_MAX;
+    float maxDepth = -FLT_MAX;
+    for (uint32_t i = 0; i < width * height; ++i)
+    {
+        float d = deviceDepth[i];
+        if (d >= 1.0f)
+            continue;
+        minDepth = (std::min)(minDepth, d);
+        maxDepth = (std::max)(maxDepth, d);
+    }
+
+    DepthRange range;
+    if (minDepth > maxDepth)
+        return range;
+
+    range.minZ = LinearizeDepth(minDepth, nearZ, farZ);
+    range.maxZ = LinearizeDepth(maxDepth, nearZ, farZ);
+    range.valid = true;
+    return range;
+}
+
+void DepthReduction::ComputePartitions(const DepthRange& visible, float nearZ, float farZ, const SdsmSettings& settings,
+    uint32_t count, ShadowPartition* outPartitions)
+{
+    float minZ = nearZ;
+    float maxZ = farZ;
+    if (visible.valid)
+    {
+        // Outward onto the log grid: the range has to grow or shrink by a
+        // whole step before the splits (and cached cascades) change
+        float steps = (float)(std::max)(settings.stepsPerOctave, 1u);
+        float paddedMin = visible.minZ / (1.0f + settings.latencyPadding);
+        float paddedMax = visible.maxZ * (1.0f + settings.latencyPadding);
+        minZ = exp2f(floorf(log2f((std::max)(paddedMin, nearZ)) * steps) / steps);
+        maxZ = exp2f(ceilf(log2f((std::max)(paddedMax, nearZ)) * steps) / steps);
+        minZ = (std::max)(minZ, nearZ);
+        maxZ = (std::min)(maxZ, farZ);
+        if (maxZ <= minZ)
+        {
+            minZ = nearZ;
+            maxZ = farZ;
+        }
+    }
+
+    std::vector<float> splits(count);
+    CascadeShadows::ComputeSplits(minZ, maxZ, settings.lambda, count, splits.data());
+
+    float prev = minZ;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        outPartitions[i].nearZ = prev;
+        outPartitions[i].farZ = splits[i];
+        prev = splits[i];
+    }
+}
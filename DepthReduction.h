@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine::Graphics
+{
+    // View-space depth range of the visible samples
+    struct DepthRange
+    {
+        float minZ = 0.0f;
+        float maxZ = 0.0f;
+        bool valid = false;     // false when nothing but sky was drawn
+    };
+
+    // View-space interval one shadow cascade covers
+    struct ShadowPartition
+    {
+        float nearZ = 0.0f;
+        float farZ = 0.0f;
+    };
+
+    struct SdsmSettings
+    {
+        float lambda = 0.8f;            // log (1) / linear (0) blend inside the visible range
+        float latencyPadding = 0.1f;    // the range is a frame old: widen it by this fraction each way
+        uint32_t stepsPerOctave = 8;    // snap the range to a log grid so splits do not change every frame
+    };
+
+    // Sample distribution shadow maps: cascade partitions fitted to the depth
+    // range actually on screen instead of the whole near..far range. Plain
+    // math; the reduction here is the reference for the GPU one.
+    class DepthReduction
+    {
+    public:
+        // View depth of a depth buffer value from XMMatrixPerspectiveFovLH
+        static float LinearizeDepth(float deviceDepth, float nearZ, float farZ);
+
+        // Min/max view depth of every sample short of the far plane (1.0 is the clear value)
+        static DepthRange Reduce(const float* deviceDepth, uint32_t width, uint32_t height, float nearZ, float farZ);
+
+        // Partitions over the visible range, padded and snapped and kept
+        // within nearZ..farZ. Without a valid range they cover all of it.
+        static void ComputePartitions(const DepthRange& visible, float nearZ, float farZ, const SdsmSettings& settings,
+            uint32_t count, ShadowPartition* outPartitions);
+    };
+
+} // namespace Engine::Graphics
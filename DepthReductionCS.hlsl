@@ -0,0 +1,49 @@
+// SDSM depth reduction: min/max device depth of every sample short of the far
+// plane. Each 16x16 group reduces in shared memory, then issues one atomic.
+// Result[0] holds the min and Result[1] the complement of the max, both as
+// uints: positive floats order like their bits, and the complement lets both
+// use InterlockedMin from a single 0xFFFFFFFF clear.
+// DepthReduction::Reduce is the CPU reference.
+Texture2D<float> Depth : register(t0);
+RWBuffer<uint> Result : register(u0);
+
+#define GROUP_SIZE 16
+#define GROUP_THREADS (GROUP_SIZE * GROUP_SIZE)
+
+groupshared float s_minDepth[GROUP_THREADS];
+groupshared float s_maxDepth[GROUP_THREADS];
+
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void main(uint3 id : SV_DispatchThreadID, uint index : SV_GroupIndex)
+{
+    uint width, height;
+    Depth.GetDimensions(width, height);
+
+    float depth = 1.0f;
+    if (id.x < width && id.y < height)
+        depth = Depth.Load(int3(id.xy, 0));
+
+    // Sky (the clear value) and texels past the edge take no part
+    bool covered = depth < 1.0f;
+    s_minDepth[index] = covered ? depth : 1.0f;
+    s_maxDepth[index] = covered ? depth : 0.0f;
+    GroupMemoryBarrierWithGroupSync();
+
+    [unroll]
+    for (uint stride = GROUP_THREADS / 2; stride > 0; stride >>= 1)
+    {
+        if (index < stride)
+        {
+            s_minDepth[index] = min(s_minDepth[index], s_minDepth[index + stride]);
+            s_maxDepth[index] = max(s_maxDepth[index], s_maxDepth[index + stride]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (index == 0 && s_minDepth[0] < 1.0f)
+    {
+        uint previous;
+        InterlockedMin(Result[0], asuint(s_minDepth[0]), previous);
+        InterlockedMin(Result[1], ~asuint(s_maxDepth[0]), previous);
+    }
+}
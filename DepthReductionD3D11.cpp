@@ -0,0 +1,100 @@
+#include "DepthReductionD3D11.h"
+#include "ShaderCache.h"
+
+#include <cstring>
+
+using namespace Engine::Graphics;
+
+bool GpuDepthReduction::Create(ID3D11Device* device, const ShaderCompileResult& computeShader)
+{
+    if (!computeShader.success ||
+        FAILED(device->CreateComputeShader(computeShader.bytecode.data(), computeShader.bytecode.size(), nullptr,
+            m_shader.GetAddressOf())))
+        return false;
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = 2 * sizeof(uint32_t);
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+    if (FAILED(device->CreateBuffer(&desc, nullptr, m_result.GetAddressOf())))
+        return false;
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R32_UINT;
+    uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.NumElements = 2;
+    if (FAILED(device->CreateUnorderedAccessView(m_result.Get(), &uavDesc, m_resultUAV.GetAddressOf())))
+        return false;
+
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    for (Slot& slot : m_slots)
+    {
+        if (FAILED(device->CreateBuffer(&desc, nullptr, slot.staging.GetAddressOf())))
+            return false;
+    }
+    return true;
+}
+
+void GpuDepthReduction::Dispatch(ID3D11DeviceContext* context, ID3D11ShaderResourceView* depth, uint32_t width, uint32_t height)
+{
+    Slot& slot = m_slots[m_next];
+    if (slot.pending || !depth)
+        return;
+
+    const UINT clear[4] = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF };
+    context->ClearUnorderedAccessViewUint(m_resultUAV.Get(), clear);
+
+    context->CSSetShader(m_shader.Get(), nullptr, 0);
+    context->CSSetShaderResources(0, 1, &depth);
+    context->CSSetUnorderedAccessViews(0, 1, m_resultUAV.GetAddressOf(), nullptr);
+    context->Dispatch((width + 15) / 16, (height + 15) / 16, 1);
+
+    // Leave nothing bound that the next frame writes as a depth target
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    context->CSSetShaderResources(0, 1, &nullSRV);
+    context->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    context->CSSetShader(nullptr, nullptr, 0);
+
+    context->CopyResource(slot.staging.Get(), m_result.Get());
+    slot.pending = true;
+    m_next = (m_next + 1) % LATENCY;
+}
+
+bool GpuDepthReduction::Collect(ID3D11DeviceContext* context, float nearZ, float farZ, DepthRange& outRange)
+{
+    bool collected = false;
+    while (m_slots[m_oldest].pending)
+    {
+        Slot& slot = m_slots[m_oldest];
+
+        // DXGI_ERROR_WAS_STILL_DRAWING until the copy landed; never stall for it
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+        if (FAILED(context->Map(slot.staging.Get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped)))
+            break;
+
+        uint32_t words[2];
+        memcpy(words, mapped.pData, sizeof(words));
+        context->Unmap(slot.staging.Get(), 0);
+
+        DepthRange range;
+        if (words[0] != 0xFFFFFFFF)
+        {
+            uint32_t maxBits = ~words[1];
+            float minDepth, maxDepth;
+            memcpy(&minDepth, &words[0], sizeof(float));
+            memcpy(&maxDepth, &maxBits, sizeof(float));
+            range.minZ = DepthReduction::LinearizeDepth(minDepth, nearZ, farZ);
+            range.maxZ = DepthReduction::LinearizeDepth(maxDepth, nearZ, farZ);
+            range.valid = true;
+        }
+
+        outRange = range;
+        collected = true;
+        slot.pending = false;
+        m_oldest = (m_oldest + 1) % LATENCY;
+    }
+    return collected;
+}
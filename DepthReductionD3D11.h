@@ -0,0 +1,45 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include "DepthReduction.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    struct ShaderCompileResult;
+
+    // GPU side of the SDSM reduction (DepthReductionCS.hlsl). The two result
+    // words are copied to a ring of staging buffers and read back a frame or
+    // more later, so the CPU never waits on the GPU.
+    class GpuDepthReduction
+    {
+    public:
+        static const uint32_t LATENCY = 3;
+
+        bool Create(ID3D11Device* device, const ShaderCompileResult& computeShader);
+
+        // depth must not be bound as a depth target. Skipped while every staging buffer is in flight.
+        void Dispatch(ID3D11DeviceContext* context, ID3D11ShaderResourceView* depth, uint32_t width, uint32_t height);
+
+        // Newest finished result, linearized. False (and outRange untouched) when none finished since the last call.
+        bool Collect(ID3D11DeviceContext* context, float nearZ, float farZ, DepthRange& outRange);
+
+    private:
+        struct Slot
+        {
+            ComPtr<ID3D11Buffer> staging;
+            bool pending = false;
+        };
+
+        ComPtr<ID3D11ComputeShader> m_shader;
+        ComPtr<ID3D11Buffer> m_result;
+        ComPtr<ID3D11UnorderedAccessView> m_resultUAV;
+        Slot m_slots[LATENCY];
+        uint32_t m_next = 0;
+        uint32_t m_oldest = 0;
+    };
+
+} // namespace Engine::Graphics
@@ -77,6 +77,7 @@ bool DeviceResources::CreateWindowSizeDependentResources(int width, int height)
 {
     m_rtv.Reset();
     m_dsv.Reset();
+    m_depthSRV.Reset();
     m_depthBuffer.Reset();
     m_backBuffer.Reset();
 
@@ -100,9 +101,10 @@ bool DeviceResources::CreateWindowSizeDependentResources(int width, int height)
     depthDesc.Height = height;
     depthDesc.MipLevels = 1;
     depthDesc.ArraySize = 1;
-    depthDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    // Typeless so the depth can also be read, e.g. by the SDSM reduction
+    depthDesc.Format = DXGI_FORMAT_R24G8_TYPELESS;
     depthDesc.SampleDesc.Count = 1;
-    depthDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+    depthDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
 
     hr = m_device->CreateTexture2D(&depthDesc, nullptr, m_depthBuffer.GetAddressOf());
     if (FAILED(hr))
@@ -110,7 +112,20 @@ bool DeviceResources::CreateWindowSizeDependentResources(int width, int height)
         return false;
     }
 
-    hr = m_device->CreateDepthStencilView(m_depthBuffer.Get(), nullptr, m_dsv.GetAddressOf());
+    D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+    dsvDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    hr = m_device->CreateDepthStencilView(m_depthBuffer.Get(), &dsvDesc, m_dsv.GetAddressOf());
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = 1;
+    hr = m_device->CreateShaderResourceView(m_depthBuffer.Get(), &srvDesc, m_depthSRV.GetAddressOf());
     if (FAILED(hr))
     {
         return false;
@@ -140,6 +155,7 @@ void DeviceResources::Resize(int width, int height)
     m_context->OMSetRenderTargets(0, nullptr, nullptr);
     m_rtv.Reset();
     m_dsv.Reset();
+    m_depthSRV.Reset();
     m_depthBuffer.Reset();
     m_backBuffer.Reset();
 
@@ -20,6 +20,7 @@ namespace Engine::Graphics
         ID3D11DeviceContext* GetDeviceContext() const { return m_context.Get(); }
         ID3D11RenderTargetView* GetRenderTargetView() const { return m_rtv.Get(); }
         ID3D11DepthStencilView* GetDepthStencilView() const { return m_dsv.Get(); }
+        ID3D11ShaderResourceView* GetDepthSRV() const { return m_depthSRV.Get(); }   // depth as R24 unorm, unbind the DSV first
 		float GetAspectRatio() const { return static_cast<float>(m_width) / static_cast<float>(m_height); }
 		float GetWidth() const { return static_cast<float>(m_width); }
 		float GetHeight() const { return static_cast<float>(m_height); }
@@ -34,6 +35,7 @@ namespace Engine::Graphics
 
         Microsoft::WRL::ComPtr<ID3D11Texture2D> m_depthBuffer;
         Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_dsv;
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_depthSRV;
 
         HWND m_hwnd = nullptr;
         int m_width = 0;
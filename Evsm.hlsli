@@ -0,0 +1,65 @@
+// Exponential variance shadow maps: depth warped by exp(c * d) and
+// -exp(-c * d), filtered as moments, shadowed by the Chebyshev upper bound.
+// Same math as ShadowMoments.cpp, which has the tests.
+#ifndef EVSM_HLSLI
+#define EVSM_HLSLI
+
+#define EVSM_MAX_EXPONENT 42.0f   // exp(2 * c) must stay a finite float
+#define EVSM_MAX_BLUR_RADIUS 7
+
+// Prefilter passes (EvsmConvertPS, EvsmBlurPS)
+cbuffer CBEvsm : register(b4)
+{
+    float4 EvsmExponents;       // x = positive, y = negative, already clamped
+    float4 EvsmBlurWeights[2];  // weight of offset +-i is EvsmBlurWeights[i / 4][i % 4]
+    uint4 EvsmBlurParams;       // x = cascade slice, y = radius in moment texels
+};
+
+float GetEvsmBlurWeight(int offset)
+{
+    uint i = (uint)abs(offset);
+    return EvsmBlurWeights[i >> 2][i & 3];
+}
+
+// exponents: x = positive, y = negative. Depth in 0..1 goes to -1..1 first.
+float2 WarpDepth(float depth, float2 exponents)
+{
+    float d = 2.0f * depth - 1.0f;
+    return float2(exp(exponents.x * d), -exp(-exponents.y * d));
+}
+
+float4 ComputeMoments(float depth, float2 exponents)
+{
+    float2 warped = WarpDepth(depth, exponents);
+    return float4(warped.x, warped.x * warped.x, warped.y, warped.y * warped.y);
+}
+
+float ChebyshevUpperBound(float2 moments, float value, float minVariance)
+{
+    if (value <= moments.x)
+        return 1.0f;
+
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float distance = value - moments.x;
+    return variance / (variance + distance * distance);
+}
+
+float ReduceLightBleeding(float pMax, float amount)
+{
+    return saturate((pMax - amount) / max(1.0f - amount, 1e-4f));
+}
+
+// params: x = positive exponent, y = negative exponent, z = light bleeding reduction, w = min variance
+float ComputeEvsmShadow(float4 moments, float depth, float4 params)
+{
+    float2 warped = WarpDepth(depth, params.xy);
+
+    // The warp's slope at the receiver turns a depth variance into a warped one
+    float2 scale = params.xy * warped;
+    float positiveBound = ChebyshevUpperBound(moments.xy, warped.x, params.w * scale.x * scale.x);
+    float negativeBound = ChebyshevUpperBound(moments.zw, warped.y, params.w * scale.y * scale.y);
+
+    return ReduceLightBleeding(min(positiveBound, negativeBound), params.z);
+}
+
+#endif // EVSM_HLSLI
@@ -0,0 +1,28 @@
+// EVSM prefilter, second pass: vertical blur of the moments EvsmConvertPS
+// wrote, into the cascade's slice of the moment array (mip 0)
+#include "Evsm.hlsli"
+
+Texture2D<float4> Moments : register(t0);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float2 uv : TEXCOORD;
+};
+
+float4 main(PSInput input) : SV_TARGET
+{
+    uint width, height;
+    Moments.GetDimensions(width, height);
+
+    int2 texel = int2(input.position.xy);
+    int radius = (int)EvsmBlurParams.y;
+
+    float4 moments = 0.0f;
+    for (int i = -radius; i <= radius; ++i)
+    {
+        int y = clamp(texel.y + i, 0, (int)height - 1);
+        moments += GetEvsmBlurWeight(i) * Moments.Load(int3(texel.x, y, 0));
+    }
+    return moments;
+}
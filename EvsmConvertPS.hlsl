@@ -0,0 +1,39 @@
+// EVSM prefilter, first pass: each moment texel resolves the 2x2 shadow map
+// texels under it into moments and blurs them horizontally. The moment map is
+// half the shadow map size, so this is the only pass that reads depth.
+#include "Evsm.hlsli"
+
+Texture2DArray<float> ShadowDepth : register(t0);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float2 uv : TEXCOORD;
+};
+
+float4 main(PSInput input) : SV_TARGET
+{
+    uint width, height, slices;
+    ShadowDepth.GetDimensions(width, height, slices);
+
+    int2 texel = int2(input.position.xy);
+    int radius = (int)EvsmBlurParams.y;
+    int slice = (int)EvsmBlurParams.x;
+    int sourceY = texel.y * 2;
+
+    float4 moments = 0.0f;
+    for (int i = -radius; i <= radius; ++i)
+    {
+        // Clamp to the edge: the border is not 1.0 here, it is the nearest caster
+        int sourceX = clamp((texel.x + i) * 2, 0, (int)width - 2);
+
+        float4 resolved =
+            ComputeMoments(ShadowDepth.Load(int4(sourceX, sourceY, slice, 0)), EvsmExponents.xy) +
+            ComputeMoments(ShadowDepth.Load(int4(sourceX + 1, sourceY, slice, 0)), EvsmExponents.xy) +
+            ComputeMoments(ShadowDepth.Load(int4(sourceX, sourceY + 1, slice, 0)), EvsmExponents.xy) +
+            ComputeMoments(ShadowDepth.Load(int4(sourceX + 1, sourceY + 1, slice, 0)), EvsmExponents.xy);
+
+        moments += GetEvsmBlurWeight(i) * 0.25f * resolved;
+    }
+    return moments;
+}
@@ -0,0 +1,268 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace Engine::Core;
+
+#if defined(_WIN32)
+
+// -----------------------------
+// ReadDirectoryChangesW backend
+// -----------------------------
+namespace
+{
+    struct DirectoryWatch
+    {
+        std::filesystem::path directory;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped = {};
+        bool pending = false;
+        alignas(DWORD) uint8_t buffer[16 * 1024];
+    };
+
+    const DWORD WATCH_FILTER = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+
+    void Issue(DirectoryWatch& watch)
+    {
+        HANDLE event = watch.overlapped.hEvent;
+        memset(&watch.overlapped, 0, sizeof(watch.overlapped));
+        watch.overlapped.hEvent = event;
+
+        watch.pending = ReadDirectoryChangesW(watch.handle, watch.buffer, sizeof(watch.buffer), FALSE, WATCH_FILTER,
+            nullptr, &watch.overlapped, nullptr) != FALSE;
+    }
+}
+
+struct FileWatcher::Platform
+{
+    std::vector<std::unique_ptr<DirectoryWatch>> watches;
+};
+
+FileWatcher::FileWatcher()
+    : m_platform(new Platform())
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    for (auto& watch : m_platform->watches)
+    {
+        // The kernel writes into the buffer until the read is cancelled
+        if (watch->pending)
+        {
+            DWORD bytes = 0;
+            CancelIoEx(watch->handle, &watch->overlapped);
+            GetOverlappedResult(watch->handle, &watch->overlapped, &bytes, TRUE);
+        }
+        CloseHandle(watch->overlapped.hEvent);
+        CloseHandle(watch->handle);
+    }
+    delete m_platform;
+}
+
+bool FileWatcher::Watch(const std::filesystem::path& directory)
+{
+    std::filesystem::path dir = Normalize(directory);
+    if (IsWatching(dir))
+        return true;
+
+    auto watch = std::make_unique<DirectoryWatch>();
+    watch->directory = dir;
+    watch->handle = CreateFileW(dir.wstring().c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (watch->handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    watch->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    Issue(*watch);
+    if (!watch->pending)
+    {
+        CloseHandle(watch->overlapped.hEvent);
+        CloseHandle(watch->handle);
+        return false;
+    }
+
+    m_platform->watches.push_back(std::move(watch));
+    m_directories.push_back(dir);
+    return true;
+}
+
+void FileWatcher::ReadEvents(std::vector<std::filesystem::path>& outRaw)
+{
+    for (auto& watch : m_platform->watches)
+    {
+        if (!watch->pending)
+        {
+            Issue(*watch);
+            continue;
+        }
+
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(watch->handle, &watch->overlapped, &bytes, FALSE))
+        {
+            if (GetLastError() == ERROR_IO_INCOMPLETE)
+                continue;
+
+            // Directory gone or the read failed, report it and try again next poll
+            watch->pending = false;
+            outRaw.push_back(watch->directory);
+            continue;
+        }
+
+        // Zero bytes means the buffer overflowed and the events were dropped
+        if (bytes == 0)
+            outRaw.push_back(watch->directory);
+
+        size_t offset = 0;
+        while (bytes > 0)
+        {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(watch->buffer + offset);
+            outRaw.push_back(watch->directory / std::wstring(info->FileName, info->FileNameLength / sizeof(wchar_t)));
+
+            if (info->NextEntryOffset == 0)
+                break;
+            offset += info->NextEntryOffset;
+        }
+
+        Issue(*watch);
+    }
+}
+
+#else
+
+// -----------------------------
+// inotify backend
+// -----------------------------
+struct FileWatcher::Platform
+{
+    int fd = -1;
+    std::unordered_map<int, std::filesystem::path> directories;   // watch descriptor -> directory
+};
+
+FileWatcher::FileWatcher()
+    : m_platform(new Platform())
+{
+    m_platform->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (m_platform->fd >= 0)
+        close(m_platform->fd);
+    delete m_platform;
+}
+
+bool FileWatcher::Watch(const std::filesystem::path& directory)
+{
+    std::filesystem::path dir = Normalize(directory);
+    if (IsWatching(dir))
+        return true;
+    if (m_platform->fd < 0)
+        return false;
+
+    int wd = inotify_add_watch(m_platform->fd, dir.c_str(),
+        IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM);
+    if (wd < 0)
+        return false;
+
+    m_platform->directories[wd] = dir;
+    m_directories.push_back(dir);
+    return true;
+}
+
+void FileWatcher::ReadEvents(std::vector<std::filesystem::path>& outRaw)
+{
+    if (m_platform->fd < 0)
+        return;
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;)
+    {
+        ssize_t length = read(m_platform->fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                for (const std::filesystem::path& dir : m_directories)
+                    outRaw.push_back(dir);
+                continue;
+            }
+
+            auto it = m_platform->directories.find(event->wd);
+            if (it == m_platform->directories.end())
+                continue;
+
+            if (event->mask & IN_IGNORED)
+            {
+                // Directory deleted or unmounted, the watch is gone
+                outRaw.push_back(it->second);
+                m_directories.erase(std::remove(m_directories.begin(), m_directories.end(), it->second), m_directories.end());
+                m_platform->directories.erase(it);
+                continue;
+            }
+
+            if (event->len > 0)
+                outRaw.push_back(it->second / event->name);
+        }
+    }
+}
+
+#endif
+
+// -----------------------------
+// Portable part
+// -----------------------------
+std::filesystem::path FileWatcher::Normalize(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    std::filesystem::path result = std::filesystem::weakly_canonical(std::filesystem::absolute(path, ec), ec);
+    if (ec)
+        return std::filesystem::absolute(path, ec).lexically_normal();
+    return result;
+}
+
+bool FileWatcher::IsWatching(const std::filesystem::path& directory) const
+{
+    std::filesystem::path dir = Normalize(directory);
+    return std::find(m_directories.begin(), m_directories.end(), dir) != m_directories.end();
+}
+
+void FileWatcher::Poll(std::vector<std::filesystem::path>& outChanged)
+{
+    auto now = std::chrono::steady_clock::now();
+
+    // Every event restarts the file's settle timer
+    std::vector<std::filesystem::path> raw;
+    ReadEvents(raw);
+    for (const std::filesystem::path& path : raw)
+        m_pending[path.wstring()] = now;
+
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (now - it->second >= m_settle)
+        {
+            outChanged.push_back(std::filesystem::path(it->first));
+            it = m_pending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
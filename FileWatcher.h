@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine::Core
+{
+    // Reports files that changed inside a set of watched directories
+    // (non-recursive). ReadDirectoryChangesW on Windows, inotify elsewhere.
+    // Editors save in several steps (truncate + write, temp file + rename),
+    // so a file is only reported once it has been quiet for the settle time.
+    // Single thread: Watch and Poll from the same thread.
+    class FileWatcher
+    {
+    public:
+        FileWatcher();
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // Watching the same directory twice is a no-op
+        bool Watch(const std::filesystem::path& directory);
+        bool IsWatching(const std::filesystem::path& directory) const;
+
+        // Non-blocking. Appends the settled changes since the last call, each
+        // once, as normalized absolute paths. When the OS drops events the
+        // directory itself is reported: treat it as "anything in here".
+        void Poll(std::vector<std::filesystem::path>& outChanged);
+
+        void SetSettleTime(std::chrono::milliseconds settle) { m_settle = settle; }
+
+        // Absolute and canonical (as far as the path exists), the form Poll
+        // reports, so dependency lists can be compared against it directly
+        static std::filesystem::path Normalize(const std::filesystem::path& path);
+
+    private:
+        struct Platform;
+        Platform* m_platform = nullptr;
+
+        std::vector<std::filesystem::path> m_directories;
+
+        std::unordered_map<std::wstring, std::chrono::steady_clock::time_point> m_pending;
+        std::chrono::milliseconds m_settle{ 100 };
+
+        void ReadEvents(std::vector<std::filesystem::path>& outRaw);
+    };
+
+} // namespace Engine::Core
@@ -0,0 +1,310 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const char* const PASS_NAMES[RENDER_PASS_COUNT + 1] =
+    {
+        "Frame", "Streaming", "Culling", "Shadow", "ShadowAtlas", "Prepass", "Main", "Deferred", "Debug", "All"
+    };
+
+    const char* const COUNTER_NAMES[FRAME_COUNTER_COUNT] =
+    {
+        "draws", "instances", "triangles", "vertices", "state_changes", "state_changes_elided",
+        "constant_bytes", "texture_bytes", "visible_objects", "culled_objects",
+        "gpu_ia_vertices", "gpu_ia_primitives", "gpu_vs_invocations", "gpu_rasterized_primitives",
+        "gpu_ps_invocations", "gpu_cs_invocations"
+    };
+
+    // Fits 6 columns: 999, 12.3K, 1.23M, 12.3G
+    std::string FormatCount(double value)
+    {
+        static const char* const suffixes[] = { "", "K", "M", "G" };
+        uint32_t scale = 0;
+        while (value >= 999.5 && scale < 3)
+        {
+            value /= 1000.0;
+            ++scale;
+        }
+
+        char text[16];
+        if (scale == 0)
+            snprintf(text, sizeof(text), "%.0f", value);
+        else
+            snprintf(text, sizeof(text), value < 9.995 ? "%.2f%s" : value < 99.95 ? "%.1f%s" : "%.0f%s", value, suffixes[scale]);
+        return text;
+    }
+}
+
+uint64_t FrameCounters::Get(RenderPassId pass, FrameCounter counter) const
+{
+    if (pass != RENDER_PASS_ALL)
+        return passes[pass].values[counter];
+
+    uint64_t sum = 0;
+    for (const PassCounters& p : passes)
+        sum += p.values[counter];
+    return sum;
+}
+
+FrameStats::FrameStats()
+    : m_history(FRAME_STATS_HISTORY)
+{
+}
+
+const char* FrameStats::GetPassName(RenderPassId pass)
+{
+    return pass <= RENDER_PASS_ALL ? PASS_NAMES[pass] : "?";
+}
+
+const char* FrameStats::GetCounterName(FrameCounter counter)
+{
+    return counter < FRAME_COUNTER_COUNT ? COUNTER_NAMES[counter] : "?";
+}
+
+void FrameStats::BeginFrame()
+{
+    m_current = FrameCounters();
+    m_current.frame = m_frame;
+    m_pass = RENDER_PASS_FRAME;
+    m_passesRun = 1u << RENDER_PASS_FRAME;
+
+    for (uint32_t p = 0; p < RENDER_PASS_COUNT; ++p)
+    {
+        if (m_pipelineValid[p])
+            SetPipelineCounters((RenderPassId)p, m_pipeline[p]);
+    }
+}
+
+void FrameStats::EndFrame()
+{
+    // A pass that stopped running reports no GPU work, whatever is still in flight for it
+    for (uint32_t p = 0; p < RENDER_PASS_COUNT; ++p)
+    {
+        if (m_passesRun & (1u << p))
+            continue;
+
+        m_pipelineValid[p] = false;
+        for (uint32_t c = FRAME_COUNTER_GPU_IA_VERTICES; c < FRAME_COUNTER_COUNT; ++c)
+            m_current.passes[p].values[c] = 0;
+    }
+
+    m_history[m_next] = m_current;
+    m_next = (m_next + 1) % FRAME_STATS_HISTORY;
+    m_count = (std::min)(m_count + 1, FRAME_STATS_HISTORY);
+    ++m_frame;
+}
+
+void FrameStats::CountDraw(uint32_t vertexCount, uint32_t instanceCount)
+{
+    Add(FRAME_COUNTER_DRAWS, 1);
+    Add(FRAME_COUNTER_INSTANCES, instanceCount);
+    Add(FRAME_COUNTER_VERTICES, (uint64_t)vertexCount * instanceCount);
+    Add(FRAME_COUNTER_TRIANGLES, (uint64_t)(vertexCount / 3) * instanceCount);
+}
+
+void FrameStats::CountStripDraw(uint32_t vertexCount)
+{
+    Add(FRAME_COUNTER_DRAWS, 1);
+    Add(FRAME_COUNTER_INSTANCES, 1);
+    Add(FRAME_COUNTER_VERTICES, vertexCount);
+    Add(FRAME_COUNTER_TRIANGLES, vertexCount > 2 ? vertexCount - 2 : 0);
+}
+
+void FrameStats::SetPipelineCounters(RenderPassId pass, const PipelineCounters& counters)
+{
+    m_pipeline[pass] = counters;
+    m_pipelineValid[pass] = true;
+
+    uint64_t* values = m_current.passes[pass].values;
+    values[FRAME_COUNTER_GPU_IA_VERTICES] = counters.iaVertices;
+    values[FRAME_COUNTER_GPU_IA_PRIMITIVES] = counters.iaPrimitives;
+    values[FRAME_COUNTER_GPU_VS_INVOCATIONS] = counters.vsInvocations;
+    values[FRAME_COUNTER_GPU_RASTERIZED_PRIMITIVES] = counters.rasterizedPrimitives;
+    values[FRAME_COUNTER_GPU_PS_INVOCATIONS] = counters.psInvocations;
+    values[FRAME_COUNTER_GPU_CS_INVOCATIONS] = counters.csInvocations;
+}
+
+const FrameCounters& FrameStats::GetFrame(uint32_t age) const
+{
+    return m_history[(m_next + FRAME_STATS_HISTORY - 1 - age) % FRAME_STATS_HISTORY];
+}
+
+const FrameCounters& FrameStats::GetLastFrame() const
+{
+    // An empty history holds default frames, all zero
+    return GetFrame(0);
+}
+
+FrameCounterSummary FrameStats::GetSummary(RenderPassId pass, FrameCounter counter) const
+{
+    FrameCounterSummary summary;
+    if (!m_count)
+        return summary;
+
+    double sum = 0.0;
+    summary.min = UINT64_MAX;
+    for (uint32_t age = 0; age < m_count; ++age)
+    {
+        uint64_t value = GetFrame(age).Get(pass, counter);
+        sum += (double)value;
+        summary.min = (std::min)(summary.min, value);
+        summary.max = (std::max)(summary.max, value);
+    }
+    summary.average = sum / m_count;
+    summary.last = GetFrame(0).Get(pass, counter);
+    return summary;
+}
+
+std::string FrameStats::WriteCsv() const
+{
+    std::string out = "frame,pass";
+    for (uint32_t c = 0; c < FRAME_COUNTER_COUNT; ++c)
+    {
+        out += ',';
+        out += COUNTER_NAMES[c];
+    }
+    out += '\n';
+
+    // Oldest first
+    for (uint32_t age = m_count; age-- > 0;)
+    {
+        const FrameCounters& frame = GetFrame(age);
+        for (uint32_t p = 0; p <= RENDER_PASS_ALL; ++p)
+        {
+            out += std::to_string(frame.frame);
+            out += ',';
+            out += PASS_NAMES[p];
+            for (uint32_t c = 0; c < FRAME_COUNTER_COUNT; ++c)
+            {
+                out += ',';
+                out += std::to_string(frame.Get((RenderPassId)p, (FrameCounter)c));
+            }
+            out += '\n';
+        }
+    }
+    return out;
+}
+
+std::string FrameStats::WriteJson() const
+{
+    std::string out = "{\n\"frames\":" + std::to_string(m_count) + ",\n\"counters\":[";
+    for (uint32_t c = 0; c < FRAME_COUNTER_COUNT; ++c)
+    {
+        out += c ? ",\"" : "\"";
+        out += COUNTER_NAMES[c];
+        out += '"';
+    }
+    out += "],\n\"summary\":{";
+
+    char line[160];
+    for (uint32_t p = 0; p <= RENDER_PASS_ALL; ++p)
+    {
+        out += p ? ",\n\"" : "\n\"";
+        out += PASS_NAMES[p];
+        out += "\":{";
+        for (uint32_t c = 0; c < FRAME_COUNTER_COUNT; ++c)
+        {
+            FrameCounterSummary summary = GetSummary((RenderPassId)p, (FrameCounter)c);
+            snprintf(line, sizeof(line), "%s\"%s\":{\"average\":%.3f,\"min\":%llu,\"max\":%llu,\"last\":%llu}",
+                c ? "," : "", COUNTER_NAMES[c], summary.average, (unsigned long long)summary.min,
+                (unsigned long long)summary.max, (unsigned long long)summary.last);
+            out += line;
+        }
+        out += '}';
+    }
+    out += "},\n\"history\":[";
+
+    // Oldest first, each pass an array in "counters" order
+    for (uint32_t age = m_count; age-- > 0;)
+    {
+        const FrameCounters& frame = GetFrame(age);
+        out += age + 1 == m_count ? "\n{\"frame\":" : ",\n{\"frame\":";
+        out += std::to_string(frame.frame);
+        for (uint32_t p = 0; p <= RENDER_PASS_ALL; ++p)
+        {
+            out += ",\"";
+            out += PASS_NAMES[p];
+            out += "\":[";
+            for (uint32_t c = 0; c < FRAME_COUNTER_COUNT; ++c)
+            {
+                if (c)
+                    out += ',';
+                out += std::to_string(frame.Get((RenderPassId)p, (FrameCounter)c));
+            }
+            out += ']';
+        }
+        out += '}';
+    }
+    out += "\n]\n}\n";
+    return out;
+}
+
+bool FrameStats::ExportCsv(const std::filesystem::path& path) const
+{
+    std::string csv = WriteCsv();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file.write(csv.data(), (std::streamsize)csv.size());
+    return (bool)file;
+}
+
+bool FrameStats::ExportJson(const std::filesystem::path& path) const
+{
+    std::string json = WriteJson();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file.write(json.data(), (std::streamsize)json.size());
+    return (bool)file;
+}
+
+std::vector<std::string> FrameStats::FormatOverlay() const
+{
+    std::vector<std::string> lines;
+    char line[128];
+    snprintf(line, sizeof(line), "FRAME STATS, AVERAGE OF %u FRAMES", m_count);
+    lines.push_back(line);
+    lines.push_back("PASS         DRAWS   TRIS  BINDS/SKIP  CB KB   VIS/CULL  GPU PRIM  PS INV");
+
+    auto pair = [](double a, double b) { return FormatCount(a) + "/" + FormatCount(b); };
+    for (uint32_t p = 0; p <= RENDER_PASS_ALL; ++p)
+    {
+        RenderPassId pass = (RenderPassId)p;
+        double average[FRAME_COUNTER_COUNT];
+        bool empty = true;
+        for (uint32_t c = 0; c < FRAME_COUNTER_COUNT; ++c)
+        {
+            average[c] = GetAverage(pass, (FrameCounter)c);
+            empty &= average[c] == 0.0;
+        }
+        if (empty && pass != RENDER_PASS_ALL)
+            continue;
+
+        snprintf(line, sizeof(line), "%-11s %6s %6s %11s %6s %10s %9s %7s", PASS_NAMES[p],
+            FormatCount(average[FRAME_COUNTER_DRAWS]).c_str(),
+            FormatCount(average[FRAME_COUNTER_TRIANGLES]).c_str(),
+            pair(average[FRAME_COUNTER_STATE_CHANGES], average[FRAME_COUNTER_STATE_CHANGES_ELIDED]).c_str(),
+            FormatCount(average[FRAME_COUNTER_CONSTANT_BYTES] / 1024.0).c_str(),
+            pair(average[FRAME_COUNTER_VISIBLE_OBJECTS], average[FRAME_COUNTER_CULLED_OBJECTS]).c_str(),
+            FormatCount(average[FRAME_COUNTER_GPU_RASTERIZED_PRIMITIVES]).c_str(),
+            FormatCount(average[FRAME_COUNTER_GPU_PS_INVOCATIONS]).c_str());
+        lines.push_back(line);
+    }
+
+    snprintf(line, sizeof(line), "INSTANCES %s  VERTICES %s  TEXTURE KB %s  GPU VS %s  CS %s",
+        FormatCount(GetAverage(RENDER_PASS_ALL, FRAME_COUNTER_INSTANCES)).c_str(),
+        FormatCount(GetAverage(RENDER_PASS_ALL, FRAME_COUNTER_VERTICES)).c_str(),
+        FormatCount(GetAverage(RENDER_PASS_ALL, FRAME_COUNTER_TEXTURE_BYTES) / 1024.0).c_str(),
+        FormatCount(GetAverage(RENDER_PASS_ALL, FRAME_COUNTER_GPU_VS_INVOCATIONS)).c_str(),
+        FormatCount(GetAverage(RENDER_PASS_ALL, FRAME_COUNTER_GPU_CS_INVOCATIONS)).c_str());
+    lines.push_back(line);
+    return lines;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Engine::Graphics
+{
+    // Frames the rolling averages and the dumps span
+    static constexpr uint32_t FRAME_STATS_HISTORY = 120;
+
+    // Where a counter is charged. Work outside the named passes (depth
+    // reduction, hot reload) lands in RENDER_PASS_FRAME.
+    enum RenderPassId : uint32_t
+    {
+        RENDER_PASS_FRAME = 0,
+        RENDER_PASS_STREAMING,      // texture uploads of the streamer
+        RENDER_PASS_CULLING,        // occlusion buffer, GPU-driven batch upload
+        RENDER_PASS_SHADOW,         // cascades and their cull dispatch, EVSM moments
+        RENDER_PASS_SHADOW_ATLAS,
+        RENDER_PASS_PREPASS,
+        RENDER_PASS_MAIN,           // forward shading, the GPU-driven late cull and Hi-Z build
+        RENDER_PASS_DEFERRED,
+        RENDER_PASS_DEBUG,          // shadow map view and the stats overlay
+        RENDER_PASS_COUNT,
+        RENDER_PASS_ALL = RENDER_PASS_COUNT     // every pass summed, for the queries below
+    };
+
+    enum FrameCounter : uint32_t
+    {
+        // Submitted by the CPU. Indirect draws count as draws only: their
+        // instances and triangles are known on the GPU, see the pipeline counters.
+        FRAME_COUNTER_DRAWS = 0,
+        FRAME_COUNTER_INSTANCES,
+        FRAME_COUNTER_TRIANGLES,
+        FRAME_COUNTER_VERTICES,             // indices for indexed draws
+        FRAME_COUNTER_STATE_CHANGES,        // per-draw binds issued: pixel shader, material textures
+        FRAME_COUNTER_STATE_CHANGES_ELIDED, // the same binds skipped, already bound
+        FRAME_COUNTER_CONSTANT_BYTES,       // written into mapped constant buffers
+        FRAME_COUNTER_TEXTURE_BYTES,        // streamed mips uploaded
+        FRAME_COUNTER_VISIBLE_OBJECTS,      // object-view pairs drawn
+        FRAME_COUNTER_CULLED_OBJECTS,       // object-view pairs rejected before submission
+
+        // D3D11_QUERY_PIPELINE_STATISTICS, the newest result of the pass: a
+        // few frames old, held until the next one arrives while the pass runs
+        FRAME_COUNTER_GPU_IA_VERTICES,
+        FRAME_COUNTER_GPU_IA_PRIMITIVES,
+        FRAME_COUNTER_GPU_VS_INVOCATIONS,
+        FRAME_COUNTER_GPU_RASTERIZED_PRIMITIVES,
+        FRAME_COUNTER_GPU_PS_INVOCATIONS,
+        FRAME_COUNTER_GPU_CS_INVOCATIONS,
+
+        FRAME_COUNTER_COUNT
+    };
+
+    // The pipeline statistics FrameStats keeps, API independent
+    struct PipelineCounters
+    {
+        uint64_t iaVertices = 0;
+        uint64_t iaPrimitives = 0;
+        uint64_t vsInvocations = 0;
+        uint64_t rasterizedPrimitives = 0;  // CPrimitives: out of the clipper
+        uint64_t psInvocations = 0;
+        uint64_t csInvocations = 0;
+    };
+
+    struct PassCounters
+    {
+        uint64_t values[FRAME_COUNTER_COUNT] = {};
+    };
+
+    struct FrameCounters
+    {
+        uint64_t frame = 0;
+        PassCounters passes[RENDER_PASS_COUNT];
+
+        uint64_t Get(RenderPassId pass, FrameCounter counter) const;
+    };
+
+    // One counter of one pass over the history
+    struct FrameCounterSummary
+    {
+        double average = 0.0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        uint64_t last = 0;
+    };
+
+    // Per-frame, per-pass render counters. The renderer charges everything it
+    // submits to the current pass; EndFrame moves the frame into a ring of the
+    // last FRAME_STATS_HISTORY frames, which the averages, the overlay text and
+    // the CSV/JSON dumps read. Main thread only.
+    class FrameStats
+    {
+    public:
+        FrameStats();
+
+        static const char* GetPassName(RenderPassId pass);
+        static const char* GetCounterName(FrameCounter counter);
+
+        // Clears the frame being recorded, RENDER_PASS_FRAME current
+        void BeginFrame();
+        void EndFrame();
+
+        void SetPass(RenderPassId pass)
+        {
+            m_pass = pass;
+            m_passesRun |= 1u << pass;
+        }
+        RenderPassId GetPass() const { return m_pass; }
+
+        void Add(FrameCounter counter, uint64_t value) { m_current.passes[m_pass].values[counter] += value; }
+        void Add(RenderPassId pass, FrameCounter counter, uint64_t value) { m_current.passes[pass].values[counter] += value; }
+
+        // Triangle lists, vertexCount indices per instance for indexed draws
+        void CountDraw(uint32_t vertexCount, uint32_t instanceCount = 1);
+        void CountStripDraw(uint32_t vertexCount);
+        void CountIndirectDraw() { Add(FRAME_COUNTER_DRAWS, 1); }
+
+        // A per-draw bind, issued or skipped because it was bound already
+        void CountBind(bool issued) { Add(issued ? FRAME_COUNTER_STATE_CHANGES : FRAME_COUNTER_STATE_CHANGES_ELIDED, 1); }
+
+        // Newest pipeline statistics of the pass, reported every frame it runs until replaced
+        void SetPipelineCounters(RenderPassId pass, const PipelineCounters& counters);
+
+        // Last finished frame, and frames in the history
+        const FrameCounters& GetLastFrame() const;
+        uint32_t GetFrameCount() const { return m_count; }
+
+        // Over the history; RENDER_PASS_ALL sums the passes of each frame first
+        FrameCounterSummary GetSummary(RenderPassId pass, FrameCounter counter) const;
+        double GetAverage(RenderPassId pass, FrameCounter counter) const { return GetSummary(pass, counter).average; }
+
+        // One row per frame and pass, "All" rows included
+        std::string WriteCsv() const;
+
+        // Summaries per pass and counter, then every frame of the history
+        std::string WriteJson() const;
+
+        bool ExportCsv(const std::filesystem::path& path) const;
+        bool ExportJson(const std::filesystem::path& path) const;
+
+        // Compact table of the averages for the on-screen overlay, passes with no work left out
+        std::vector<std::string> FormatOverlay() const;
+
+    private:
+        FrameCounters m_current;
+        RenderPassId m_pass = RENDER_PASS_FRAME;
+        PipelineCounters m_pipeline[RENDER_PASS_COUNT];
+        bool m_pipelineValid[RENDER_PASS_COUNT] = {};
+        uint32_t m_passesRun = 0;               // bit per pass made current this frame
+        uint64_t m_frame = 0;
+
+        std::vector<FrameCounters> m_history;   // ring of FRAME_STATS_HISTORY
+        uint32_t m_next = 0;
+        uint32_t m_count = 0;
+
+        const FrameCounters& GetFrame(uint32_t age) const;     // 0: the newest
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,21 @@
+// Fullscreen quad (the renderer's POSITION/TEXCOORD quad) at the far plane:
+// with a GREATER depth test only pixels that have geometry are shaded
+struct VSInput
+{
+    float3 position : POSITION;
+    float2 uv : TEXCOORD;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+    float2 uv : TEXCOORD;
+};
+
+VSOutput main(VSInput input)
+{
+    VSOutput output;
+    output.position = float4(input.position.xy, 1.0f, 1.0f);
+    output.uv = input.uv;
+    return output;
+}
@@ -0,0 +1,48 @@
+// G-buffer layout, mirrored on the CPU by GBufferPacking.h:
+//   RT0  R8G8B8A8_UNORM_SRGB   albedo.rgb (sRGB encoded by the RTV), roughness in linear alpha
+//   RT1  R16G16_UNORM          octahedral normal
+//   depth D32_FLOAT            read back as R32_FLOAT to rebuild the position
+#ifndef GBUFFER_HLSLI
+#define GBUFFER_HLSLI
+
+struct GBufferOutput
+{
+    float4 albedoRoughness : SV_Target0;
+    float2 normal : SV_Target1;
+};
+
+// ----------------------------------------------------
+// OCTAHEDRAL NORMALS
+// The unit sphere folded onto the |x|+|y|+|z| = 1 octahedron, the lower
+// half flipped over the diagonals, mapped to [0,1]^2
+// ----------------------------------------------------
+float2 OctahedralWrap(float2 v)
+{
+    return (1.0f - abs(v.yx)) * (v >= 0.0f ? 1.0f : -1.0f);
+}
+
+float2 EncodeOctahedral(float3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    float2 e = n.z >= 0.0f ? n.xy : OctahedralWrap(n.xy);
+    return e * 0.5f + 0.5f;
+}
+
+float3 DecodeOctahedral(float2 e)
+{
+    e = e * 2.0f - 1.0f;
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+GBufferOutput PackGBuffer(float3 albedo, float3 N, float roughness)
+{
+    GBufferOutput output;
+    output.albedoRoughness = float4(albedo, roughness);
+    output.normal = EncodeOctahedral(N);
+    return output;
+}
+
+#endif // GBUFFER_HLSLI
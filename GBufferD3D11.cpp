@@ -0,0 +1,116 @@
+#include "GBufferD3D11.h"
+
+using namespace Engine::Graphics;
+
+bool GBuffer::CreateTarget(ID3D11Device* device, DXGI_FORMAT format, Target& target)
+{
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = m_width;
+    desc.Height = m_height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+    if (FAILED(device->CreateTexture2D(&desc, nullptr, target.texture.GetAddressOf())))
+        return false;
+    if (FAILED(device->CreateRenderTargetView(target.texture.Get(), nullptr, target.rtv.GetAddressOf())))
+        return false;
+    return SUCCEEDED(device->CreateShaderResourceView(target.texture.Get(), nullptr, target.srv.GetAddressOf()));
+}
+
+bool GBuffer::CreateDepth(ID3D11Device* device)
+{
+    // Typeless so the same texture is a D32 depth target and an R32 float input
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = m_width;
+    desc.Height = m_height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R32_TYPELESS;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+
+    if (FAILED(device->CreateTexture2D(&desc, nullptr, m_depth.GetAddressOf())))
+        return false;
+
+    D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+    dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    if (FAILED(device->CreateDepthStencilView(m_depth.Get(), &dsvDesc, m_depthDSV.GetAddressOf())))
+        return false;
+
+    // Bound together with the SRV during the light pass
+    dsvDesc.Flags = D3D11_DSV_READ_ONLY_DEPTH;
+    if (FAILED(device->CreateDepthStencilView(m_depth.Get(), &dsvDesc, m_depthReadOnlyDSV.GetAddressOf())))
+        return false;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = 1;
+    return SUCCEEDED(device->CreateShaderResourceView(m_depth.Get(), &srvDesc, m_depthSRV.GetAddressOf()));
+}
+
+bool GBuffer::Resize(ID3D11Device* device, uint32_t width, uint32_t height)
+{
+    if (width == m_width && height == m_height && m_depth)
+        return true;
+
+    Release();
+    m_width = width;
+    m_height = height;
+
+    if (CreateTarget(device, ALBEDO_FORMAT, m_albedo) &&
+        CreateTarget(device, NORMAL_FORMAT, m_normal) &&
+        CreateTarget(device, LIGHT_FORMAT, m_light) &&
+        CreateDepth(device))
+        return true;
+
+    Release();
+    return false;
+}
+
+void GBuffer::BeginGeometryPass(ID3D11DeviceContext* context)
+{
+    UnbindInputs(context);
+
+    // No color clears: the light pass depth test skips every texel no geometry wrote
+    context->ClearDepthStencilView(m_depthDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+    ID3D11RenderTargetView* targets[2] = { m_albedo.rtv.Get(), m_normal.rtv.Get() };
+    context->OMSetRenderTargets(2, targets, m_depthDSV.Get());
+}
+
+void GBuffer::BeginLightPass(ID3D11DeviceContext* context, const float clearColor[4])
+{
+    context->ClearRenderTargetView(m_light.rtv.Get(), clearColor);
+
+    ID3D11RenderTargetView* target = m_light.rtv.Get();
+    context->OMSetRenderTargets(1, &target, m_depthReadOnlyDSV.Get());
+
+    ID3D11ShaderResourceView* inputs[3] = { m_albedo.srv.Get(), m_normal.srv.Get(), m_depthSRV.Get() };
+    context->PSSetShaderResources(FIRST_SLOT, 3, inputs);
+}
+
+void GBuffer::UnbindInputs(ID3D11DeviceContext* context)
+{
+    ID3D11ShaderResourceView* nullSRVs[3] = { nullptr, nullptr, nullptr };
+    context->PSSetShaderResources(FIRST_SLOT, 3, nullSRVs);
+}
+
+void GBuffer::Release()
+{
+    m_albedo = Target();
+    m_normal = Target();
+    m_light = Target();
+    m_depth.Reset();
+    m_depthDSV.Reset();
+    m_depthReadOnlyDSV.Reset();
+    m_depthSRV.Reset();
+    m_width = 0;
+    m_height = 0;
+}
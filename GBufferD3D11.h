@@ -0,0 +1,65 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // Render targets of the deferred path, sized to the back buffer. The
+    // layout is documented in GBuffer.hlsli (12 bytes per pixel) plus an
+    // HDR light buffer the light pass accumulates into.
+    class GBuffer
+    {
+    public:
+        static const DXGI_FORMAT ALBEDO_FORMAT = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        static const DXGI_FORMAT NORMAL_FORMAT = DXGI_FORMAT_R16G16_UNORM;
+        static const DXGI_FORMAT LIGHT_FORMAT = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+        // Light pass inputs: t6 albedo/roughness, t7 normal, t8 depth
+        static const UINT FIRST_SLOT = 6;
+
+        // Recreates the targets when the size changed, no-op otherwise
+        bool Resize(ID3D11Device* device, uint32_t width, uint32_t height);
+
+        // Clears and binds albedo + normal + depth
+        void BeginGeometryPass(ID3D11DeviceContext* context);
+
+        // Binds the light buffer, cleared to clearColor so untouched (sky)
+        // pixels come out as the background, with the depth read-only for the
+        // light pass's depth test. The G-buffer goes to t6-t8.
+        void BeginLightPass(ID3D11DeviceContext* context, const float clearColor[4]);
+
+        // Drops the G-buffer views from the pixel stage before the targets are written again
+        void UnbindInputs(ID3D11DeviceContext* context);
+
+        ID3D11ShaderResourceView* GetLightSRV() const { return m_light.srv.Get(); }
+        ID3D11ShaderResourceView* GetDepthSRV() const { return m_depthSRV.Get(); }
+
+        void Release();
+
+    private:
+        struct Target
+        {
+            ComPtr<ID3D11Texture2D> texture;
+            ComPtr<ID3D11RenderTargetView> rtv;
+            ComPtr<ID3D11ShaderResourceView> srv;
+        };
+
+        Target m_albedo;
+        Target m_normal;
+        Target m_light;
+        ComPtr<ID3D11Texture2D> m_depth;
+        ComPtr<ID3D11DepthStencilView> m_depthDSV;
+        ComPtr<ID3D11DepthStencilView> m_depthReadOnlyDSV;
+        ComPtr<ID3D11ShaderResourceView> m_depthSRV;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+
+        bool CreateTarget(ID3D11Device* device, DXGI_FORMAT format, Target& target);
+        bool CreateDepth(ID3D11Device* device);
+    };
+
+} // namespace Engine::Graphics
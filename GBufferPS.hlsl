@@ -0,0 +1,10 @@
+// Deferred geometry pass: material only, lighting happens in DeferredLightPS.
+// Keywords: NORMAL_MAP, ALPHA_TEST (Surface.hlsli).
+#include "Surface.hlsli"
+#include "GBuffer.hlsli"
+
+GBufferOutput main(PSInput input)
+{
+    Surface surface = SampleSurface(input);
+    return PackGBuffer(surface.albedo, surface.N, surface.roughness);
+}
@@ -0,0 +1,103 @@
+#include "GBufferPacking.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    float Saturate(float v)
+    {
+        return (std::min)((std::max)(v, 0.0f), 1.0f);
+    }
+
+    // The HLSL ternary: v >= 0 ? 1 : -1, zero counts as positive
+    float SignNotZero(float v)
+    {
+        return v >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    uint8_t ToUnorm8(float v)
+    {
+        return (uint8_t)(Saturate(v) * 255.0f + 0.5f);
+    }
+
+    uint16_t ToUnorm16(float v)
+    {
+        return (uint16_t)(Saturate(v) * 65535.0f + 0.5f);
+    }
+}
+
+void GBufferPacking::EncodeOctahedral(const float n[3], float outEncoded[2])
+{
+    float invL1 = 1.0f / (fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]));
+    float x = n[0] * invL1;
+    float y = n[1] * invL1;
+
+    if (n[2] < 0.0f)
+    {
+        float wrappedX = (1.0f - fabsf(y)) * SignNotZero(x);
+        float wrappedY = (1.0f - fabsf(x)) * SignNotZero(y);
+        x = wrappedX;
+        y = wrappedY;
+    }
+
+    outEncoded[0] = x * 0.5f + 0.5f;
+    outEncoded[1] = y * 0.5f + 0.5f;
+}
+
+void GBufferPacking::DecodeOctahedral(const float encoded[2], float outN[3])
+{
+    float x = encoded[0] * 2.0f - 1.0f;
+    float y = encoded[1] * 2.0f - 1.0f;
+    float z = 1.0f - fabsf(x) - fabsf(y);
+
+    float t = Saturate(-z);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    float invLength = 1.0f / sqrtf(x * x + y * y + z * z);
+    outN[0] = x * invLength;
+    outN[1] = y * invLength;
+    outN[2] = z * invLength;
+}
+
+uint8_t GBufferPacking::LinearToSrgb8(float linear)
+{
+    float l = Saturate(linear);
+    float s = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+    return ToUnorm8(s);
+}
+
+float GBufferPacking::Srgb8ToLinear(uint8_t srgb)
+{
+    float s = srgb / 255.0f;
+    return s <= 0.04045f ? s / 12.92f : powf((s + 0.055f) / 1.055f, 2.4f);
+}
+
+GBufferTexel GBufferPacking::Pack(const GBufferSurface& surface)
+{
+    GBufferTexel texel;
+    for (int i = 0; i < 3; ++i)
+        texel.albedoRoughness[i] = LinearToSrgb8(surface.albedo[i]);
+    texel.albedoRoughness[3] = ToUnorm8(surface.roughness);
+
+    float encoded[2];
+    EncodeOctahedral(surface.normal, encoded);
+    texel.normal[0] = ToUnorm16(encoded[0]);
+    texel.normal[1] = ToUnorm16(encoded[1]);
+    return texel;
+}
+
+GBufferSurface GBufferPacking::Unpack(const GBufferTexel& texel)
+{
+    GBufferSurface surface;
+    for (int i = 0; i < 3; ++i)
+        surface.albedo[i] = Srgb8ToLinear(texel.albedoRoughness[i]);
+    surface.roughness = texel.albedoRoughness[3] / 255.0f;
+
+    float encoded[2] = { texel.normal[0] / 65535.0f, texel.normal[1] / 65535.0f };
+    DecodeOctahedral(encoded, surface.normal);
+    return surface;
+}
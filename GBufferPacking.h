@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine::Graphics
+{
+    // Surface attributes before packing, linear albedo and a unit normal
+    struct GBufferSurface
+    {
+        float albedo[3] = { 0.0f, 0.0f, 0.0f };
+        float normal[3] = { 0.0f, 0.0f, 1.0f };
+        float roughness = 0.0f;
+    };
+
+    // One texel as stored: RT0 R8G8B8A8_UNORM_SRGB, RT1 R16G16_UNORM
+    struct GBufferTexel
+    {
+        uint8_t albedoRoughness[4] = {};
+        uint16_t normal[2] = {};
+    };
+
+    // CPU mirror of GBuffer.hlsli, including what the render target formats
+    // do on write (sRGB encode, round to nearest) and on read. For tests and
+    // tools; keep it in step with the shader.
+    class GBufferPacking
+    {
+    public:
+        static GBufferTexel Pack(const GBufferSurface& surface);
+        static GBufferSurface Unpack(const GBufferTexel& texel);
+
+        // Unit vector to [0,1]^2 and back
+        static void EncodeOctahedral(const float n[3], float outEncoded[2]);
+        static void DecodeOctahedral(const float encoded[2], float outN[3]);
+
+        static uint8_t LinearToSrgb8(float linear);
+        static float Srgb8ToLinear(uint8_t srgb);
+    };
+
+} // namespace Engine::Graphics
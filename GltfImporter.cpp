@@ -0,0 +1,565 @@
+#include "GltfImporter.h"
+#include "GltfParser.h"
+#include "JobSystem.h"
+#include "AssetCache.h"
+
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // -----------------------------
+    // Accessor decoding
+    // -----------------------------
+    struct AccessorView
+    {
+        const uint8_t* data = nullptr;
+        size_t stride = 0;
+        size_t count = 0;
+        uint32_t componentType = 0;
+        uint32_t components = 0;
+    };
+
+    bool ResolveAccessor(const GltfRawDocument& doc, int index, AccessorView& out)
+    {
+        if (index < 0 || index >= (int)doc.accessors.size())
+            return false;
+
+        const GltfRawAccessor& a = doc.accessors[index];
+        if (a.bufferView < 0 || a.bufferView >= (int)doc.bufferViews.size())
+            return false; // sparse / zero-initialized accessors are not supported
+
+        const GltfRawBufferView& view = doc.bufferViews[a.bufferView];
+        if (view.buffer < 0 || view.buffer >= (int)doc.buffers.size())
+            return false;
+
+        const GltfRawBuffer& buffer = doc.buffers[view.buffer];
+        size_t elementSize = (size_t)GltfParser::GetComponentSize(a.componentType) * a.components;
+        if (elementSize == 0)
+            return false;
+
+        size_t stride = view.byteStride ? view.byteStride : elementSize;
+
+        // Bounds check: the last element must sit inside both the view and the buffer
+        if (view.byteOffset + view.byteLength > buffer.data.size())
+            return false;
+        if (a.count > 0 && a.byteOffset + (a.count - 1) * stride + elementSize > view.byteLength)
+            return false;
+
+        out.data = buffer.data.data() + view.byteOffset + a.byteOffset;
+        out.stride = stride;
+        out.count = a.count;
+        out.componentType = a.componentType;
+        out.components = a.components;
+        return true;
+    }
+
+    // Decodes N-component elements straight into a Vertex field with DirectXMath's
+    // SIMD loads (float or normalized integers), applying a per-component scale.
+    template <uint32_t N, typename LoadFn>
+    void DecodeInto(const AccessorView& src, LoadFn load, FXMVECTOR scale, Vertex* dst, size_t fieldOffset)
+    {
+        const uint8_t* in = src.data;
+        uint8_t* out = reinterpret_cast<uint8_t*>(dst) + fieldOffset;
+
+        for (size_t i = 0; i < src.count; ++i, in += src.stride, out += sizeof(Vertex))
+        {
+            XMVECTOR v = XMVectorMultiply(load(in), scale);
+            if constexpr (N == 3)
+                XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(out), v);
+            else
+                XMStoreFloat2(reinterpret_cast<XMFLOAT2*>(out), v);
+        }
+    }
+
+    bool DecodeVec3(const AccessorView& src, FXMVECTOR scale, Vertex* dst, size_t fieldOffset)
+    {
+        if (src.components != 3 || src.componentType != GLTF_COMPONENT_FLOAT)
+            return false;
+
+        DecodeInto<3>(src, [](const uint8_t* p) { return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(p)); },
+            scale, dst, fieldOffset);
+        return true;
+    }
+
+    bool DecodeVec2(const AccessorView& src, Vertex* dst, size_t fieldOffset)
+    {
+        if (src.components != 2)
+            return false;
+
+        XMVECTOR one = XMVectorSplatOne();
+        switch (src.componentType)
+        {
+        case GLTF_COMPONENT_FLOAT:
+            DecodeInto<2>(src, [](const uint8_t* p) { return XMLoadFloat2(reinterpret_cast<const XMFLOAT2*>(p)); },
+                one, dst, fieldOffset);
+            return true;
+        case GLTF_COMPONENT_UNSIGNED_BYTE:
+            DecodeInto<2>(src, [](const uint8_t* p) { return XMLoadUByteN2(reinterpret_cast<const XMUBYTEN2*>(p)); },
+                one, dst, fieldOffset);
+            return true;
+        case GLTF_COMPONENT_UNSIGNED_SHORT:
+            DecodeInto<2>(src, [](const uint8_t* p) { return XMLoadUShortN2(reinterpret_cast<const XMUSHORTN2*>(p)); },
+                one, dst, fieldOffset);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool DecodeIndices(const AccessorView& src, std::vector<uint32_t>& out)
+    {
+        if (src.components != 1)
+            return false;
+
+        out.resize(src.count);
+        const uint8_t* in = src.data;
+
+        switch (src.componentType)
+        {
+        case GLTF_COMPONENT_UNSIGNED_BYTE:
+            for (size_t i = 0; i < src.count; ++i, in += src.stride)
+                out[i] = *in;
+            return true;
+        case GLTF_COMPONENT_UNSIGNED_SHORT:
+            for (size_t i = 0; i < src.count; ++i, in += src.stride)
+            {
+                uint16_t v;
+                memcpy(&v, in, sizeof(v));
+                out[i] = v;
+            }
+            return true;
+        case GLTF_COMPONENT_UNSIGNED_INT:
+            if (src.stride == sizeof(uint32_t))
+            {
+                memcpy(out.data(), in, src.count * sizeof(uint32_t));
+                return true;
+            }
+            for (size_t i = 0; i < src.count; ++i, in += src.stride)
+                memcpy(&out[i], in, sizeof(uint32_t));
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void ComputeNormals(GltfPrimitive& prim)
+    {
+        for (auto& v : prim.vertices)
+            v.Normal = { 0, 0, 0 };
+
+        for (size_t i = 0; i + 2 < prim.indices.size(); i += 3)
+        {
+            Vertex& a = prim.vertices[prim.indices[i]];
+            Vertex& b = prim.vertices[prim.indices[i + 1]];
+            Vertex& c = prim.vertices[prim.indices[i + 2]];
+
+            XMVECTOR pa = XMLoadFloat3(&a.Position);
+            XMVECTOR n = XMVector3Cross(XMLoadFloat3(&b.Position) - pa, XMLoadFloat3(&c.Position) - pa);
+
+            XMStoreFloat3(&a.Normal, XMLoadFloat3(&a.Normal) + n);
+            XMStoreFloat3(&b.Normal, XMLoadFloat3(&b.Normal) + n);
+            XMStoreFloat3(&c.Normal, XMLoadFloat3(&c.Normal) + n);
+        }
+
+        for (auto& v : prim.vertices)
+            XMStoreFloat3(&v.Normal, XMVector3Normalize(XMLoadFloat3(&v.Normal)));
+    }
+
+    // -----------------------------
+    // Asset cache: decoded geometry keyed on the JSON and buffer bytes
+    // -----------------------------
+    const uint32_t GEOMETRY_CACHE_VERSION = 1;
+
+    uint64_t ComputeGeometryKey(std::string_view json, const GltfRawDocument& doc)
+    {
+        ContentHash hash;
+        hash.Append("gltf-geometry").AppendValue(GEOMETRY_CACHE_VERSION).Append(json);
+        for (const GltfRawBuffer& buffer : doc.buffers)
+            hash.Append(buffer.data);
+        return hash.Get();
+    }
+
+    void StoreGeometry(uint64_t key, const std::vector<GltfMesh>& meshes)
+    {
+        BinaryWriter writer;
+        writer.WriteValue((uint32_t)meshes.size());
+        for (const GltfMesh& mesh : meshes)
+        {
+            writer.WriteValue((uint32_t)mesh.primitives.size());
+            for (const GltfPrimitive& prim : mesh.primitives)
+            {
+                writer.WriteValue(prim.material);
+                writer.WriteVector(prim.vertices);
+                writer.WriteVector(prim.indices);
+            }
+        }
+        AssetCache::Store(key, writer.GetData().data(), writer.GetData().size());
+    }
+
+    // Meshes are pre-sized from the JSON, the cached payload must match that layout
+    bool LoadGeometry(uint64_t key, std::vector<GltfMesh>& meshes)
+    {
+        std::vector<uint8_t> data;
+        if (!AssetCache::Load(key, data))
+            return false;
+
+        BinaryReader reader(data);
+        uint32_t meshCount = 0;
+        if (!reader.ReadValue(meshCount) || meshCount != meshes.size())
+            return false;
+
+        for (GltfMesh& mesh : meshes)
+        {
+            uint32_t primitiveCount = 0;
+            if (!reader.ReadValue(primitiveCount) || primitiveCount != mesh.primitives.size())
+                return false;
+
+            for (GltfPrimitive& prim : mesh.primitives)
+            {
+                if (!reader.ReadValue(prim.material) || !reader.ReadVector(prim.vertices) ||
+                    !reader.ReadVector(prim.indices))
+                    return false;
+            }
+        }
+        return reader.IsAtEnd();
+    }
+
+    bool DecodePrimitive(const GltfRawDocument& doc, const GltfRawPrimitive& raw, GltfPrimitive& out)
+    {
+        if (raw.mode != GLTF_MODE_TRIANGLES)
+            return false;
+
+        AccessorView positions;
+        if (!ResolveAccessor(doc, raw.position, positions))
+            return false;
+
+        // glTF is right-handed, the engine is left-handed: mirror Z
+        const XMVECTOR flipZ = XMVectorSet(1.0f, 1.0f, -1.0f, 1.0f);
+
+        out.material = raw.material;
+        out.vertices.assign(positions.count, Vertex{});
+
+        if (!DecodeVec3(positions, flipZ, out.vertices.data(), offsetof(Vertex, Position)))
+            return false;
+
+        AccessorView normals;
+        bool hasNormals = ResolveAccessor(doc, raw.normal, normals) && normals.count == positions.count &&
+            DecodeVec3(normals, flipZ, out.vertices.data(), offsetof(Vertex, Normal));
+
+        AccessorView uvs;
+        if (ResolveAccessor(doc, raw.texcoord, uvs) && uvs.count == positions.count)
+            DecodeVec2(uvs, out.vertices.data(), offsetof(Vertex, UV));
+
+        if (raw.indices >= 0)
+        {
+            AccessorView indices;
+            if (!ResolveAccessor(doc, raw.indices, indices) || !DecodeIndices(indices, out.indices))
+                return false;
+        }
+        else
+        {
+            out.indices.resize(positions.count);
+            for (uint32_t i = 0; i < (uint32_t)positions.count; ++i)
+                out.indices[i] = i;
+        }
+
+        out.indices.resize(out.indices.size() - out.indices.size() % 3);
+        for (uint32_t index : out.indices)
+        {
+            if (index >= positions.count)
+                return false;
+        }
+
+        // Mirroring flips the winding, swap back to clockwise front faces
+        for (size_t i = 0; i + 2 < out.indices.size(); i += 3)
+            std::swap(out.indices[i + 1], out.indices[i + 2]);
+
+        if (!hasNormals)
+            ComputeNormals(out);
+
+        return true;
+    }
+
+    XMMATRIX LocalMatrix(const GltfRawNode& node)
+    {
+        XMMATRIX m;
+        if (node.hasMatrix)
+        {
+            // Column-major column-vector in glTF == row-major row-vector in DirectXMath
+            m = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(node.matrix));
+        }
+        else
+        {
+            m = XMMatrixScaling(node.scale[0], node.scale[1], node.scale[2]) *
+                XMMatrixRotationQuaternion(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(node.rotation))) *
+                XMMatrixTranslation(node.translation[0], node.translation[1], node.translation[2]);
+        }
+
+        // Change of basis RH -> LH: F * M * F with F = diag(1, 1, -1)
+        XMMATRIX flip = XMMatrixScaling(1.0f, 1.0f, -1.0f);
+        return flip * m * flip;
+    }
+
+    void BuildWorld(GltfDocument& doc, int nodeIndex, FXMMATRIX parentWorld, std::vector<bool>& visited)
+    {
+        if (nodeIndex < 0 || nodeIndex >= (int)doc.nodes.size() || visited[nodeIndex])
+            return;
+        visited[nodeIndex] = true;
+
+        GltfNode& node = doc.nodes[nodeIndex];
+        XMMATRIX world = XMLoadFloat4x4(&node.local) * parentWorld;
+        XMStoreFloat4x4(&node.world, world);
+
+        for (int child : node.children)
+        {
+            if (child >= 0 && child < (int)doc.nodes.size())
+                doc.nodes[child].parent = nodeIndex;
+            BuildWorld(doc, child, world, visited);
+        }
+    }
+}
+
+bool GltfImporter::Load(const std::filesystem::path& path, GltfDocument& outDoc)
+{
+    outDoc = GltfDocument{};
+    GltfImportStats& stats = outDoc.stats;
+    Clock::time_point start = Clock::now();
+
+    std::vector<uint8_t> file;
+    if (!GltfParser::ReadFile(path, file))
+    {
+        outDoc.error = "failed to read file";
+        return false;
+    }
+    stats.bytesRead += file.size();
+
+    // -----------------------------
+    // Container (.glb or plain JSON)
+    // -----------------------------
+    std::string_view json;
+    std::vector<uint8_t> glbBin;
+    bool hasGlbBin = false;
+
+    if (!GltfParser::ReadContainer(file, json, glbBin, hasGlbBin))
+    {
+        outDoc.error = "truncated GLB chunk";
+        return false;
+    }
+
+    // -----------------------------
+    // JSON
+    // -----------------------------
+    Clock::time_point phase = Clock::now();
+    GltfRawDocument raw;
+    if (json.empty() || !GltfParser::Parse(json, raw))
+    {
+        outDoc.error = "malformed JSON";
+        return false;
+    }
+    stats.parseMs = ElapsedMs(phase);
+
+    // -----------------------------
+    // Buffers and image bytes, loaded in parallel
+    // -----------------------------
+    phase = Clock::now();
+    std::filesystem::path baseDir = path.parent_path();
+
+    outDoc.images.resize(raw.images.size());
+    std::vector<uint8_t> loadOk(raw.buffers.size() + raw.images.size(), 1);
+    std::atomic<size_t> externalBytes{ 0 };
+
+    JobContext loadCtx;
+    for (size_t i = 0; i < raw.buffers.size(); ++i)
+    {
+        GltfRawBuffer& buffer = raw.buffers[i];
+        if (buffer.uri.empty())
+        {
+            // The first buffer of a .glb without a uri is the BIN chunk
+            if (i == 0 && hasGlbBin)
+                buffer.data = std::move(glbBin);
+            else
+                loadOk[i] = 0;
+            continue;
+        }
+
+        JobSystem::Execute(loadCtx, [&, i]()
+            {
+                GltfRawBuffer& b = raw.buffers[i];
+                loadOk[i] = GltfParser::LoadUri(baseDir, b.uri, b.data) ? 1 : 0;
+                if (b.data.size() < b.byteLength)
+                    loadOk[i] = 0;
+                externalBytes += b.data.size();
+            });
+    }
+
+    for (size_t i = 0; i < raw.images.size(); ++i)
+    {
+        outDoc.images[i].name = raw.images[i].name;
+        if (raw.images[i].uri.empty())
+            continue; // bufferView images are copied once buffers are resident
+
+        JobSystem::Execute(loadCtx, [&, i]()
+            {
+                std::vector<uint8_t>& bytes = outDoc.images[i].bytes;
+                loadOk[raw.buffers.size() + i] = GltfParser::LoadUri(baseDir, raw.images[i].uri, bytes) ? 1 : 0;
+                externalBytes += bytes.size();
+            });
+    }
+    JobSystem::Wait(loadCtx);
+    stats.bytesRead += externalBytes.load();
+
+    for (size_t i = 0; i < raw.buffers.size(); ++i)
+    {
+        if (!loadOk[i])
+        {
+            outDoc.error = "failed to load buffer";
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < raw.images.size(); ++i)
+    {
+        const GltfRawImage& img = raw.images[i];
+        if (img.uri.empty() && img.bufferView >= 0 && img.bufferView < (int)raw.bufferViews.size())
+        {
+            const GltfRawBufferView& view = raw.bufferViews[img.bufferView];
+            if (view.buffer >= 0 && view.buffer < (int)raw.buffers.size() &&
+                view.byteOffset + view.byteLength <= raw.buffers[view.buffer].data.size())
+            {
+                const uint8_t* begin = raw.buffers[view.buffer].data.data() + view.byteOffset;
+                outDoc.images[i].bytes.assign(begin, begin + view.byteLength);
+            }
+        }
+        // A missing image is not fatal, the instance simply falls back to the default texture
+    }
+    stats.loadMs = ElapsedMs(phase);
+
+    // -----------------------------
+    // Geometry, one job per primitive
+    // -----------------------------
+    phase = Clock::now();
+
+    struct PrimitiveJob { size_t mesh; size_t primitive; };
+    std::vector<PrimitiveJob> primitiveJobs;
+
+    outDoc.meshes.resize(raw.meshes.size());
+    for (size_t m = 0; m < raw.meshes.size(); ++m)
+    {
+        outDoc.meshes[m].name = raw.meshes[m].name;
+        outDoc.meshes[m].primitives.resize(raw.meshes[m].primitives.size());
+        for (size_t p = 0; p < raw.meshes[m].primitives.size(); ++p)
+            primitiveJobs.push_back({ m, p });
+    }
+
+    // Same JSON and buffers always decode to the same geometry
+    uint64_t cacheKey = AssetCache::IsEnabled() ? ComputeGeometryKey(json, raw) : 0;
+    stats.cacheHit = cacheKey != 0 && LoadGeometry(cacheKey, outDoc.meshes);
+
+    if (!stats.cacheHit)
+    {
+        std::vector<uint8_t> decodeOk(primitiveJobs.size(), 0);
+        JobContext decodeCtx;
+        JobSystem::Dispatch(decodeCtx, (uint32_t)primitiveJobs.size(), 1, [&](uint32_t i)
+            {
+                const PrimitiveJob& job = primitiveJobs[i];
+                decodeOk[i] = DecodePrimitive(raw, raw.meshes[job.mesh].primitives[job.primitive],
+                    outDoc.meshes[job.mesh].primitives[job.primitive]) ? 1 : 0;
+            });
+        JobSystem::Wait(decodeCtx);
+
+        for (size_t i = 0; i < primitiveJobs.size(); ++i)
+        {
+            if (!decodeOk[i])
+            {
+                // Unsupported primitives (points, lines, sparse accessors) are dropped
+                GltfPrimitive& prim = outDoc.meshes[primitiveJobs[i].mesh].primitives[primitiveJobs[i].primitive];
+                prim.vertices.clear();
+                prim.indices.clear();
+            }
+        }
+
+        if (cacheKey != 0)
+            StoreGeometry(cacheKey, outDoc.meshes);
+    }
+    stats.decodeMs = ElapsedMs(phase);
+
+    // -----------------------------
+    // Materials
+    // -----------------------------
+    for (const GltfRawMaterial& rm : raw.materials)
+    {
+        GltfMaterial mat;
+        if (rm.baseColorTexture >= 0 && rm.baseColorTexture < (int)raw.textureSources.size())
+            mat.baseColorImage = raw.textureSources[rm.baseColorTexture];
+        mat.baseColorFactor = { rm.baseColorFactor[0], rm.baseColorFactor[1], rm.baseColorFactor[2], rm.baseColorFactor[3] };
+        outDoc.materials.push_back(mat);
+    }
+
+    // -----------------------------
+    // Node hierarchy
+    // -----------------------------
+    outDoc.nodes.resize(raw.nodes.size());
+    for (size_t i = 0; i < raw.nodes.size(); ++i)
+    {
+        GltfNode& node = outDoc.nodes[i];
+        node.name = raw.nodes[i].name;
+        node.mesh = raw.nodes[i].mesh < (int)raw.meshes.size() ? raw.nodes[i].mesh : -1;
+        node.children = raw.nodes[i].children;
+        XMStoreFloat4x4(&node.local, LocalMatrix(raw.nodes[i]));
+        XMStoreFloat4x4(&node.world, XMMatrixIdentity());
+    }
+
+    outDoc.rootNodes = GltfParser::GetRootNodes(raw);
+    std::vector<bool> inScene = GltfParser::FindSceneNodes(raw, outDoc.rootNodes);
+    for (size_t i = 0; i < outDoc.nodes.size(); ++i)
+        outDoc.nodes[i].inScene = inScene[i];
+
+    std::vector<bool> visited(outDoc.nodes.size(), false);
+    for (int root : outDoc.rootNodes)
+        BuildWorld(outDoc, root, XMMatrixIdentity(), visited);
+
+    // -----------------------------
+    // Stats
+    // -----------------------------
+    stats.meshCount = (uint32_t)outDoc.meshes.size();
+    stats.nodeCount = (uint32_t)outDoc.nodes.size();
+    stats.imageCount = (uint32_t)outDoc.images.size();
+    for (const GltfNode& node : outDoc.nodes)
+    {
+        XMVECTOR scale, rotation, translation;
+        if (node.inScene && node.mesh >= 0 &&
+            !XMMatrixDecompose(&scale, &rotation, &translation, XMLoadFloat4x4(&node.world)))
+            stats.skippedNodes++;
+    }
+    for (const GltfMesh& mesh : outDoc.meshes)
+    {
+        for (const GltfPrimitive& prim : mesh.primitives)
+        {
+            stats.primitiveCount++;
+            if (prim.vertices.empty())
+                stats.skippedPrimitives++;
+            stats.vertexCount += (uint32_t)prim.vertices.size();
+            stats.triangleCount += (uint32_t)(prim.indices.size() / 3);
+        }
+    }
+    stats.totalMs = ElapsedMs(start);
+
+    return true;
+}
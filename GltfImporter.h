@@ -0,0 +1,95 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Vertex.h"
+
+using namespace DirectX;
+
+namespace Engine::Graphics
+{
+    struct GltfImportStats
+    {
+        size_t bytesRead = 0;       // .gltf/.glb + external buffers + images
+        double parseMs = 0.0;       // JSON
+        double loadMs = 0.0;        // buffers and image bytes
+        double decodeMs = 0.0;      // accessors -> Vertex / indices
+        double totalMs = 0.0;
+        bool cacheHit = false;      // decoded geometry came from the asset cache
+
+        uint32_t meshCount = 0;
+        uint32_t primitiveCount = 0;
+        uint32_t vertexCount = 0;
+        uint32_t triangleCount = 0;
+        uint32_t nodeCount = 0;
+        uint32_t imageCount = 0;
+        uint32_t skippedPrimitives = 0;     // points, lines, sparse accessors
+        uint32_t skippedNodes = 0;          // in-scene mesh nodes whose world matrix has no TRS decomposition
+
+        double GetMegabytesPerSecond() const
+        {
+            return totalMs > 0.0 ? (bytesRead / (1024.0 * 1024.0)) / (totalMs / 1000.0) : 0.0;
+        }
+    };
+
+    // CPU-side import result, already converted to the engine's left-handed convention.
+    struct GltfPrimitive
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        int material = -1;
+    };
+
+    struct GltfMesh
+    {
+        std::string name;
+        std::vector<GltfPrimitive> primitives;
+    };
+
+    struct GltfNode
+    {
+        std::string name;
+        int mesh = -1;
+        int parent = -1;
+        std::vector<int> children;
+        bool inScene = false;       // reached from rootNodes; nodes of other scenes are not instanced
+        XMFLOAT4X4 local;
+        XMFLOAT4X4 world;
+    };
+
+    struct GltfImage
+    {
+        std::string name;
+        std::vector<uint8_t> bytes; // still encoded (PNG/JPEG)
+    };
+
+    struct GltfMaterial
+    {
+        int baseColorImage = -1;
+        XMFLOAT4 baseColorFactor = { 1, 1, 1, 1 };
+    };
+
+    struct GltfDocument
+    {
+        std::vector<GltfMesh> meshes;
+        std::vector<GltfNode> nodes;
+        std::vector<GltfImage> images;
+        std::vector<GltfMaterial> materials;
+        std::vector<int> rootNodes;
+        GltfImportStats stats;
+        std::string error;          // why Load failed
+    };
+
+    class GltfImporter
+    {
+    public:
+        // Parse a .gltf (with external or embedded buffers) or .glb and decode all
+        // geometry on the job system. Does not touch the device; GltfScene
+        // (GltfImporterD3D11.h) creates the GPU side.
+        static bool Load(const std::filesystem::path& path, GltfDocument& outDoc);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,122 @@
+#include "GltfImporterD3D11.h"
+#include "JobSystem.h"
+
+#include <WICTextureLoader.h>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+using namespace DirectX;
+
+void GltfScene::Release()
+{
+    for (Mesh* mesh : meshes)
+        delete mesh;
+    for (ID3D11ShaderResourceView* texture : textures)
+    {
+        if (texture) texture->Release();
+    }
+
+    meshes.clear();
+    textures.clear();
+    instances.clear();
+}
+
+bool GltfScene::Create(ID3D11Device* device, const GltfDocument& doc)
+{
+    if (!device)
+        return false;
+
+    Release();
+
+    // -----------------------------
+    // Images: decoded on workers. The device is free-threaded, so texture
+    // creation can happen off the main thread; no context is used.
+    // -----------------------------
+    textures.assign(doc.images.size(), nullptr);
+
+    JobContext imageCtx;
+    JobSystem::Dispatch(imageCtx, (uint32_t)doc.images.size(), 1, [&](uint32_t i)
+        {
+            const GltfImage& image = doc.images[i];
+            if (image.bytes.empty())
+                return;
+
+            HRESULT coInit = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+            ID3D11ShaderResourceView* srv = nullptr;
+            if (SUCCEEDED(CreateWICTextureFromMemory(device, image.bytes.data(), image.bytes.size(), nullptr, &srv)))
+                textures[i] = srv;
+
+            if (SUCCEEDED(coInit))
+                CoUninitialize();
+        });
+
+    // -----------------------------
+    // Meshes (one GPU mesh per primitive), overlapped with image decoding
+    // -----------------------------
+    std::vector<std::vector<int>> primitiveSlots(doc.meshes.size());
+    for (size_t m = 0; m < doc.meshes.size(); ++m)
+    {
+        for (const GltfPrimitive& prim : doc.meshes[m].primitives)
+        {
+            if (prim.vertices.empty() || prim.indices.empty())
+            {
+                primitiveSlots[m].push_back(-1);
+                continue;
+            }
+
+            Mesh* mesh = new Mesh();
+            if (!mesh->Create(device, prim.vertices.data(), prim.vertices.size(), prim.indices.data(), prim.indices.size()))
+            {
+                delete mesh;
+                primitiveSlots[m].push_back(-1);
+                continue;
+            }
+
+            primitiveSlots[m].push_back((int)meshes.size());
+            meshes.push_back(mesh);
+        }
+    }
+
+    JobSystem::Wait(imageCtx);
+
+    // -----------------------------
+    // Instances
+    // -----------------------------
+    for (const GltfNode& node : doc.nodes)
+    {
+        if (node.mesh < 0 || !node.inScene)
+            continue;
+
+        // Shear or a singular scale has no TRS form; counted in stats.skippedNodes
+        XMVECTOR scale, rotation, translation;
+        if (!XMMatrixDecompose(&scale, &rotation, &translation, XMLoadFloat4x4(&node.world)))
+            continue;
+
+        const GltfMesh& mesh = doc.meshes[node.mesh];
+        for (size_t p = 0; p < mesh.primitives.size(); ++p)
+        {
+            int slot = primitiveSlots[node.mesh][p];
+            if (slot < 0)
+                continue;
+
+            GltfSceneInstance instance;
+            instance.mesh = (uint32_t)slot;
+
+            int material = mesh.primitives[p].material;
+            if (material >= 0 && material < (int)doc.materials.size())
+            {
+                int image = doc.materials[material].baseColorImage;
+                if (image >= 0 && image < (int)textures.size() && textures[image])
+                    instance.texture = image;
+            }
+
+            XMStoreFloat3(&instance.position, translation);
+            XMStoreFloat4(&instance.rotation, rotation);
+            XMStoreFloat3(&instance.scale, scale);
+            instances.push_back(instance);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "GltfImporter.h"
+#include "Mesh.h"
+
+using namespace DirectX;
+
+namespace Engine::Graphics
+{
+    // One drawable per (node, primitive), world transform already flattened.
+    struct GltfSceneInstance
+    {
+        uint32_t mesh = 0;      // index into GltfScene::meshes
+        int texture = -1;       // index into GltfScene::textures
+        XMFLOAT3 position;
+        XMFLOAT4 rotation;
+        XMFLOAT3 scale;
+    };
+
+    // GPU side of an imported GltfDocument
+    struct GltfScene
+    {
+        std::vector<Mesh*> meshes;
+        std::vector<ID3D11ShaderResourceView*> textures;
+        std::vector<GltfSceneInstance> instances;
+
+        // Create GPU meshes and decode images in parallel on the job system.
+        bool Create(ID3D11Device* device, const GltfDocument& doc);
+        void Release();
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,466 @@
+#include "GltfParser.h"
+#include "JsonReader.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+namespace
+{
+    const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+    const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;  // "JSON"
+    const uint32_t GLB_CHUNK_BIN = 0x004E4942;   // "BIN\0"
+
+    // JSON sections
+    // -----------------------------
+    bool ParseIntArray(JsonReader& r, std::vector<int>& out)
+    {
+        out.clear();
+        if (!r.BeginArray())
+            return false;
+        while (r.NextElement())
+        {
+            int v = 0;
+            if (!r.ReadInt(v))
+                return false;
+            out.push_back(v);
+        }
+        return !r.HasError();
+    }
+
+    template <typename T, typename ParseFn>
+    bool ParseObjectArray(JsonReader& r, std::vector<T>& out, ParseFn parseOne)
+    {
+        if (!r.BeginArray())
+            return false;
+        while (r.NextElement())
+        {
+            T item{};
+            std::string key;
+            if (!r.BeginObject())
+                return false;
+            while (r.NextMember(key))
+            {
+                if (!parseOne(key, item))
+                    return false;
+            }
+            if (r.HasError())
+                return false;
+            out.push_back(std::move(item));
+        }
+        return !r.HasError();
+    }
+
+    bool ParsePrimitive(JsonReader& r, GltfRawPrimitive& prim)
+    {
+        std::string key;
+        if (!r.BeginObject())
+            return false;
+
+        while (r.NextMember(key))
+        {
+            if (key == "attributes")
+            {
+                std::string attr;
+                r.BeginObject();
+                while (r.NextMember(attr))
+                {
+                    if (attr == "POSITION") r.ReadInt(prim.position);
+                    else if (attr == "NORMAL") r.ReadInt(prim.normal);
+                    else if (attr == "TEXCOORD_0") r.ReadInt(prim.texcoord);
+                    else r.Skip();
+                }
+            }
+            else if (key == "indices") r.ReadInt(prim.indices);
+            else if (key == "material") r.ReadInt(prim.material);
+            else if (key == "mode") r.ReadInt(prim.mode);
+            else r.Skip();
+        }
+        return !r.HasError();
+    }
+}
+
+bool GltfParser::ReadContainer(const std::vector<uint8_t>& file, std::string_view& outJson,
+    std::vector<uint8_t>& outBin, bool& outHasBin)
+{
+    outJson = std::string_view();
+    outBin.clear();
+    outHasBin = false;
+
+    uint32_t magic = 0;
+    if (file.size() >= 12)
+        memcpy(&magic, file.data(), sizeof(magic));
+
+    if (magic != GLB_MAGIC)
+    {
+        outJson = std::string_view(reinterpret_cast<const char*>(file.data()), file.size());
+        return true;
+    }
+
+    uint32_t header[3];
+    memcpy(header, file.data(), sizeof(header));
+    size_t length = (std::min)((size_t)header[2], file.size());
+    size_t offset = 12;
+
+    while (offset + 8 <= length)
+    {
+        uint32_t chunkLength, chunkType;
+        memcpy(&chunkLength, file.data() + offset, 4);
+        memcpy(&chunkType, file.data() + offset + 4, 4);
+        offset += 8;
+
+        if (offset + chunkLength > length)
+            return false;
+
+        if (chunkType == GLB_CHUNK_JSON && outJson.empty())
+        {
+            outJson = std::string_view(reinterpret_cast<const char*>(file.data() + offset), chunkLength);
+        }
+        else if (chunkType == GLB_CHUNK_BIN && !outHasBin)
+        {
+            outBin.assign(file.begin() + offset, file.begin() + offset + chunkLength);
+            outHasBin = true;
+        }
+        offset += (chunkLength + 3) & ~3u;
+    }
+    return true;
+}
+
+bool GltfParser::Parse(std::string_view json, GltfRawDocument& doc)
+{
+    JsonReader r(json);
+    std::string key;
+
+    if (!r.BeginObject())
+        return false;
+
+    while (r.NextMember(key))
+    {
+        if (key == "buffers")
+        {
+            ParseObjectArray(r, doc.buffers, [&r](const std::string& k, GltfRawBuffer& b)
+                {
+                    if (k == "uri") return r.ReadString(b.uri);
+                    if (k == "byteLength") return r.ReadSize(b.byteLength);
+                    return r.Skip();
+                });
+        }
+        else if (key == "bufferViews")
+        {
+            ParseObjectArray(r, doc.bufferViews, [&r](const std::string& k, GltfRawBufferView& v)
+                {
+                    if (k == "buffer") return r.ReadInt(v.buffer);
+                    if (k == "byteOffset") return r.ReadSize(v.byteOffset);
+                    if (k == "byteLength") return r.ReadSize(v.byteLength);
+                    if (k == "byteStride") return r.ReadSize(v.byteStride);
+                    return r.Skip();
+                });
+        }
+        else if (key == "accessors")
+        {
+            ParseObjectArray(r, doc.accessors, [&r](const std::string& k, GltfRawAccessor& a)
+                {
+                    if (k == "bufferView") return r.ReadInt(a.bufferView);
+                    if (k == "byteOffset") return r.ReadSize(a.byteOffset);
+                    if (k == "componentType") return r.ReadUInt(a.componentType);
+                    if (k == "count") return r.ReadSize(a.count);
+                    if (k == "normalized") return r.ReadBool(a.normalized);
+                    if (k == "type")
+                    {
+                        std::string type;
+                        if (!r.ReadString(type))
+                            return false;
+                        a.components = GetComponentCount(type);
+                        return true;
+                    }
+                    return r.Skip();
+                });
+        }
+        else if (key == "meshes")
+        {
+            ParseObjectArray(r, doc.meshes, [&r](const std::string& k, GltfRawMesh& m)
+                {
+                    if (k == "name") return r.ReadString(m.name);
+                    if (k == "primitives")
+                    {
+                        if (!r.BeginArray())
+                            return false;
+                        while (r.NextElement())
+                        {
+                            GltfRawPrimitive prim;
+                            if (!ParsePrimitive(r, prim))
+                                return false;
+                            m.primitives.push_back(prim);
+                        }
+                        return !r.HasError();
+                    }
+                    return r.Skip();
+                });
+        }
+        else if (key == "nodes")
+        {
+            ParseObjectArray(r, doc.nodes, [&r](const std::string& k, GltfRawNode& n)
+                {
+                    if (k == "name") return r.ReadString(n.name);
+                    if (k == "mesh") return r.ReadInt(n.mesh);
+                    if (k == "children") return ParseIntArray(r, n.children);
+                    if (k == "matrix")
+                    {
+                        n.hasMatrix = true;
+                        return r.ReadFloatArray(n.matrix, 16);
+                    }
+                    if (k == "translation") return r.ReadFloatArray(n.translation, 3);
+                    if (k == "rotation") return r.ReadFloatArray(n.rotation, 4);
+                    if (k == "scale") return r.ReadFloatArray(n.scale, 3);
+                    return r.Skip();
+                });
+        }
+        else if (key == "images")
+        {
+            ParseObjectArray(r, doc.images, [&r](const std::string& k, GltfRawImage& img)
+                {
+                    if (k == "name") return r.ReadString(img.name);
+                    if (k == "uri") return r.ReadString(img.uri);
+                    if (k == "bufferView") return r.ReadInt(img.bufferView);
+                    return r.Skip();
+                });
+        }
+        else if (key == "textures")
+        {
+            r.BeginArray();
+            while (r.NextElement())
+            {
+                int source = -1;
+                std::string k;
+                r.BeginObject();
+                while (r.NextMember(k))
+                {
+                    if (k == "source") r.ReadInt(source);
+                    else r.Skip();
+                }
+                doc.textureSources.push_back(source);
+            }
+        }
+        else if (key == "materials")
+        {
+            ParseObjectArray(r, doc.materials, [&r](const std::string& k, GltfRawMaterial& m)
+                {
+                    if (k != "pbrMetallicRoughness")
+                        return r.Skip();
+
+                    std::string pk;
+                    r.BeginObject();
+                    while (r.NextMember(pk))
+                    {
+                        if (pk == "baseColorFactor")
+                        {
+                            r.ReadFloatArray(m.baseColorFactor, 4);
+                        }
+                        else if (pk == "baseColorTexture")
+                        {
+                            std::string tk;
+                            r.BeginObject();
+                            while (r.NextMember(tk))
+                            {
+                                if (tk == "index") r.ReadInt(m.baseColorTexture);
+                                else r.Skip();
+                            }
+                        }
+                        else
+                        {
+                            r.Skip();
+                        }
+                    }
+                    return !r.HasError();
+                });
+        }
+        else if (key == "scenes")
+        {
+            r.BeginArray();
+            while (r.NextElement())
+            {
+                std::vector<int> roots;
+                std::string k;
+                r.BeginObject();
+                while (r.NextMember(k))
+                {
+                    if (k == "nodes") ParseIntArray(r, roots);
+                    else r.Skip();
+                }
+                doc.scenes.push_back(std::move(roots));
+            }
+        }
+        else if (key == "scene")
+        {
+            r.ReadInt(doc.scene);
+        }
+        else
+        {
+            r.Skip();
+        }
+    }
+
+    return !r.HasError();
+}
+
+std::vector<int> GltfParser::GetRootNodes(const GltfRawDocument& doc)
+{
+    int sceneIndex = doc.scene >= 0 ? doc.scene : 0;
+    if (sceneIndex < (int)doc.scenes.size())
+        return doc.scenes[sceneIndex];
+
+    std::vector<bool> isChild(doc.nodes.size(), false);
+    for (const GltfRawNode& node : doc.nodes)
+    {
+        for (int child : node.children)
+        {
+            if (child >= 0 && child < (int)isChild.size())
+                isChild[child] = true;
+        }
+    }
+
+    std::vector<int> roots;
+    for (size_t i = 0; i < isChild.size(); ++i)
+    {
+        if (!isChild[i])
+            roots.push_back((int)i);
+    }
+    return roots;
+}
+
+std::vector<bool> GltfParser::FindSceneNodes(const GltfRawDocument& doc, const std::vector<int>& roots)
+{
+    std::vector<bool> reached(doc.nodes.size(), false);
+    std::vector<int> stack(roots.rbegin(), roots.rend());
+    while (!stack.empty())
+    {
+        int node = stack.back();
+        stack.pop_back();
+        if (node < 0 || node >= (int)doc.nodes.size() || reached[node])
+            continue;
+
+        reached[node] = true;
+        const std::vector<int>& children = doc.nodes[node].children;
+        stack.insert(stack.end(), children.rbegin(), children.rend());
+    }
+    return reached;
+}
+
+bool GltfParser::ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& out)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::streamsize size = file.tellg();
+    if (size < 0)
+        return false;
+
+    out.resize((size_t)size);
+    file.seekg(0, std::ios::beg);
+    return size == 0 || (bool)file.read(reinterpret_cast<char*>(out.data()), size);
+}
+
+bool GltfParser::DecodeBase64(std::string_view in, std::vector<uint8_t>& out)
+{
+    static const auto table = []()
+        {
+            std::array<int8_t, 256> t{};
+            t.fill(-1);
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int i = 0; i < 64; ++i)
+                t[(uint8_t)alphabet[i]] = (int8_t)i;
+            return t;
+        }();
+
+    out.clear();
+    out.reserve(in.size() * 3 / 4);
+
+    uint32_t acc = 0;
+    int bits = 0;
+    for (char c : in)
+    {
+        if (c == '=')
+            break;
+
+        int8_t v = table[(uint8_t)c];
+        if (v < 0)
+            return false;
+
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out.push_back((uint8_t)(acc >> bits));
+        }
+    }
+    return true;
+}
+
+std::string GltfParser::DecodePercent(const std::string& uri)
+{
+    std::string out;
+    out.reserve(uri.size());
+    for (size_t i = 0; i < uri.size(); ++i)
+    {
+        if (uri[i] == '%' && i + 2 < uri.size() &&
+            isxdigit((unsigned char)uri[i + 1]) && isxdigit((unsigned char)uri[i + 2]))
+        {
+            out += (char)strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        }
+        else
+        {
+            out += uri[i];
+        }
+    }
+    return out;
+}
+
+bool GltfParser::LoadUri(const std::filesystem::path& baseDir, const std::string& uri, std::vector<uint8_t>& out)
+{
+    if (uri.compare(0, 5, "data:") == 0)
+    {
+        size_t comma = uri.find(',');
+        if (comma == std::string::npos || uri.find(";base64", 0) > comma)
+            return false;
+        return DecodeBase64(std::string_view(uri).substr(comma + 1), out);
+    }
+
+    std::string decoded = DecodePercent(uri);
+    std::filesystem::path relative(std::u8string(decoded.begin(), decoded.end()));
+    return ReadFile(baseDir / relative, out);
+}
+
+uint32_t GltfParser::GetComponentCount(const std::string& type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+uint32_t GltfParser::GetComponentSize(uint32_t componentType)
+{
+    switch (componentType)
+    {
+    case GLTF_COMPONENT_BYTE:
+    case GLTF_COMPONENT_UNSIGNED_BYTE: return 1;
+    case GLTF_COMPONENT_SHORT:
+    case GLTF_COMPONENT_UNSIGNED_SHORT: return 2;
+    case GLTF_COMPONENT_UNSIGNED_INT:
+    case GLTF_COMPONENT_FLOAT: return 4;
+    default: return 0;
+    }
+}
+
+// -----------------------------
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Engine::Graphics
+{
+    static constexpr uint32_t GLTF_COMPONENT_BYTE = 5120;
+    static constexpr uint32_t GLTF_COMPONENT_UNSIGNED_BYTE = 5121;
+    static constexpr uint32_t GLTF_COMPONENT_SHORT = 5122;
+    static constexpr uint32_t GLTF_COMPONENT_UNSIGNED_SHORT = 5123;
+    static constexpr uint32_t GLTF_COMPONENT_UNSIGNED_INT = 5125;
+    static constexpr uint32_t GLTF_COMPONENT_FLOAT = 5126;
+
+    static constexpr int GLTF_MODE_TRIANGLES = 4;
+
+    // JSON-side structures, indices as written in the file
+    struct GltfRawBuffer
+    {
+        std::string uri;
+        size_t byteLength = 0;
+        std::vector<uint8_t> data;  // filled by the importer, not by Parse
+    };
+
+    struct GltfRawBufferView
+    {
+        int buffer = -1;
+        size_t byteOffset = 0;
+        size_t byteLength = 0;
+        size_t byteStride = 0;
+    };
+
+    struct GltfRawAccessor
+    {
+        int bufferView = -1;
+        size_t byteOffset = 0;
+        uint32_t componentType = 0;
+        uint32_t components = 0;
+        size_t count = 0;
+        bool normalized = false;
+    };
+
+    struct GltfRawPrimitive
+    {
+        int position = -1;
+        int normal = -1;
+        int texcoord = -1;
+        int indices = -1;
+        int material = -1;
+        int mode = GLTF_MODE_TRIANGLES;
+    };
+
+    struct GltfRawMesh
+    {
+        std::string name;
+        std::vector<GltfRawPrimitive> primitives;
+    };
+
+    struct GltfRawNode
+    {
+        std::string name;
+        int mesh = -1;
+        std::vector<int> children;
+        bool hasMatrix = false;
+        float matrix[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+        float translation[3] = { 0, 0, 0 };
+        float rotation[4] = { 0, 0, 0, 1 };
+        float scale[3] = { 1, 1, 1 };
+    };
+
+    struct GltfRawImage
+    {
+        std::string name;
+        std::string uri;
+        int bufferView = -1;
+    };
+
+    struct GltfRawMaterial
+    {
+        int baseColorTexture = -1;
+        float baseColorFactor[4] = { 1, 1, 1, 1 };
+    };
+
+    struct GltfRawDocument
+    {
+        std::vector<GltfRawBuffer> buffers;
+        std::vector<GltfRawBufferView> bufferViews;
+        std::vector<GltfRawAccessor> accessors;
+        std::vector<GltfRawMesh> meshes;
+        std::vector<GltfRawNode> nodes;
+        std::vector<GltfRawImage> images;
+        std::vector<int> textureSources;
+        std::vector<GltfRawMaterial> materials;
+        std::vector<std::vector<int>> scenes;
+        int scene = -1;
+    };
+
+    // The container and JSON layer of the glTF importer: no math library and
+    // no device, so it builds and is tested everywhere. GltfImporter decodes
+    // the accessors and the node transforms on top of it.
+    class GltfParser
+    {
+    public:
+        // Splits a .glb into its JSON and BIN chunks; anything else is taken
+        // as plain JSON. outJson points into file. False on a truncated chunk.
+        static bool ReadContainer(const std::vector<uint8_t>& file, std::string_view& outJson,
+            std::vector<uint8_t>& outBin, bool& outHasBin);
+
+        static bool Parse(std::string_view json, GltfRawDocument& outDoc);
+
+        // Roots of the default scene; with no scenes, every node that is nobody's child
+        static std::vector<int> GetRootNodes(const GltfRawDocument& doc);
+
+        // True for every node reached from roots, each node at most once
+        static std::vector<bool> FindSceneNodes(const GltfRawDocument& doc, const std::vector<int>& roots);
+
+        // Embedded base64 data: URI or a file next to the document, percent-decoded
+        static bool LoadUri(const std::filesystem::path& baseDir, const std::string& uri, std::vector<uint8_t>& out);
+        static bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& out);
+
+        static bool DecodeBase64(std::string_view in, std::vector<uint8_t>& out);
+        static std::string DecodePercent(const std::string& uri);
+
+        static uint32_t GetComponentCount(const std::string& type);
+        static uint32_t GetComponentSize(uint32_t componentType);
+    };
+
+} // namespace Engine::Graphics
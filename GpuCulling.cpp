@@ -0,0 +1,214 @@
+#include "GpuCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+// -----------------------------
+// CullBatch
+// -----------------------------
+void CullBatch::Reset()
+{
+    m_objects.clear();
+    m_buckets.clear();
+    m_args.clear();
+    m_viewCount = 0;
+}
+
+uint32_t CullBatch::AddBucket(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    m_buckets.push_back({ indexCount, startIndex, baseVertex, 0 });
+    return (uint32_t)m_buckets.size() - 1;
+}
+
+void CullBatch::AddObject(const CullObject& object)
+{
+    m_objects.push_back(object);
+    ++m_buckets[object.bucket].objectCount;
+}
+
+void CullBatch::Finalize(uint32_t viewCount)
+{
+    m_viewCount = viewCount;
+    m_args.assign((size_t)viewCount * m_buckets.size(), IndirectDrawArgs());
+
+    // Each view owns objectCount instance slots, split between the buckets by their object counts
+    uint32_t objectCount = (uint32_t)m_objects.size();
+    for (uint32_t view = 0; view < viewCount; ++view)
+    {
+        uint32_t start = view * objectCount;
+        for (uint32_t b = 0; b < (uint32_t)m_buckets.size(); ++b)
+        {
+            IndirectDrawArgs& args = m_args[GetDrawIndex(view, b, (uint32_t)m_buckets.size())];
+            args.indexCountPerInstance = m_buckets[b].indexCount;
+            args.startIndexLocation = m_buckets[b].startIndex;
+            args.baseVertexLocation = m_buckets[b].baseVertex;
+            args.startInstanceLocation = start;
+            start += m_buckets[b].objectCount;
+        }
+    }
+}
+
+// -----------------------------
+// CullKernel
+// -----------------------------
+CullView CullKernel::MakeView(const OcclusionMatrix& viewProj, uint32_t flags)
+{
+    const float (*m)[4] = viewProj.m;
+    CullView view;
+    view.viewProj = viewProj;
+    view.flags = flags;
+
+    // Column j of the matrix is clip coordinate j as a plane over world positions
+    for (int i = 0; i < 4; ++i)
+    {
+        float x = m[i][0], y = m[i][1], z = m[i][2], w = m[i][3];
+        view.planes[0][i] = w + x;
+        view.planes[1][i] = w - x;
+        view.planes[2][i] = w + y;
+        view.planes[3][i] = w - y;
+        view.planes[4][i] = z;
+        view.planes[5][i] = w - z;
+    }
+
+    for (float (&plane)[4] : view.planes)
+    {
+        float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            for (float& value : plane)
+                value /= length;
+        }
+    }
+    return view;
+}
+
+bool CullKernel::IsInFrustum(const CullObject& object, const CullView& view)
+{
+    for (int p = 0; p < 6; ++p)
+    {
+        if (p == 4 && (view.flags & CULL_VIEW_SKIP_NEAR))
+            continue;
+
+        // The corner farthest along the plane normal
+        const float* plane = view.planes[p];
+        float x = plane[0] >= 0.0f ? object.boundsMax.x : object.boundsMin.x;
+        float y = plane[1] >= 0.0f ? object.boundsMax.y : object.boundsMin.y;
+        float z = plane[2] >= 0.0f ? object.boundsMax.z : object.boundsMin.z;
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool CullKernel::IsOccluded(const CullObject& object, const CullView& view, const CullPyramid& pyramid)
+{
+    if (!pyramid.levelCount || !pyramid.width || !pyramid.height)
+        return false;
+
+    const float (*m)[4] = view.viewProj.m;
+    float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        float x = (corner & 1) ? object.boundsMax.x : object.boundsMin.x;
+        float y = (corner & 2) ? object.boundsMax.y : object.boundsMin.y;
+        float z = (corner & 4) ? object.boundsMax.z : object.boundsMin.z;
+
+        float clipX = x * m[0][0] + y * m[1][0] + z * m[2][0] + m[3][0];
+        float clipY = x * m[0][1] + y * m[1][1] + z * m[2][1] + m[3][1];
+        float clipZ = x * m[0][2] + y * m[1][2] + z * m[2][2] + m[3][2];
+        float clipW = x * m[0][3] + y * m[1][3] + z * m[2][3] + m[3][3];
+
+        // Behind or at the camera: the projected rect is meaningless
+        if (clipW <= 1e-5f)
+            return false;
+
+        float invW = 1.0f / clipW;
+        minX = (std::min)(minX, clipX * invW);
+        maxX = (std::max)(maxX, clipX * invW);
+        minY = (std::min)(minY, clipY * invW);
+        maxY = (std::max)(maxY, clipY * invW);
+        minZ = (std::min)(minZ, clipZ * invW);
+    }
+
+    // Crossing the near plane
+    if (minZ <= 0.0f)
+        return false;
+
+    // Level 0 texels, y down, clamped to the viewport
+    float width = (float)pyramid.width;
+    float height = (float)pyramid.height;
+    float x0 = (std::max)((minX * 0.5f + 0.5f) * width, 0.0f);
+    float x1 = (std::min)((maxX * 0.5f + 0.5f) * width, width - 1.0f);
+    float y0 = (std::max)((0.5f - maxY * 0.5f) * height, 0.0f);
+    float y1 = (std::min)((0.5f - minY * 0.5f) * height, height - 1.0f);
+    if (x0 > x1 || y0 > y1)
+        return false;
+
+    // The level where the rect spans at most two texels each way
+    float extent = (std::max)(x1 - x0, y1 - y0);
+    uint32_t level = extent > 1.0f ? (uint32_t)ceilf(log2f(extent)) : 0;
+    if (level >= pyramid.levelCount)
+        return false;
+
+    float scale = 1.0f / (float)(1u << level);
+    uint32_t levelWidth = (std::max)(pyramid.width >> level, 1u);
+    uint32_t levelHeight = (std::max)(pyramid.height >> level, 1u);
+    uint32_t tx0 = (std::min)((uint32_t)(x0 * scale), levelWidth - 1);
+    uint32_t tx1 = (std::min)((uint32_t)(x1 * scale), levelWidth - 1);
+    uint32_t ty0 = (std::min)((uint32_t)(y0 * scale), levelHeight - 1);
+    uint32_t ty1 = (std::min)((uint32_t)(y1 * scale), levelHeight - 1);
+
+    const float* texels = pyramid.levels[level];
+    float farthest = (std::max)(
+        (std::max)(texels[ty0 * levelWidth + tx0], texels[ty0 * levelWidth + tx1]),
+        (std::max)(texels[ty1 * levelWidth + tx0], texels[ty1 * levelWidth + tx1]));
+    return minZ > farthest;
+}
+
+bool CullKernel::IsVisible(const CullObject& object, const CullView& view, const CullPyramid* pyramid)
+{
+    if ((object.flags & view.filterMask) != view.filterValue)
+        return false;
+    if (!IsInFrustum(object, view))
+        return false;
+    if ((view.flags & CULL_VIEW_HIZ) && pyramid && IsOccluded(object, view, *pyramid))
+        return false;
+    return true;
+}
+
+void CullKernel::Run(const CullBatch& batch, const CullView* views, uint32_t firstView, uint32_t viewCount,
+    const CullPyramid* pyramid, IndirectDrawArgs* args, uint32_t* instances, uint32_t* visibility)
+{
+    const std::vector<CullObject>& objects = batch.GetObjects();
+    uint32_t bucketCount = batch.GetBucketCount();
+
+    for (uint32_t view = firstView; view < firstView + viewCount; ++view)
+    {
+        uint32_t flags = views[view].flags;
+        for (uint32_t i = 0; i < (uint32_t)objects.size(); ++i)
+        {
+            if ((flags & CULL_VIEW_EARLY) && visibility && !visibility[i])
+                continue;
+
+            bool visible = IsVisible(objects[i], views[view], pyramid);
+            if ((flags & CULL_VIEW_LATE) && visibility)
+            {
+                // Drawn by the early pass already
+                bool wasVisible = visibility[i] != 0;
+                visibility[i] = visible ? 1 : 0;
+                if (wasVisible)
+                    continue;
+            }
+            if (!visible)
+                continue;
+
+            IndirectDrawArgs& draw = args[CullBatch::GetDrawIndex(view, objects[i].bucket, bucketCount)];
+            instances[draw.startInstanceLocation + draw.instanceCount] = i;
+            ++draw.instanceCount;
+        }
+    }
+}
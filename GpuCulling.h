@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CascadeShadows.h"
+#include "OcclusionCulling.h"
+
+namespace Engine::Graphics
+{
+    // Views one CullCS.hlsl dispatch can hold: the main view and two shadow phases per cascade fit
+    static constexpr uint32_t MAX_CULL_VIEWS = 16;
+
+    enum CullObjectFlags : uint32_t
+    {
+        CULL_OBJECT_DYNAMIC = 1,
+        CULL_OBJECT_ALPHA_TEST = 2
+    };
+
+    enum CullViewFlags : uint32_t
+    {
+        CULL_VIEW_SKIP_NEAR = 1,    // shadow cascades: casters between the light and the cascade still cast
+        CULL_VIEW_HIZ = 2,          // test against the depth pyramid after the frustum
+        CULL_VIEW_EARLY = 4,        // two-phase first pass: only objects visible last frame, no Hi-Z
+        CULL_VIEW_LATE = 8          // two-phase second pass: records visibility, draws only the newly visible
+    };
+
+    // One object as CullCS.hlsl reads it (StructuredBuffer, 32 bytes)
+    struct CullObject
+    {
+        ShadowVector boundsMin;     // world space
+        uint32_t bucket = 0;
+        ShadowVector boundsMax;
+        uint32_t flags = 0;         // CullObjectFlags
+    };
+
+    // D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS
+    struct IndirectDrawArgs
+    {
+        uint32_t indexCountPerInstance = 0;
+        uint32_t instanceCount = 0;
+        uint32_t startIndexLocation = 0;
+        int32_t baseVertexLocation = 0;
+        uint32_t startInstanceLocation = 0;
+    };
+
+    // What one view draws: inside all planes and passing the filter,
+    // (object flags & filterMask) == filterValue
+    struct CullView
+    {
+        float planes[6][4] = {};    // left, right, bottom, top, near, far; inside where dot(n, p) + d >= 0
+        OcclusionMatrix viewProj;   // the pyramid's projection, CULL_VIEW_HIZ only
+        uint32_t flags = 0;         // CullViewFlags
+        uint32_t filterMask = 0;
+        uint32_t filterValue = 0;
+    };
+
+    // Farthest depth pyramid of the main view. Level k is (width >> k) x
+    // (height >> k), at least 1x1, each texel the farthest of the texels it
+    // covers one level down; level 0 spans the viewport.
+    struct CullPyramid
+    {
+        const float* const* levels = nullptr;
+        uint32_t levelCount = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    struct GpuCullingStats
+    {
+        uint32_t objects = 0;
+        uint32_t buckets = 0;
+        uint32_t views = 0;
+        uint32_t indirectDraws = 0;         // issued, empty buckets included
+        uint32_t mainVisible = 0;           // instances the main view drew, read back a few frames late
+        uint32_t mainLate = 0;              // of those, drawn by the late pass (newly visible)
+        uint32_t hizLevels = 0;             // 0 without a pyramid
+    };
+
+    // Per-frame input of the GPU-driven path: objects grouped into buckets
+    // (one mesh and material, one indirect draw per view), and the layout of
+    // the argument and instance buffers the cull kernel fills. Draw
+    // (view, bucket) is args[view * bucketCount + bucket]; its instances are
+    // object indices at instances[view * objectCount + bucket start].
+    class CullBatch
+    {
+    public:
+        void Reset();
+
+        // Returns the bucket index
+        uint32_t AddBucket(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex);
+
+        // Objects may arrive in any bucket order
+        void AddObject(const CullObject& object);
+
+        // Draw arguments for viewCount views, every instance count 0
+        void Finalize(uint32_t viewCount);
+
+        const std::vector<CullObject>& GetObjects() const { return m_objects; }
+        const std::vector<IndirectDrawArgs>& GetArgs() const { return m_args; }
+        uint32_t GetObjectCount() const { return (uint32_t)m_objects.size(); }
+        uint32_t GetBucketCount() const { return (uint32_t)m_buckets.size(); }
+        uint32_t GetViewCount() const { return m_viewCount; }
+        uint32_t GetInstanceCapacity() const { return m_viewCount * (uint32_t)m_objects.size(); }
+
+        static uint32_t GetDrawIndex(uint32_t view, uint32_t bucket, uint32_t bucketCount) { return view * bucketCount + bucket; }
+
+    private:
+        struct Bucket
+        {
+            uint32_t indexCount;
+            uint32_t startIndex;
+            int32_t baseVertex;
+            uint32_t objectCount;
+        };
+
+        std::vector<CullObject> m_objects;
+        std::vector<Bucket> m_buckets;
+        std::vector<IndirectDrawArgs> m_args;
+        uint32_t m_viewCount = 0;
+    };
+
+    // CPU emulation of CullCS.hlsl, test for test, so the kernel's results can
+    // be checked without a GPU. The shader appends in whatever order its
+    // threads run; here each bucket's instances come out in object order.
+    class CullKernel
+    {
+    public:
+        // Frustum planes of a row-vector view-projection (clip = [x y z 1] * m), normalized
+        static CullView MakeView(const OcclusionMatrix& viewProj, uint32_t flags);
+
+        static bool IsInFrustum(const CullObject& object, const CullView& view);
+
+        // True only when every texel under the box is nearer than the box's nearest point.
+        // Boxes crossing the near plane or too large for the pyramid's top level are never occluded.
+        static bool IsOccluded(const CullObject& object, const CullView& view, const CullPyramid& pyramid);
+
+        static bool IsVisible(const CullObject& object, const CullView& view, const CullPyramid* pyramid);
+
+        // One thread per (object, view) for views firstView..firstView + viewCount - 1:
+        // visible objects bump their draw's instance count and write their index.
+        // visibility (one word per object, nonzero when visible) is the two-phase
+        // history: CULL_VIEW_EARLY views draw only what it marks, CULL_VIEW_LATE
+        // views rewrite it and draw only what it did not mark.
+        static void Run(const CullBatch& batch, const CullView* views, uint32_t firstView, uint32_t viewCount,
+            const CullPyramid* pyramid, IndirectDrawArgs* args, uint32_t* instances, uint32_t* visibility);
+    };
+
+} // namespace Engine::Graphics
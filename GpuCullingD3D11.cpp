@@ -0,0 +1,309 @@
+#include "GpuCullingD3D11.h"
+#include "ShaderCache.h"
+#include "CBCull.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Engine::Graphics;
+
+GpuCuller::GpuCuller(ID3D11Device* device)
+    : m_device(device)
+{
+}
+
+bool GpuCuller::Create(const ShaderCompileResult& computeShader)
+{
+    if (!computeShader.success ||
+        FAILED(m_device->CreateComputeShader(computeShader.bytecode.data(), computeShader.bytecode.size(), nullptr,
+            m_shader.GetAddressOf())))
+        return false;
+
+    return m_constants.Create(m_device.Get(), sizeof(CBCull));
+}
+
+bool GpuCuller::Write(ID3D11DeviceContext* context, StructuredBuffer& target, uint32_t stride,
+    const void* data, uint32_t count)
+{
+    // Grow by half again so a slowly rising count does not recreate every frame
+    if (!target.buffer || count > target.capacity)
+    {
+        uint32_t capacity = (std::max)((std::max)(count + count / 2, target.capacity), 64u);
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = capacity * stride;
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = stride;
+
+        ComPtr<ID3D11Buffer> buffer;
+        if (FAILED(m_device->CreateBuffer(&desc, nullptr, buffer.GetAddressOf())))
+            return false;
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvDesc.Buffer.FirstElement = 0;
+        srvDesc.Buffer.NumElements = capacity;
+
+        ComPtr<ID3D11ShaderResourceView> view;
+        if (FAILED(m_device->CreateShaderResourceView(buffer.Get(), &srvDesc, view.GetAddressOf())))
+            return false;
+
+        target.buffer = buffer;
+        target.view = view;
+        target.capacity = capacity;
+    }
+
+    if (count == 0)
+        return true;
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(context->Map(target.buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        return false;
+    memcpy(mapped.pData, data, (size_t)count * stride);
+    context->Unmap(target.buffer.Get(), 0);
+    return true;
+}
+
+bool GpuCuller::ReserveArgs(uint32_t draws)
+{
+    if (m_args && draws <= m_argsCapacity)
+        return true;
+
+    uint32_t capacity = (std::max)(draws + draws / 2, 64u);
+    const uint32_t wordsPerDraw = sizeof(IndirectDrawArgs) / sizeof(uint32_t);
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = capacity * (UINT)sizeof(IndirectDrawArgs);
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+
+    ComPtr<ID3D11Buffer> buffer;
+    if (FAILED(m_device->CreateBuffer(&desc, nullptr, buffer.GetAddressOf())))
+        return false;
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R32_UINT;
+    uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.NumElements = capacity * wordsPerDraw;
+
+    ComPtr<ID3D11UnorderedAccessView> uav;
+    if (FAILED(m_device->CreateUnorderedAccessView(buffer.Get(), &uavDesc, uav.GetAddressOf())))
+        return false;
+
+    m_args = buffer;
+    m_argsUAV = uav;
+    m_argsCapacity = capacity;
+    return true;
+}
+
+bool GpuCuller::ReserveInstances(uint32_t instances)
+{
+    if (m_instances && instances <= m_instancesCapacity)
+        return true;
+
+    uint32_t capacity = (std::max)(instances + instances / 2, 256u);
+
+    // Written by the kernel, read by the input assembler as a per-instance stream
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = capacity * (UINT)sizeof(uint32_t);
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_VERTEX_BUFFER;
+
+    ComPtr<ID3D11Buffer> buffer;
+    if (FAILED(m_device->CreateBuffer(&desc, nullptr, buffer.GetAddressOf())))
+        return false;
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R32_UINT;
+    uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.NumElements = capacity;
+
+    ComPtr<ID3D11UnorderedAccessView> uav;
+    if (FAILED(m_device->CreateUnorderedAccessView(buffer.Get(), &uavDesc, uav.GetAddressOf())))
+        return false;
+
+    m_instances = buffer;
+    m_instancesUAV = uav;
+    m_instancesCapacity = capacity;
+    return true;
+}
+
+bool GpuCuller::ReserveVisibility(ID3D11DeviceContext* context, uint32_t objects)
+{
+    if (!m_visibility || objects > m_visibilityCapacity)
+    {
+        uint32_t capacity = (std::max)(objects + objects / 2, 256u);
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = capacity * (UINT)sizeof(uint32_t);
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+
+        ComPtr<ID3D11Buffer> buffer;
+        if (FAILED(m_device->CreateBuffer(&desc, nullptr, buffer.GetAddressOf())))
+            return false;
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_UINT;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.NumElements = capacity;
+
+        ComPtr<ID3D11UnorderedAccessView> uav;
+        if (FAILED(m_device->CreateUnorderedAccessView(buffer.Get(), &uavDesc, uav.GetAddressOf())))
+            return false;
+
+        m_visibility = buffer;
+        m_visibilityUAV = uav;
+        m_visibilityCapacity = capacity;
+        m_visibilityObjects = ~0u;
+    }
+
+    // Nothing visible: the first frame after a change draws everything in the late pass
+    if (objects != m_visibilityObjects)
+    {
+        const UINT clear[4] = {};
+        context->ClearUnorderedAccessViewUint(m_visibilityUAV.Get(), clear);
+        m_visibilityObjects = objects;
+    }
+    return true;
+}
+
+bool GpuCuller::Upload(ID3D11DeviceContext* context, const CullBatch& batch, const InstanceTransformGpu* transforms)
+{
+    const std::vector<IndirectDrawArgs>& args = batch.GetArgs();
+    if (!ReserveArgs((uint32_t)args.size()) || !ReserveInstances(batch.GetInstanceCapacity()) ||
+        !ReserveVisibility(context, batch.GetObjectCount()))
+        return false;
+
+    bool ok = Write(context, m_objects, sizeof(CullObject), batch.GetObjects().data(), batch.GetObjectCount());
+    ok &= Write(context, m_transforms, sizeof(InstanceTransformGpu), transforms, batch.GetObjectCount());
+
+    if (!args.empty())
+    {
+        D3D11_BOX box = { 0, 0, 0, (UINT)(args.size() * sizeof(IndirectDrawArgs)), 1, 1 };
+        context->UpdateSubresource(m_args.Get(), 0, &box, args.data(), 0, 0);
+    }
+    return ok;
+}
+
+void GpuCuller::Dispatch(ID3D11DeviceContext* context, const CullBatch& batch, const CullView* views, uint32_t firstView,
+    uint32_t viewCount, ID3D11ShaderResourceView* pyramid, uint32_t pyramidWidth, uint32_t pyramidHeight,
+    uint32_t pyramidLevels)
+{
+    if (!batch.GetObjectCount() || !viewCount || !m_args)
+        return;
+
+    CBCull cb = {};
+    for (uint32_t v = firstView; v < firstView + viewCount; ++v)
+    {
+        CBCullView& target = cb.Views[v];
+        memcpy(target.Planes, views[v].planes, sizeof(target.Planes));
+
+        // Row vectors on the CPU, column-major in the shader
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+                target.ViewProj.m[r][c] = views[v].viewProj.m[c][r];
+        }
+        target.Params = XMUINT4(views[v].flags, views[v].filterMask, views[v].filterValue, 0);
+    }
+    cb.CullCounts = XMUINT4(batch.GetObjectCount(), batch.GetBucketCount(), firstView, viewCount);
+    if (pyramid)
+        cb.PyramidSize = XMUINT4(pyramidWidth, pyramidHeight, pyramidLevels, 0);
+    m_constants.Update(context, &cb);
+
+    // The instance buffer is still an input of the last indirect draws
+    ID3D11Buffer* nullVB = nullptr;
+    UINT zero = 0;
+    context->IASetVertexBuffers(INSTANCE_SLOT, 1, &nullVB, &zero, &zero);
+
+    ID3D11ShaderResourceView* inputs[2] = { m_objects.view.Get(), pyramid };
+    ID3D11UnorderedAccessView* outputs[3] = { m_argsUAV.Get(), m_instancesUAV.Get(), m_visibilityUAV.Get() };
+    ID3D11Buffer* constants = m_constants.Get();
+    context->CSSetShader(m_shader.Get(), nullptr, 0);
+    context->CSSetConstantBuffers(0, 1, &constants);
+    context->CSSetShaderResources(0, 2, inputs);
+    context->CSSetUnorderedAccessViews(0, 3, outputs, nullptr);
+    context->Dispatch((batch.GetObjectCount() + 63) / 64, viewCount, 1);
+
+    // Nothing left bound that the draws read or the next frame writes as a depth target
+    ID3D11ShaderResourceView* nullSRVs[2] = {};
+    ID3D11UnorderedAccessView* nullUAVs[3] = {};
+    context->CSSetShaderResources(0, 2, nullSRVs);
+    context->CSSetUnorderedAccessViews(0, 3, nullUAVs, nullptr);
+    context->CSSetShader(nullptr, nullptr, 0);
+}
+
+void GpuCuller::BindInstances(ID3D11DeviceContext* context) const
+{
+    UINT stride = sizeof(uint32_t);
+    UINT offset = 0;
+    context->IASetVertexBuffers(INSTANCE_SLOT, 1, m_instances.GetAddressOf(), &stride, &offset);
+
+    ID3D11ShaderResourceView* transforms = m_transforms.view.Get();
+    context->VSSetShaderResources(TRANSFORM_SLOT, 1, &transforms);
+}
+
+void GpuCuller::QueueReadback(ID3D11DeviceContext* context, uint32_t firstView, uint32_t viewCount, uint32_t bucketCount)
+{
+    Slot& slot = m_slots[m_next];
+    uint32_t draws = viewCount * bucketCount;
+    if (slot.pending || !m_args || !draws)
+        return;
+
+    if (!slot.staging || draws > slot.capacity)
+    {
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = draws * (UINT)sizeof(IndirectDrawArgs);
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+        slot.staging.Reset();
+        if (FAILED(m_device->CreateBuffer(&desc, nullptr, slot.staging.GetAddressOf())))
+            return;
+        slot.capacity = draws;
+    }
+
+    // A view's draws are contiguous, and so are consecutive views
+    UINT first = GetArgsOffset(CullBatch::GetDrawIndex(firstView, 0, bucketCount));
+    D3D11_BOX box = { first, 0, 0, first + draws * (UINT)sizeof(IndirectDrawArgs), 1, 1 };
+    context->CopySubresourceRegion(slot.staging.Get(), 0, 0, 0, 0, m_args.Get(), 0, &box);
+    slot.views = viewCount;
+    slot.buckets = bucketCount;
+    slot.pending = true;
+    m_next = (m_next + 1) % LATENCY;
+}
+
+bool GpuCuller::Collect(ID3D11DeviceContext* context, uint32_t* outInstances)
+{
+    bool collected = false;
+    while (m_slots[m_oldest].pending)
+    {
+        Slot& slot = m_slots[m_oldest];
+
+        // DXGI_ERROR_WAS_STILL_DRAWING until the copy landed; never stall for it
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+        if (FAILED(context->Map(slot.staging.Get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped)))
+            break;
+
+        const IndirectDrawArgs* draws = (const IndirectDrawArgs*)mapped.pData;
+        for (uint32_t v = 0; v < slot.views; ++v)
+        {
+            uint32_t instances = 0;
+            for (uint32_t b = 0; b < slot.buckets; ++b)
+                instances += draws[CullBatch::GetDrawIndex(v, b, slot.buckets)].instanceCount;
+            outInstances[v] = instances;
+        }
+        context->Unmap(slot.staging.Get(), 0);
+
+        collected = true;
+        slot.pending = false;
+        m_oldest = (m_oldest + 1) % LATENCY;
+    }
+    return collected;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include "GpuCulling.h"
+#include "ConstantBuffer.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    struct ShaderCompileResult;
+
+    // One object's transforms as the instanced vertex shaders read them
+    struct InstanceTransformGpu
+    {
+        DirectX::XMFLOAT4X4 World;                  // transposed
+        DirectX::XMFLOAT4X4 WorldInvTranspose;      // transposed
+    };
+
+    // GPU side of the GPU-driven path (CullCS.hlsl): objects and transforms in
+    // structured buffers, the kernel's output in an indirect argument buffer
+    // and an instance buffer of object indices. The instance buffer doubles
+    // as a per-instance vertex stream, so each draw's StartInstanceLocation
+    // selects its range and the vertex shader fetches its transform with it.
+    // A visibility word per object carries the two-phase history across frames.
+    class GpuCuller
+    {
+    public:
+        static const uint32_t LATENCY = 3;
+
+        // Vertex stage inputs: t13 transforms, object indices in vertex buffer slot 1
+        static const UINT TRANSFORM_SLOT = 13;
+        static const UINT INSTANCE_SLOT = 1;
+
+        GpuCuller(ID3D11Device* device);
+
+        bool Create(const ShaderCompileResult& computeShader);
+
+        // Objects and transforms of the batch, every draw reset to no instances. The visibility
+        // history is cleared when the object count changes; a stale one only costs draws, since
+        // the late pass tests everything the early pass skipped.
+        bool Upload(ID3D11DeviceContext* context, const CullBatch& batch, const InstanceTransformGpu* transforms);
+
+        // Culls views firstView..firstView + viewCount - 1 of the uploaded batch. A null
+        // pyramid turns the Hi-Z test off; it must not be bound as a depth target.
+        void Dispatch(ID3D11DeviceContext* context, const CullBatch& batch, const CullView* views, uint32_t firstView,
+            uint32_t viewCount, ID3D11ShaderResourceView* pyramid, uint32_t pyramidWidth, uint32_t pyramidHeight,
+            uint32_t pyramidLevels);
+
+        void BindInstances(ID3D11DeviceContext* context) const;
+
+        // Draw d of the batch: DrawIndexedInstancedIndirect(GetArgs(), GetArgsOffset(d))
+        ID3D11Buffer* GetArgs() const { return m_args.Get(); }
+        static UINT GetArgsOffset(uint32_t draw) { return draw * (UINT)sizeof(IndirectDrawArgs); }
+
+        // Copies the instance counts of views firstView..firstView + viewCount - 1 for Collect.
+        // Skipped while every staging buffer is in flight.
+        void QueueReadback(ID3D11DeviceContext* context, uint32_t firstView, uint32_t viewCount, uint32_t bucketCount);
+
+        // Newest finished readback: instances drawn per view, summed over the buckets; one entry
+        // per view of the readback
+        bool Collect(ID3D11DeviceContext* context, uint32_t* outInstances);
+
+        uint64_t GetUploadedConstantBytes() const { return m_constants.GetUploadedBytes(); }
+
+    private:
+        struct StructuredBuffer
+        {
+            ComPtr<ID3D11Buffer> buffer;
+            ComPtr<ID3D11ShaderResourceView> view;
+            uint32_t capacity = 0;
+        };
+
+        struct Slot
+        {
+            ComPtr<ID3D11Buffer> staging;
+            uint32_t capacity = 0;      // draws
+            uint32_t views = 0;
+            uint32_t buckets = 0;
+            bool pending = false;
+        };
+
+        ComPtr<ID3D11Device> m_device;
+        ComPtr<ID3D11ComputeShader> m_shader;
+        ConstantBuffer m_constants;
+        StructuredBuffer m_objects;
+        StructuredBuffer m_transforms;
+        ComPtr<ID3D11Buffer> m_args;
+        ComPtr<ID3D11UnorderedAccessView> m_argsUAV;
+        uint32_t m_argsCapacity = 0;    // draws
+        ComPtr<ID3D11Buffer> m_instances;
+        ComPtr<ID3D11UnorderedAccessView> m_instancesUAV;
+        uint32_t m_instancesCapacity = 0;
+        ComPtr<ID3D11Buffer> m_visibility;
+        ComPtr<ID3D11UnorderedAccessView> m_visibilityUAV;
+        uint32_t m_visibilityCapacity = 0;
+        uint32_t m_visibilityObjects = 0;   // object count the history belongs to
+        Slot m_slots[LATENCY];
+        uint32_t m_next = 0;
+        uint32_t m_oldest = 0;
+
+        bool Write(ID3D11DeviceContext* context, StructuredBuffer& target, uint32_t stride, const void* data, uint32_t count);
+        bool ReserveArgs(uint32_t draws);
+        bool ReserveInstances(uint32_t instances);
+        bool ReserveVisibility(ID3D11DeviceContext* context, uint32_t objects);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,54 @@
+#include "GpuQueriesD3D11.h"
+
+using namespace Engine::Graphics;
+
+GpuPassStatistics::GpuPassStatistics(ID3D11Device* device)
+{
+    D3D11_QUERY_DESC desc = {};
+    desc.Query = D3D11_QUERY_PIPELINE_STATISTICS;
+    for (Slot& slot : m_slots)
+    {
+        // A slot without a query is never used, statistics just stay empty
+        device->CreateQuery(&desc, slot.query.GetAddressOf());
+    }
+}
+
+void GpuPassStatistics::Begin(ID3D11DeviceContext* context, uint32_t tag)
+{
+    Slot& slot = m_slots[m_next];
+    if (slot.pending || !slot.query)
+        return;
+
+    slot.tag = tag;
+    context->Begin(slot.query.Get());
+    m_open = true;
+}
+
+void GpuPassStatistics::End(ID3D11DeviceContext* context)
+{
+    if (!m_open)
+        return;
+
+    Slot& slot = m_slots[m_next];
+    context->End(slot.query.Get());
+    slot.pending = true;
+    m_open = false;
+    m_next = (m_next + 1) % LATENCY;
+}
+
+bool GpuPassStatistics::Collect(ID3D11DeviceContext* context, D3D11_QUERY_DATA_PIPELINE_STATISTICS& outData,
+    uint32_t& outTag)
+{
+    Slot& slot = m_slots[m_oldest];
+    if (!slot.pending)
+        return false;
+
+    // S_FALSE while the GPU is still on it; never flush just to ask
+    if (context->GetData(slot.query.Get(), &outData, sizeof(outData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        return false;
+
+    outTag = slot.tag;
+    slot.pending = false;
+    m_oldest = (m_oldest + 1) % LATENCY;
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // Pipeline statistics of one pass, a ring of queries so reading never
+    // stalls: results come back a few frames late, with the tag passed to
+    // Begin so the caller knows which configuration they belong to.
+    class GpuPassStatistics
+    {
+    public:
+        static const uint32_t LATENCY = 4;
+
+        GpuPassStatistics(ID3D11Device* device);
+
+        // Skipped (and End too) while every query is still in flight
+        void Begin(ID3D11DeviceContext* context, uint32_t tag);
+        void End(ID3D11DeviceContext* context);
+
+        // Oldest finished result, false when nothing is ready yet
+        bool Collect(ID3D11DeviceContext* context, D3D11_QUERY_DATA_PIPELINE_STATISTICS& outData, uint32_t& outTag);
+
+    private:
+        struct Slot
+        {
+            ComPtr<ID3D11Query> query;
+            uint32_t tag = 0;
+            bool pending = false;
+        };
+
+        Slot m_slots[LATENCY];
+        uint32_t m_next = 0;        // slot Begin uses
+        uint32_t m_oldest = 0;      // slot Collect reads
+        bool m_open = false;
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,51 @@
+// Hi-Z pyramid build, one dispatch per level: level 0 copies the depth
+// buffer, every later level keeps the farthest depth of the 2x2 block under
+// each texel of the level below. Over an odd source width or height the last
+// column or row also takes in the leftover texels, so every texel bounds
+// every depth pixel it maps to.
+// HiZPyramid::Downsample (HiZPyramid.cpp) is the CPU reference.
+Texture2D<float> Source : register(t0);
+RWTexture2D<float> Target : register(u0);
+
+cbuffer CBHiZ : register(b0)
+{
+    uint4 HiZSource;        // x source width, y source height, z copy
+};
+
+#define GROUP_SIZE 8
+
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    uint2 sourceSize = HiZSource.xy;
+    if (HiZSource.z)
+    {
+        if (all(id.xy < sourceSize))
+            Target[id.xy] = Source.Load(int3(id.xy, 0));
+        return;
+    }
+
+    uint2 size = max(sourceSize >> 1, 1u);
+    if (any(id.xy >= size))
+        return;
+
+    // Three texels for the last column or row over an odd source size
+    uint2 first = id.xy * 2;
+    uint2 extra = 1 + (sourceSize & 1) * (uint2)(id.xy == size - 1);
+    uint2 last = min(first + extra, sourceSize - 1);
+
+    float farthest = 0.0f;
+    [unroll]
+    for (uint y = 0; y < 3; ++y)
+    {
+        [unroll]
+        for (uint x = 0; x < 3; ++x)
+        {
+            // Out of the block: clamped back onto its first texel
+            uint2 texel = uint2(x, y) + first;
+            texel = texel <= last ? texel : first;
+            farthest = max(farthest, Source.Load(int3(texel, 0)));
+        }
+    }
+    Target[id.xy] = farthest;
+}
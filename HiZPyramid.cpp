@@ -0,0 +1,79 @@
+#include "HiZPyramid.h"
+
+#include <algorithm>
+
+using namespace Engine::Graphics;
+
+uint32_t HiZPyramid::GetLevelCount(uint32_t width, uint32_t height)
+{
+    if (!width || !height)
+        return 0;
+
+    uint32_t levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = GetNextSize(width);
+        height = GetNextSize(height);
+        ++levels;
+    }
+    return levels;
+}
+
+void HiZPyramid::Downsample(const float* source, uint32_t sourceWidth, uint32_t sourceHeight, float* target)
+{
+    uint32_t width = GetNextSize(sourceWidth);
+    uint32_t height = GetNextSize(sourceHeight);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        // Three rows for the last one over an odd height
+        uint32_t y0 = 2 * y;
+        uint32_t y1 = (std::min)(y0 + ((sourceHeight & 1) && y == height - 1 ? 2 : 1), sourceHeight - 1);
+
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            uint32_t x0 = 2 * x;
+            uint32_t x1 = (std::min)(x0 + ((sourceWidth & 1) && x == width - 1 ? 2 : 1), sourceWidth - 1);
+
+            float farthest = 0.0f;
+            for (uint32_t sy = y0; sy <= y1; ++sy)
+            {
+                for (uint32_t sx = x0; sx <= x1; ++sx)
+                    farthest = (std::max)(farthest, source[sy * sourceWidth + sx]);
+            }
+            target[y * width + x] = farthest;
+        }
+    }
+}
+
+void HiZPyramid::Build(const float* depth, uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+    m_levels.resize(GetLevelCount(width, height));
+    m_levelPointers.clear();
+    if (m_levels.empty())
+        return;
+
+    m_levels[0].assign(depth, depth + (size_t)width * height);
+    for (size_t level = 1; level < m_levels.size(); ++level)
+    {
+        m_levels[level].resize((size_t)GetNextSize(width) * GetNextSize(height));
+        Downsample(m_levels[level - 1].data(), width, height, m_levels[level].data());
+        width = GetNextSize(width);
+        height = GetNextSize(height);
+    }
+
+    for (const std::vector<float>& level : m_levels)
+        m_levelPointers.push_back(level.data());
+}
+
+CullPyramid HiZPyramid::GetPyramid() const
+{
+    CullPyramid pyramid;
+    pyramid.levels = m_levelPointers.data();
+    pyramid.levelCount = (uint32_t)m_levelPointers.size();
+    pyramid.width = m_width;
+    pyramid.height = m_height;
+    return pyramid;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "GpuCulling.h"
+
+namespace Engine::Graphics
+{
+    // Farthest-depth pyramid of the main view, the reference for
+    // HiZBuildCS.hlsl. Level 0 is the depth buffer itself; level k + 1 keeps
+    // the farthest of each 2x2 block of level k, and where level k has an odd
+    // width or height the last column or row of the new level takes in the
+    // leftover texels too. Every texel then bounds every depth pixel it maps
+    // to, so CullKernel::IsOccluded never hides a visible box.
+    class HiZPyramid
+    {
+    public:
+        // Levels down to 1x1
+        static uint32_t GetLevelCount(uint32_t width, uint32_t height);
+
+        // Texels of the next level, at least 1 each way
+        static uint32_t GetNextSize(uint32_t size) { return size > 1 ? size / 2 : 1; }
+
+        // One level from the one below it, row-major
+        static void Downsample(const float* source, uint32_t sourceWidth, uint32_t sourceHeight, float* target);
+
+        void Build(const float* depth, uint32_t width, uint32_t height);
+
+        // Valid until the next Build
+        CullPyramid GetPyramid() const;
+
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+        uint32_t GetLevelCount() const { return (uint32_t)m_levels.size(); }
+        const std::vector<float>& GetLevel(uint32_t level) const { return m_levels[level]; }
+
+    private:
+        std::vector<std::vector<float>> m_levels;
+        std::vector<const float*> m_levelPointers;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+    };
+
+} // namespace Engine::Graphics
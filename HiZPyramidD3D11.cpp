@@ -0,0 +1,117 @@
+#include "HiZPyramidD3D11.h"
+#include "ShaderCache.h"
+#include "CBHiZ.h"
+
+using namespace Engine::Graphics;
+
+bool GpuHiZPyramid::Create(ID3D11Device* device, const ShaderCompileResult& computeShader)
+{
+    m_device = device;
+    if (!computeShader.success ||
+        FAILED(device->CreateComputeShader(computeShader.bytecode.data(), computeShader.bytecode.size(), nullptr,
+            m_shader.GetAddressOf())))
+        return false;
+
+    return m_constants.Create(device, sizeof(CBHiZ));
+}
+
+bool GpuHiZPyramid::Resize(uint32_t width, uint32_t height)
+{
+    if (m_texture && width == m_width && height == m_height)
+        return true;
+
+    m_texture.Reset();
+    m_srv.Reset();
+    m_levelSRVs.clear();
+    m_levelUAVs.clear();
+    m_width = 0;
+    m_height = 0;
+
+    uint32_t levels = HiZPyramid::GetLevelCount(width, height);
+    if (!levels)
+        return false;
+
+    // Mip k is (width >> k) x (height >> k), the pyramid's own level sizes
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = levels;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R32_FLOAT;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    if (FAILED(m_device->CreateTexture2D(&desc, nullptr, m_texture.GetAddressOf())))
+        return false;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = levels;
+    if (FAILED(m_device->CreateShaderResourceView(m_texture.Get(), &srvDesc, m_srv.GetAddressOf())))
+        return false;
+
+    m_levelSRVs.resize(levels);
+    m_levelUAVs.resize(levels);
+    for (uint32_t level = 0; level < levels; ++level)
+    {
+        srvDesc.Texture2D.MostDetailedMip = level;
+        srvDesc.Texture2D.MipLevels = 1;
+        if (FAILED(m_device->CreateShaderResourceView(m_texture.Get(), &srvDesc, m_levelSRVs[level].GetAddressOf())))
+            return false;
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+        uavDesc.Texture2D.MipSlice = level;
+        if (FAILED(m_device->CreateUnorderedAccessView(m_texture.Get(), &uavDesc, m_levelUAVs[level].GetAddressOf())))
+            return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+void GpuHiZPyramid::Build(ID3D11DeviceContext* context, ID3D11ShaderResourceView* depth)
+{
+    if (!depth || !m_texture)
+        return;
+
+    ID3D11Buffer* constants = m_constants.Get();
+    context->CSSetShader(m_shader.Get(), nullptr, 0);
+    context->CSSetConstantBuffers(0, 1, &constants);
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    uint32_t width = m_width;
+    uint32_t height = m_height;
+    for (uint32_t level = 0; level < GetLevelCount(); ++level)
+    {
+        // Level 0 reads the depth buffer, every later one the level below
+        ID3D11ShaderResourceView* source = level ? m_levelSRVs[level - 1].Get() : depth;
+        uint32_t sourceWidth = width;
+        uint32_t sourceHeight = height;
+        if (level)
+        {
+            width = HiZPyramid::GetNextSize(width);
+            height = HiZPyramid::GetNextSize(height);
+        }
+
+        CBHiZ cb = {};
+        cb.HiZSource = XMUINT4(sourceWidth, sourceHeight, level ? 0 : 1, 0);
+        m_constants.Update(context, &cb);
+
+        // A mip cannot be read and written at once; drop the previous target before binding it as the source
+        context->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+        context->CSSetShaderResources(0, 1, &source);
+        context->CSSetUnorderedAccessViews(0, 1, m_levelUAVs[level].GetAddressOf(), nullptr);
+        context->Dispatch((width + 7) / 8, (height + 7) / 8, 1);
+        context->CSSetShaderResources(0, 1, &nullSRV);
+    }
+
+    // Leave nothing bound that the culling reads or the next frame writes as a depth target
+    context->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    context->CSSetShader(nullptr, nullptr, 0);
+}
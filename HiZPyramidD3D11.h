@@ -0,0 +1,49 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <vector>
+#include "HiZPyramid.h"
+#include "ConstantBuffer.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    struct ShaderCompileResult;
+
+    // GPU side of the Hi-Z pyramid (HiZBuildCS.hlsl): an R32_FLOAT texture
+    // with the full mip chain, mip k the pyramid's level k, rebuilt from the
+    // main depth buffer with one dispatch per level. The whole chain is what
+    // CullCS.hlsl reads as its pyramid.
+    class GpuHiZPyramid
+    {
+    public:
+        bool Create(ID3D11Device* device, const ShaderCompileResult& computeShader);
+
+        // Recreates the texture when the size changed
+        bool Resize(uint32_t width, uint32_t height);
+
+        // depth must not be bound as a depth target
+        void Build(ID3D11DeviceContext* context, ID3D11ShaderResourceView* depth);
+
+        ID3D11ShaderResourceView* GetSRV() const { return m_srv.Get(); }
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+        uint32_t GetLevelCount() const { return (uint32_t)m_levelUAVs.size(); }
+        uint64_t GetUploadedConstantBytes() const { return m_constants.GetUploadedBytes(); }
+
+    private:
+        ComPtr<ID3D11Device> m_device;
+        ComPtr<ID3D11ComputeShader> m_shader;
+        ConstantBuffer m_constants;
+        ComPtr<ID3D11Texture2D> m_texture;
+        ComPtr<ID3D11ShaderResourceView> m_srv;
+        std::vector<ComPtr<ID3D11ShaderResourceView>> m_levelSRVs;
+        std::vector<ComPtr<ID3D11UnorderedAccessView>> m_levelUAVs;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,139 @@
+#include "HotReload.h"
+
+#include <algorithm>
+
+using namespace Engine::Core;
+
+HotReloader::~HotReloader()
+{
+    // Build jobs hold pointers to the entries
+    WaitForBuilds();
+}
+
+void HotReloader::Register(IReloadable* reloadable)
+{
+    m_entries.push_back(std::make_unique<Entry>());
+    Entry& entry = *m_entries.back();
+    entry.reloadable.reset(reloadable);
+
+    std::vector<std::filesystem::path> files;
+    reloadable->GetDependencies(files);
+    SetDependencies(entry, files);
+}
+
+void HotReloader::SetDependencies(Entry& entry, const std::vector<std::filesystem::path>& files)
+{
+    entry.dependencies.clear();
+    for (const std::filesystem::path& file : files)
+    {
+        std::filesystem::path normalized = FileWatcher::Normalize(file);
+        m_watcher.Watch(normalized.parent_path());
+        entry.dependencies.push_back(normalized);
+    }
+}
+
+bool HotReloader::Affects(const Entry& entry, const std::filesystem::path& changed)
+{
+    // A reported directory means its events were dropped, anything in it may have changed
+    for (const std::filesystem::path& dependency : entry.dependencies)
+    {
+        if (dependency == changed || dependency.parent_path() == changed)
+            return true;
+    }
+    return false;
+}
+
+void HotReloader::StartBuild(Entry& entry)
+{
+    entry.changedAt = std::chrono::steady_clock::now();
+    entry.errors.clear();
+    entry.newDependencies.clear();
+    entry.reloadable->BeginReload();
+    entry.state.store(BuildState::Building, std::memory_order_relaxed);
+
+    Entry* target = &entry;
+    JobSystem::Execute(m_buildJobs, [target]()
+        {
+            bool built = target->reloadable->Build(target->errors);
+
+            // Even after a failed build: the fix may be a newly created include
+            target->reloadable->GetDependencies(target->newDependencies);
+            target->state.store(built ? BuildState::Built : BuildState::Failed, std::memory_order_release);
+        });
+}
+
+void HotReloader::Update(std::string& outLog)
+{
+    // -----------------------------
+    // Commit finished builds
+    // -----------------------------
+    for (auto& e : m_entries)
+    {
+        Entry& entry = *e;
+        BuildState state = entry.state.load(std::memory_order_acquire);
+        if (state != BuildState::Built && state != BuildState::Failed)
+            continue;
+
+        SetDependencies(entry, entry.newDependencies);
+
+        std::string name = entry.reloadable->GetName();
+        std::string errors = entry.errors;
+        if (state == BuildState::Built && entry.reloadable->Commit(errors))
+        {
+            m_stats.reloads++;
+            m_stats.lastReloadMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - entry.changedAt).count();
+            outLog += "Reloaded " + name + " in " + std::to_string((int)m_stats.lastReloadMs) + " ms\n";
+        }
+        else
+        {
+            m_stats.failures++;
+            outLog += "Reload of " + name + " failed, keeping the previous version\n" + errors;
+            if (!errors.empty() && errors.back() != '\n')
+                outLog += '\n';
+        }
+
+        entry.state.store(BuildState::Idle, std::memory_order_relaxed);
+        if (entry.dirty)
+        {
+            entry.dirty = false;
+            StartBuild(entry);
+        }
+    }
+
+    // -----------------------------
+    // Queue builds for changed files
+    // -----------------------------
+    std::vector<std::filesystem::path> changed;
+    m_watcher.Poll(changed);
+    changed.insert(changed.end(), m_marked.begin(), m_marked.end());
+    m_marked.clear();
+
+    if (changed.empty())
+        return;
+
+    for (auto& e : m_entries)
+    {
+        Entry& entry = *e;
+        bool affected = std::any_of(changed.begin(), changed.end(),
+            [&entry](const std::filesystem::path& path) { return Affects(entry, path); });
+        if (!affected)
+            continue;
+
+        // One build at a time per asset; a change mid-build queues one more
+        if (entry.state.load(std::memory_order_relaxed) == BuildState::Idle)
+            StartBuild(entry);
+        else
+            entry.dirty = true;
+    }
+}
+
+void HotReloader::MarkChanged(const std::filesystem::path& file)
+{
+    m_marked.push_back(FileWatcher::Normalize(file));
+}
+
+void HotReloader::WaitForBuilds()
+{
+    JobSystem::Wait(m_buildJobs);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FileWatcher.h"
+#include "JobSystem.h"
+
+namespace Engine::Core
+{
+    // Something that can be rebuilt from files on disk while the app runs.
+    // A reload is split so nothing live is touched off the main thread:
+    // BeginReload (main) -> Build (worker) -> Commit (main, between frames).
+    class IReloadable
+    {
+    public:
+        virtual ~IReloadable() = default;
+
+        virtual const char* GetName() const = 0;
+
+        // Every file the asset is built from, e.g. a shader and its includes.
+        // Called on registration and again on a worker after each build.
+        virtual void GetDependencies(std::vector<std::filesystem::path>& outFiles) = 0;
+
+        // Main thread, right before Build is queued: snapshot the live state Build needs
+        virtual void BeginReload() {}
+
+        // Worker thread: compile/decode into staging data only
+        virtual bool Build(std::string& outErrors) = 0;
+
+        // Main thread at a frame boundary, after a successful Build: create the
+        // new objects and swap them in. On failure the live version must be
+        // left exactly as it was.
+        virtual bool Commit(std::string& outErrors) = 0;
+    };
+
+    struct HotReloadStats
+    {
+        uint32_t reloads = 0;
+        uint32_t failures = 0;
+        double lastReloadMs = 0.0;     // change detected -> committed
+    };
+
+    // Watches the dependencies of the registered assets and rebuilds only the
+    // ones a change affects, in the background. Finished builds are committed
+    // by Update, so callers see the swap at a frame boundary.
+    class HotReloader
+    {
+    public:
+        HotReloader() = default;
+        ~HotReloader();
+
+        HotReloader(const HotReloader&) = delete;
+        HotReloader& operator=(const HotReloader&) = delete;
+
+        // Takes ownership. Watches the directories of its dependencies.
+        void Register(IReloadable* reloadable);
+
+        // Main thread, once per frame before rendering: commits finished
+        // builds and queues new ones for changed files. Appends a line per
+        // reload (and the errors of failed ones) to outLog.
+        void Update(std::string& outLog);
+
+        // Same as a watcher event for file, without the settle delay
+        void MarkChanged(const std::filesystem::path& file);
+
+        // Blocks until the queued builds have finished (they still need an Update to commit)
+        void WaitForBuilds();
+
+        void SetSettleTime(std::chrono::milliseconds settle) { m_watcher.SetSettleTime(settle); }
+        const HotReloadStats& GetStats() const { return m_stats; }
+
+    private:
+        enum class BuildState : uint32_t
+        {
+            Idle,
+            Building,
+            Built,
+            Failed
+        };
+
+        struct Entry
+        {
+            std::unique_ptr<IReloadable> reloadable;
+            std::vector<std::filesystem::path> dependencies;    // normalized, main thread
+            std::vector<std::filesystem::path> newDependencies; // written by the build job
+            std::atomic<BuildState> state{ BuildState::Idle };
+            std::string errors;                                 // written by the build job
+            std::chrono::steady_clock::time_point changedAt;
+            bool dirty = false;                                 // changed again while building
+        };
+
+        FileWatcher m_watcher;
+        std::vector<std::unique_ptr<Entry>> m_entries;
+        std::vector<std::filesystem::path> m_marked;
+        JobContext m_buildJobs;
+        HotReloadStats m_stats;
+
+        void SetDependencies(Entry& entry, const std::vector<std::filesystem::path>& files);
+        void StartBuild(Entry& entry);
+        static bool Affects(const Entry& entry, const std::filesystem::path& changed);
+    };
+
+} // namespace Engine::Core
@@ -0,0 +1,168 @@
+#include "HotReloadD3D11.h"
+#include "Shader.h"
+
+#include <DDSTextureLoader.h>
+#include <fstream>
+#include <iterator>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+using namespace DirectX;
+
+namespace
+{
+    void AddShaderDependencies(const std::filesystem::path& path, std::vector<std::filesystem::path>& outFiles)
+    {
+        std::vector<std::filesystem::path> includes;
+        ShaderCache::CollectIncludes(path, includes);
+
+        outFiles.push_back(path);
+        outFiles.insert(outFiles.end(), includes.begin(), includes.end());
+    }
+
+    bool CheckResults(const std::vector<ShaderCompileResult>& results, std::string& outErrors)
+    {
+        bool success = true;
+        for (const ShaderCompileResult& result : results)
+        {
+            outErrors += result.errors;
+            success &= result.success;
+        }
+        return success;
+    }
+}
+
+// -----------------------------
+// ShaderProgramReloadable
+// -----------------------------
+ShaderProgramReloadable::ShaderProgramReloadable(ID3D11Device* device, ShaderCache* cache, const char* name,
+    const ShaderCompileRequest& vs, const ShaderCompileRequest& ps,
+    const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements,
+    const ConstantBufferLayout* cbLayouts, size_t cbLayoutCount, Shader* target,
+    const ShaderCompileRequest* gs)
+    : m_device(device)
+    , m_cache(cache)
+    , m_name(name)
+    , m_layout(layoutDesc, layoutDesc + layoutNumElements)
+    , m_cbLayouts(cbLayouts)
+    , m_cbLayoutCount(cbLayoutCount)
+    , m_target(target)
+{
+    m_requests.push_back(vs);
+    m_requests.push_back(ps);
+    if (gs)
+        m_requests.push_back(*gs);
+}
+
+void ShaderProgramReloadable::GetDependencies(std::vector<std::filesystem::path>& outFiles)
+{
+    for (const ShaderCompileRequest& request : m_requests)
+        AddShaderDependencies(request.path, outFiles);
+}
+
+bool ShaderProgramReloadable::Build(std::string& outErrors)
+{
+    m_cache->CompileAll(m_requests.data(), m_requests.size(), m_results);
+    return CheckResults(m_results, outErrors);
+}
+
+bool ShaderProgramReloadable::Commit(std::string& outErrors)
+{
+    Shader fresh;
+    if (!fresh.Create(m_device, m_results[0], m_results[1], m_layout.data(), (UINT)m_layout.size()) ||
+        (m_results.size() > 2 && !fresh.CreateGeometryShader(m_device, m_results[2])))
+    {
+        outErrors += m_name + ": failed to create the shader objects\n";
+        return false;
+    }
+
+    // An edit that drifts a cbuffer away from its C++ struct is rejected like a compile error
+    if (m_cbLayouts && !fresh.GetBindings().Validate(m_cbLayouts, m_cbLayoutCount, m_name, outErrors))
+        return false;
+
+    m_target->Swap(fresh);
+    m_results.clear();
+    return true;
+}
+
+// -----------------------------
+// PixelShaderVariantsReloadable
+// -----------------------------
+PixelShaderVariantsReloadable::PixelShaderVariantsReloadable(PixelShaderVariants* variants, const char* name)
+    : m_variants(variants)
+    , m_name(name)
+{
+}
+
+void PixelShaderVariantsReloadable::GetDependencies(std::vector<std::filesystem::path>& outFiles)
+{
+    AddShaderDependencies(m_variants->GetBytecode().GetBaseRequest().path, outFiles);
+}
+
+void PixelShaderVariantsReloadable::BeginReload()
+{
+    const ShaderVariantCache& bytecode = m_variants->GetBytecode();
+    bytecode.GetKeys(m_keys);
+
+    m_requests.clear();
+    for (ShaderVariantKey key : m_keys)
+        m_requests.push_back(bytecode.MakeRequest(key));
+}
+
+bool PixelShaderVariantsReloadable::Build(std::string& outErrors)
+{
+    m_variants->GetBytecode().GetCache()->CompileAll(m_requests.data(), m_requests.size(), m_results);
+    return CheckResults(m_results, outErrors);
+}
+
+bool PixelShaderVariantsReloadable::Commit(std::string& outErrors)
+{
+    bool replaced = m_variants->Replace(m_keys, m_results, outErrors);
+    m_results.clear();
+    return replaced;
+}
+
+// -----------------------------
+// CookedTextureReloadable
+// -----------------------------
+CookedTextureReloadable::CookedTextureReloadable(ID3D11Device* device, const std::filesystem::path& path,
+    ID3D11ShaderResourceView** target, SwapCallback onSwap)
+    : m_device(device)
+    , m_path(path)
+    , m_name(path.string())
+    , m_target(target)
+    , m_onSwap(std::move(onSwap))
+{
+}
+
+bool CookedTextureReloadable::Build(std::string& outErrors)
+{
+    std::ifstream file(m_path, std::ios::binary);
+    m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (m_data.empty())
+    {
+        outErrors += "cannot read " + m_name + "\n";
+        return false;
+    }
+    return true;
+}
+
+bool CookedTextureReloadable::Commit(std::string& outErrors)
+{
+    ID3D11ShaderResourceView* srv = nullptr;
+    HRESULT hr = CreateDDSTextureFromMemory(m_device, m_data.data(), m_data.size(), nullptr, &srv);
+    m_data.clear();
+    if (FAILED(hr))
+    {
+        outErrors += m_name + " is not a valid .dds\n";
+        return false;
+    }
+
+    ID3D11ShaderResourceView* previous = *m_target;
+    *m_target = srv;
+    if (m_onSwap)
+        m_onSwap(previous, srv);
+    if (previous)
+        previous->Release();
+    return true;
+}
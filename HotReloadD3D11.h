@@ -0,0 +1,87 @@
+#pragma once
+
+#include <d3d11.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "HotReload.h"
+#include "ShaderCacheD3D11.h"
+
+namespace Engine::Graphics
+{
+    class Shader;
+
+    // VS + PS (+ optional GS) program of a Shader. The replacement is created and its
+    // cbuffers validated before it is swapped into the Shader, so a broken
+    // edit leaves the running program untouched.
+    class ShaderProgramReloadable : public Engine::Core::IReloadable
+    {
+    public:
+        ShaderProgramReloadable(ID3D11Device* device, ShaderCache* cache, const char* name,
+            const ShaderCompileRequest& vs, const ShaderCompileRequest& ps,
+            const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements,
+            const ConstantBufferLayout* cbLayouts, size_t cbLayoutCount, Shader* target,
+            const ShaderCompileRequest* gs = nullptr);
+
+        const char* GetName() const override { return m_name.c_str(); }
+        void GetDependencies(std::vector<std::filesystem::path>& outFiles) override;
+        bool Build(std::string& outErrors) override;
+        bool Commit(std::string& outErrors) override;
+
+    private:
+        ID3D11Device* m_device = nullptr;
+        ShaderCache* m_cache = nullptr;
+        std::string m_name;
+        std::vector<ShaderCompileRequest> m_requests;     // VS, PS[, GS]
+        std::vector<D3D11_INPUT_ELEMENT_DESC> m_layout;
+        const ConstantBufferLayout* m_cbLayouts = nullptr;
+        size_t m_cbLayoutCount = 0;
+        Shader* m_target = nullptr;
+        std::vector<ShaderCompileResult> m_results;
+    };
+
+    // Recompiles only the variants that have been used so far
+    class PixelShaderVariantsReloadable : public Engine::Core::IReloadable
+    {
+    public:
+        PixelShaderVariantsReloadable(PixelShaderVariants* variants, const char* name);
+
+        const char* GetName() const override { return m_name.c_str(); }
+        void GetDependencies(std::vector<std::filesystem::path>& outFiles) override;
+        void BeginReload() override;
+        bool Build(std::string& outErrors) override;
+        bool Commit(std::string& outErrors) override;
+
+    private:
+        PixelShaderVariants* m_variants = nullptr;
+        std::string m_name;
+        std::vector<ShaderVariantKey> m_keys;
+        std::vector<ShaderCompileRequest> m_requests;
+        std::vector<ShaderCompileResult> m_results;
+    };
+
+    // A cooked .dds behind an SRV pointer. onSwap runs before the old view is
+    // released so holders of the raw pointer can be repointed.
+    class CookedTextureReloadable : public Engine::Core::IReloadable
+    {
+    public:
+        using SwapCallback = std::function<void(ID3D11ShaderResourceView* previous, ID3D11ShaderResourceView* current)>;
+
+        CookedTextureReloadable(ID3D11Device* device, const std::filesystem::path& path, ID3D11ShaderResourceView** target,
+            SwapCallback onSwap);
+
+        const char* GetName() const override { return m_name.c_str(); }
+        void GetDependencies(std::vector<std::filesystem::path>& outFiles) override { outFiles.push_back(m_path); }
+        bool Build(std::string& outErrors) override;
+        bool Commit(std::string& outErrors) override;
+
+    private:
+        ID3D11Device* m_device = nullptr;
+        std::filesystem::path m_path;
+        std::string m_name;
+        ID3D11ShaderResourceView** m_target = nullptr;
+        SwapCallback m_onSwap;
+        std::vector<uint8_t> m_data;
+    };
+
+} // namespace Engine::Graphics
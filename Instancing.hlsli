@@ -0,0 +1,14 @@
+// GPU-driven draws (CullCS.hlsl): the instance stream carries object
+// indices, each selecting its transforms. Layout of InstanceTransformGpu.
+#ifndef INSTANCING_HLSLI
+#define INSTANCING_HLSLI
+
+struct InstanceTransform
+{
+    float4x4 World;
+    float4x4 WorldInvTranspose;
+};
+
+StructuredBuffer<InstanceTransform> InstanceTransforms : register(t13);
+
+#endif
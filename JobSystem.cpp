@@ -0,0 +1,172 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Engine::Core;
+
+namespace
+{
+    struct Job
+    {
+        std::function<void()> work;
+        JobContext* ctx = nullptr;
+    };
+
+    std::vector<std::thread> s_workers;
+    std::deque<Job> s_queue;
+    std::mutex s_mutex;
+    std::condition_variable s_wake;
+    bool s_running = false;
+
+    void RunJob(Job& job)
+    {
+        {
+            ProfileScope profile("Job");
+            job.work();
+        }
+        job.ctx->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    bool TryPop(Job& out)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_queue.empty())
+            return false;
+
+        out = std::move(s_queue.front());
+        s_queue.pop_front();
+        return true;
+    }
+
+    void WorkerLoop()
+    {
+        Profiler::SetThreadName("Job worker");
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(s_mutex);
+                s_wake.wait(lock, [] { return !s_running || !s_queue.empty(); });
+
+                if (!s_running && s_queue.empty())
+                    return;
+
+                job = std::move(s_queue.front());
+                s_queue.pop_front();
+            }
+            RunJob(job);
+        }
+    }
+}
+
+void JobSystem::Initialize(uint32_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        uint32_t hw = std::thread::hardware_concurrency();
+        workerCount = std::max(1u, hw > 1 ? hw - 1 : 1u);
+    }
+
+    // Workers block on the mutex until the pool is complete
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_running)
+        return;
+
+    s_running = true;
+    for (uint32_t i = 0; i < workerCount; ++i)
+        s_workers.emplace_back(WorkerLoop);
+}
+
+void JobSystem::Shutdown()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (!s_running)
+            return;
+        s_running = false;
+        workers.swap(s_workers);
+    }
+    s_wake.notify_all();
+
+    for (auto& t : workers)
+        t.join();
+}
+
+uint32_t JobSystem::GetWorkerCount()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return (uint32_t)s_workers.size();
+}
+
+void JobSystem::Execute(JobContext& ctx, std::function<void()> job)
+{
+    ctx.pending.fetch_add(1, std::memory_order_relaxed);
+
+    bool queued = false;
+    {
+        // Checked under the lock: a job queued after Shutdown stopped the
+        // workers would never run
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_running)
+        {
+            s_queue.push_back({ std::move(job), &ctx });
+            queued = true;
+        }
+    }
+
+    // No pool (not initialized or already shut down): run inline
+    if (!queued)
+    {
+        Job inlineJob{ std::move(job), &ctx };
+        RunJob(inlineJob);
+        return;
+    }
+    s_wake.notify_one();
+}
+
+void JobSystem::Dispatch(JobContext& ctx, uint32_t jobCount, uint32_t groupSize,
+    const std::function<void(uint32_t index)>& job)
+{
+    if (jobCount == 0)
+        return;
+
+    groupSize = std::max(1u, groupSize);
+    uint32_t groupCount = (jobCount + groupSize - 1) / groupSize;
+
+    for (uint32_t g = 0; g < groupCount; ++g)
+    {
+        uint32_t begin = g * groupSize;
+        uint32_t end = std::min(begin + groupSize, jobCount);
+
+        Execute(ctx, [job, begin, end]()
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                    job(i);
+            });
+    }
+}
+
+bool JobSystem::IsBusy(const JobContext& ctx)
+{
+    return ctx.pending.load(std::memory_order_acquire) > 0;
+}
+
+void JobSystem::Wait(const JobContext& ctx)
+{
+    while (IsBusy(ctx))
+    {
+        // Help out instead of blocking the calling thread
+        Job job;
+        if (TryPop(job))
+            RunJob(job);
+        else
+            std::this_thread::yield();
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace Engine::Core
+{
+    // Tracks the jobs submitted against it so callers can wait on a batch.
+    struct JobContext
+    {
+        std::atomic<uint32_t> pending{ 0 };
+    };
+
+    // Small fixed-size worker pool shared by the importers, streamers and
+    // per-frame CPU work (culling, light assignment).
+    class JobSystem
+    {
+    public:
+        // workerCount == 0 picks hardware_concurrency - 1.
+        static void Initialize(uint32_t workerCount = 0);
+        static void Shutdown();
+
+        static uint32_t GetWorkerCount();
+
+        // Queue a single job.
+        static void Execute(JobContext& ctx, std::function<void()> job);
+
+        // Run job(index) for index in [0, jobCount), split into groups of groupSize.
+        static void Dispatch(JobContext& ctx, uint32_t jobCount, uint32_t groupSize,
+            const std::function<void(uint32_t index)>& job);
+
+        static bool IsBusy(const JobContext& ctx);
+
+        // Blocks until ctx has no pending jobs, running queued jobs meanwhile.
+        static void Wait(const JobContext& ctx);
+    };
+}
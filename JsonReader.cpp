@@ -0,0 +1,369 @@
+#include "JsonReader.h"
+
+#include <charconv>
+#include <cstring>
+
+using namespace Engine::Core;
+
+static void AppendUtf8(std::string& out, uint32_t cp)
+{
+    if (cp < 0x80)
+    {
+        out += (char)cp;
+    }
+    else if (cp < 0x800)
+    {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+static bool ParseHex4(std::string_view s, size_t pos, uint32_t& out)
+{
+    if (pos + 4 > s.size())
+        return false;
+
+    out = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        char c = s[pos + i];
+        out <<= 4;
+        if (c >= '0' && c <= '9') out |= (uint32_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') out |= (uint32_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') out |= (uint32_t)(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+JsonReader::JsonReader(std::string_view text)
+    : m_text(text)
+{
+}
+
+bool JsonReader::Fail()
+{
+    m_error = true;
+    return false;
+}
+
+void JsonReader::SkipWhitespace()
+{
+    while (m_pos < m_text.size())
+    {
+        char c = m_text[m_pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+            break;
+        ++m_pos;
+    }
+}
+
+bool JsonReader::Expect(char c)
+{
+    SkipWhitespace();
+    if (m_pos >= m_text.size() || m_text[m_pos] != c)
+        return Fail();
+    ++m_pos;
+    return true;
+}
+
+JsonType JsonReader::Peek()
+{
+    if (m_error)
+        return JsonType::Invalid;
+
+    SkipWhitespace();
+    if (m_pos >= m_text.size())
+        return JsonType::Invalid;
+
+    switch (m_text[m_pos])
+    {
+    case '{': return JsonType::Object;
+    case '[': return JsonType::Array;
+    case '"': return JsonType::String;
+    case 't':
+    case 'f': return JsonType::Bool;
+    case 'n': return JsonType::Null;
+    default:  return JsonType::Number;
+    }
+}
+
+bool JsonReader::BeginObject()
+{
+    if (m_error || !Expect('{'))
+        return false;
+    m_first.push_back(true);
+    return true;
+}
+
+bool JsonReader::BeginArray()
+{
+    if (m_error || !Expect('['))
+        return false;
+    m_first.push_back(true);
+    return true;
+}
+
+bool JsonReader::NextItem(char close)
+{
+    if (m_error || m_first.empty())
+        return false;
+
+    SkipWhitespace();
+    if (m_pos >= m_text.size())
+        return Fail();
+
+    if (m_text[m_pos] == close)
+    {
+        ++m_pos;
+        m_first.pop_back();
+        return false;
+    }
+
+    if (!m_first.back())
+    {
+        if (!Expect(','))
+            return false;
+    }
+    m_first.back() = false;
+    return true;
+}
+
+bool JsonReader::NextMember(std::string& key)
+{
+    if (!NextItem('}'))
+        return false;
+
+    if (!ReadString(key))
+        return false;
+
+    return Expect(':');
+}
+
+bool JsonReader::NextElement()
+{
+    return NextItem(']');
+}
+
+bool JsonReader::ReadString(std::string& out)
+{
+    out.clear();
+    if (m_error || !Expect('"'))
+        return false;
+
+    // Fast path: copy runs without escapes in one go
+    for (;;)
+    {
+        size_t start = m_pos;
+        while (m_pos < m_text.size() && m_text[m_pos] != '"' && m_text[m_pos] != '\\')
+            ++m_pos;
+
+        out.append(m_text.data() + start, m_pos - start);
+
+        if (m_pos >= m_text.size())
+            return Fail();
+
+        if (m_text[m_pos] == '"')
+        {
+            ++m_pos;
+            return true;
+        }
+
+        // Escape sequence
+        ++m_pos;
+        if (m_pos >= m_text.size())
+            return Fail();
+
+        char e = m_text[m_pos++];
+        switch (e)
+        {
+        case '"':  out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/':  out += '/'; break;
+        case 'b':  out += '\b'; break;
+        case 'f':  out += '\f'; break;
+        case 'n':  out += '\n'; break;
+        case 'r':  out += '\r'; break;
+        case 't':  out += '\t'; break;
+        case 'u':
+        {
+            uint32_t cp = 0;
+            if (!ParseHex4(m_text, m_pos, cp))
+                return Fail();
+            m_pos += 4;
+
+            // Surrogate pair
+            if (cp >= 0xD800 && cp <= 0xDBFF &&
+                m_pos + 6 <= m_text.size() && m_text[m_pos] == '\\' && m_text[m_pos + 1] == 'u')
+            {
+                uint32_t lo = 0;
+                if (ParseHex4(m_text, m_pos + 2, lo) && lo >= 0xDC00 && lo <= 0xDFFF)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    m_pos += 6;
+                }
+            }
+            AppendUtf8(out, cp);
+            break;
+        }
+        default:
+            return Fail();
+        }
+    }
+}
+
+bool JsonReader::ReadNumber(double& out)
+{
+    if (m_error)
+        return false;
+
+    SkipWhitespace();
+    const char* begin = m_text.data() + m_pos;
+    const char* end = m_text.data() + m_text.size();
+
+    // from_chars does not accept a leading '+', JSON does not either
+    auto result = std::from_chars(begin, end, out);
+    if (result.ec != std::errc())
+        return Fail();
+
+    m_pos += (size_t)(result.ptr - begin);
+    return true;
+}
+
+bool JsonReader::ReadFloat(float& out)
+{
+    double d = 0.0;
+    if (!ReadNumber(d))
+        return false;
+    out = (float)d;
+    return true;
+}
+
+bool JsonReader::ReadInt(int& out)
+{
+    double d = 0.0;
+    if (!ReadNumber(d))
+        return false;
+    out = (int)d;
+    return true;
+}
+
+bool JsonReader::ReadUInt(uint32_t& out)
+{
+    double d = 0.0;
+    if (!ReadNumber(d) || d < 0.0)
+        return Fail();
+    out = (uint32_t)d;
+    return true;
+}
+
+bool JsonReader::ReadSize(size_t& out)
+{
+    double d = 0.0;
+    if (!ReadNumber(d) || d < 0.0)
+        return Fail();
+    out = (size_t)d;
+    return true;
+}
+
+bool JsonReader::ReadBool(bool& out)
+{
+    if (m_error)
+        return false;
+
+    SkipWhitespace();
+    if (m_text.compare(m_pos, 4, "true") == 0)
+    {
+        m_pos += 4;
+        out = true;
+        return true;
+    }
+    if (m_text.compare(m_pos, 5, "false") == 0)
+    {
+        m_pos += 5;
+        out = false;
+        return true;
+    }
+    return Fail();
+}
+
+bool JsonReader::ReadFloatArray(float* out, size_t count)
+{
+    if (!BeginArray())
+        return false;
+
+    size_t i = 0;
+    while (NextElement())
+    {
+        float v = 0.0f;
+        if (!ReadFloat(v))
+            return false;
+        if (i < count)
+            out[i] = v;
+        ++i;
+    }
+    return !m_error;
+}
+
+bool JsonReader::Skip()
+{
+    switch (Peek())
+    {
+    case JsonType::Object:
+    {
+        std::string key;
+        BeginObject();
+        while (NextMember(key))
+        {
+            if (!Skip())
+                return false;
+        }
+        return !m_error;
+    }
+    case JsonType::Array:
+    {
+        BeginArray();
+        while (NextElement())
+        {
+            if (!Skip())
+                return false;
+        }
+        return !m_error;
+    }
+    case JsonType::String:
+    {
+        std::string tmp;
+        return ReadString(tmp);
+    }
+    case JsonType::Bool:
+    {
+        bool b;
+        return ReadBool(b);
+    }
+    case JsonType::Null:
+        if (m_text.compare(m_pos, 4, "null") != 0)
+            return Fail();
+        m_pos += 4;
+        return true;
+    case JsonType::Number:
+    {
+        double d;
+        return ReadNumber(d);
+    }
+    default:
+        return Fail();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Engine::Core
+{
+    enum class JsonType
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+        Invalid
+    };
+
+    // Forward-only pull parser. Values are consumed as they are read, no DOM
+    // is built. The source text must outlive the reader.
+    //
+    //   reader.BeginObject();
+    //   std::string key;
+    //   while (reader.NextMember(key)) { if (key == "x") reader.ReadFloat(x); else reader.Skip(); }
+    class JsonReader
+    {
+    public:
+        explicit JsonReader(std::string_view text);
+
+        JsonType Peek();
+
+        // Objects: BeginObject, then NextMember until it returns false.
+        bool BeginObject();
+        bool NextMember(std::string& key);
+
+        // Arrays: BeginArray, then NextElement until it returns false.
+        bool BeginArray();
+        bool NextElement();
+
+        bool ReadString(std::string& out);
+        bool ReadNumber(double& out);
+        bool ReadFloat(float& out);
+        bool ReadInt(int& out);
+        bool ReadUInt(uint32_t& out);
+        bool ReadSize(size_t& out);
+        bool ReadBool(bool& out);
+
+        // Reads up to count numbers from an array value.
+        bool ReadFloatArray(float* out, size_t count);
+
+        // Skips over the next value, whatever its type.
+        bool Skip();
+
+        bool HasError() const { return m_error; }
+        size_t GetOffset() const { return m_pos; }
+
+    private:
+        std::string_view m_text;
+        size_t m_pos = 0;
+        bool m_error = false;
+        std::vector<bool> m_first; // one entry per open object/array
+
+        void SkipWhitespace();
+        bool Expect(char c);
+        bool Fail();
+        bool NextItem(char close);
+    };
+}
@@ -0,0 +1,238 @@
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <xmmintrin.h>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+namespace
+{
+    // Squared distance from the sphere center to the box, the same
+    // operations in the same order as the SSE path so both agree bit for bit
+    float DistanceSquared(float c, float lo, float hi)
+    {
+        float d = (std::max)(lo - c, 0.0f) + (std::max)(c - hi, 0.0f);
+        return d * d;
+    }
+}
+
+LightClusterGrid::LightClusterGrid(const ClusterGridConfig& config)
+    : m_config(config)
+{
+}
+
+void LightClusterGrid::SetProjection(float fovY, float aspect, float nearZ, float farZ)
+{
+    const float projection[4] = { fovY, aspect, nearZ, farZ };
+    if (!m_bounds.empty() && memcmp(projection, m_projection, sizeof(projection)) == 0)
+        return;
+    memcpy(m_projection, projection, sizeof(projection));
+
+    const uint32_t slices = m_config.slices;
+    const float logRatio = logf(farZ / nearZ);
+    m_depthScale = slices / logRatio;
+    m_depthBias = -(slices * logf(nearZ)) / logRatio;
+
+    const float tanY = tanf(fovY * 0.5f);
+    const float tanX = tanY * aspect;
+    const uint32_t tiles = GetTilesPerSlice();
+    const uint32_t padded = (tiles + 3) & ~3u;
+
+    m_bounds.assign(slices, SliceBounds());
+    for (uint32_t s = 0; s < slices; ++s)
+    {
+        SliceBounds& bounds = m_bounds[s];
+        bounds.nearZ = nearZ * powf(farZ / nearZ, (float)s / slices);
+        bounds.farZ = nearZ * powf(farZ / nearZ, (float)(s + 1) / slices);
+
+        // Padding lanes get inverted boxes, their distance is infinite
+        bounds.minX.assign(padded, FLT_MAX);
+        bounds.minY.assign(padded, FLT_MAX);
+        bounds.minZ.assign(padded, FLT_MAX);
+        bounds.maxX.assign(padded, -FLT_MAX);
+        bounds.maxY.assign(padded, -FLT_MAX);
+        bounds.maxZ.assign(padded, -FLT_MAX);
+
+        for (uint32_t ty = 0; ty < m_config.tilesY; ++ty)
+        {
+            // Row 0 is the top of the screen, as SV_Position counts
+            float ndcTop = 1.0f - 2.0f * ty / m_config.tilesY;
+            float ndcBottom = 1.0f - 2.0f * (ty + 1) / m_config.tilesY;
+
+            for (uint32_t tx = 0; tx < m_config.tilesX; ++tx)
+            {
+                float ndcLeft = -1.0f + 2.0f * tx / m_config.tilesX;
+                float ndcRight = -1.0f + 2.0f * (tx + 1) / m_config.tilesX;
+
+                // The froxel edges are linear in depth: the extremes are on the near or far face
+                uint32_t t = ty * m_config.tilesX + tx;
+                bounds.minX[t] = (std::min)(ndcLeft * tanX * bounds.nearZ, ndcLeft * tanX * bounds.farZ);
+                bounds.maxX[t] = (std::max)(ndcRight * tanX * bounds.nearZ, ndcRight * tanX * bounds.farZ);
+                bounds.minY[t] = (std::min)(ndcBottom * tanY * bounds.nearZ, ndcBottom * tanY * bounds.farZ);
+                bounds.maxY[t] = (std::max)(ndcTop * tanY * bounds.nearZ, ndcTop * tanY * bounds.farZ);
+                bounds.minZ[t] = bounds.nearZ;
+                bounds.maxZ[t] = bounds.farZ;
+            }
+        }
+    }
+}
+
+uint32_t LightClusterGrid::GetSlice(float viewZ) const
+{
+    float slice = logf((std::max)(viewZ, FLT_MIN)) * m_depthScale + m_depthBias;
+    return (uint32_t)(std::min)((std::max)(slice, 0.0f), (float)(m_config.slices - 1));
+}
+
+void LightClusterGrid::Assign(const LightSphere* lights, uint32_t count)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    const uint32_t slices = m_config.slices;
+    const uint32_t tiles = GetTilesPerSlice();
+    m_scratch.resize(slices);
+
+    JobSystem::Dispatch(m_jobs, slices, 1, [this, lights, count](uint32_t slice)
+        {
+            AssignSlice(slice, lights, count);
+        });
+    JobSystem::Wait(m_jobs);
+
+    // -----------------------------
+    // Merge the slice lists
+    // -----------------------------
+    m_stats = ClusterStats();
+    m_stats.lights = count;
+    m_cells.resize(GetClusterCount());
+    m_indices.clear();
+
+    for (uint32_t s = 0; s < slices; ++s)
+    {
+        const SliceScratch& scratch = m_scratch[s];
+        uint32_t base = (uint32_t)m_indices.size();
+        for (uint32_t t = 0; t < tiles; ++t)
+        {
+            ClusterCell cell = scratch.cells[t];
+            cell.offset += base;
+            m_cells[s * tiles + t] = cell;
+
+            m_stats.maxPerCluster = (std::max)(m_stats.maxPerCluster, cell.count);
+            m_stats.occupiedClusters += cell.count > 0 ? 1 : 0;
+        }
+        m_indices.insert(m_indices.end(), scratch.indices.begin(), scratch.indices.end());
+    }
+
+    m_stats.references = (uint32_t)m_indices.size();
+    m_stats.assignMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void LightClusterGrid::AssignSlice(uint32_t slice, const LightSphere* lights, uint32_t count)
+{
+    const SliceBounds& bounds = m_bounds[slice];
+    SliceScratch& scratch = m_scratch[slice];
+    const uint32_t tiles = GetTilesPerSlice();
+    const uint32_t padded = (uint32_t)bounds.minX.size();
+
+    // -----------------------------
+    // Depth prefilter: loose, the box test below is the exact one
+    // -----------------------------
+    scratch.candidates.clear();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const LightSphere& light = lights[i];
+        float reach = light.radius * 1.001f + 1e-4f;
+        if (light.z + reach >= bounds.nearZ && light.z - reach <= bounds.farZ)
+            scratch.candidates.push_back(i);
+    }
+
+    const uint32_t candidateCount = (uint32_t)scratch.candidates.size();
+    const uint32_t words = (candidateCount + 63) / 64;
+    scratch.hits.assign((size_t)tiles * words, 0);
+
+    // -----------------------------
+    // Sphere vs froxel boxes, four tiles per test
+    // -----------------------------
+    const __m128 zero = _mm_setzero_ps();
+    for (uint32_t j = 0; j < candidateCount; ++j)
+    {
+        const LightSphere& light = lights[scratch.candidates[j]];
+        const __m128 cx = _mm_set1_ps(light.x);
+        const __m128 cy = _mm_set1_ps(light.y);
+        const __m128 cz = _mm_set1_ps(light.z);
+        const __m128 r2 = _mm_set1_ps(light.radius * light.radius);
+        const uint64_t bit = 1ull << (j & 63);
+        uint64_t* column = scratch.hits.data() + j / 64;
+
+        for (uint32_t t = 0; t < padded; t += 4)
+        {
+            __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&bounds.minX[t]), cx), zero),
+                _mm_max_ps(_mm_sub_ps(cx, _mm_loadu_ps(&bounds.maxX[t])), zero));
+            __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&bounds.minY[t]), cy), zero),
+                _mm_max_ps(_mm_sub_ps(cy, _mm_loadu_ps(&bounds.maxY[t])), zero));
+            __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&bounds.minZ[t]), cz), zero),
+                _mm_max_ps(_mm_sub_ps(cz, _mm_loadu_ps(&bounds.maxZ[t])), zero));
+
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            int mask = _mm_movemask_ps(_mm_cmple_ps(d2, r2));
+            while (mask)
+            {
+                int lane = std::countr_zero((uint32_t)mask);
+                column[(size_t)(t + lane) * words] |= bit;
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    // -----------------------------
+    // Bit rows to index lists, ascending light order
+    // -----------------------------
+    scratch.cells.resize(tiles);
+    scratch.indices.clear();
+    for (uint32_t t = 0; t < tiles; ++t)
+    {
+        ClusterCell& cell = scratch.cells[t];
+        cell.offset = (uint32_t)scratch.indices.size();
+
+        const uint64_t* row = scratch.hits.data() + (size_t)t * words;
+        for (uint32_t w = 0; w < words; ++w)
+        {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1)
+                scratch.indices.push_back(scratch.candidates[w * 64 + std::countr_zero(bits)]);
+        }
+        cell.count = (uint32_t)scratch.indices.size() - cell.offset;
+    }
+}
+
+void LightClusterGrid::AssignReference(const LightSphere* lights, uint32_t count,
+    std::vector<ClusterCell>& outCells, std::vector<uint32_t>& outIndices) const
+{
+    const uint32_t tiles = GetTilesPerSlice();
+    outCells.assign(GetClusterCount(), ClusterCell());
+    outIndices.clear();
+
+    for (uint32_t s = 0; s < m_config.slices; ++s)
+    {
+        const SliceBounds& bounds = m_bounds[s];
+        for (uint32_t t = 0; t < tiles; ++t)
+        {
+            ClusterCell& cell = outCells[s * tiles + t];
+            cell.offset = (uint32_t)outIndices.size();
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const LightSphere& light = lights[i];
+                float dx2 = DistanceSquared(light.x, bounds.minX[t], bounds.maxX[t]);
+                float dy2 = DistanceSquared(light.y, bounds.minY[t], bounds.maxY[t]);
+                float dz2 = DistanceSquared(light.z, bounds.minZ[t], bounds.maxZ[t]);
+                if (dx2 + dy2 + dz2 <= light.radius * light.radius)
+                    outIndices.push_back(i);
+            }
+            cell.count = (uint32_t)outIndices.size() - cell.offset;
+        }
+    }
+}
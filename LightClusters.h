@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "JobSystem.h"
+
+namespace Engine::Graphics
+{
+    // Light bounds in view space (left-handed, +z into the screen)
+    struct LightSphere
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float radius = 0.0f;
+    };
+
+    struct ClusterGridConfig
+    {
+        uint32_t tilesX = 16;
+        uint32_t tilesY = 9;
+        uint32_t slices = 24;   // exponential in view depth, so near froxels stay small
+    };
+
+    // Light list of one froxel: indices[offset, offset + count)
+    struct ClusterCell
+    {
+        uint32_t offset = 0;
+        uint32_t count = 0;
+    };
+
+    struct ClusterStats
+    {
+        uint32_t lights = 0;
+        uint32_t references = 0;        // index list length
+        uint32_t maxPerCluster = 0;
+        uint32_t occupiedClusters = 0;
+        double assignMs = 0.0;
+    };
+
+    // Clustered shading on the CPU: splits the view frustum into froxels
+    // (screen tiles x depth slices) and lists, per froxel, the lights whose
+    // sphere touches it. Cells are ordered slice, then row (top first), then
+    // column, matching the pixel shader lookup. Lists keep ascending light
+    // order, so the result does not depend on the thread count.
+    class LightClusterGrid
+    {
+    public:
+        LightClusterGrid(const ClusterGridConfig& config = ClusterGridConfig());
+
+        // Rebuilds the froxel bounds when the projection changed, cheap otherwise
+        void SetProjection(float fovY, float aspect, float nearZ, float farZ);
+
+        // One job per depth slice, SSE sphere/AABB tests over four froxels at a time
+        void Assign(const LightSphere* lights, uint32_t count);
+
+        // Scalar test of every light against every froxel, for validation
+        void AssignReference(const LightSphere* lights, uint32_t count,
+            std::vector<ClusterCell>& outCells, std::vector<uint32_t>& outIndices) const;
+
+        const ClusterGridConfig& GetConfig() const { return m_config; }
+        uint32_t GetClusterCount() const { return m_config.tilesX * m_config.tilesY * m_config.slices; }
+        const std::vector<ClusterCell>& GetCells() const { return m_cells; }
+        const std::vector<uint32_t>& GetIndices() const { return m_indices; }
+        const ClusterStats& GetStats() const { return m_stats; }
+
+        // slice = log(viewZ) * scale + bias, what the pixel shader evaluates
+        float GetDepthScale() const { return m_depthScale; }
+        float GetDepthBias() const { return m_depthBias; }
+        uint32_t GetSlice(float viewZ) const;
+
+    private:
+        // Froxel bounds of one slice, structure of arrays padded to a multiple of 4
+        struct SliceBounds
+        {
+            float nearZ = 0.0f;
+            float farZ = 0.0f;
+            std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+        };
+
+        // Per-slice output, merged once every slice job is done
+        struct SliceScratch
+        {
+            std::vector<uint32_t> candidates;   // lights overlapping the slice depth range
+            std::vector<uint64_t> hits;         // tile-major bit rows over the candidates
+            std::vector<ClusterCell> cells;     // offsets local to indices
+            std::vector<uint32_t> indices;
+        };
+
+        ClusterGridConfig m_config;
+        float m_projection[4] = {};             // fovY, aspect, near, far
+        float m_depthScale = 0.0f;
+        float m_depthBias = 0.0f;
+        std::vector<SliceBounds> m_bounds;
+        std::vector<SliceScratch> m_scratch;
+
+        std::vector<ClusterCell> m_cells;
+        std::vector<uint32_t> m_indices;
+        ClusterStats m_stats;
+        Engine::Core::JobContext m_jobs;
+
+        uint32_t GetTilesPerSlice() const { return m_config.tilesX * m_config.tilesY; }
+        void AssignSlice(uint32_t slice, const LightSphere* lights, uint32_t count);
+    };
+
+} // namespace Engine::Graphics
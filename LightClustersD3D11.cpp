@@ -0,0 +1,75 @@
+#include "LightClustersD3D11.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Engine::Graphics;
+
+ClusteredLightBuffers::ClusteredLightBuffers(ID3D11Device* device)
+    : m_device(device)
+{
+}
+
+bool ClusteredLightBuffers::Write(ID3D11DeviceContext* context, StructuredBuffer& target, uint32_t stride,
+    const void* data, uint32_t count)
+{
+    // Grow by half again so a slowly rising light count does not recreate every frame
+    if (!target.buffer || count > target.capacity)
+    {
+        uint32_t capacity = (std::max)((std::max)(count + count / 2, target.capacity), 64u);
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = capacity * stride;
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = stride;
+
+        ComPtr<ID3D11Buffer> buffer;
+        if (FAILED(m_device->CreateBuffer(&desc, nullptr, buffer.GetAddressOf())))
+            return false;
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvDesc.Buffer.FirstElement = 0;
+        srvDesc.Buffer.NumElements = capacity;
+
+        ComPtr<ID3D11ShaderResourceView> view;
+        if (FAILED(m_device->CreateShaderResourceView(buffer.Get(), &srvDesc, view.GetAddressOf())))
+            return false;
+
+        target.buffer = buffer;
+        target.view = view;
+        target.capacity = capacity;
+    }
+
+    if (count == 0)
+        return true;
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(context->Map(target.buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        return false;
+    memcpy(mapped.pData, data, (size_t)count * stride);
+    context->Unmap(target.buffer.Get(), 0);
+    return true;
+}
+
+bool ClusteredLightBuffers::Update(ID3D11DeviceContext* context, const Light* lights, uint32_t lightCount,
+    const LightClusterGrid& grid)
+{
+    const std::vector<ClusterCell>& cells = grid.GetCells();
+    const std::vector<uint32_t>& indices = grid.GetIndices();
+
+    bool ok = Write(context, m_lights, sizeof(Light), lights, lightCount);
+    ok &= Write(context, m_cells, sizeof(ClusterCell), cells.data(), (uint32_t)cells.size());
+    ok &= Write(context, m_indices, sizeof(uint32_t), indices.data(), (uint32_t)indices.size());
+    return ok;
+}
+
+void ClusteredLightBuffers::Bind(ID3D11DeviceContext* context) const
+{
+    ID3D11ShaderResourceView* views[3] = { m_lights.view.Get(), m_cells.view.Get(), m_indices.view.Get() };
+    context->PSSetShaderResources(FIRST_SLOT, 3, views);
+}
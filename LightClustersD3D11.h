@@ -0,0 +1,41 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include "Light.h"
+#include "LightClusters.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // GPU side of the clustered lights, read by the forward pixel shader:
+    // t3 lights, t4 cells (offset, count per froxel), t5 light indices.
+    // Dynamic structured buffers, rewritten every frame and grown on demand.
+    class ClusteredLightBuffers
+    {
+    public:
+        static const UINT FIRST_SLOT = 3;
+
+        ClusteredLightBuffers(ID3D11Device* device);
+
+        bool Update(ID3D11DeviceContext* context, const Light* lights, uint32_t lightCount, const LightClusterGrid& grid);
+        void Bind(ID3D11DeviceContext* context) const;
+
+    private:
+        struct StructuredBuffer
+        {
+            ComPtr<ID3D11Buffer> buffer;
+            ComPtr<ID3D11ShaderResourceView> view;
+            uint32_t capacity = 0;
+        };
+
+        ComPtr<ID3D11Device> m_device;
+        StructuredBuffer m_lights;
+        StructuredBuffer m_cells;
+        StructuredBuffer m_indices;
+
+        bool Write(ID3D11DeviceContext* context, StructuredBuffer& target, uint32_t stride, const void* data, uint32_t count);
+    };
+
+} // namespace Engine::Graphics
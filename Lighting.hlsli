@@ -0,0 +1,430 @@
+// Lighting shared by the forward pixel shader and the deferred light pass:
+// the cbuffer lights (sun + cascaded shadows) and the clustered point lights.
+#ifndef LIGHTING_HLSLI
+#define LIGHTING_HLSLI
+
+#define LIGHT_DIRECTIONAL 0
+#define LIGHT_POINT 1
+#define MAX_LIGHTS 8 // cbuffer lights, clustered point lights are unbounded
+#define NUM_CASCADES 4
+
+#include "Evsm.hlsli"
+
+// ----------------------------------------------------
+// PERMUTATION KEYWORDS (Renderer::AddLightingFeatures)
+// Defaults give the generic shader: every branch taken at runtime.
+// ----------------------------------------------------
+#define SHADOW_QUALITY_OFF 0
+#define SHADOW_QUALITY_HARD 1     // single comparison tap
+#define SHADOW_QUALITY_SOFT 2     // gather PCF, kernel sized per cascade (ShadowFilter.h)
+#define SHADOW_QUALITY_POISSON 3  // 16-tap Poisson disk, radius per cascade
+#define SHADOW_QUALITY_EVSM 4     // one trilinear fetch of the prefiltered moments (Evsm.hlsli)
+
+#define LIGHT_MIX_DIRECTIONAL 0
+#define LIGHT_MIX_POINT 1
+#define LIGHT_MIX_MIXED 2         // branch on light.Type per light
+
+#ifndef SHADOW_QUALITY
+#define SHADOW_QUALITY SHADOW_QUALITY_SOFT
+#endif
+#ifndef LIGHT_MIX
+#define LIGHT_MIX LIGHT_MIX_MIXED
+#endif
+#ifndef CLUSTERED_LIGHTS
+#define CLUSTERED_LIGHTS 1        // point lights from the froxel lists (LightClusters.h)
+#endif
+
+static const float SHADOW_MAP_SIZE = 2048.0f;
+static const float SHADOW_ATLAS_SIZE = 4096.0f;
+
+struct Light
+{
+    int Type;
+    float3 Color;
+
+    float3 Direction;
+    float Range;
+
+    float3 Position;
+    float Intensity;
+};
+
+cbuffer CBLight : register(b1)
+{
+    int LightCount;
+    float3 CameraPosition;
+    Light Lights[MAX_LIGHTS];
+    uint4 ClusterDims;      // tiles x, tiles y, depth slices, clustered light count
+    float4 ClusterParams;   // xy = tiles per pixel, z = depth scale, w = depth bias
+};
+
+cbuffer CBShadow : register(b2)
+{
+    float4x4 LightViewProj[NUM_CASCADES];
+    float4 CascadeSplits; // view-space split depths
+    float4 CascadeFilterRadius; // kernel radius in texels per cascade
+    float4 ShadowFilterParams;  // x = cascade blend band (0 off), y = early-out
+    float4 EvsmParams;          // x = positive exponent, y = negative exponent, z = light bleeding reduction, w = min variance
+    float4 EvsmLodScale;        // per cascade: moment mip = log2(view depth * scale)
+};
+
+Texture2DArray ShadowMapArray : register(t1);
+#if SHADOW_QUALITY == SHADOW_QUALITY_EVSM
+Texture2DArray<float4> ShadowMomentArray : register(t9);
+#endif
+#if CLUSTERED_LIGHTS
+StructuredBuffer<Light> ClusterLights : register(t3);
+StructuredBuffer<uint2> ClusterCells : register(t4);     // offset, count into ClusterLightIndices
+StructuredBuffer<uint> ClusterLightIndices : register(t5);
+
+// Local light shadows (ShadowAtlasD3D11.h)
+struct ShadowTile
+{
+    float4x4 ViewProj;
+    float4 Rect;        // xy scale, zw offset: tile UV to atlas UV
+};
+
+Texture2D ShadowAtlas : register(t10);
+StructuredBuffer<ShadowTile> ShadowAtlasTiles : register(t11);
+StructuredBuffer<int> ClusterLightShadows : register(t12);  // first tile per clustered light, -1 without a shadow
+#endif
+
+SamplerComparisonState ShadowSampler : register(s1);
+#if SHADOW_QUALITY == SHADOW_QUALITY_EVSM
+SamplerState MomentSampler : register(s2);      // trilinear, clamp
+#endif
+
+// ----------------------------------------------------
+// CASCADE SELECTION
+// ----------------------------------------------------
+int SelectCascade(float viewDepth)
+{
+    if (viewDepth < CascadeSplits.x)
+        return 0;
+    if (viewDepth < CascadeSplits.y)
+        return 1;
+    if (viewDepth < CascadeSplits.z)
+        return 2;
+    return 3;
+}
+
+// ----------------------------------------------------
+// SHADOW FILTERS
+// Tap for tap the same as ShadowFilter.cpp, which has the tests
+// ----------------------------------------------------
+#define MAX_KERNEL_SIZE 7
+#define EARLY_OUT_TAPS 4
+
+// Castano's optimized PCF: the box of K x K bilinear taps, as (K + 1)^2 texel
+// compares weighted 1 inside and by the bilinear fraction on the edges,
+// fetched four at a time. K = 7 is 16 gathers instead of 49 taps.
+float FilterGatherPcf(float2 uv, float cascade, float depth, int kernelSize, bool earlyOut)
+{
+    float2 texel = uv * SHADOW_MAP_SIZE - 0.5f;
+    float2 base = floor(texel);
+    float2 f = texel - base;
+    int quads = (kernelSize + 1) / 2;
+    float2 start = base - (kernelSize - 1) / 2;
+
+    // The corner quads first: if all 16 compares agree the pixel is fully lit
+    // or fully shadowed. Only pays off once the corners are not the whole kernel.
+    if (earlyOut && quads > 2)
+    {
+        float last = quads - 1;
+        float4 sum =
+            ShadowMapArray.GatherCmpRed(ShadowSampler, float3((start + 1.0f) / SHADOW_MAP_SIZE, cascade), depth) +
+            ShadowMapArray.GatherCmpRed(ShadowSampler, float3((start + float2(2.0f * last, 0.0f) + 1.0f) / SHADOW_MAP_SIZE, cascade), depth) +
+            ShadowMapArray.GatherCmpRed(ShadowSampler, float3((start + float2(0.0f, 2.0f * last) + 1.0f) / SHADOW_MAP_SIZE, cascade), depth) +
+            ShadowMapArray.GatherCmpRed(ShadowSampler, float3((start + 2.0f * last + 1.0f) / SHADOW_MAP_SIZE, cascade), depth);
+        float lit = dot(sum, 1.0f);
+        if (lit == 0.0f || lit == 16.0f)
+            return lit / 16.0f;
+    }
+
+    float shadow = 0.0f;
+    [loop]
+    for (int y = 0; y < quads; ++y)
+    {
+        [loop]
+        for (int x = 0; x < quads; ++x)
+        {
+            // At the corner shared by four texel centers a gather returns exactly those four
+            float2 quad = start + float2(2 * x, 2 * y);
+            float4 c = ShadowMapArray.GatherCmpRed(ShadowSampler, float3((quad + 1.0f) / SHADOW_MAP_SIZE, cascade), depth);
+
+            // Gather order: x (0, 1), y (1, 1), z (1, 0), w (0, 0)
+            float2 wx = float2(x == 0 ? 1.0f - f.x : 1.0f, x == quads - 1 ? f.x : 1.0f);
+            float2 wy = float2(y == 0 ? 1.0f - f.y : 1.0f, y == quads - 1 ? f.y : 1.0f);
+            shadow += c.w * wx.x * wy.x + c.z * wx.y * wy.x + c.x * wx.x * wy.y + c.y * wx.y * wy.y;
+        }
+    }
+
+    return shadow / (kernelSize * kernelSize);
+}
+
+float FilterPoisson(float2 uv, float cascade, float depth, float radiusTexels, bool earlyOut)
+{
+    // The first four are spread out for the early-out
+    static const float2 poissonDisk[16] = {
+        float2(0.94558609, -0.76890725),
+        float2(-0.91588581, 0.45771432),
+        float2(0.97484398, 0.75648379),
+        float2(-0.81544232, -0.87912464),
+        float2(-0.94201624, -0.39906216),
+        float2(-0.094184101, -0.92938870),
+        float2(0.34495938, 0.29387760),
+        float2(-0.38277543, 0.27676845),
+        float2(0.44323325, -0.97511554),
+        float2(0.53742981, -0.47373420),
+        float2(-0.26496911, -0.41893023),
+        float2(0.79197514, 0.19090188),
+        float2(-0.24188840, 0.99706507),
+        float2(-0.81409955, 0.91437590),
+        float2(0.19984126, 0.78641367),
+        float2(0.14383161, -0.14100790)
+    };
+
+    float radius = radiusTexels / SHADOW_MAP_SIZE;
+    float shadow = 0.0f;
+
+    [unroll]
+    for (int i = 0; i < EARLY_OUT_TAPS; ++i)
+        shadow += ShadowMapArray.SampleCmpLevelZero(ShadowSampler, float3(uv + poissonDisk[i] * radius, cascade), depth);
+
+    if (earlyOut && (shadow == 0.0f || shadow == EARLY_OUT_TAPS))
+        return shadow / EARLY_OUT_TAPS;
+
+    [unroll]
+    for (int j = EARLY_OUT_TAPS; j < 16; ++j)
+        shadow += ShadowMapArray.SampleCmpLevelZero(ShadowSampler, float3(uv + poissonDisk[j] * radius, cascade), depth);
+
+    return shadow / 16.0f;
+}
+
+// One cascade's filtered shadow, 1 outside its map
+float FilterCascade(float3 posWS, float viewDepth, int cascadeIndex, float bias)
+{
+    float4 shadowPos = mul(float4(posWS, 1.0f), LightViewProj[cascadeIndex]);
+    float3 proj = shadowPos.xyz / shadowPos.w;
+
+    proj.xy = proj.xy * 0.5f + 0.5f;
+    proj.y = 1.0f - proj.y;
+
+    if (proj.x < 0 || proj.x > 1 ||
+        proj.y < 0 || proj.y > 1 ||
+        proj.z < 0 || proj.z > 1)
+        return 1.0f;
+
+#if SHADOW_QUALITY == SHADOW_QUALITY_EVSM
+    // The mip comes from the pixel's footprint in the cascade rather than from
+    // derivatives, which the cascade select and blend branches make unreliable.
+    // The moments need no depth bias.
+    float lod = log2(max(viewDepth * EvsmLodScale[cascadeIndex], 1.0f));
+    float4 moments = ShadowMomentArray.SampleLevel(MomentSampler, float3(proj.xy, cascadeIndex), lod);
+    return ComputeEvsmShadow(moments, proj.z, EvsmParams);
+#else
+    float depth = proj.z - bias;
+
+#if SHADOW_QUALITY == SHADOW_QUALITY_HARD
+    return ShadowMapArray.SampleCmpLevelZero(ShadowSampler, float3(proj.xy, cascadeIndex), depth);
+#else
+    // Per-cascade radius keeps the penumbra about the same width in the world
+    float radius = CascadeFilterRadius[cascadeIndex];
+    bool earlyOut = ShadowFilterParams.y != 0.0f;
+#if SHADOW_QUALITY == SHADOW_QUALITY_POISSON
+    return FilterPoisson(proj.xy, cascadeIndex, depth, radius, earlyOut);
+#else
+    int kernelSize = clamp(2 * (int)floor(radius + 0.5f) + 1, 1, MAX_KERNEL_SIZE);
+    return FilterGatherPcf(proj.xy, cascadeIndex, depth, kernelSize, earlyOut);
+#endif
+#endif
+#endif
+}
+
+// ----------------------------------------------------
+// CASCADED SHADOW
+// ----------------------------------------------------
+float CalculateCascadedShadow(
+    float3 posWS,
+    float viewDepth,
+    float3 normalWS,
+    float3 lightDir)
+{
+#if SHADOW_QUALITY == SHADOW_QUALITY_OFF
+    return 1.0f;
+#else
+    int cascadeIndex = SelectCascade(viewDepth);
+    float bias = max(0.001f * (1.0f - dot(normalWS, lightDir)), 0.0002f);
+    float shadow = FilterCascade(posWS, viewDepth, cascadeIndex, bias);
+
+    // Cross-fade into the next cascade over the last part of this one, so the
+    // switch in resolution does not show as a line. Only pixels in the band pay.
+    float band = ShadowFilterParams.x;
+    if (band > 0.0f && cascadeIndex < NUM_CASCADES - 1)
+    {
+        float splitNear = cascadeIndex > 0 ? CascadeSplits[cascadeIndex - 1] : 0.0f;
+        float splitFar = CascadeSplits[cascadeIndex];
+        float width = band * (splitFar - splitNear);
+        float blend = saturate((viewDepth - (splitFar - width)) / width);
+        if (blend > 0.0f)
+            shadow = lerp(shadow, FilterCascade(posWS, viewDepth, cascadeIndex + 1, bias), blend);
+    }
+
+    return shadow;
+#endif
+}
+
+// ----------------------------------------------------
+// LIGHT EVALUATION
+// ----------------------------------------------------
+void EvaluateDirectional(Light light, float3 posWS, float viewDepth, float3 N,
+    out float3 L, out float attenuation, out float shadow)
+{
+    L = normalize(-light.Direction);
+    attenuation = 1.0f;
+    shadow = CalculateCascadedShadow(posWS, viewDepth, N, L);
+}
+
+void EvaluatePoint(Light light, float3 posWS,
+    out float3 L, out float attenuation, out float shadow)
+{
+    float3 toLight = light.Position - posWS;
+    float dist = length(toLight);
+    L = toLight / dist;
+
+    attenuation = saturate(1.0f - dist / light.Range);
+    attenuation *= attenuation;
+    shadow = 1.0f;
+}
+
+// Blinn-Phong exponent, DEFAULT_ROUGHNESS gives 16
+float RoughnessToSpecPower(float roughness)
+{
+    return 2.0f / max(roughness * roughness, 1e-4f) - 2.0f;
+}
+
+float3 ShadeLight(Light light, float3 albedo, float specPower, float3 N, float3 V, float3 L,
+    float attenuation, float shadow)
+{
+    float diff = max(dot(N, L), 0.0f);
+    float3 H = normalize(L + V);
+    float spec = pow(max(dot(N, H), 0.0f), specPower);
+
+    return
+        albedo *
+        (diff + spec * 0.25f) *
+        light.Color *
+        light.Intensity *
+        attenuation *
+        shadow;
+}
+
+// ----------------------------------------------------
+// POINT LIGHT SHADOWS
+// Six atlas tiles per light, one 90 degree frustum per cube face
+// ----------------------------------------------------
+#if CLUSTERED_LIGHTS
+// Same face order as ShadowAtlas.h: +X, -X, +Y, -Y, +Z, -Z
+uint SelectCubeFace(float3 v)
+{
+    float3 a = abs(v);
+    if (a.x >= a.y && a.x >= a.z)
+        return v.x >= 0.0f ? 0 : 1;
+    if (a.y >= a.z)
+        return v.y >= 0.0f ? 2 : 3;
+    return v.z >= 0.0f ? 4 : 5;
+}
+
+float CalculatePointShadow(int firstTile, Light light, float3 posWS, float3 normalWS)
+{
+    float3 fromLight = posWS - light.Position;
+    ShadowTile tile = ShadowAtlasTiles[firstTile + SelectCubeFace(fromLight)];
+    float tileTexels = tile.Rect.x * SHADOW_ATLAS_SIZE;
+
+    // Normal offset of about a texel at this distance: a face spans twice the distance
+    float texelWorld = 2.0f * length(fromLight) / tileTexels;
+    float4 shadowPos = mul(float4(posWS + normalWS * 1.5f * texelWorld, 1.0f), tile.ViewProj);
+    float3 proj = shadowPos.xyz / shadowPos.w;
+
+    // The bilinear footprint stays inside the tile, the neighbours are other lights
+    float2 uv = float2(proj.x * 0.5f + 0.5f, 0.5f - proj.y * 0.5f);
+    uv = clamp(uv, 0.5f / tileTexels, 1.0f - 0.5f / tileTexels);
+
+    return ShadowAtlas.SampleCmpLevelZero(ShadowSampler, uv * tile.Rect.xy + tile.Rect.zw, proj.z);
+}
+#endif
+
+// ----------------------------------------------------
+// CLUSTER LOOKUP
+// Same froxel as LightClusterGrid: slice from log depth,
+// tile from the pixel, row 0 at the top of the screen
+// ----------------------------------------------------
+#if CLUSTERED_LIGHTS
+uint GetClusterIndex(float2 pixel, float viewDepth)
+{
+    float slice = log(max(viewDepth, 1e-6f)) * ClusterParams.z + ClusterParams.w;
+    uint z = (uint)clamp(slice, 0.0f, (float)(ClusterDims.z - 1));
+    uint2 tile = min((uint2)(pixel * ClusterParams.xy), ClusterDims.xy - 1);
+    return (z * ClusterDims.y + tile.y) * ClusterDims.x + tile.x;
+}
+#endif
+
+// ----------------------------------------------------
+// SURFACE LIGHTING
+// pixel is SV_Position.xy, viewDepth the view-space z
+// ----------------------------------------------------
+float3 ComputeLighting(float3 posWS, float viewDepth, float2 pixel, float3 N, float3 albedo, float roughness)
+{
+    float3 V = normalize(CameraPosition - posWS);
+    float specPower = RoughnessToSpecPower(roughness);
+
+    // Ambient light so shadows aren't pitch black
+    float3 color = albedo * 0.15f;
+
+    for (int i = 0; i < LightCount; ++i)
+    {
+        Light light = Lights[i];
+
+        float3 L;
+        float attenuation;
+        float shadow;
+
+#if LIGHT_MIX == LIGHT_MIX_DIRECTIONAL
+        EvaluateDirectional(light, posWS, viewDepth, N, L, attenuation, shadow);
+#elif LIGHT_MIX == LIGHT_MIX_POINT
+        EvaluatePoint(light, posWS, L, attenuation, shadow);
+#else
+        if (light.Type == LIGHT_DIRECTIONAL)
+            EvaluateDirectional(light, posWS, viewDepth, N, L, attenuation, shadow);
+        else
+            EvaluatePoint(light, posWS, L, attenuation, shadow);
+#endif
+
+        color += ShadeLight(light, albedo, specPower, N, V, L, attenuation, shadow);
+    }
+
+#if CLUSTERED_LIGHTS
+    // Only the lights whose range touches this pixel's froxel
+    uint2 cell = ClusterCells[GetClusterIndex(pixel, viewDepth)];
+    for (uint c = 0; c < cell.y; ++c)
+    {
+        uint lightIndex = ClusterLightIndices[cell.x + c];
+        Light light = ClusterLights[lightIndex];
+
+        float3 L;
+        float attenuation;
+        float shadow;
+        EvaluatePoint(light, posWS, L, attenuation, shadow);
+
+        int firstTile = ClusterLightShadows[lightIndex];
+        if (firstTile >= 0 && attenuation > 0.0f)
+            shadow = CalculatePointShadow(firstTile, light, posWS, N);
+
+        color += ShadeLight(light, albedo, specPower, N, V, L, attenuation, shadow);
+    }
+#endif
+
+    return color;
+}
+
+#endif // LIGHTING_HLSLI
@@ -68,6 +68,8 @@ bool Mesh::CreateCube(ID3D11Device* device)
     };
 
     m_indexCount = _countof(indices);
+    BoundingBox::CreateFromPoints(m_bounds, _countof(vertices), &vertices[0].Position, sizeof(Vertex));
+    KeepOccluderGeometry(vertices, _countof(vertices), indices, _countof(indices));
 
     // ----------------------------
     // VERTEX BUFFER
@@ -121,6 +123,8 @@ bool Mesh::CreatePlane(ID3D11Device* device)
     };
 
     m_indexCount = 6;
+    BoundingBox::CreateFromPoints(m_bounds, _countof(vertices), &vertices[0].Position, sizeof(Vertex));
+    KeepOccluderGeometry(vertices, _countof(vertices), indices, _countof(indices));
 
     D3D11_BUFFER_DESC vbDesc = {};
     vbDesc.Usage = D3D11_USAGE_DEFAULT;
@@ -145,6 +149,46 @@ bool Mesh::CreatePlane(ID3D11Device* device)
     return true;
 }
 
+bool Mesh::Create(ID3D11Device* device, const Vertex* vertices, size_t vertexCount,
+    const uint32_t* indices, size_t indexCount)
+{
+    if (!device || !vertices || !indices || vertexCount == 0 || indexCount == 0)
+    {
+        return false;
+    }
+
+    m_indexCount = (UINT)indexCount;
+    BoundingBox::CreateFromPoints(m_bounds, vertexCount, &vertices[0].Position, sizeof(Vertex));
+    KeepOccluderGeometry(vertices, vertexCount, indices, indexCount);
+
+    D3D11_BUFFER_DESC vbDesc = {};
+    vbDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    vbDesc.ByteWidth = (UINT)(sizeof(Vertex) * vertexCount);
+    vbDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+    D3D11_SUBRESOURCE_DATA vbData = {};
+    vbData.pSysMem = vertices;
+
+    if (FAILED(device->CreateBuffer(&vbDesc, &vbData, m_vertexBuffer.GetAddressOf())))
+    {
+        return false;
+    }
+
+    D3D11_BUFFER_DESC ibDesc = {};
+    ibDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    ibDesc.ByteWidth = (UINT)(sizeof(uint32_t) * indexCount);
+    ibDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+    D3D11_SUBRESOURCE_DATA ibData = {};
+    ibData.pSysMem = indices;
+
+    if (FAILED(device->CreateBuffer(&ibDesc, &ibData, m_indexBuffer.GetAddressOf())))
+    {
+        return false;
+    }
+
+    return true;
+}
 
 
 void Mesh::Draw(ID3D11DeviceContext* context)
@@ -161,9 +205,52 @@ void Mesh::Draw(ID3D11DeviceContext* context)
     context->DrawIndexed(m_indexCount, 0, 0);
 }
 
+void Mesh::DrawInstanced(ID3D11DeviceContext* context, UINT instanceCount)
+{
+    if (!context || !m_vertexBuffer) return;
+
+    UINT stride = sizeof(Vertex);
+    UINT offset = 0;
+
+    context->IASetVertexBuffers(0, 1, m_vertexBuffer.GetAddressOf(), &stride, &offset);
+    context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    context->DrawIndexedInstanced(m_indexCount, instanceCount, 0, 0, 0);
+}
+
+void Mesh::DrawIndirect(ID3D11DeviceContext* context, ID3D11Buffer* args, UINT argsOffset)
+{
+    if (!context || !m_vertexBuffer || !args) return;
+
+    UINT stride = sizeof(Vertex);
+    UINT offset = 0;
+
+    context->IASetVertexBuffers(0, 1, m_vertexBuffer.GetAddressOf(), &stride, &offset);
+    context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    context->DrawIndexedInstancedIndirect(args, argsOffset);
+}
+
 void Mesh::Release()
 {
     m_vertexBuffer.Reset();
 	m_indexBuffer.Reset();
 	m_indexCount = 0;
+    m_occluderPositions.clear();
+    m_occluderIndices.clear();
+}
+
+void Mesh::KeepOccluderGeometry(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+    m_occluderPositions.clear();
+    m_occluderIndices.clear();
+    if (indexCount / 3 > MAX_OCCLUDER_TRIANGLES)
+        return;
+
+    m_occluderPositions.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+        m_occluderPositions.push_back(vertices[i].Position);
+    m_occluderIndices.assign(indices, indices + indexCount);
 }
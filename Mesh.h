@@ -4,6 +4,8 @@
 #include <wrl/client.h>
 #include <vector>
 #include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include "Vertex.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -12,13 +14,6 @@ using namespace DirectX;
 namespace Engine::Graphics
 {
 
-    struct Vertex
-    {
-		XMFLOAT3 Position;
-		XMFLOAT3 Normal;
-        XMFLOAT2 UV;
-    };
-
     class Mesh
     {
     public:
@@ -28,7 +23,25 @@ namespace Engine::Graphics
         bool CreateCube(ID3D11Device* device);
 		bool CreatePlane(ID3D11Device* device);
 
+        // Create from arbitrary vertex/index data (imported meshes)
+        bool Create(ID3D11Device* device, const Vertex* vertices, size_t vertexCount,
+            const uint32_t* indices, size_t indexCount);
+
         void Draw(ID3D11DeviceContext* context);
+        void DrawInstanced(ID3D11DeviceContext* context, UINT instanceCount);
+
+        // DrawIndexedInstancedIndirect with this mesh in vertex slot 0; other slots are left as bound
+        void DrawIndirect(ID3D11DeviceContext* context, ID3D11Buffer* args, UINT argsOffset);
+        UINT GetIndexCount() const { return m_indexCount; }
+
+        // Object-space bounds, computed on creation
+        const BoundingBox& GetBounds() const { return m_bounds; }
+
+        // CPU copy for the software occlusion rasterizer; empty for meshes
+        // above MAX_OCCLUDER_TRIANGLES, which are too costly to occlude with
+        static const size_t MAX_OCCLUDER_TRIANGLES = 2048;
+        const std::vector<XMFLOAT3>& GetOccluderPositions() const { return m_occluderPositions; }
+        const std::vector<uint32_t>& GetOccluderIndices() const { return m_occluderIndices; }
 
         void Release();
 
@@ -36,6 +49,11 @@ namespace Engine::Graphics
         ComPtr<ID3D11Buffer> m_vertexBuffer;
         ComPtr<ID3D11Buffer> m_indexBuffer;
         UINT m_indexCount = 0;
+        BoundingBox m_bounds;
+        std::vector<XMFLOAT3> m_occluderPositions;
+        std::vector<uint32_t> m_occluderIndices;
+
+        void KeepOccluderGeometry(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
 
     };
 
@@ -0,0 +1,532 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+namespace
+{
+    // Up to three vertices in, one more per clip plane
+    const uint32_t MAX_CLIP_VERTICES = 8;
+
+    void TransformPoint(const OcclusionMatrix& m, float x, float y, float z, float* out)
+    {
+        for (int i = 0; i < 4; ++i)
+            out[i] = x * m.m[0][i] + y * m.m[1][i] + z * m.m[2][i] + m.m[3][i];
+    }
+
+    OcclusionMatrix Multiply(const OcclusionMatrix& a, const OcclusionMatrix& b)
+    {
+        OcclusionMatrix r;
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+        }
+        return r;
+    }
+
+    // Signed distance to clip plane p: near (z >= 0), then the four sides
+    float PlaneDistance(const float* v, int plane)
+    {
+        switch (plane)
+        {
+        case 0: return v[2];
+        case 1: return v[3] + v[0];
+        case 2: return v[3] - v[0];
+        case 3: return v[3] + v[1];
+        default: return v[3] - v[1];
+        }
+    }
+
+    // Sutherland-Hodgman against one plane, returns the new vertex count
+    uint32_t ClipPolygon(const float (*in)[4], uint32_t count, int plane, float (*out)[4])
+    {
+        uint32_t written = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float* a = in[i];
+            const float* b = in[(i + 1) % count];
+            float da = PlaneDistance(a, plane);
+            float db = PlaneDistance(b, plane);
+
+            if (da >= 0.0f)
+            {
+                for (int k = 0; k < 4; ++k)
+                    out[written][k] = a[k];
+                ++written;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                float t = da / (da - db);
+                for (int k = 0; k < 4; ++k)
+                    out[written][k] = a[k] + (b[k] - a[k]) * t;
+                ++written;
+            }
+        }
+        return written;
+    }
+
+    // Outcodes of one clip-space point, far plane included for the box test.
+    // Branch free: box corners land on either side of a plane at random.
+    uint32_t ComputeOutcode(__m128 v)
+    {
+        __m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+        uint32_t below = (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(v, _mm_sub_ps(_mm_setzero_ps(), w)));
+        uint32_t above = (uint32_t)_mm_movemask_ps(_mm_cmpgt_ps(v, w));
+        uint32_t negative = (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(v, _mm_setzero_ps()));
+
+        return (below & 1) | ((above & 1) << 1) | ((below & 2) << 1) | ((above & 2) << 2) |
+            ((negative & 4) << 2) | ((above & 4) << 3);
+    }
+
+    // Columns of one row the edges allow, padded a pixel each way: the lane
+    // masks decide the exact coverage, this only skips empty steps
+    template <typename Triangle>
+    bool ComputeRowSpan(const Triangle& t, float fy, int32_t& outStart, int32_t& outEnd)
+    {
+        float lo = (float)t.minX;
+        float hi = (float)t.maxX;
+        for (int i = 0; i < 3; ++i)
+        {
+            float a = t.edgeA[i];
+            float e = t.edgeB[i] * fy + t.edgeC[i];
+            if (a > 0.0f)
+                lo = (std::max)(lo, -e / a - 1.0f);
+            else if (a < 0.0f)
+                hi = (std::min)(hi, -e / a + 1.0f);
+            else if (e < 0.0f)
+                return false;
+        }
+        if (!(lo <= hi))
+            return false;
+
+        // Both are at least minX, truncation is floor
+        outStart = (int32_t)lo;
+        outEnd = (int32_t)hi;
+        return true;
+    }
+}
+
+OcclusionBuffer::OcclusionBuffer(const OcclusionSettings& settings)
+{
+    SetSettings(settings);
+    SetSimd(OCCLUSION_SIMD_AVX2);
+}
+
+void OcclusionBuffer::SetSettings(const OcclusionSettings& settings)
+{
+    m_settings = settings;
+    m_tilesX = (std::max)((settings.width + TILE_SIZE - 1) / TILE_SIZE, 1u);
+    m_tilesY = (std::max)((settings.height + TILE_SIZE - 1) / TILE_SIZE, 1u);
+    m_width = m_tilesX * TILE_SIZE;
+    m_height = m_tilesY * TILE_SIZE;
+    m_depth.assign((size_t)m_width * m_height, 1.0f);
+    m_tileDepth.assign((size_t)m_tilesX * m_tilesY, 1.0f);
+}
+
+bool OcclusionBuffer::IsAvx2Supported()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // AVX state has to be saved by the OS, not just present in the CPU
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+void OcclusionBuffer::SetSimd(OcclusionSimd simd)
+{
+    static const bool avx2 = IsAvx2Supported();
+    m_simd = (simd == OCCLUSION_SIMD_AVX2 && avx2) ? OCCLUSION_SIMD_AVX2 : OCCLUSION_SIMD_SSE;
+}
+
+void OcclusionBuffer::Begin(const OcclusionMatrix& viewProj)
+{
+    m_viewProj = viewProj;
+    m_occluders.clear();
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+    std::fill(m_tileDepth.begin(), m_tileDepth.end(), 1.0f);
+
+    m_stats = OcclusionStats();
+    m_stats.simd = m_simd;
+}
+
+void OcclusionBuffer::AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+    const OcclusionMatrix& world)
+{
+    if (!positions || !indices || indexCount < 3)
+        return;
+
+    m_occluders.push_back({ positions, vertexCount, indices, indexCount, Multiply(world, m_viewProj) });
+    ++m_stats.occluders;
+    m_stats.occluderTriangles += indexCount / 3;
+}
+
+void OcclusionBuffer::AddTriangle(const float (*clip)[4], std::vector<ScreenTriangle>& outTriangles) const
+{
+    float x[3], y[3], z[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        float invW = 1.0f / clip[i][3];
+        x[i] = (clip[i][0] * invW * 0.5f + 0.5f) * m_width;
+        y[i] = (0.5f - clip[i][1] * invW * 0.5f) * m_height;
+        z[i] = clip[i][2] * invW;
+    }
+
+    // Clockwise on screen is the front face, as in the main pass
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area > 0.0f))
+        return;
+
+    // Pixels whose centers the triangle's bounds hold
+    ScreenTriangle t;
+    t.minX = (std::max)((int32_t)ceilf((std::min)({ x[0], x[1], x[2] }) - 0.5f), 0);
+    t.maxX = (std::min)((int32_t)floorf((std::max)({ x[0], x[1], x[2] }) - 0.5f), (int32_t)m_width - 1);
+    t.minY = (std::max)((int32_t)ceilf((std::min)({ y[0], y[1], y[2] }) - 0.5f), 0);
+    t.maxY = (std::min)((int32_t)floorf((std::max)({ y[0], y[1], y[2] }) - 0.5f), (int32_t)m_height - 1);
+    if (t.minX > t.maxX || t.minY > t.maxY)
+        return;
+
+    // Edge i -> j is positive inside; evaluated at pixel centers from integer coordinates
+    for (int i = 0; i < 3; ++i)
+    {
+        int j = (i + 1) % 3;
+        t.edgeA[i] = y[i] - y[j];
+        t.edgeB[i] = x[j] - x[i];
+        t.edgeC[i] = -(t.edgeA[i] * x[i] + t.edgeB[i] * y[i]) + 0.5f * (t.edgeA[i] + t.edgeB[i]);
+    }
+
+    // Depth plane, pushed to the pixel's farthest corner and capped at the farthest vertex
+    float dzdx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    float dzdy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+    t.depthDx = dzdx;
+    t.depthDy = dzdy;
+    t.depthC = z[0] - dzdx * x[0] - dzdy * y[0] + 0.5f * (dzdx + dzdy) + 0.5f * (fabsf(dzdx) + fabsf(dzdy));
+    t.depthMax = (std::max)({ z[0], z[1], z[2] });
+
+    outTriangles.push_back(t);
+}
+
+void OcclusionBuffer::SetupOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& outTriangles) const
+{
+    outTriangles.clear();
+
+    for (uint32_t i = 0; i + 2 < occluder.indexCount; i += 3)
+    {
+        float polygon[MAX_CLIP_VERTICES + 1][4];
+        uint32_t outAll = 0x1F;
+        uint32_t outAny = 0;
+        bool valid = true;
+        for (int v = 0; v < 3; ++v)
+        {
+            uint32_t index = occluder.indices[i + v];
+            if (index >= occluder.vertexCount)
+            {
+                valid = false;
+                break;
+            }
+            const float* p = occluder.positions + (size_t)index * 3;
+            TransformPoint(occluder.worldViewProj, p[0], p[1], p[2], polygon[v]);
+
+            uint32_t code = ComputeOutcode(_mm_loadu_ps(polygon[v])) & 0x1F;
+            outAll &= code;
+            outAny |= code;
+        }
+        if (!valid || outAll)
+            continue;
+
+        if (!outAny)
+        {
+            AddTriangle(polygon, outTriangles);
+            continue;
+        }
+
+        // Crosses the near plane or a side: clip, then fan
+        float scratch[MAX_CLIP_VERTICES + 1][4];
+        float (*in)[4] = polygon;
+        float (*out)[4] = scratch;
+        uint32_t count = 3;
+        for (int plane = 0; plane < 5 && count >= 3; ++plane)
+        {
+            count = ClipPolygon(in, count, plane, out);
+            std::swap(in, out);
+        }
+
+        for (uint32_t k = 1; k + 1 < count; ++k)
+        {
+            float fan[3][4];
+            for (int c = 0; c < 4; ++c)
+            {
+                fan[0][c] = in[0][c];
+                fan[1][c] = in[k][c];
+                fan[2][c] = in[k + 1][c];
+            }
+            AddTriangle(fan, outTriangles);
+        }
+    }
+}
+
+void OcclusionBuffer::RasterizeRowsSse(const ScreenTriangle& t, float* depth, uint32_t width, int32_t y0, int32_t y1)
+{
+    const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 a0 = _mm_set1_ps(t.edgeA[0]);
+    const __m128 a1 = _mm_set1_ps(t.edgeA[1]);
+    const __m128 a2 = _mm_set1_ps(t.edgeA[2]);
+    const __m128 dzdx = _mm_set1_ps(t.depthDx);
+    const __m128 zMax = _mm_set1_ps(t.depthMax);
+
+    for (int32_t y = y0; y <= y1; ++y)
+    {
+        float fy = (float)y;
+        int32_t xStart, xEnd;
+        if (!ComputeRowSpan(t, fy, xStart, xEnd))
+            continue;
+
+        __m128 row0 = _mm_set1_ps(t.edgeB[0] * fy + t.edgeC[0]);
+        __m128 row1 = _mm_set1_ps(t.edgeB[1] * fy + t.edgeC[1]);
+        __m128 row2 = _mm_set1_ps(t.edgeB[2] * fy + t.edgeC[2]);
+        __m128 rowZ = _mm_set1_ps(t.depthDy * fy + t.depthC);
+        float* line = depth + (size_t)y * width;
+
+        for (int32_t x = xStart & ~3; x <= xEnd; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lane);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), row0);
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), row1);
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), row2);
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                _mm_cmpge_ps(e2, zero));
+            if (!_mm_movemask_ps(inside))
+                continue;
+
+            __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(dzdx, px), rowZ), zMax);
+            __m128 d = _mm_loadu_ps(line + x);
+            __m128 nearest = _mm_min_ps(d, z);
+            _mm_storeu_ps(line + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, d)));
+        }
+    }
+}
+
+void OcclusionBuffer::RasterizeBand(uint32_t tileRow)
+{
+    const int32_t y0 = (int32_t)(tileRow * TILE_SIZE);
+    const int32_t y1 = y0 + (int32_t)TILE_SIZE - 1;
+    float* depth = m_depth.data();
+
+    for (const std::vector<ScreenTriangle>& triangles : m_triangles)
+    {
+        for (const ScreenTriangle& t : triangles)
+        {
+            if (t.maxY < y0 || t.minY > y1)
+                continue;
+
+            int32_t rowStart = (std::max)(t.minY, y0);
+            int32_t rowEnd = (std::min)(t.maxY, y1);
+            if (m_simd == OCCLUSION_SIMD_AVX2)
+                RasterizeRowsAvx2(t, depth, m_width, rowStart, rowEnd);
+            else
+                RasterizeRowsSse(t, depth, m_width, rowStart, rowEnd);
+        }
+    }
+
+    // Farthest depth per tile of this row
+    for (uint32_t tx = 0; tx < m_tilesX; ++tx)
+    {
+        __m128 farthest = _mm_setzero_ps();
+        for (int32_t y = y0; y <= y1; ++y)
+        {
+            const float* line = depth + (size_t)y * m_width + tx * TILE_SIZE;
+            farthest = _mm_max_ps(farthest, _mm_max_ps(_mm_loadu_ps(line), _mm_loadu_ps(line + 4)));
+        }
+        farthest = _mm_max_ps(farthest, _mm_movehl_ps(farthest, farthest));
+        farthest = _mm_max_ss(farthest, _mm_shuffle_ps(farthest, farthest, 1));
+        m_tileDepth[(size_t)tileRow * m_tilesX + tx] = _mm_cvtss_f32(farthest);
+    }
+}
+
+void OcclusionBuffer::Rasterize()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (m_triangles.size() < m_occluders.size())
+        m_triangles.resize(m_occluders.size());
+    for (size_t i = m_occluders.size(); i < m_triangles.size(); ++i)
+        m_triangles[i].clear();
+
+    if (!m_occluders.empty())
+    {
+        JobSystem::Dispatch(m_jobs, (uint32_t)m_occluders.size(), 1, [this](uint32_t i)
+            {
+                SetupOccluder(m_occluders[i], m_triangles[i]);
+            });
+        JobSystem::Wait(m_jobs);
+
+        for (size_t i = 0; i < m_occluders.size(); ++i)
+            m_stats.rasterizedTriangles += (uint32_t)m_triangles[i].size();
+
+        // Bands own their rows, no two jobs write the same pixel
+        JobSystem::Dispatch(m_jobs, m_tilesY, 1, [this](uint32_t row)
+            {
+                RasterizeBand(row);
+            });
+        JobSystem::Wait(m_jobs);
+    }
+
+    m_stats.rasterizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint8_t OcclusionBuffer::TestBox(const ShadowAabb& worldBounds) const
+{
+    // Corners as sums of one min/max term per axis, the translation folded into z
+    const __m128 r0 = _mm_loadu_ps(m_viewProj.m[0]);
+    const __m128 r1 = _mm_loadu_ps(m_viewProj.m[1]);
+    const __m128 r2 = _mm_loadu_ps(m_viewProj.m[2]);
+    const __m128 r3 = _mm_loadu_ps(m_viewProj.m[3]);
+    const __m128 x[2] = { _mm_mul_ps(_mm_set1_ps(worldBounds.min.x), r0), _mm_mul_ps(_mm_set1_ps(worldBounds.max.x), r0) };
+    const __m128 y[2] = { _mm_mul_ps(_mm_set1_ps(worldBounds.min.y), r1), _mm_mul_ps(_mm_set1_ps(worldBounds.max.y), r1) };
+    const __m128 z[2] = { _mm_add_ps(_mm_mul_ps(_mm_set1_ps(worldBounds.min.z), r2), r3),
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(worldBounds.max.z), r2), r3) };
+
+    __m128 clip[8];
+    uint32_t outAll = 0x3F;
+    uint32_t outAny = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        clip[i] = _mm_add_ps(_mm_add_ps(x[i & 1], y[(i >> 1) & 1]), z[i >> 2]);
+        uint32_t code = ComputeOutcode(clip[i]);
+        outAll &= code;
+        outAny |= code;
+    }
+    if (outAll)
+        return BOX_FRUSTUM_CULLED;
+
+    // Reaches behind the near plane: no safe projection, and likely close anyway
+    if (outAny & 16)
+        return BOX_VISIBLE;
+
+    __m128 ndcMin = _mm_set1_ps(FLT_MAX);
+    __m128 ndcMax = _mm_set1_ps(-FLT_MAX);
+    for (int i = 0; i < 8; ++i)
+    {
+        __m128 ndc = _mm_div_ps(clip[i], _mm_shuffle_ps(clip[i], clip[i], _MM_SHUFFLE(3, 3, 3, 3)));
+        ndcMin = _mm_min_ps(ndcMin, ndc);
+        ndcMax = _mm_max_ps(ndcMax, ndc);
+    }
+    float lo[4], hi[4];
+    _mm_storeu_ps(lo, ndcMin);
+    _mm_storeu_ps(hi, ndcMax);
+
+    // Screen y runs down
+    float minX = (lo[0] * 0.5f + 0.5f) * m_width;
+    float maxX = (hi[0] * 0.5f + 0.5f) * m_width;
+    float minY = (0.5f - hi[1] * 0.5f) * m_height;
+    float maxY = (0.5f - lo[1] * 0.5f) * m_height;
+    float nearest = lo[2];
+
+    // Every pixel the rectangle touches
+    int32_t x0 = (std::max)((int32_t)floorf(minX), 0);
+    int32_t y0 = (std::max)((int32_t)floorf(minY), 0);
+    int32_t x1 = (std::min)((std::max)((int32_t)ceilf(maxX) - 1, x0), (int32_t)m_width - 1);
+    int32_t y1 = (std::min)((std::max)((int32_t)ceilf(maxY) - 1, y0), (int32_t)m_height - 1);
+    if (x0 > x1 || y0 > y1)
+        return BOX_FRUSTUM_CULLED;
+
+    const int32_t tileSize = (int32_t)TILE_SIZE;
+    for (int32_t ty = y0 / tileSize; ty <= y1 / tileSize; ++ty)
+    {
+        for (int32_t tx = x0 / tileSize; tx <= x1 / tileSize; ++tx)
+        {
+            if (nearest > m_tileDepth[(size_t)ty * m_tilesX + tx])
+                continue;
+
+            // The tile's farthest pixel may lie outside the box: check the overlap
+            int32_t px0 = (std::max)(x0, tx * tileSize);
+            int32_t px1 = (std::min)(x1, tx * tileSize + tileSize - 1);
+            int32_t py0 = (std::max)(y0, ty * tileSize);
+            int32_t py1 = (std::min)(y1, ty * tileSize + tileSize - 1);
+            for (int32_t py = py0; py <= py1; ++py)
+            {
+                const float* line = m_depth.data() + (size_t)py * m_width;
+                for (int32_t px = px0; px <= px1; ++px)
+                {
+                    if (nearest <= line[px])
+                        return BOX_VISIBLE;
+                }
+            }
+        }
+    }
+    return BOX_OCCLUDED;
+}
+
+bool OcclusionBuffer::IsVisible(const ShadowAabb& worldBounds) const
+{
+    return TestBox(worldBounds) == BOX_VISIBLE;
+}
+
+void OcclusionBuffer::TestVisibility(const ShadowAabb* worldBounds, size_t count, uint8_t* outVisible)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    m_results.resize(count);
+    if (count > 0)
+    {
+        JobSystem::Dispatch(m_jobs, (uint32_t)count, 64, [this, worldBounds](uint32_t i)
+            {
+                m_results[i] = TestBox(worldBounds[i]);
+            });
+        JobSystem::Wait(m_jobs);
+    }
+
+    m_stats.tested += (uint32_t)count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        outVisible[i] = m_results[i] == BOX_VISIBLE ? 1 : 0;
+        if (m_results[i] == BOX_FRUSTUM_CULLED)
+            ++m_stats.frustumCulled;
+        else if (m_results[i] == BOX_OCCLUDED)
+            ++m_stats.occlusionCulled;
+    }
+
+    m_stats.testMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+float OcclusionBuffer::EstimateScreenSize(const ShadowAabb& worldBounds, const ShadowVector& cameraPosition, float fovY)
+{
+    float ex = 0.5f * (worldBounds.max.x - worldBounds.min.x);
+    float ey = 0.5f * (worldBounds.max.y - worldBounds.min.y);
+    float ez = 0.5f * (worldBounds.max.z - worldBounds.min.z);
+    float radius = sqrtf(ex * ex + ey * ey + ez * ez);
+
+    float dx = worldBounds.min.x + ex - cameraPosition.x;
+    float dy = worldBounds.min.y + ey - cameraPosition.y;
+    float dz = worldBounds.min.z + ez - cameraPosition.z;
+    float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+    if (distance <= radius)
+        return 1.0f;
+
+    float s = radius / distance;
+    return (std::min)(s / sqrtf(1.0f - s * s) / tanf(0.5f * fovY), 1.0f);
+}
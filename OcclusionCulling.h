@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CascadeShadows.h"
+#include "JobSystem.h"
+
+namespace Engine::Graphics
+{
+    // Row vectors, clip = [x y z 1] * m: the XMFLOAT4X4 layout
+    struct OcclusionMatrix
+    {
+        float m[4][4] = {};
+    };
+
+    enum OcclusionSimd : uint32_t
+    {
+        OCCLUSION_SIMD_SSE = 0,     // 4 pixels per step, any x64 CPU
+        OCCLUSION_SIMD_AVX2 = 1     // 8 pixels per step, picked when the CPU and OS support it
+    };
+
+    struct OcclusionSettings
+    {
+        uint32_t width = 320;               // rounded up to whole tiles
+        uint32_t height = 192;
+        uint32_t maxOccluders = 64;         // largest on screen first
+        float minOccluderSize = 0.1f;       // projected bounds diameter over the screen height
+    };
+
+    struct OcclusionStats
+    {
+        OcclusionSimd simd = OCCLUSION_SIMD_SSE;
+        uint32_t occluders = 0;
+        uint32_t occluderTriangles = 0;     // submitted
+        uint32_t rasterizedTriangles = 0;   // after back face culling and clipping
+        uint32_t tested = 0;
+        uint32_t frustumCulled = 0;
+        uint32_t occlusionCulled = 0;
+        double rasterizeMs = 0.0;
+        double testMs = 0.0;
+    };
+
+    // Software depth buffer for occlusion culling. Selected occluders are
+    // rasterized at low resolution, a band of tile rows per job, with SIMD
+    // edge functions whose lane masks gate the depth update; each tile keeps
+    // the farthest depth under it. Boxes are tested tile first, pixels only
+    // where a tile cannot decide. Depth is z/w of the main projection, 0 at
+    // the near plane. A covered pixel stores the farthest depth of the
+    // triangle over the pixel, so culling errs only at occluder silhouettes,
+    // by less than one of these pixels.
+    class OcclusionBuffer
+    {
+    public:
+        static const uint32_t TILE_SIZE = 8;
+
+        explicit OcclusionBuffer(const OcclusionSettings& settings = OcclusionSettings());
+
+        void SetSettings(const OcclusionSettings& settings);
+        const OcclusionSettings& GetSettings() const { return m_settings; }
+
+        // AVX2 falls back to SSE when the CPU lacks it
+        void SetSimd(OcclusionSimd simd);
+        OcclusionSimd GetSimd() const { return m_simd; }
+        static bool IsAvx2Supported();
+
+        // Clears the buffer and drops last frame's occluders
+        void Begin(const OcclusionMatrix& viewProj);
+
+        // Triangle list, positions are xyz triples. Nothing is copied: the
+        // arrays must live until Rasterize returns.
+        void AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+            const OcclusionMatrix& world);
+
+        // One job per occluder for setup, then one per band of tile rows
+        void Rasterize();
+
+        // False when the box is outside the frustum or behind the occluders
+        bool IsVisible(const ShadowAabb& worldBounds) const;
+
+        // outVisible[i] is 1 or 0; jobs of 64 boxes
+        void TestVisibility(const ShadowAabb* worldBounds, size_t count, uint8_t* outVisible);
+
+        // Projected bounds diameter over the screen height, 1 with the camera inside the bounds
+        static float EstimateScreenSize(const ShadowAabb& worldBounds, const ShadowVector& cameraPosition, float fovY);
+
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+        const float* GetDepth() const { return m_depth.data(); }
+        const float* GetTileDepth() const { return m_tileDepth.data(); }    // farthest per tile, row-major
+        const OcclusionStats& GetStats() const { return m_stats; }
+
+    private:
+        struct Occluder
+        {
+            const float* positions;
+            uint32_t vertexCount;
+            const uint32_t* indices;
+            uint32_t indexCount;
+            OcclusionMatrix worldViewProj;
+        };
+
+        // Screen-space triangle ready to rasterize: edge functions and the
+        // depth plane at pixel centers, rows and columns it may cover
+        struct ScreenTriangle
+        {
+            float edgeA[3];
+            float edgeB[3];
+            float edgeC[3];
+            float depthC;
+            float depthDx;
+            float depthDy;
+            float depthMax;
+            int32_t minX, maxX, minY, maxY;
+        };
+
+        OcclusionSettings m_settings;
+        OcclusionSimd m_simd = OCCLUSION_SIMD_SSE;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_tilesX = 0;
+        uint32_t m_tilesY = 0;
+        OcclusionMatrix m_viewProj;
+        std::vector<float> m_depth;
+        std::vector<float> m_tileDepth;
+        std::vector<Occluder> m_occluders;
+        std::vector<std::vector<ScreenTriangle>> m_triangles;   // per occluder, capacity kept across frames
+        std::vector<uint8_t> m_results;                         // BoxResult per tested box
+        OcclusionStats m_stats;
+        Engine::Core::JobContext m_jobs;
+
+        enum BoxResult : uint8_t
+        {
+            BOX_VISIBLE = 0,
+            BOX_FRUSTUM_CULLED = 1,
+            BOX_OCCLUDED = 2
+        };
+
+        uint8_t TestBox(const ShadowAabb& worldBounds) const;
+        void SetupOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& outTriangles) const;
+        void AddTriangle(const float (*clip)[4], std::vector<ScreenTriangle>& outTriangles) const;
+        void RasterizeBand(uint32_t tileRow);
+
+        // Rows y0..y1 of one triangle. The AVX2 version lives in
+        // OcclusionCullingAvx2.cpp, the one file built with /arch:AVX2.
+        static void RasterizeRowsSse(const ScreenTriangle& t, float* depth, uint32_t width, int32_t y0, int32_t y1);
+        static void RasterizeRowsAvx2(const ScreenTriangle& t, float* depth, uint32_t width, int32_t y0, int32_t y1);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,80 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <immintrin.h>
+
+// Built with /arch:AVX2 and only entered after OcclusionBuffer::IsAvx2Supported,
+// so nothing here may be shared with the SSE file: an inline function the
+// linker merged across the two would run AVX code on any CPU.
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Same as ComputeRowSpan in OcclusionCulling.cpp
+    template <typename Triangle>
+    bool ComputeRowSpan(const Triangle& t, float fy, int32_t& outStart, int32_t& outEnd)
+    {
+        float lo = (float)t.minX;
+        float hi = (float)t.maxX;
+        for (int i = 0; i < 3; ++i)
+        {
+            float a = t.edgeA[i];
+            float e = t.edgeB[i] * fy + t.edgeC[i];
+            if (a > 0.0f)
+                lo = (std::max)(lo, -e / a - 1.0f);
+            else if (a < 0.0f)
+                hi = (std::min)(hi, -e / a + 1.0f);
+            else if (e < 0.0f)
+                return false;
+        }
+        if (!(lo <= hi))
+            return false;
+
+        outStart = (int32_t)lo;
+        outEnd = (int32_t)hi;
+        return true;
+    }
+}
+
+// Same operations in the same order as the SSE path, so both write the same depths
+void OcclusionBuffer::RasterizeRowsAvx2(const ScreenTriangle& t, float* depth, uint32_t width, int32_t y0, int32_t y1)
+{
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 a0 = _mm256_set1_ps(t.edgeA[0]);
+    const __m256 a1 = _mm256_set1_ps(t.edgeA[1]);
+    const __m256 a2 = _mm256_set1_ps(t.edgeA[2]);
+    const __m256 dzdx = _mm256_set1_ps(t.depthDx);
+    const __m256 zMax = _mm256_set1_ps(t.depthMax);
+
+    for (int32_t y = y0; y <= y1; ++y)
+    {
+        float fy = (float)y;
+        int32_t xStart, xEnd;
+        if (!ComputeRowSpan(t, fy, xStart, xEnd))
+            continue;
+
+        __m256 row0 = _mm256_set1_ps(t.edgeB[0] * fy + t.edgeC[0]);
+        __m256 row1 = _mm256_set1_ps(t.edgeB[1] * fy + t.edgeC[1]);
+        __m256 row2 = _mm256_set1_ps(t.edgeB[2] * fy + t.edgeC[2]);
+        __m256 rowZ = _mm256_set1_ps(t.depthDy * fy + t.depthC);
+        float* line = depth + (size_t)y * width;
+
+        for (int32_t x = xStart & ~7; x <= xEnd; x += 8)
+        {
+            __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), lane);
+            __m256 e0 = _mm256_add_ps(_mm256_mul_ps(a0, px), row0);
+            __m256 e1 = _mm256_add_ps(_mm256_mul_ps(a1, px), row1);
+            __m256 e2 = _mm256_add_ps(_mm256_mul_ps(a2, px), row2);
+            __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ),
+                _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)), _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+            if (!_mm256_movemask_ps(inside))
+                continue;
+
+            __m256 z = _mm256_min_ps(_mm256_add_ps(_mm256_mul_ps(dzdx, px), rowZ), zMax);
+            __m256 d = _mm256_loadu_ps(line + x);
+            _mm256_storeu_ps(line + x, _mm256_blendv_ps(d, _mm256_min_ps(d, z), inside));
+        }
+    }
+}
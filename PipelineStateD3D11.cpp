@@ -0,0 +1,215 @@
+#include "PipelineStateD3D11.h"
+#include "Shader.h"
+
+#include <cstdio>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+// -----------------------------
+// Descriptor keys
+// -----------------------------
+void RasterizerDescTraits::Write(BinaryWriter& writer, const D3D11_RASTERIZER_DESC& desc)
+{
+    writer.WriteValue((uint32_t)desc.FillMode);
+    writer.WriteValue((uint32_t)desc.CullMode);
+    writer.WriteValue((uint32_t)desc.FrontCounterClockwise);
+    writer.WriteValue((int32_t)desc.DepthBias);
+    writer.WriteValue(desc.DepthBiasClamp);
+    writer.WriteValue(desc.SlopeScaledDepthBias);
+    writer.WriteValue((uint32_t)desc.DepthClipEnable);
+    writer.WriteValue((uint32_t)desc.ScissorEnable);
+    writer.WriteValue((uint32_t)desc.MultisampleEnable);
+    writer.WriteValue((uint32_t)desc.AntialiasedLineEnable);
+}
+
+namespace
+{
+    void WriteStencilOp(BinaryWriter& writer, const D3D11_DEPTH_STENCILOP_DESC& op)
+    {
+        writer.WriteValue((uint32_t)op.StencilFailOp);
+        writer.WriteValue((uint32_t)op.StencilDepthFailOp);
+        writer.WriteValue((uint32_t)op.StencilPassOp);
+        writer.WriteValue((uint32_t)op.StencilFunc);
+    }
+
+    void WriteRenderTargetBlend(BinaryWriter& writer, const D3D11_RENDER_TARGET_BLEND_DESC& rt)
+    {
+        writer.WriteValue((uint32_t)rt.BlendEnable);
+        writer.WriteValue((uint32_t)rt.SrcBlend);
+        writer.WriteValue((uint32_t)rt.DestBlend);
+        writer.WriteValue((uint32_t)rt.BlendOp);
+        writer.WriteValue((uint32_t)rt.SrcBlendAlpha);
+        writer.WriteValue((uint32_t)rt.DestBlendAlpha);
+        writer.WriteValue((uint32_t)rt.BlendOpAlpha);
+        writer.WriteValue((uint8_t)rt.RenderTargetWriteMask);
+    }
+}
+
+void DepthStencilDescTraits::Write(BinaryWriter& writer, const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+    writer.WriteValue((uint32_t)desc.DepthEnable);
+    writer.WriteValue((uint32_t)desc.DepthWriteMask);
+    writer.WriteValue((uint32_t)desc.DepthFunc);
+    writer.WriteValue((uint32_t)desc.StencilEnable);
+    if (!desc.StencilEnable)
+        return;
+
+    writer.WriteValue((uint8_t)desc.StencilReadMask);
+    writer.WriteValue((uint8_t)desc.StencilWriteMask);
+    WriteStencilOp(writer, desc.FrontFace);
+    WriteStencilOp(writer, desc.BackFace);
+}
+
+void BlendDescTraits::Write(BinaryWriter& writer, const D3D11_BLEND_DESC& desc)
+{
+    writer.WriteValue((uint32_t)desc.AlphaToCoverageEnable);
+    writer.WriteValue((uint32_t)desc.IndependentBlendEnable);
+
+    uint32_t targets = desc.IndependentBlendEnable ? 8 : 1;
+    for (uint32_t i = 0; i < targets; ++i)
+        WriteRenderTargetBlend(writer, desc.RenderTarget[i]);
+}
+
+void SamplerDescTraits::Write(BinaryWriter& writer, const D3D11_SAMPLER_DESC& desc)
+{
+    writer.WriteValue((uint32_t)desc.Filter);
+    writer.WriteValue((uint32_t)desc.AddressU);
+    writer.WriteValue((uint32_t)desc.AddressV);
+    writer.WriteValue((uint32_t)desc.AddressW);
+    writer.WriteValue(desc.MipLODBias);
+    writer.WriteValue((uint32_t)desc.MaxAnisotropy);
+    writer.WriteValue((uint32_t)desc.ComparisonFunc);
+    writer.WriteValue(desc.MinLOD);
+    writer.WriteValue(desc.MaxLOD);
+
+    bool border = desc.AddressU == D3D11_TEXTURE_ADDRESS_BORDER || desc.AddressV == D3D11_TEXTURE_ADDRESS_BORDER ||
+        desc.AddressW == D3D11_TEXTURE_ADDRESS_BORDER;
+    if (border)
+        writer.Write(desc.BorderColor, sizeof(desc.BorderColor));
+}
+
+// -----------------------------
+// PipelineState
+// -----------------------------
+void PipelineState::Bind(ID3D11DeviceContext* context) const
+{
+    m_shader->Bind(context);
+    if (m_depthOnly)
+        context->PSSetShader(nullptr, nullptr, 0);
+
+    context->IASetPrimitiveTopology(m_topology);
+    context->RSSetState(m_rasterizer);
+    context->OMSetDepthStencilState(m_depthStencil, 0);
+    context->OMSetBlendState(m_blend, nullptr, 0xFFFFFFFF);
+}
+
+// -----------------------------
+// RenderStateCache
+// -----------------------------
+RenderStateCache::RenderStateCache(ID3D11Device* device)
+    : m_device(device)
+{
+}
+
+const RenderStateCache::RasterizerCache::Entry* RenderStateCache::AcquireRasterizer(const D3D11_RASTERIZER_DESC& desc)
+{
+    return m_rasterizers.GetOrCreate(desc, [this](const D3D11_RASTERIZER_DESC& d, ComPtr<ID3D11RasterizerState>& out)
+        {
+            return SUCCEEDED(m_device->CreateRasterizerState(&d, out.GetAddressOf()));
+        });
+}
+
+const RenderStateCache::DepthStencilCache::Entry* RenderStateCache::AcquireDepthStencil(const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+    return m_depthStencils.GetOrCreate(desc, [this](const D3D11_DEPTH_STENCIL_DESC& d, ComPtr<ID3D11DepthStencilState>& out)
+        {
+            return SUCCEEDED(m_device->CreateDepthStencilState(&d, out.GetAddressOf()));
+        });
+}
+
+const RenderStateCache::BlendCache::Entry* RenderStateCache::AcquireBlend(const D3D11_BLEND_DESC& desc)
+{
+    return m_blends.GetOrCreate(desc, [this](const D3D11_BLEND_DESC& d, ComPtr<ID3D11BlendState>& out)
+        {
+            return SUCCEEDED(m_device->CreateBlendState(&d, out.GetAddressOf()));
+        });
+}
+
+ID3D11RasterizerState* RenderStateCache::GetRasterizerState(const D3D11_RASTERIZER_DESC& desc)
+{
+    auto* entry = AcquireRasterizer(desc);
+    return entry ? entry->object.Get() : nullptr;
+}
+
+ID3D11DepthStencilState* RenderStateCache::GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc)
+{
+    auto* entry = AcquireDepthStencil(desc);
+    return entry ? entry->object.Get() : nullptr;
+}
+
+ID3D11BlendState* RenderStateCache::GetBlendState(const D3D11_BLEND_DESC& desc)
+{
+    auto* entry = AcquireBlend(desc);
+    return entry ? entry->object.Get() : nullptr;
+}
+
+ID3D11SamplerState* RenderStateCache::GetSamplerState(const D3D11_SAMPLER_DESC& desc)
+{
+    auto* entry = m_samplers.GetOrCreate(desc, [this](const D3D11_SAMPLER_DESC& d, ComPtr<ID3D11SamplerState>& out)
+        {
+            return SUCCEEDED(m_device->CreateSamplerState(&d, out.GetAddressOf()));
+        });
+    return entry ? entry->object.Get() : nullptr;
+}
+
+const PipelineState* RenderStateCache::GetPipeline(const PipelineStateDesc& desc)
+{
+    if (!desc.shader)
+        return nullptr;
+
+    // States first: the pipeline key is made of their ids
+    auto* rasterizer = AcquireRasterizer(desc.rasterizer);
+    auto* depthStencil = AcquireDepthStencil(desc.depthStencil);
+    auto* blend = AcquireBlend(desc.blend);
+    if (!rasterizer || !depthStencil || !blend)
+        return nullptr;
+
+    PipelineKey key;
+    key.program = desc.shader;
+    key.depthOnly = desc.depthOnly;
+    key.rasterizer = rasterizer->id;
+    key.depthStencil = depthStencil->id;
+    key.blend = blend->id;
+    key.topology = (uint32_t)desc.topology;
+
+    auto* entry = m_pipelines.GetOrCreate(key, [&](const PipelineKey&, std::unique_ptr<PipelineState>& out)
+        {
+            out = std::make_unique<PipelineState>();
+            out->m_shader = desc.shader;
+            out->m_depthOnly = desc.depthOnly;
+            out->m_rasterizer = rasterizer->object.Get();
+            out->m_depthStencil = depthStencil->object.Get();
+            out->m_blend = blend->object.Get();
+            out->m_topology = desc.topology;
+            return true;
+        });
+
+    PipelineState* pipeline = entry->object.get();
+    pipeline->m_id = entry->id;
+    pipeline->m_hash = entry->hash;
+    return pipeline;
+}
+
+std::string RenderStateCache::GetSummary() const
+{
+    char line[256];
+    sprintf_s(line, "Render states: %zu rasterizer, %zu depth-stencil, %zu blend, %zu sampler, %zu pipelines "
+        "(%u requests shared an existing object, %u hash collisions)\n",
+        m_rasterizers.GetCount(), m_depthStencils.GetCount(), m_blends.GetCount(), m_samplers.GetCount(), m_pipelines.GetCount(),
+        m_rasterizers.GetStats().hits + m_depthStencils.GetStats().hits + m_blends.GetStats().hits +
+        m_samplers.GetStats().hits + m_pipelines.GetStats().hits,
+        m_rasterizers.GetStats().collisions + m_depthStencils.GetStats().collisions + m_blends.GetStats().collisions +
+        m_samplers.GetStats().collisions + m_pipelines.GetStats().collisions);
+    return line;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <string>
+#include "StateCache.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    class Shader;
+
+    // Field-by-field keys. Fields the GPU ignores under the other settings
+    // (blend targets 1-7 without independent blend, border color without a
+    // border address mode) are left out so equivalent descriptors share an object.
+    struct RasterizerDescTraits
+    {
+        static void Write(Engine::Core::BinaryWriter& writer, const D3D11_RASTERIZER_DESC& desc);
+    };
+
+    struct DepthStencilDescTraits
+    {
+        static void Write(Engine::Core::BinaryWriter& writer, const D3D11_DEPTH_STENCIL_DESC& desc);
+    };
+
+    struct BlendDescTraits
+    {
+        static void Write(Engine::Core::BinaryWriter& writer, const D3D11_BLEND_DESC& desc);
+    };
+
+    struct SamplerDescTraits
+    {
+        static void Write(Engine::Core::BinaryWriter& writer, const D3D11_SAMPLER_DESC& desc);
+    };
+
+    struct PipelineStateDesc
+    {
+        Shader* shader = nullptr;           // VS, PS and input layout
+        bool depthOnly = false;             // bind no pixel shader (shadow maps, depth prepass)
+        D3D11_RASTERIZER_DESC rasterizer = CD3D11_RASTERIZER_DESC(CD3D11_DEFAULT());
+        D3D11_DEPTH_STENCIL_DESC depthStencil = CD3D11_DEPTH_STENCIL_DESC(CD3D11_DEFAULT());
+        D3D11_BLEND_DESC blend = CD3D11_BLEND_DESC(CD3D11_DEFAULT());
+        D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    };
+
+    // Everything fixed-function a draw needs plus its program, bound in one
+    // call. States are shared with every other pipeline that uses them.
+    class PipelineState
+    {
+    public:
+        void Bind(ID3D11DeviceContext* context) const;
+
+        // Dense per cache: put it in the high bits of draw sort keys
+        uint32_t GetId() const { return m_id; }
+        uint64_t GetHash() const { return m_hash; }
+        Shader* GetShader() const { return m_shader; }
+
+    private:
+        friend class RenderStateCache;
+
+        Shader* m_shader = nullptr;
+        bool m_depthOnly = false;
+        ID3D11RasterizerState* m_rasterizer = nullptr;
+        ID3D11DepthStencilState* m_depthStencil = nullptr;
+        ID3D11BlendState* m_blend = nullptr;
+        D3D11_PRIMITIVE_TOPOLOGY m_topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        uint32_t m_id = 0;
+        uint64_t m_hash = 0;
+    };
+
+    // Owns every state object and pipeline. The returned pointers stay valid
+    // until the cache is destroyed; callers never release them.
+    class RenderStateCache
+    {
+    public:
+        RenderStateCache(ID3D11Device* device);
+
+        ID3D11RasterizerState* GetRasterizerState(const D3D11_RASTERIZER_DESC& desc);
+        ID3D11DepthStencilState* GetDepthStencilState(const D3D11_DEPTH_STENCIL_DESC& desc);
+        ID3D11BlendState* GetBlendState(const D3D11_BLEND_DESC& desc);
+        ID3D11SamplerState* GetSamplerState(const D3D11_SAMPLER_DESC& desc);
+
+        // nullptr if a state cannot be created
+        const PipelineState* GetPipeline(const PipelineStateDesc& desc);
+
+        // One line of object counts and dedup hits for the debug output
+        std::string GetSummary() const;
+
+    private:
+        using RasterizerCache = StateCache<D3D11_RASTERIZER_DESC, ComPtr<ID3D11RasterizerState>, RasterizerDescTraits>;
+        using DepthStencilCache = StateCache<D3D11_DEPTH_STENCIL_DESC, ComPtr<ID3D11DepthStencilState>, DepthStencilDescTraits>;
+        using BlendCache = StateCache<D3D11_BLEND_DESC, ComPtr<ID3D11BlendState>, BlendDescTraits>;
+        using SamplerCache = StateCache<D3D11_SAMPLER_DESC, ComPtr<ID3D11SamplerState>, SamplerDescTraits>;
+        using PipelineCache = StateCache<PipelineKey, std::unique_ptr<PipelineState>, PipelineKeyTraits>;
+
+        ID3D11Device* m_device = nullptr;
+        RasterizerCache m_rasterizers;
+        DepthStencilCache m_depthStencils;
+        BlendCache m_blends;
+        SamplerCache m_samplers;
+        PipelineCache m_pipelines;
+
+        const RasterizerCache::Entry* AcquireRasterizer(const D3D11_RASTERIZER_DESC& desc);
+        const DepthStencilCache::Entry* AcquireDepthStencil(const D3D11_DEPTH_STENCIL_DESC& desc);
+        const BlendCache::Entry* AcquireBlend(const D3D11_BLEND_DESC& desc);
+    };
+
+} // namespace Engine::Graphics
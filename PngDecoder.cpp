@@ -0,0 +1,492 @@
+#include "PngDecoder.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // -----------------------------
+    // Inflate (RFC 1950/1951)
+    // -----------------------------
+    struct Huffman
+    {
+        uint16_t count[16];
+        uint16_t symbol[288];
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        bool Bits(uint32_t n, uint32_t& out)
+        {
+            while (m_count < n)
+            {
+                if (m_pos >= m_size)
+                    return false;
+                m_buffer |= (uint64_t)m_data[m_pos++] << m_count;
+                m_count += 8;
+            }
+            out = (uint32_t)(m_buffer & ((1ull << n) - 1));
+            m_buffer >>= n;
+            m_count -= n;
+            return true;
+        }
+
+        void AlignToByte()
+        {
+            m_buffer >>= (m_count & 7);
+            m_count -= (m_count & 7);
+        }
+
+        // Only valid after AlignToByte
+        bool Bytes(uint8_t* out, size_t n)
+        {
+            while (n > 0 && m_count >= 8)
+            {
+                *out++ = (uint8_t)m_buffer;
+                m_buffer >>= 8;
+                m_count -= 8;
+                --n;
+            }
+            if (m_pos + n > m_size)
+                return false;
+            memcpy(out, m_data + m_pos, n);
+            m_pos += n;
+            return true;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_pos = 0;
+        uint64_t m_buffer = 0;
+        uint32_t m_count = 0;
+    };
+
+    bool BuildHuffman(Huffman& h, const uint8_t* lengths, uint32_t n)
+    {
+        memset(h.count, 0, sizeof(h.count));
+        for (uint32_t i = 0; i < n; ++i)
+            h.count[lengths[i]]++;
+
+        // Over-subscribed sets are invalid, incomplete ones are allowed (single distance code)
+        int left = 1;
+        for (int len = 1; len < 16; ++len)
+        {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0)
+                return false;
+        }
+
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for (int len = 1; len < 15; ++len)
+            offsets[len + 1] = offsets[len] + h.count[len];
+
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (lengths[i] != 0)
+                h.symbol[offsets[lengths[i]]++] = (uint16_t)i;
+        }
+        return true;
+    }
+
+    int DecodeSymbol(BitReader& br, const Huffman& h)
+    {
+        int code = 0;
+        int first = 0;
+        int index = 0;
+
+        for (int len = 1; len < 16; ++len)
+        {
+            uint32_t bit;
+            if (!br.Bits(1, bit))
+                return -1;
+
+            code |= (int)bit;
+            int count = h.count[len];
+            if (code - count < first)
+                return h.symbol[index + (code - first)];
+
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint16_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint16_t DIST_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    bool InflateCodes(BitReader& br, const Huffman& lit, const Huffman& dist, std::vector<uint8_t>& out)
+    {
+        for (;;)
+        {
+            int sym = DecodeSymbol(br, lit);
+            if (sym < 0)
+                return false;
+
+            if (sym < 256)
+            {
+                out.push_back((uint8_t)sym);
+                continue;
+            }
+            if (sym == 256)
+                return true;
+
+            sym -= 257;
+            if (sym >= 29)
+                return false;
+
+            uint32_t extra;
+            if (!br.Bits(LENGTH_EXTRA[sym], extra))
+                return false;
+            size_t length = LENGTH_BASE[sym] + extra;
+
+            int dsym = DecodeSymbol(br, dist);
+            if (dsym < 0 || dsym >= 30)
+                return false;
+            if (!br.Bits(DIST_EXTRA[dsym], extra))
+                return false;
+            size_t distance = DIST_BASE[dsym] + extra;
+
+            if (distance > out.size())
+                return false;
+
+            // Byte by byte: source and destination may overlap
+            size_t from = out.size() - distance;
+            for (size_t i = 0; i < length; ++i)
+                out.push_back(out[from + i]);
+        }
+    }
+
+    bool Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+    {
+        // zlib header: deflate, no preset dictionary
+        if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20))
+            return false;
+
+        BitReader br(data + 2, size - 2);
+
+        Huffman fixedLit, fixedDist;
+        {
+            uint8_t lengths[288];
+            for (int i = 0; i < 144; ++i) lengths[i] = 8;
+            for (int i = 144; i < 256; ++i) lengths[i] = 9;
+            for (int i = 256; i < 280; ++i) lengths[i] = 7;
+            for (int i = 280; i < 288; ++i) lengths[i] = 8;
+            BuildHuffman(fixedLit, lengths, 288);
+
+            for (int i = 0; i < 30; ++i) lengths[i] = 5;
+            BuildHuffman(fixedDist, lengths, 30);
+        }
+
+        uint32_t last = 0;
+        while (!last)
+        {
+            uint32_t type;
+            if (!br.Bits(1, last) || !br.Bits(2, type))
+                return false;
+
+            if (type == 0)
+            {
+                br.AlignToByte();
+                uint8_t header[4];
+                if (!br.Bytes(header, 4))
+                    return false;
+
+                uint32_t len = header[0] | (header[1] << 8);
+                uint32_t nlen = header[2] | (header[3] << 8);
+                if ((len ^ 0xFFFF) != nlen)
+                    return false;
+
+                size_t at = out.size();
+                out.resize(at + len);
+                if (!br.Bytes(out.data() + at, len))
+                    return false;
+            }
+            else if (type == 1)
+            {
+                if (!InflateCodes(br, fixedLit, fixedDist, out))
+                    return false;
+            }
+            else if (type == 2)
+            {
+                uint32_t hlit, hdist, hclen;
+                if (!br.Bits(5, hlit) || !br.Bits(5, hdist) || !br.Bits(4, hclen))
+                    return false;
+                hlit += 257;
+                hdist += 1;
+                hclen += 4;
+
+                static const uint8_t ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+                uint8_t codeLengths[19] = {};
+                for (uint32_t i = 0; i < hclen; ++i)
+                {
+                    uint32_t v;
+                    if (!br.Bits(3, v))
+                        return false;
+                    codeLengths[ORDER[i]] = (uint8_t)v;
+                }
+
+                Huffman lenCode;
+                if (!BuildHuffman(lenCode, codeLengths, 19))
+                    return false;
+
+                uint8_t lengths[320] = {};
+                uint32_t index = 0;
+                while (index < hlit + hdist)
+                {
+                    int sym = DecodeSymbol(br, lenCode);
+                    if (sym < 0)
+                        return false;
+
+                    if (sym < 16)
+                    {
+                        lengths[index++] = (uint8_t)sym;
+                        continue;
+                    }
+
+                    uint8_t value = 0;
+                    uint32_t repeat = 0;
+                    if (sym == 16)
+                    {
+                        if (index == 0 || !br.Bits(2, repeat))
+                            return false;
+                        value = lengths[index - 1];
+                        repeat += 3;
+                    }
+                    else if (sym == 17)
+                    {
+                        if (!br.Bits(3, repeat))
+                            return false;
+                        repeat += 3;
+                    }
+                    else
+                    {
+                        if (!br.Bits(7, repeat))
+                            return false;
+                        repeat += 11;
+                    }
+
+                    if (index + repeat > hlit + hdist)
+                        return false;
+                    while (repeat--)
+                        lengths[index++] = value;
+                }
+
+                Huffman lit, dist;
+                if (!BuildHuffman(lit, lengths, hlit) || !BuildHuffman(dist, lengths + hlit, hdist))
+                    return false;
+
+                if (!InflateCodes(br, lit, dist, out))
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // -----------------------------
+    // PNG
+    // -----------------------------
+    uint32_t ReadBE32(const uint8_t* p)
+    {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+
+    uint8_t Paeth(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = abs(p - a);
+        int pb = abs(p - b);
+        int pc = abs(p - c);
+        if (pa <= pb && pa <= pc) return (uint8_t)a;
+        if (pb <= pc) return (uint8_t)b;
+        return (uint8_t)c;
+    }
+
+    bool Unfilter(uint8_t* data, uint32_t height, size_t stride, uint32_t bpp)
+    {
+        std::vector<uint8_t> zero(stride, 0);
+        const uint8_t* prev = zero.data();
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            uint8_t filter = data[y * (stride + 1)];
+            uint8_t* row = data + y * (stride + 1) + 1;
+
+            switch (filter)
+            {
+            case 0:
+                break;
+            case 1:
+                for (size_t i = bpp; i < stride; ++i) row[i] += row[i - bpp];
+                break;
+            case 2:
+                for (size_t i = 0; i < stride; ++i) row[i] += prev[i];
+                break;
+            case 3:
+                for (size_t i = 0; i < stride; ++i)
+                    row[i] += (uint8_t)(((i >= bpp ? row[i - bpp] : 0) + prev[i]) / 2);
+                break;
+            case 4:
+                for (size_t i = 0; i < stride; ++i)
+                    row[i] += Paeth(i >= bpp ? row[i - bpp] : 0, prev[i], i >= bpp ? prev[i - bpp] : 0);
+                break;
+            default:
+                return false;
+            }
+            prev = row;
+        }
+        return true;
+    }
+}
+
+bool PngDecoder::DecodeMemory(const uint8_t* data, size_t size, TextureMipLevel& outLevel)
+{
+    static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (size < 8 || memcmp(data, SIGNATURE, 8) != 0)
+        return false;
+
+    uint32_t width = 0, height = 0;
+    uint8_t bitDepth = 0, colorType = 0, interlace = 0;
+    uint8_t palette[256][4] = {};
+    std::vector<uint8_t> idat;
+
+    size_t pos = 8;
+    while (pos + 12 <= size)
+    {
+        uint32_t length = ReadBE32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* chunk = data + pos + 8;
+        if (pos + 12 + (size_t)length > size)
+            return false;
+
+        if (memcmp(type, "IHDR", 4) == 0 && length >= 13)
+        {
+            width = ReadBE32(chunk);
+            height = ReadBE32(chunk + 4);
+            bitDepth = chunk[8];
+            colorType = chunk[9];
+            interlace = chunk[12];
+        }
+        else if (memcmp(type, "PLTE", 4) == 0)
+        {
+            for (uint32_t i = 0; i < length / 3 && i < 256; ++i)
+            {
+                palette[i][0] = chunk[i * 3 + 0];
+                palette[i][1] = chunk[i * 3 + 1];
+                palette[i][2] = chunk[i * 3 + 2];
+                palette[i][3] = 255;
+            }
+        }
+        else if (memcmp(type, "tRNS", 4) == 0 && colorType == 3)
+        {
+            for (uint32_t i = 0; i < length && i < 256; ++i)
+                palette[i][3] = chunk[i];
+        }
+        else if (memcmp(type, "IDAT", 4) == 0)
+        {
+            idat.insert(idat.end(), chunk, chunk + length);
+        }
+        else if (memcmp(type, "IEND", 4) == 0)
+        {
+            break;
+        }
+
+        pos += 12 + (size_t)length;
+    }
+
+    if (width == 0 || height == 0 || interlace != 0)
+        return false;
+
+    uint32_t channels = 0;
+    switch (colorType)
+    {
+    case 0: channels = 1; break;
+    case 2: channels = 3; break;
+    case 3: channels = 1; break;
+    case 4: channels = 2; break;
+    case 6: channels = 4; break;
+    default: return false;
+    }
+
+    if (!(bitDepth == 8 || (bitDepth == 16 && colorType != 3)))
+        return false;
+
+    uint32_t bytesPerSample = bitDepth / 8;
+    uint32_t bpp = channels * bytesPerSample;
+    size_t stride = (size_t)width * bpp;
+
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * height);
+    if (!Inflate(idat.data(), idat.size(), raw) || raw.size() < (stride + 1) * height)
+        return false;
+
+    if (!Unfilter(raw.data(), height, stride, bpp))
+        return false;
+
+    outLevel.width = width;
+    outLevel.height = height;
+    outLevel.pixels.resize((size_t)width * height * 4);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* src = raw.data() + y * (stride + 1) + 1;
+        uint8_t* dst = outLevel.pixels.data() + (size_t)y * width * 4;
+
+        for (uint32_t x = 0; x < width; ++x, dst += 4)
+        {
+            // 16-bit samples are big endian, keep the high byte
+            const uint8_t* s = src + (size_t)x * bpp;
+            auto sample = [&](uint32_t c) { return s[c * bytesPerSample]; };
+
+            switch (colorType)
+            {
+            case 0: dst[0] = dst[1] = dst[2] = sample(0); dst[3] = 255; break;
+            case 2: dst[0] = sample(0); dst[1] = sample(1); dst[2] = sample(2); dst[3] = 255; break;
+            case 3: memcpy(dst, palette[s[0]], 4); break;
+            case 4: dst[0] = dst[1] = dst[2] = sample(0); dst[3] = sample(1); break;
+            case 6: dst[0] = sample(0); dst[1] = sample(1); dst[2] = sample(2); dst[3] = sample(3); break;
+            }
+        }
+    }
+    return true;
+}
+
+bool PngDecoder::Decode(const std::filesystem::path& path, TextureMipLevel& outLevel)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::vector<uint8_t> bytes((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read((char*)bytes.data(), (std::streamsize)bytes.size()))
+        return false;
+
+    return DecodeMemory(bytes.data(), bytes.size(), outLevel);
+}
+
+bool PngDecoder::Decode(const std::vector<uint8_t>& bytes, const std::filesystem::path&, TextureMipLevel& outLevel)
+{
+    return DecodeMemory(bytes.data(), bytes.size(), outLevel);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "TextureStreamer.h"
+
+namespace Engine::Graphics
+{
+    // Portable PNG reader (8/16-bit gray, gray+alpha, RGB, RGBA and 8-bit palette,
+    // non-interlaced) so textures can be decoded and cooked without WIC.
+    class PngDecoder : public ITextureDecoder
+    {
+    public:
+        bool Decode(const std::filesystem::path& path, TextureMipLevel& outLevel) override;
+        bool Decode(const std::vector<uint8_t>& bytes, const std::filesystem::path& path,
+            TextureMipLevel& outLevel) override;
+
+        static bool DecodeMemory(const uint8_t* data, size_t size, TextureMipLevel& outLevel);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,468 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+using namespace Engine::Core;
+
+namespace
+{
+    enum EventKind : uint32_t
+    {
+        EVENT_BEGIN,
+        EVENT_END
+    };
+
+    struct Event
+    {
+        const char* name;
+        uint64_t time;
+        uint32_t kind;
+    };
+
+    struct OpenScope
+    {
+        const char* name;
+        uint64_t begin;
+        std::string path;
+    };
+
+    // Written by its thread, drained by EndFrame
+    struct ThreadRing
+    {
+        Event events[PROFILER_RING_CAPACITY];
+        std::atomic<uint64_t> head{ 0 };    // next write, producer only
+        std::atomic<uint64_t> tail{ 0 };    // next read, consumer only
+
+        // Producer side
+        uint32_t open = 0;                  // recorded begins still waiting for their end
+        uint32_t skipped = 0;               // dropped begins still open, their ends are dropped too
+        std::atomic<uint64_t> dropped{ 0 };
+
+        // Consumer side
+        uint32_t track = 0;
+        std::string name;
+        std::vector<OpenScope> stack;
+    };
+
+    static constexpr uint32_t GPU_TRACK = ~0u;
+
+    struct TraceScope
+    {
+        const char* name;
+        uint32_t track;
+        uint32_t depth;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    struct ScopeSample
+    {
+        uint64_t frame = 0;
+        double ms = 0.0;
+        uint32_t calls = 0;
+    };
+
+    // The last PROFILER_AVERAGE_FRAMES frames the scope ran in, plus the one being summed
+    struct ScopeHistory
+    {
+        ScopeSample samples[PROFILER_AVERAGE_FRAMES];
+        uint32_t next = 0;
+        uint64_t frame = ~0ull;
+        double frameMs = 0.0;
+        uint32_t frameCalls = 0;
+    };
+
+    std::atomic<bool> s_enabled{ true };
+    std::atomic<uint64_t> s_generation{ 1 };
+    uint64_t s_origin = 0;
+
+    // Registration and everything EndFrame collects; never taken while recording
+    std::mutex s_mutex;
+    std::vector<std::unique_ptr<ThreadRing>> s_rings;
+    std::deque<std::vector<TraceScope>> s_trace;
+    std::map<std::string, ScopeHistory> s_cpuScopes;
+    std::map<std::string, ScopeHistory> s_gpuScopes;
+    uint64_t s_frames = 0;
+    uint64_t s_gpuFrames = 0;
+
+    thread_local ThreadRing* t_ring = nullptr;
+    thread_local uint64_t t_generation = 0;
+
+    ThreadRing* GetThreadRing()
+    {
+        // Rings of a previous Initialize are gone; register again
+        uint64_t generation = s_generation.load(std::memory_order_acquire);
+        if (t_ring && t_generation == generation)
+            return t_ring;
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_rings.push_back(std::make_unique<ThreadRing>());
+        t_ring = s_rings.back().get();
+        t_ring->track = (uint32_t)s_rings.size();
+        t_generation = generation;
+        return t_ring;
+    }
+
+    bool Push(ThreadRing& ring, const char* name, uint32_t kind)
+    {
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        uint64_t used = head - ring.tail.load(std::memory_order_acquire);
+
+        // A begin also keeps room for the end of every open scope, its own
+        // included, so an end always fits and the consumer never sees half a scope
+        uint64_t needed = kind == EVENT_BEGIN ? (uint64_t)ring.open + 2 : 1;
+        if (PROFILER_RING_CAPACITY - used < needed)
+            return false;
+
+        Event& event = ring.events[head % PROFILER_RING_CAPACITY];
+        event.name = name;
+        event.time = Profiler::Now();
+        event.kind = kind;
+        ring.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void AddSample(std::map<std::string, ScopeHistory>& scopes, const std::string& path, uint64_t frame, double ms)
+    {
+        ScopeHistory& history = scopes[path];
+        if (history.frame != frame)
+        {
+            history.frame = frame;
+            history.frameMs = 0.0;
+            history.frameCalls = 0;
+        }
+        history.frameMs += ms;
+        ++history.frameCalls;
+    }
+
+    // Closes the frame of every scope that ran in it
+    void CommitSamples(std::map<std::string, ScopeHistory>& scopes, uint64_t frame)
+    {
+        for (auto& [path, history] : scopes)
+        {
+            if (history.frame != frame || !history.frameCalls)
+                continue;
+
+            ScopeSample& sample = history.samples[history.next];
+            sample.frame = frame;
+            sample.ms = history.frameMs;
+            sample.calls = history.frameCalls;
+            history.next = (history.next + 1) % PROFILER_AVERAGE_FRAMES;
+            history.frameCalls = 0;
+        }
+    }
+
+    bool Summarize(const std::string& path, const ScopeHistory& history, bool gpu, uint64_t lastFrame,
+        ProfileScopeStats& outStats)
+    {
+        outStats = ProfileScopeStats();
+        outStats.path = path;
+        outStats.gpu = gpu;
+
+        double totalMs = 0.0;
+        uint64_t calls = 0;
+        uint64_t newest = 0;
+        for (const ScopeSample& sample : history.samples)
+        {
+            // Unused, or older than the window
+            if (!sample.calls || sample.frame + PROFILER_AVERAGE_FRAMES <= lastFrame)
+                continue;
+
+            outStats.minMs = outStats.frames ? (std::min)(outStats.minMs, sample.ms) : sample.ms;
+            outStats.maxMs = (std::max)(outStats.maxMs, sample.ms);
+            if (!outStats.frames || sample.frame >= newest)
+            {
+                newest = sample.frame;
+                outStats.lastMs = sample.ms;
+            }
+            totalMs += sample.ms;
+            calls += sample.calls;
+            ++outStats.frames;
+        }
+
+        if (!outStats.frames)
+            return false;
+        outStats.averageMs = totalMs / outStats.frames;
+        outStats.callsPerFrame = (double)calls / outStats.frames;
+        return true;
+    }
+
+    void KeepTraceFrame(std::vector<TraceScope>&& scopes)
+    {
+        s_trace.push_back(std::move(scopes));
+        while (s_trace.size() > PROFILER_TRACE_FRAMES)
+            s_trace.pop_front();
+    }
+
+    void AppendEscaped(std::string& out, const char* text)
+    {
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                out += '\\';
+            if ((unsigned char)*c < 0x20)
+                continue;
+            out += *c;
+        }
+    }
+}
+
+void Profiler::Initialize()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_rings.clear();
+    s_trace.clear();
+    s_cpuScopes.clear();
+    s_gpuScopes.clear();
+    s_frames = 0;
+    s_gpuFrames = 0;
+    s_origin = Now();
+    s_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Profiler::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_rings.clear();
+    s_trace.clear();
+    s_cpuScopes.clear();
+    s_gpuScopes.clear();
+    s_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::IsEnabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t Profiler::Now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ThreadRing* ring = GetThreadRing();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    ring->name = name;
+}
+
+bool Profiler::BeginScope(const char* name)
+{
+    if (!s_enabled.load(std::memory_order_relaxed))
+        return false;
+
+    ThreadRing& ring = *GetThreadRing();
+    if (ring.skipped || !Push(ring, name, EVENT_BEGIN))
+    {
+        // Dropped with everything nested in it
+        ++ring.skipped;
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    ++ring.open;
+    return true;
+}
+
+void Profiler::EndScope()
+{
+    ThreadRing& ring = *GetThreadRing();
+    if (ring.skipped)
+    {
+        --ring.skipped;
+        return;
+    }
+    if (!ring.open)
+        return;
+
+    Push(ring, nullptr, EVENT_END);
+    --ring.open;
+}
+
+void Profiler::EndFrame()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    uint64_t frame = s_frames++;
+
+    std::vector<TraceScope> trace;
+    for (std::unique_ptr<ThreadRing>& ring : s_rings)
+    {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail)
+        {
+            const Event& event = ring->events[tail % PROFILER_RING_CAPACITY];
+            if (event.kind == EVENT_BEGIN)
+            {
+                std::string path = ring->stack.empty() ? std::string() : ring->stack.back().path + "/";
+                ring->stack.push_back({ event.name, event.time, path + event.name });
+                continue;
+            }
+
+            // Scopes still open at the frame boundary finish in a later frame
+            if (ring->stack.empty())
+                continue;
+            OpenScope scope = std::move(ring->stack.back());
+            ring->stack.pop_back();
+            AddSample(s_cpuScopes, scope.path, frame, (event.time - scope.begin) / 1e6);
+            trace.push_back({ scope.name, ring->track, (uint32_t)ring->stack.size(), scope.begin, event.time });
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+
+    CommitSamples(s_cpuScopes, frame);
+    KeepTraceFrame(std::move(trace));
+}
+
+void Profiler::SubmitGpuFrame(const GpuScopeTimestamps* scopes, uint32_t count, uint64_t frequency,
+    uint64_t frameBegin, uint64_t cpuFrameBegin)
+{
+    if (!frequency)
+        return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    uint64_t frame = s_gpuFrames++;
+
+    // Signed: a scope may start on the GPU before the tick taken as the frame's start
+    auto toCpu = [&](uint64_t tick) {
+        double offset = ((double)(int64_t)(tick - frameBegin) * 1e9) / (double)frequency;
+        return (uint64_t)((int64_t)cpuFrameBegin + (int64_t)offset);
+    };
+
+    std::vector<std::string> paths;
+    std::vector<TraceScope> trace;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const GpuScopeTimestamps& scope = scopes[i];
+        paths.resize((std::min)((size_t)scope.depth, paths.size()));
+        paths.push_back(paths.empty() ? std::string(scope.name) : paths.back() + "/" + scope.name);
+
+        uint64_t end = (std::max)(scope.end, scope.begin);
+        AddSample(s_gpuScopes, paths.back(), frame, ((double)(end - scope.begin) * 1e3) / (double)frequency);
+        trace.push_back({ scope.name, GPU_TRACK, scope.depth, toCpu(scope.begin), toCpu(end) });
+    }
+
+    CommitSamples(s_gpuScopes, frame);
+
+    // Onto the newest CPU frame; the trace orders by time, not by frame
+    if (s_trace.empty())
+        KeepTraceFrame(std::move(trace));
+    else
+        s_trace.back().insert(s_trace.back().end(), trace.begin(), trace.end());
+}
+
+bool Profiler::GetScopeStats(const std::string& path, bool gpu, ProfileScopeStats& outStats)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    const std::map<std::string, ScopeHistory>& scopes = gpu ? s_gpuScopes : s_cpuScopes;
+    auto it = scopes.find(path);
+    if (it == scopes.end())
+        return false;
+
+    uint64_t frames = gpu ? s_gpuFrames : s_frames;
+    return Summarize(it->first, it->second, gpu, frames ? frames - 1 : 0, outStats);
+}
+
+std::vector<ProfileScopeStats> Profiler::GetAllScopeStats()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::vector<ProfileScopeStats> result;
+    ProfileScopeStats stats;
+    for (const auto& [path, history] : s_cpuScopes)
+    {
+        if (Summarize(path, history, false, s_frames ? s_frames - 1 : 0, stats))
+            result.push_back(stats);
+    }
+    for (const auto& [path, history] : s_gpuScopes)
+    {
+        if (Summarize(path, history, true, s_gpuFrames ? s_gpuFrames - 1 : 0, stats))
+            result.push_back(stats);
+    }
+    return result;
+}
+
+ProfilerStats Profiler::GetStats()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    ProfilerStats stats;
+    stats.threads = (uint32_t)s_rings.size();
+    stats.frames = s_frames;
+    for (const std::unique_ptr<ThreadRing>& ring : s_rings)
+        stats.droppedEvents += ring->dropped.load(std::memory_order_relaxed);
+    for (const std::vector<TraceScope>& frame : s_trace)
+        stats.traceScopes += (uint32_t)frame.size();
+    return stats;
+}
+
+std::string Profiler::WriteChromeTrace()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    // Complete ("X") events in microseconds, one pid for the CPU threads and one for the GPU
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    char line[128];
+    bool first = true;
+    auto separate = [&]() {
+        if (!first)
+            out += ",\n";
+        first = false;
+    };
+
+    for (const std::unique_ptr<ThreadRing>& ring : s_rings)
+    {
+        separate();
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":";
+        out += std::to_string(ring->track);
+        out += ",\"args\":{\"name\":\"";
+        if (ring->name.empty())
+            out += "Thread " + std::to_string(ring->track);
+        else
+            AppendEscaped(out, ring->name.c_str());
+        out += "\"}}";
+    }
+    separate();
+    out += "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    out += "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    for (const std::vector<TraceScope>& frame : s_trace)
+    {
+        for (const TraceScope& scope : frame)
+        {
+            separate();
+            out += "{\"ph\":\"X\",\"name\":\"";
+            AppendEscaped(out, scope.name);
+            double ts = ((double)(int64_t)(scope.begin - s_origin)) / 1e3;
+            double dur = (double)(scope.end - scope.begin) / 1e3;
+            snprintf(line, sizeof(line), "\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                scope.track == GPU_TRACK ? 2 : 1, scope.track == GPU_TRACK ? 1u : scope.track, ts, dur);
+            out += line;
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool Profiler::ExportChromeTrace(const std::filesystem::path& path)
+{
+    std::string json = WriteChromeTrace();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    file.write(json.data(), (std::streamsize)json.size());
+    return (bool)file;
+}
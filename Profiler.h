@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Engine::Core
+{
+    // Events one thread can have in flight before the frame drains them
+    static constexpr uint32_t PROFILER_RING_CAPACITY = 1u << 14;
+
+    // Frames the per-scope averages span, and frames a trace export keeps
+    static constexpr uint32_t PROFILER_AVERAGE_FRAMES = 64;
+    static constexpr uint32_t PROFILER_TRACE_FRAMES = 300;
+
+    // One scope over the averaging window. Paths join the names of the
+    // enclosing scopes with '/', e.g. "Frame/ShadowPass".
+    struct ProfileScopeStats
+    {
+        std::string path;
+        bool gpu = false;
+        uint32_t frames = 0;            // in the window, with at least one call
+        double averageMs = 0.0;         // per frame it ran, all calls summed
+        double minMs = 0.0;
+        double maxMs = 0.0;
+        double lastMs = 0.0;
+        double callsPerFrame = 0.0;
+    };
+
+    // One GPU scope in timestamp ticks, begin order, as GpuProfiler resolves them
+    struct GpuScopeTimestamps
+    {
+        const char* name = nullptr;
+        uint32_t depth = 0;             // 0: a root scope of the frame
+        uint64_t begin = 0;
+        uint64_t end = 0;
+    };
+
+    struct ProfilerStats
+    {
+        uint32_t threads = 0;
+        uint64_t frames = 0;
+        uint64_t droppedEvents = 0;     // a full ring drops a whole scope, never half of one
+        uint32_t traceScopes = 0;       // kept for export
+    };
+
+    // Hierarchical CPU profiler. Every thread writes begin/end events into a
+    // ring of its own, single producer, single consumer, so recording takes
+    // no lock; only a thread's first event registers its ring. EndFrame, on
+    // the main thread, drains every ring, pairs the events into scopes, and
+    // folds them into the per-scope averages and the trace history.
+    // GPU scopes come in through SubmitGpuFrame, frames late, on a track of
+    // their own.
+    //
+    // Scope names must outlive the profiler (string literals). Initialize
+    // and Shutdown only with no scope open on any thread.
+    class Profiler
+    {
+    public:
+        static void Initialize();
+        static void Shutdown();
+
+        // Off: BeginScope and EndScope return at once, nothing is recorded
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled();
+
+        // Monotonic, the time base of every event
+        static uint64_t Now();
+
+        // Names the calling thread's track in the trace
+        static void SetThreadName(const char* name);
+
+        // True when the scope needs its EndScope, false while disabled
+        static bool BeginScope(const char* name);
+        static void EndScope();
+
+        // Main thread, once per frame: drains every thread's events recorded so far
+        static void EndFrame();
+
+        // One resolved GPU frame. frameBegin is the tick that lines up with
+        // cpuFrameBegin (Now()), which places the scopes on the CPU timeline.
+        static void SubmitGpuFrame(const GpuScopeTimestamps* scopes, uint32_t count, uint64_t frequency,
+            uint64_t frameBegin, uint64_t cpuFrameBegin);
+
+        // False when the scope did not run in the averaging window
+        static bool GetScopeStats(const std::string& path, bool gpu, ProfileScopeStats& outStats);
+        static std::vector<ProfileScopeStats> GetAllScopeStats();
+        static ProfilerStats GetStats();
+
+        // chrome://tracing and Perfetto JSON of the kept frames
+        static std::string WriteChromeTrace();
+        static bool ExportChromeTrace(const std::filesystem::path& path);
+    };
+
+    // Begins a scope on construction, ends it on destruction
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name) : m_active(Profiler::BeginScope(name)) {}
+        ~ProfileScope()
+        {
+            if (m_active)
+                Profiler::EndScope();
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        bool m_active;
+    };
+
+} // namespace Engine::Core
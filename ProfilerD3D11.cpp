@@ -0,0 +1,141 @@
+#include "ProfilerD3D11.h"
+
+using namespace Engine::Graphics;
+using Engine::Core::GpuScopeTimestamps;
+using Engine::Core::Profiler;
+
+GpuProfiler::GpuProfiler(ID3D11Device* device)
+    : m_device(device)
+{
+    m_stack.reserve(MAX_SCOPES);
+    m_resolved.reserve(MAX_SCOPES);
+}
+
+bool GpuProfiler::CreateQueries(Frame& frame)
+{
+    if (frame.disjoint)
+        return true;
+
+    D3D11_QUERY_DESC desc = {};
+    desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+    if (FAILED(m_device->CreateQuery(&desc, frame.disjoint.GetAddressOf())))
+        return false;
+
+    desc.Query = D3D11_QUERY_TIMESTAMP;
+    if (FAILED(m_device->CreateQuery(&desc, frame.start.GetAddressOf())))
+    {
+        frame.disjoint.Reset();
+        return false;
+    }
+    for (Scope& scope : frame.scopes)
+    {
+        if (FAILED(m_device->CreateQuery(&desc, scope.begin.GetAddressOf())) ||
+            FAILED(m_device->CreateQuery(&desc, scope.end.GetAddressOf())))
+        {
+            frame.disjoint.Reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+void GpuProfiler::BeginFrame(ID3D11DeviceContext* context)
+{
+    Frame& frame = m_frames[m_next];
+    m_stack.clear();
+    if (frame.pending || !Profiler::IsEnabled() || !CreateQueries(frame))
+        return;
+
+    frame.scopeCount = 0;
+    context->Begin(frame.disjoint.Get());
+    context->End(frame.start.Get());
+    frame.cpuStart = Profiler::Now();
+    m_open = true;
+}
+
+void GpuProfiler::BeginScope(ID3D11DeviceContext* context, const char* name)
+{
+    // Scopes past the limit still nest, they are just not timed
+    Frame& frame = m_frames[m_next];
+    if (!m_open || frame.scopeCount == MAX_SCOPES)
+    {
+        m_stack.push_back(MAX_SCOPES);
+        return;
+    }
+
+    Scope& scope = frame.scopes[frame.scopeCount];
+    scope.name = name;
+    scope.depth = (uint32_t)m_stack.size();
+    context->End(scope.begin.Get());
+    m_stack.push_back(frame.scopeCount++);
+}
+
+void GpuProfiler::EndScope(ID3D11DeviceContext* context)
+{
+    if (m_stack.empty())
+        return;
+
+    uint32_t index = m_stack.back();
+    m_stack.pop_back();
+    if (m_open && index < MAX_SCOPES)
+        context->End(m_frames[m_next].scopes[index].end.Get());
+}
+
+void GpuProfiler::EndFrame(ID3D11DeviceContext* context)
+{
+    if (m_open)
+    {
+        // Scopes left open end with the frame
+        while (!m_stack.empty())
+            EndScope(context);
+
+        Frame& frame = m_frames[m_next];
+        context->End(frame.disjoint.Get());
+        frame.pending = true;
+        m_open = false;
+        m_next = (m_next + 1) % LATENCY;
+    }
+
+    Collect(context);
+}
+
+void GpuProfiler::Collect(ID3D11DeviceContext* context)
+{
+    while (m_frames[m_oldest].pending)
+    {
+        Frame& frame = m_frames[m_oldest];
+
+        // S_FALSE while the GPU is still on it; never flush just to ask
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+        if (context->GetData(frame.disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+            return;
+
+        // Every timestamp inside a finished disjoint query has landed too
+        uint64_t start = 0;
+        bool valid = !disjoint.Disjoint &&
+            context->GetData(frame.start.Get(), &start, sizeof(start), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+
+        m_resolved.clear();
+        for (uint32_t i = 0; valid && i < frame.scopeCount; ++i)
+        {
+            GpuScopeTimestamps scope;
+            scope.name = frame.scopes[i].name;
+            scope.depth = frame.scopes[i].depth;
+            valid = context->GetData(frame.scopes[i].begin.Get(), &scope.begin, sizeof(scope.begin),
+                        D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK &&
+                    context->GetData(frame.scopes[i].end.Get(), &scope.end, sizeof(scope.end),
+                        D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+            m_resolved.push_back(scope);
+        }
+
+        // A disjoint frame (clock change, power event) has meaningless ticks: dropped
+        if (valid)
+        {
+            Profiler::SubmitGpuFrame(m_resolved.data(), (uint32_t)m_resolved.size(), disjoint.Frequency, start,
+                frame.cpuStart);
+        }
+
+        frame.pending = false;
+        m_oldest = (m_oldest + 1) % LATENCY;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <vector>
+#include "Profiler.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // GPU side of the profiler: timestamp queries around each scope, one
+    // disjoint query per frame, in a ring of LATENCY frames. Frames are read
+    // back without flushing as they finish and handed to
+    // Profiler::SubmitGpuFrame; a frame whose slot is still in flight is
+    // not timed at all instead of stalling. The trace places a GPU frame at
+    // the CPU time it was submitted, so its track leads the real execution
+    // by the queue depth; durations are exact.
+    class GpuProfiler
+    {
+    public:
+        static const uint32_t LATENCY = 4;
+        static const uint32_t MAX_SCOPES = 64;      // per frame, the rest are not timed
+
+        GpuProfiler(ID3D11Device* device);
+
+        void BeginFrame(ID3D11DeviceContext* context);
+
+        // Collects every finished frame after closing this one
+        void EndFrame(ID3D11DeviceContext* context);
+
+        // Names must outlive the profiler (string literals)
+        void BeginScope(ID3D11DeviceContext* context, const char* name);
+        void EndScope(ID3D11DeviceContext* context);
+
+    private:
+        struct Scope
+        {
+            const char* name = nullptr;
+            uint32_t depth = 0;
+            ComPtr<ID3D11Query> begin;
+            ComPtr<ID3D11Query> end;
+        };
+
+        struct Frame
+        {
+            ComPtr<ID3D11Query> disjoint;
+            ComPtr<ID3D11Query> start;
+            Scope scopes[MAX_SCOPES];
+            uint32_t scopeCount = 0;
+            uint64_t cpuStart = 0;
+            bool pending = false;
+        };
+
+        ComPtr<ID3D11Device> m_device;
+        Frame m_frames[LATENCY];
+        uint32_t m_next = 0;        // frame BeginFrame uses
+        uint32_t m_oldest = 0;      // frame Collect reads
+        bool m_open = false;
+        std::vector<uint32_t> m_stack;      // open scopes of the current frame
+        std::vector<Engine::Core::GpuScopeTimestamps> m_resolved;
+
+        bool CreateQueries(Frame& frame);
+        void Collect(ID3D11DeviceContext* context);
+    };
+
+    // Times a GPU scope and the CPU scope of the same name; a null profiler times the CPU only
+    class GpuProfileScope
+    {
+    public:
+        GpuProfileScope(GpuProfiler* profiler, ID3D11DeviceContext* context, const char* name)
+            : m_cpu(name), m_profiler(profiler), m_context(context)
+        {
+            if (m_profiler)
+                m_profiler->BeginScope(m_context, name);
+        }
+
+        ~GpuProfileScope()
+        {
+            if (m_profiler)
+                m_profiler->EndScope(m_context);
+        }
+
+        GpuProfileScope(const GpuProfileScope&) = delete;
+        GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+    private:
+        Engine::Core::ProfileScope m_cpu;
+        GpuProfiler* m_profiler;
+        ID3D11DeviceContext* m_context;
+    };
+
+} // namespace Engine::Graphics
@@ -26,4 +26,43 @@ void RenderObject::SetTexture(ID3D11ShaderResourceView* texture)
 ID3D11ShaderResourceView* RenderObject::GetTexture() const
 {
     return m_texture;
+}
+
+void RenderObject::SetTextureHandle(TextureHandle handle)
+{
+    m_textureHandle = handle;
+}
+
+TextureHandle RenderObject::GetTextureHandle() const
+{
+    return m_textureHandle;
+}
+void RenderObject::SetNormalMap(ID3D11ShaderResourceView* normalMap)
+{
+    m_normalMap = normalMap;
+}
+
+ID3D11ShaderResourceView* RenderObject::GetNormalMap() const
+{
+    return m_normalMap;
+}
+
+void RenderObject::SetAlphaTest(bool alphaTest)
+{
+    m_alphaTest = alphaTest;
+}
+
+bool RenderObject::GetAlphaTest() const
+{
+    return m_alphaTest;
+}
+
+void RenderObject::SetDynamic(bool dynamic)
+{
+    m_dynamic = dynamic;
+}
+
+bool RenderObject::IsDynamic() const
+{
+    return m_dynamic;
 }
\ No newline at end of file
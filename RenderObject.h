@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Transform.h"
+#include "TextureStreamer.h"
 #include <d3d11.h>
 
 namespace Engine::Graphics
@@ -17,9 +18,29 @@ namespace Engine::Graphics
         void SetTexture(ID3D11ShaderResourceView* texture);
         ID3D11ShaderResourceView* GetTexture() const;
 
+        // Streamed texture, takes precedence over SetTexture once resident
+        void SetTextureHandle(TextureHandle handle);
+        TextureHandle GetTextureHandle() const;
+
+        // Material features, they select the pixel shader variant
+        void SetNormalMap(ID3D11ShaderResourceView* normalMap);
+        ID3D11ShaderResourceView* GetNormalMap() const;
+        void SetAlphaTest(bool alphaTest);
+        bool GetAlphaTest() const;
+
+        // Dynamic objects move or animate; their shadows are redrawn every
+        // frame on top of the cached static casters. Changing it on a live
+        // object needs Renderer::InvalidateStaticShadows.
+        void SetDynamic(bool dynamic);
+        bool IsDynamic() const;
+
     private:
         Mesh* m_mesh = nullptr;
         Transform m_transform;
         ID3D11ShaderResourceView* m_texture = nullptr; 
+        TextureHandle m_textureHandle = INVALID_TEXTURE_HANDLE;
+        ID3D11ShaderResourceView* m_normalMap = nullptr;
+        bool m_alphaTest = false;
+        bool m_dynamic = false;
     };
 }
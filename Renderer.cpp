@@ -5,10 +5,17 @@
 #include "CBPerObject.h"
 #include "CBLight.h"
 #include "CBShadow.h"
+#include "CBDeferred.h"
+#include "CBEvsm.h"
 #include "Input.h"
 
 #include <DirectXMath.h>
-#include <WICTextureLoader.h>
+#include <algorithm>
+#include <DDSTextureLoader.h>
+#include <filesystem>
+#include <chrono>
+#include <random>
+#include <tuple>
 
 
 using namespace Engine::Graphics;
@@ -17,6 +24,33 @@ using namespace DirectX;
 using namespace std;
 
 
+static ShadowVector ToShadowVector(FXMVECTOR v)
+{
+    return { XMVectorGetX(v), XMVectorGetY(v), XMVectorGetZ(v) };
+}
+
+static OcclusionMatrix ToOcclusionMatrix(FXMMATRIX m)
+{
+    XMFLOAT4X4 stored;
+    XMStoreFloat4x4(&stored, m);
+
+    OcclusionMatrix result;
+    memcpy(result.m, stored.m, sizeof(result.m));
+    return result;
+}
+
+static PipelineCounters ToPipelineCounters(const D3D11_QUERY_DATA_PIPELINE_STATISTICS& data)
+{
+    PipelineCounters counters;
+    counters.iaVertices = data.IAVertices;
+    counters.iaPrimitives = data.IAPrimitives;
+    counters.vsInvocations = data.VSInvocations;
+    counters.rasterizedPrimitives = data.CPrimitives;
+    counters.psInvocations = data.PSInvocations;
+    counters.csInvocations = data.CSInvocations;
+    return counters;
+}
+
 static XMFLOAT3 Normalize(const XMFLOAT3& v)
 {
     XMVECTOR vec = XMLoadFloat3(&v);
@@ -26,62 +60,21 @@ static XMFLOAT3 Normalize(const XMFLOAT3& v)
     return result;
 }
 
-void GetFrustrumConrersWS(const XMMATRIX& view, const XMMATRIX& proj, float nearZ, float farZ, vector<XMVECTOR>& corners)
+// Output of Tools/TextureCooker: BC-compressed with a full mip chain, no decode needed
+static ID3D11ShaderResourceView* LoadCookedTexture(ID3D11Device* device, const wchar_t* path)
 {
-    corners.clear();
-
-    XMMATRIX invView = XMMatrixInverse(nullptr, view);
-    XMMATRIX invProj = XMMatrixInverse(nullptr, proj);
-
-    static const XMFLOAT2 ndcCorners[4] =
-    {
-        { -1,  1 },
-        {  1,  1 },
-        {  1, -1 },
-        { -1, -1 }
-    };
+    if (!filesystem::exists(path))
+        return nullptr;
 
-    for (int i = 0; i < 4; ++i)
+    ID3D11ShaderResourceView* srv = nullptr;
+    if (FAILED(CreateDDSTextureFromFile(device, path, nullptr, &srv)))
     {
-        // Near plane in NDC (z = 0 for LH)
-        XMVECTOR cornerNearNDC = XMVectorSet(ndcCorners[i].x, ndcCorners[i].y, 0.0f, 1.0f);
-        // Far plane in NDC (z = 1 for LH)
-        XMVECTOR cornerFarNDC = XMVectorSet(ndcCorners[i].x, ndcCorners[i].y, 1.0f, 1.0f);
-
-        // Transform to view space
-        XMVECTOR cornerNearVS = XMVector4Transform(cornerNearNDC, invProj);
-        XMVECTOR cornerFarVS = XMVector4Transform(cornerFarNDC, invProj);
-
-        cornerNearVS /= XMVectorGetW(cornerNearVS);
-        cornerFarVS /= XMVectorGetW(cornerFarVS);
-
-        // Ray direction in view space (from near to far)
-        XMVECTOR dir = cornerFarVS - cornerNearVS;
-
-        // Get the view-space z values at the projection's near and far planes
-        float vsNearZ = XMVectorGetZ(cornerNearVS);
-        float vsFarZ = XMVectorGetZ(cornerFarVS);
-
-        // Calculate interpolation factors for the desired cascade depths
-        float tNear = (nearZ - vsNearZ) / (vsFarZ - vsNearZ);
-        float tFar = (farZ - vsNearZ) / (vsFarZ - vsNearZ);
-
-        // Interpolate to get view-space positions at desired depths
-        XMVECTOR pointNearVS = cornerNearVS + dir * tNear;
-        XMVECTOR pointFarVS = cornerNearVS + dir * tFar;
-
-        // Transform to world space
-        XMVECTOR cornerNearWS = XMVector4Transform(pointNearVS, invView);
-        XMVECTOR cornerFarWS = XMVector4Transform(pointFarVS, invView);
-
-        corners.push_back(cornerNearWS);
-        corners.push_back(cornerFarWS);
+        OutputDebugStringA("Failed to load cooked texture, streaming the source instead\n");
+        return nullptr;
     }
+    return srv;
 }
 
-
-
-
 Renderer::Renderer() = default;
 
 Renderer::~Renderer()
@@ -89,10 +82,119 @@ Renderer::~Renderer()
     Release();
 }
 
+// C++ mirrors of the HLSL cbuffers, checked against shader reflection at load
+static const ConstantBufferMember PER_OBJECT_MEMBERS[] =
+{
+    CB_MEMBER(CBPerObject, World),
+    CB_MEMBER(CBPerObject, WorldInvTranspose),
+    CB_MEMBER(CBPerObject, View),
+    CB_MEMBER(CBPerObject, Projection),
+    CB_MEMBER(CBPerObject, LightViewProj),
+    CB_MEMBER(CBPerObject, CascadeRange)
+};
+
+static const ConstantBufferMember LIGHT_MEMBERS[] =
+{
+    CB_MEMBER(CBLight, LightCount),
+    CB_MEMBER(CBLight, CameraPosition),
+    CB_MEMBER(CBLight, Lights),
+    CB_MEMBER(CBLight, ClusterDims),
+    CB_MEMBER(CBLight, ClusterParams)
+};
+
+static const ConstantBufferMember SHADOW_MEMBERS[] =
+{
+    CB_MEMBER(CBShadow, LightViewProj),
+    CB_MEMBER(CBShadow, CascadeSplits),
+    CB_MEMBER(CBShadow, CascadeFilterRadius),
+    CB_MEMBER(CBShadow, ShadowFilterParams),
+    CB_MEMBER(CBShadow, EvsmParams),
+    CB_MEMBER(CBShadow, EvsmLodScale)
+};
+
+static const ConstantBufferMember DEFERRED_MEMBERS[] =
+{
+    CB_MEMBER(CBDeferred, InvViewProj),
+    CB_MEMBER(CBDeferred, View)
+};
+
+static const ConstantBufferMember EVSM_MEMBERS[] =
+{
+    CB_MEMBER(CBEvsm, EvsmExponents),
+    CB_MEMBER(CBEvsm, EvsmBlurWeights),
+    CB_MEMBER(CBEvsm, EvsmBlurParams)
+};
+
+static const ConstantBufferLayout CONSTANT_BUFFER_LAYOUTS[] =
+{
+    { "CBPerObject", 0, sizeof(CBPerObject), PER_OBJECT_MEMBERS, ARRAYSIZE(PER_OBJECT_MEMBERS) },
+    { "CBLight", 1, sizeof(CBLight), LIGHT_MEMBERS, ARRAYSIZE(LIGHT_MEMBERS) },
+    { "CBShadow", 2, sizeof(CBShadow), SHADOW_MEMBERS, ARRAYSIZE(SHADOW_MEMBERS) },
+    { "CBDeferred", 3, sizeof(CBDeferred), DEFERRED_MEMBERS, ARRAYSIZE(DEFERRED_MEMBERS) },
+    { "CBEvsm", 4, sizeof(CBEvsm), EVSM_MEMBERS, ARRAYSIZE(EVSM_MEMBERS) }
+};
+
+// Vertex + pixel programs compiled in one batch at startup. The batch holds
+// each program's vertex stage at VertexStage() and pixel stage at PixelStage().
+enum StartupProgram : uint32_t
+{
+    PROGRAM_SIMPLE = 0,
+    PROGRAM_SHADOW,
+    PROGRAM_SHADOW_DEBUG,
+    PROGRAM_GBUFFER,
+    PROGRAM_DEFERRED_LIGHT,
+    PROGRAM_DEFERRED_COMPOSITE,
+    PROGRAM_DEPTH_PREPASS,
+    PROGRAM_SHADOW_CASCADES,
+    PROGRAM_EVSM_CONVERT,
+    PROGRAM_EVSM_BLUR,
+    PROGRAM_ATLAS_CLEAR,
+    PROGRAM_INSTANCED,
+    PROGRAM_INSTANCED_PREPASS,
+    PROGRAM_INSTANCED_SHADOW,
+    PROGRAM_DEBUG_TEXT,
+    PROGRAM_COUNT
+};
+
+// Vertex inputs the startup programs are created with
+enum StartupLayout : uint32_t
+{
+    LAYOUT_VERTEX = 0,              // full Vertex
+    LAYOUT_POSITION,                // position only, out of the full Vertex
+    LAYOUT_INSTANCED,               // full Vertex + object index per instance
+    LAYOUT_INSTANCED_POSITION,
+    LAYOUT_QUAD,                    // position + uv, fullscreen and debug quads
+    LAYOUT_COUNT
+};
+
+// The name shows up in layout validation errors and hot reload messages
+static const struct { const char* name; const wchar_t* vs; const wchar_t* ps; StartupLayout layout; } STARTUP_PROGRAMS[PROGRAM_COUNT] =
+{
+    { "Simple", L"SimpleVS.hlsl", L"SimplePS.hlsl", LAYOUT_VERTEX },
+    { "Shadow", L"ShadowVS.hlsl", L"ShadowPS.hlsl", LAYOUT_VERTEX },
+    { "ShadowDebug", L"ShadowDebugVS.hlsl", L"ShadowDebugPS.hlsl", LAYOUT_QUAD },
+    { "GBuffer", L"SimpleVS.hlsl", L"GBufferPS.hlsl", LAYOUT_VERTEX },
+    { "DeferredLight", L"FullscreenVS.hlsl", L"DeferredLightPS.hlsl", LAYOUT_QUAD },
+    { "DeferredComposite", L"FullscreenVS.hlsl", L"DeferredCompositePS.hlsl", LAYOUT_QUAD },
+    { "DepthPrepass", L"DepthPrepassVS.hlsl", L"ShadowPS.hlsl", LAYOUT_POSITION },
+    { "ShadowCascades", L"ShadowCascadesVS.hlsl", L"ShadowPS.hlsl", LAYOUT_VERTEX },
+    { "EvsmConvert", L"FullscreenVS.hlsl", L"EvsmConvertPS.hlsl", LAYOUT_QUAD },
+    { "EvsmBlur", L"FullscreenVS.hlsl", L"EvsmBlurPS.hlsl", LAYOUT_QUAD },
+    { "ShadowAtlasClear", L"FullscreenVS.hlsl", L"ShadowPS.hlsl", LAYOUT_QUAD },
+    { "SimpleInstanced", L"SimpleInstancedVS.hlsl", L"SimplePS.hlsl", LAYOUT_INSTANCED },
+    { "DepthPrepassInstanced", L"DepthPrepassInstancedVS.hlsl", L"ShadowPS.hlsl", LAYOUT_INSTANCED_POSITION },
+    { "ShadowInstanced", L"ShadowInstancedVS.hlsl", L"ShadowPS.hlsl", LAYOUT_INSTANCED_POSITION },
+    { "DebugText", L"ShadowDebugVS.hlsl", L"DebugTextPS.hlsl", LAYOUT_QUAD }
+};
+
+static uint32_t VertexStage(StartupProgram program) { return program * 2; }
+static uint32_t PixelStage(StartupProgram program) { return program * 2 + 1; }
+
 bool Renderer::Initialize(DeviceResources* deviceResources)
 {
     if (!deviceResources) return false;
     m_deviceResources = deviceResources;
+    m_initTime = std::chrono::steady_clock::now();
     return CreateResources();
 }
 
@@ -106,15 +208,53 @@ bool Renderer::CreateResources()
     if (!device || !context) return false;
 
 
+    m_shaderCompiler = new D3DShaderCompiler();
+    m_shaderCache = new ShaderCache(m_shaderCompiler);
     m_shader = new Shader();
     m_shadowShader = new Shader();
+    m_shadowCascadesShader = new Shader();
 	m_shadowDebugShader = new Shader();
+    m_gbufferShader = new Shader();
+    m_deferredLightShader = new Shader();
+    m_compositeShader = new Shader();
+    m_depthPrepassShader = new Shader();
+    m_evsmConvertShader = new Shader();
+    m_evsmBlurShader = new Shader();
+    m_atlasClearShader = new Shader();
+    m_instancedShader = new Shader();
+    m_instancedPrepassShader = new Shader();
+    m_instancedShadowShader = new Shader();
+    m_debugTextShader = new Shader();
+
+    // Each program's shader object, in StartupProgram order
+    Shader* const programShaders[PROGRAM_COUNT] =
+    {
+        m_shader,
+        m_shadowShader,
+        m_shadowDebugShader,
+        m_gbufferShader,
+        m_deferredLightShader,
+        m_compositeShader,
+        m_depthPrepassShader,
+        m_shadowCascadesShader,
+        m_evsmConvertShader,
+        m_evsmBlurShader,
+        m_atlasClearShader,
+        m_instancedShader,
+        m_instancedPrepassShader,
+        m_instancedShadowShader,
+        m_debugTextShader
+    };
+
     m_mesh = new Mesh();
     m_planeMesh = new Mesh();
 
     m_cbPerObject = new ConstantBuffer();
     m_cbLight = new ConstantBuffer();
     m_cbShadow = new ConstantBuffer();
+    m_cbDeferred = new ConstantBuffer();
+    m_cbEvsm = new ConstantBuffer();
+    m_gbuffer = new GBuffer();
 
 
     // -----------------------------
@@ -127,45 +267,300 @@ bool Renderer::CreateResources()
         { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0 }
     };
 
+    // Depth prepass: fetches only the position out of the full vertex
+    D3D11_INPUT_ELEMENT_DESC positionLayoutDesc[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+    };
+
+    // Indirect draws: the object index per instance from the culling output in slot 1
+    D3D11_INPUT_ELEMENT_DESC instancedLayoutDesc[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "INSTANCE", 0, DXGI_FORMAT_R32_UINT, GpuCuller::INSTANCE_SLOT, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+    };
+
+    D3D11_INPUT_ELEMENT_DESC instancedPositionLayoutDesc[] =
+    {
+        { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "INSTANCE", 0, DXGI_FORMAT_R32_UINT, GpuCuller::INSTANCE_SLOT, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+    };
+
     D3D11_INPUT_ELEMENT_DESC shadowDebugLayoutDesc[] =
     {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
         { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 }
     };
 
-    if (!m_shader->LoadFromFiles(
-        device,
-        L"SimpleVS.hlsl",
-        L"SimplePS.hlsl",
-        layoutDesc,
-        ARRAYSIZE(layoutDesc)))
+    const struct { const D3D11_INPUT_ELEMENT_DESC* desc; UINT count; } inputLayouts[LAYOUT_COUNT] =
+    {
+        { layoutDesc, ARRAYSIZE(layoutDesc) },
+        { positionLayoutDesc, ARRAYSIZE(positionLayoutDesc) },
+        { instancedLayoutDesc, ARRAYSIZE(instancedLayoutDesc) },
+        { instancedPositionLayoutDesc, ARRAYSIZE(instancedPositionLayoutDesc) },
+        { shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc) }
+    };
+
+    // -----------------------------
+    // Shaders: one batch through the bytecode cache, misses compile in parallel
+    // -----------------------------
+    ShaderCompileRequest stageRequests[PROGRAM_COUNT * 2];
+    for (uint32_t p = 0; p < PROGRAM_COUNT; ++p)
+    {
+        ShaderCompileRequest& vs = stageRequests[VertexStage((StartupProgram)p)];
+        vs.path = STARTUP_PROGRAMS[p].vs;
+        vs.target = "vs_5_0";
+        vs.flags = D3DShaderCompiler::GetDefaultFlags();
+
+        ShaderCompileRequest& ps = stageRequests[PixelStage((StartupProgram)p)];
+        ps.path = STARTUP_PROGRAMS[p].ps;
+        ps.target = "ps_5_0";
+        ps.flags = D3DShaderCompiler::GetDefaultFlags();
+    }
+    auto vsRequest = [&stageRequests](StartupProgram p) -> ShaderCompileRequest& { return stageRequests[VertexStage(p)]; };
+    auto psRequest = [&stageRequests](StartupProgram p) -> ShaderCompileRequest& { return stageRequests[PixelStage(p)]; };
+
+    // Single-pass cascades pick the array slice in the VS where the hardware
+    // allows it (D3D11.3), through a pass-through GS everywhere else
+    D3D11_FEATURE_DATA_D3D11_OPTIONS3 options3 = {};
+    bool sliceFromVS = SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS3, &options3, sizeof(options3))) &&
+        options3.VPAndRTArrayIndexFromAnyShaderFeedingRasterizer;
+    vsRequest(PROGRAM_SHADOW_CASCADES).defines.push_back({ "RT_INDEX_FROM_VS", sliceFromVS ? "1" : "0" });
+
+    ShaderCompileRequest shadowCascadesGS;
+    shadowCascadesGS.path = L"ShadowCascadesGS.hlsl";
+    shadowCascadesGS.target = "gs_5_0";
+    shadowCascadesGS.flags = D3DShaderCompiler::GetDefaultFlags();
+
+    std::vector<ShaderCompileResult> stages;
+    m_shaderCache->CompileAll(stageRequests, ARRAYSIZE(stageRequests), stages);
+    auto vs = [&stages](StartupProgram p) -> const ShaderCompileResult& { return stages[VertexStage(p)]; };
+    auto ps = [&stages](StartupProgram p) -> const ShaderCompileResult& { return stages[PixelStage(p)]; };
+    auto compiled = [&](StartupProgram p) { return vs(p).success && ps(p).success; };
+    for (const ShaderCompileResult& stage : stages)
+    {
+        if (!stage.errors.empty())
+            OutputDebugStringA(stage.errors.c_str());
+    }
+
+    {
+        ShaderCacheStats shaderStats = m_shaderCache->GetStats();
+        char msg[128];
+        sprintf_s(msg, "Shaders: %u cached, %u compiled, %u failed in %.1f ms\n",
+            shaderStats.hits, shaderStats.compiled, shaderStats.failed, shaderStats.lastBatchMs);
+        OutputDebugStringA(msg);
+    }
+
+    if (!compiled(PROGRAM_SIMPLE) ||
+        !m_shader->Create(device, vs(PROGRAM_SIMPLE), ps(PROGRAM_SIMPLE), layoutDesc, ARRAYSIZE(layoutDesc)))
     {
         MessageBox(nullptr, L"Failed to load shaders", L"Error", MB_OK);
         return false;
     }
 
-    if(!m_shadowShader->LoadFromFiles(
-        device,
-        L"ShadowVS.hlsl",
-        L"ShadowPS.hlsl",
-        layoutDesc,
-        ARRAYSIZE(layoutDesc)))
+    if (!compiled(PROGRAM_SHADOW) ||
+        !m_shadowShader->Create(device, vs(PROGRAM_SHADOW), ps(PROGRAM_SHADOW), layoutDesc, ARRAYSIZE(layoutDesc)))
     {
         MessageBox(nullptr, L"Failed to load shadow shaders", L"Error", MB_OK);
         return false;
     }
 
-    if(!m_shadowDebugShader->LoadFromFiles(
-        device,
-        L"ShadowDebugVS.hlsl",
-        L"ShadowDebugPS.hlsl",
-        shadowDebugLayoutDesc,
-		ARRAYSIZE(shadowDebugLayoutDesc)))
+    if (!compiled(PROGRAM_SHADOW_DEBUG) ||
+        !m_shadowDebugShader->Create(device, vs(PROGRAM_SHADOW_DEBUG), ps(PROGRAM_SHADOW_DEBUG), shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc)))
     {
         MessageBox(nullptr, L"Failed to load shadow debug shaders", L"Error", MB_OK);
         return false;
     }
 
+    if (!compiled(PROGRAM_GBUFFER) ||
+        !m_gbufferShader->Create(device, vs(PROGRAM_GBUFFER), ps(PROGRAM_GBUFFER), layoutDesc, ARRAYSIZE(layoutDesc)) ||
+        !compiled(PROGRAM_DEFERRED_LIGHT) ||
+        !m_deferredLightShader->Create(device, vs(PROGRAM_DEFERRED_LIGHT), ps(PROGRAM_DEFERRED_LIGHT), shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc)) ||
+        !compiled(PROGRAM_DEFERRED_COMPOSITE) ||
+        !m_compositeShader->Create(device, vs(PROGRAM_DEFERRED_COMPOSITE), ps(PROGRAM_DEFERRED_COMPOSITE), shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc)))
+    {
+        MessageBox(nullptr, L"Failed to load deferred shaders", L"Error", MB_OK);
+        return false;
+    }
+
+    // Single-pass cascades fall back to the per-cascade loop when they fail
+    m_shadowCascadesReady = compiled(PROGRAM_SHADOW_CASCADES) &&
+        m_shadowCascadesShader->Create(device, vs(PROGRAM_SHADOW_CASCADES), ps(PROGRAM_SHADOW_CASCADES), layoutDesc, ARRAYSIZE(layoutDesc));
+    if (m_shadowCascadesReady && !sliceFromVS)
+    {
+        ShaderCompileResult gs;
+        m_shaderCache->Compile(shadowCascadesGS, gs);
+        if (!gs.errors.empty())
+            OutputDebugStringA(gs.errors.c_str());
+        m_shadowCascadesReady = gs.success && m_shadowCascadesShader->CreateGeometryShader(device, gs);
+    }
+    if (!m_shadowCascadesReady)
+    {
+        OutputDebugStringA("Single-pass shadow cascades unavailable, rendering them one by one\n");
+        m_shadowCascadesShader->Release();
+    }
+
+    // The EVSM tier falls back to gather PCF without its prefilter
+    bool evsmReady = compiled(PROGRAM_EVSM_CONVERT) &&
+        m_evsmConvertShader->Create(device, vs(PROGRAM_EVSM_CONVERT), ps(PROGRAM_EVSM_CONVERT), shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc)) &&
+        compiled(PROGRAM_EVSM_BLUR) &&
+        m_evsmBlurShader->Create(device, vs(PROGRAM_EVSM_BLUR), ps(PROGRAM_EVSM_BLUR), shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc));
+    if (!evsmReady)
+    {
+        OutputDebugStringA("EVSM prefilter shaders unavailable, shadow quality EVSM uses soft shadows\n");
+        m_evsmConvertShader->Release();
+        m_evsmBlurShader->Release();
+    }
+
+    // GPU-driven path: the instanced programs and the cull kernel. Without
+    // either, objects are culled and drawn one by one on the CPU
+    m_gpuDrivenReady = compiled(PROGRAM_INSTANCED) &&
+        m_instancedShader->Create(device, vs(PROGRAM_INSTANCED), ps(PROGRAM_INSTANCED), instancedLayoutDesc, ARRAYSIZE(instancedLayoutDesc)) &&
+        compiled(PROGRAM_INSTANCED_PREPASS) &&
+        m_instancedPrepassShader->Create(device, vs(PROGRAM_INSTANCED_PREPASS), ps(PROGRAM_INSTANCED_PREPASS), instancedPositionLayoutDesc, ARRAYSIZE(instancedPositionLayoutDesc)) &&
+        compiled(PROGRAM_INSTANCED_SHADOW) &&
+        m_instancedShadowShader->Create(device, vs(PROGRAM_INSTANCED_SHADOW), ps(PROGRAM_INSTANCED_SHADOW), instancedPositionLayoutDesc, ARRAYSIZE(instancedPositionLayoutDesc));
+    if (m_gpuDrivenReady)
+    {
+        ShaderCompileRequest cullCS;
+        cullCS.path = L"CullCS.hlsl";
+        cullCS.target = "cs_5_0";
+        cullCS.flags = D3DShaderCompiler::GetDefaultFlags();
+
+        ShaderCompileResult cs;
+        m_shaderCache->Compile(cullCS, cs);
+        if (!cs.errors.empty())
+            OutputDebugStringA(cs.errors.c_str());
+
+        m_gpuCuller = new GpuCuller(device);
+        if (!m_gpuCuller->Create(cs))
+        {
+            delete m_gpuCuller;
+            m_gpuCuller = nullptr;
+            m_gpuDrivenReady = false;
+        }
+    }
+    if (m_gpuDrivenReady)
+    {
+        // Hi-Z of the early phase's depth. Without it the late phase culls by frustum only
+        ShaderCompileRequest hiZCS;
+        hiZCS.path = L"HiZBuildCS.hlsl";
+        hiZCS.target = "cs_5_0";
+        hiZCS.flags = D3DShaderCompiler::GetDefaultFlags();
+
+        ShaderCompileResult cs;
+        m_shaderCache->Compile(hiZCS, cs);
+        if (!cs.errors.empty())
+            OutputDebugStringA(cs.errors.c_str());
+
+        m_hiZPyramid = new GpuHiZPyramid();
+        if (!m_hiZPyramid->Create(device, cs))
+        {
+            OutputDebugStringA("Hi-Z pyramid unavailable, GPU-driven culling is frustum only\n");
+            delete m_hiZPyramid;
+            m_hiZPyramid = nullptr;
+        }
+    }
+    if (!m_gpuDrivenReady)
+    {
+        OutputDebugStringA("GPU-driven culling unavailable, drawing objects one by one\n");
+        m_instancedShader->Release();
+        m_instancedPrepassShader->Release();
+        m_instancedShadowShader->Release();
+    }
+
+    // SDSM reduction. Without it the splits stay fixed
+    {
+        ShaderCompileRequest depthReductionCS;
+        depthReductionCS.path = L"DepthReductionCS.hlsl";
+        depthReductionCS.target = "cs_5_0";
+        depthReductionCS.flags = D3DShaderCompiler::GetDefaultFlags();
+
+        ShaderCompileResult cs;
+        m_shaderCache->Compile(depthReductionCS, cs);
+        if (!cs.errors.empty())
+            OutputDebugStringA(cs.errors.c_str());
+
+        m_depthReduction = new GpuDepthReduction();
+        if (!m_depthReduction->Create(device, cs))
+        {
+            OutputDebugStringA("SDSM depth reduction unavailable, using fixed cascade splits\n");
+            delete m_depthReduction;
+            m_depthReduction = nullptr;
+        }
+    }
+
+    // The pixel shader is never bound (depth-only pipeline)
+    if (!compiled(PROGRAM_DEPTH_PREPASS) ||
+        !m_depthPrepassShader->Create(device, vs(PROGRAM_DEPTH_PREPASS), ps(PROGRAM_DEPTH_PREPASS), positionLayoutDesc, ARRAYSIZE(positionLayoutDesc)))
+    {
+        MessageBox(nullptr, L"Failed to load depth prepass shaders", L"Error", MB_OK);
+        return false;
+    }
+
+    // Depth-only as well: the fullscreen quad at the far plane resets one atlas tile
+    if (!compiled(PROGRAM_ATLAS_CLEAR) ||
+        !m_atlasClearShader->Create(device, vs(PROGRAM_ATLAS_CLEAR), ps(PROGRAM_ATLAS_CLEAR), shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc)))
+    {
+        MessageBox(nullptr, L"Failed to load shadow atlas shaders", L"Error", MB_OK);
+        return false;
+    }
+
+    // Stats overlay text; the counters and their dumps work without it
+    bool debugTextReady = compiled(PROGRAM_DEBUG_TEXT) &&
+        m_debugTextShader->Create(device, vs(PROGRAM_DEBUG_TEXT), ps(PROGRAM_DEBUG_TEXT), shadowDebugLayoutDesc, ARRAYSIZE(shadowDebugLayoutDesc));
+    if (!debugTextReady)
+    {
+        OutputDebugStringA("Debug text shaders unavailable, no stats overlay\n");
+        m_debugTextShader->Release();
+    }
+
+    // A drifted cbuffer fails here instead of rendering garbage
+    {
+        std::string layoutErrors;
+        bool layoutsValid = true;
+        for (uint32_t p = 0; p < PROGRAM_COUNT; ++p)
+        {
+            layoutsValid &= programShaders[p]->GetBindings().Validate(CONSTANT_BUFFER_LAYOUTS, ARRAYSIZE(CONSTANT_BUFFER_LAYOUTS),
+                STARTUP_PROGRAMS[p].name, layoutErrors);
+        }
+        if (!layoutsValid)
+        {
+            OutputDebugStringA(layoutErrors.c_str());
+            MessageBoxA(nullptr, layoutErrors.c_str(), "Constant buffer layout mismatch", MB_OK);
+            return false;
+        }
+    }
+
+    // -----------------------------
+    // Hot reload: each program rebuilds when one of its sources or includes changes
+    // -----------------------------
+    m_hotReloader = new HotReloader();
+
+    // Optional programs that did not come up are not watched
+    bool programReloads[PROGRAM_COUNT];
+    for (uint32_t p = 0; p < PROGRAM_COUNT; ++p)
+        programReloads[p] = true;
+    programReloads[PROGRAM_EVSM_CONVERT] = programReloads[PROGRAM_EVSM_BLUR] = evsmReady;
+    programReloads[PROGRAM_INSTANCED] = programReloads[PROGRAM_INSTANCED_PREPASS] =
+        programReloads[PROGRAM_INSTANCED_SHADOW] = m_gpuDrivenReady;
+    programReloads[PROGRAM_DEBUG_TEXT] = debugTextReady;
+
+    for (uint32_t p = 0; p < PROGRAM_COUNT; ++p)
+    {
+        if (!programReloads[p])
+            continue;
+
+        StartupProgram program = (StartupProgram)p;
+        const ShaderCompileRequest* gs = program == PROGRAM_SHADOW_CASCADES && !sliceFromVS ? &shadowCascadesGS : nullptr;
+        m_hotReloader->Register(new ShaderProgramReloadable(device, m_shaderCache, STARTUP_PROGRAMS[p].name,
+            vsRequest(program), psRequest(program),
+            inputLayouts[STARTUP_PROGRAMS[p].layout].desc, inputLayouts[STARTUP_PROGRAMS[p].layout].count,
+            CONSTANT_BUFFER_LAYOUTS, ARRAYSIZE(CONSTANT_BUFFER_LAYOUTS), programShaders[p], gs));
+    }
+
     if (!m_mesh->CreateCube(device))
     {
         MessageBox(nullptr, L"Failed to create cube", L"Error", MB_OK);
@@ -219,54 +614,113 @@ bool Renderer::CreateResources()
     if (!m_cbShadow->Create(device, sizeof(CBShadow)))
         return false;
 
+    if (!m_cbDeferred->Create(device, sizeof(CBDeferred)))
+        return false;
+
+    if (!m_cbEvsm->Create(device, sizeof(CBEvsm)))
+        return false;
+
     // -----------------------------
     // Textures (MOVED UP - LOAD BEFORE CREATING OBJECTS)
+    // Decoded on worker threads and streamed in, objects draw with
+    // the default texture until their low mips are resident
     // -----------------------------
-    if (FAILED(CreateWICTextureFromFile(
-        device,
-        context,
-        L"Assets/textures/Brick.png",
-        nullptr,
-        &m_brickTexture)))
-    {
-        MessageBox(nullptr, L"Failed to load brick texture", L"Error", MB_OK);
-        return false;
-    }
-
-    if (FAILED(CreateWICTextureFromFile(
-        device,
-        context,
-        L"Assets/textures/Ground.png",
-        nullptr,
-        &m_groundTexture)))
     {
-        MessageBox(nullptr, L"Failed to load ground texture", L"Error", MB_OK);
-        return false;
+        const uint32_t white = 0xFFFFFFFF;
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = 1;
+        desc.Height = 1;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        D3D11_SUBRESOURCE_DATA init = {};
+        init.pSysMem = &white;
+        init.SysMemPitch = sizeof(white);
+
+        ID3D11Texture2D* tex = nullptr;
+        if (FAILED(device->CreateTexture2D(&desc, &init, &tex)) ||
+            FAILED(device->CreateShaderResourceView(tex, nullptr, &m_defaultTexture)))
+        {
+            if (tex) tex->Release();
+            MessageBox(nullptr, L"Failed to create default texture", L"Error", MB_OK);
+            return false;
+        }
+        tex->Release();
     }
 
+    m_textureDecoder = new WicTextureDecoder();
+    m_textureUploader = new D3D11TextureUploader(device, m_deviceResources->GetDeviceContext());
+    m_textureStreamer = new TextureStreamer(m_textureDecoder, m_textureUploader);
+
+    m_brickCookedTexture = LoadCookedTexture(device, L"Assets/textures/Brick.dds");
+    m_groundCookedTexture = LoadCookedTexture(device, L"Assets/textures/Ground.dds");
+
+    if (!m_brickCookedTexture)
+        m_brickTexture = m_textureStreamer->Request(L"Assets/textures/Brick.png");
+    if (!m_groundCookedTexture)
+        m_groundTexture = m_textureStreamer->Request(L"Assets/textures/Ground.png");
+
+    // A re-cooked .dds replaces the view every object holds; streamed sources go through the streamer
+    auto repointObjects = [this](ID3D11ShaderResourceView* previous, ID3D11ShaderResourceView* current)
+        {
+            for (RenderObject* obj : m_renderObjects)
+            {
+                if (obj->GetTexture() == previous)
+                    obj->SetTexture(current);
+            }
+        };
+
+    if (m_brickCookedTexture)
+        m_hotReloader->Register(new CookedTextureReloadable(device, L"Assets/textures/Brick.dds", &m_brickCookedTexture, repointObjects));
+    else
+        m_hotReloader->Register(new StreamedTextureReloadable(m_textureStreamer, m_brickTexture));
+
+    if (m_groundCookedTexture)
+        m_hotReloader->Register(new CookedTextureReloadable(device, L"Assets/textures/Ground.dds", &m_groundCookedTexture, repointObjects));
+    else
+        m_hotReloader->Register(new StreamedTextureReloadable(m_textureStreamer, m_groundTexture));
+
     // -----------------------------
     // Render Objects 
     // -----------------------------
     {
         RenderObject* cube1 = new RenderObject(m_mesh);
         cube1->GetTransform().SetPosition(XMFLOAT3(0.0f, 0.0f, 0.0f));
-        cube1->SetTexture(m_brickTexture); 
+        cube1->SetTexture(m_brickCookedTexture);
+        cube1->SetTextureHandle(m_brickTexture); 
+        cube1->SetDynamic(true);
         m_renderObjects.push_back(cube1);
 
         RenderObject* cube2 = new RenderObject(m_mesh);
         cube2->GetTransform().SetPosition(XMFLOAT3(3.0f, 2.0f, 0.0f));
-        cube2->SetTexture(m_brickTexture);  
+        cube2->SetTexture(m_brickCookedTexture);
+        cube2->SetTextureHandle(m_brickTexture);  
+        cube2->SetDynamic(true);
         m_renderObjects.push_back(cube2);
 
         RenderObject* ground = new RenderObject(m_planeMesh);
         ground->GetTransform().SetPosition({ 1, -1.6f, 0 });
-        ground->SetTexture(m_groundTexture); 
+        ground->SetTexture(m_groundCookedTexture);
+        ground->SetTextureHandle(m_groundTexture); 
         m_renderObjects.push_back(ground);
     }
 
+    // Optional imported scene
+    if (filesystem::exists(L"Assets/models/Scene.glb"))
+        LoadScene(L"Assets/models/Scene.glb");
+    else if (filesystem::exists(L"Assets/models/Scene.gltf"))
+        LoadScene(L"Assets/models/Scene.gltf");
+
     // -----------------------------
-    // Sampler
+    // Render states and pipelines: equal descriptors share one object
     // -----------------------------
+    m_stateCache = new RenderStateCache(device);
+
     D3D11_SAMPLER_DESC samp = {};
     samp.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
     samp.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -274,43 +728,112 @@ bool Renderer::CreateResources()
     samp.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
     samp.MaxLOD = D3D11_FLOAT32_MAX;
 
-    if (FAILED(device->CreateSamplerState(&samp, &m_samplerState)))
+    m_samplerState = m_stateCache->GetSamplerState(samp);
+    if (!m_samplerState)
         return false;
 
-    // -----------------------------
-    // Rasterizer State
-    // -----------------------------
+    PipelineStateDesc mainDesc;
+    mainDesc.shader = m_shader;
+    mainDesc.rasterizer.CullMode = D3D11_CULL_BACK;
+    mainDesc.depthStencil.DepthFunc = D3D11_COMPARISON_LESS;
+    m_mainPipeline = m_stateCache->GetPipeline(mainDesc);
+
+    // After the depth prepass every visible fragment matches the stored depth exactly
+    PipelineStateDesc mainEqualDesc = mainDesc;
+    mainEqualDesc.depthStencil.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+    mainEqualDesc.depthStencil.DepthFunc = D3D11_COMPARISON_EQUAL;
+    m_mainEqualPipeline = m_stateCache->GetPipeline(mainEqualDesc);
+
+    PipelineStateDesc depthPrepassDesc;
+    depthPrepassDesc.shader = m_depthPrepassShader;
+    depthPrepassDesc.depthOnly = true;
+    depthPrepassDesc.rasterizer.CullMode = D3D11_CULL_BACK;
+    depthPrepassDesc.depthStencil.DepthFunc = D3D11_COMPARISON_LESS;
+    m_depthPrepassPipeline = m_stateCache->GetPipeline(depthPrepassDesc);
+
+    // Front faces culled and biased against acne, no pixel shader
+    PipelineStateDesc shadowDesc;
+    shadowDesc.shader = m_shadowShader;
+    shadowDesc.depthOnly = true;
+    shadowDesc.rasterizer.CullMode = D3D11_CULL_FRONT;
+    shadowDesc.rasterizer.DepthBias = 500;
+    shadowDesc.rasterizer.DepthBiasClamp = 0.0f;
+    shadowDesc.rasterizer.SlopeScaledDepthBias = 0.5f;
+    m_shadowPipeline = m_stateCache->GetPipeline(shadowDesc);
+
+    PipelineStateDesc shadowCascadesDesc = shadowDesc;
+    shadowCascadesDesc.shader = m_shadowCascadesShader;
+    m_shadowCascadesPipeline = m_stateCache->GetPipeline(shadowCascadesDesc);
+
+    PipelineStateDesc shadowDebugDesc;
+    shadowDebugDesc.shader = m_shadowDebugShader;
+    shadowDebugDesc.depthStencil.DepthEnable = FALSE;
+    shadowDebugDesc.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+    m_shadowDebugPipeline = m_stateCache->GetPipeline(shadowDebugDesc);
+
+    if (debugTextReady)
+    {
+        PipelineStateDesc debugTextDesc = shadowDebugDesc;
+        debugTextDesc.shader = m_debugTextShader;
+        m_debugTextPipeline = m_stateCache->GetPipeline(debugTextDesc);
+    }
 
-    CD3D11_RASTERIZER_DESC shadowRast = {};
-	shadowRast.FillMode = D3D11_FILL_SOLID;
-	shadowRast.CullMode = D3D11_CULL_FRONT;
-    shadowRast.DepthBias = 500;
-	shadowRast.DepthBiasClamp = 0.0f;
-	shadowRast.SlopeScaledDepthBias = 0.5f;
-	shadowRast.DepthClipEnable = TRUE;
+    PipelineStateDesc gbufferDesc;
+    gbufferDesc.shader = m_gbufferShader;
+    gbufferDesc.rasterizer.CullMode = D3D11_CULL_BACK;
+    gbufferDesc.depthStencil.DepthFunc = D3D11_COMPARISON_LESS;
+    m_gbufferPipeline = m_stateCache->GetPipeline(gbufferDesc);
+
+    // Fullscreen quad at the far plane: GREATER passes only where geometry was drawn
+    PipelineStateDesc deferredLightDesc;
+    deferredLightDesc.shader = m_deferredLightShader;
+    deferredLightDesc.rasterizer.CullMode = D3D11_CULL_NONE;
+    deferredLightDesc.depthStencil.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+    deferredLightDesc.depthStencil.DepthFunc = D3D11_COMPARISON_GREATER;
+    deferredLightDesc.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+    m_deferredLightPipeline = m_stateCache->GetPipeline(deferredLightDesc);
+
+    PipelineStateDesc compositeDesc;
+    compositeDesc.shader = m_compositeShader;
+    compositeDesc.rasterizer.CullMode = D3D11_CULL_NONE;
+    compositeDesc.depthStencil.DepthEnable = FALSE;
+    compositeDesc.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+    m_compositePipeline = m_stateCache->GetPipeline(compositeDesc);
+
+    // The same states with the instanced programs
+    if (m_gpuDrivenReady)
+    {
+        PipelineStateDesc instancedDesc = mainDesc;
+        instancedDesc.shader = m_instancedShader;
+        m_instancedPipeline = m_stateCache->GetPipeline(instancedDesc);
 
-    if (FAILED(device->CreateRasterizerState(&shadowRast, &m_shadowRasterizerState)))
-		return false;
+        instancedDesc = mainEqualDesc;
+        instancedDesc.shader = m_instancedShader;
+        m_instancedEqualPipeline = m_stateCache->GetPipeline(instancedDesc);
 
-    D3D11_RASTERIZER_DESC rastDesc = {};
-    rastDesc.FillMode = D3D11_FILL_SOLID;
-    rastDesc.CullMode = D3D11_CULL_BACK;
-    rastDesc.DepthClipEnable = TRUE;
+        instancedDesc = depthPrepassDesc;
+        instancedDesc.shader = m_instancedPrepassShader;
+        m_instancedPrepassPipeline = m_stateCache->GetPipeline(instancedDesc);
 
-    if (FAILED(device->CreateRasterizerState(&rastDesc, &m_rasterizerState)))
-        return false;
+        instancedDesc = shadowDesc;
+        instancedDesc.shader = m_instancedShadowShader;
+        m_instancedShadowPipeline = m_stateCache->GetPipeline(instancedDesc);
 
-    // -----------------------------
-    // Depth Stencil State
-    // -----------------------------
-    D3D11_DEPTH_STENCIL_DESC depthDesc = {};
-    depthDesc.DepthEnable = TRUE;
-    depthDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
-    depthDesc.DepthFunc = D3D11_COMPARISON_LESS;
+        m_gpuDrivenReady = m_instancedPipeline && m_instancedEqualPipeline && m_instancedPrepassPipeline &&
+            m_instancedShadowPipeline;
+    }
 
-    if (FAILED(device->CreateDepthStencilState(&depthDesc, &m_depthStencilState)))
+    if (!m_mainPipeline || !m_shadowPipeline || !m_shadowDebugPipeline ||
+        !m_gbufferPipeline || !m_deferredLightPipeline || !m_compositePipeline ||
+        !m_mainEqualPipeline || !m_depthPrepassPipeline)
         return false;
 
+    m_mainPassStatistics = new GpuPassStatistics(device);
+    m_gpuProfiler = new GpuProfiler(device);
+    for (RenderPassId pass : { RENDER_PASS_SHADOW, RENDER_PASS_SHADOW_ATLAS, RENDER_PASS_DEFERRED, RENDER_PASS_DEBUG })
+        m_passStatistics[pass] = new GpuPassStatistics(device);
+    m_statsText = new DebugTextTexture(device);
+
     // -----------------------------
     // Shadow map
     // -----------------------------
@@ -381,6 +904,32 @@ bool Renderer::CreateResources()
         return false;
     }
 
+    // STEP 5: Static caster cache, same layout so slices copy straight across
+    D3D11_TEXTURE2D_DESC cacheDesc = texDesc;
+    cacheDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+
+    if (FAILED(device->CreateTexture2D(&cacheDesc, nullptr, &m_shadowCacheArray)) ||
+        FAILED(device->CreateDepthStencilView(m_shadowCacheArray, &dsvDesc, &m_shadowCacheDSVArray)))
+    {
+        MessageBox(nullptr, L"Failed to create shadow cache array", L"Error", MB_OK);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    {
+        D3D11_DEPTH_STENCIL_VIEW_DESC desc = dsvDesc;
+        desc.Texture2DArray.FirstArraySlice = i;
+        desc.Texture2DArray.ArraySize = 1;
+
+        if (FAILED(device->CreateDepthStencilView(m_shadowCacheArray, &desc, &m_shadowCacheDSVs[i])))
+        {
+            MessageBox(nullptr, L"Failed to create shadow cache DSV", L"Error", MB_OK);
+            return false;
+        }
+    }
+
+    m_shadowCache = new ShadowCacheScheduler(NUM_CASCADES, m_shadowCacheConfig);
+
 	// Sampler for shadow map
     D3D11_SAMPLER_DESC shadowSamp = {};
     shadowSamp.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
@@ -395,9 +944,66 @@ bool Renderer::CreateResources()
     shadowSamp.MinLOD = 0;           
     shadowSamp.MaxLOD = D3D11_FLOAT32_MAX;  
 
-    if(FAILED(device->CreateSamplerState(&shadowSamp, &m_shadowMapSampler)))
+    m_shadowMapSampler = m_stateCache->GetSamplerState(shadowSamp);
+    if (!m_shadowMapSampler)
 		return false;
 
+    // Software occlusion buffer, AVX2 when the CPU has it
+    m_occlusion = new OcclusionBuffer(m_occlusionSettings);
+
+    // STEP 6: Local light shadow atlas
+    m_shadowAtlas = new ShadowAtlas(m_shadowAtlasSettings);
+    m_shadowAtlasMaps = new ShadowAtlasMaps(device);
+    if (!m_shadowAtlasMaps->Create(m_shadowAtlasSettings.atlasSize))
+    {
+        MessageBox(nullptr, L"Failed to create shadow atlas", L"Error", MB_OK);
+        return false;
+    }
+
+    PipelineStateDesc atlasClearDesc;
+    atlasClearDesc.shader = m_atlasClearShader;
+    atlasClearDesc.depthOnly = true;
+    atlasClearDesc.rasterizer.CullMode = D3D11_CULL_NONE;
+    atlasClearDesc.depthStencil.DepthFunc = D3D11_COMPARISON_ALWAYS;
+    atlasClearDesc.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+    m_atlasClearPipeline = m_stateCache->GetPipeline(atlasClearDesc);
+    if (!m_atlasClearPipeline)
+        return false;
+
+    // STEP 7: EVSM moments at half resolution: RGBA32F is 16 bytes a texel, and
+    // the blur and mips soften the edges more than the lost resolution would
+    if (evsmReady)
+    {
+        PipelineStateDesc evsmDesc;
+        evsmDesc.shader = m_evsmConvertShader;
+        evsmDesc.rasterizer.CullMode = D3D11_CULL_NONE;
+        evsmDesc.depthStencil.DepthEnable = FALSE;
+        evsmDesc.topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+        m_evsmConvertPipeline = m_stateCache->GetPipeline(evsmDesc);
+
+        evsmDesc.shader = m_evsmBlurShader;
+        m_evsmBlurPipeline = m_stateCache->GetPipeline(evsmDesc);
+
+        D3D11_SAMPLER_DESC momentSamp = {};
+        momentSamp.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        momentSamp.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        momentSamp.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        momentSamp.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        momentSamp.MaxLOD = D3D11_FLOAT32_MAX;
+        m_momentSampler = m_stateCache->GetSamplerState(momentSamp);
+
+        m_shadowMoments = new ShadowMomentMaps();
+        if (!m_evsmConvertPipeline || !m_evsmBlurPipeline || !m_momentSampler ||
+            !m_shadowMoments->Create(device, SHADOW_MAP_SIZE / 2, NUM_CASCADES))
+        {
+            OutputDebugStringA("Failed to create EVSM moment maps, shadow quality EVSM uses soft shadows\n");
+            delete m_shadowMoments;
+            m_shadowMoments = nullptr;
+        }
+    }
+
+    OutputDebugStringA(m_stateCache->GetSummary().c_str());
+
 
 	// -----------------------------
 	// Lights
@@ -435,169 +1041,1518 @@ bool Renderer::CreateResources()
     m_lights.push_back(lamp2);
 	m_lights.push_back(lamp3);*/
 
+    m_lightClusters = new LightClusterGrid();
+    m_lightClusterBuffers = new ClusteredLightBuffers(device);
+    CreateClusteredLights();
+
+    // Needs the lights: the startup variants are prewarmed for this setup
+    CreateForwardVariants(device);
+    CreateDeferredVariants(device);
+
     return true;
 }
 
-void Renderer::Render()
+// Added first and in the same order everywhere, so GetLightingKey() is valid
+// in the forward space and the deferred light space alike
+void Renderer::AddLightingFeatures(ShaderPermutationSpace& space)
 {
-    if (Input::IsKeyPressed(VK_F1))
-        ToggleShadowDebug();
-   
-    // Update camera FIRST so both shadow pass and main pass use consistent matrices
-    float dt = 0.016f; // temporary
-    m_camera.Update(dt);
+    m_featureShadowQuality = space.AddFeature("SHADOW_QUALITY", 5);
+    m_featureLightMix = space.AddFeature("LIGHT_MIX", 3);
+    m_featureClusteredLights = space.AddFeature("CLUSTERED_LIGHTS", 2);
 
-    // Compute cascade splits BEFORE shadow pass
-    ComputeCascadeSplits();
+    // Only directional lights sample the cascades
+    space.AddCollapseRule(m_featureLightMix, LIGHT_MIX_POINT, m_featureShadowQuality, SHADOW_QUALITY_OFF);
+}
 
-    ShadowPass();
+void Renderer::CreateForwardVariants(ID3D11Device* device)
+{
+    ShaderPermutationSpace space;
+    AddLightingFeatures(space);
+    m_featureNormalMap = space.AddFeature("NORMAL_MAP", 2);
+    m_featureAlphaTest = space.AddFeature("ALPHA_TEST", 2);
+
+    ShaderCompileRequest base;
+    base.path = L"SimplePS.hlsl";
+    base.target = "ps_5_0";
+    base.flags = D3DShaderCompiler::GetDefaultFlags();
+    m_forwardVariants = new PixelShaderVariants(device, m_shaderCache, space, base);
+
+    // Everything else compiles on first use (usually a cache hit)
+    ShaderVariantKey passKey = GetLightingKey();
+    m_forwardVariants->Prewarm({ passKey, space.Set(passKey, m_featureAlphaTest, 1) });
+
+    // An edit recompiles only the variants used so far, other variants compile from the new source on first use
+    m_hotReloader->Register(new PixelShaderVariantsReloadable(m_forwardVariants, "Forward variants"));
+
+    std::vector<ShaderVariantKey> variants;
+    space.EnumerateVariants(variants);
+    char msg[128];
+    sprintf_s(msg, "Forward shader: %zu variants after pruning (%llu combinations)\n",
+        variants.size(), (unsigned long long)space.GetCombinationCount());
+    OutputDebugStringA(msg);
+}
 
-    if (m_showShadowDebug)
-    {
-        RenderShadowDebug();
-    }
-    else
+void Renderer::CreateDeferredVariants(ID3D11Device* device)
+{
+    // G-buffer: material features only, lighting happens later
+    ShaderPermutationSpace gbufferSpace;
+    m_gbufferFeatureNormalMap = gbufferSpace.AddFeature("NORMAL_MAP", 2);
+    m_gbufferFeatureAlphaTest = gbufferSpace.AddFeature("ALPHA_TEST", 2);
+
+    ShaderCompileRequest base;
+    base.path = L"GBufferPS.hlsl";
+    base.target = "ps_5_0";
+    base.flags = D3DShaderCompiler::GetDefaultFlags();
+    m_gbufferVariants = new PixelShaderVariants(device, m_shaderCache, gbufferSpace, base);
+    m_gbufferVariants->Prewarm({ 0, gbufferSpace.Set(0, m_gbufferFeatureAlphaTest, 1) });
+    m_hotReloader->Register(new PixelShaderVariantsReloadable(m_gbufferVariants, "G-buffer variants"));
+
+    // Light pass: lighting features only, one variant per frame
+    ShaderPermutationSpace lightSpace;
+    AddLightingFeatures(lightSpace);
+
+    base.path = L"DeferredLightPS.hlsl";
+    m_deferredLightVariants = new PixelShaderVariants(device, m_shaderCache, lightSpace, base);
+    m_deferredLightVariants->Prewarm({ GetLightingKey() });
+    m_hotReloader->Register(new PixelShaderVariantsReloadable(m_deferredLightVariants, "Deferred light variants"));
+}
+
+ShaderVariantKey Renderer::GetLightingKey() const
+{
+    bool hasDirectional = false;
+    bool hasPoint = false;
+    for (const Light& light : m_lights)
     {
-        MainRenderPass(); // your current scene draw code
+        hasDirectional |= light.Type == LIGHT_DIRECTIONAL;
+        hasPoint |= light.Type != LIGHT_DIRECTIONAL;
     }
-   
-    m_deviceResources->Present();
+
+    uint32_t lightMix = LIGHT_MIX_MIXED;
+    if (!hasPoint)
+        lightMix = LIGHT_MIX_DIRECTIONAL;
+    else if (!hasDirectional)
+        lightMix = LIGHT_MIX_POINT;
+
+    const ShaderPermutationSpace& space = m_forwardVariants->GetSpace();
+    ShaderVariantKey key = 0;
+    key = space.Set(key, m_featureShadowQuality, m_shadowQuality);
+    key = space.Set(key, m_featureLightMix, lightMix);
+    key = space.Set(key, m_featureClusteredLights, m_clusteredLights.empty() ? 0 : 1);
+    return key;
 }
 
-void Renderer::ShadowPass()
+void Renderer::CreateClusteredLights()
 {
-    ID3D11Device* device = m_deviceResources->GetDevice();
-    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    // Demo field: a jittered 32x32 grid of small lights over the ground plane
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
 
-    // Ensure shadow map is not bound as SRV
-    ID3D11ShaderResourceView* nullSRV[1] = { nullptr };
-    context->PSSetShaderResources(1, 1, nullSRV);
+    const uint32_t side = 32;
+    for (uint32_t z = 0; z < side; ++z)
+    {
+        for (uint32_t x = 0; x < side; ++x)
+        {
+            Light lamp = {};
+            lamp.Type = LIGHT_POINT;
+            lamp.Position = XMFLOAT3(
+                -9.0f + (x + unit(rng)) * (20.0f / side),
+                -1.4f + unit(rng) * 1.5f,
+                -10.0f + (z + unit(rng)) * (20.0f / side));
+            lamp.Color = XMFLOAT3(0.2f + 0.8f * unit(rng), 0.2f + 0.8f * unit(rng), 0.2f + 0.8f * unit(rng));
+            lamp.Range = 1.0f + unit(rng);
+            lamp.Intensity = 0.6f;
+            m_clusteredLights.push_back(lamp);
+            m_clusteredLightDynamic.push_back(0);
+        }
+    }
+}
 
-    context->RSSetState(m_shadowRasterizerState);
+void Renderer::AssignLightClusters(ID3D11DeviceContext* context, const XMMATRIX& view, CBLight& cb)
+{
+    m_lightClusters->SetProjection(XM_PIDIV4, m_deviceResources->GetAspectRatio(), m_nearZ, m_farZ);
 
-    // --------------------------------------------------
-    // Compute cascade light matrices
-    // --------------------------------------------------
-    XMFLOAT3 dir = m_lights[0].Direction;
-    XMVECTOR lightDir = XMVector3Normalize(XMLoadFloat3(&dir));
+    m_clusteredLightSpheres.resize(m_clusteredLights.size());
+    for (size_t i = 0; i < m_clusteredLights.size(); ++i)
+    {
+        XMFLOAT3 center;
+        XMStoreFloat3(&center, XMVector3TransformCoord(XMLoadFloat3(&m_clusteredLights[i].Position), view));
+
+        LightSphere& sphere = m_clusteredLightSpheres[i];
+        sphere.x = center.x;
+        sphere.y = center.y;
+        sphere.z = center.z;
+        sphere.radius = m_clusteredLights[i].Range;
+    }
 
-    XMMATRIX camView = m_camera.GetViewMatrix();
-    XMMATRIX camProj = XMMatrixPerspectiveFovLH(
-        XM_PIDIV4,
-        m_deviceResources->GetAspectRatio(),
-        m_nearZ,
-        m_farZ
-    );
+    uint32_t count = (uint32_t)m_clusteredLights.size();
+    m_lightClusters->Assign(m_clusteredLightSpheres.data(), count);
+    if (!m_lightClusterBuffers->Update(context, m_clusteredLights.data(), count, *m_lightClusters))
+        OutputDebugStringA("Failed to upload the light clusters\n");
 
-    float prevSplit = m_nearZ;
-    std::vector<XMVECTOR> frustumCorners;
+    const ClusterGridConfig& config = m_lightClusters->GetConfig();
+    cb.ClusterDims = XMUINT4(config.tilesX, config.tilesY, config.slices, count);
+    cb.ClusterParams = XMFLOAT4(
+        config.tilesX / (float)m_deviceResources->GetWidth(),
+        config.tilesY / (float)m_deviceResources->GetHeight(),
+        m_lightClusters->GetDepthScale(),
+        m_lightClusters->GetDepthBias());
 
-    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    if (!m_lightClustersLogged)
     {
-        float splitDist = m_cascadeSplits[i];
-
-        GetFrustrumConrersWS(camView, camProj, prevSplit, splitDist, frustumCorners);
-
-        XMVECTOR center = XMVectorZero();
-        for (auto& v : frustumCorners)
-            center += v;
-        center /= (float)frustumCorners.size();
+        m_lightClustersLogged = true;
+        const ClusterStats& stats = m_lightClusters->GetStats();
+        char msg[160];
+        sprintf_s(msg, "Light clusters: %u lights, %u references, max %u per cluster, %u/%u clusters lit, %.2f ms\n",
+            stats.lights, stats.references, stats.maxPerCluster, stats.occupiedClusters,
+            m_lightClusters->GetClusterCount(), stats.assignMs);
+        OutputDebugStringA(msg);
+    }
+}
 
-        XMVECTOR lightPos = center - lightDir * 50.0f;
+bool Renderer::LoadScene(const wchar_t* path)
+{
+    ID3D11Device* device = m_deviceResources->GetDevice();
 
-        XMMATRIX lightView = XMMatrixLookAtLH(
-            lightPos,
-            center,
-            XMVectorSet(0, 1, 0, 0)
-        );
+    GltfDocument doc;
+    if (!GltfImporter::Load(path, doc))
+    {
+        OutputDebugStringA(("glTF: " + doc.error + "\n").c_str());
+        MessageBox(nullptr, L"Failed to import glTF scene", L"Error", MB_OK);
+        return false;
+    }
 
-        XMVECTOR minExt = XMVectorSet(FLT_MAX, FLT_MAX, FLT_MAX, 1);
-        XMVECTOR maxExt = XMVectorSet(-FLT_MAX, -FLT_MAX, -FLT_MAX, 1);
+    GltfScene scene;
+    if (!scene.Create(device, doc))
+    {
+        scene.Release();
+        return false;
+    }
 
-        for (auto& v : frustumCorners)
+    const GltfImportStats& stats = doc.stats;
+    char msg[256];
+    sprintf_s(msg, "glTF import: %.2f MB in %.2f ms (%.1f MB/s) [parse %.2f, load %.2f, decode %.2f%s] %u primitives (%u skipped), %u triangles, %u nodes (%u skipped)\n",
+        stats.bytesRead / (1024.0 * 1024.0), stats.totalMs, stats.GetMegabytesPerSecond(),
+        stats.parseMs, stats.loadMs, stats.decodeMs, stats.cacheHit ? " cached" : "",
+        stats.primitiveCount, stats.skippedPrimitives, stats.triangleCount, stats.nodeCount, stats.skippedNodes);
+    OutputDebugStringA(msg);
+
+    // Scene objects keep pointers into the scene, so merge instead of replacing
+    uint32_t meshBase = (uint32_t)m_scene.meshes.size();
+    uint32_t textureBase = (uint32_t)m_scene.textures.size();
+    m_scene.meshes.insert(m_scene.meshes.end(), scene.meshes.begin(), scene.meshes.end());
+    m_scene.textures.insert(m_scene.textures.end(), scene.textures.begin(), scene.textures.end());
+
+    for (const GltfSceneInstance& instance : scene.instances)
+    {
+        RenderObject* obj = new RenderObject(m_scene.meshes[meshBase + instance.mesh]);
+        obj->GetTransform().SetPosition(instance.position);
+        obj->GetTransform().SetRotation(instance.rotation);
+        obj->GetTransform().SetScale(instance.scale);
+        if (instance.texture >= 0)
+            obj->SetTexture(m_scene.textures[textureBase + instance.texture]);
+        else
         {
-            XMVECTOR vLS = XMVector3TransformCoord(v, lightView);
-            minExt = XMVectorMin(minExt, vLS);
-            maxExt = XMVectorMax(maxExt, vLS);
+            obj->SetTexture(m_brickCookedTexture);
+            obj->SetTextureHandle(m_brickTexture);
         }
-
-        XMMATRIX lightProj = XMMatrixOrthographicOffCenterLH(
-            XMVectorGetX(minExt), XMVectorGetX(maxExt),
-            XMVectorGetY(minExt), XMVectorGetY(maxExt),
-            XMVectorGetZ(minExt) - 10.0f,
-            XMVectorGetZ(maxExt) + 10.0f
-        );
-
-        m_lightViewProj[i] = lightView * lightProj;
-        prevSplit = splitDist;
+        m_renderObjects.push_back(obj);
     }
 
-    // --------------------------------------------------
-    // Shadow pass rendering
-    // --------------------------------------------------
-    m_shadowShader->Bind(context);
-    context->PSSetShader(nullptr, nullptr, 0);
+    InvalidateStaticShadows();
+    return true;
+}
 
-    ID3D11Buffer* perObjCB = m_cbPerObject->Get();
-    ID3D11Buffer* shadowCB = m_cbShadow->Get();
+void Renderer::InvalidateStaticShadows()
+{
+    // Before CreateResources made the cache there is nothing to invalidate
+    if (m_shadowCache)
+        m_shadowCache->InvalidateStatic();
+    if (m_shadowAtlas)
+        m_shadowAtlas->Invalidate();
+}
+
+void Renderer::Render()
+{
+    if (Input::IsKeyPressed(VK_F1))
+        ToggleShadowDebug();
+    if (Input::IsKeyPressed(VK_F2))
+        m_shadowQuality = (ShadowQuality)((m_shadowQuality + 1) % 5);
+    if (Input::IsKeyPressed(VK_F3))
+        m_renderPath = (RenderPath)((m_renderPath + 1) % 2);
+    if (Input::IsKeyPressed(VK_F4))
+        m_depthPrepass = !m_depthPrepass;
+    if (Input::IsKeyPressed(VK_F5))
+        m_shadowPassMode = (ShadowPassMode)((m_shadowPassMode + 1) % 2);
+    if (Input::IsKeyPressed(VK_F6))
+        m_cascadeFitMode = (CascadeFitMode)((m_cascadeFitMode + 1) % 2);
+    if (Input::IsKeyPressed(VK_F7))
+        m_shadowCacheConfig.cacheStatic = !m_shadowCacheConfig.cacheStatic;
+    if (Input::IsKeyPressed(VK_F8))
+        m_cascadeSplitMode = (CascadeSplitMode)((m_cascadeSplitMode + 1) % 2);
+    if (Input::IsKeyPressed(VK_F9))
+        m_occlusionCulling = !m_occlusionCulling;
+    if (Input::IsKeyPressed(VK_F10))
+        m_gpuDriven = !m_gpuDriven;
+    if (Input::IsKeyPressed(VK_F11))
+        DumpProfile();
+
+    // The F keys are taken, and F12 breaks into an attached debugger
+    if (Input::IsKeyPressed(VK_TAB))
+        ToggleStatsOverlay();
+    if (m_shadowQuality == SHADOW_QUALITY_EVSM && !m_shadowMoments)
+        m_shadowQuality = SHADOW_QUALITY_SOFT;
+
+    // GPU scopes nest in the frame's; the frame's CPU scope also takes in Present
+    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    bool frameScope = Profiler::BeginScope("Frame");
+    m_gpuProfiler->BeginFrame(context);
+    m_gpuProfiler->BeginScope(context, "Frame");
+    m_frameStats.BeginFrame();
+   
+    // Update camera FIRST so both shadow pass and main pass use consistent matrices
+    float dt = 0.016f; // temporary
+    m_camera.Update(dt);
+
+    // Frame boundary: swap in whatever finished rebuilding since last frame
+    {
+        ProfileScope profile("HotReload");
+        std::string reloadLog;
+        m_hotReloader->Update(reloadLog);
+        if (!reloadLog.empty())
+            OutputDebugStringA(reloadLog.c_str());
+    }
+
+    // Finish uploads/evictions from last frame's mip feedback before anything binds textures
+    {
+        GpuProfileScope profile(m_gpuProfiler, context, "TextureStreamer");
+        SetStatsPass(context, RENDER_PASS_STREAMING);
+        m_textureStreamer->Update();
+        m_frameStats.Add(FRAME_COUNTER_TEXTURE_BYTES, m_textureStreamer->GetStats().uploadedBytes);
+    }
+
+    if (!m_texturesReadyLogged && m_textureStreamer->GetStats().pendingDecodes == 0)
+    {
+        // Second half of startup: decodes (or cache reads) of every requested texture
+        m_texturesReadyLogged = true;
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_initTime).count();
+        char msg[128];
+        sprintf_s(msg, "Startup: textures decoded %.1f ms after renderer init began\n", ms);
+        OutputDebugStringA(msg);
+    }
+
+    // Move objects before the shadow pass so shadows and the scene agree
+    AnimateObjects(dt);
+    SetStatsPass(context, RENDER_PASS_CULLING);
+    CullOccludedObjects();
+
+    m_stats.gpuDriven = IsGpuDriven();
+    if (m_stats.gpuDriven)
+        BuildCullBatch();
+    else
+        m_stats.gpuCulling = GpuCullingStats();
+
+    // Compute cascade splits BEFORE shadow pass
+    SetStatsPass(context, RENDER_PASS_FRAME);
+    ComputeCascadeSplits();
+
+    ShadowPass();
+    ShadowAtlasPass();
+
+    if (m_showShadowDebug)
+    {
+        RenderShadowDebug();
+    }
+    else if (m_renderPath == RENDER_PATH_DEFERRED)
+    {
+        DeferredRenderPass();
+    }
+    else
+    {
+        MainRenderPass(); // your current scene draw code
+    }
+
+    // Visible depth for the next frames' cascade partitions
+    if (m_cascadeSplitMode == CASCADE_SPLIT_SDSM && !m_showShadowDebug)
+    {
+        SetStatsPass(context, RENDER_PASS_FRAME);
+        ReduceVisibleDepth();
+    }
+
+    // Last frame's averages over the finished image
+    if (m_showStatsOverlay && m_debugTextPipeline)
+        RenderStatsOverlay();
+
+    SetStatsPass(context, RENDER_PASS_FRAME);
+    CollectPassStatistics(context);
+    m_frameStats.EndFrame();
+
+    m_gpuProfiler->EndScope(context);
+    m_gpuProfiler->EndFrame(context);
+    {
+        ProfileScope profile("Present");
+        m_deviceResources->Present();
+    }
+
+    if (frameScope)
+        Profiler::EndScope();
+    Profiler::EndFrame();
+}
+
+void Renderer::DumpProfile()
+{
+    // Averages over the last PROFILER_AVERAGE_FRAMES frames, then the trace for chrome://tracing or Perfetto
+    std::vector<ProfileScopeStats> scopes = Profiler::GetAllScopeStats();
+    std::string report = "Profile (ms per frame, average / min / max, calls):\n";
+    for (const ProfileScopeStats& scope : scopes)
+    {
+        char line[256];
+        sprintf_s(line, "  %s %-40s %7.3f %7.3f %7.3f %5.1f\n", scope.gpu ? "GPU" : "CPU", scope.path.c_str(),
+            scope.averageMs, scope.minMs, scope.maxMs, scope.callsPerFrame);
+        report += line;
+    }
+    OutputDebugStringA(report.c_str());
+
+    if (Profiler::ExportChromeTrace("Profile.json"))
+        OutputDebugStringA("Profile: trace written to Profile.json\n");
+    else
+        OutputDebugStringA("Profile: failed to write Profile.json\n");
+
+    // Render counters of the same frames, for regression tracking
+    if (m_frameStats.ExportCsv("FrameStats.csv") && m_frameStats.ExportJson("FrameStats.json"))
+        OutputDebugStringA("Profile: render counters written to FrameStats.csv and FrameStats.json\n");
+    else
+        OutputDebugStringA("Profile: failed to write the render counters\n");
+}
+
+void Renderer::SetStatsPass(ID3D11DeviceContext* context, RenderPassId pass)
+{
+    // Constant buffers are charged in bulk: whatever was written since the last switch
+    uint64_t constantBytes = GetUploadedConstantBytes();
+    m_frameStats.Add(FRAME_COUNTER_CONSTANT_BYTES, constantBytes - m_constantBytesCharged);
+    m_constantBytesCharged = constantBytes;
+
+    RenderPassId current = m_frameStats.GetPass();
+    if (pass == current)
+        return;
+
+    if (m_passStatistics[current])
+        m_passStatistics[current]->End(context);
+    m_frameStats.SetPass(pass);
+    if (m_passStatistics[pass])
+        m_passStatistics[pass]->Begin(context, 0);
+}
+
+uint64_t Renderer::GetUploadedConstantBytes() const
+{
+    uint64_t bytes = m_cbPerObject->GetUploadedBytes() + m_cbLight->GetUploadedBytes() + m_cbShadow->GetUploadedBytes() +
+        m_cbDeferred->GetUploadedBytes() + m_cbEvsm->GetUploadedBytes();
+    if (m_gpuCuller)
+        bytes += m_gpuCuller->GetUploadedConstantBytes();
+    if (m_hiZPyramid)
+        bytes += m_hiZPyramid->GetUploadedConstantBytes();
+    return bytes;
+}
+
+void Renderer::CollectPassStatistics(ID3D11DeviceContext* context)
+{
+    // The main pass's query is read by CollectMainPassStatistics
+    for (uint32_t pass = 0; pass < RENDER_PASS_COUNT; ++pass)
+    {
+        if (!m_passStatistics[pass])
+            continue;
+
+        D3D11_QUERY_DATA_PIPELINE_STATISTICS data = {};
+        uint32_t tag = 0;
+        while (m_passStatistics[pass]->Collect(context, data, tag))
+            m_frameStats.SetPipelineCounters((RenderPassId)pass, ToPipelineCounters(data));
+    }
+}
+
+void Renderer::RenderStatsOverlay()
+{
+    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, context, "StatsOverlay");
+    SetStatsPass(context, RENDER_PASS_DEBUG);
+
+    if (!m_statsText->Update(context, m_frameStats.FormatOverlay()))
+        return;
+
+    ID3D11RenderTargetView* rtv = m_deviceResources->GetRenderTargetView();
+    context->OMSetRenderTargets(1, &rtv, nullptr);
+
+    // Top left, font pixels scaled by whole steps with the back buffer height
+    float scale = (std::max)(1.0f, floorf(m_deviceResources->GetHeight() / 720.0f));
+    D3D11_VIEWPORT vp{};
+    vp.TopLeftX = 8.0f;
+    vp.TopLeftY = 8.0f;
+    vp.Width = m_statsText->GetWidth() * scale;
+    vp.Height = m_statsText->GetHeight() * scale;
+    vp.MinDepth = 0.0f;
+    vp.MaxDepth = 1.0f;
+    context->RSSetViewports(1, &vp);
+
+    UINT stride = sizeof(float) * 5;
+    UINT offset = 0;
+    context->IASetVertexBuffers(0, 1, &m_fullscreenVB, &stride, &offset);
+
+    m_debugTextPipeline->Bind(context);
+    ID3D11ShaderResourceView* text = m_statsText->GetSRV();
+    context->PSSetShaderResources(0, 1, &text);
+    context->Draw(4, 0);
+    m_frameStats.CountStripDraw(4);
+}
+
+void Renderer::ShadowPass()
+{
+    ID3D11Device* device = m_deviceResources->GetDevice();
+    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, context, "ShadowPass");
+    SetStatsPass(context, RENDER_PASS_SHADOW);
+
+    // Ensure shadow map is not bound as SRV
+    ID3D11ShaderResourceView* nullSRV[1] = { nullptr };
+    context->PSSetShaderResources(1, 1, nullSRV);
+
+    // --------------------------------------------------
+    // Compute cascade light matrices
+    // --------------------------------------------------
+    XMMATRIX camView = m_camera.GetViewMatrix();
+    XMMATRIX invView = XMMatrixInverse(nullptr, camView);
+
+    CascadeCamera camera;
+    camera.right = ToShadowVector(invView.r[0]);
+    camera.up = ToShadowVector(invView.r[1]);
+    camera.forward = ToShadowVector(invView.r[2]);
+    camera.position = ToShadowVector(invView.r[3]);
+    camera.fovY = XM_PIDIV4;
+    camera.aspect = m_deviceResources->GetAspectRatio();
+
+    // Rotation only: the fit places each cascade inside this fixed frame
+    XMFLOAT3 dir = m_lights[0].Direction;
+    LightBasis basis = CascadeShadows::MakeLightBasis({ dir.x, dir.y, dir.z });
+    XMMATRIX lightView(
+        basis.right.x, basis.up.x, basis.forward.x, 0.0f,
+        basis.right.y, basis.up.y, basis.forward.y, 0.0f,
+        basis.right.z, basis.up.z, basis.forward.z, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f);
+
+    // Casters in light space, once per frame for every cascade; their union is the scene
+    m_shadowCasterBounds.resize(m_renderObjects.size());
+    ShadowAabb sceneBounds;
+    sceneBounds.min = { FLT_MAX, FLT_MAX, FLT_MAX };
+    sceneBounds.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t i = 0; i < m_renderObjects.size(); ++i)
+    {
+        RenderObject* obj = m_renderObjects[i];
+        BoundingBox worldBounds;
+        obj->GetMesh()->GetBounds().Transform(worldBounds, obj->GetTransform().GetWorldMatrix());
+
+        XMVECTOR center = XMLoadFloat3(&worldBounds.Center);
+        XMVECTOR extents = XMLoadFloat3(&worldBounds.Extents);
+        ShadowAabb world = { ToShadowVector(center - extents), ToShadowVector(center + extents) };
+        ShadowAabb& light = m_shadowCasterBounds[i];
+        light = CascadeShadows::ToLightSpaceBounds(basis, world);
+
+        sceneBounds.min = { (std::min)(sceneBounds.min.x, light.min.x), (std::min)(sceneBounds.min.y, light.min.y),
+            (std::min)(sceneBounds.min.z, light.min.z) };
+        sceneBounds.max = { (std::max)(sceneBounds.max.x, light.max.x), (std::max)(sceneBounds.max.y, light.max.y),
+            (std::max)(sceneBounds.max.z, light.max.z) };
+    }
+
+    CascadeBounds bounds[NUM_CASCADES];
+    float prevSplit = m_cascadeNearZ;
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    {
+        bounds[i] = CascadeShadows::Fit(m_cascadeFitMode, camera, basis, prevSplit, m_cascadeSplits[i],
+            SHADOW_MAP_SIZE, 10.0f);
+
+        // Coarse snap: a spinning object at the scene's edge must not invalidate the cache every frame
+        if (!m_renderObjects.empty())
+            CascadeShadows::FitDepthToScene(sceneBounds, 64.0f * bounds[i].texelSize, bounds[i]);
+        prevSplit = m_cascadeSplits[i];
+    }
+
+    // A cascade that is not updated keeps the matrix and split it was drawn with,
+    // so its map and the lighting that picks and samples it stay consistent
+    ShadowCascadeUpdate updates[NUM_CASCADES];
+    m_shadowCache->SetConfig(m_shadowCacheConfig);
+    m_shadowCache->Schedule(basis, bounds, updates);
+
+    uint32_t updateMask = 0;
+    uint32_t staticMask = 0;
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    {
+        if (!updates[i].update)
+            continue;
+
+        XMMATRIX lightProj = XMMatrixOrthographicOffCenterLH(
+            bounds[i].minX, bounds[i].maxX,
+            bounds[i].minY, bounds[i].maxY,
+            bounds[i].minZ, bounds[i].maxZ
+        );
+
+        m_lightViewProj[i] = lightView * lightProj;
+        m_cascadeBounds[i] = bounds[i];
+        m_cascadeRenderedSplits[i] = m_cascadeSplits[i];
+        updateMask |= 1u << i;
+        if (updates[i].renderStatic)
+            staticMask |= 1u << i;
+    }
+
+    const ShadowCacheStats& cacheStats = m_shadowCache->GetStats();
+    m_stats.shadowCascadesUpdated = cacheStats.cascadesUpdated;
+    m_stats.shadowStaticRenders = cacheStats.staticRenders;
+    m_stats.shadowCascadesSkipped = cacheStats.cascadesSkipped;
+
+    // --------------------------------------------------
+    // Shadow pass rendering
+    // --------------------------------------------------
+    D3D11_VIEWPORT vp{};
+    vp.Width = SHADOW_MAP_SIZE;
+    vp.Height = SHADOW_MAP_SIZE;
+    vp.MinDepth = 0.0f;
+    vp.MaxDepth = 1.0f;
+    context->RSSetViewports(1, &vp);
+
+    m_stats.shadowDraws = 0;
+    m_stats.shadowInstances = 0;
+    m_stats.shadowConstantUpdates = 0;
+    for (uint32_t& casters : m_stats.shadowCasters)
+        casters = 0;
+
+    bool singlePass = m_shadowPassMode == SHADOW_PASS_SINGLE && m_shadowCascadesReady;
+    m_stats.shadowPassMode = singlePass ? SHADOW_PASS_SINGLE : SHADOW_PASS_PER_CASCADE;
+
+    // GPU-driven: both caster phases of every cascade culled in one dispatch
+    bool gpuDriven = IsGpuDriven();
+    if (gpuDriven)
+    {
+        for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+        {
+            CullView view = CullKernel::MakeView(ToOcclusionMatrix(m_lightViewProj[c]), CULL_VIEW_SKIP_NEAR);
+            view.filterMask = CULL_OBJECT_DYNAMIC;
+            view.filterValue = CULL_OBJECT_DYNAMIC;
+            m_cullViews[CULL_VIEW_DYNAMIC_CASTERS + c] = view;
+            view.filterValue = 0;
+            m_cullViews[CULL_VIEW_STATIC_CASTERS + c] = view;
+        }
+        m_gpuCuller->Dispatch(context, m_cullBatch, m_cullViews, CULL_VIEW_DYNAMIC_CASTERS, 2 * NUM_CASCADES,
+            nullptr, 0, 0, 0);
+    }
+
+    // Static casters into the cache, only where it went stale
+    for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+    {
+        if (staticMask & (1u << c))
+            context->ClearDepthStencilView(m_shadowCacheDSVs[c], D3D11_CLEAR_DEPTH, 1.0f, 0);
+    }
+
+    if (staticMask)
+    {
+        if (gpuDriven)
+            DrawShadowsIndirect(context, m_shadowCacheDSVs, staticMask, false);
+        else if (singlePass)
+            DrawShadowsSinglePass(context, m_shadowCacheDSVArray, staticMask, false);
+        else
+            DrawShadowsPerCascade(context, m_shadowCacheDSVs, staticMask, false);
+    }
+
+    // Cached statics replace the old slice, dynamic casters go on top
+    context->OMSetRenderTargets(0, nullptr, nullptr);
+    for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+    {
+        if (!(updateMask & (1u << c)))
+            continue;
+
+        UINT slice = D3D11CalcSubresource(0, c, 1);
+        context->CopySubresourceRegion(m_shadowMapArray, slice, 0, 0, 0, m_shadowCacheArray, slice, nullptr);
+    }
+
+    if (updateMask)
+    {
+        if (gpuDriven)
+            DrawShadowsIndirect(context, m_shadowCascadeDSVs, updateMask, true);
+        else if (singlePass)
+            DrawShadowsSinglePass(context, m_shadowMapDSVArray, updateMask, true);
+        else
+            DrawShadowsPerCascade(context, m_shadowCascadeDSVs, updateMask, true);
+    }
+
+    GenerateShadowMoments(context, updateMask);
+}
+
+void Renderer::GenerateShadowMoments(ID3D11DeviceContext* context, uint32_t updateMask)
+{
+    // Redrawn cascades invalidate their moments whether or not EVSM is on, so
+    // switching to it catches up every slice that went stale in the meantime
+    m_shadowMomentsValid &= ~updateMask;
+    m_stats.shadowMomentCascades = 0;
+    if (m_shadowQuality != SHADOW_QUALITY_EVSM || !m_shadowMoments)
+        return;
+
+    uint32_t cascadeMask = ((1u << NUM_CASCADES) - 1) & ~m_shadowMomentsValid;
+    if (!cascadeMask)
+        return;
+
+    uint32_t radius = (std::min)(m_evsmSettings.blurRadius, ShadowMoments::MAX_BLUR_RADIUS);
+    float weights[8] = {};
+    ShadowMoments::ComputeBlurWeights(radius, weights);
+
+    CBEvsm cb = {};
+    cb.EvsmExponents = {
+        (std::min)(m_evsmSettings.positiveExponent, ShadowMoments::MAX_EXPONENT),
+        (std::min)(m_evsmSettings.negativeExponent, ShadowMoments::MAX_EXPONENT),
+        0.0f, 0.0f };
+    cb.EvsmBlurWeights[0] = { weights[0], weights[1], weights[2], weights[3] };
+    cb.EvsmBlurWeights[1] = { weights[4], weights[5], weights[6], weights[7] };
+
+    m_shadowMoments->UnbindInput(context);
+
+    UINT stride = sizeof(float) * 5;
+    UINT offset = 0;
+    context->IASetVertexBuffers(0, 1, &m_fullscreenVB, &stride, &offset);
+
+    // Horizontal pass at half resolution into the scratch target, vertical into the slice
+    for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+    {
+        if (!(cascadeMask & (1u << c)))
+            continue;
+
+        cb.EvsmBlurParams = { c, radius, 0, 0 };
+        m_cbEvsm->Update(context, &cb);
+
+        m_shadowMoments->BeginConvert(context, m_shadowMapSRVArray);
+        m_evsmConvertPipeline->Bind(context);
+        m_evsmConvertShader->BindConstantBuffer(context, "CBEvsm", m_cbEvsm->Get());
+        context->Draw(4, 0);
+        m_frameStats.CountStripDraw(4);
+
+        m_shadowMoments->BeginBlur(context, c);
+        m_evsmBlurPipeline->Bind(context);
+        m_evsmBlurShader->BindConstantBuffer(context, "CBEvsm", m_cbEvsm->Get());
+        context->Draw(4, 0);
+        m_frameStats.CountStripDraw(4);
+
+        m_shadowMoments->FinishCascade(context, c);
+        ++m_stats.shadowMomentCascades;
+    }
+
+    m_shadowMomentsValid |= cascadeMask;
+}
+
+void Renderer::ShadowAtlasPass()
+{
+    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, context, "ShadowAtlasPass");
+    SetStatsPass(context, RENDER_PASS_SHADOW_ATLAS);
+
+    // The atlas texture keeps the size it was created with
+    ShadowAtlasSettings settings = m_shadowAtlasSettings;
+    settings.atlasSize = m_shadowAtlasMaps->GetSize();
+    m_shadowAtlas->SetSettings(settings);
+
+    XMMATRIX view = m_camera.GetViewMatrix();
+    XMMATRIX invView = XMMatrixInverse(nullptr, view);
+    ShadowVector cameraPosition = ToShadowVector(invView.r[3]);
+
+    BoundingFrustum frustum(XMMatrixPerspectiveFovLH(XM_PIDIV4, m_deviceResources->GetAspectRatio(), m_nearZ, m_farZ));
+    frustum.Transform(frustum, invView);
+
+    // One cube per clustered light; lights off screen get no shadow. The casters
+    // inside each shadowed light's sphere are found once here, for both the
+    // dynamic face mask and the tile draws below.
+    m_shadowLightRequests.resize(m_clusteredLights.size());
+    m_shadowLightCasterFirst.resize(m_clusteredLights.size() + 1);
+    m_shadowLightCasters.clear();
+    m_shadowLightCasterFaces.clear();
+    for (size_t i = 0; i < m_clusteredLights.size(); ++i)
+    {
+        const Light& light = m_clusteredLights[i];
+        ShadowLightRequest& request = m_shadowLightRequests[i];
+        request.lightId = (uint32_t)i;
+        request.faceCount = 6;
+        request.isStatic = !m_clusteredLightDynamic[i];
+        request.position = { light.Position.x, light.Position.y, light.Position.z };
+        request.range = light.Range;
+
+        BoundingSphere sphere(light.Position, light.Range);
+        request.importance = frustum.Intersects(sphere) ?
+            ShadowAtlas::EstimateImportance(cameraPosition, XM_PIDIV4, request.position, request.range) : 0.0f;
+
+        request.dynamicFaceMask = 0;
+        m_shadowLightCasterFirst[i] = (uint32_t)m_shadowLightCasters.size();
+        if (request.importance < settings.minImportance)
+            continue;
+
+        for (size_t o = 0; o < m_renderObjects.size(); ++o)
+        {
+            uint32_t faces = ShadowAtlas::GetPointLightFaceMask(request.position, request.range, m_objectWorldBounds[o]);
+            if (!faces)
+                continue;
+
+            m_shadowLightCasters.push_back((uint32_t)o);
+            m_shadowLightCasterFaces.push_back((uint8_t)faces);
+            if (m_renderObjects[o]->IsDynamic())
+                request.dynamicFaceMask |= faces;
+        }
+    }
+    m_shadowLightCasterFirst[m_clusteredLights.size()] = (uint32_t)m_shadowLightCasters.size();
+
+    m_shadowAtlas->Update(m_shadowLightRequests.data(), m_shadowLightRequests.size());
+
+    m_clusteredLightShadows.resize(m_clusteredLights.size());
+    for (size_t i = 0; i < m_clusteredLights.size(); ++i)
+    {
+        uint32_t first = m_shadowAtlas->GetFirstTile(i);
+        m_clusteredLightShadows[i] = first == ShadowAtlas::INVALID_TILE ? -1 : (int32_t)first;
+    }
+
+    // --------------------------------------------------
+    // Tiles: matrices for all, depth only where the cache went stale
+    // --------------------------------------------------
+    static const XMVECTORF32 faceDirections[6] = {
+        { 1.0f, 0.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f, 0.0f } };
+    static const XMVECTORF32 faceUps[6] = {
+        { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f } };
+
+    const std::vector<ShadowAtlasTile>& tiles = m_shadowAtlas->GetTiles();
+    float invSize = 1.0f / (float)settings.atlasSize;
+    m_shadowAtlasTiles.resize(tiles.size());
+    m_stats.shadowAtlasDraws = 0;
+
+    m_shadowAtlasMaps->UnbindInputs(context);
+    const ConstantBufferBinding* shadowPerObject = m_shadowShader->FindConstantBuffer("CBPerObject");
+
+    for (size_t t = 0; t < tiles.size(); ++t)
+    {
+        const ShadowAtlasTile& tile = tiles[t];
+        const ShadowLightRequest& request = m_shadowLightRequests[tile.request];
+
+        XMVECTOR position = XMVectorSet(request.position.x, request.position.y, request.position.z, 1.0f);
+        XMMATRIX viewProj = XMMatrixLookToLH(position, faceDirections[tile.face], faceUps[tile.face]) *
+            XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.05f, request.range);
+
+        ShadowAtlasTileGpu& gpuTile = m_shadowAtlasTiles[t];
+        XMStoreFloat4x4(&gpuTile.ViewProj, XMMatrixTranspose(viewProj));
+        gpuTile.Rect = {
+            tile.rect.width * invSize, tile.rect.height * invSize,
+            tile.rect.x * invSize, tile.rect.y * invSize };
+
+        if (!tile.render)
+            continue;
+
+        // No per-rect depth clear in D3D11: far depth over the tile with a quad
+        m_shadowAtlasMaps->BeginTile(context, tile.rect);
+        m_atlasClearPipeline->Bind(context);
+        UINT stride = sizeof(float) * 5;
+        UINT offset = 0;
+        context->IASetVertexBuffers(0, 1, &m_fullscreenVB, &stride, &offset);
+        context->Draw(4, 0);
+        m_frameStats.CountStripDraw(4);
+
+        m_shadowPipeline->Bind(context);
+        m_shadowShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+
+        uint32_t faceBit = 1u << tile.face;
+        uint32_t drawn = 0;
+        for (uint32_t c = m_shadowLightCasterFirst[tile.request]; c < m_shadowLightCasterFirst[tile.request + 1]; ++c)
+        {
+            if (!(m_shadowLightCasterFaces[c] & faceBit))
+                continue;
+
+            RenderObject* obj = m_renderObjects[m_shadowLightCasters[c]];
+            CBPerObject cb{};
+            XMStoreFloat4x4(&cb.World, XMMatrixTranspose(obj->GetTransform().GetWorldMatrix()));
+            XMStoreFloat4x4(&cb.LightViewProj, XMMatrixTranspose(viewProj));
+
+            m_cbPerObject->Update(context, &cb, shadowPerObject);
+            obj->GetMesh()->Draw(context);
+            m_frameStats.CountDraw(obj->GetMesh()->GetIndexCount());
+            m_frameStats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, 1);
+            ++m_stats.shadowAtlasDraws;
+            ++drawn;
+        }
+        m_frameStats.Add(FRAME_COUNTER_CULLED_OBJECTS, (uint32_t)m_renderObjects.size() - drawn);
+    }
+
+    context->OMSetRenderTargets(0, nullptr, nullptr);
+
+    if (!m_shadowAtlasMaps->Update(context, m_shadowAtlasTiles.data(), (uint32_t)m_shadowAtlasTiles.size(),
+        m_clusteredLightShadows.data(), (uint32_t)m_clusteredLightShadows.size()))
+        OutputDebugStringA("Failed to upload the shadow atlas tiles\n");
+
+    m_stats.shadowAtlas = m_shadowAtlas->GetStats();
+}
+
+void Renderer::DrawShadowsPerCascade(ID3D11DeviceContext* context, ID3D11DepthStencilView* const* cascadeDSVs,
+    uint32_t cascadeMask, bool dynamicCasters)
+{
+    m_shadowPipeline->Bind(context);
+
+    m_shadowShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+    m_shadowShader->BindConstantBuffer(context, "CBShadow", m_cbShadow->Get());
+    const ConstantBufferBinding* shadowPerObject = m_shadowShader->FindConstantBuffer("CBPerObject");
+    const ConstantBufferBinding* shadowCascades = m_shadowShader->FindConstantBuffer("CBShadow");
+
+    for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+    {
+        if (!(cascadeMask & (1u << c)))
+            continue;
+
+        context->OMSetRenderTargets(0, nullptr, cascadeDSVs[c]);
+
+        // Update shadow CB (once per cascade)
+        CBShadow cbShadow{};
+        for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+        {
+            XMStoreFloat4x4(
+                &cbShadow.LightViewProj[i],
+                XMMatrixTranspose(m_lightViewProj[i])
+            );
+        }
+
+        cbShadow.CascadeSplits = {
+            m_cascadeRenderedSplits[0],
+            m_cascadeRenderedSplits[1],
+            m_cascadeRenderedSplits[2],
+            m_cascadeRenderedSplits[3]
+        };
+
+        // The shadow VS takes its matrix from CBPerObject, skip the update unless it reads CBShadow
+        if (shadowCascades)
+        {
+            m_cbShadow->Update(context, &cbShadow, shadowCascades);
+            ++m_stats.shadowConstantUpdates;
+        }
+
+
+        // Draw this phase's shadow casters that can reach the cascade
+        for (size_t i = 0; i < m_renderObjects.size(); ++i)
+        {
+            RenderObject* obj = m_renderObjects[i];
+            if (obj->IsDynamic() != dynamicCasters)
+                continue;
+            if (!CascadeShadows::IsCasterVisible(m_cascadeBounds[c], m_shadowCasterBounds[i]))
+            {
+                m_frameStats.Add(FRAME_COUNTER_CULLED_OBJECTS, 1);
+                continue;
+            }
+
+            CBPerObject cb{};
+            XMMATRIX world = obj->GetTransform().GetWorldMatrix();
+            XMStoreFloat4x4(&cb.World, XMMatrixTranspose(world));
+            XMStoreFloat4x4(&cb.LightViewProj, XMMatrixTranspose(m_lightViewProj[c]));
+
+            // World + LightViewProj only: 128 of 320 bytes
+            m_cbPerObject->Update(context, &cb, shadowPerObject);
+            obj->GetMesh()->Draw(context);
+            m_frameStats.CountDraw(obj->GetMesh()->GetIndexCount());
+            m_frameStats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, 1);
+            ++m_stats.shadowConstantUpdates;
+            ++m_stats.shadowDraws;
+            ++m_stats.shadowInstances;
+            ++m_stats.shadowCasters[c];
+        }
+    }
+}
+
+void Renderer::DrawShadowsSinglePass(ID3D11DeviceContext* context, ID3D11DepthStencilView* arrayDSV,
+    uint32_t cascadeMask, bool dynamicCasters)
+{
+    // Every slice at once: the VS (or GS) routes each instance to its cascade
+    context->OMSetRenderTargets(0, nullptr, arrayDSV);
+
+    m_shadowCascadesPipeline->Bind(context);
+    m_shadowCascadesShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+    m_shadowCascadesShader->BindConstantBuffer(context, "CBShadow", m_cbShadow->Get());
+    const ConstantBufferBinding* shadowPerObject = m_shadowCascadesShader->FindConstantBuffer("CBPerObject");
+
+    // All cascade matrices once per frame instead of once per cascade
+    CBShadow cbShadow{};
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+        XMStoreFloat4x4(&cbShadow.LightViewProj[i], XMMatrixTranspose(m_lightViewProj[i]));
+    cbShadow.CascadeSplits = { m_cascadeRenderedSplits[0], m_cascadeRenderedSplits[1], m_cascadeRenderedSplits[2], m_cascadeRenderedSplits[3] };
+    m_cbShadow->Update(context, &cbShadow, m_shadowCascadesShader->FindConstantBuffer("CBShadow"));
+    ++m_stats.shadowConstantUpdates;
+
+    for (size_t i = 0; i < m_renderObjects.size(); ++i)
+    {
+        RenderObject* obj = m_renderObjects[i];
+        if (obj->IsDynamic() != dynamicCasters)
+            continue;
+
+        uint32_t overlapMask = 0;
+        for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+        {
+            if (!(cascadeMask & (1u << c)))
+                continue;
+
+            if (CascadeShadows::IsCasterVisible(m_cascadeBounds[c], m_shadowCasterBounds[i]))
+            {
+                overlapMask |= 1u << c;
+                ++m_stats.shadowCasters[c];
+                m_frameStats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, 1);
+            }
+            else
+            {
+                m_frameStats.Add(FRAME_COUNTER_CULLED_OBJECTS, 1);
+            }
+        }
+
+        if (!overlapMask)
+            continue;
+
+        CBPerObject cb{};
+        XMStoreFloat4x4(&cb.World, XMMatrixTranspose(obj->GetTransform().GetWorldMatrix()));
+
+        // One draw per run of cascades. Gaps between overlapped cascades of
+        // the pass cost an instance that clips away; cascades outside the
+        // pass must not be touched at all, so they split the run.
+        uint32_t first = 0;
+        while (first < NUM_CASCADES)
+        {
+            if (!(overlapMask & (1u << first)))
+            {
+                ++first;
+                continue;
+            }
+
+            uint32_t last = first;
+            for (uint32_t c = first + 1; c < NUM_CASCADES && (cascadeMask & (1u << c)); ++c)
+            {
+                if (overlapMask & (1u << c))
+                    last = c;
+            }
+
+            cb.CascadeRange = XMUINT4(first, last - first + 1, 0, 0);
+            m_cbPerObject->Update(context, &cb, shadowPerObject);
+            obj->GetMesh()->DrawInstanced(context, cb.CascadeRange.y);
+            m_frameStats.CountDraw(obj->GetMesh()->GetIndexCount(), cb.CascadeRange.y);
+            ++m_stats.shadowConstantUpdates;
+            ++m_stats.shadowDraws;
+            m_stats.shadowInstances += cb.CascadeRange.y;
+
+            first = last + 1;
+        }
+    }
+}
+
+void Renderer::DrawShadowsIndirect(ID3D11DeviceContext* context, ID3D11DepthStencilView* const* cascadeDSVs,
+    uint32_t cascadeMask, bool dynamicCasters)
+{
+    m_instancedShadowPipeline->Bind(context);
+    m_gpuCuller->BindInstances(context);
+    m_instancedShadowShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+    m_instancedShadowShader->BindConstantBuffer(context, "CBShadow", m_cbShadow->Get());
+    const ConstantBufferBinding* shadowPerObject = m_instancedShadowShader->FindConstantBuffer("CBPerObject");
+
+    CBShadow cbShadow{};
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+        XMStoreFloat4x4(&cbShadow.LightViewProj[i], XMMatrixTranspose(m_lightViewProj[i]));
+    cbShadow.CascadeSplits = { m_cascadeRenderedSplits[0], m_cascadeRenderedSplits[1], m_cascadeRenderedSplits[2], m_cascadeRenderedSplits[3] };
+    m_cbShadow->Update(context, &cbShadow, m_instancedShadowShader->FindConstantBuffer("CBShadow"));
+    ++m_stats.shadowConstantUpdates;
+
+    // One indirect draw per bucket and cascade, empty ones included: the counts live on the GPU
+    uint32_t firstView = dynamicCasters ? CULL_VIEW_DYNAMIC_CASTERS : CULL_VIEW_STATIC_CASTERS;
+    uint32_t bucketCount = m_cullBatch.GetBucketCount();
+    for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+    {
+        if (!(cascadeMask & (1u << c)))
+            continue;
+
+        context->OMSetRenderTargets(0, nullptr, cascadeDSVs[c]);
+
+        CBPerObject cb{};
+        cb.CascadeRange = XMUINT4(c, 1, 0, 0);
+        m_cbPerObject->Update(context, &cb, shadowPerObject);
+        ++m_stats.shadowConstantUpdates;
+
+        for (uint32_t b = 0; b < bucketCount; ++b)
+        {
+            m_indirectBuckets[b].mesh->DrawIndirect(context, m_gpuCuller->GetArgs(),
+                GpuCuller::GetArgsOffset(CullBatch::GetDrawIndex(firstView + c, b, bucketCount)));
+            m_frameStats.CountIndirectDraw();
+        }
+        m_stats.shadowDraws += bucketCount;
+        m_stats.gpuCulling.indirectDraws += bucketCount;
+    }
+}
+
+void Renderer::AnimateObjects(float dt)
+{
+    // Only the two demo cubes spin
+    for (size_t i = 0; i < m_renderObjects.size(); ++i)
+    {
+        RenderObject* obj = m_renderObjects[i];
+        if (obj->GetMesh() != m_mesh)
+            continue;
+
+        XMFLOAT3 axis = (i == 0)
+            ? XMFLOAT3(0, 1, 0)
+            : XMFLOAT3(1, 0, 0);
+
+        obj->GetTransform().RotateAxisAngle(axis, dt * (i + 1));
+    }
+}
+
+void Renderer::CullOccludedObjects()
+{
+    ProfileScope profile("CullOccludedObjects");
+    // World bounds once per frame, the atlas pass reuses them
+    m_objectWorldBounds.resize(m_renderObjects.size());
+    for (size_t i = 0; i < m_renderObjects.size(); ++i)
+    {
+        RenderObject* obj = m_renderObjects[i];
+        BoundingBox worldBounds;
+        obj->GetMesh()->GetBounds().Transform(worldBounds, obj->GetTransform().GetWorldMatrix());
+
+        XMVECTOR center = XMLoadFloat3(&worldBounds.Center);
+        XMVECTOR extents = XMLoadFloat3(&worldBounds.Extents);
+        m_objectWorldBounds[i] = { ToShadowVector(center - extents), ToShadowVector(center + extents) };
+    }
+
+    // The GPU-driven path culls on the GPU, everything stays visible here
+    m_objectVisible.assign(m_renderObjects.size(), 1);
+    m_stats.occlusion = OcclusionStats();
+    if (!m_occlusionCulling || IsGpuDriven() || m_renderObjects.empty())
+        return;
+
+    XMMATRIX view = m_camera.GetViewMatrix();
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, m_deviceResources->GetAspectRatio(), m_nearZ, m_farZ);
+    ShadowVector cameraPosition = ToShadowVector(XMMatrixInverse(nullptr, view).r[3]);
+
+    m_occlusion->SetSettings(m_occlusionSettings);
+    m_occlusion->Begin(ToOcclusionMatrix(view * proj));
+
+    // Occluders: opaque, simple enough to keep on the CPU, largest on screen first
+    struct Candidate
+    {
+        float size;
+        size_t index;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i < m_renderObjects.size(); ++i)
+    {
+        RenderObject* obj = m_renderObjects[i];
+        if (obj->GetAlphaTest() || obj->GetMesh()->GetOccluderIndices().empty())
+            continue;
+
+        float size = OcclusionBuffer::EstimateScreenSize(m_objectWorldBounds[i], cameraPosition, XM_PIDIV4);
+        if (size >= m_occlusionSettings.minOccluderSize)
+            candidates.push_back({ size, i });
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+        {
+            return a.size > b.size;
+        });
+
+    size_t occluderCount = (std::min)(candidates.size(), (size_t)m_occlusionSettings.maxOccluders);
+    for (size_t k = 0; k < occluderCount; ++k)
+    {
+        RenderObject* obj = m_renderObjects[candidates[k].index];
+        const Mesh* mesh = obj->GetMesh();
+        const vector<XMFLOAT3>& positions = mesh->GetOccluderPositions();
+        const vector<uint32_t>& indices = mesh->GetOccluderIndices();
+        m_occlusion->AddOccluder(&positions[0].x, (uint32_t)positions.size(), indices.data(), (uint32_t)indices.size(),
+            ToOcclusionMatrix(obj->GetTransform().GetWorldMatrix()));
+    }
+
+    m_occlusion->Rasterize();
+    m_occlusion->TestVisibility(m_objectWorldBounds.data(), m_objectWorldBounds.size(), m_objectVisible.data());
+    m_stats.occlusion = m_occlusion->GetStats();
+}
+
+bool Renderer::IsGpuDriven() const
+{
+    return m_gpuDriven && m_gpuDrivenReady && m_renderPath == RENDER_PATH_FORWARD;
+}
+
+void Renderer::BuildCullBatch()
+{
+    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, context, "BuildCullBatch");
+    size_t objectCount = m_renderObjects.size();
+
+    // Buckets: equal mesh and material, opaque ones first so each pass draws a contiguous range
+    auto bucketKey = [this](size_t i)
+        {
+            RenderObject* obj = m_renderObjects[i];
+            return std::make_tuple(obj->GetAlphaTest(), (uintptr_t)obj->GetMesh(), (uintptr_t)obj->GetTexture(),
+                obj->GetTextureHandle(), (uintptr_t)obj->GetNormalMap());
+        };
+
+    vector<uint32_t> order(objectCount);
+    for (size_t i = 0; i < objectCount; ++i)
+        order[i] = (uint32_t)i;
+    std::sort(order.begin(), order.end(), [&bucketKey](uint32_t a, uint32_t b)
+        {
+            return bucketKey(a) < bucketKey(b);
+        });
+
+    m_cullBatch.Reset();
+    m_indirectBuckets.clear();
+    m_opaqueBucketCount = 0;
+
+    XMFLOAT3 camPos = m_camera.GetPosition();
+    XMVECTOR cameraPosition = XMLoadFloat3(&camPos);
+    vector<uint32_t> objectBucket(objectCount);
+    for (size_t k = 0; k < objectCount; ++k)
+    {
+        uint32_t i = order[k];
+        RenderObject* obj = m_renderObjects[i];
+        if (k == 0 || bucketKey(i) != bucketKey(order[k - 1]))
+        {
+            m_cullBatch.AddBucket(obj->GetMesh()->GetIndexCount(), 0, 0);
+            m_indirectBuckets.push_back({ obj->GetMesh(), obj, FLT_MAX });
+            if (!obj->GetAlphaTest())
+                ++m_opaqueBucketCount;
+        }
+
+        XMFLOAT3 position = obj->GetTransform().GetPosition();
+        float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&position) - cameraPosition));
+        IndirectBucket& bucket = m_indirectBuckets.back();
+        bucket.nearestDistance = (std::min)(bucket.nearestDistance, distance);
+        objectBucket[i] = (uint32_t)m_indirectBuckets.size() - 1;
+    }
+
+    // Objects in render list order: the instance stream holds these indices
+    m_instanceTransforms.resize(objectCount);
+    for (size_t i = 0; i < objectCount; ++i)
+    {
+        RenderObject* obj = m_renderObjects[i];
+        XMMATRIX world = obj->GetTransform().GetWorldMatrix();
+        XMStoreFloat4x4(&m_instanceTransforms[i].World, XMMatrixTranspose(world));
+        XMStoreFloat4x4(&m_instanceTransforms[i].WorldInvTranspose, XMMatrixInverse(nullptr, world));
+
+        CullObject object;
+        object.boundsMin = m_objectWorldBounds[i].min;
+        object.boundsMax = m_objectWorldBounds[i].max;
+        object.bucket = objectBucket[i];
+        object.flags = (obj->IsDynamic() ? CULL_OBJECT_DYNAMIC : 0) | (obj->GetAlphaTest() ? CULL_OBJECT_ALPHA_TEST : 0);
+        m_cullBatch.AddObject(object);
+    }
+
+    m_cullBatch.Finalize(CULL_VIEW_COUNT);
+    m_gpuCuller->Upload(context, m_cullBatch, m_instanceTransforms.data());
+
+    // The visible counts are a readback, they carry over until the next one lands
+    uint32_t mainVisible = m_stats.gpuCulling.mainVisible;
+    uint32_t mainLate = m_stats.gpuCulling.mainLate;
+    m_stats.gpuCulling = GpuCullingStats();
+    m_stats.gpuCulling.objects = m_cullBatch.GetObjectCount();
+    m_stats.gpuCulling.buckets = m_cullBatch.GetBucketCount();
+    m_stats.gpuCulling.views = CULL_VIEW_COUNT;
+    m_stats.gpuCulling.mainVisible = mainVisible;
+    m_stats.gpuCulling.mainLate = mainLate;
+}
 
-    context->VSSetConstantBuffers(0, 1, &perObjCB);
-    context->VSSetConstantBuffers(1, 1, &shadowCB);
+void Renderer::UpdateFrameLighting(ID3D11DeviceContext* context, const XMMATRIX& view, Shader* lightingShader)
+{
+    // -----------------------------
+    // Cascades (matrices from this frame's ShadowPass)
+    // -----------------------------
+    CBShadow cbShadow = {};
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    {
+        XMStoreFloat4x4(
+            &cbShadow.LightViewProj[i],
+            XMMatrixTranspose(m_lightViewProj[i])
+        );
+    }
 
-    D3D11_VIEWPORT vp{};
-    vp.Width = SHADOW_MAP_SIZE;
-    vp.Height = SHADOW_MAP_SIZE;
-    vp.MinDepth = 0.0f;
-    vp.MaxDepth = 1.0f;
-    context->RSSetViewports(1, &vp);
+    cbShadow.CascadeSplits = {
+        m_cascadeRenderedSplits[0],
+        m_cascadeRenderedSplits[1],
+        m_cascadeRenderedSplits[2],
+        m_cascadeRenderedSplits[3]
+    };
 
-    for (uint32_t c = 0; c < NUM_CASCADES; ++c)
+    // Same world-space penumbra in every cascade, as far as the kernel sizes reach
+    float radius[NUM_CASCADES];
+    bool earlyOut = m_shadowFilter.earlyOut;
+    m_stats.shadowFetchesEarlyOut = 0;
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
     {
+        radius[i] = ShadowFilter::GetFilterRadius(m_cascadeBounds[i].texelSize, m_shadowFilter);
+        uint32_t kernelSize = ShadowFilter::GetKernelSize(radius[i]);
+        uint32_t gathers = ShadowFilter::GetGatherCount(kernelSize);
 
-        context->OMSetRenderTargets(0, nullptr, m_shadowCascadeDSVs[c]);
-
-        context->ClearDepthStencilView(m_shadowCascadeDSVs[c], D3D11_CLEAR_DEPTH, 1.0f, 0);
+        uint32_t fetches = 0;
+        uint32_t earlyOutFetches = 0;
+        switch (m_shadowQuality)
+        {
+        case SHADOW_QUALITY_HARD:
+            fetches = 1;
+            break;
+        case SHADOW_QUALITY_SOFT:
+            // Same condition as the shader: the corners must be fewer than the whole kernel
+            earlyOutFetches = (earlyOut && kernelSize > 3) ? 4 : 0;
+            fetches = gathers + earlyOutFetches;
+            break;
+        case SHADOW_QUALITY_POISSON:
+            earlyOutFetches = earlyOut ? ShadowFilter::EARLY_OUT_TAPS : 0;
+            fetches = ShadowFilter::POISSON_TAPS;
+            break;
+        case SHADOW_QUALITY_EVSM:
+            kernelSize = 1;
+            fetches = 1;
+            break;
+        default:
+            break;
+        }
 
-        // Update shadow CB (once per cascade)
-        CBShadow cbShadow{};
+        m_stats.shadowKernelSize[i] = kernelSize;
+        m_stats.shadowFetchesPenumbra[i] = fetches;
+        m_stats.shadowFetchesEarlyOut = (std::max)(m_stats.shadowFetchesEarlyOut, earlyOutFetches);
+    }
+    cbShadow.CascadeFilterRadius = { radius[0], radius[1], radius[2], radius[3] };
+    cbShadow.ShadowFilterParams = { m_shadowFilter.blendBand, earlyOut ? 1.0f : 0.0f, 0.0f, 0.0f };
+
+    cbShadow.EvsmParams = {
+        (std::min)(m_evsmSettings.positiveExponent, ShadowMoments::MAX_EXPONENT),
+        (std::min)(m_evsmSettings.negativeExponent, ShadowMoments::MAX_EXPONENT),
+        m_evsmSettings.lightBleedingReduction,
+        m_evsmSettings.minVariance };
+
+    // Moment mip whose texel matches a screen pixel's footprint at that depth
+    float lodScale[NUM_CASCADES] = {};
+    if (m_shadowMoments)
+    {
+        float pixelsPerDepth = m_deviceResources->GetHeight() / (2.0f * tanf(0.5f * XM_PIDIV4));
+        float momentTexelScale = (float)SHADOW_MAP_SIZE / m_shadowMoments->GetSize();
         for (uint32_t i = 0; i < NUM_CASCADES; ++i)
         {
-            XMStoreFloat4x4(
-                &cbShadow.LightViewProj[i],
-                XMMatrixTranspose(m_lightViewProj[i])
-            );
+            float texelSize = m_cascadeBounds[i].texelSize * momentTexelScale;
+            lodScale[i] = texelSize > 0.0f ? 1.0f / (pixelsPerDepth * texelSize) : 0.0f;
         }
+    }
+    cbShadow.EvsmLodScale = { lodScale[0], lodScale[1], lodScale[2], lodScale[3] };
 
-        cbShadow.CascadeSplits = {
-            m_cascadeSplits[0],
-            m_cascadeSplits[1],
-            m_cascadeSplits[2],
-            m_cascadeSplits[3]
-        };
+    // The generic shader reads a superset of what the PCF variants read; the
+    // EVSM constants only exist in the EVSM variants, so write everything then
+    const ConstantBufferBinding* shadowBinding = m_shadowQuality == SHADOW_QUALITY_EVSM ?
+        nullptr : lightingShader->FindConstantBuffer("CBShadow");
+    m_cbShadow->Update(context, &cbShadow, shadowBinding);
+
+    // -----------------------------
+    // Lights
+    // -----------------------------
+    CBLight cb = {};
+    cb.LightCount = (int)m_lights.size();
+    cb.CameraPosition = m_camera.GetPosition();
+
+    for (int i = 0; i < cb.LightCount; i++)
+    {
+        cb.Lights[i] = m_lights[i];
+    }
+
+    AssignLightClusters(context, view, cb);
+
+    m_cbLight->Update(context, &cb, lightingShader->FindConstantBuffer("CBLight"));
+}
+
+void Renderer::BindLighting(ID3D11DeviceContext* context, Shader* shader)
+{
+    // Slots and stages come from reflection
+    shader->BindConstantBuffer(context, "CBLight", m_cbLight->Get());
+    shader->BindConstantBuffer(context, "CBShadow", m_cbShadow->Get());
+
+    context->PSSetShaderResources(1, 1, &m_shadowMapSRVArray);
+    m_lightClusterBuffers->Bind(context);
+    m_shadowAtlasMaps->Bind(context);
+
+    if (m_shadowMoments)
+    {
+        ID3D11ShaderResourceView* moments = m_shadowMoments->GetSRV();
+        context->PSSetShaderResources(ShadowMomentMaps::SLOT, 1, &moments);
+    }
+
+    // Bind the samplers together to ensure proper binding
+    ID3D11SamplerState* samplers[3] = { m_samplerState, m_shadowMapSampler, m_momentSampler };
+    context->PSSetSamplers(0, 3, samplers);
+}
+
+void Renderer::SortDrawOrder(const XMMATRIX& view)
+{
+    struct DrawItem
+    {
+        RenderObject* object;
+        float depth;
+        bool alphaTest;
+    };
+
+    std::vector<DrawItem> items;
+    items.reserve(m_renderObjects.size());
+    for (size_t i = 0; i < m_renderObjects.size(); ++i)
+    {
+        if (!m_objectVisible[i])
+            continue;
+
+        RenderObject* obj = m_renderObjects[i];
+
+        // View depth of the world-space bounds center
+        XMFLOAT3 center = obj->GetMesh()->GetBounds().Center;
+        XMVECTOR centerVS = XMVector3TransformCoord(
+            XMVector3TransformCoord(XMLoadFloat3(&center), obj->GetTransform().GetWorldMatrix()), view);
+        items.push_back({ obj, XMVectorGetZ(centerVS), obj->GetAlphaTest() });
+    }
+
+    // Opaque first, each group front to back so early-Z rejects as much as it can
+    std::stable_sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b)
+    {
+        if (a.alphaTest != b.alphaTest)
+            return !a.alphaTest;
+        return a.depth < b.depth;
+    });
+
+    m_drawOrder.clear();
+    m_opaqueDrawCount = 0;
+    for (const DrawItem& item : items)
+    {
+        m_drawOrder.push_back(item.object);
+        if (!item.alphaTest)
+            ++m_opaqueDrawCount;
+    }
+}
+
+void Renderer::DepthPrepass(ID3D11DeviceContext* context, const XMMATRIX& view, const XMMATRIX& proj)
+{
+    GpuProfileScope profile(m_gpuProfiler, context, "DepthPrepass");
+    m_depthPrepassPipeline->Bind(context);
+    m_depthPrepassShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+    const ConstantBufferBinding* perObject = m_depthPrepassShader->FindConstantBuffer("CBPerObject");
+
+    for (size_t i = 0; i < m_opaqueDrawCount; ++i)
+    {
+        RenderObject* obj = m_drawOrder[i];
+        XMMATRIX world = obj->GetTransform().GetWorldMatrix();
+
+        CBPerObject cbObj = {};
+        XMStoreFloat4x4(&cbObj.World, XMMatrixTranspose(world));
+        XMStoreFloat4x4(&cbObj.View, XMMatrixTranspose(view));
+        XMStoreFloat4x4(&cbObj.Projection, XMMatrixTranspose(proj));
 
-        m_cbShadow->Update(context, &cbShadow);
+        m_cbPerObject->Update(context, &cbObj, perObject);
+        obj->GetMesh()->Draw(context);
+        m_frameStats.CountDraw(obj->GetMesh()->GetIndexCount());
+    }
 
+    m_stats.prepassDraws = (uint32_t)m_opaqueDrawCount;
+}
 
-        // Draw all shadow casters
-        for (auto* obj : m_renderObjects)
+void Renderer::CollectMainPassStatistics(ID3D11DeviceContext* context)
+{
+    D3D11_QUERY_DATA_PIPELINE_STATISTICS data = {};
+    uint32_t withPrepass = 0;
+    while (m_mainPassStatistics->Collect(context, data, withPrepass))
+    {
+        m_frameStats.SetPipelineCounters(RENDER_PASS_MAIN, ToPipelineCounters(data));
+        m_stats.shadedPixels = data.PSInvocations;
+        if (withPrepass)
+            m_stats.shadedPixelsWithPrepass = data.PSInvocations;
+        else
+            m_stats.shadedPixelsWithoutPrepass = data.PSInvocations;
+
+        // Once per session, when both modes were seen (toggle with F4)
+        if (!m_overdrawLogged && m_stats.shadedPixelsWithPrepass && m_stats.shadedPixelsWithoutPrepass)
         {
-            CBPerObject cb{};
-            XMMATRIX world = obj->GetTransform().GetWorldMatrix();
-            XMStoreFloat4x4(&cb.World, XMMatrixTranspose(world));
-            XMStoreFloat4x4(&cb.LightViewProj, XMMatrixTranspose(m_lightViewProj[c]));
+            m_overdrawLogged = true;
+            char msg[192];
+            sprintf_s(msg, "Depth prepass: %llu shaded pixels with, %llu without (%.0f%% less shading)\n",
+                (unsigned long long)m_stats.shadedPixelsWithPrepass, (unsigned long long)m_stats.shadedPixelsWithoutPrepass,
+                m_stats.GetOverdrawReduction() * 100.0);
+            OutputDebugStringA(msg);
+        }
+    }
+}
 
-            m_cbPerObject->Update(context, &cb);
-            obj->GetMesh()->Draw(context);
+uint32_t Renderer::DrawObjects(ID3D11DeviceContext* context, const XMMATRIX& view, const XMMATRIX& proj,
+    const ScenePass& pass, RenderObject* const* objects, size_t count)
+{
+    pass.fallback->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+    const ConstantBufferBinding* perObject = pass.fallback->FindConstantBuffer("CBPerObject");
+
+    // Pass features are fixed for the frame, materials add theirs per draw.
+    // Material binds are skipped while the previous draw's are still bound.
+    const ShaderPermutationSpace& space = pass.variants->GetSpace();
+    ID3D11PixelShader* boundPS = nullptr;
+    ID3D11ShaderResourceView* boundTexture = nullptr;
+    ID3D11ShaderResourceView* boundNormalMap = nullptr;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        RenderObject* obj = objects[i];
+        XMMATRIX world = obj->GetTransform().GetWorldMatrix();
+
+        // Compute inverse transpose (ignore translation)
+        XMMATRIX worldInvTranspose = XMMatrixTranspose(XMMatrixInverse(nullptr, world));
+
+        CBPerObject cbObj = {};
+        XMStoreFloat4x4(&cbObj.World, XMMatrixTranspose(world));
+        XMStoreFloat4x4(&cbObj.WorldInvTranspose, XMMatrixTranspose(worldInvTranspose));
+        XMStoreFloat4x4(&cbObj.View, XMMatrixTranspose(view));
+        XMStoreFloat4x4(&cbObj.Projection, XMMatrixTranspose(proj));
+
+        m_cbPerObject->Update(context, &cbObj, perObject);
+
+        XMFLOAT3 objPos = obj->GetTransform().GetPosition();
+        XMFLOAT3 camPos = m_camera.GetPosition();
+        float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&objPos) - XMLoadFloat3(&camPos)));
+
+        ID3D11ShaderResourceView* texture = ResolveTexture(obj, distance);
+        if (texture)
+        {
+            m_frameStats.CountBind(texture != boundTexture);
+            if (texture != boundTexture)
+            {
+                context->PSSetShaderResources(0, 1, &texture);
+                boundTexture = texture;
+            }
+        }
+
+        ShaderVariantKey key = pass.passKey;
+        key = space.Set(key, pass.featureNormalMap, obj->GetNormalMap() ? 1 : 0);
+        key = space.Set(key, pass.featureAlphaTest, obj->GetAlphaTest() ? 1 : 0);
+
+        ID3D11ShaderResourceView* normalMap = obj->GetNormalMap();
+        if (normalMap)
+        {
+            m_frameStats.CountBind(normalMap != boundNormalMap);
+            if (normalMap != boundNormalMap)
+            {
+                context->PSSetShaderResources(2, 1, &normalMap);
+                boundNormalMap = normalMap;
+            }
         }
+
+        // A variant that failed to build falls back to the generic shader
+        ID3D11PixelShader* ps = pass.variants->Get(key);
+        if (!ps)
+            ps = pass.fallback->GetPixelShader();
+        m_frameStats.CountBind(ps != boundPS);
+        if (ps != boundPS)
+        {
+            context->PSSetShader(ps, nullptr, 0);
+            boundPS = ps;
+        }
+
+        obj->GetMesh()->Draw(context);
+        m_frameStats.CountDraw(obj->GetMesh()->GetIndexCount());
     }
 
-    context->RSSetState(nullptr);
+    return (uint32_t)count;
 }
 
-
 void Renderer::MainRenderPass()
 {
     ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, context, "MainRenderPass");
+    SetStatsPass(context, RENDER_PASS_MAIN);
     ID3D11RenderTargetView* rtv = m_deviceResources->GetRenderTargetView();
     ID3D11DepthStencilView* dsv = m_deviceResources->GetDepthStencilView();
     context->OMSetRenderTargets(1, &rtv, dsv);
@@ -622,9 +2577,6 @@ void Renderer::MainRenderPass()
     if (dsv)
         context->ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH, 1.0f, 0);
 
-    context->RSSetState(m_rasterizerState);
-    context->OMSetDepthStencilState(m_depthStencilState, 0);
-
     // -----------------------------
     // Camera + Matrices (camera already updated in Render())
     // -----------------------------
@@ -635,163 +2587,364 @@ void Renderer::MainRenderPass()
         m_nearZ,
         m_farZ);
 
-    // -----------------------------
-    // Compute Shadow Matrices
-    // -----------------------------
-    XMFLOAT3 dir = m_lights[0].Direction;
-    XMVECTOR lightDir = XMVector3Normalize(XMLoadFloat3(&dir));
+    UpdateFrameLighting(context, view, m_shader);
+    CollectMainPassStatistics(context);
 
-    float prevSplit = m_nearZ;
-    std::vector<XMVECTOR> frustumCorners;
+    m_stats.depthPrepass = m_depthPrepass;
+    m_stats.screenPixels = (uint64_t)m_deviceResources->GetWidth() * m_deviceResources->GetHeight();
+    m_stats.prepassDraws = 0;
 
-    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    if (IsGpuDriven())
     {
-        float splitDist = m_cascadeSplits[i];
-
-        GetFrustrumConrersWS(view, proj, prevSplit, splitDist, frustumCorners);
-
-        XMVECTOR center = XMVectorZero();
-        for (auto& v : frustumCorners)
-            center += v;
-        center /= (float)frustumCorners.size();
+        MainRenderPassIndirect(context, view, proj);
+        return;
+    }
 
-        XMVECTOR lightPos = center - lightDir * 50.0f;
+    SortDrawOrder(view);
+    m_frameStats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, m_drawOrder.size());
+    m_frameStats.Add(FRAME_COUNTER_CULLED_OBJECTS, m_renderObjects.size() - m_drawOrder.size());
 
-        XMMATRIX lightView = XMMatrixLookAtLH(
-            lightPos,
-            center,
-            XMVectorSet(0, 1, 0, 0)
-        );
+    // One query spans the prepass too (it shades nothing), as in the GPU-driven path
+    m_mainPassStatistics->Begin(context, m_depthPrepass ? 1 : 0);
+    if (m_depthPrepass)
+    {
+        SetStatsPass(context, RENDER_PASS_PREPASS);
+        DepthPrepass(context, view, proj);
+        SetStatsPass(context, RENDER_PASS_MAIN);
+    }
 
-        XMVECTOR minExt = XMVectorSet(FLT_MAX, FLT_MAX, FLT_MAX, 1);
-        XMVECTOR maxExt = XMVectorSet(-FLT_MAX, -FLT_MAX, -FLT_MAX, 1);
+    // -----------------------------
+    // Draw objects
+    // -----------------------------
 
-        for (auto& v : frustumCorners)
-        {
-            XMVECTOR vLS = XMVector3TransformCoord(v, lightView);
-            minExt = XMVectorMin(minExt, vLS);
-            maxExt = XMVectorMax(maxExt, vLS);
-        }
+    ScenePass pass;
+    pass.variants = m_forwardVariants;
+    pass.fallback = m_shader;
+    pass.passKey = GetLightingKey();
+    pass.featureNormalMap = m_featureNormalMap;
+    pass.featureAlphaTest = m_featureAlphaTest;
 
-        XMMATRIX lightProj = XMMatrixOrthographicOffCenterLH(
-            XMVectorGetX(minExt), XMVectorGetX(maxExt),
-            XMVectorGetY(minExt), XMVectorGetY(maxExt),
-            XMVectorGetZ(minExt) - 10.0f,
-            XMVectorGetZ(maxExt) + 10.0f
-        );
+    RenderObject* const* objects = m_drawOrder.data();
+    size_t alphaTestCount = m_drawOrder.size() - m_opaqueDrawCount;
+    m_stats.mainDraws = 0;
 
-        m_lightViewProj[i] = lightView * lightProj;
-        prevSplit = splitDist;
-    }
+    // Opaque objects: shaded once per pixel after the prepass
+    (m_depthPrepass ? m_mainEqualPipeline : m_mainPipeline)->Bind(context);
+    BindLighting(context, m_shader);
+    m_stats.mainDraws += DrawObjects(context, view, proj, pass, objects, m_opaqueDrawCount);
 
-    // Update Shadow CB
-    CBShadow cbShadow = {};
-    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    // Alpha-tested objects: not in the prepass, regular depth test
+    if (alphaTestCount)
     {
-        XMStoreFloat4x4(
-            &cbShadow.LightViewProj[i],
-            XMMatrixTranspose(m_lightViewProj[i])
-        );
+        m_mainPipeline->Bind(context);
+        m_stats.mainDraws += DrawObjects(context, view, proj, pass, objects + m_opaqueDrawCount, alphaTestCount);
     }
 
-    cbShadow.CascadeSplits = {
-        m_cascadeSplits[0],
-        m_cascadeSplits[1],
-        m_cascadeSplits[2],
-        m_cascadeSplits[3]
-    };
-
-    m_cbShadow->Update(context, &cbShadow);
+    m_mainPassStatistics->End(context);
+}
 
-    // -----------------------------
-    // Lighting
-    // -----------------------------
-    CBLight cb = {};
-    cb.LightCount = (int)m_lights.size();
-    cb.CameraPosition = m_camera.GetPosition();
+void Renderer::MainRenderPassIndirect(ID3D11DeviceContext* context, const XMMATRIX& view, const XMMATRIX& proj)
+{
+    // Instance counts of a few frames ago, then this frame's two phases
+    uint32_t visible[2] = {};
+    if (m_gpuCuller->Collect(context, visible))
+    {
+        m_stats.gpuCulling.mainVisible = visible[0] + visible[1];
+        m_stats.gpuCulling.mainLate = visible[1];
+    }
+    uint32_t objectCount = m_cullBatch.GetObjectCount();
+    uint32_t mainVisible = (std::min)(m_stats.gpuCulling.mainVisible, objectCount);
+    m_frameStats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, mainVisible);
+    m_frameStats.Add(FRAME_COUNTER_CULLED_OBJECTS, objectCount - mainVisible);
+
+    // Early phase: what was visible last frame, frustum only
+    OcclusionMatrix viewProj = ToOcclusionMatrix(view * proj);
+    m_cullViews[CULL_VIEW_MAIN] = CullKernel::MakeView(viewProj, CULL_VIEW_EARLY);
+    m_gpuCuller->Dispatch(context, m_cullBatch, m_cullViews, CULL_VIEW_MAIN, 1, nullptr, 0, 0, 0);
+
+    // View and projection once, the transforms come from the instance stream
+    CBPerObject cbView = {};
+    XMStoreFloat4x4(&cbView.View, XMMatrixTranspose(view));
+    XMStoreFloat4x4(&cbView.Projection, XMMatrixTranspose(proj));
+    m_cbPerObject->Update(context, &cbView, m_instancedShader->FindConstantBuffer("CBPerObject"));
+    m_gpuCuller->BindInstances(context);
+
+    ScenePass pass;
+    pass.variants = m_forwardVariants;
+    pass.fallback = m_shader;
+    pass.passKey = GetLightingKey();
+    pass.featureNormalMap = m_featureNormalMap;
+    pass.featureAlphaTest = m_featureAlphaTest;
+    m_stats.mainDraws = 0;
+
+    uint32_t bucketCount = (uint32_t)m_indirectBuckets.size();
+    uint32_t alphaTestBuckets = bucketCount - m_opaqueBucketCount;
+
+    // The early phase's depth: the prepass, or the shaded objects without one
+    m_mainPassStatistics->Begin(context, m_depthPrepass ? 1 : 0);
+    if (m_depthPrepass)
+    {
+        SetStatsPass(context, RENDER_PASS_PREPASS);
+        m_instancedPrepassPipeline->Bind(context);
+        m_instancedPrepassShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+        m_stats.prepassDraws = DrawBucketsIndirect(context, nullptr, CULL_VIEW_MAIN, 0, m_opaqueBucketCount);
+        SetStatsPass(context, RENDER_PASS_MAIN);
+    }
+    else
+    {
+        m_instancedPipeline->Bind(context);
+        m_instancedShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+        BindLighting(context, m_shader);
+        m_stats.mainDraws += DrawBucketsIndirect(context, &pass, CULL_VIEW_MAIN, 0, bucketCount);
+    }
 
-    for (int i = 0; i < cb.LightCount; i++)
+    // Hi-Z of that depth, then the late phase: every object against it, drawing only what the early phase missed
+    uint32_t lateFlags = CULL_VIEW_LATE;
+    uint32_t width = (uint32_t)m_deviceResources->GetWidth();
+    uint32_t height = (uint32_t)m_deviceResources->GetHeight();
+    if (m_hiZPyramid && m_hiZPyramid->Resize(width, height))
     {
-        cb.Lights[i] = m_lights[i];
+        GpuProfileScope profile(m_gpuProfiler, context, "HiZBuild");
+
+        // The depth buffer is read, so it cannot stay bound for writing
+        ID3D11RenderTargetView* rtv = m_deviceResources->GetRenderTargetView();
+        context->OMSetRenderTargets(1, &rtv, nullptr);
+        m_hiZPyramid->Build(context, m_deviceResources->GetDepthSRV());
+        context->OMSetRenderTargets(1, &rtv, m_deviceResources->GetDepthStencilView());
+        lateFlags |= CULL_VIEW_HIZ;
     }
+    m_stats.gpuCulling.hizLevels = (lateFlags & CULL_VIEW_HIZ) ? m_hiZPyramid->GetLevelCount() : 0;
 
-    m_cbLight->Update(context, &cb);
+    m_cullViews[CULL_VIEW_MAIN_LATE] = CullKernel::MakeView(viewProj, lateFlags);
+    if (lateFlags & CULL_VIEW_HIZ)
+    {
+        m_gpuCuller->Dispatch(context, m_cullBatch, m_cullViews, CULL_VIEW_MAIN_LATE, 1, m_hiZPyramid->GetSRV(),
+            m_hiZPyramid->GetWidth(), m_hiZPyramid->GetHeight(), m_hiZPyramid->GetLevelCount());
+    }
+    else
+    {
+        m_gpuCuller->Dispatch(context, m_cullBatch, m_cullViews, CULL_VIEW_MAIN_LATE, 1, nullptr, 0, 0, 0);
+    }
+    m_gpuCuller->QueueReadback(context, CULL_VIEW_MAIN, 2, bucketCount);
+    m_gpuCuller->BindInstances(context);
 
-    // -----------------------------
-    // Bind pipeline
-    // -----------------------------
-    m_shader->Bind(context);
+    if (m_depthPrepass)
+    {
+        SetStatsPass(context, RENDER_PASS_PREPASS);
+        m_stats.prepassDraws += DrawBucketsIndirect(context, nullptr, CULL_VIEW_MAIN_LATE, 0, m_opaqueBucketCount);
+        SetStatsPass(context, RENDER_PASS_MAIN);
+
+        // Opaque objects of both phases shaded once per pixel, alpha-tested ones with the regular depth test
+        m_instancedEqualPipeline->Bind(context);
+        m_instancedShader->BindConstantBuffer(context, "CBPerObject", m_cbPerObject->Get());
+        BindLighting(context, m_shader);
+        m_stats.mainDraws += DrawBucketsIndirect(context, &pass, CULL_VIEW_MAIN, 0, m_opaqueBucketCount);
+        m_stats.mainDraws += DrawBucketsIndirect(context, &pass, CULL_VIEW_MAIN_LATE, 0, m_opaqueBucketCount);
+
+        if (alphaTestBuckets)
+        {
+            m_instancedPipeline->Bind(context);
+            m_stats.mainDraws += DrawBucketsIndirect(context, &pass, CULL_VIEW_MAIN, m_opaqueBucketCount, alphaTestBuckets);
+            m_stats.mainDraws += DrawBucketsIndirect(context, &pass, CULL_VIEW_MAIN_LATE, m_opaqueBucketCount, alphaTestBuckets);
+        }
+    }
+    else
+    {
+        // Still bound from the early phase
+        m_stats.mainDraws += DrawBucketsIndirect(context, &pass, CULL_VIEW_MAIN_LATE, 0, bucketCount);
+    }
 
-    ID3D11Buffer* vsCB = m_cbPerObject->Get();
-    context->VSSetConstantBuffers(0, 1, &vsCB);
+    m_mainPassStatistics->End(context);
+    m_stats.gpuCulling.indirectDraws += m_stats.prepassDraws + m_stats.mainDraws;
+}
 
-    ID3D11Buffer* psCB = m_cbLight->Get();
-    context->PSSetConstantBuffers(1, 1, &psCB);
+uint32_t Renderer::DrawBucketsIndirect(ID3D11DeviceContext* context, const ScenePass* pass, uint32_t view,
+    uint32_t firstBucket, uint32_t bucketCount)
+{
+    uint32_t drawsPerView = m_cullBatch.GetBucketCount();
+    ID3D11PixelShader* boundPS = nullptr;
+    ID3D11ShaderResourceView* boundTexture = nullptr;
+    ID3D11ShaderResourceView* boundNormalMap = nullptr;
 
-    ID3D11Buffer* shadowCB = m_cbShadow->Get();
-    context->VSSetConstantBuffers(2, 1, &shadowCB);
-    context->PSSetConstantBuffers(2, 1, &shadowCB);
+    for (uint32_t b = firstBucket; b < firstBucket + bucketCount; ++b)
+    {
+        const IndirectBucket& bucket = m_indirectBuckets[b];
 
-    context->PSSetShaderResources(1, 1, &m_shadowMapSRVArray);
-    
-    // Bind both samplers together to ensure proper binding
-    ID3D11SamplerState* samplers[2] = { m_samplerState, m_shadowMapSampler };
-    context->PSSetSamplers(0, 2, samplers);
+        // Material of the bucket; a null pass is depth only
+        if (pass)
+        {
+            RenderObject* obj = bucket.material;
+            ID3D11ShaderResourceView* texture = ResolveTexture(obj, bucket.nearestDistance);
+            if (texture)
+            {
+                m_frameStats.CountBind(texture != boundTexture);
+                if (texture != boundTexture)
+                {
+                    context->PSSetShaderResources(0, 1, &texture);
+                    boundTexture = texture;
+                }
+            }
+
+            ID3D11ShaderResourceView* normalMap = obj->GetNormalMap();
+            if (normalMap)
+            {
+                m_frameStats.CountBind(normalMap != boundNormalMap);
+                if (normalMap != boundNormalMap)
+                {
+                    context->PSSetShaderResources(2, 1, &normalMap);
+                    boundNormalMap = normalMap;
+                }
+            }
+
+            const ShaderPermutationSpace& space = pass->variants->GetSpace();
+            ShaderVariantKey key = pass->passKey;
+            key = space.Set(key, pass->featureNormalMap, normalMap ? 1 : 0);
+            key = space.Set(key, pass->featureAlphaTest, obj->GetAlphaTest() ? 1 : 0);
+
+            ID3D11PixelShader* ps = pass->variants->Get(key);
+            if (!ps)
+                ps = pass->fallback->GetPixelShader();
+            m_frameStats.CountBind(ps != boundPS);
+            if (ps != boundPS)
+            {
+                context->PSSetShader(ps, nullptr, 0);
+                boundPS = ps;
+            }
+        }
 
- 
+        bucket.mesh->DrawIndirect(context, m_gpuCuller->GetArgs(),
+            GpuCuller::GetArgsOffset(CullBatch::GetDrawIndex(view, b, drawsPerView)));
+        m_frameStats.CountIndirectDraw();
+    }
 
+    return bucketCount;
+}
 
+void Renderer::DeferredRenderPass()
+{
+    ID3D11Device* device = m_deviceResources->GetDevice();
+    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, context, "DeferredRenderPass");
+    SetStatsPass(context, RENDER_PASS_DEFERRED);
 
-    // -----------------------------
-    // Draw objects
-    // -----------------------------
-    float dt = 0.016f; // for rotation animation
-    for (size_t i = 0; i < m_renderObjects.size(); ++i)
+    if (!m_gbuffer->Resize(device, (uint32_t)m_deviceResources->GetWidth(), (uint32_t)m_deviceResources->GetHeight()))
     {
-        RenderObject* obj = m_renderObjects[i];
-
-        if (i < m_renderObjects.size() - 1)
-        {
-            XMFLOAT3 axis = (i == 0)
-                ? XMFLOAT3(0, 1, 0)
-                : XMFLOAT3(1, 0, 0);
+        OutputDebugStringA("Failed to create the G-buffer, switching to forward rendering\n");
+        m_renderPath = RENDER_PATH_FORWARD;
+        MainRenderPass();
+        return;
+    }
 
+    D3D11_VIEWPORT vp{};
+    vp.Width = (float)m_deviceResources->GetWidth();
+    vp.Height = (float)m_deviceResources->GetHeight();
+    vp.MinDepth = 0.0f;
+    vp.MaxDepth = 1.0f;
+    context->RSSetViewports(1, &vp);
 
-            obj->GetTransform().RotateAxisAngle(axis, dt * (i + 1));
-        }
+    XMMATRIX view = m_camera.GetViewMatrix();
+    XMMATRIX proj = XMMatrixPerspectiveFovLH(
+        XM_PIDIV4,
+        m_deviceResources->GetAspectRatio(),
+        m_nearZ,
+        m_farZ);
 
+    UpdateFrameLighting(context, view, m_deferredLightShader);
 
+    // -----------------------------
+    // Geometry: material attributes only, overdraw costs no lighting
+    // -----------------------------
+    m_gbuffer->BeginGeometryPass(context);
+    m_gbufferPipeline->Bind(context);
+    context->PSSetSamplers(0, 1, &m_samplerState);
+
+    ScenePass pass;
+    pass.variants = m_gbufferVariants;
+    pass.fallback = m_gbufferShader;
+    pass.featureNormalMap = m_gbufferFeatureNormalMap;
+    pass.featureAlphaTest = m_gbufferFeatureAlphaTest;
+
+    // Front to back helps the geometry pass too, no prepass needed here
+    SortDrawOrder(view);
+    m_frameStats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, m_drawOrder.size());
+    m_frameStats.Add(FRAME_COUNTER_CULLED_OBJECTS, m_renderObjects.size() - m_drawOrder.size());
+    DrawObjects(context, view, proj, pass, m_drawOrder.data(), m_drawOrder.size());
 
-        XMMATRIX world = obj->GetTransform().GetWorldMatrix();
+    // -----------------------------
+    // Lighting: one fullscreen draw, the depth test skips the sky
+    // -----------------------------
+    CBDeferred cbDeferred = {};
+    XMStoreFloat4x4(&cbDeferred.InvViewProj, XMMatrixTranspose(XMMatrixInverse(nullptr, view * proj)));
+    XMStoreFloat4x4(&cbDeferred.View, XMMatrixTranspose(view));
+    m_cbDeferred->Update(context, &cbDeferred, m_deferredLightShader->FindConstantBuffer("CBDeferred"));
 
-        // Compute inverse transpose (ignore translation)
-        XMMATRIX worldInvTranspose = XMMatrixTranspose(XMMatrixInverse(nullptr, world));
+    float clearColor[4] = { m_clearColor.x, m_clearColor.y, m_clearColor.z, m_clearColor.w };
+    m_gbuffer->BeginLightPass(context, clearColor);
 
-        CBPerObject cbObj = {};
-        XMStoreFloat4x4(&cbObj.World, XMMatrixTranspose(world));
-        XMStoreFloat4x4(&cbObj.WorldInvTranspose, XMMatrixTranspose(worldInvTranspose));
-        XMStoreFloat4x4(&cbObj.View, XMMatrixTranspose(view));
-        XMStoreFloat4x4(&cbObj.Projection, XMMatrixTranspose(proj));
-        //XMStoreFloat4x4(&cbObj.LightViewProj, XMMatrixTranspose(m_lightViewProj[0]));
+    m_deferredLightPipeline->Bind(context);
+    BindLighting(context, m_deferredLightShader);
+    m_deferredLightShader->BindConstantBuffer(context, "CBDeferred", m_cbDeferred->Get());
 
+    ID3D11PixelShader* lightPS = m_deferredLightVariants->Get(GetLightingKey());
+    if (!lightPS)
+        lightPS = m_deferredLightShader->GetPixelShader();
+    context->PSSetShader(lightPS, nullptr, 0);
 
+    UINT stride = sizeof(float) * 5;
+    UINT offset = 0;
+    context->IASetVertexBuffers(0, 1, &m_fullscreenVB, &stride, &offset);
+    context->Draw(4, 0);
+    m_frameStats.CountStripDraw(4);
 
-        m_cbPerObject->Update(context, &cbObj);
+    // -----------------------------
+    // Composite onto the back buffer
+    // -----------------------------
+    ID3D11RenderTargetView* rtv = m_deviceResources->GetRenderTargetView();
+    context->OMSetRenderTargets(1, &rtv, nullptr);
+    m_compositePipeline->Bind(context);
+
+    ID3D11ShaderResourceView* lightBuffer = m_gbuffer->GetLightSRV();
+    context->PSSetShaderResources(0, 1, &lightBuffer);
+    context->Draw(4, 0);
+    m_frameStats.CountStripDraw(4);
+
+    // The light buffer and G-buffer are render targets again next frame
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    context->PSSetShaderResources(0, 1, &nullSRV);
+    m_gbuffer->UnbindInputs(context);
+}
 
-        ID3D11ShaderResourceView* texture = obj->GetTexture();
-        if (texture)
-        {
-            context->PSSetShaderResources(0, 1, &texture);
-        }
+ID3D11ShaderResourceView* Renderer::ResolveTexture(RenderObject* obj, float distance)
+{
+    TextureHandle handle = obj->GetTextureHandle();
+    if (handle == INVALID_TEXTURE_HANDLE)
+        return obj->GetTexture() ? obj->GetTexture() : m_defaultTexture;
 
-        obj->GetMesh()->Draw(context);
+    // Feed back the mip this draw needs from its projected texel density
+    uint32_t width = m_textureStreamer->GetWidth(handle);
+    if (width > 0)
+    {
+        XMFLOAT3 scale = obj->GetTransform().GetScale();
+        XMFLOAT3 extents = obj->GetMesh()->GetBounds().Extents;
+        float maxScale = (std::max)(scale.x, (std::max)(scale.y, scale.z));
+        float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&extents))) * maxScale;
+
+        uint32_t size = (std::max)(width, m_textureStreamer->GetHeight(handle));
+        m_textureStreamer->RequestMip(handle, TextureStreamer::ComputeDesiredMip(
+            size, radius, distance, XM_PIDIV4, (float)m_deviceResources->GetHeight()));
     }
 
+    ID3D11ShaderResourceView* srv = m_textureUploader->GetShaderResourceView(handle);
+    if (srv)
+        return srv;
+    return obj->GetTexture() ? obj->GetTexture() : m_defaultTexture;
 }
 
 void Renderer::RenderShadowDebug()
 {
     ID3D11DeviceContext* ctx = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, ctx, "ShadowDebug");
+    SetStatsPass(ctx, RENDER_PASS_DEBUG);
     ID3D11RenderTargetView* rtv = m_deviceResources->GetRenderTargetView();
 
     ctx->OMSetRenderTargets(1, &rtv, nullptr);
@@ -809,30 +2962,53 @@ void Renderer::RenderShadowDebug()
     UINT stride = sizeof(float) * 5;  // 3 floats (pos) + 2 floats (uv) = 20 bytes
     UINT offset = 0;
     ctx->IASetVertexBuffers(0, 1, &m_fullscreenVB, &stride, &offset);
-    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
-    m_shadowDebugShader->Bind(ctx);  // This should set the input layout
+    m_shadowDebugPipeline->Bind(ctx);
 
     ctx->PSSetShaderResources(0, 1, &m_shadowMapSRVArray);
     ctx->PSSetSamplers(0, 1, &m_samplerState);
 
-    ctx->OMSetDepthStencilState(nullptr, 0);
-    ctx->RSSetState(nullptr);
-
     ctx->Draw(4, 0);
+    m_frameStats.CountStripDraw(4);
 }
 
 void Renderer::ComputeCascadeSplits()
 {
-	for (uint32_t i = 0; i < NUM_CASCADES; i++)
+    bool sdsm = m_cascadeSplitMode == CASCADE_SPLIT_SDSM && m_depthReduction;
+    m_stats.cascadeSplitMode = sdsm ? CASCADE_SPLIT_SDSM : CASCADE_SPLIT_FIXED;
+    if (!sdsm)
     {
-        float p = (i + 1) / (float)NUM_CASCADES;
-        
-		float logSplit = m_nearZ * powf(m_farZ / m_nearZ, p);
-		float linearSplit = m_nearZ + (m_farZ - m_nearZ) * p;
-
-		m_cascadeSplits[i] = m_cascadeLambda * logSplit + (1.0f - m_cascadeLambda) * linearSplit;
+        m_cascadeNearZ = m_nearZ;
+        CascadeShadows::ComputeSplits(m_nearZ, m_farZ, m_cascadeLambda, NUM_CASCADES, m_cascadeSplits);
+        return;
     }
+
+    // Whatever finished since last frame; until then the previous range holds
+    m_depthReduction->Collect(m_deviceResources->GetDeviceContext(), m_nearZ, m_farZ, m_visibleDepth);
+    m_stats.visibleDepth = m_visibleDepth;
+
+    ShadowPartition partitions[NUM_CASCADES];
+    DepthReduction::ComputePartitions(m_visibleDepth, m_nearZ, m_farZ, m_sdsmSettings, NUM_CASCADES, partitions);
+    m_cascadeNearZ = partitions[0].nearZ;
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+        m_cascadeSplits[i] = partitions[i].farZ;
+}
+
+void Renderer::ReduceVisibleDepth()
+{
+    if (!m_depthReduction)
+        return;
+
+    ID3D11DeviceContext* context = m_deviceResources->GetDeviceContext();
+    GpuProfileScope profile(m_gpuProfiler, context, "ReduceVisibleDepth");
+    ID3D11ShaderResourceView* depth = (m_renderPath == RENDER_PATH_DEFERRED)
+        ? m_gbuffer->GetDepthSRV()
+        : m_deviceResources->GetDepthSRV();
+
+    // The depth buffer is read, so it cannot stay bound for writing
+    context->OMSetRenderTargets(0, nullptr, nullptr);
+    m_depthReduction->Dispatch(context, depth,
+        (uint32_t)m_deviceResources->GetWidth(), (uint32_t)m_deviceResources->GetHeight());
 }
 
 
@@ -845,11 +3021,23 @@ void Renderer::SetClearColor(float r, float g, float b, float a)
 
 void Renderer::Release()
 {
-    if (m_rasterizerState)  m_rasterizerState->Release();
-    if (m_depthStencilState) m_depthStencilState->Release();
-    if (m_brickTexture)   m_brickTexture->Release();     
-    if (m_groundTexture)  m_groundTexture->Release();   
-    if (m_samplerState)     m_samplerState->Release();
+    // Build jobs reference the caches, the streamer and the variants below
+    delete m_hotReloader;
+    m_hotReloader = nullptr;
+
+    // Streamer first: it waits for in-flight decodes and evicts through the uploader
+    delete m_textureStreamer;
+    delete m_textureUploader;
+    delete m_textureDecoder;
+    m_textureStreamer = nullptr;
+    m_textureUploader = nullptr;
+    m_textureDecoder = nullptr;
+    if (m_defaultTexture) m_defaultTexture->Release();
+    if (m_brickCookedTexture) m_brickCookedTexture->Release();
+    if (m_groundCookedTexture) m_groundCookedTexture->Release();
+    m_defaultTexture = nullptr;
+    m_brickCookedTexture = nullptr;
+    m_groundCookedTexture = nullptr;
     for (uint32_t i = 0; i < NUM_CASCADES; ++i)
     {
         if (m_shadowCascadeDSVs[i]) m_shadowCascadeDSVs[i]->Release();
@@ -857,8 +3045,23 @@ void Renderer::Release()
     if (m_shadowMapDSVArray) m_shadowMapDSVArray->Release();
     if (m_shadowMapSRVArray) m_shadowMapSRVArray->Release();
     if (m_shadowMapArray) m_shadowMapArray->Release();
-    if (m_shadowMapSampler) m_shadowMapSampler->Release();
-    if (m_shadowRasterizerState) m_shadowRasterizerState->Release();
+    for (uint32_t i = 0; i < NUM_CASCADES; ++i)
+    {
+        if (m_shadowCacheDSVs[i]) m_shadowCacheDSVs[i]->Release();
+    }
+    if (m_shadowCacheDSVArray) m_shadowCacheDSVArray->Release();
+    if (m_shadowCacheArray) m_shadowCacheArray->Release();
+    delete m_shadowCache;
+    delete m_shadowMoments;
+    delete m_shadowAtlas;
+    delete m_shadowAtlasMaps;
+    delete m_atlasClearShader;
+    delete m_occlusion;
+    delete m_gpuCuller;
+    delete m_hiZPyramid;
+    delete m_instancedShader;
+    delete m_instancedPrepassShader;
+    delete m_instancedShadowShader;
 
     delete m_shader;
     delete m_mesh;
@@ -866,10 +3069,40 @@ void Renderer::Release()
     delete m_cbPerObject;
     delete m_cbLight;
     delete m_cbShadow;
+    delete m_lightClusterBuffers;
+    delete m_lightClusters;
     delete m_shadowShader;
+    delete m_shadowDebugShader;
+    delete m_shadowCascadesShader;
+    delete m_forwardVariants;
+    delete m_gbufferVariants;
+    delete m_deferredLightVariants;
+    delete m_gbufferShader;
+    delete m_deferredLightShader;
+    delete m_compositeShader;
+    delete m_cbDeferred;
+    delete m_cbEvsm;
+    delete m_evsmConvertShader;
+    delete m_evsmBlurShader;
+    delete m_gbuffer;
+    delete m_depthPrepassShader;
+    delete m_depthReduction;
+    delete m_mainPassStatistics;
+    delete m_gpuProfiler;
+    for (GpuPassStatistics*& statistics : m_passStatistics)
+    {
+        delete statistics;
+        statistics = nullptr;
+    }
+    delete m_statsText;
+    delete m_debugTextShader;
+    delete m_stateCache;
+    delete m_shaderCache;
+    delete m_shaderCompiler;
 
     for (RenderObject* obj : m_renderObjects)
         delete obj;
 
     m_renderObjects.clear();
+    m_scene.Release();
 }
@@ -2,12 +2,34 @@
 
 #include <DirectXMath.h>
 #include <vector>
+#include <chrono>
 #include "DeviceResources.h"
 #include "Camera.h"
 #include "RenderObject.h"
 #include "Light.h"
 #include "CBLight.h"
 #include "ConstantBuffer.h"
+#include "GltfImporterD3D11.h"
+#include "TextureStreamerD3D11.h"
+#include "ShaderCacheD3D11.h"
+#include "HotReloadD3D11.h"
+#include "PipelineStateD3D11.h"
+#include "LightClustersD3D11.h"
+#include "GBufferD3D11.h"
+#include "GpuQueriesD3D11.h"
+#include "CascadeShadows.h"
+#include "ShadowCache.h"
+#include "DepthReductionD3D11.h"
+#include "ShadowFilter.h"
+#include "ShadowMoments.h"
+#include "ShadowMomentsD3D11.h"
+#include "ShadowAtlasD3D11.h"
+#include "OcclusionCulling.h"
+#include "GpuCullingD3D11.h"
+#include "HiZPyramidD3D11.h"
+#include "ProfilerD3D11.h"
+#include "FrameStats.h"
+#include "DebugTextD3D11.h"
 
 
 
@@ -24,6 +46,116 @@ namespace Engine::Graphics
     class Mesh;
     class ConstantBuffer;
 
+    // Forward pixel shader keywords, values match SimplePS.hlsl
+    enum ShadowQuality : uint32_t
+    {
+        SHADOW_QUALITY_OFF = 0,
+        SHADOW_QUALITY_HARD = 1,
+        SHADOW_QUALITY_SOFT = 2,        // gather PCF, kernel sized per cascade
+        SHADOW_QUALITY_POISSON = 3,     // 16-tap Poisson disk
+        SHADOW_QUALITY_EVSM = 4         // prefiltered moments, one trilinear fetch
+    };
+
+    enum LightMix : uint32_t
+    {
+        LIGHT_MIX_DIRECTIONAL = 0,
+        LIGHT_MIX_POINT = 1,
+        LIGHT_MIX_MIXED = 2
+    };
+
+    enum RenderPath : uint32_t
+    {
+        RENDER_PATH_FORWARD = 0,    // material + lighting per fragment
+        RENDER_PATH_DEFERRED = 1    // G-buffer, fullscreen light pass, composite
+    };
+
+    enum ShadowPassMode : uint32_t
+    {
+        SHADOW_PASS_PER_CASCADE = 0,    // one DSV and one draw per object per cascade
+        SHADOW_PASS_SINGLE = 1          // all cascades at once, instanced per overlapped cascade
+    };
+
+    enum CascadeSplitMode : uint32_t
+    {
+        CASCADE_SPLIT_FIXED = 0,    // log/linear blend over near..far
+        CASCADE_SPLIT_SDSM = 1      // the same blend over the depth range on screen (last frame's depth buffer)
+    };
+
+    // Objects sharing a mesh and material: one indirect draw per view
+    struct IndirectBucket
+    {
+        Mesh* mesh = nullptr;
+        RenderObject* material = nullptr;  // first object of the bucket, its textures and flags
+        float nearestDistance = 0.0f;      // texture streaming feedback for the bucket
+    };
+
+    // A pass that draws the scene objects: its pixel shader variants and the
+    // material feature ids set per draw
+    struct ScenePass
+    {
+        PixelShaderVariants* variants = nullptr;
+        Shader* fallback = nullptr;         // generic program, used when a variant failed
+        ShaderVariantKey passKey = 0;
+        uint32_t featureNormalMap = 0;
+        uint32_t featureAlphaTest = 0;
+    };
+
+    // Main view counters. Shaded pixels are pixel shader invocations of the
+    // forward pass, read back a few frames late.
+    struct RenderStats
+    {
+        bool depthPrepass = false;
+        uint32_t prepassDraws = 0;
+        uint32_t mainDraws = 0;
+        uint64_t screenPixels = 0;
+        uint64_t shadedPixels = 0;
+        uint64_t shadedPixelsWithPrepass = 0;       // latest sample with the prepass on
+        uint64_t shadedPixelsWithoutPrepass = 0;    // and off
+
+        ShadowPassMode shadowPassMode = SHADOW_PASS_SINGLE;
+        uint32_t shadowDraws = 0;
+        uint32_t shadowInstances = 0;           // cascades rendered, summed over objects
+        uint32_t shadowConstantUpdates = 0;
+        uint32_t shadowCascadesUpdated = 0;
+        uint32_t shadowStaticRenders = 0;       // cascades whose static casters were redrawn
+        uint32_t shadowCascadesSkipped = 0;     // far cascades waiting for their round-robin turn
+        uint32_t shadowCasters[NUM_CASCADES] = {};  // objects drawn into each cascade after culling
+
+        CascadeSplitMode cascadeSplitMode = CASCADE_SPLIT_FIXED;
+        DepthRange visibleDepth;                // SDSM input, a frame or more old
+
+        // Shadow map fetches (a gather counts once) of one directional light sample
+        uint32_t shadowKernelSize[NUM_CASCADES] = {};
+        uint32_t shadowFetchesPenumbra[NUM_CASCADES] = {};  // full kernel, after the early-out taps if enabled
+        uint32_t shadowFetchesEarlyOut = 0;                 // fully lit or shadowed, 0 without early-out
+        uint32_t shadowMomentCascades = 0;                  // EVSM slices converted, blurred and mipped this frame
+
+        // Point light shadows in the atlas
+        ShadowAtlasStats shadowAtlas;
+        uint32_t shadowAtlasDraws = 0;
+
+        // Main view culling on the CPU before anything is submitted
+        OcclusionStats occlusion;
+
+        // GPU-driven path: culled by CullCS.hlsl, drawn with indirect arguments
+        bool gpuDriven = false;
+        GpuCullingStats gpuCulling;
+
+        // Pixel shader runs per screen pixel, 1.0 is no overdraw over a full screen
+        double GetOverdraw() const
+        {
+            return screenPixels ? (double)shadedPixels / screenPixels : 0.0;
+        }
+
+        // Fraction of main pass shading the prepass saves, once both modes were sampled
+        double GetOverdrawReduction() const
+        {
+            if (!shadedPixelsWithPrepass || !shadedPixelsWithoutPrepass)
+                return 0.0;
+            return 1.0 - (double)shadedPixelsWithPrepass / shadedPixelsWithoutPrepass;
+        }
+    };
+
     class Renderer
     {
     public:
@@ -32,16 +164,122 @@ namespace Engine::Graphics
 
         bool Initialize(DeviceResources* deviceResources);
         void Render();
+
+        // Import a glTF 2.0 scene (.gltf/.glb) and append its nodes to the render list
+        bool LoadScene(const wchar_t* path);
         
         void SetClearColor(float r, float g, float b, float a);
+        void SetShadowQuality(ShadowQuality quality) { m_shadowQuality = quality; }
+        void SetRenderPath(RenderPath path) { m_renderPath = path; }
+
+        // Depth-only pass before the forward pass, which then shades each pixel once.
+        // Worth it when overdraw is high; set it per scene.
+        void SetDepthPrepass(bool enabled) { m_depthPrepass = enabled; }
+        const RenderStats& GetStats() const { return m_stats; }
+
+        void SetShadowPassMode(ShadowPassMode mode) { m_shadowPassMode = mode; }
+
+        // Stable cascades trade some resolution for shadows that do not shimmer
+        void SetCascadeFitMode(CascadeFitMode mode) { m_cascadeFitMode = mode; }
+
+        // SDSM fits the cascade partitions to what is visible; it needs compute shaders
+        void SetCascadeSplitMode(CascadeSplitMode mode) { m_cascadeSplitMode = mode; }
+        void SetSdsmSettings(const SdsmSettings& settings) { m_sdsmSettings = settings; }
+
+        // Kernel scaling, early-out and cascade blending of the soft shadow tiers
+        void SetShadowFilter(const ShadowFilterSettings& settings) { m_shadowFilter = settings; }
+
+        // Exponents, light bleeding reduction and prefilter blur of the EVSM tier
+        void SetEvsmSettings(const EvsmSettings& settings) { m_evsmSettings = settings; }
+
+        // Static casters are kept in a cached shadow map per cascade, redrawn only
+        // when the cascade moves a texel or static geometry changes
+        void SetShadowCacheConfig(const ShadowCacheConfig& config) { m_shadowCacheConfig = config; }
+        void InvalidateStaticShadows();
+
+        // Clustered point light shadows: atlas size, tile range, light limit and tile caching
+        void SetShadowAtlasSettings(const ShadowAtlasSettings& settings) { m_shadowAtlasSettings = settings; }
+
+        // Software occlusion culling of the main view: buffer size and occluder selection
+        void SetOcclusionCulling(bool enabled) { m_occlusionCulling = enabled; }
+        void SetOcclusionSettings(const OcclusionSettings& settings) { m_occlusionSettings = settings; }
+
+        // Culling on the GPU and indirect draws for the forward path and the cascades.
+        // Needs compute shaders; the deferred path keeps CPU submission.
+        void SetGpuDriven(bool enabled) { m_gpuDriven = enabled; }
+
+        // Counters per frame and pass over the last FRAME_STATS_HISTORY frames, with CSV/JSON export
+        const FrameStats& GetFrameStats() const { return m_frameStats; }
+        void SetStatsOverlay(bool enabled) { m_showStatsOverlay = enabled; }
         void Release();
 
     private:
 
         DeviceResources* m_deviceResources = nullptr;
+        D3DShaderCompiler* m_shaderCompiler = nullptr;
+        ShaderCache* m_shaderCache = nullptr;
         Shader* m_shader = nullptr;
 		Shader* m_shadowShader = nullptr;
+        Shader* m_shadowCascadesShader = nullptr;  // single-pass cascades, with a GS when the VS cannot pick the slice
+        ShadowPassMode m_shadowPassMode = SHADOW_PASS_SINGLE;
+        bool m_shadowCascadesReady = false;
         Shader* m_shadowDebugShader = nullptr;
+
+        // Forward pass permutations (pass features | material features)
+        PixelShaderVariants* m_forwardVariants = nullptr;
+        uint32_t m_featureShadowQuality = 0;
+        uint32_t m_featureLightMix = 0;
+        uint32_t m_featureNormalMap = 0;
+        uint32_t m_featureAlphaTest = 0;
+        uint32_t m_featureClusteredLights = 0;
+        ShadowQuality m_shadowQuality = SHADOW_QUALITY_SOFT;
+        ShadowFilterSettings m_shadowFilter;
+
+        // EVSM tier: moments rebuilt for the cascades the shadow pass redrew.
+        // Null when the prefilter shaders or the RGBA32F array are unavailable.
+        ShadowMomentMaps* m_shadowMoments = nullptr;
+        EvsmSettings m_evsmSettings;
+        uint32_t m_shadowMomentsValid = 0;      // cascades whose moments match the shadow map
+        Shader* m_evsmConvertShader = nullptr;
+        Shader* m_evsmBlurShader = nullptr;
+        ConstantBuffer* m_cbEvsm = nullptr;
+
+        // Deferred path. The light pass shares the lighting feature ids above
+        RenderPath m_renderPath = RENDER_PATH_FORWARD;
+        GBuffer* m_gbuffer = nullptr;
+        Shader* m_gbufferShader = nullptr;
+        Shader* m_deferredLightShader = nullptr;
+        Shader* m_compositeShader = nullptr;
+        PixelShaderVariants* m_gbufferVariants = nullptr;
+        PixelShaderVariants* m_deferredLightVariants = nullptr;
+        uint32_t m_gbufferFeatureNormalMap = 0;
+        uint32_t m_gbufferFeatureAlphaTest = 0;
+        ConstantBuffer* m_cbDeferred = nullptr;
+
+        // Depth prepass. Draw order is front to back, alpha-tested objects last
+        // (they clip, so they stay out of the prepass and test LESS as usual)
+        bool m_depthPrepass = true;
+        Shader* m_depthPrepassShader = nullptr;
+        vector<RenderObject*> m_drawOrder;
+        size_t m_opaqueDrawCount = 0;
+        GpuPassStatistics* m_mainPassStatistics = nullptr;
+        GpuProfiler* m_gpuProfiler = nullptr;               // GPU time of the passes, frames late
+        RenderStats m_stats;
+        bool m_overdrawLogged = false;
+
+        // Per-pass counters. Pipeline statistics come from a query per pass;
+        // the prepass shares the main pass's (m_mainPassStatistics), and the
+        // passes that only upload or run on the CPU have none.
+        FrameStats m_frameStats;
+        GpuPassStatistics* m_passStatistics[RENDER_PASS_COUNT] = {};
+        uint64_t m_constantBytesCharged = 0;                // uploaded bytes already charged to a pass
+        bool m_showStatsOverlay = false;
+        DebugTextTexture* m_statsText = nullptr;
+        Shader* m_debugTextShader = nullptr;
+        const PipelineState* m_debugTextPipeline = nullptr; // null without the overlay shaders
+
+        // Rebuilds edited shaders/textures in the background, swapped in at the start of Render
+        Engine::Core::HotReloader* m_hotReloader = nullptr;
         Mesh* m_mesh = nullptr;
 		Mesh* m_planeMesh = nullptr;
         ConstantBuffer* m_cbPerObject = nullptr;
@@ -49,34 +287,124 @@ namespace Engine::Graphics
 		ConstantBuffer* m_cbShadow = nullptr;
         vector<Light> m_lights;
 
+        // Clustered point lights: assigned to view-space froxels on the CPU every frame
+        vector<Light> m_clusteredLights;
+        vector<uint8_t> m_clusteredLightDynamic;            // 1: the light moves, its shadow tiles never stay cached
+        vector<LightSphere> m_clusteredLightSpheres;
+        LightClusterGrid* m_lightClusters = nullptr;
+        ClusteredLightBuffers* m_lightClusterBuffers = nullptr;
+        bool m_lightClustersLogged = false;
+
 
 
-        // Pipeline states
-		ID3D11RasterizerState* m_rasterizerState = nullptr;
-		ID3D11RasterizerState* m_shadowRasterizerState = nullptr;
-		ID3D11DepthStencilState* m_depthStencilState = nullptr;
+        // Pipeline states: shared, deduplicated objects owned by the cache
+        RenderStateCache* m_stateCache = nullptr;
+        const PipelineState* m_mainPipeline = nullptr;
+        const PipelineState* m_shadowPipeline = nullptr;
+        const PipelineState* m_shadowDebugPipeline = nullptr;
+        const PipelineState* m_gbufferPipeline = nullptr;
+        const PipelineState* m_deferredLightPipeline = nullptr;
+        const PipelineState* m_compositePipeline = nullptr;
+        const PipelineState* m_depthPrepassPipeline = nullptr;
+        const PipelineState* m_mainEqualPipeline = nullptr;    // after the prepass: EQUAL, no depth writes
+        const PipelineState* m_shadowCascadesPipeline = nullptr;
+        const PipelineState* m_evsmConvertPipeline = nullptr;
+        const PipelineState* m_evsmBlurPipeline = nullptr;
+        const PipelineState* m_atlasClearPipeline = nullptr;   // writes far depth over one tile
 
-        // Texture
-        ID3D11ShaderResourceView* m_brickTexture = nullptr;
-        ID3D11ShaderResourceView* m_groundTexture = nullptr;
-        ID3D11SamplerState* m_samplerState = nullptr;
+        // Texture streaming
+        WicTextureDecoder* m_textureDecoder = nullptr;
+        D3D11TextureUploader* m_textureUploader = nullptr;
+        TextureStreamer* m_textureStreamer = nullptr;
+        TextureHandle m_brickTexture = INVALID_TEXTURE_HANDLE;
+        TextureHandle m_groundTexture = INVALID_TEXTURE_HANDLE;
+        ID3D11ShaderResourceView* m_defaultTexture = nullptr;   // 1x1 white until a stream is resident
+        ID3D11ShaderResourceView* m_brickCookedTexture = nullptr; // .dds from the texture cooker, if present
+        ID3D11ShaderResourceView* m_groundCookedTexture = nullptr;
+        std::chrono::steady_clock::time_point m_initTime;
+        bool m_texturesReadyLogged = false;
+        ID3D11SamplerState* m_samplerState = nullptr;             // owned by m_stateCache
 
         ID3D11Texture2D* m_shadowMapArray = nullptr;
         ID3D11DepthStencilView* m_shadowMapDSVArray = nullptr;
         ID3D11ShaderResourceView* m_shadowMapSRVArray = nullptr;
 
+        // Static casters only, copied into m_shadowMapArray before the dynamic ones draw
+        ShadowCacheScheduler* m_shadowCache = nullptr;
+        ShadowCacheConfig m_shadowCacheConfig;
+        ID3D11Texture2D* m_shadowCacheArray = nullptr;
+        ID3D11DepthStencilView* m_shadowCacheDSVArray = nullptr;
+        ID3D11DepthStencilView* m_shadowCacheDSVs[NUM_CASCADES] = {};
+
+        // Point light shadows: tiles packed per frame by screen coverage, static ones kept
+        ShadowAtlas* m_shadowAtlas = nullptr;
+        ShadowAtlasSettings m_shadowAtlasSettings;
+        ShadowAtlasMaps* m_shadowAtlasMaps = nullptr;
+        Shader* m_atlasClearShader = nullptr;
+        vector<ShadowLightRequest> m_shadowLightRequests;   // one per clustered light
+        vector<uint32_t> m_shadowLightCasterFirst;          // per clustered light into the two below, plus an end
+        vector<uint32_t> m_shadowLightCasters;              // render objects inside each shadowed light's sphere
+        vector<uint8_t> m_shadowLightCasterFaces;           // cube faces each of them reaches
+        vector<ShadowAtlasTileGpu> m_shadowAtlasTiles;
+        vector<int32_t> m_clusteredLightShadows;            // first tile per clustered light, -1 without
+
+        // Occlusion culling: the largest opaque objects on screen rasterized on
+        // the CPU, every object's bounds tested before the main view draws it.
+        // Shadow passes keep every caster, hidden objects can still shadow visible ones.
+        OcclusionBuffer* m_occlusion = nullptr;
+        OcclusionSettings m_occlusionSettings;
+        bool m_occlusionCulling = true;
+        vector<ShadowAabb> m_objectWorldBounds;             // one per render object, this frame
+        vector<uint8_t> m_objectVisible;                    // 0: outside the view or occluded
+
+        // GPU-driven path: every object goes to CullCS.hlsl, which writes the
+        // draw arguments of each (view, bucket). Views: the main view's early
+        // and late phases, then dynamic and static casters per cascade.
+        // The late phase tests against a Hi-Z pyramid of the early phase's depth.
+        static const uint32_t CULL_VIEW_MAIN = 0;
+        static const uint32_t CULL_VIEW_MAIN_LATE = 1;
+        static const uint32_t CULL_VIEW_DYNAMIC_CASTERS = 2;
+        static const uint32_t CULL_VIEW_STATIC_CASTERS = 2 + NUM_CASCADES;
+        static const uint32_t CULL_VIEW_COUNT = 2 + 2 * NUM_CASCADES;
+        GpuCuller* m_gpuCuller = nullptr;                   // null when the compute shader is unavailable
+        GpuHiZPyramid* m_hiZPyramid = nullptr;              // null when the compute shader is unavailable: the late phase is frustum only
+        bool m_gpuDriven = false;
+        bool m_gpuDrivenReady = false;                      // instanced shaders built
+        CullBatch m_cullBatch;
+        CullView m_cullViews[CULL_VIEW_COUNT];
+        vector<InstanceTransformGpu> m_instanceTransforms;
+        vector<IndirectBucket> m_indirectBuckets;           // opaque first, alpha-tested after
+        uint32_t m_opaqueBucketCount = 0;
+        Shader* m_instancedShader = nullptr;
+        Shader* m_instancedPrepassShader = nullptr;
+        Shader* m_instancedShadowShader = nullptr;
+        const PipelineState* m_instancedPipeline = nullptr;
+        const PipelineState* m_instancedEqualPipeline = nullptr;
+        const PipelineState* m_instancedPrepassPipeline = nullptr;
+        const PipelineState* m_instancedShadowPipeline = nullptr;
+
 		/*ID3D11Texture2D* m_shadowMapTexture = nullptr;
 		ID3D11DepthStencilView* m_shadowMapDSV = nullptr;
 		ID3D11ShaderResourceView* m_shadowMapSRV = nullptr;*/
 
-		ID3D11SamplerState* m_shadowMapSampler = nullptr;
+		ID3D11SamplerState* m_shadowMapSampler = nullptr;     // owned by m_stateCache
+        ID3D11SamplerState* m_momentSampler = nullptr;        // trilinear clamp, owned by m_stateCache
 
         // Shadow matrices
         XMMATRIX m_lightViewProj[NUM_CASCADES];
         ID3D11DepthStencilView* m_shadowCascadeDSVs[NUM_CASCADES];
 
         float    m_cascadeSplits[NUM_CASCADES];
+        float m_cascadeRenderedSplits[NUM_CASCADES] = {};  // far split each m_lightViewProj was fitted with
+        float m_cascadeNearZ = 0.1f;                    // near end of the first cascade
+        CascadeSplitMode m_cascadeSplitMode = CASCADE_SPLIT_FIXED;
+        SdsmSettings m_sdsmSettings;
+        GpuDepthReduction* m_depthReduction = nullptr;  // null when the compute shader is unavailable
+        DepthRange m_visibleDepth;
+        CascadeBounds m_cascadeBounds[NUM_CASCADES];    // light-space boxes behind m_lightViewProj
+        vector<ShadowAabb> m_shadowCasterBounds;        // light space, one per render object
         float m_cascadeLambda = 0.6f;
+        CascadeFitMode m_cascadeFitMode = CASCADE_FIT_STABLE;
         float m_nearZ = 0.1f;
         float m_farZ = 100.0f;
 
@@ -95,15 +423,55 @@ namespace Engine::Graphics
 
 		vector<RenderObject*> m_renderObjects;
 
+        // Imported content (owns the meshes/textures referenced by scene render objects)
+        GltfScene m_scene;
+
 
         XMFLOAT4 m_clearColor{ 0.1f, 0.5f, 0.6f, 1.0f };
 
         bool CreateResources();
         void ShadowPass();
+        void DrawShadowsPerCascade(ID3D11DeviceContext* context, ID3D11DepthStencilView* const* cascadeDSVs,
+            uint32_t cascadeMask, bool dynamicCasters);
+        void DrawShadowsSinglePass(ID3D11DeviceContext* context, ID3D11DepthStencilView* arrayDSV,
+            uint32_t cascadeMask, bool dynamicCasters);
+        void GenerateShadowMoments(ID3D11DeviceContext* context, uint32_t updateMask);
+        void ShadowAtlasPass();
         void MainRenderPass();
+        void MainRenderPassIndirect(ID3D11DeviceContext* context, const XMMATRIX& view, const XMMATRIX& proj);
+        void DeferredRenderPass();
+        void AnimateObjects(float dt);
+        void CullOccludedObjects();
+        bool IsGpuDriven() const;
+        void BuildCullBatch();
+        void DrawShadowsIndirect(ID3D11DeviceContext* context, ID3D11DepthStencilView* const* cascadeDSVs,
+            uint32_t cascadeMask, bool dynamicCasters);
+        uint32_t DrawBucketsIndirect(ID3D11DeviceContext* context, const ScenePass* pass, uint32_t view,
+            uint32_t firstBucket, uint32_t bucketCount);
+        void UpdateFrameLighting(ID3D11DeviceContext* context, const XMMATRIX& view, Shader* lightingShader);
+        void BindLighting(ID3D11DeviceContext* context, Shader* shader);
+        void SortDrawOrder(const XMMATRIX& view);
+        void DepthPrepass(ID3D11DeviceContext* context, const XMMATRIX& view, const XMMATRIX& proj);
+        void CollectMainPassStatistics(ID3D11DeviceContext* context);
+        uint32_t DrawObjects(ID3D11DeviceContext* context, const XMMATRIX& view, const XMMATRIX& proj, const ScenePass& pass,
+            RenderObject* const* objects, size_t count);
+        void AddLightingFeatures(ShaderPermutationSpace& space);
+        void CreateForwardVariants(ID3D11Device* device);
+        void CreateDeferredVariants(ID3D11Device* device);
+        ShaderVariantKey GetLightingKey() const;
+        void CreateClusteredLights();
+        void AssignLightClusters(ID3D11DeviceContext* context, const XMMATRIX& view, CBLight& cb);
+        ID3D11ShaderResourceView* ResolveTexture(RenderObject* obj, float distance);
         void RenderShadowDebug();
 		void ComputeCascadeSplits();
+        void ReduceVisibleDepth();
+        void SetStatsPass(ID3D11DeviceContext* context, RenderPassId pass);
+        uint64_t GetUploadedConstantBytes() const;
+        void CollectPassStatistics(ID3D11DeviceContext* context);
+        void RenderStatsOverlay();
+        void DumpProfile();
         void ToggleShadowDebug() { m_showShadowDebug = !m_showShadowDebug; }
+        void ToggleStatsOverlay() { m_showStatsOverlay = !m_showStatsOverlay; }
         void DestroyResources();
     };
 
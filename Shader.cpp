@@ -1,53 +1,52 @@
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "ShaderCacheD3D11.h"
 #include <stdexcept>
 
 using namespace Engine::Graphics;
 
-static bool CompileShaderFromFile(const wchar_t* filePath, const char* entryPoint, const char* target, std::vector<BYTE>& outBlob)
+bool Shader::LoadFromFiles(ID3D11Device* device, ShaderCache& cache, const wchar_t* vsPath, const wchar_t* psPath, const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements)
 {
-    outBlob.clear();
-
-    UINT compileFlags = 0;
-#if defined(_DEBUG)
-    compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#else
-    compileFlags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-#endif
+    if (!device) return false;
 
+    // Both stages go through the bytecode cache and compile in parallel on a miss
+    ShaderCompileRequest requests[2];
+    requests[0].path = vsPath;
+    requests[0].target = "vs_5_0";
+    requests[1].path = psPath;
+    requests[1].target = "ps_5_0";
+    for (ShaderCompileRequest& request : requests)
+        request.flags = D3DShaderCompiler::GetDefaultFlags();
 
-    ID3DBlob* shaderBlob = nullptr;
-    ID3DBlob* errorBlob = nullptr;
-    HRESULT hr = D3DCompileFromFile(filePath, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, entryPoint, target, compileFlags, 0, &shaderBlob, &errorBlob);
+    std::vector<ShaderCompileResult> results;
+    cache.CompileAll(requests, 2, results);
 
-    if (FAILED(hr))
+    for (const ShaderCompileResult& result : results)
     {
-        if (errorBlob)
-        {
-            OutputDebugStringA(reinterpret_cast<const char*>(errorBlob->GetBufferPointer()));
-            errorBlob->Release();
-        }
-        if (shaderBlob) shaderBlob->Release();
-        return false;
+        if (!result.errors.empty())
+            OutputDebugStringA(result.errors.c_str());
+        if (!result.success)
+            return false;
     }
 
-    // copy blob bytes into vector for storage
-    outBlob.resize(shaderBlob->GetBufferSize());
-    memcpy(outBlob.data(), shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize());
+    return Create(device, results[0], results[1], layoutDesc, layoutNumElements);
+}
+
+bool Shader::Create(ID3D11Device* device, const ShaderCompileResult& vs, const ShaderCompileResult& ps, const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements)
+{
+    m_bindings.Clear();
+    m_bindings.AddStage(vs.reflection, SHADER_STAGE_VERTEX);
+    m_bindings.AddStage(ps.reflection, SHADER_STAGE_PIXEL);
 
-    shaderBlob->Release();
-    if (errorBlob) errorBlob->Release();
-    return true;
+    return Create(device, vs.bytecode, ps.bytecode, layoutDesc, layoutNumElements);
 }
 
-bool Shader::LoadFromFiles(ID3D11Device* device, const wchar_t* vsPath, const wchar_t* psPath, const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements)
+bool Shader::Create(ID3D11Device* device, const std::vector<BYTE>& vsBytecode, const std::vector<BYTE>& psBytecode, const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements)
 {
     if (!device) return false;
 
-    // Compile vertex shader
-    if (!CompileShaderFromFile(vsPath, "main", "vs_5_0", m_vsBlob))
-    {
-        return false;
-    }
+    // keep the VS bytecode, the input layout is validated against its signature
+    m_vsBlob = vsBytecode;
 
     // Create vertex shader object from compiled blob
     HRESULT hr = device->CreateVertexShader(m_vsBlob.data(), m_vsBlob.size(), nullptr, m_vs.GetAddressOf());
@@ -57,33 +56,60 @@ bool Shader::LoadFromFiles(ID3D11Device* device, const wchar_t* vsPath, const wc
     hr = device->CreateInputLayout(layoutDesc, layoutNumElements, m_vsBlob.data(), m_vsBlob.size(), m_inputLayout.GetAddressOf());
     if (FAILED(hr)) return false;
 
-    // Compile pixel shader
-    std::vector<BYTE> psBlob;
-    if (!CompileShaderFromFile(psPath, "main", "ps_5_0", psBlob))
-    {
-        return false;
-    }
-
     // Create pixel shader object
-    hr = device->CreatePixelShader(psBlob.data(), psBlob.size(), nullptr, m_ps.GetAddressOf());
+    hr = device->CreatePixelShader(psBytecode.data(), psBytecode.size(), nullptr, m_ps.GetAddressOf());
     if (FAILED(hr)) return false;
 
     return true;
 }
 
+bool Shader::CreateGeometryShader(ID3D11Device* device, const ShaderCompileResult& gs)
+{
+    if (!device) return false;
+
+    m_bindings.AddStage(gs.reflection, SHADER_STAGE_GEOMETRY);
+    return SUCCEEDED(device->CreateGeometryShader(gs.bytecode.data(), gs.bytecode.size(), nullptr, m_gs.GetAddressOf()));
+}
+
 void Shader::Bind(ID3D11DeviceContext* context)
 {
     if (!context) return;
 
     context->IASetInputLayout(m_inputLayout.Get());
     context->VSSetShader(m_vs.Get(), nullptr, 0);
+    context->GSSetShader(m_gs.Get(), nullptr, 0);
     context->PSSetShader(m_ps.Get(), nullptr, 0);
 }
 
+void Shader::BindConstantBuffer(ID3D11DeviceContext* context, const char* name, ID3D11Buffer* buffer) const
+{
+    const ConstantBufferBinding* binding = m_bindings.FindConstantBuffer(name);
+    if (!context || !binding) return;
+
+    if (binding->stages & SHADER_STAGE_VERTEX)
+        context->VSSetConstantBuffers(binding->slot, 1, &buffer);
+    if (binding->stages & SHADER_STAGE_PIXEL)
+        context->PSSetConstantBuffers(binding->slot, 1, &buffer);
+    if (binding->stages & SHADER_STAGE_GEOMETRY)
+        context->GSSetConstantBuffers(binding->slot, 1, &buffer);
+}
+
+void Shader::Swap(Shader& other)
+{
+    m_vs.Swap(other.m_vs);
+    m_ps.Swap(other.m_ps);
+    m_gs.Swap(other.m_gs);
+    m_inputLayout.Swap(other.m_inputLayout);
+    m_vsBlob.swap(other.m_vsBlob);
+    std::swap(m_bindings, other.m_bindings);
+}
+
 void Shader::Release()
 {
     m_inputLayout.Reset();
     m_vs.Reset();
     m_ps.Reset();
+    m_gs.Reset();
     m_vsBlob.clear();
+    m_bindings.Clear();
 }
@@ -5,6 +5,7 @@
 #include <wrl/client.h>
 #include <string>
 #include <vector>
+#include "ShaderReflection.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -12,6 +13,8 @@ namespace Engine::Graphics
 {
 
     class DeviceResources; // forward-declared
+    class ShaderCache;
+    struct ShaderCompileResult;
 
     class Shader
     {
@@ -19,20 +22,46 @@ namespace Engine::Graphics
         Shader() = default;
         ~Shader() = default;
 
-        // Load and compile a vertex + pixel shader from files.
-        bool LoadFromFiles(ID3D11Device* device, const wchar_t* vsPath, const wchar_t* psPath,
+        // Load and compile a vertex + pixel shader from files, through the bytecode cache.
+        bool LoadFromFiles(ID3D11Device* device, ShaderCache& cache, const wchar_t* vsPath, const wchar_t* psPath,
             const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements);
 
-        // Bind shader + input layout to the pipeline
+        // Create from already compiled bytecode.
+        bool Create(ID3D11Device* device, const std::vector<BYTE>& vsBytecode, const std::vector<BYTE>& psBytecode,
+            const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements);
+
+        // Create from compile results, the binding table is built from their reflection.
+        bool Create(ID3D11Device* device, const ShaderCompileResult& vs, const ShaderCompileResult& ps,
+            const D3D11_INPUT_ELEMENT_DESC* layoutDesc, UINT layoutNumElements);
+
+        // Optional geometry stage, added after Create. Its cbuffers join the binding table.
+        bool CreateGeometryShader(ID3D11Device* device, const ShaderCompileResult& gs);
+
+        // Bind shader + input layout to the pipeline (clears the GS slot when there is none)
         void Bind(ID3D11DeviceContext* context);
 
         void Release();
 
+        // Exchange everything with other. Hot reload swaps a rebuilt program
+        // in place, so pipelines holding this Shader* stay valid.
+        void Swap(Shader& other);
+
+        ID3D11PixelShader* GetPixelShader() const { return m_ps.Get(); }
+
+        // cbuffer slots and used ranges from reflection (empty for raw bytecode)
+        const ShaderBindingTable& GetBindings() const { return m_bindings; }
+        const ConstantBufferBinding* FindConstantBuffer(const char* name) const { return m_bindings.FindConstantBuffer(name); }
+
+        // Binds to the slot, and only the stages, that declare the cbuffer
+        void BindConstantBuffer(ID3D11DeviceContext* context, const char* name, ID3D11Buffer* buffer) const;
+
     private:
         ComPtr<ID3D11VertexShader> m_vs;
         ComPtr<ID3D11PixelShader> m_ps;
+        ComPtr<ID3D11GeometryShader> m_gs;
         ComPtr<ID3D11InputLayout> m_inputLayout;
 		std::vector<BYTE> m_vsBlob; // keep compiled VS blob for input layout creation
+        ShaderBindingTable m_bindings;
     };
 
 } // namespace Engine::Graphics
@@ -0,0 +1,272 @@
+#include "ShaderCache.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <set>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+namespace
+{
+    // Bump when the key layout or the entry format changes
+    const uint32_t SHADER_CACHE_VERSION = 3;
+
+    bool ReadText(const std::filesystem::path& path, std::string& out)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // #include "x" / #include <x> outside comments, in source order. Includes
+    // inside inactive #if blocks are kept: over-invalidating is harmless.
+    std::vector<std::string> ParseIncludes(const std::string& source)
+    {
+        std::vector<std::string> names;
+        size_t i = 0;
+        bool lineStart = true;
+
+        while (i < source.size())
+        {
+            char c = source[i];
+
+            if (c == '/' && i + 1 < source.size() && source[i + 1] == '/')
+            {
+                while (i < source.size() && source[i] != '\n')
+                    ++i;
+                continue;
+            }
+            if (c == '/' && i + 1 < source.size() && source[i + 1] == '*')
+            {
+                size_t end = source.find("*/", i + 2);
+                i = end == std::string::npos ? source.size() : end + 2;
+                continue;
+            }
+            if (c == '\n')
+            {
+                lineStart = true;
+                ++i;
+                continue;
+            }
+            if (c == ' ' || c == '\t' || c == '\r')
+            {
+                ++i;
+                continue;
+            }
+
+            if (c == '#' && lineStart)
+            {
+                size_t p = i + 1;
+                while (p < source.size() && (source[p] == ' ' || source[p] == '\t'))
+                    ++p;
+
+                if (source.compare(p, 7, "include") == 0)
+                {
+                    p += 7;
+                    while (p < source.size() && (source[p] == ' ' || source[p] == '\t'))
+                        ++p;
+
+                    if (p < source.size() && (source[p] == '"' || source[p] == '<'))
+                    {
+                        char close = source[p] == '"' ? '"' : '>';
+                        size_t end = source.find_first_of(std::string(1, close) + "\n", p + 1);
+                        if (end != std::string::npos && source[end] == close)
+                            names.push_back(source.substr(p + 1, end - p - 1));
+                    }
+                }
+            }
+
+            lineStart = false;
+            ++i;
+        }
+        return names;
+    }
+
+    // Depth-first in source order. visit(name, resolvedPath, text) sees every
+    // directive; a missing include comes through with an empty path.
+    template <typename Visit>
+    void WalkIncludes(const std::filesystem::path& file, const std::string& source, const std::filesystem::path& rootDir,
+        std::set<std::filesystem::path>& visited, Visit&& visit)
+    {
+        for (const std::string& name : ParseIncludes(source))
+        {
+            std::filesystem::path resolved;
+            std::string text;
+            for (const std::filesystem::path& dir : { file.parent_path(), rootDir })
+            {
+                std::filesystem::path candidate = (dir / name).lexically_normal();
+                if (ReadText(candidate, text))
+                {
+                    resolved = candidate;
+                    break;
+                }
+            }
+
+            visit(name, resolved, text);
+            if (resolved.empty() || !visited.insert(resolved).second)
+                continue;
+
+            WalkIncludes(resolved, text, rootDir, visited, visit);
+        }
+    }
+}
+
+const std::string* ShaderSourceSnapshot::FindInclude(const std::filesystem::path& includer, const std::string& name,
+    std::filesystem::path* outPath) const
+{
+    for (const std::filesystem::path& dir : { includer.parent_path(), path.parent_path() })
+    {
+        std::filesystem::path candidate = (dir / name).lexically_normal();
+        auto it = includes.find(candidate);
+        if (it != includes.end())
+        {
+            if (outPath)
+                *outPath = candidate;
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+ShaderCache::ShaderCache(IShaderCompiler* compiler)
+    : m_compiler(compiler)
+{
+}
+
+uint64_t ShaderCache::ComputeKey(const ShaderCompileRequest& request, ShaderSourceSnapshot* outSource) const
+{
+    std::string source;
+    if (!ReadText(request.path, source))
+        return 0;
+
+    ContentHash hash;
+    hash.Append("shader")
+        .AppendValue(SHADER_CACHE_VERSION)
+        .AppendValue(m_compiler->GetVersion())
+        .Append(source)
+        .Append(request.entryPoint)
+        .Append(request.target)
+        .AppendValue(request.flags);
+
+    hash.AppendValue((uint32_t)request.defines.size());
+    for (const ShaderDefine& define : request.defines)
+        hash.Append(define.name).Append(define.value);
+
+    // A missing include still contributes its name, so creating it later
+    // changes the key as well
+    std::set<std::filesystem::path> visited;
+    WalkIncludes(request.path, source, request.path.parent_path(), visited,
+        [&hash, outSource](const std::string& name, const std::filesystem::path& resolved, const std::string& text)
+        {
+            hash.Append(name).AppendValue((uint8_t)(resolved.empty() ? 0 : 1)).Append(text);
+            if (outSource && !resolved.empty())
+                outSource->includes.emplace(resolved, text);
+        });
+
+    if (outSource)
+    {
+        outSource->path = request.path;
+        outSource->text = std::move(source);
+    }
+    return hash.Get();
+}
+
+void ShaderCache::CollectIncludes(const std::filesystem::path& file, std::vector<std::filesystem::path>& outIncludes)
+{
+    outIncludes.clear();
+
+    std::string source;
+    if (!ReadText(file, source))
+        return;
+
+    // The walker marks a file visited right after reporting it, so each
+    // include is collected once
+    std::set<std::filesystem::path> visited;
+    WalkIncludes(file, source, file.parent_path(), visited,
+        [&outIncludes, &visited](const std::string&, const std::filesystem::path& resolved, const std::string&)
+        {
+            if (!resolved.empty() && visited.find(resolved) == visited.end())
+                outIncludes.push_back(resolved);
+        });
+}
+
+bool ShaderCache::Compile(const ShaderCompileRequest& request, ShaderCompileResult& outResult)
+{
+    std::vector<ShaderCompileResult> results;
+    CompileAll(&request, 1, results);
+    outResult = std::move(results[0]);
+    return outResult.success;
+}
+
+void ShaderCache::CompileAll(const ShaderCompileRequest* requests, size_t count, std::vector<ShaderCompileResult>& outResults)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    outResults.clear();
+    outResults.resize(count);
+
+    // One job per stage; the cache lookup (hashing + includes) is parallel too
+    JobContext ctx;
+    JobSystem::Dispatch(ctx, (uint32_t)count, 1, [this, requests, &outResults](uint32_t i)
+        {
+            const ShaderCompileRequest& request = requests[i];
+            ShaderCompileResult& result = outResults[i];
+
+            ShaderSourceSnapshot source;
+            result.key = ComputeKey(request, &source);
+            if (result.key == 0)
+            {
+                result.errors = "cannot read " + request.path.string() + "\n";
+                return;
+            }
+
+            std::vector<uint8_t> entry;
+            if (AssetCache::Load(result.key, entry))
+            {
+                BinaryReader reader(entry);
+                if (reader.ReadVector(result.bytecode) && result.reflection.Deserialize(reader) && reader.IsAtEnd())
+                {
+                    result.success = true;
+                    result.fromCache = true;
+                    return;
+                }
+                result.bytecode.clear();
+            }
+
+            result.success = m_compiler->Compile(request, source, result.bytecode, result.errors) &&
+                m_compiler->Reflect(result.bytecode, result.reflection);
+            if (!result.success)
+                return;
+
+            BinaryWriter writer;
+            writer.WriteVector(result.bytecode);
+            result.reflection.Serialize(writer);
+            AssetCache::Store(result.key, writer.GetData().data(), writer.GetData().size());
+        });
+    JobSystem::Wait(ctx);
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    for (const ShaderCompileResult& result : outResults)
+    {
+        if (result.fromCache)
+            m_stats.hits++;
+        else if (result.success)
+            m_stats.compiled++;
+        else
+            m_stats.failed++;
+    }
+    m_stats.lastBatchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ShaderCacheStats ShaderCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
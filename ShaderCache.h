@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ShaderReflection.h"
+
+namespace Engine::Graphics
+{
+    struct ShaderDefine
+    {
+        std::string name;
+        std::string value;
+    };
+
+    struct ShaderCompileRequest
+    {
+        std::filesystem::path path;
+        std::string entryPoint = "main";
+        std::string target;             // vs_5_0, ps_5_0, ...
+        std::vector<ShaderDefine> defines;
+        uint32_t flags = 0;             // compiler specific, part of the cache key
+    };
+
+    struct ShaderCompileResult
+    {
+        std::vector<uint8_t> bytecode;
+        ShaderReflectionData reflection;
+        std::string errors;
+        uint64_t key = 0;
+        bool success = false;
+        bool fromCache = false;
+    };
+
+    // The source and every include it reached, exactly as they were hashed into
+    // the cache key. Compilers build from these bytes instead of reading the
+    // files again, so an edit landing mid-compile cannot be stored under the
+    // key of the old text.
+    struct ShaderSourceSnapshot
+    {
+        std::filesystem::path path;
+        std::string text;
+        std::map<std::filesystem::path, std::string> includes;    // resolved path -> text
+
+        // Like the key: relative to the including file, then next to path.
+        // nullptr when the include was missing when hashed.
+        const std::string* FindInclude(const std::filesystem::path& includer, const std::string& name,
+            std::filesystem::path* outPath = nullptr) const;
+    };
+
+    // Turns HLSL into bytecode and describes the result. Called on worker threads.
+    class IShaderCompiler
+    {
+    public:
+        virtual ~IShaderCompiler() = default;
+        virtual bool Compile(const ShaderCompileRequest& request, const ShaderSourceSnapshot& source,
+            std::vector<uint8_t>& outBytecode, std::string& outErrors) = 0;
+        virtual bool Reflect(const std::vector<uint8_t>& bytecode, ShaderReflectionData& outReflection) = 0;
+
+        // Changes whenever the same input could produce different bytecode
+        virtual uint64_t GetVersion() const = 0;
+    };
+
+    struct ShaderCacheStats
+    {
+        uint32_t hits = 0;
+        uint32_t compiled = 0;
+        uint32_t failed = 0;
+        double lastBatchMs = 0.0;
+    };
+
+    // Compiled-bytecode cache on top of the asset cache. The key covers the
+    // source, every file it #includes (transitively), defines, entry point,
+    // target, flags and compiler version, so editing a shared header
+    // invalidates exactly the shaders that pull it in. Entries hold the
+    // bytecode plus its reflection, so a hit needs no compiler at all.
+    // Misses compile in parallel on the job system.
+    class ShaderCache
+    {
+    public:
+        ShaderCache(IShaderCompiler* compiler);
+
+        bool Compile(const ShaderCompileRequest& request, ShaderCompileResult& outResult);
+        void CompileAll(const ShaderCompileRequest* requests, size_t count, std::vector<ShaderCompileResult>& outResults);
+
+        // 0 when the source file cannot be read. outSource receives the bytes the key covers.
+        uint64_t ComputeKey(const ShaderCompileRequest& request, ShaderSourceSnapshot* outSource = nullptr) const;
+
+        // Every file reachable through #include, resolved like the standard
+        // file include handler: relative to the including file, then the root
+        static void CollectIncludes(const std::filesystem::path& file, std::vector<std::filesystem::path>& outIncludes);
+
+        // Batches may run on several threads at once (hot reload), so this is a copy
+        ShaderCacheStats GetStats() const;
+
+    private:
+        IShaderCompiler* m_compiler = nullptr;
+        ShaderCacheStats m_stats;
+        mutable std::mutex m_statsMutex;
+    };
+
+} // namespace Engine::Graphics
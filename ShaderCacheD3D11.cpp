@@ -0,0 +1,210 @@
+#include "ShaderCacheD3D11.h"
+
+#include <cstring>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Serves #includes from the snapshot the cache key was computed from.
+    // parentData is the buffer handed out for the including file, which
+    // tells us where to resolve relative names from.
+    class SnapshotInclude : public ID3DInclude
+    {
+    public:
+        SnapshotInclude(const ShaderSourceSnapshot& source) : m_source(source) {}
+
+        HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR fileName, LPCVOID parentData, LPCVOID* outData, UINT* outBytes) override
+        {
+            std::filesystem::path includer = m_source.path;
+            for (const auto& [path, text] : m_source.includes)
+            {
+                if (text.data() == parentData)
+                    includer = path;
+            }
+
+            const std::string* text = m_source.FindInclude(includer, fileName);
+            if (!text)
+                return E_FAIL;
+
+            *outData = text->data();
+            *outBytes = (UINT)text->size();
+            return S_OK;
+        }
+
+        HRESULT __stdcall Close(LPCVOID) override { return S_OK; }
+
+    private:
+        const ShaderSourceSnapshot& m_source;
+    };
+}
+
+bool D3DShaderCompiler::Compile(const ShaderCompileRequest& request, const ShaderSourceSnapshot& source,
+    std::vector<uint8_t>& outBytecode, std::string& outErrors)
+{
+    outBytecode.clear();
+    outErrors.clear();
+
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (const ShaderDefine& define : request.defines)
+        macros.push_back({ define.name.c_str(), define.value.c_str() });
+    macros.push_back({ nullptr, nullptr });
+
+    // The file name only labels errors, the bytes come from the snapshot
+    std::string sourceName = source.path.string();
+    SnapshotInclude include(source);
+
+    ComPtr<ID3DBlob> shaderBlob;
+    ComPtr<ID3DBlob> errorBlob;
+    HRESULT hr = D3DCompile(source.text.data(), source.text.size(), sourceName.c_str(), macros.data(), &include,
+        request.entryPoint.c_str(), request.target.c_str(), request.flags, 0,
+        shaderBlob.GetAddressOf(), errorBlob.GetAddressOf());
+
+    if (errorBlob)
+        outErrors.assign(reinterpret_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+
+    if (FAILED(hr) || !shaderBlob)
+        return false;
+
+    outBytecode.resize(shaderBlob->GetBufferSize());
+    memcpy(outBytecode.data(), shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize());
+    return true;
+}
+
+bool D3DShaderCompiler::Reflect(const std::vector<uint8_t>& bytecode, ShaderReflectionData& outReflection)
+{
+    outReflection = ShaderReflectionData{};
+
+    ComPtr<ID3D11ShaderReflection> reflection;
+    if (FAILED(D3DReflect(bytecode.data(), bytecode.size(), __uuidof(ID3D11ShaderReflection),
+        reinterpret_cast<void**>(reflection.GetAddressOf()))))
+        return false;
+
+    D3D11_SHADER_DESC shaderDesc = {};
+    reflection->GetDesc(&shaderDesc);
+
+    for (UINT i = 0; i < shaderDesc.BoundResources; ++i)
+    {
+        D3D11_SHADER_INPUT_BIND_DESC bindDesc = {};
+        reflection->GetResourceBindingDesc(i, &bindDesc);
+
+        ShaderResourceBindingInfo binding;
+        binding.name = bindDesc.Name;
+        binding.slot = bindDesc.BindPoint;
+        binding.count = bindDesc.BindCount;
+        switch (bindDesc.Type)
+        {
+        case D3D_SIT_CBUFFER: binding.type = ShaderBindingType::ConstantBuffer; break;
+        case D3D_SIT_TEXTURE: binding.type = ShaderBindingType::Texture; break;
+        case D3D_SIT_SAMPLER: binding.type = ShaderBindingType::Sampler; break;
+        default: binding.type = ShaderBindingType::Other; break;
+        }
+        outReflection.bindings.push_back(binding);
+    }
+
+    for (UINT i = 0; i < shaderDesc.ConstantBuffers; ++i)
+    {
+        ID3D11ShaderReflectionConstantBuffer* cb = reflection->GetConstantBufferByIndex(i);
+        D3D11_SHADER_BUFFER_DESC cbDesc = {};
+        cb->GetDesc(&cbDesc);
+        if (cbDesc.Type != D3D_CT_CBUFFER)
+            continue;
+
+        ShaderConstantBufferInfo info;
+        info.name = cbDesc.Name;
+        info.size = cbDesc.Size;
+        for (const ShaderResourceBindingInfo& binding : outReflection.bindings)
+        {
+            if (binding.type == ShaderBindingType::ConstantBuffer && binding.name == info.name)
+                info.slot = binding.slot;
+        }
+
+        for (UINT v = 0; v < cbDesc.Variables; ++v)
+        {
+            D3D11_SHADER_VARIABLE_DESC varDesc = {};
+            cb->GetVariableByIndex(v)->GetDesc(&varDesc);
+
+            ShaderVariableInfo var;
+            var.name = varDesc.Name;
+            var.offset = varDesc.StartOffset;
+            var.size = varDesc.Size;
+            var.used = (varDesc.uFlags & D3D_SVF_USED) != 0;
+            info.variables.push_back(var);
+        }
+        outReflection.constantBuffers.push_back(std::move(info));
+    }
+    return true;
+}
+
+uint32_t D3DShaderCompiler::GetDefaultFlags()
+{
+#if defined(_DEBUG)
+    return D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    return D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+}
+
+// -----------------------------
+// PixelShaderVariants
+// -----------------------------
+PixelShaderVariants::PixelShaderVariants(ID3D11Device* device, ShaderCache* cache, const ShaderPermutationSpace& space,
+    const ShaderCompileRequest& base)
+    : m_device(device)
+    , m_bytecode(cache, space, base)
+{
+}
+
+ID3D11PixelShader* PixelShaderVariants::Get(ShaderVariantKey key)
+{
+    key = GetSpace().Canonicalize(key);
+
+    auto it = m_shaders.find(key);
+    if (it != m_shaders.end())
+        return it->second.Get();
+
+    ComPtr<ID3D11PixelShader>& shader = m_shaders[key];
+    const ShaderCompileResult& result = m_bytecode.Get(key);
+    if (!result.errors.empty())
+        OutputDebugStringA(result.errors.c_str());
+
+    if (!result.success ||
+        FAILED(m_device->CreatePixelShader(result.bytecode.data(), result.bytecode.size(), nullptr, shader.GetAddressOf())))
+    {
+        std::string msg = "Shader variant failed: " + GetSpace().GetName(key) + "\n";
+        OutputDebugStringA(msg.c_str());
+        shader.Reset();
+    }
+    return shader.Get();
+}
+
+void PixelShaderVariants::Prewarm(const std::vector<ShaderVariantKey>& keys)
+{
+    m_bytecode.Prewarm(keys);
+    for (ShaderVariantKey key : keys)
+        Get(key);
+}
+
+bool PixelShaderVariants::Replace(const std::vector<ShaderVariantKey>& keys, std::vector<ShaderCompileResult>& results,
+    std::string& outErrors)
+{
+    std::vector<ComPtr<ID3D11PixelShader>> shaders(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const ShaderCompileResult& result = results[i];
+        if (!result.success ||
+            FAILED(m_device->CreatePixelShader(result.bytecode.data(), result.bytecode.size(), nullptr, shaders[i].GetAddressOf())))
+        {
+            outErrors += "Shader variant failed: " + GetSpace().GetName(keys[i]) + "\n";
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        ShaderVariantKey key = GetSpace().Canonicalize(keys[i]);
+        m_shaders[key] = shaders[i];
+        m_bytecode.Replace(key, std::move(results[i]));
+    }
+    return true;
+}
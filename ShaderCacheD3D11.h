@@ -0,0 +1,53 @@
+#pragma once
+
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#include <d3d11shader.h>
+#include <wrl/client.h>
+#include <unordered_map>
+#include "ShaderCache.h"
+#include "ShaderPermutations.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // D3DCompile over the hashed source snapshot, includes served from it too; D3DReflect for the layout
+    class D3DShaderCompiler : public IShaderCompiler
+    {
+    public:
+        bool Compile(const ShaderCompileRequest& request, const ShaderSourceSnapshot& source,
+            std::vector<uint8_t>& outBytecode, std::string& outErrors) override;
+        bool Reflect(const std::vector<uint8_t>& bytecode, ShaderReflectionData& outReflection) override;
+        uint64_t GetVersion() const override { return D3D_COMPILER_VERSION; }
+
+        // Debug info and no optimization in debug builds, O3 otherwise
+        static uint32_t GetDefaultFlags();
+    };
+
+    // Pixel shader objects per variant, created lazily from the variant cache.
+    // A variant that fails to compile resolves to nullptr every time after.
+    class PixelShaderVariants
+    {
+    public:
+        PixelShaderVariants(ID3D11Device* device, ShaderCache* cache, const ShaderPermutationSpace& space,
+            const ShaderCompileRequest& base);
+
+        ID3D11PixelShader* Get(ShaderVariantKey key);
+        void Prewarm(const std::vector<ShaderVariantKey>& keys);
+
+        // Shader objects for every result are created first and swapped in
+        // together; if any result fails nothing changes
+        bool Replace(const std::vector<ShaderVariantKey>& keys, std::vector<ShaderCompileResult>& results, std::string& outErrors);
+
+        const ShaderVariantCache& GetBytecode() const { return m_bytecode; }
+        const ShaderPermutationSpace& GetSpace() const { return m_bytecode.GetSpace(); }
+        size_t GetVariantCount() const { return m_shaders.size(); }
+
+    private:
+        ID3D11Device* m_device = nullptr;
+        ShaderVariantCache m_bytecode;
+        std::unordered_map<ShaderVariantKey, ComPtr<ID3D11PixelShader>> m_shaders;
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,195 @@
+#include "ShaderPermutations.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Engine::Graphics;
+
+// -----------------------------
+// ShaderPermutationSpace
+// -----------------------------
+uint32_t ShaderPermutationSpace::AddFeature(const std::string& define, uint32_t valueCount)
+{
+    assert(valueCount >= 2);
+
+    uint32_t bits = 0;
+    while ((1u << bits) < valueCount)
+        ++bits;
+    assert(m_usedBits + bits <= 32);
+
+    ShaderFeature feature;
+    feature.define = define;
+    feature.valueCount = valueCount;
+    feature.shift = m_usedBits;
+    feature.mask = (bits == 32 ? ~0u : ((1u << bits) - 1)) << m_usedBits;
+    m_features.push_back(feature);
+
+    m_usedBits += bits;
+    return (uint32_t)m_features.size() - 1;
+}
+
+void ShaderPermutationSpace::AddCollapseRule(uint32_t feature, uint32_t value, uint32_t dependent, uint32_t collapsedValue)
+{
+    assert(feature < m_features.size() && dependent < m_features.size() && feature != dependent);
+    assert(value < m_features[feature].valueCount && collapsedValue < m_features[dependent].valueCount);
+    m_rules.push_back({ feature, value, dependent, collapsedValue });
+}
+
+ShaderVariantKey ShaderPermutationSpace::Set(ShaderVariantKey key, uint32_t feature, uint32_t value) const
+{
+    const ShaderFeature& f = m_features[feature];
+    return (key & ~f.mask) | ((value << f.shift) & f.mask);
+}
+
+uint32_t ShaderPermutationSpace::Get(ShaderVariantKey key, uint32_t feature) const
+{
+    const ShaderFeature& f = m_features[feature];
+    return (key & f.mask) >> f.shift;
+}
+
+bool ShaderPermutationSpace::IsValid(ShaderVariantKey key) const
+{
+    uint32_t allMask = 0;
+    for (uint32_t i = 0; i < m_features.size(); ++i)
+    {
+        allMask |= m_features[i].mask;
+        if (Get(key, i) >= m_features[i].valueCount)
+            return false;
+    }
+    return (key & ~allMask) == 0;
+}
+
+ShaderVariantKey ShaderPermutationSpace::Canonicalize(ShaderVariantKey key) const
+{
+    // Rules can chain (A collapses B, B collapses C), iterate to a fixed point.
+    // Each pass can only pin more fields, so this ends within rule-count passes.
+    for (size_t pass = 0; pass <= m_rules.size(); ++pass)
+    {
+        ShaderVariantKey before = key;
+        for (const CollapseRule& rule : m_rules)
+        {
+            if (Get(key, rule.feature) == rule.value)
+                key = Set(key, rule.dependent, rule.collapsedValue);
+        }
+        if (key == before)
+            break;
+    }
+    return key;
+}
+
+uint64_t ShaderPermutationSpace::GetCombinationCount() const
+{
+    uint64_t count = 1;
+    for (const ShaderFeature& f : m_features)
+        count *= f.valueCount;
+    return count;
+}
+
+void ShaderPermutationSpace::EnumerateVariants(std::vector<ShaderVariantKey>& outKeys) const
+{
+    outKeys.clear();
+
+    // Mixed-radix counter over the feature values, keep the canonical keys
+    std::vector<uint32_t> values(m_features.size(), 0);
+    for (uint64_t n = 0; n < GetCombinationCount(); ++n)
+    {
+        ShaderVariantKey key = 0;
+        for (uint32_t i = 0; i < m_features.size(); ++i)
+            key = Set(key, i, values[i]);
+
+        if (Canonicalize(key) == key)
+            outKeys.push_back(key);
+
+        for (uint32_t i = 0; i < m_features.size(); ++i)
+        {
+            if (++values[i] < m_features[i].valueCount)
+                break;
+            values[i] = 0;
+        }
+    }
+}
+
+void ShaderPermutationSpace::GetDefines(ShaderVariantKey key, std::vector<ShaderDefine>& outDefines) const
+{
+    for (uint32_t i = 0; i < m_features.size(); ++i)
+        outDefines.push_back({ m_features[i].define, std::to_string(Get(key, i)) });
+}
+
+std::string ShaderPermutationSpace::GetName(ShaderVariantKey key) const
+{
+    std::string name;
+    for (uint32_t i = 0; i < m_features.size(); ++i)
+    {
+        if (!name.empty())
+            name += ' ';
+        name += m_features[i].define + "=" + std::to_string(Get(key, i));
+    }
+    return name;
+}
+
+// -----------------------------
+// ShaderVariantCache
+// -----------------------------
+ShaderVariantCache::ShaderVariantCache(ShaderCache* cache, const ShaderPermutationSpace& space, const ShaderCompileRequest& base)
+    : m_cache(cache)
+    , m_space(space)
+    , m_base(base)
+{
+}
+
+ShaderCompileRequest ShaderVariantCache::MakeRequest(ShaderVariantKey key) const
+{
+    ShaderCompileRequest request = m_base;
+    m_space.GetDefines(key, request.defines);
+    return request;
+}
+
+const ShaderCompileResult& ShaderVariantCache::Get(ShaderVariantKey key)
+{
+    key = m_space.Canonicalize(key);
+
+    auto it = m_variants.find(key);
+    if (it != m_variants.end())
+        return it->second;
+
+    ShaderCompileResult& result = m_variants[key];
+    m_cache->Compile(MakeRequest(key), result);
+    return result;
+}
+
+void ShaderVariantCache::Prewarm(const std::vector<ShaderVariantKey>& keys)
+{
+    std::vector<ShaderVariantKey> missing;
+    std::vector<ShaderCompileRequest> requests;
+    for (ShaderVariantKey key : keys)
+    {
+        key = m_space.Canonicalize(key);
+        if (m_variants.find(key) != m_variants.end())
+            continue;
+        if (std::find(missing.begin(), missing.end(), key) != missing.end())
+            continue;
+
+        missing.push_back(key);
+        requests.push_back(MakeRequest(key));
+    }
+
+    if (requests.empty())
+        return;
+
+    std::vector<ShaderCompileResult> results;
+    m_cache->CompileAll(requests.data(), requests.size(), results);
+    for (size_t i = 0; i < missing.size(); ++i)
+        m_variants[missing[i]] = std::move(results[i]);
+}
+
+void ShaderVariantCache::GetKeys(std::vector<ShaderVariantKey>& outKeys) const
+{
+    outKeys.clear();
+    for (const auto& variant : m_variants)
+        outKeys.push_back(variant.first);
+}
+
+void ShaderVariantCache::Replace(ShaderVariantKey key, ShaderCompileResult&& result)
+{
+    m_variants[m_space.Canonicalize(key)] = std::move(result);
+}
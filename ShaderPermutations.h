@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ShaderCache.h"
+
+namespace Engine::Graphics
+{
+    // Packed feature values, one bit field per feature
+    using ShaderVariantKey = uint32_t;
+
+    struct ShaderFeature
+    {
+        std::string define;     // passed as define=value to the compiler
+        uint32_t valueCount = 2;
+        uint32_t shift = 0;
+        uint32_t mask = 0;
+    };
+
+    // The set of compile-time keywords a shader understands. Collapse rules
+    // prune combinations that would compile to the same code: when the
+    // trigger feature has the trigger value, the dependent feature no longer
+    // matters and is forced to one value, so every equivalent key maps to a
+    // single canonical variant.
+    class ShaderPermutationSpace
+    {
+    public:
+        // Returns the feature index. At most 32 bits of features in total.
+        uint32_t AddFeature(const std::string& define, uint32_t valueCount);
+        void AddCollapseRule(uint32_t feature, uint32_t value, uint32_t dependent, uint32_t collapsedValue);
+
+        ShaderVariantKey Set(ShaderVariantKey key, uint32_t feature, uint32_t value) const;
+        uint32_t Get(ShaderVariantKey key, uint32_t feature) const;
+
+        // Every field in range and no bits outside the features
+        bool IsValid(ShaderVariantKey key) const;
+        ShaderVariantKey Canonicalize(ShaderVariantKey key) const;
+
+        uint64_t GetCombinationCount() const;
+        void EnumerateVariants(std::vector<ShaderVariantKey>& outKeys) const;
+
+        void GetDefines(ShaderVariantKey key, std::vector<ShaderDefine>& outDefines) const;
+        std::string GetName(ShaderVariantKey key) const;
+
+        size_t GetFeatureCount() const { return m_features.size(); }
+
+    private:
+        struct CollapseRule
+        {
+            uint32_t feature;
+            uint32_t value;
+            uint32_t dependent;
+            uint32_t collapsedValue;
+        };
+
+        std::vector<ShaderFeature> m_features;
+        std::vector<CollapseRule> m_rules;
+        uint32_t m_usedBits = 0;
+    };
+
+    // Compiles variants of one shader on first use, through the bytecode
+    // cache. Main thread only.
+    class ShaderVariantCache
+    {
+    public:
+        ShaderVariantCache(ShaderCache* cache, const ShaderPermutationSpace& space, const ShaderCompileRequest& base);
+
+        // Canonicalizes the key; failed variants are remembered, not retried
+        const ShaderCompileResult& Get(ShaderVariantKey key);
+
+        // Compile the missing ones as one parallel batch
+        void Prewarm(const std::vector<ShaderVariantKey>& keys);
+
+        // Every key compiled so far, failed ones included (hot reload rebuilds these)
+        void GetKeys(std::vector<ShaderVariantKey>& outKeys) const;
+
+        // Swap in a result compiled outside the cache, e.g. by hot reload
+        void Replace(ShaderVariantKey key, ShaderCompileResult&& result);
+
+        // Thread safe: only reads the space and the base request
+        ShaderCompileRequest MakeRequest(ShaderVariantKey key) const;
+
+        ShaderCache* GetCache() const { return m_cache; }
+        const ShaderCompileRequest& GetBaseRequest() const { return m_base; }
+        const ShaderPermutationSpace& GetSpace() const { return m_space; }
+        size_t GetVariantCount() const { return m_variants.size(); }
+
+    private:
+
+        ShaderCache* m_cache = nullptr;
+        ShaderPermutationSpace m_space;
+        ShaderCompileRequest m_base;
+        std::unordered_map<ShaderVariantKey, ShaderCompileResult> m_variants;
+    };
+
+} // namespace Engine::Graphics
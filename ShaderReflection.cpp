@@ -0,0 +1,245 @@
+#include "ShaderReflection.h"
+#include "AssetCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+// -----------------------------
+// ShaderReflectionData
+// -----------------------------
+const ShaderConstantBufferInfo* ShaderReflectionData::FindConstantBuffer(const std::string& name) const
+{
+    for (const ShaderConstantBufferInfo& cb : constantBuffers)
+    {
+        if (cb.name == name)
+            return &cb;
+    }
+    return nullptr;
+}
+
+void ShaderReflectionData::Serialize(BinaryWriter& writer) const
+{
+    writer.WriteValue((uint32_t)constantBuffers.size());
+    for (const ShaderConstantBufferInfo& cb : constantBuffers)
+    {
+        writer.WriteString(cb.name);
+        writer.WriteValue(cb.slot);
+        writer.WriteValue(cb.size);
+        writer.WriteValue((uint32_t)cb.variables.size());
+        for (const ShaderVariableInfo& var : cb.variables)
+        {
+            writer.WriteString(var.name);
+            writer.WriteValue(var.offset);
+            writer.WriteValue(var.size);
+            writer.WriteValue((uint8_t)(var.used ? 1 : 0));
+        }
+    }
+
+    writer.WriteValue((uint32_t)bindings.size());
+    for (const ShaderResourceBindingInfo& binding : bindings)
+    {
+        writer.WriteString(binding.name);
+        writer.WriteValue(binding.type);
+        writer.WriteValue(binding.slot);
+        writer.WriteValue(binding.count);
+    }
+}
+
+bool ShaderReflectionData::Deserialize(BinaryReader& reader)
+{
+    constantBuffers.clear();
+    bindings.clear();
+
+    uint32_t cbCount = 0;
+    if (!reader.ReadValue(cbCount))
+        return false;
+
+    for (uint32_t i = 0; i < cbCount; ++i)
+    {
+        ShaderConstantBufferInfo cb;
+        uint32_t varCount = 0;
+        if (!reader.ReadString(cb.name) || !reader.ReadValue(cb.slot) || !reader.ReadValue(cb.size) ||
+            !reader.ReadValue(varCount))
+            return false;
+
+        for (uint32_t v = 0; v < varCount; ++v)
+        {
+            ShaderVariableInfo var;
+            uint8_t used = 0;
+            if (!reader.ReadString(var.name) || !reader.ReadValue(var.offset) || !reader.ReadValue(var.size) ||
+                !reader.ReadValue(used))
+                return false;
+            var.used = used != 0;
+            cb.variables.push_back(std::move(var));
+        }
+        constantBuffers.push_back(std::move(cb));
+    }
+
+    uint32_t bindingCount = 0;
+    if (!reader.ReadValue(bindingCount))
+        return false;
+
+    for (uint32_t i = 0; i < bindingCount; ++i)
+    {
+        ShaderResourceBindingInfo binding;
+        if (!reader.ReadString(binding.name) || !reader.ReadValue(binding.type) || !reader.ReadValue(binding.slot) ||
+            !reader.ReadValue(binding.count))
+            return false;
+        bindings.push_back(std::move(binding));
+    }
+    return true;
+}
+
+// -----------------------------
+// ShaderBindingTable
+// -----------------------------
+namespace
+{
+    void MergeRanges(std::vector<ByteRange>& ranges)
+    {
+        std::sort(ranges.begin(), ranges.end(),
+            [](const ByteRange& a, const ByteRange& b) { return a.offset < b.offset; });
+
+        std::vector<ByteRange> merged;
+        for (const ByteRange& r : ranges)
+        {
+            if (!merged.empty() && r.offset <= merged.back().offset + merged.back().size)
+            {
+                uint32_t end = std::max(merged.back().offset + merged.back().size, r.offset + r.size);
+                merged.back().size = end - merged.back().offset;
+            }
+            else
+            {
+                merged.push_back(r);
+            }
+        }
+        ranges.swap(merged);
+    }
+}
+
+void ShaderBindingTable::Clear()
+{
+    m_constantBuffers.clear();
+    m_stageConflicts.clear();
+}
+
+void ShaderBindingTable::AddStage(const ShaderReflectionData& stage, ShaderStageFlags stageFlag)
+{
+    for (const ShaderConstantBufferInfo& cb : stage.constantBuffers)
+    {
+        auto it = std::find_if(m_constantBuffers.begin(), m_constantBuffers.end(),
+            [&cb](const ConstantBufferBinding& b) { return b.name == cb.name; });
+
+        if (it == m_constantBuffers.end())
+        {
+            ConstantBufferBinding binding;
+            binding.name = cb.name;
+            binding.slot = cb.slot;
+            m_constantBuffers.push_back(binding);
+            it = m_constantBuffers.end() - 1;
+        }
+
+        if (it->slot != cb.slot)
+            m_stageConflicts.push_back("cbuffer " + cb.name + " is bound at b" + std::to_string(it->slot) +
+                " and b" + std::to_string(cb.slot) + " by different stages");
+
+        it->stages |= stageFlag;
+        it->size = std::max(it->size, cb.size);
+
+        for (const ShaderVariableInfo& var : cb.variables)
+        {
+            auto existing = std::find_if(it->variables.begin(), it->variables.end(),
+                [&var](const ShaderVariableInfo& v) { return v.name == var.name; });
+
+            if (existing == it->variables.end())
+                it->variables.push_back(var);
+            else if (existing->offset != var.offset || existing->size != var.size)
+                m_stageConflicts.push_back(cb.name + "." + var.name + " differs between stages");
+            else
+                existing->used |= var.used;
+        }
+
+        // Whole registers: partial writes never split a float4
+        for (const ShaderVariableInfo& var : cb.variables)
+        {
+            if (!var.used || var.size == 0)
+                continue;
+            uint32_t begin = var.offset & ~15u;
+            uint32_t end = (var.offset + var.size + 15) & ~15u;
+            it->usedRanges.push_back({ begin, end - begin });
+        }
+        MergeRanges(it->usedRanges);
+    }
+}
+
+const ConstantBufferBinding* ShaderBindingTable::FindConstantBuffer(const std::string& name) const
+{
+    for (const ConstantBufferBinding& cb : m_constantBuffers)
+    {
+        if (cb.name == name)
+            return &cb;
+    }
+    return nullptr;
+}
+
+bool ShaderBindingTable::Validate(const ConstantBufferLayout* layouts, size_t layoutCount, const std::string& programName,
+    std::string& outErrors) const
+{
+    bool valid = true;
+    auto fail = [&](const std::string& message)
+        {
+            outErrors += programName + ": " + message + "\n";
+            valid = false;
+        };
+
+    for (const std::string& conflict : m_stageConflicts)
+        fail(conflict);
+
+    for (const ConstantBufferBinding& cb : m_constantBuffers)
+    {
+        const ConstantBufferLayout* layout = nullptr;
+        for (size_t i = 0; i < layoutCount; ++i)
+        {
+            if (cb.name == layouts[i].name)
+                layout = &layouts[i];
+        }
+
+        if (!layout)
+        {
+            fail("cbuffer " + cb.name + " has no C++ layout");
+            continue;
+        }
+        if (layout->slot != cb.slot)
+            fail("cbuffer " + cb.name + " is at b" + std::to_string(cb.slot) + ", C++ expects b" + std::to_string(layout->slot));
+        if (cb.size > ((layout->size + 15) & ~15u))
+            fail("cbuffer " + cb.name + " is " + std::to_string(cb.size) + " bytes, C++ struct is " + std::to_string(layout->size));
+
+        for (const ShaderVariableInfo& var : cb.variables)
+        {
+            const ConstantBufferMember* member = nullptr;
+            for (size_t m = 0; m < layout->memberCount; ++m)
+            {
+                if (var.name == layout->members[m].name)
+                    member = &layout->members[m];
+            }
+
+            std::string where = cb.name + "." + var.name;
+            if (!member)
+            {
+                fail(where + " has no C++ member");
+                continue;
+            }
+            if (member->offset != var.offset)
+                fail(where + " is at offset " + std::to_string(var.offset) + ", C++ has " + std::to_string(member->offset));
+
+            // HLSL arrays drop the padding after their last element
+            if (var.size > member->size || member->size - var.size >= 16)
+                fail(where + " is " + std::to_string(var.size) + " bytes, C++ has " + std::to_string(member->size));
+        }
+    }
+
+    return valid;
+}
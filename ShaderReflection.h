@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine::Core
+{
+    class BinaryWriter;
+    class BinaryReader;
+}
+
+namespace Engine::Graphics
+{
+    struct ShaderVariableInfo
+    {
+        std::string name;
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        bool used = false;      // referenced by the compiled code
+    };
+
+    struct ShaderConstantBufferInfo
+    {
+        std::string name;
+        uint32_t slot = 0;
+        uint32_t size = 0;
+        std::vector<ShaderVariableInfo> variables;
+    };
+
+    enum class ShaderBindingType : uint32_t
+    {
+        ConstantBuffer,
+        Texture,
+        Sampler,
+        Other
+    };
+
+    struct ShaderResourceBindingInfo
+    {
+        std::string name;
+        ShaderBindingType type = ShaderBindingType::Other;
+        uint32_t slot = 0;
+        uint32_t count = 1;
+    };
+
+    // What one compiled stage declares. Produced by the compiler backend and
+    // stored next to the bytecode in the shader cache.
+    struct ShaderReflectionData
+    {
+        std::vector<ShaderConstantBufferInfo> constantBuffers;
+        std::vector<ShaderResourceBindingInfo> bindings;
+
+        const ShaderConstantBufferInfo* FindConstantBuffer(const std::string& name) const;
+
+        void Serialize(Engine::Core::BinaryWriter& writer) const;
+        bool Deserialize(Engine::Core::BinaryReader& reader);
+    };
+
+    // -----------------------------
+    // C++ side of a cbuffer, checked against reflection at load time
+    // -----------------------------
+    struct ConstantBufferMember
+    {
+        const char* name;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+#define CB_MEMBER(type, member) \
+    ::Engine::Graphics::ConstantBufferMember{ #member, (uint32_t)offsetof(type, member), (uint32_t)sizeof(((type*)nullptr)->member) }
+
+    struct ConstantBufferLayout
+    {
+        const char* name;
+        uint32_t slot;
+        uint32_t size;
+        const ConstantBufferMember* members;
+        size_t memberCount;
+    };
+
+    struct ByteRange
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    enum ShaderStageFlags : uint32_t
+    {
+        SHADER_STAGE_VERTEX = 1,
+        SHADER_STAGE_PIXEL = 2,
+        SHADER_STAGE_GEOMETRY = 4
+    };
+
+    struct ConstantBufferBinding
+    {
+        std::string name;
+        uint32_t slot = 0;
+        uint32_t size = 0;
+        uint32_t stages = 0;                // ShaderStageFlags
+        std::vector<ShaderVariableInfo> variables;
+        std::vector<ByteRange> usedRanges;  // 16-byte aligned, merged, across all stages
+    };
+
+    // Merged view of the stages of one program: which cbuffers it binds at
+    // which slot, and which bytes of them the code actually reads.
+    class ShaderBindingTable
+    {
+    public:
+        void Clear();
+        void AddStage(const ShaderReflectionData& stage, ShaderStageFlags stageFlag);
+
+        const ConstantBufferBinding* FindConstantBuffer(const std::string& name) const;
+        const std::vector<ConstantBufferBinding>& GetConstantBuffers() const { return m_constantBuffers; }
+
+        // Every cbuffer must have a layout with the same slot, and every
+        // HLSL variable a C++ member at the same offset and size. Appends a
+        // line per problem to outErrors.
+        bool Validate(const ConstantBufferLayout* layouts, size_t layoutCount, const std::string& programName,
+            std::string& outErrors) const;
+
+    private:
+        std::vector<ConstantBufferBinding> m_constantBuffers;
+        std::vector<std::string> m_stageConflicts;  // same cbuffer declared differently by two stages
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,312 @@
+#include "ShadowAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Smallest |v| over lo..hi
+    float MinAbs(float lo, float hi)
+    {
+        if (lo <= 0.0f && hi >= 0.0f)
+            return 0.0f;
+        return (std::min)(fabsf(lo), fabsf(hi));
+    }
+
+    bool SameRect(const AtlasRect& a, const AtlasRect& b)
+    {
+        return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+    }
+}
+
+// -----------------------------
+// SkylinePacker
+// -----------------------------
+void SkylinePacker::Reset(uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+    m_usedArea = 0;
+    m_skyline.clear();
+    m_skyline.push_back({ 0, 0, width });
+}
+
+bool SkylinePacker::Allocate(uint32_t width, uint32_t height, AtlasRect& outRect)
+{
+    size_t best = m_skyline.size();
+    uint32_t bestTop = UINT32_MAX;
+
+    for (size_t i = 0; i < m_skyline.size(); ++i)
+    {
+        uint32_t x = m_skyline[i].x;
+        if (x + width > m_width)
+            break;
+
+        // The rectangle rests on the highest segment under it
+        uint32_t y = 0;
+        uint32_t remaining = width;
+        for (size_t j = i; remaining > 0; ++j)
+        {
+            y = (std::max)(y, m_skyline[j].y);
+            if (m_skyline[j].width >= remaining)
+                break;
+            remaining -= m_skyline[j].width;
+        }
+
+        // Leftmost wins ties, it comes first
+        if (y + height <= m_height && y + height < bestTop)
+        {
+            best = i;
+            bestTop = y + height;
+        }
+    }
+
+    if (best == m_skyline.size())
+        return false;
+
+    outRect.x = m_skyline[best].x;
+    outRect.y = bestTop - height;
+    outRect.width = width;
+    outRect.height = height;
+
+    // New segment on top, then trim what it covers
+    m_skyline.insert(m_skyline.begin() + best, { outRect.x, bestTop, width });
+    uint32_t end = outRect.x + width;
+    size_t next = best + 1;
+    while (next < m_skyline.size() && m_skyline[next].x < end)
+    {
+        Segment& segment = m_skyline[next];
+        uint32_t covered = end - segment.x;
+        if (segment.width <= covered)
+        {
+            m_skyline.erase(m_skyline.begin() + next);
+            continue;
+        }
+        segment.x += covered;
+        segment.width -= covered;
+        break;
+    }
+
+    // Neighbours at the same height are one segment
+    for (size_t i = 0; i + 1 < m_skyline.size();)
+    {
+        if (m_skyline[i].y == m_skyline[i + 1].y)
+        {
+            m_skyline[i].width += m_skyline[i + 1].width;
+            m_skyline.erase(m_skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    m_usedArea += (uint64_t)width * height;
+    return true;
+}
+
+float SkylinePacker::GetOccupancy() const
+{
+    uint64_t area = (uint64_t)m_width * m_height;
+    return area ? (float)((double)m_usedArea / area) : 0.0f;
+}
+
+// -----------------------------
+// ShadowAtlas
+// -----------------------------
+ShadowAtlas::ShadowAtlas(const ShadowAtlasSettings& settings)
+    : m_settings(settings)
+{
+}
+
+void ShadowAtlas::SetSettings(const ShadowAtlasSettings& settings)
+{
+    // A new atlas size or tile range moves every rect
+    if (settings.atlasSize != m_settings.atlasSize || !settings.cacheStatic)
+        m_cache.clear();
+    m_settings = settings;
+}
+
+float ShadowAtlas::EstimateImportance(const ShadowVector& cameraPosition, float fovY,
+    const ShadowVector& lightPosition, float range)
+{
+    float dx = lightPosition.x - cameraPosition.x;
+    float dy = lightPosition.y - cameraPosition.y;
+    float dz = lightPosition.z - cameraPosition.z;
+    float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+    if (distance <= range)
+        return 1.0f;
+
+    // Tangent of the sphere's angular radius over the tangent of half the view
+    float s = range / distance;
+    float projected = s / sqrtf(1.0f - s * s) / tanf(0.5f * fovY);
+    return (std::min)(projected, 1.0f);
+}
+
+uint32_t ShadowAtlas::GetDesiredTileSize(float importance, const ShadowAtlasSettings& settings)
+{
+    uint32_t maxTile = (std::min)(settings.maxTileSize, settings.atlasSize);
+    float target = importance * maxTile;
+
+    uint32_t size = (std::min)(settings.minTileSize, maxTile);
+    while (size < maxTile && (float)size < target)
+        size *= 2;
+    return size;
+}
+
+uint32_t ShadowAtlas::GetPointLightFaceMask(const ShadowVector& lightPosition, float range, const ShadowAabb& bounds)
+{
+    float lo[3] = { bounds.min.x - lightPosition.x, bounds.min.y - lightPosition.y, bounds.min.z - lightPosition.z };
+    float hi[3] = { bounds.max.x - lightPosition.x, bounds.max.y - lightPosition.y, bounds.max.z - lightPosition.z };
+
+    float distanceSq = 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float d = MinAbs(lo[axis], hi[axis]);
+        distanceSq += d * d;
+    }
+    if (distanceSq > range * range)
+        return 0;
+
+    // Face +axis holds the points with v[axis] >= |v| on the other two axes
+    uint32_t mask = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float otherA = MinAbs(lo[(axis + 1) % 3], hi[(axis + 1) % 3]);
+        float otherB = MinAbs(lo[(axis + 2) % 3], hi[(axis + 2) % 3]);
+        float reach = (std::max)(otherA, otherB);
+
+        if (hi[axis] >= reach)
+            mask |= 1u << (2 * axis);
+        if (-lo[axis] >= reach)
+            mask |= 1u << (2 * axis + 1);
+    }
+    return mask;
+}
+
+bool ShadowAtlas::Pack(const ShadowLightRequest* requests, size_t shadowed)
+{
+    // Largest tiles first, importance order among equals
+    std::vector<uint32_t> packOrder(m_order.begin(), m_order.begin() + shadowed);
+    std::stable_sort(packOrder.begin(), packOrder.end(),
+        [this](uint32_t a, uint32_t b) { return m_tileSize[a] > m_tileSize[b]; });
+
+    m_packer.Reset(m_settings.atlasSize, m_settings.atlasSize);
+    m_tiles.clear();
+    std::fill(m_firstTile.begin(), m_firstTile.end(), INVALID_TILE);
+
+    for (uint32_t index : packOrder)
+    {
+        uint32_t size = m_tileSize[index];
+        m_firstTile[index] = (uint32_t)m_tiles.size();
+        for (uint32_t face = 0; face < requests[index].faceCount; ++face)
+        {
+            ShadowAtlasTile tile;
+            if (!m_packer.Allocate(size, size, tile.rect))
+                return false;
+            tile.request = index;
+            tile.face = face;
+            m_tiles.push_back(tile);
+        }
+    }
+    return true;
+}
+
+void ShadowAtlas::Update(const ShadowLightRequest* requests, size_t count)
+{
+    m_stats = ShadowAtlasStats();
+    m_stats.lightsRequested = (uint32_t)count;
+    m_firstTile.assign(count, INVALID_TILE);
+    m_tileSize.assign(count, 0);
+    m_tiles.clear();
+
+    // Most important first, the id breaks ties so the order holds from frame to frame
+    m_order.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (requests[i].faceCount > 0 && requests[i].importance >= m_settings.minImportance)
+            m_order.push_back((uint32_t)i);
+    }
+    std::sort(m_order.begin(), m_order.end(), [requests](uint32_t a, uint32_t b)
+        {
+            if (requests[a].importance != requests[b].importance)
+                return requests[a].importance > requests[b].importance;
+            return requests[a].lightId < requests[b].lightId;
+        });
+
+    size_t wanted = m_order.size();
+    size_t shadowed = (std::min)(wanted, (size_t)m_settings.maxLights);
+    for (size_t k = 0; k < shadowed; ++k)
+        m_tileSize[m_order[k]] = GetDesiredTileSize(requests[m_order[k]].importance, m_settings);
+
+    // Over budget: halve the least important tile that can still shrink,
+    // drop the least important light once all are at the minimum
+    const uint64_t budget = (uint64_t)m_settings.atlasSize * m_settings.atlasSize;
+    const uint32_t minTile = (std::min)(m_settings.minTileSize, m_settings.atlasSize);
+    while (shadowed > 0)
+    {
+        uint64_t area = 0;
+        for (size_t k = 0; k < shadowed; ++k)
+        {
+            uint64_t size = m_tileSize[m_order[k]];
+            area += size * size * requests[m_order[k]].faceCount;
+        }
+        if (area <= budget && Pack(requests, shadowed))
+            break;
+
+        size_t k = shadowed;
+        while (k > 0 && m_tileSize[m_order[k - 1]] <= minTile)
+            --k;
+
+        if (k > 0)
+        {
+            m_tileSize[m_order[k - 1]] /= 2;
+        }
+        else
+        {
+            m_tileSize[m_order[shadowed - 1]] = 0;
+            --shadowed;
+        }
+    }
+
+    if (shadowed == 0)
+    {
+        m_tiles.clear();
+        std::fill(m_firstTile.begin(), m_firstTile.end(), INVALID_TILE);
+    }
+
+    // Reuse a tile when it landed on the same rect for the same static light
+    // and neither a dynamic caster is in it now nor was one last frame
+    std::unordered_map<uint64_t, CachedTile> cache;
+    for (ShadowAtlasTile& tile : m_tiles)
+    {
+        const ShadowLightRequest& request = requests[tile.request];
+        uint64_t key = ((uint64_t)request.lightId << 32) | tile.face;
+        bool dynamic = (request.dynamicFaceMask >> tile.face) & 1;
+
+        auto it = m_cache.find(key);
+        bool reuse = m_settings.cacheStatic && request.isStatic && !dynamic &&
+            it != m_cache.end() && !it->second.dynamic && SameRect(it->second.rect, tile.rect) &&
+            it->second.position.x == request.position.x && it->second.position.y == request.position.y &&
+            it->second.position.z == request.position.z && it->second.range == request.range;
+
+        tile.render = !reuse;
+        if (tile.render)
+            ++m_stats.tilesRendered;
+        else
+            ++m_stats.tilesCached;
+
+        CachedTile& cached = cache[key];
+        cached.rect = tile.rect;
+        cached.position = request.position;
+        cached.range = request.range;
+        cached.dynamic = dynamic;
+    }
+    m_cache.swap(cache);
+
+    m_stats.lightsShadowed = (uint32_t)shadowed;
+    m_stats.lightsDropped = (uint32_t)(wanted - shadowed);
+    m_stats.occupancy = shadowed ? m_packer.GetOccupancy() : 0.0f;
+}
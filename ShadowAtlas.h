@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "CascadeShadows.h"
+
+namespace Engine::Graphics
+{
+    // Texels of the atlas, origin at the top left
+    struct AtlasRect
+    {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    // Bottom-left skyline packer: the atlas is filled as a row of segments,
+    // each rectangle goes where its top ends lowest. Power-of-two squares
+    // sorted largest first pack without gaps.
+    class SkylinePacker
+    {
+    public:
+        void Reset(uint32_t width, uint32_t height);
+        bool Allocate(uint32_t width, uint32_t height, AtlasRect& outRect);
+
+        uint64_t GetUsedArea() const { return m_usedArea; }
+        float GetOccupancy() const;
+
+    private:
+        struct Segment
+        {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+        };
+
+        std::vector<Segment> m_skyline;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint64_t m_usedArea = 0;
+    };
+
+    struct ShadowAtlasSettings
+    {
+        uint32_t atlasSize = 4096;
+        uint32_t maxTileSize = 1024;    // a light filling the screen height
+        uint32_t minTileSize = 64;
+        uint32_t maxLights = 16;        // shadowed lights per frame, most important first
+        float minImportance = 0.02f;    // smaller on screen than this: no shadow
+        bool cacheStatic = true;        // keep tiles of static lights until something in them changes
+    };
+
+    // One light that wants a shadow this frame. Point lights take six tiles
+    // (cube faces: +X, -X, +Y, -Y, +Z, -Z), spot lights one.
+    struct ShadowLightRequest
+    {
+        uint32_t lightId = 0;           // stable across frames, the cache key
+        uint32_t faceCount = 1;
+        float importance = 0.0f;        // EstimateImportance
+        bool isStatic = true;           // lights that move redraw every frame
+        ShadowVector position;
+        float range = 0.0f;
+        uint32_t dynamicFaceMask = 0;   // faces a dynamic caster reaches this frame
+    };
+
+    struct ShadowAtlasTile
+    {
+        AtlasRect rect;
+        uint32_t request = 0;           // index into the requests passed to Update
+        uint32_t face = 0;
+        bool render = false;            // false: last frame's depth in this rect is still valid
+    };
+
+    struct ShadowAtlasStats
+    {
+        uint32_t lightsRequested = 0;
+        uint32_t lightsShadowed = 0;
+        uint32_t lightsDropped = 0;     // wanted a shadow, did not fit the budget or the light limit
+        uint32_t tilesRendered = 0;
+        uint32_t tilesCached = 0;
+        float occupancy = 0.0f;
+    };
+
+    // Per-frame layout of the local light shadow atlas. Tile sizes follow
+    // screen coverage and shrink, least important light first, until the
+    // atlas holds them. The packing is deterministic, so an unchanged set of
+    // sizes gives the same rects and static tiles are reused.
+    class ShadowAtlas
+    {
+    public:
+        static constexpr uint32_t INVALID_TILE = 0xFFFFFFFF;
+
+        explicit ShadowAtlas(const ShadowAtlasSettings& settings);
+
+        void SetSettings(const ShadowAtlasSettings& settings);
+        const ShadowAtlasSettings& GetSettings() const { return m_settings; }
+
+        void Update(const ShadowLightRequest* requests, size_t count);
+
+        // Every cached tile is redrawn on the next Update (static geometry changed)
+        void Invalidate() { m_cache.clear(); }
+
+        const std::vector<ShadowAtlasTile>& GetTiles() const { return m_tiles; }
+
+        // First tile of a request (faces follow in order), INVALID_TILE when it got no shadow
+        uint32_t GetFirstTile(size_t request) const { return m_firstTile[request]; }
+        uint32_t GetTileSize(size_t request) const { return m_tileSize[request]; }
+        const ShadowAtlasStats& GetStats() const { return m_stats; }
+
+        // Projected diameter of the light's sphere over the screen height, 1 with the camera inside it
+        static float EstimateImportance(const ShadowVector& cameraPosition, float fovY,
+            const ShadowVector& lightPosition, float range);
+
+        // Power of two for the importance, minTileSize..maxTileSize
+        static uint32_t GetDesiredTileSize(float importance, const ShadowAtlasSettings& settings);
+
+        // Cube faces of a point light whose frustum the box may reach, 0 when it is out of range.
+        // Conservative: a box near a face's edge counts for both faces.
+        static uint32_t GetPointLightFaceMask(const ShadowVector& lightPosition, float range, const ShadowAabb& bounds);
+
+    private:
+        struct CachedTile
+        {
+            AtlasRect rect;
+            ShadowVector position;
+            float range = 0.0f;
+            bool dynamic = false;       // a dynamic caster was drawn into it
+        };
+
+        ShadowAtlasSettings m_settings;
+        SkylinePacker m_packer;
+        std::vector<ShadowAtlasTile> m_tiles;
+        std::vector<uint32_t> m_firstTile;
+        std::vector<uint32_t> m_tileSize;
+        std::vector<uint32_t> m_order;
+        std::unordered_map<uint64_t, CachedTile> m_cache;  // (light id, face)
+        ShadowAtlasStats m_stats;
+
+        bool Pack(const ShadowLightRequest* requests, size_t shadowed);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,123 @@
+#include "ShadowAtlasD3D11.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Engine::Graphics;
+
+ShadowAtlasMaps::ShadowAtlasMaps(ID3D11Device* device)
+    : m_device(device)
+{
+}
+
+bool ShadowAtlasMaps::Create(uint32_t size)
+{
+    // Typeless so the same texture is a D32 depth target and an R32 float input
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = size;
+    desc.Height = size;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R32_TYPELESS;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+
+    if (FAILED(m_device->CreateTexture2D(&desc, nullptr, m_atlas.GetAddressOf())))
+        return false;
+
+    D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+    dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    if (FAILED(m_device->CreateDepthStencilView(m_atlas.Get(), &dsvDesc, m_atlasDSV.GetAddressOf())))
+        return false;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = 1;
+    if (FAILED(m_device->CreateShaderResourceView(m_atlas.Get(), &srvDesc, m_atlasSRV.GetAddressOf())))
+        return false;
+
+    m_size = size;
+    return true;
+}
+
+void ShadowAtlasMaps::BeginTile(ID3D11DeviceContext* context, const AtlasRect& rect)
+{
+    context->OMSetRenderTargets(0, nullptr, m_atlasDSV.Get());
+
+    D3D11_VIEWPORT vp = {};
+    vp.TopLeftX = (float)rect.x;
+    vp.TopLeftY = (float)rect.y;
+    vp.Width = (float)rect.width;
+    vp.Height = (float)rect.height;
+    vp.MaxDepth = 1.0f;
+    context->RSSetViewports(1, &vp);
+}
+
+bool ShadowAtlasMaps::Write(ID3D11DeviceContext* context, StructuredBuffer& target, uint32_t stride,
+    const void* data, uint32_t count)
+{
+    // Grow by half again so a slowly rising count does not recreate every frame
+    if (!target.buffer || count > target.capacity)
+    {
+        uint32_t capacity = (std::max)((std::max)(count + count / 2, target.capacity), 64u);
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = capacity * stride;
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = stride;
+
+        ComPtr<ID3D11Buffer> buffer;
+        if (FAILED(m_device->CreateBuffer(&desc, nullptr, buffer.GetAddressOf())))
+            return false;
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvDesc.Buffer.FirstElement = 0;
+        srvDesc.Buffer.NumElements = capacity;
+
+        ComPtr<ID3D11ShaderResourceView> view;
+        if (FAILED(m_device->CreateShaderResourceView(buffer.Get(), &srvDesc, view.GetAddressOf())))
+            return false;
+
+        target.buffer = buffer;
+        target.view = view;
+        target.capacity = capacity;
+    }
+
+    if (count == 0)
+        return true;
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(context->Map(target.buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+        return false;
+    memcpy(mapped.pData, data, (size_t)count * stride);
+    context->Unmap(target.buffer.Get(), 0);
+    return true;
+}
+
+bool ShadowAtlasMaps::Update(ID3D11DeviceContext* context, const ShadowAtlasTileGpu* tiles, uint32_t tileCount,
+    const int32_t* lightTiles, uint32_t lightCount)
+{
+    bool ok = Write(context, m_tiles, sizeof(ShadowAtlasTileGpu), tiles, tileCount);
+    ok &= Write(context, m_lightTiles, sizeof(int32_t), lightTiles, lightCount);
+    return ok;
+}
+
+void ShadowAtlasMaps::Bind(ID3D11DeviceContext* context) const
+{
+    ID3D11ShaderResourceView* views[3] = { m_atlasSRV.Get(), m_tiles.view.Get(), m_lightTiles.view.Get() };
+    context->PSSetShaderResources(FIRST_SLOT, 3, views);
+}
+
+void ShadowAtlasMaps::UnbindInputs(ID3D11DeviceContext* context)
+{
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    context->PSSetShaderResources(FIRST_SLOT, 1, &nullSRV);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include "ShadowAtlas.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // One atlas tile as Lighting.hlsli reads it
+    struct ShadowAtlasTileGpu
+    {
+        DirectX::XMFLOAT4X4 ViewProj;   // transposed
+        DirectX::XMFLOAT4 Rect;         // xy scale, zw offset: tile UV to atlas UV
+    };
+
+    // GPU side of the local light shadows: one D32 atlas for every shadowed
+    // light, plus the tiles (t11) and the first tile of each clustered light
+    // (t12, -1 without a shadow). Tiles are drawn in place, the ShadowAtlas
+    // layout decides which ones.
+    class ShadowAtlasMaps
+    {
+    public:
+        // Lighting inputs: t10 atlas, t11 tiles, t12 first tile per clustered light
+        static const UINT FIRST_SLOT = 10;
+
+        ShadowAtlasMaps(ID3D11Device* device);
+
+        bool Create(uint32_t size);
+
+        // Binds the atlas as the depth target with the viewport on the tile
+        void BeginTile(ID3D11DeviceContext* context, const AtlasRect& rect);
+
+        bool Update(ID3D11DeviceContext* context, const ShadowAtlasTileGpu* tiles, uint32_t tileCount,
+            const int32_t* lightTiles, uint32_t lightCount);
+
+        void Bind(ID3D11DeviceContext* context) const;
+
+        // Drops the atlas from the pixel stage before tiles are drawn into it
+        void UnbindInputs(ID3D11DeviceContext* context);
+
+        uint32_t GetSize() const { return m_size; }
+
+    private:
+        struct StructuredBuffer
+        {
+            ComPtr<ID3D11Buffer> buffer;
+            ComPtr<ID3D11ShaderResourceView> view;
+            uint32_t capacity = 0;
+        };
+
+        ComPtr<ID3D11Device> m_device;
+        ComPtr<ID3D11Texture2D> m_atlas;
+        ComPtr<ID3D11DepthStencilView> m_atlasDSV;
+        ComPtr<ID3D11ShaderResourceView> m_atlasSRV;
+        StructuredBuffer m_tiles;
+        StructuredBuffer m_lightTiles;
+        uint32_t m_size = 0;
+
+        bool Write(ID3D11DeviceContext* context, StructuredBuffer& target, uint32_t stride, const void* data, uint32_t count);
+    };
+
+} // namespace Engine::Graphics
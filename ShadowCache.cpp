@@ -0,0 +1,64 @@
+#include "ShadowCache.h"
+
+#include <cstring>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Exact compare: the stable fit snaps to texels, so unchanged means bit-identical
+    bool SamePlacement(const LightBasis& basisA, const CascadeBounds& boundsA,
+        const LightBasis& basisB, const CascadeBounds& boundsB)
+    {
+        return memcmp(&basisA, &basisB, sizeof(LightBasis)) == 0 &&
+            memcmp(&boundsA, &boundsB, sizeof(CascadeBounds)) == 0;
+    }
+}
+
+ShadowCacheScheduler::ShadowCacheScheduler(uint32_t cascadeCount, const ShadowCacheConfig& config)
+    : m_config(config)
+    , m_cascades(cascadeCount)
+{
+}
+
+void ShadowCacheScheduler::InvalidateStatic()
+{
+    for (CascadeState& cascade : m_cascades)
+        cascade.staticValid = false;
+}
+
+void ShadowCacheScheduler::Schedule(const LightBasis& basis, const CascadeBounds* bounds, ShadowCascadeUpdate* outUpdates)
+{
+    m_stats = ShadowCacheStats();
+    const uint32_t period = m_config.roundRobinPeriod ? m_config.roundRobinPeriod : 1;
+
+    for (uint32_t c = 0; c < (uint32_t)m_cascades.size(); ++c)
+    {
+        CascadeState& cascade = m_cascades[c];
+        ShadowCascadeUpdate& update = outUpdates[c];
+
+        // Staggered by index so round-robin cascades take turns instead of all landing on one frame
+        bool due = c < m_config.roundRobinFirst || !cascade.rendered || (m_frame + c) % period == 0;
+        if (!due)
+        {
+            update = ShadowCascadeUpdate();
+            ++m_stats.cascadesSkipped;
+            continue;
+        }
+
+        bool moved = !SamePlacement(cascade.basis, cascade.bounds, basis, bounds[c]);
+        update.update = true;
+        update.renderStatic = !m_config.cacheStatic || !cascade.staticValid || moved;
+
+        cascade.basis = basis;
+        cascade.bounds = bounds[c];
+        cascade.rendered = true;
+        cascade.staticValid = true;
+
+        ++m_stats.cascadesUpdated;
+        if (update.renderStatic)
+            ++m_stats.staticRenders;
+    }
+
+    ++m_frame;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CascadeShadows.h"
+
+namespace Engine::Graphics
+{
+    struct ShadowCacheConfig
+    {
+        bool cacheStatic = true;            // keep static casters between frames
+        uint32_t roundRobinFirst = 2;       // cascades from here on do not update every frame
+        uint32_t roundRobinPeriod = 2;      // ... but once every this many frames, staggered
+    };
+
+    // What one cascade does this frame
+    struct ShadowCascadeUpdate
+    {
+        bool update = false;            // redrawn at all; otherwise map and matrix stay as they were
+        bool renderStatic = false;      // static casters re-rendered into the cache first
+    };
+
+    struct ShadowCacheStats
+    {
+        uint32_t cascadesUpdated = 0;
+        uint32_t staticRenders = 0;     // cascades whose static casters were drawn this frame
+        uint32_t cascadesSkipped = 0;   // waiting for their round-robin turn
+    };
+
+    // Decides per frame which shadow cascades to redraw and which need their
+    // static casters again. The static part of a cascade stays valid while
+    // its placement (light basis and texel-snapped bounds) is unchanged and
+    // no static geometry changed. CPU only; the renderer does the drawing.
+    class ShadowCacheScheduler
+    {
+    public:
+        ShadowCacheScheduler(uint32_t cascadeCount, const ShadowCacheConfig& config = ShadowCacheConfig());
+
+        void SetConfig(const ShadowCacheConfig& config) { m_config = config; }
+        const ShadowCacheConfig& GetConfig() const { return m_config; }
+
+        // Static casters moved, appeared or went away: every cascade redraws them on its next update
+        void InvalidateStatic();
+
+        // bounds has one entry per cascade, as fitted this frame. outUpdates gets one entry per cascade.
+        void Schedule(const LightBasis& basis, const CascadeBounds* bounds, ShadowCascadeUpdate* outUpdates);
+
+        const ShadowCacheStats& GetStats() const { return m_stats; }
+        uint64_t GetFrame() const { return m_frame; }
+
+    private:
+        struct CascadeState
+        {
+            LightBasis basis;
+            CascadeBounds bounds;
+            bool rendered = false;      // the shadow map holds this cascade at all
+            bool staticValid = false;
+        };
+
+        ShadowCacheConfig m_config;
+        std::vector<CascadeState> m_cascades;
+        ShadowCacheStats m_stats;
+        uint64_t m_frame = 0;
+    };
+
+} // namespace Engine::Graphics
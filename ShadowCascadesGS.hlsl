@@ -0,0 +1,25 @@
+// Fallback for ShadowCascadesVS.hlsl without RT array index output from the
+// VS: passes each triangle through to the cascade slice it was instanced for.
+struct GSInput
+{
+    float4 position : SV_POSITION;
+    uint cascade : CASCADE;
+};
+
+struct GSOutput
+{
+    float4 position : SV_POSITION;
+    uint cascade : SV_RenderTargetArrayIndex;
+};
+
+[maxvertexcount(3)]
+void main(triangle GSInput input[3], inout TriangleStream<GSOutput> stream)
+{
+    for (uint i = 0; i < 3; ++i)
+    {
+        GSOutput output;
+        output.position = input[i].position;
+        output.cascade = input[i].cascade;
+        stream.Append(output);
+    }
+}
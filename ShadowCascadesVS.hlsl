@@ -0,0 +1,48 @@
+// Single-pass cascaded shadows: one instance per cascade the object overlaps
+// (CascadeRange.x first, .y count), all drawn into the cascade array at once.
+// RT_INDEX_FROM_VS=1 needs VPAndRTArrayIndexFromAnyShaderFeedingRasterizer
+// (D3D11.3); otherwise ShadowCascadesGS.hlsl routes the triangles.
+#ifndef RT_INDEX_FROM_VS
+#define RT_INDEX_FROM_VS 1
+#endif
+
+#define NUM_CASCADES 4
+
+// Only the members this shader reads: LightViewProj is also a CBShadow name
+cbuffer CBPerObject : register(b0)
+{
+    float4x4 World : packoffset(c0);
+    uint4 CascadeRange : packoffset(c20);
+};
+
+cbuffer CBShadow : register(b2)
+{
+    float4x4 LightViewProj[NUM_CASCADES];
+    float4 CascadeSplits;
+};
+
+struct VSInput
+{
+    float3 position : POSITION;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+#if RT_INDEX_FROM_VS
+    uint cascade : SV_RenderTargetArrayIndex;
+#else
+    uint cascade : CASCADE;
+#endif
+};
+
+VSOutput main(VSInput input, uint instance : SV_InstanceID)
+{
+    VSOutput output;
+
+    uint cascade = CascadeRange.x + instance;
+    float4 worldPosition = mul(float4(input.position, 1.0f), World);
+    output.position = mul(worldPosition, LightViewProj[cascade]);
+    output.cascade = cascade;
+    return output;
+}
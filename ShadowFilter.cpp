@@ -0,0 +1,194 @@
+#include "ShadowFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Same order as Lighting.hlsli: the first four are spread out for the early-out
+    const float POISSON_DISK[ShadowFilter::POISSON_TAPS][2] =
+    {
+        {  0.94558609f, -0.76890725f },
+        { -0.91588581f,  0.45771432f },
+        {  0.97484398f,  0.75648379f },
+        { -0.81544232f, -0.87912464f },
+        { -0.94201624f, -0.39906216f },
+        { -0.09418410f, -0.92938870f },
+        {  0.34495938f,  0.29387760f },
+        { -0.38277543f,  0.27676845f },
+        {  0.44323325f, -0.97511554f },
+        {  0.53742981f, -0.47373420f },
+        { -0.26496911f, -0.41893023f },
+        {  0.79197514f,  0.19090188f },
+        { -0.24188840f,  0.99706507f },
+        { -0.81409955f,  0.91437590f },
+        {  0.19984126f,  0.78641367f },
+        {  0.14383161f, -0.14100790f }
+    };
+
+    void Count(ShadowFilterStats* stats, uint32_t fetches, bool earlyOut)
+    {
+        if (!stats)
+            return;
+        ++stats->evaluations;
+        stats->fetches += fetches;
+        if (earlyOut)
+            ++stats->earlyOuts;
+    }
+}
+
+float ShadowFilter::GetFilterRadius(float texelSize, const ShadowFilterSettings& settings)
+{
+    float radius = texelSize > 0.0f ? 0.5f * settings.penumbraWidth / texelSize : 0.0f;
+    return (std::min)(radius, settings.maxRadius);
+}
+
+uint32_t ShadowFilter::GetKernelSize(float radiusTexels)
+{
+    int size = 2 * (int)floorf(radiusTexels + 0.5f) + 1;
+    return (uint32_t)(std::clamp)(size, 1, (int)MAX_KERNEL_SIZE);
+}
+
+uint32_t ShadowFilter::GetGatherCount(uint32_t kernelSize)
+{
+    uint32_t quads = (kernelSize + 1) / 2;
+    return quads * quads;
+}
+
+float ShadowFilter::GetCascadeBlend(float viewDepth, float splitNear, float splitFar, float band)
+{
+    float width = band * (splitFar - splitNear);
+    if (width <= 0.0f)
+        return 0.0f;
+    return (std::clamp)((viewDepth - (splitFar - width)) / width, 0.0f, 1.0f);
+}
+
+float ShadowFilter::Compare(const ShadowMapSlice& slice, int x, int y, float depth)
+{
+    int size = (int)slice.size;
+    float texel = (x < 0 || y < 0 || x >= size || y >= size) ? 1.0f : slice.depth[y * size + x];
+    return depth <= texel ? 1.0f : 0.0f;
+}
+
+float ShadowFilter::SampleCmp(const ShadowMapSlice& slice, float u, float v, float depth)
+{
+    float px = u * slice.size - 0.5f;
+    float py = v * slice.size - 0.5f;
+    int x = (int)floorf(px);
+    int y = (int)floorf(py);
+    float fx = px - x;
+    float fy = py - y;
+
+    return
+        Compare(slice, x, y, depth) * (1.0f - fx) * (1.0f - fy) +
+        Compare(slice, x + 1, y, depth) * fx * (1.0f - fy) +
+        Compare(slice, x, y + 1, depth) * (1.0f - fx) * fy +
+        Compare(slice, x + 1, y + 1, depth) * fx * fy;
+}
+
+void ShadowFilter::GatherCmp(const ShadowMapSlice& slice, float u, float v, float depth, float out[4])
+{
+    int x = (int)floorf(u * slice.size - 0.5f);
+    int y = (int)floorf(v * slice.size - 0.5f);
+
+    // x (0, 1), y (1, 1), z (1, 0), w (0, 0)
+    out[0] = Compare(slice, x, y + 1, depth);
+    out[1] = Compare(slice, x + 1, y + 1, depth);
+    out[2] = Compare(slice, x + 1, y, depth);
+    out[3] = Compare(slice, x, y, depth);
+}
+
+float ShadowFilter::Hard(const ShadowMapSlice& slice, float u, float v, float depth, ShadowFilterStats* stats)
+{
+    Count(stats, 1, false);
+    return SampleCmp(slice, u, v, depth);
+}
+
+float ShadowFilter::GatherPcf(const ShadowMapSlice& slice, float u, float v, float depth, uint32_t kernelSize,
+    bool earlyOut, ShadowFilterStats* stats)
+{
+    const float size = (float)slice.size;
+    float px = u * size - 0.5f;
+    float py = v * size - 0.5f;
+    float baseX = floorf(px);
+    float baseY = floorf(py);
+    float fx = px - baseX;
+    float fy = py - baseY;
+
+    int quads = (int)(kernelSize + 1) / 2;
+    float startX = baseX - (float)((kernelSize - 1) / 2);
+    float startY = baseY - (float)((kernelSize - 1) / 2);
+    uint32_t fetches = 0;
+
+    // A gather at the corner shared by four texel centers returns exactly those four
+    auto gather = [&](int qx, int qy, float out[4])
+        {
+            GatherCmp(slice, (startX + 2 * qx + 1.0f) / size, (startY + 2 * qy + 1.0f) / size, depth, out);
+            ++fetches;
+        };
+
+    // Only pays off once the corners are fewer than the whole kernel
+    if (earlyOut && quads > 2)
+    {
+        float sum = 0.0f;
+        const int corners[4][2] = { { 0, 0 }, { quads - 1, 0 }, { 0, quads - 1 }, { quads - 1, quads - 1 } };
+        for (const int* corner : corners)
+        {
+            float c[4];
+            gather(corner[0], corner[1], c);
+            sum += c[0] + c[1] + c[2] + c[3];
+        }
+
+        if (sum == 0.0f || sum == 16.0f)
+        {
+            Count(stats, fetches, true);
+            return sum / 16.0f;
+        }
+    }
+
+    float shadow = 0.0f;
+    for (int qy = 0; qy < quads; ++qy)
+    {
+        for (int qx = 0; qx < quads; ++qx)
+        {
+            float c[4];
+            gather(qx, qy, c);
+
+            // Edge texels of the window carry the bilinear fraction
+            float wx0 = qx == 0 ? 1.0f - fx : 1.0f;
+            float wx1 = qx == quads - 1 ? fx : 1.0f;
+            float wy0 = qy == 0 ? 1.0f - fy : 1.0f;
+            float wy1 = qy == quads - 1 ? fy : 1.0f;
+
+            shadow += c[3] * wx0 * wy0 + c[2] * wx1 * wy0 + c[0] * wx0 * wy1 + c[1] * wx1 * wy1;
+        }
+    }
+
+    Count(stats, fetches, false);
+    return shadow / (float)(kernelSize * kernelSize);
+}
+
+float ShadowFilter::Poisson(const ShadowMapSlice& slice, float u, float v, float depth, float radiusTexels,
+    bool earlyOut, ShadowFilterStats* stats)
+{
+    const float radius = radiusTexels / slice.size;
+    float shadow = 0.0f;
+    uint32_t taps = 0;
+
+    for (uint32_t i = 0; i < POISSON_TAPS; ++i)
+    {
+        shadow += SampleCmp(slice, u + POISSON_DISK[i][0] * radius, v + POISSON_DISK[i][1] * radius, depth);
+        ++taps;
+
+        if (earlyOut && taps == EARLY_OUT_TAPS && (shadow == 0.0f || shadow == (float)EARLY_OUT_TAPS))
+        {
+            Count(stats, taps, true);
+            return shadow / EARLY_OUT_TAPS;
+        }
+    }
+
+    Count(stats, taps, false);
+    return shadow / POISSON_TAPS;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine::Graphics
+{
+    struct ShadowFilterSettings
+    {
+        float penumbraWidth = 0.06f;    // world units: each cascade's kernel covers about this much
+        float maxRadius = 3.0f;         // texels, 3 is the 7x7 kernel
+        bool earlyOut = true;           // corner taps first, the full kernel only in the penumbra
+        float blendBand = 0.1f;         // fraction of a cascade cross-faded into the next one, 0 is off
+    };
+
+    // One cascade slice as the shader sees it: size x size depths, row 0 at v = 0
+    struct ShadowMapSlice
+    {
+        const float* depth = nullptr;
+        uint32_t size = 0;
+    };
+
+    // Texture instructions issued, a gather counts once
+    struct ShadowFilterStats
+    {
+        uint64_t evaluations = 0;
+        uint64_t fetches = 0;
+        uint64_t earlyOuts = 0;
+
+        double GetFetchesPerEvaluation() const
+        {
+            return evaluations ? (double)fetches / evaluations : 0.0;
+        }
+    };
+
+    // CPU reference of the shadow filters in Lighting.hlsli, tap for tap,
+    // with the sampler's LESS_EQUAL compare and 1.0 border
+    class ShadowFilter
+    {
+    public:
+        static const uint32_t MAX_KERNEL_SIZE = 7;
+        static const uint32_t POISSON_TAPS = 16;
+        static const uint32_t EARLY_OUT_TAPS = 4;
+
+        // Kernel radius in texels for a cascade, so the world-space penumbra
+        // stays the same across cascades as far as the kernel sizes allow
+        static float GetFilterRadius(float texelSize, const ShadowFilterSettings& settings);
+
+        // Odd width of the gather kernel for a radius, 1..MAX_KERNEL_SIZE
+        static uint32_t GetKernelSize(float radiusTexels);
+
+        // Gathers for the full kernel: (K + 1) / 2 per axis
+        static uint32_t GetGatherCount(uint32_t kernelSize);
+
+        // 0 inside a cascade, rising to 1 across the last band fraction of it
+        static float GetCascadeBlend(float viewDepth, float splitNear, float splitFar, float band);
+
+        // The hardware operations
+        static float Compare(const ShadowMapSlice& slice, int x, int y, float depth);
+        static float SampleCmp(const ShadowMapSlice& slice, float u, float v, float depth);
+        static void GatherCmp(const ShadowMapSlice& slice, float u, float v, float depth, float out[4]);
+
+        static float Hard(const ShadowMapSlice& slice, float u, float v, float depth, ShadowFilterStats* stats);
+
+        // Castano's optimized PCF: the box of K x K bilinear taps, as (K + 1)^2
+        // texel compares weighted 1 inside and by the bilinear fraction on the
+        // edges, fetched four at a time
+        static float GatherPcf(const ShadowMapSlice& slice, float u, float v, float depth, uint32_t kernelSize,
+            bool earlyOut, ShadowFilterStats* stats);
+
+        static float Poisson(const ShadowMapSlice& slice, float u, float v, float depth, float radiusTexels,
+            bool earlyOut, ShadowFilterStats* stats);
+    };
+
+} // namespace Engine::Graphics
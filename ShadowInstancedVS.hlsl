@@ -0,0 +1,37 @@
+// Shadow caster for indirect draws: one cascade per draw (CascadeRange.x),
+// the world matrix from the object the instance stream names.
+#include "Instancing.hlsli"
+
+#define NUM_CASCADES 4
+
+// Only the members this shader reads: LightViewProj is also a CBShadow name
+cbuffer CBPerObject : register(b0)
+{
+    uint4 CascadeRange : packoffset(c20);
+};
+
+cbuffer CBShadow : register(b2)
+{
+    float4x4 LightViewProj[NUM_CASCADES];
+    float4 CascadeSplits;
+};
+
+struct VSInput
+{
+    float3 position : POSITION;
+    uint object : INSTANCE;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+};
+
+VSOutput main(VSInput input)
+{
+    VSOutput output;
+
+    float4 worldPosition = mul(float4(input.position, 1.0f), InstanceTransforms[input.object].World);
+    output.position = mul(worldPosition, LightViewProj[CascadeRange.x]);
+    return output;
+}
@@ -0,0 +1,81 @@
+#include "ShadowMoments.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+void ShadowMoments::WarpDepth(float depth, const EvsmSettings& settings, float& outPositive, float& outNegative)
+{
+    float positiveExponent = (std::min)(settings.positiveExponent, MAX_EXPONENT);
+    float negativeExponent = (std::min)(settings.negativeExponent, MAX_EXPONENT);
+
+    float d = 2.0f * depth - 1.0f;
+    outPositive = expf(positiveExponent * d);
+    outNegative = -expf(-negativeExponent * d);
+}
+
+EvsmMoments ShadowMoments::ComputeMoments(float depth, const EvsmSettings& settings)
+{
+    float p, n;
+    WarpDepth(depth, settings, p, n);
+
+    EvsmMoments moments;
+    moments.positive = p;
+    moments.positiveSq = p * p;
+    moments.negative = n;
+    moments.negativeSq = n * n;
+    return moments;
+}
+
+float ShadowMoments::ChebyshevUpperBound(float mean, float meanSq, float value, float minVariance)
+{
+    if (value <= mean)
+        return 1.0f;
+
+    float variance = (std::max)(meanSq - mean * mean, minVariance);
+    float distance = value - mean;
+    return variance / (variance + distance * distance);
+}
+
+float ShadowMoments::ReduceLightBleeding(float pMax, float amount)
+{
+    if (amount >= 1.0f)
+        return pMax >= 1.0f ? 1.0f : 0.0f;
+    return (std::clamp)((pMax - amount) / (1.0f - amount), 0.0f, 1.0f);
+}
+
+float ShadowMoments::ComputeShadow(const EvsmMoments& moments, float receiverDepth, const EvsmSettings& settings)
+{
+    float positiveExponent = (std::min)(settings.positiveExponent, MAX_EXPONENT);
+    float negativeExponent = (std::min)(settings.negativeExponent, MAX_EXPONENT);
+
+    float p, n;
+    WarpDepth(receiverDepth, settings, p, n);
+
+    // The warp's slope at the receiver turns a depth variance into a warped one
+    float positiveScale = positiveExponent * p;
+    float negativeScale = negativeExponent * n;
+    float positiveBound = ChebyshevUpperBound(moments.positive, moments.positiveSq, p,
+        settings.minVariance * positiveScale * positiveScale);
+    float negativeBound = ChebyshevUpperBound(moments.negative, moments.negativeSq, n,
+        settings.minVariance * negativeScale * negativeScale);
+
+    return ReduceLightBleeding((std::min)(positiveBound, negativeBound), settings.lightBleedingReduction);
+}
+
+void ShadowMoments::ComputeBlurWeights(uint32_t radius, float* outWeights)
+{
+    radius = (std::min)(radius, MAX_BLUR_RADIUS);
+    float sigma = (std::max)(0.5f * (radius + 1), 0.5f);
+
+    float total = 0.0f;
+    for (uint32_t i = 0; i <= radius; ++i)
+    {
+        outWeights[i] = expf(-0.5f * (i * i) / (sigma * sigma));
+        total += (i == 0) ? outWeights[i] : 2.0f * outWeights[i];
+    }
+
+    for (uint32_t i = 0; i <= radius; ++i)
+        outWeights[i] /= total;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine::Graphics
+{
+    struct EvsmSettings
+    {
+        float positiveExponent = 40.0f;     // clamped to MAX_EXPONENT, larger is less light bleeding
+        float negativeExponent = 5.0f;
+        float lightBleedingReduction = 0.25f;   // 0..1, cuts off the tail of the upper bound
+        float minVariance = 1e-4f;          // in depth units, scaled into each warped space
+        uint32_t blurRadius = 2;            // moment texels, 0..MAX_BLUR_RADIUS
+    };
+
+    // Filtered warped depths: E[p], E[p^2], E[n], E[n^2]
+    struct EvsmMoments
+    {
+        float positive = 0.0f;
+        float positiveSq = 0.0f;
+        float negative = 0.0f;
+        float negativeSq = 0.0f;
+    };
+
+    // Exponential variance shadow maps. Depth is warped by exp(c * d) and
+    // -exp(-c * d) so the moments can be filtered like colors (blur, mips,
+    // trilinear), and visibility comes back as the Chebyshev upper bound of
+    // both warps. CPU reference of Evsm.hlsli.
+    class ShadowMoments
+    {
+    public:
+        // exp(2 * c) must stay a finite 32-bit float
+        static constexpr float MAX_EXPONENT = 42.0f;
+        static const uint32_t MAX_BLUR_RADIUS = 7;
+
+        // Depth in 0..1, moved to -1..1 first so both warps use their full range
+        static void WarpDepth(float depth, const EvsmSettings& settings, float& outPositive, float& outNegative);
+        static EvsmMoments ComputeMoments(float depth, const EvsmSettings& settings);
+
+        // Upper bound of P(occluder depth >= value); 1 when value is at or in front of the mean
+        static float ChebyshevUpperBound(float mean, float meanSq, float value, float minVariance);
+
+        // Maps pMax below amount to 0 and rescales the rest, trading some
+        // penumbra for less light leaking through overlapping casters
+        static float ReduceLightBleeding(float pMax, float amount);
+
+        static float ComputeShadow(const EvsmMoments& moments, float receiverDepth, const EvsmSettings& settings);
+
+        // Normalized Gaussian over -radius..radius, outWeights[i] for offset +-i (radius + 1 values)
+        static void ComputeBlurWeights(uint32_t radius, float* outWeights);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,121 @@
+#include "ShadowMomentsD3D11.h"
+
+using namespace Engine::Graphics;
+
+bool ShadowMomentMaps::Create(ID3D11Device* device, uint32_t size, uint32_t cascades)
+{
+    Release();
+    m_size = size;
+    m_mipLevels = 1;
+    while ((size >> m_mipLevels) > 0)
+        ++m_mipLevels;
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = size;
+    desc.Height = size;
+    desc.MipLevels = m_mipLevels;
+    desc.ArraySize = cascades;
+    desc.Format = FORMAT;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+    if (FAILED(device->CreateTexture2D(&desc, nullptr, m_moments.GetAddressOf())) ||
+        FAILED(device->CreateShaderResourceView(m_moments.Get(), nullptr, m_momentSRV.GetAddressOf())))
+    {
+        Release();
+        return false;
+    }
+
+    m_slices.resize(cascades);
+    for (uint32_t i = 0; i < cascades; ++i)
+    {
+        D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+        rtvDesc.Format = FORMAT;
+        rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+        rtvDesc.Texture2DArray.MipSlice = 0;
+        rtvDesc.Texture2DArray.FirstArraySlice = i;
+        rtvDesc.Texture2DArray.ArraySize = 1;
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = FORMAT;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MipLevels = m_mipLevels;
+        srvDesc.Texture2DArray.FirstArraySlice = i;
+        srvDesc.Texture2DArray.ArraySize = 1;
+
+        if (FAILED(device->CreateRenderTargetView(m_moments.Get(), &rtvDesc, m_slices[i].rtv.GetAddressOf())) ||
+            FAILED(device->CreateShaderResourceView(m_moments.Get(), &srvDesc, m_slices[i].srv.GetAddressOf())))
+        {
+            Release();
+            return false;
+        }
+    }
+
+    // The horizontal pass result, one slice at a time
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.MiscFlags = 0;
+    if (FAILED(device->CreateTexture2D(&desc, nullptr, m_scratch.GetAddressOf())) ||
+        FAILED(device->CreateRenderTargetView(m_scratch.Get(), nullptr, m_scratchRTV.GetAddressOf())) ||
+        FAILED(device->CreateShaderResourceView(m_scratch.Get(), nullptr, m_scratchSRV.GetAddressOf())))
+    {
+        Release();
+        return false;
+    }
+    return true;
+}
+
+void ShadowMomentMaps::SetViewport(ID3D11DeviceContext* context) const
+{
+    D3D11_VIEWPORT vp = {};
+    vp.Width = (float)m_size;
+    vp.Height = (float)m_size;
+    vp.MaxDepth = 1.0f;
+    context->RSSetViewports(1, &vp);
+}
+
+void ShadowMomentMaps::BeginConvert(ID3D11DeviceContext* context, ID3D11ShaderResourceView* shadowDepth)
+{
+    // Every texel is written, no clear needed
+    context->OMSetRenderTargets(1, m_scratchRTV.GetAddressOf(), nullptr);
+    context->PSSetShaderResources(0, 1, &shadowDepth);
+    SetViewport(context);
+}
+
+void ShadowMomentMaps::BeginBlur(ID3D11DeviceContext* context, uint32_t cascade)
+{
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    context->PSSetShaderResources(0, 1, &nullSRV);
+
+    context->OMSetRenderTargets(1, m_slices[cascade].rtv.GetAddressOf(), nullptr);
+    context->PSSetShaderResources(0, 1, m_scratchSRV.GetAddressOf());
+}
+
+void ShadowMomentMaps::FinishCascade(ID3D11DeviceContext* context, uint32_t cascade)
+{
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    context->PSSetShaderResources(0, 1, &nullSRV);
+    context->OMSetRenderTargets(0, nullptr, nullptr);
+
+    context->GenerateMips(m_slices[cascade].srv.Get());
+}
+
+void ShadowMomentMaps::UnbindInput(ID3D11DeviceContext* context)
+{
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    context->PSSetShaderResources(SLOT, 1, &nullSRV);
+}
+
+void ShadowMomentMaps::Release()
+{
+    m_moments.Reset();
+    m_momentSRV.Reset();
+    m_slices.clear();
+    m_scratch.Reset();
+    m_scratchRTV.Reset();
+    m_scratchSRV.Reset();
+    m_size = 0;
+    m_mipLevels = 0;
+}
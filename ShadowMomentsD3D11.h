@@ -0,0 +1,64 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // Prefiltered EVSM moments for the cascades: one RGBA32F slice per cascade
+    // at half the shadow map size, with a full mip chain for the lighting's
+    // trilinear fetch. 32-bit moments because exp(2 * 40) is far past half
+    // floats. The Renderer runs EvsmConvertPS into the scratch target, then
+    // EvsmBlurPS into the slice (ShadowMoments.h has the math).
+    class ShadowMomentMaps
+    {
+    public:
+        static const DXGI_FORMAT FORMAT = DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+        // Lighting input: t9 moment array
+        static const UINT SLOT = 9;
+
+        bool Create(ID3D11Device* device, uint32_t size, uint32_t cascades);
+
+        // Binds the scratch target with the depth slices at t0 for the horizontal pass
+        void BeginConvert(ID3D11DeviceContext* context, ID3D11ShaderResourceView* shadowDepth);
+
+        // Binds the cascade's mip 0 with the scratch target at t0 for the vertical pass
+        void BeginBlur(ID3D11DeviceContext* context, uint32_t cascade);
+
+        // Unbinds the targets and rebuilds the cascade's mips, leaving the other slices alone
+        void FinishCascade(ID3D11DeviceContext* context, uint32_t cascade);
+
+        // Drops the moment array from the pixel stage before its slices are written again
+        void UnbindInput(ID3D11DeviceContext* context);
+
+        ID3D11ShaderResourceView* GetSRV() const { return m_momentSRV.Get(); }
+        uint32_t GetSize() const { return m_size; }
+        uint32_t GetMipLevels() const { return m_mipLevels; }
+
+        void Release();
+
+    private:
+        struct Slice
+        {
+            ComPtr<ID3D11RenderTargetView> rtv;        // mip 0
+            ComPtr<ID3D11ShaderResourceView> srv;      // every mip, for GenerateMips
+        };
+
+        ComPtr<ID3D11Texture2D> m_moments;
+        ComPtr<ID3D11ShaderResourceView> m_momentSRV;
+        std::vector<Slice> m_slices;
+        ComPtr<ID3D11Texture2D> m_scratch;
+        ComPtr<ID3D11RenderTargetView> m_scratchRTV;
+        ComPtr<ID3D11ShaderResourceView> m_scratchSRV;
+        uint32_t m_size = 0;
+        uint32_t m_mipLevels = 0;
+
+        void SetViewport(ID3D11DeviceContext* context) const;
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,48 @@
+// SimpleVS.hlsl for indirect draws: the transforms come from the object
+// the instance stream names instead of CBPerObject. The position math
+// matches DepthPrepassInstancedVS.hlsl bit for bit, as in the CPU path.
+#include "Instancing.hlsli"
+
+// Only the members this shader reads
+cbuffer CBPerObject : register(b0)
+{
+    float4x4 View : packoffset(c8);
+    float4x4 Projection : packoffset(c12);
+};
+
+struct VSInput
+{
+    float3 position : POSITION;
+    float3 normal : NORMAL;
+    float2 uv : TEXCOORD;
+    uint object : INSTANCE;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+    float3 normalWS : NORMAL;
+    float3 posWS : POSITION;
+    float2 uv : TEXCOORD;
+    float4 posVS : TEXCOORD1; // view-space position
+};
+
+VSOutput main(VSInput input)
+{
+    VSOutput output;
+    InstanceTransform transform = InstanceTransforms[input.object];
+
+    precise float4 posWorld = mul(float4(input.position, 1.0f), transform.World);
+    output.posWS = posWorld.xyz;
+
+    precise float4 posView = mul(posWorld, View);
+    output.posVS = posView;
+
+    precise float4 posClip = mul(posView, Projection);
+    output.position = posClip;
+
+    output.normalWS = normalize(mul(input.normal, (float3x3) transform.WorldInvTranspose));
+    output.uv = input.uv;
+
+    return output;
+}
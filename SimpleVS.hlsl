@@ -1,9 +1,12 @@
+// Same layout as ShadowVS.hlsl and the C++ CBPerObject; each pass only
+// writes the members its shaders read (see ShaderBindingTable)
 cbuffer CBPerObject : register(b0)
 {
     float4x4 World;
     float4x4 WorldInvTranspose;
     float4x4 View;
     float4x4 Projection;
+    float4x4 LightViewProj;
 };
 
 struct VSInput
@@ -26,13 +29,15 @@ VSOutput main(VSInput input)
 {
     VSOutput output;
 
-    float4 posWorld = mul(float4(input.position, 1.0f), World);
+    // precise: the depth prepass (DepthPrepassVS.hlsl) must match bit for bit
+    precise float4 posWorld = mul(float4(input.position, 1.0f), World);
     output.posWS = posWorld.xyz;
 
-    float4 posView = mul(posWorld, View);
+    precise float4 posView = mul(posWorld, View);
     output.posVS = posView;
 
-    output.position = mul(posView, Projection);
+    precise float4 posClip = mul(posView, Projection);
+    output.position = posClip;
 
     output.normalWS = normalize(mul(input.normal, (float3x3) WorldInvTranspose));
     output.uv = input.uv;
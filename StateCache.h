@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "AssetCache.h"
+
+namespace Engine::Graphics
+{
+    struct StateCacheStats
+    {
+        uint32_t requests = 0;
+        uint32_t hits = 0;          // an existing object was shared
+        uint32_t created = 0;
+        uint32_t failed = 0;
+        uint32_t collisions = 0;    // same hash, different descriptor
+    };
+
+    struct StateKeyHasher
+    {
+        uint64_t operator()(const std::vector<uint8_t>& key) const { return Engine::Core::ContentHash().Append(key).Get(); }
+    };
+
+    // Deduplicates immutable objects by descriptor. Traits::Write(writer, desc)
+    // writes every field that matters, one by one, so padding and unset bytes
+    // never reach the key. Lookups hash those bytes and compare them in full,
+    // so a hash collision costs a compare and nothing else. Entries never
+    // move or go away before Clear, their ids are dense from 0. Main thread.
+    template <typename Desc, typename Object, typename Traits, typename Hasher = StateKeyHasher>
+    class StateCache
+    {
+    public:
+        struct Entry
+        {
+            std::vector<uint8_t> key;
+            uint64_t hash = 0;
+            uint32_t id = 0;
+            Desc desc;
+            Object object;
+        };
+
+        // create(desc, outObject) runs only for a descriptor not seen before.
+        // A failed create is not cached and returns nullptr.
+        template <typename Create>
+        const Entry* GetOrCreate(const Desc& desc, Create&& create)
+        {
+            m_stats.requests++;
+
+            Engine::Core::BinaryWriter writer;
+            Traits::Write(writer, desc);
+            const std::vector<uint8_t>& key = writer.GetData();
+            uint64_t hash = Hasher()(key);
+
+            std::vector<uint32_t>& bucket = m_buckets[hash];
+            for (uint32_t id : bucket)
+            {
+                if (m_entries[id]->key == key)
+                {
+                    m_stats.hits++;
+                    return m_entries[id].get();
+                }
+            }
+            if (!bucket.empty())
+                m_stats.collisions++;
+
+            auto entry = std::make_unique<Entry>();
+            if (!create(desc, entry->object))
+            {
+                m_stats.failed++;
+                if (bucket.empty())
+                    m_buckets.erase(hash);
+                return nullptr;
+            }
+
+            entry->key = key;
+            entry->hash = hash;
+            entry->id = (uint32_t)m_entries.size();
+            entry->desc = desc;
+            bucket.push_back(entry->id);
+            m_entries.push_back(std::move(entry));
+            m_stats.created++;
+            return m_entries.back().get();
+        }
+
+        const Entry* Get(uint32_t id) const { return id < m_entries.size() ? m_entries[id].get() : nullptr; }
+        size_t GetCount() const { return m_entries.size(); }
+        const StateCacheStats& GetStats() const { return m_stats; }
+
+        void Clear()
+        {
+            m_buckets.clear();
+            m_entries.clear();
+        }
+
+    private:
+        std::unordered_map<uint64_t, std::vector<uint32_t>> m_buckets;   // hash -> ids
+        std::vector<std::unique_ptr<Entry>> m_entries;
+        StateCacheStats m_stats;
+    };
+
+    // Identity of a pipeline: the program plus the ids of its deduplicated
+    // states. Portable so pipeline dedup and sort keys work without a device.
+    struct PipelineKey
+    {
+        const void* program = nullptr;      // stable for the program's lifetime (hot reload swaps in place)
+        bool depthOnly = false;             // no pixel stage
+        uint32_t rasterizer = 0;
+        uint32_t depthStencil = 0;
+        uint32_t blend = 0;
+        uint32_t topology = 0;
+    };
+
+    struct PipelineKeyTraits
+    {
+        static void Write(Engine::Core::BinaryWriter& writer, const PipelineKey& key)
+        {
+            writer.WriteValue((uint64_t)(uintptr_t)key.program);
+            writer.WriteValue((uint8_t)(key.depthOnly ? 1 : 0));
+            writer.WriteValue(key.rasterizer);
+            writer.WriteValue(key.depthStencil);
+            writer.WriteValue(key.blend);
+            writer.WriteValue(key.topology);
+        }
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,87 @@
+// Material inputs shared by the forward and G-buffer pixel shaders: the
+// SimpleVS interpolants, albedo with optional alpha test and normal map.
+#ifndef SURFACE_HLSLI
+#define SURFACE_HLSLI
+
+// ----------------------------------------------------
+// PERMUTATION KEYWORDS (material features, set per draw)
+// ----------------------------------------------------
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
+#ifndef ALPHA_TEST
+#define ALPHA_TEST 0
+#endif
+
+Texture2D DiffuseTexture : register(t0);
+#if NORMAL_MAP
+Texture2D NormalTexture : register(t2);
+#endif
+
+SamplerState TextureSampler : register(s0);
+
+// No per-material roughness yet: the exponent 16 the forward pass always used
+static const float DEFAULT_ROUGHNESS = 0.3333f;
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float3 normalWS : NORMAL;
+    float3 posWS : POSITION;
+    float2 uv : TEXCOORD0;
+    float4 posVS : TEXCOORD1; // view-space position
+};
+
+struct Surface
+{
+    float3 albedo;
+    float3 N;
+    float roughness;
+};
+
+// ----------------------------------------------------
+// NORMAL MAPPING
+// ----------------------------------------------------
+#if NORMAL_MAP
+// The vertex format has no tangents: build the cotangent frame from
+// screen-space derivatives of position and UV
+float3 PerturbNormal(float3 N, float3 posWS, float2 uv)
+{
+    float3 dp1 = ddx(posWS);
+    float3 dp2 = ddy(posWS);
+    float2 duv1 = ddx(uv);
+    float2 duv2 = ddy(uv);
+
+    float3 dp2perp = cross(dp2, N);
+    float3 dp1perp = cross(N, dp1);
+    float3 T = dp2perp * duv1.x + dp1perp * duv2.x;
+    float3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+
+    float invMax = rsqrt(max(max(dot(T, T), dot(B, B)), 1e-20f));
+    float3x3 TBN = float3x3(T * invMax, B * invMax, N);
+
+    float3 tangentNormal = NormalTexture.Sample(TextureSampler, uv).xyz * 2.0f - 1.0f;
+    return normalize(mul(tangentNormal, TBN));
+}
+#endif
+
+Surface SampleSurface(PSInput input)
+{
+    Surface surface;
+
+    float4 albedoSample = DiffuseTexture.Sample(TextureSampler, input.uv);
+#if ALPHA_TEST
+    clip(albedoSample.a - 0.5f);
+#endif
+    surface.albedo = albedoSample.rgb;
+    surface.roughness = DEFAULT_ROUGHNESS;
+
+    surface.N = normalize(input.normalWS);
+#if NORMAL_MAP
+    surface.N = PerturbNormal(surface.N, input.posWS, input.uv);
+#endif
+
+    return surface;
+}
+
+#endif // SURFACE_HLSLI
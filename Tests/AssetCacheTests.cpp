@@ -0,0 +1,237 @@
+#include "Check.h"
+#include "AssetCache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace Engine::Core;
+
+namespace
+{
+    std::filesystem::path CacheDirectory()
+    {
+        return std::filesystem::temp_directory_path() / "AssetCacheTests";
+    }
+
+    std::filesystem::path EntryFile(uint64_t key)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return CacheDirectory() / name;
+    }
+
+    std::vector<uint8_t> MakePayload(size_t size, uint8_t seed)
+    {
+        std::vector<uint8_t> payload(size);
+        for (size_t i = 0; i < size; ++i)
+            payload[i] = (uint8_t)(seed + i * 31);
+        return payload;
+    }
+
+    // Overwrites bytes of an entry file in place
+    void Patch(uint64_t key, size_t offset, const void* data, size_t size)
+    {
+        std::fstream file(EntryFile(key), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp((std::streamoff)offset);
+        file.write(static_cast<const char*>(data), (std::streamsize)size);
+    }
+
+    void Reset(uint64_t maxBytes = AssetCache::DEFAULT_MAX_BYTES)
+    {
+        AssetCache::Shutdown();
+        std::error_code ec;
+        std::filesystem::remove_all(CacheDirectory(), ec);
+        AssetCache::Initialize(CacheDirectory(), maxBytes);
+    }
+
+    void DisabledUntilInitialized()
+    {
+        AssetCache::Shutdown();
+        std::vector<uint8_t> out;
+        CHECK(!AssetCache::IsEnabled());
+        CHECK(!AssetCache::Store(1, "x", 1));
+        CHECK(!AssetCache::Load(1, out));
+    }
+
+    void StoreThenLoad()
+    {
+        Reset();
+        std::vector<uint8_t> payload = MakePayload(1000, 3);
+        std::vector<uint8_t> out;
+
+        CHECK(!AssetCache::Load(42, out));
+        CHECK(AssetCache::Store(42, payload.data(), payload.size()));
+        CHECK(AssetCache::Load(42, out));
+        CHECK(out == payload);
+
+        // An empty payload is a valid artifact
+        CHECK(AssetCache::Store(43, nullptr, 0));
+        CHECK(AssetCache::Load(43, out));
+        CHECK(out.empty());
+
+        AssetCacheStats stats = AssetCache::GetStats();
+        CHECK(stats.hits == 2);
+        CHECK(stats.misses == 1);
+        CHECK(stats.stores == 2);
+        CHECK(stats.entryCount == 2);
+    }
+
+    void CorruptPayloadIsDeleted()
+    {
+        Reset();
+        std::vector<uint8_t> payload = MakePayload(256, 9);
+        std::vector<uint8_t> out;
+        CHECK(AssetCache::Store(7, payload.data(), payload.size()));
+
+        uint8_t flipped = payload[100] ^ 0xFF;
+        Patch(7, 32 + 100, &flipped, 1);
+
+        CHECK(!AssetCache::Load(7, out));
+        CHECK(out.empty());
+        CHECK(!std::filesystem::exists(EntryFile(7)));
+        CHECK(AssetCache::GetStats().corrupt == 1);
+        CHECK(AssetCache::GetStats().entryCount == 0);
+    }
+
+    void PayloadSizeMustMatchTheFile()
+    {
+        Reset();
+        std::vector<uint8_t> payload = MakePayload(64, 1);
+        std::vector<uint8_t> out;
+
+        // A size field far beyond the file is rejected before anything is allocated
+        CHECK(AssetCache::Store(8, payload.data(), payload.size()));
+        uint64_t huge = 1ull << 60;
+        Patch(8, 16, &huge, sizeof(huge));
+        CHECK(!AssetCache::Load(8, out));
+        CHECK(out.empty());
+
+        // Trailing bytes after the payload
+        CHECK(AssetCache::Store(9, payload.data(), payload.size()));
+        {
+            std::ofstream file(EntryFile(9), std::ios::binary | std::ios::app);
+            file.write("junk", 4);
+        }
+        CHECK(!AssetCache::Load(9, out));
+
+        // Shorter than a header
+        CHECK(AssetCache::Store(10, payload.data(), payload.size()));
+        std::filesystem::resize_file(EntryFile(10), 8);
+        CHECK(!AssetCache::Load(10, out));
+
+        CHECK(AssetCache::GetStats().corrupt == 3);
+        CHECK(AssetCache::GetStats().entryCount == 0);
+    }
+
+    void LeastRecentlyUsedIsEvicted()
+    {
+        // Room for two 1 KB entries plus their headers
+        Reset(2 * (1024 + 32));
+        std::vector<uint8_t> payload = MakePayload(1024, 5);
+        std::vector<uint8_t> out;
+
+        CHECK(AssetCache::Store(1, payload.data(), payload.size()));
+        CHECK(AssetCache::Store(2, payload.data(), payload.size()));
+        CHECK(AssetCache::Load(1, out));        // 2 is now the oldest
+        CHECK(AssetCache::Store(3, payload.data(), payload.size()));
+
+        CHECK(AssetCache::Load(1, out));
+        CHECK(!AssetCache::Load(2, out));
+        CHECK(AssetCache::Load(3, out));
+        CHECK(AssetCache::GetStats().evictions == 1);
+        CHECK(AssetCache::GetStats().totalBytes <= 2 * (1024 + 32));
+
+        // An entry larger than the whole cache still lands, everything else goes
+        std::vector<uint8_t> large = MakePayload(4096, 6);
+        CHECK(AssetCache::Store(4, large.data(), large.size()));
+        CHECK(AssetCache::Load(4, out));
+        CHECK(AssetCache::GetStats().entryCount == 1);
+    }
+
+    void IndexSurvivesRestart()
+    {
+        Reset();
+        std::vector<uint8_t> payload = MakePayload(300, 2);
+        CHECK(AssetCache::Store(11, payload.data(), payload.size()));
+        CHECK(AssetCache::Store(12, payload.data(), payload.size()));
+
+        // A crashed writer's temp file is cleaned up on startup
+        {
+            std::ofstream file(CacheDirectory() / "000000000000000b.bin.1.2.tmp", std::ios::binary);
+            file.write("partial", 7);
+        }
+
+        AssetCache::Shutdown();
+        CHECK(AssetCache::Initialize(CacheDirectory()));
+
+        std::vector<uint8_t> out;
+        CHECK(AssetCache::GetStats().entryCount == 2);
+        CHECK(AssetCache::Load(11, out) && out == payload);
+        CHECK(AssetCache::Load(12, out) && out == payload);
+        CHECK(!std::filesystem::exists(CacheDirectory() / "000000000000000b.bin.1.2.tmp"));
+    }
+
+    void ConcurrentStoresAndLoads()
+    {
+        // Readers only ever see a complete payload from one of the writers
+        Reset();
+        std::vector<uint8_t> a = MakePayload(64 * 1024, 1);
+        std::vector<uint8_t> b = MakePayload(64 * 1024, 2);
+        CHECK(AssetCache::Store(20, a.data(), a.size()));
+
+        std::atomic<bool> done{ false };
+        std::atomic<uint32_t> torn{ 0 };
+        std::vector<std::thread> threads;
+        for (int w = 0; w < 2; ++w)
+        {
+            threads.emplace_back([&, w]
+                {
+                    const std::vector<uint8_t>& payload = w == 0 ? a : b;
+                    for (int i = 0; i < 50; ++i)
+                        AssetCache::Store(20, payload.data(), payload.size());
+                });
+        }
+        for (int r = 0; r < 2; ++r)
+        {
+            threads.emplace_back([&]
+                {
+                    std::vector<uint8_t> out;
+                    while (!done.load())
+                    {
+                        if (AssetCache::Load(20, out) && out != a && out != b)
+                            torn++;
+                    }
+                });
+        }
+
+        threads[0].join();
+        threads[1].join();
+        done = true;
+        for (size_t i = 2; i < threads.size(); ++i)
+            threads[i].join();
+
+        std::vector<uint8_t> out;
+        CHECK(torn.load() == 0);
+        CHECK(AssetCache::GetStats().corrupt == 0);
+        CHECK(AssetCache::Load(20, out) && (out == a || out == b));
+    }
+}
+
+int main()
+{
+    RUN_TEST(DisabledUntilInitialized);
+    RUN_TEST(StoreThenLoad);
+    RUN_TEST(CorruptPayloadIsDeleted);
+    RUN_TEST(PayloadSizeMustMatchTheFile);
+    RUN_TEST(LeastRecentlyUsedIsEvicted);
+    RUN_TEST(IndexSurvivesRestart);
+    RUN_TEST(ConcurrentStoresAndLoads);
+
+    AssetCache::Shutdown();
+    std::error_code ec;
+    std::filesystem::remove_all(CacheDirectory(), ec);
+    return TEST_RESULT();
+}
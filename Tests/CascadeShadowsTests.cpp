@@ -0,0 +1,206 @@
+#include "Check.h"
+#include "CascadeShadows.h"
+
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const uint32_t RESOLUTION = 2048;
+    const float NEAR_Z = 0.1f;
+    const float FAR_Z = 100.0f;
+
+    // Left-handed, yaw around +y then pitch down
+    CascadeCamera MakeCamera(const ShadowVector& position, float yaw, float pitch)
+    {
+        CascadeCamera camera;
+        camera.position = position;
+        camera.fovY = 0.785398f;
+        camera.aspect = 16.0f / 9.0f;
+
+        float cy = cosf(yaw), sy = sinf(yaw), cp = cosf(pitch), sp = sinf(pitch);
+        camera.forward = { sy * cp, -sp, cy * cp };
+        camera.right = { cy, 0.0f, -sy };
+        const ShadowVector& f = camera.forward;
+        const ShadowVector& r = camera.right;
+        camera.up = { f.y * r.z - f.z * r.y, f.z * r.x - f.x * r.z, f.x * r.y - f.y * r.x };
+        return camera;
+    }
+
+    // Where a fixed world point falls within its shadow map texel, in [0, 1)
+    void TexelPhase(const LightBasis& basis, const CascadeBounds& bounds, const ShadowVector& point, double& outU, double& outV)
+    {
+        ShadowVector light = CascadeShadows::ToLightSpace(basis, point);
+        double u = (light.x - bounds.minX) / bounds.texelSize;
+        double v = (light.y - bounds.minY) / bounds.texelSize;
+        outU = u - floor(u);
+        outV = v - floor(v);
+    }
+
+    double PhaseDistance(double a, double b)
+    {
+        double d = fabs(a - b);
+        return fmin(d, 1.0 - d);
+    }
+
+    bool CornersInside(const CascadeCamera& camera, const LightBasis& basis, float sliceNear, float sliceFar, const CascadeBounds& bounds)
+    {
+        ShadowVector corners[8];
+        CascadeShadows::GetSliceCorners(camera, sliceNear, sliceFar, corners);
+        for (const ShadowVector& corner : corners)
+        {
+            ShadowVector l = CascadeShadows::ToLightSpace(basis, corner);
+            if (l.x < bounds.minX - 1e-3f || l.x > bounds.maxX + 1e-3f || l.y < bounds.minY - 1e-3f || l.y > bounds.maxY + 1e-3f ||
+                l.z < bounds.minZ || l.z > bounds.maxZ)
+                return false;
+        }
+        return true;
+    }
+
+    void SplitsBlendLogAndLinear()
+    {
+        float linear[4], logarithmic[4], practical[4];
+        CascadeShadows::ComputeSplits(NEAR_Z, FAR_Z, 0.0f, 4, linear);
+        CascadeShadows::ComputeSplits(NEAR_Z, FAR_Z, 1.0f, 4, logarithmic);
+        CascadeShadows::ComputeSplits(NEAR_Z, FAR_Z, 0.6f, 4, practical);
+
+        CHECK_NEAR(linear[0], NEAR_Z + (FAR_Z - NEAR_Z) * 0.25f, 1e-4f);
+        CHECK_NEAR(logarithmic[1], NEAR_Z * sqrtf(FAR_Z / NEAR_Z), 1e-3f);
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            CHECK(practical[i] >= logarithmic[i] && practical[i] <= linear[i]);
+            CHECK(i == 0 || practical[i] > practical[i - 1]);
+        }
+        CHECK_NEAR(practical[3], FAR_Z, 1e-3f);
+    }
+
+    // The stable fit keeps the texel size and the texel grid fixed in world
+    // space while the camera turns, and still covers the whole slice
+    void StableFitIgnoresRotation()
+    {
+        float splits[4];
+        CascadeShadows::ComputeSplits(NEAR_Z, FAR_Z, 0.6f, 4, splits);
+        LightBasis basis = CascadeShadows::MakeLightBasis({ 0.3f, -1.0f, 0.4f });
+        const ShadowVector probe = { 1.234f, 0.5f, 3.21f };
+
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            float sliceNear = c ? splits[c - 1] : NEAR_Z;
+            float sliceFar = splits[c];
+
+            CascadeCamera first = MakeCamera({ 0.37f, 2.0f, -5.1f }, 0.0f, 0.0f);
+            CascadeBounds reference = CascadeShadows::FitStable(first, basis, sliceNear, sliceFar, RESOLUTION, 10.0f);
+            double u0, v0;
+            TexelPhase(basis, reference, probe, u0, v0);
+
+            bool sameTexel = true, fullWidth = true, covered = true;
+            double drift = 0.0, tightMin = 1e9, tightMax = 0.0;
+            for (int i = 0; i < 360; ++i)
+            {
+                CascadeCamera camera = MakeCamera({ 0.37f, 2.0f, -5.1f }, i * 0.0274f, sinf(i * 0.05f) * 0.6f);
+                CascadeBounds stable = CascadeShadows::FitStable(camera, basis, sliceNear, sliceFar, RESOLUTION, 10.0f);
+                CascadeBounds tight = CascadeShadows::FitTight(camera, basis, sliceNear, sliceFar, RESOLUTION, 10.0f);
+
+                sameTexel &= stable.texelSize == reference.texelSize;
+                fullWidth &= fabs((stable.maxX - stable.minX) / stable.texelSize - RESOLUTION) <= 1e-2;
+                covered &= CornersInside(camera, basis, sliceNear, sliceFar, stable);
+
+                double u, v;
+                TexelPhase(basis, stable, probe, u, v);
+                drift = fmax(drift, fmax(PhaseDistance(u, u0), PhaseDistance(v, v0)));
+                tightMin = fmin(tightMin, tight.texelSize);
+                tightMax = fmax(tightMax, tight.texelSize);
+            }
+
+            CHECK(sameTexel);
+            CHECK(fullWidth);
+            CHECK(covered);
+            CHECK(drift <= 2e-3);
+
+            // What the stable fit is there for: the tight one changes texel size as the view turns
+            CHECK(tightMax > tightMin * 1.01);
+            CHECK(tightMax <= reference.texelSize * 1.001);
+        }
+    }
+
+    void StableFitSnapsTranslation()
+    {
+        LightBasis basis = CascadeShadows::MakeLightBasis({ 0.3f, -1.0f, 0.4f });
+        const ShadowVector probe = { 1.234f, 0.5f, 3.21f };
+
+        double u0 = -1.0, v0 = -1.0, drift = 0.0;
+        for (int i = 0; i < 200; ++i)
+        {
+            CascadeCamera camera = MakeCamera({ 0.37f + i * 0.0071f, 2.0f + i * 0.003f, -5.1f + i * 0.0113f }, 0.4f, 0.2f);
+            CascadeBounds bounds = CascadeShadows::FitStable(camera, basis, 5.0f, 20.0f, RESOLUTION, 10.0f);
+
+            double u, v;
+            TexelPhase(basis, bounds, probe, u, v);
+            if (u0 < 0.0)
+            {
+                u0 = u;
+                v0 = v;
+            }
+            drift = fmax(drift, fmax(PhaseDistance(u, u0), PhaseDistance(v, v0)));
+        }
+        CHECK(drift <= 2e-3);
+    }
+
+    void SceneDepthSnapsOutward()
+    {
+        CascadeBounds bounds;
+        bounds.minX = -10.0f;
+        bounds.maxX = 10.0f;
+        bounds.minY = -10.0f;
+        bounds.maxY = 10.0f;
+        bounds.minZ = 0.0f;
+        bounds.maxZ = 50.0f;
+
+        // Casters in front of the slice pull the near plane back, the far plane stops at the scene
+        ShadowAabb scene = { { -100.0f, -100.0f, -33.0f }, { 100.0f, 100.0f, 21.0f } };
+        CascadeBounds fitted = bounds;
+        CascadeShadows::FitDepthToScene(scene, 8.0f, fitted);
+        CHECK(fitted.minZ == -40.0f);
+        CHECK(fitted.maxZ == 24.0f);
+
+        // A small change inside the snap keeps the range
+        scene.min.z = -34.0f;
+        scene.max.z = 22.5f;
+        CascadeBounds moved = bounds;
+        CascadeShadows::FitDepthToScene(scene, 8.0f, moved);
+        CHECK(moved.minZ == fitted.minZ && moved.maxZ == fitted.maxZ);
+
+        // A scene off to the side leaves the cascade alone
+        ShadowAabb away = { { 20.0f, 20.0f, 0.0f }, { 30.0f, 30.0f, 10.0f } };
+        CascadeBounds untouched = bounds;
+        CascadeShadows::FitDepthToScene(away, 8.0f, untouched);
+        CHECK(untouched.minZ == 0.0f && untouched.maxZ == 50.0f);
+    }
+
+    void CastersExtrudeTowardTheLight()
+    {
+        CascadeBounds bounds;
+        bounds.minX = -10.0f;
+        bounds.maxX = 10.0f;
+        bounds.minY = -10.0f;
+        bounds.maxY = 10.0f;
+        bounds.minZ = 0.0f;
+        bounds.maxZ = 50.0f;
+
+        CHECK(CascadeShadows::IsCasterVisible(bounds, { { -1.0f, -1.0f, 10.0f }, { 1.0f, 1.0f, 12.0f } }));
+        CHECK(CascadeShadows::IsCasterVisible(bounds, { { -1.0f, -1.0f, -500.0f }, { 1.0f, 1.0f, -490.0f } }));
+        CHECK(!CascadeShadows::IsCasterVisible(bounds, { { -1.0f, -1.0f, 60.0f }, { 1.0f, 1.0f, 70.0f } }));
+        CHECK(!CascadeShadows::IsCasterVisible(bounds, { { 11.0f, -1.0f, 10.0f }, { 12.0f, 1.0f, 12.0f } }));
+    }
+}
+
+int main()
+{
+    RUN_TEST(SplitsBlendLogAndLinear);
+    RUN_TEST(StableFitIgnoresRotation);
+    RUN_TEST(StableFitSnapsTranslation);
+    RUN_TEST(SceneDepthSnapsOutward);
+    RUN_TEST(CastersExtrudeTowardTheLight);
+    return TEST_RESULT();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Checks for the portable unit tests. A failed check reports its location
+// and the test carries on; TEST_RESULT() is main's exit code.
+namespace Engine::Tests
+{
+    inline int s_failures = 0;
+}
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++Engine::Tests::s_failures; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+    do \
+    { \
+        double checkA = (double)(a); \
+        double checkB = (double)(b); \
+        if (!(std::fabs(checkA - checkB) <= (double)(tolerance))) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, checkA, checkB); \
+            ++Engine::Tests::s_failures; \
+        } \
+    } while (0)
+
+#define RUN_TEST(test) \
+    do \
+    { \
+        int failuresBefore = Engine::Tests::s_failures; \
+        test(); \
+        std::printf("%s %s\n", Engine::Tests::s_failures == failuresBefore ? "[  OK  ]" : "[ FAIL ]", #test); \
+    } while (0)
+
+#define TEST_RESULT() (Engine::Tests::s_failures == 0 ? 0 : 1)
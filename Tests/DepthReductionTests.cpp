@@ -0,0 +1,110 @@
+#include "Check.h"
+#include "DepthReduction.h"
+
+#include <vector>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const float NEAR_Z = 0.1f;
+    const float FAR_Z = 100.0f;
+    const uint32_t CASCADES = 4;
+
+    // What XMMatrixPerspectiveFovLH writes to the depth buffer
+    float DeviceDepth(float viewZ)
+    {
+        return FAR_Z / (FAR_Z - NEAR_Z) * (1.0f - NEAR_Z / viewZ);
+    }
+
+    // Sky in the top half, a ground plane from 25 down to 4 units below it
+    std::vector<float> MakeFrame(uint32_t width, uint32_t height)
+    {
+        std::vector<float> depth((size_t)width * height, 1.0f);
+        for (uint32_t y = height / 2; y < height; ++y)
+        {
+            float t = (float)(y - height / 2) / (height / 2 - 1);
+            for (uint32_t x = 0; x < width; ++x)
+                depth[(size_t)y * width + x] = DeviceDepth(25.0f - 21.0f * t);
+        }
+        return depth;
+    }
+
+    void LinearizeInvertsTheProjection()
+    {
+        CHECK_NEAR(DepthReduction::LinearizeDepth(DeviceDepth(7.0f), NEAR_Z, FAR_Z), 7.0f, 1e-3f);
+        CHECK_NEAR(DepthReduction::LinearizeDepth(DeviceDepth(90.0f), NEAR_Z, FAR_Z), 90.0f, 0.1f);
+        CHECK_NEAR(DepthReduction::LinearizeDepth(0.0f, NEAR_Z, FAR_Z), NEAR_Z, 1e-6f);
+    }
+
+    void ReduceSkipsTheSky()
+    {
+        const uint32_t width = 64, height = 48;
+        std::vector<float> frame = MakeFrame(width, height);
+        DepthRange range = DepthReduction::Reduce(frame.data(), width, height, NEAR_Z, FAR_Z);
+        CHECK(range.valid);
+        CHECK_NEAR(range.minZ, 4.0f, 0.01f);
+        CHECK_NEAR(range.maxZ, 25.0f, 0.05f);
+
+        std::vector<float> sky((size_t)width * height, 1.0f);
+        CHECK(!DepthReduction::Reduce(sky.data(), width, height, NEAR_Z, FAR_Z).valid);
+    }
+
+    void NoRangeCoversEverything()
+    {
+        ShadowPartition partitions[CASCADES];
+        DepthReduction::ComputePartitions(DepthRange(), NEAR_Z, FAR_Z, SdsmSettings(), CASCADES, partitions);
+        CHECK(partitions[0].nearZ == NEAR_Z);
+        CHECK_NEAR(partitions[CASCADES - 1].farZ, FAR_Z, 1e-3f);
+    }
+
+    // Contiguous, around the padded visible range, inside near..far and much
+    // tighter than the fixed splits
+    void PartitionsFitTheVisibleRange()
+    {
+        DepthRange visible = { 4.0f, 25.0f, true };
+        ShadowPartition partitions[CASCADES];
+        DepthReduction::ComputePartitions(visible, NEAR_Z, FAR_Z, SdsmSettings(), CASCADES, partitions);
+
+        CHECK(partitions[0].nearZ <= 4.0f / 1.1f && partitions[0].nearZ > 2.0f);
+        CHECK(partitions[CASCADES - 1].farZ >= 25.0f * 1.1f && partitions[CASCADES - 1].farZ < 40.0f);
+        for (uint32_t i = 1; i < CASCADES; ++i)
+        {
+            CHECK(partitions[i].nearZ == partitions[i - 1].farZ);
+            CHECK(partitions[i].farZ > partitions[i].nearZ);
+        }
+
+        DepthRange beyond = { 50.0f, 99.0f, true };
+        DepthReduction::ComputePartitions(beyond, NEAR_Z, FAR_Z, SdsmSettings(), CASCADES, partitions);
+        CHECK(partitions[0].nearZ >= NEAR_Z);
+        CHECK(partitions[CASCADES - 1].farZ <= FAR_Z + 1e-4f);
+    }
+
+    // A visible range that wobbles a little from frame to frame keeps the
+    // splits bit-identical, so cached cascades stay valid
+    void SmallChangesKeepThePartitions()
+    {
+        DepthRange visible = { 4.0f, 25.0f, true };
+        ShadowPartition before[CASCADES], after[CASCADES];
+        DepthReduction::ComputePartitions(visible, NEAR_Z, FAR_Z, SdsmSettings(), CASCADES, before);
+
+        visible.minZ *= 1.002f;
+        visible.maxZ *= 0.998f;
+        DepthReduction::ComputePartitions(visible, NEAR_Z, FAR_Z, SdsmSettings(), CASCADES, after);
+
+        bool same = true;
+        for (uint32_t i = 0; i < CASCADES; ++i)
+            same &= after[i].nearZ == before[i].nearZ && after[i].farZ == before[i].farZ;
+        CHECK(same);
+    }
+}
+
+int main()
+{
+    RUN_TEST(LinearizeInvertsTheProjection);
+    RUN_TEST(ReduceSkipsTheSky);
+    RUN_TEST(NoRangeCoversEverything);
+    RUN_TEST(PartitionsFitTheVisibleRange);
+    RUN_TEST(SmallChangesKeepThePartitions);
+    return TEST_RESULT();
+}
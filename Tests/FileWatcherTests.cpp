@@ -0,0 +1,132 @@
+#include "Check.h"
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Engine::Core;
+
+namespace
+{
+    std::filesystem::path TestDirectory()
+    {
+        return FileWatcher::Normalize(std::filesystem::temp_directory_path()) / "FileWatcherTests";
+    }
+
+    void WriteText(const std::filesystem::path& path, const std::string& text)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+    }
+
+    void Reset()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(TestDirectory(), ec);
+        std::filesystem::create_directories(TestDirectory() / "Sub");
+    }
+
+    // Polls for ms, collecting everything reported
+    std::vector<std::filesystem::path> PollFor(FileWatcher& watcher, int ms)
+    {
+        std::vector<std::filesystem::path> changed;
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (std::chrono::steady_clock::now() < end)
+        {
+            watcher.Poll(changed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return changed;
+    }
+
+    size_t CountOf(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& path)
+    {
+        return (size_t)std::count(paths.begin(), paths.end(), path);
+    }
+
+    void WatchesEachDirectoryOnce()
+    {
+        Reset();
+        FileWatcher watcher;
+        CHECK(watcher.Watch(TestDirectory()));
+        CHECK(watcher.Watch(TestDirectory() / "."));
+        CHECK(watcher.IsWatching(TestDirectory()));
+        CHECK(!watcher.IsWatching(TestDirectory() / "Sub"));
+        CHECK(!watcher.Watch(TestDirectory() / "Missing"));
+
+        CHECK(FileWatcher::Normalize(TestDirectory() / "Sub" / ".." / "a.txt") == TestDirectory() / "a.txt");
+    }
+
+    // A burst of writes is one change, reported only once the file is quiet
+    void BurstSettlesIntoOneChange()
+    {
+        Reset();
+        FileWatcher watcher;
+        watcher.SetSettleTime(std::chrono::milliseconds(150));
+        CHECK(watcher.Watch(TestDirectory()));
+
+        std::vector<std::filesystem::path> changed;
+        for (int i = 0; i < 5; ++i)
+        {
+            WriteText(TestDirectory() / "a.txt", "version " + std::to_string(i));
+            watcher.Poll(changed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK(changed.empty());
+
+        changed = PollFor(watcher, 400);
+        CHECK(CountOf(changed, TestDirectory() / "a.txt") == 1);
+        CHECK(changed.size() == 1);
+        CHECK(PollFor(watcher, 50).empty());
+    }
+
+    // Editors that save to a temp file and rename it over the original
+    void RenameOverTheFileIsAChange()
+    {
+        Reset();
+        WriteText(TestDirectory() / "a.txt", "old");
+        FileWatcher watcher;
+        watcher.SetSettleTime(std::chrono::milliseconds(20));
+        CHECK(watcher.Watch(TestDirectory()));
+
+        WriteText(TestDirectory() / "a.txt.tmp", "new");
+        std::filesystem::rename(TestDirectory() / "a.txt.tmp", TestDirectory() / "a.txt");
+
+        std::vector<std::filesystem::path> changed = PollFor(watcher, 200);
+        CHECK(CountOf(changed, TestDirectory() / "a.txt") == 1);
+    }
+
+    // Non-recursive: files in an unwatched subdirectory are not reported
+    void OnlyWatchedDirectoriesReport()
+    {
+        Reset();
+        FileWatcher watcher;
+        watcher.SetSettleTime(std::chrono::milliseconds(20));
+        CHECK(watcher.Watch(TestDirectory()));
+
+        WriteText(TestDirectory() / "Sub" / "b.txt", "b");
+        std::vector<std::filesystem::path> changed = PollFor(watcher, 150);
+        CHECK(CountOf(changed, TestDirectory() / "Sub" / "b.txt") == 0);
+
+        CHECK(watcher.Watch(TestDirectory() / "Sub"));
+        WriteText(TestDirectory() / "Sub" / "b.txt", "b2");
+        changed = PollFor(watcher, 150);
+        CHECK(CountOf(changed, TestDirectory() / "Sub" / "b.txt") == 1);
+    }
+}
+
+int main()
+{
+    RUN_TEST(WatchesEachDirectoryOnce);
+    RUN_TEST(BurstSettlesIntoOneChange);
+    RUN_TEST(RenameOverTheFileIsAChange);
+    RUN_TEST(OnlyWatchedDirectoriesReport);
+
+    std::error_code ec;
+    std::filesystem::remove_all(TestDirectory(), ec);
+    return TEST_RESULT();
+}
@@ -0,0 +1,215 @@
+#include "Check.h"
+#include "FrameStats.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Shadow: a cube drawn twice, three binds; Main: a cube, a strip quad,
+    // culling results, 2 KB of constants and pipeline statistics
+    void RecordKnownFrame(FrameStats& stats)
+    {
+        stats.BeginFrame();
+        stats.SetPass(RENDER_PASS_SHADOW);
+        stats.CountDraw(36, 2);
+        stats.CountBind(true);
+        stats.CountBind(false);
+        stats.CountBind(false);
+
+        stats.SetPass(RENDER_PASS_MAIN);
+        stats.CountDraw(36);
+        stats.CountStripDraw(4);
+        stats.Add(FRAME_COUNTER_CONSTANT_BYTES, 2048);
+        stats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, 10);
+        stats.Add(FRAME_COUNTER_CULLED_OBJECTS, 5);
+
+        PipelineCounters pipeline;
+        pipeline.rasterizedPrimitives = 1500;
+        pipeline.psInvocations = 1234567;
+        stats.SetPipelineCounters(RENDER_PASS_MAIN, pipeline);
+        stats.EndFrame();
+    }
+
+    std::string ReadText(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    void CountersGoToTheCurrentPass()
+    {
+        FrameStats stats;
+        CHECK(stats.GetFrameCount() == 0);
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_ALL, FRAME_COUNTER_DRAWS) == 0);
+        CHECK(stats.GetAverage(RENDER_PASS_ALL, FRAME_COUNTER_DRAWS) == 0.0);
+
+        RecordKnownFrame(stats);
+        const FrameCounters& frame = stats.GetLastFrame();
+        CHECK(stats.GetFrameCount() == 1 && frame.frame == 0);
+
+        CHECK(frame.Get(RENDER_PASS_SHADOW, FRAME_COUNTER_DRAWS) == 1);
+        CHECK(frame.Get(RENDER_PASS_SHADOW, FRAME_COUNTER_INSTANCES) == 2);
+        CHECK(frame.Get(RENDER_PASS_SHADOW, FRAME_COUNTER_VERTICES) == 72);
+        CHECK(frame.Get(RENDER_PASS_SHADOW, FRAME_COUNTER_TRIANGLES) == 24);
+        CHECK(frame.Get(RENDER_PASS_SHADOW, FRAME_COUNTER_STATE_CHANGES) == 1);
+        CHECK(frame.Get(RENDER_PASS_SHADOW, FRAME_COUNTER_STATE_CHANGES_ELIDED) == 2);
+
+        // 12 triangles of the cube, 2 of the strip
+        CHECK(frame.Get(RENDER_PASS_MAIN, FRAME_COUNTER_DRAWS) == 2);
+        CHECK(frame.Get(RENDER_PASS_MAIN, FRAME_COUNTER_TRIANGLES) == 14);
+        CHECK(frame.Get(RENDER_PASS_MAIN, FRAME_COUNTER_VERTICES) == 40);
+        CHECK(frame.Get(RENDER_PASS_MAIN, FRAME_COUNTER_STATE_CHANGES) == 0);
+        CHECK(frame.Get(RENDER_PASS_MAIN, FRAME_COUNTER_GPU_PS_INVOCATIONS) == 1234567);
+        CHECK(frame.Get(RENDER_PASS_FRAME, FRAME_COUNTER_DRAWS) == 0);
+
+        // Explicit pass, the current one untouched; BeginFrame starts over in Frame
+        stats.BeginFrame();
+        CHECK(stats.GetPass() == RENDER_PASS_FRAME);
+        stats.SetPass(RENDER_PASS_MAIN);
+        stats.Add(RENDER_PASS_STREAMING, FRAME_COUNTER_TEXTURE_BYTES, 4096);
+        stats.CountIndirectDraw();
+        stats.EndFrame();
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_STREAMING, FRAME_COUNTER_TEXTURE_BYTES) == 4096);
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_MAIN, FRAME_COUNTER_TEXTURE_BYTES) == 0);
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_MAIN, FRAME_COUNTER_DRAWS) == 1);
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_MAIN, FRAME_COUNTER_TRIANGLES) == 0);
+    }
+
+    void AllSumsThePasses()
+    {
+        FrameStats stats;
+        RecordKnownFrame(stats);
+        const FrameCounters& frame = stats.GetLastFrame();
+
+        bool sums = true;
+        for (uint32_t c = 0; c < FRAME_COUNTER_COUNT; ++c)
+        {
+            uint64_t sum = 0;
+            for (uint32_t p = 0; p < RENDER_PASS_COUNT; ++p)
+                sum += frame.Get((RenderPassId)p, (FrameCounter)c);
+            sums &= frame.Get(RENDER_PASS_ALL, (FrameCounter)c) == sum;
+        }
+        CHECK(sums);
+        CHECK(frame.Get(RENDER_PASS_ALL, FRAME_COUNTER_DRAWS) == 3);
+        CHECK(frame.Get(RENDER_PASS_ALL, FRAME_COUNTER_TRIANGLES) == 38);
+        CHECK(stats.GetAverage(RENDER_PASS_ALL, FRAME_COUNTER_INSTANCES) == 4.0);
+
+        CHECK(std::string(FrameStats::GetPassName(RENDER_PASS_ALL)) == "All");
+        CHECK(std::string(FrameStats::GetCounterName(FRAME_COUNTER_GPU_CS_INVOCATIONS)) == "gpu_cs_invocations");
+    }
+
+    // The summary spans the last FRAME_STATS_HISTORY frames only
+    void AveragesRollOverTheHistory()
+    {
+        FrameStats stats;
+        const uint32_t frames = FRAME_STATS_HISTORY + 80;
+        for (uint32_t f = 0; f < frames; ++f)
+        {
+            stats.BeginFrame();
+            stats.SetPass(RENDER_PASS_MAIN);
+            stats.Add(FRAME_COUNTER_VISIBLE_OBJECTS, f);
+            stats.EndFrame();
+        }
+        CHECK(stats.GetFrameCount() == FRAME_STATS_HISTORY);
+        CHECK(stats.GetLastFrame().frame == frames - 1);
+
+        FrameCounterSummary summary = stats.GetSummary(RENDER_PASS_MAIN, FRAME_COUNTER_VISIBLE_OBJECTS);
+        CHECK(summary.min == 80 && summary.max == frames - 1 && summary.last == frames - 1);
+        CHECK_NEAR(summary.average, (80 + frames - 1) / 2.0, 1e-9);
+        CHECK(stats.GetSummary(RENDER_PASS_ALL, FRAME_COUNTER_VISIBLE_OBJECTS).average == summary.average);
+        CHECK(stats.GetSummary(RENDER_PASS_SHADOW, FRAME_COUNTER_VISIBLE_OBJECTS).max == 0);
+    }
+
+    // Pipeline statistics are held while their pass runs and dropped once it stops
+    void PipelineCountersHoldWhileThePassRuns()
+    {
+        FrameStats stats;
+        RecordKnownFrame(stats);
+
+        stats.BeginFrame();
+        stats.SetPass(RENDER_PASS_MAIN);
+        stats.EndFrame();
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_MAIN, FRAME_COUNTER_GPU_PS_INVOCATIONS) == 1234567);
+
+        stats.BeginFrame();
+        stats.SetPass(RENDER_PASS_SHADOW);
+        stats.EndFrame();
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_MAIN, FRAME_COUNTER_GPU_PS_INVOCATIONS) == 0);
+
+        stats.BeginFrame();
+        stats.SetPass(RENDER_PASS_MAIN);
+        stats.EndFrame();
+        CHECK(stats.GetLastFrame().Get(RENDER_PASS_MAIN, FRAME_COUNTER_GPU_PS_INVOCATIONS) == 0);
+    }
+
+    void DumpsHoldEveryFrameAndPass()
+    {
+        FrameStats stats;
+        RecordKnownFrame(stats);
+        RecordKnownFrame(stats);
+
+        std::string csv = stats.WriteCsv();
+        size_t lines = 0;
+        for (char c : csv)
+            lines += c == '\n';
+        CHECK(lines == 1 + 2 * (RENDER_PASS_COUNT + 1));
+        CHECK(csv.rfind("frame,pass,draws,instances,triangles,vertices,state_changes,state_changes_elided,", 0) == 0);
+        CHECK(csv.find("\n0,Shadow,1,2,24,72,1,2,0,0,0,0,0,0,0,0,0,0\n") != std::string::npos);
+        CHECK(csv.find("\n1,Main,2,2,14,40,0,0,2048,0,10,5,0,0,0,1500,1234567,0\n") != std::string::npos);
+        CHECK(csv.find("\n1,All,3,4,38,112,1,2,2048,0,10,5,0,0,0,1500,1234567,0\n") != std::string::npos);
+
+        std::string json = stats.WriteJson();
+        CHECK(json.find("\"frames\":2,") != std::string::npos);
+        CHECK(json.find("\"Main\":{\"draws\":{\"average\":2.000,\"min\":2,\"max\":2,\"last\":2}") != std::string::npos);
+        CHECK(json.find("\"gpu_ps_invocations\":{\"average\":1234567.000,\"min\":1234567,\"max\":1234567,\"last\":1234567}") != std::string::npos);
+        CHECK(json.find("{\"frame\":0,\"Frame\":[0,") != std::string::npos);
+        CHECK(json.find("\"Shadow\":[1,2,24,72,1,2,0,0,0,0,0,0,0,0,0,0]") != std::string::npos);
+        CHECK(json.find("{\"frame\":1,") != std::string::npos);
+
+        std::filesystem::path csvPath = std::filesystem::temp_directory_path() / "FrameStatsTests.csv";
+        std::filesystem::path jsonPath = std::filesystem::temp_directory_path() / "FrameStatsTests.json";
+        CHECK(stats.ExportCsv(csvPath) && ReadText(csvPath) == csv);
+        CHECK(stats.ExportJson(jsonPath) && ReadText(jsonPath) == json);
+        std::filesystem::remove(csvPath);
+        std::filesystem::remove(jsonPath);
+        CHECK(!stats.ExportCsv(std::filesystem::temp_directory_path() / "FrameStatsTests" / "missing" / "a.csv"));
+    }
+
+    // Passes without work are left out; All always shows
+    void OverlayOfAKnownFrame()
+    {
+        FrameStats stats;
+        RecordKnownFrame(stats);
+
+        std::vector<std::string> lines = stats.FormatOverlay();
+        CHECK(lines.size() == 6);
+        if (lines.size() != 6)
+            return;
+
+        CHECK(lines[0] == "FRAME STATS, AVERAGE OF 1 FRAMES");
+        CHECK(lines[1] == "PASS         DRAWS   TRIS  BINDS/SKIP  CB KB   VIS/CULL  GPU PRIM  PS INV");
+        CHECK(lines[2] == "Shadow           1     24         1/2      0        0/0         0       0");
+        CHECK(lines[3] == "Main             2     14         0/0      2       10/5     1.50K   1.23M");
+        CHECK(lines[4] == "All              3     38         1/2      2       10/5     1.50K   1.23M");
+        CHECK(lines[5] == "INSTANCES 4  VERTICES 112  TEXTURE KB 0  GPU VS 0  CS 0");
+    }
+}
+
+int main()
+{
+    RUN_TEST(CountersGoToTheCurrentPass);
+    RUN_TEST(AllSumsThePasses);
+    RUN_TEST(AveragesRollOverTheHistory);
+    RUN_TEST(PipelineCountersHoldWhileThePassRuns);
+    RUN_TEST(DumpsHoldEveryFrameAndPass);
+    RUN_TEST(OverlayOfAKnownFrame);
+    return TEST_RESULT();
+}
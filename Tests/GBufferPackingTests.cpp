@@ -0,0 +1,133 @@
+#include "Check.h"
+#include "GBufferPacking.h"
+
+#include <cmath>
+#include <random>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    double AngleDegrees(const float a[3], const float b[3])
+    {
+        double cx = (double)a[1] * b[2] - (double)a[2] * b[1];
+        double cy = (double)a[2] * b[0] - (double)a[0] * b[2];
+        double cz = (double)a[0] * b[1] - (double)a[1] * b[0];
+        double dot = (double)a[0] * b[0] + (double)a[1] * b[1] + (double)a[2] * b[2];
+        return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot) * 180.0 / 3.14159265358979;
+    }
+
+    GBufferSurface MakeNormal(float x, float y, float z)
+    {
+        float length = std::sqrt(x * x + y * y + z * z);
+        GBufferSurface surface;
+        surface.normal[0] = x / length;
+        surface.normal[1] = y / length;
+        surface.normal[2] = z / length;
+        return surface;
+    }
+
+    // 16-bit octahedral keeps every direction within a hundredth of a degree
+    // and decodes to unit length, seams and the lower hemisphere included
+    void NormalsSurviveTheRoundTrip()
+    {
+        std::mt19937 rng(7);
+        std::normal_distribution<float> gauss;
+
+        double maxError = 0.0;
+        bool allUnit = true;
+        auto check = [&](const GBufferSurface& surface)
+            {
+                GBufferSurface unpacked = GBufferPacking::Unpack(GBufferPacking::Pack(surface));
+                maxError = std::fmax(maxError, AngleDegrees(surface.normal, unpacked.normal));
+                const float* n = unpacked.normal;
+                float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                allUnit &= std::fabs(length - 1.0f) <= 1e-5f;
+            };
+
+        for (int i = 0; i < 200000; ++i)
+            check(MakeNormal(gauss(rng), gauss(rng), gauss(rng)));
+
+        const float edges[][3] =
+        {
+            { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+            { 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 }, { 1, 1, -1 }, { -1, -1, -1 },
+            { 1e-7f, 0, -1 }, { 0, 1e-7f, -1 },
+        };
+        for (const float* edge : edges)
+            check(MakeNormal(edge[0], edge[1], edge[2]));
+
+        CHECK(allUnit);
+        CHECK(maxError <= 0.01);
+    }
+
+    void AxesDecodeExactly()
+    {
+        const float axes[][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+        for (const float* axis : axes)
+        {
+            float encoded[2], decoded[3];
+            GBufferPacking::EncodeOctahedral(axis, encoded);
+            GBufferPacking::DecodeOctahedral(encoded, decoded);
+            CHECK_NEAR(decoded[0], axis[0], 1e-6f);
+            CHECK_NEAR(decoded[1], axis[1], 1e-6f);
+            CHECK_NEAR(decoded[2], axis[2], 1e-6f);
+        }
+    }
+
+    void AlbedoKeepsEverySrgbCode()
+    {
+        uint32_t changed = 0;
+        for (int code = 0; code < 256; ++code)
+        {
+            if (GBufferPacking::LinearToSrgb8(GBufferPacking::Srgb8ToLinear((uint8_t)code)) != code)
+                changed++;
+        }
+        CHECK(changed == 0);
+
+        // Linear values above the dark end come back within the 8-bit sRGB step
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        double maxRelative = 0.0;
+        for (int i = 0; i < 100000; ++i)
+        {
+            float linear = unit(rng);
+            float back = GBufferPacking::Srgb8ToLinear(GBufferPacking::LinearToSrgb8(linear));
+            if (linear > 0.01f)
+                maxRelative = std::fmax(maxRelative, std::fabs(back - linear) / linear);
+        }
+        CHECK(maxRelative <= 0.035);
+    }
+
+    void RoughnessAndClamping()
+    {
+        bool exact = true;
+        for (int code = 0; code < 256; ++code)
+        {
+            GBufferSurface surface;
+            surface.roughness = code / 255.0f;
+            exact &= GBufferPacking::Pack(surface).albedoRoughness[3] == code;
+        }
+        CHECK(exact);
+
+        GBufferSurface surface;
+        surface.roughness = 0.3333f;
+        CHECK_NEAR(GBufferPacking::Unpack(GBufferPacking::Pack(surface)).roughness, 0.3333f, 0.5f / 255.0f);
+
+        // Out of range albedo saturates like the render target would
+        surface.albedo[0] = 2.0f;
+        surface.albedo[1] = -1.0f;
+        GBufferTexel texel = GBufferPacking::Pack(surface);
+        CHECK(texel.albedoRoughness[0] == 255);
+        CHECK(texel.albedoRoughness[1] == 0);
+    }
+}
+
+int main()
+{
+    RUN_TEST(NormalsSurviveTheRoundTrip);
+    RUN_TEST(AxesDecodeExactly);
+    RUN_TEST(AlbedoKeepsEverySrgbCode);
+    RUN_TEST(RoughnessAndClamping);
+    return TEST_RESULT();
+}
@@ -0,0 +1,208 @@
+#include "GltfImporter.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+// Import throughput on a synthetic scene written to a temp directory: a grid
+// of tessellated patches as .gltf with an external .bin and as one .glb,
+// imported cold (no asset cache) and warm (decoded geometry from the cache).
+//
+//   GltfImportBenchmark [meshes] [patch resolution] [iterations]
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct SyntheticScene
+    {
+        std::string json;
+        std::vector<uint8_t> bin;
+    };
+
+    template <typename T>
+    void Append(std::vector<uint8_t>& out, const T* data, size_t count)
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+        out.insert(out.end(), p, p + count * sizeof(T));
+    }
+
+    SyntheticScene BuildScene(uint32_t meshCount, uint32_t resolution, const std::string& binUri)
+    {
+        SyntheticScene scene;
+        std::string accessors, views, meshes, nodes, children;
+
+        const uint32_t vertexCount = resolution * resolution;
+        for (uint32_t m = 0; m < meshCount; ++m)
+        {
+            std::vector<float> positions, normals, uvs;
+            std::vector<uint32_t> indices;
+            for (uint32_t y = 0; y < resolution; ++y)
+            {
+                for (uint32_t x = 0; x < resolution; ++x)
+                {
+                    float u = x / (float)(resolution - 1);
+                    float v = y / (float)(resolution - 1);
+                    float height = 0.1f * std::sin(u * 12.0f + m) * std::cos(v * 9.0f);
+                    positions.insert(positions.end(), { u - 0.5f, height, v - 0.5f });
+                    normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
+                    uvs.insert(uvs.end(), { u, v });
+                }
+            }
+            for (uint32_t y = 0; y + 1 < resolution; ++y)
+            {
+                for (uint32_t x = 0; x + 1 < resolution; ++x)
+                {
+                    uint32_t i = y * resolution + x;
+                    indices.insert(indices.end(), { i, i + resolution, i + 1, i + 1, i + resolution, i + resolution + 1 });
+                }
+            }
+
+            auto addView = [&](const void* data, size_t bytes, uint32_t target)
+                {
+                    size_t offset = scene.bin.size();
+                    Append(scene.bin, static_cast<const uint8_t*>(data), bytes);
+                    views += (views.empty() ? "" : ",") + std::string("{\"buffer\":0,\"byteOffset\":") + std::to_string(offset) +
+                        ",\"byteLength\":" + std::to_string(bytes) + ",\"target\":" + std::to_string(target) + "}";
+                };
+            uint32_t firstView = 4 * m;
+            addView(positions.data(), positions.size() * sizeof(float), 34962);
+            addView(normals.data(), normals.size() * sizeof(float), 34962);
+            addView(uvs.data(), uvs.size() * sizeof(float), 34962);
+            addView(indices.data(), indices.size() * sizeof(uint32_t), 34963);
+
+            char accessor[768];
+            snprintf(accessor, sizeof(accessor),
+                "%s{\"bufferView\":%u,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\",\"min\":[-0.5,-0.1,-0.5],\"max\":[0.5,0.1,0.5]},"
+                "{\"bufferView\":%u,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\"},"
+                "{\"bufferView\":%u,\"componentType\":5126,\"count\":%u,\"type\":\"VEC2\"},"
+                "{\"bufferView\":%u,\"componentType\":5125,\"count\":%zu,\"type\":\"SCALAR\"}",
+                accessors.empty() ? "" : ",", firstView, vertexCount, firstView + 1, vertexCount,
+                firstView + 2, vertexCount, firstView + 3, indices.size());
+            accessors += accessor;
+
+            char mesh[256];
+            snprintf(mesh, sizeof(mesh),
+                "%s{\"name\":\"patch%u\",\"primitives\":[{\"attributes\":{\"POSITION\":%u,\"NORMAL\":%u,\"TEXCOORD_0\":%u},\"indices\":%u,\"mode\":4}]}",
+                meshes.empty() ? "" : ",", m, firstView, firstView + 1, firstView + 2, firstView + 3);
+            meshes += mesh;
+
+            char node[192];
+            snprintf(node, sizeof(node), ",{\"mesh\":%u,\"translation\":[%u,0,%u],\"rotation\":[0,0.3826834,0,0.9238795]}",
+                m, m % 16, m / 16);
+            nodes += node;
+            children += (children.empty() ? "" : ",") + std::to_string(m + 1);
+        }
+
+        scene.json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+            "\"nodes\":[{\"name\":\"root\",\"children\":[" + children + "]}" + nodes + "],"
+            "\"meshes\":[" + meshes + "],\"accessors\":[" + accessors + "],\"bufferViews\":[" + views + "],"
+            "\"buffers\":[{" + (binUri.empty() ? std::string() : "\"uri\":\"" + binUri + "\",") +
+            "\"byteLength\":" + std::to_string(scene.bin.size()) + "}]}";
+        return scene;
+    }
+
+    bool WriteFile(const std::filesystem::path& path, const void* data, size_t size)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        return file && file.write(static_cast<const char*>(data), (std::streamsize)size);
+    }
+
+    bool WriteGlb(const std::filesystem::path& path, const SyntheticScene& scene)
+    {
+        std::string json = scene.json;
+        while (json.size() % 4)
+            json += ' ';
+        std::vector<uint8_t> bin = scene.bin;
+        bin.resize((bin.size() + 3) & ~size_t(3), 0);
+
+        std::vector<uint8_t> glb;
+        uint32_t header[3] = { 0x46546C67, 2, (uint32_t)(12 + 8 + json.size() + 8 + bin.size()) };
+        uint32_t jsonChunk[2] = { (uint32_t)json.size(), 0x4E4F534A };
+        uint32_t binChunk[2] = { (uint32_t)bin.size(), 0x004E4942 };
+        Append(glb, header, 3);
+        Append(glb, jsonChunk, 2);
+        Append(glb, json.data(), json.size());
+        Append(glb, binChunk, 2);
+        Append(glb, bin.data(), bin.size());
+        return WriteFile(path, glb.data(), glb.size());
+    }
+
+    void Run(const char* label, const std::filesystem::path& path, uint32_t iterations)
+    {
+        GltfDocument doc;
+        if (!GltfImporter::Load(path, doc))       // warm-up, fills the cache when enabled
+        {
+            printf("%-12s failed: %s\n", label, doc.error.c_str());
+            return;
+        }
+
+        double parseMs = 0.0, decodeMs = 0.0;
+        Clock::time_point start = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            GltfImporter::Load(path, doc);
+            parseMs += doc.stats.parseMs;
+            decodeMs += doc.stats.decodeMs;
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const GltfImportStats& stats = doc.stats;
+        double megabytes = stats.bytesRead / (1024.0 * 1024.0);
+        printf("%-12s %7.2f MB %8.2f ms/scene %9.1f MB/s %8.1f scenes/s  [parse %.2f, decode %.2f ms]%s\n",
+            label, megabytes, seconds * 1000.0 / iterations, megabytes * iterations / seconds, iterations / seconds,
+            parseMs / iterations, decodeMs / iterations, stats.cacheHit ? " cached" : "");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t meshCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+    uint32_t resolution = argc > 2 ? (uint32_t)atoi(argv[2]) : 128;
+    uint32_t iterations = argc > 3 ? (uint32_t)atoi(argv[3]) : 10;
+    if (meshCount == 0 || resolution < 2 || iterations == 0)
+    {
+        printf("usage: GltfImportBenchmark [meshes] [patch resolution] [iterations]\n");
+        return 1;
+    }
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "GltfImportBenchmark";
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+
+    SyntheticScene separate = BuildScene(meshCount, resolution, "scene.bin");
+    SyntheticScene binary = BuildScene(meshCount, resolution, "");
+    if (!WriteFile(dir / "scene.gltf", separate.json.data(), separate.json.size()) ||
+        !WriteFile(dir / "scene.bin", separate.bin.data(), separate.bin.size()) ||
+        !WriteGlb(dir / "scene.glb", binary))
+    {
+        printf("failed to write the synthetic scene to %s\n", dir.string().c_str());
+        return 1;
+    }
+
+    JobSystem::Initialize();
+    printf("%u patches of %ux%u vertices, %u workers\n", meshCount, resolution, resolution, JobSystem::GetWorkerCount());
+
+    Run(".gltf+.bin", dir / "scene.gltf", iterations);
+    Run(".glb", dir / "scene.glb", iterations);
+
+    AssetCache::Initialize(dir / "Cache");
+    Run(".gltf cache", dir / "scene.gltf", iterations);
+    Run(".glb cache", dir / "scene.glb", iterations);
+    AssetCache::Shutdown();
+
+    JobSystem::Shutdown();
+    std::filesystem::remove_all(dir, ec);
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "Check.h"
+#include "GltfParser.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Two scenes sharing nothing, the second one the default
+    const char* TWO_SCENES = R"({
+        "asset": { "version": "2.0" },
+        "scene": 1,
+        "scenes": [ { "nodes": [ 0 ] }, { "nodes": [ 2, 4 ] } ],
+        "nodes": [
+            { "name": "a", "mesh": 0, "children": [ 1 ] },
+            { "name": "a child", "mesh": 0 },
+            { "name": "b", "children": [ 3 ], "translation": [ 1, 2, 3 ] },
+            { "name": "b child", "mesh": 1, "matrix": [ 1,0,0,0, 0,1,0,0, 0,0,1,0, 5,6,7,1 ] },
+            { "name": "c", "mesh": 1, "rotation": [ 0, 0.7071068, 0, 0.7071068 ], "scale": [ 2, 2, 2 ] }
+        ],
+        "meshes": [
+            { "name": "quad", "primitives": [ { "attributes": { "POSITION": 0, "TEXCOORD_0": 1 }, "indices": 2, "material": 0 } ] },
+            { "name": "lines", "primitives": [ { "attributes": { "POSITION": 0, "NORMAL": 3 }, "mode": 1 } ] }
+        ],
+        "accessors": [
+            { "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3" },
+            { "bufferView": 1, "byteOffset": 8, "componentType": 5123, "normalized": true, "count": 4, "type": "VEC2" },
+            { "bufferView": 2, "componentType": 5125, "count": 6, "type": "SCALAR" },
+            { "componentType": 5126, "count": 4, "type": "VEC3", "extras": { "unknown": [ 1, 2 ] } }
+        ],
+        "bufferViews": [
+            { "buffer": 0, "byteLength": 48 },
+            { "buffer": 0, "byteOffset": 48, "byteLength": 24, "byteStride": 4 },
+            { "buffer": 0, "byteOffset": 72, "byteLength": 24 }
+        ],
+        "buffers": [ { "uri": "quad%20data.bin", "byteLength": 96 } ],
+        "images": [ { "name": "albedo", "uri": "data:image/png;base64,iVBORw0=" }, { "bufferView": 2 } ],
+        "textures": [ { "source": 1, "sampler": 0 } ],
+        "materials": [ { "pbrMetallicRoughness": { "baseColorTexture": { "index": 0 }, "baseColorFactor": [ 0.5, 0.25, 1, 1 ] } } ]
+    })";
+
+    std::vector<uint8_t> MakeGlb(const std::string& json, const std::vector<uint8_t>& bin)
+    {
+        std::string paddedJson = json;
+        while (paddedJson.size() % 4)
+            paddedJson += ' ';
+
+        std::vector<uint8_t> file(12);
+        auto appendChunk = [&file](uint32_t type, const uint8_t* data, size_t size)
+        {
+            uint32_t header[2] = { (uint32_t)size, type };
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(header);
+            file.insert(file.end(), bytes, bytes + sizeof(header));
+            file.insert(file.end(), data, data + size);
+            while (file.size() % 4)
+                file.push_back(0);
+        };
+        appendChunk(0x4E4F534A, reinterpret_cast<const uint8_t*>(paddedJson.data()), paddedJson.size());
+        appendChunk(0x004E4942, bin.data(), bin.size());
+
+        uint32_t header[3] = { 0x46546C67, 2, (uint32_t)file.size() };
+        memcpy(file.data(), header, sizeof(header));
+        return file;
+    }
+
+    void ParsesEverySection()
+    {
+        GltfRawDocument doc;
+        CHECK(GltfParser::Parse(TWO_SCENES, doc));
+        CHECK(doc.scene == 1 && doc.scenes.size() == 2);
+        CHECK(doc.nodes.size() == 5 && doc.meshes.size() == 2 && doc.accessors.size() == 4);
+
+        CHECK(doc.nodes[0].name == "a" && doc.nodes[0].mesh == 0 && doc.nodes[0].children == std::vector<int>{ 1 });
+        CHECK(!doc.nodes[2].hasMatrix && doc.nodes[2].translation[2] == 3.0f);
+        CHECK(doc.nodes[3].hasMatrix && doc.nodes[3].matrix[12] == 5.0f && doc.nodes[3].matrix[15] == 1.0f);
+        CHECK(doc.nodes[4].scale[0] == 2.0f && doc.nodes[4].rotation[3] > 0.7f);
+
+        const GltfRawPrimitive& quad = doc.meshes[0].primitives[0];
+        CHECK(quad.position == 0 && quad.texcoord == 1 && quad.indices == 2 && quad.material == 0);
+        CHECK(quad.normal == -1 && quad.mode == GLTF_MODE_TRIANGLES);
+        CHECK(doc.meshes[1].primitives[0].mode == 1 && doc.meshes[1].primitives[0].normal == 3);
+
+        CHECK(doc.accessors[1].byteOffset == 8 && doc.accessors[1].normalized);
+        CHECK(doc.accessors[1].componentType == GLTF_COMPONENT_UNSIGNED_SHORT && doc.accessors[1].components == 2);
+        CHECK(doc.accessors[2].components == 1 && doc.accessors[2].count == 6);
+        CHECK(doc.accessors[3].bufferView == -1);
+        CHECK(doc.bufferViews[1].byteStride == 4 && doc.bufferViews[2].byteOffset == 72);
+        CHECK(doc.buffers.size() == 1 && doc.buffers[0].uri == "quad%20data.bin" && doc.buffers[0].byteLength == 96);
+
+        CHECK(doc.images.size() == 2 && doc.images[0].name == "albedo" && doc.images[1].bufferView == 2);
+        CHECK(doc.textureSources == std::vector<int>{ 1 });
+        CHECK(doc.materials.size() == 1 && doc.materials[0].baseColorTexture == 0);
+        CHECK(doc.materials[0].baseColorFactor[1] == 0.25f);
+
+        GltfRawDocument broken;
+        CHECK(!GltfParser::Parse(R"({ "nodes": [ { "mesh": } ] })", broken));
+    }
+
+    // Only the default scene's nodes are reached; the other scene's stay out
+    void SceneNodesComeFromTheRoots()
+    {
+        GltfRawDocument doc;
+        CHECK(GltfParser::Parse(TWO_SCENES, doc));
+        std::vector<int> roots = GltfParser::GetRootNodes(doc);
+        CHECK((roots == std::vector<int>{ 2, 4 }));
+        CHECK((GltfParser::FindSceneNodes(doc, roots) == std::vector<bool>{ false, false, true, true, true }));
+
+        doc.scene = -1;
+        CHECK((GltfParser::GetRootNodes(doc) == std::vector<int>{ 0 }));
+
+        // No scenes: nodes nobody points at are the roots
+        doc.scenes.clear();
+        CHECK((GltfParser::GetRootNodes(doc) == std::vector<int>{ 0, 2, 4 }));
+
+        // Cycles and bad indices end the walk instead of looping
+        doc.nodes[3].children = { 2, 99, -1 };
+        CHECK((GltfParser::FindSceneNodes(doc, { 2 }) == std::vector<bool>{ false, false, true, true, false }));
+    }
+
+    void GlbChunksSplit()
+    {
+        std::vector<uint8_t> bin = { 1, 2, 3, 4, 5 };
+        std::vector<uint8_t> file = MakeGlb(R"({"asset":{"version":"2.0"}})", bin);
+
+        std::string_view json;
+        std::vector<uint8_t> outBin;
+        bool hasBin = false;
+        CHECK(GltfParser::ReadContainer(file, json, outBin, hasBin));
+        CHECK(hasBin && outBin == bin);
+        CHECK(json.substr(0, 27) == R"({"asset":{"version":"2.0"}})");
+
+        // A chunk running past the end is an error, not a short read
+        std::vector<uint8_t> truncated = file;
+        uint32_t binLength = 64;
+        memcpy(truncated.data() + 12 + 8 + 28, &binLength, 4);
+        CHECK(!GltfParser::ReadContainer(truncated, json, outBin, hasBin));
+
+        std::string text = "{}";
+        std::vector<uint8_t> plain(text.begin(), text.end());
+        CHECK(GltfParser::ReadContainer(plain, json, outBin, hasBin));
+        CHECK(json == "{}" && !hasBin);
+    }
+
+    void UrisDecode()
+    {
+        std::vector<uint8_t> bytes;
+        CHECK(GltfParser::DecodeBase64("aGVsbG8=", bytes));
+        CHECK(std::string(bytes.begin(), bytes.end()) == "hello");
+        CHECK(!GltfParser::DecodeBase64("a*b", bytes));
+        CHECK(GltfParser::DecodePercent("quad%20data.bin") == "quad data.bin");
+        CHECK(GltfParser::DecodePercent("100%") == "100%");
+
+        CHECK(GltfParser::LoadUri(".", "data:application/octet-stream;base64,AAEC", bytes));
+        CHECK((bytes == std::vector<uint8_t>{ 0, 1, 2 }));
+        CHECK(!GltfParser::LoadUri(".", "data:text/plain,AAEC", bytes));
+
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / "GltfParserTests";
+        std::filesystem::create_directories(dir);
+        {
+            std::ofstream file(dir / "quad data.bin", std::ios::binary);
+            file << "xyz";
+        }
+        CHECK(GltfParser::LoadUri(dir, "quad%20data.bin", bytes));
+        CHECK(std::string(bytes.begin(), bytes.end()) == "xyz");
+        CHECK(!GltfParser::LoadUri(dir, "missing.bin", bytes));
+        std::filesystem::remove_all(dir);
+    }
+
+    void ComponentLayouts()
+    {
+        CHECK(GltfParser::GetComponentCount("SCALAR") == 1);
+        CHECK(GltfParser::GetComponentCount("VEC3") == 3);
+        CHECK(GltfParser::GetComponentCount("MAT4") == 16);
+        CHECK(GltfParser::GetComponentCount("MAT3") == 0);
+        CHECK(GltfParser::GetComponentSize(GLTF_COMPONENT_BYTE) == 1);
+        CHECK(GltfParser::GetComponentSize(GLTF_COMPONENT_UNSIGNED_SHORT) == 2);
+        CHECK(GltfParser::GetComponentSize(GLTF_COMPONENT_FLOAT) == 4);
+        CHECK(GltfParser::GetComponentSize(5130) == 0);
+    }
+}
+
+int main()
+{
+    RUN_TEST(ParsesEverySection);
+    RUN_TEST(SceneNodesComeFromTheRoots);
+    RUN_TEST(GlbChunksSplit);
+    RUN_TEST(UrisDecode);
+    RUN_TEST(ComponentLayouts);
+    return TEST_RESULT();
+}
@@ -0,0 +1,301 @@
+#include "Check.h"
+#include "GpuCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const uint32_t HIZ_WIDTH = 128;
+    const uint32_t HIZ_HEIGHT = 64;
+
+    OcclusionMatrix Perspective(float fovY, float aspect, float nearZ, float farZ)
+    {
+        OcclusionMatrix m;
+        float h = 1.0f / tanf(fovY * 0.5f);
+        m.m[0][0] = h / aspect;
+        m.m[1][1] = h;
+        m.m[2][2] = farZ / (farZ - nearZ);
+        m.m[2][3] = 1.0f;
+        m.m[3][2] = -nearZ * farZ / (farZ - nearZ);
+        return m;
+    }
+
+    OcclusionMatrix Orthographic(float width, float height, float nearZ, float farZ)
+    {
+        OcclusionMatrix m;
+        m.m[0][0] = 2.0f / width;
+        m.m[1][1] = 2.0f / height;
+        m.m[2][2] = 1.0f / (farZ - nearZ);
+        m.m[3][2] = -nearZ / (farZ - nearZ);
+        m.m[3][3] = 1.0f;
+        return m;
+    }
+
+    OcclusionMatrix CameraProj()
+    {
+        return Perspective(0.785398f, 16.0f / 9.0f, 0.1f, 100.0f);
+    }
+
+    void ToClip(const OcclusionMatrix& m, float x, float y, float z, float clip[4])
+    {
+        for (int j = 0; j < 4; ++j)
+            clip[j] = x * m.m[0][j] + y * m.m[1][j] + z * m.m[2][j] + m.m[3][j];
+    }
+
+    void Corner(const CullObject& object, int corner, const OcclusionMatrix& m, float clip[4])
+    {
+        ToClip(m, (corner & 1) ? object.boundsMax.x : object.boundsMin.x,
+            (corner & 2) ? object.boundsMax.y : object.boundsMin.y,
+            (corner & 4) ? object.boundsMax.z : object.boundsMin.z, clip);
+    }
+
+    CullObject Box(float x, float y, float z, float extent, uint32_t bucket = 0, uint32_t flags = 0)
+    {
+        CullObject object;
+        object.boundsMin = { x - extent, y - extent, z - extent };
+        object.boundsMax = { x + extent, y + extent, z + extent };
+        object.bucket = bucket;
+        object.flags = flags;
+        return object;
+    }
+
+    // Farthest-depth mip chain over a wall at z = 10 across the middle of the screen
+    std::vector<std::vector<float>> MakeWallPyramid()
+    {
+        float clip[4];
+        ToClip(CameraProj(), 0.0f, 0.0f, 10.0f, clip);
+        const float wallDepth = clip[2] / clip[3];
+
+        std::vector<std::vector<float>> levels(1, std::vector<float>(HIZ_WIDTH * HIZ_HEIGHT, 1.0f));
+        for (uint32_t y = 16; y < 48; ++y)
+        {
+            for (uint32_t x = 32; x < 96; ++x)
+                levels[0][y * HIZ_WIDTH + x] = wallDepth;
+        }
+
+        for (uint32_t w = HIZ_WIDTH, h = HIZ_HEIGHT; w > 1 || h > 1;)
+        {
+            uint32_t nw = (std::max)(w / 2, 1u), nh = (std::max)(h / 2, 1u);
+            std::vector<float> next(nw * nh);
+            const std::vector<float>& prev = levels.back();
+            for (uint32_t y = 0; y < nh; ++y)
+            {
+                for (uint32_t x = 0; x < nw; ++x)
+                {
+                    float farthest = 0.0f;
+                    for (uint32_t dy = 0; dy < 2; ++dy)
+                    {
+                        for (uint32_t dx = 0; dx < 2; ++dx)
+                            farthest = (std::max)(farthest, prev[(std::min)(2 * y + dy, h - 1) * w + (std::min)(2 * x + dx, w - 1)]);
+                    }
+                    next[y * nw + x] = farthest;
+                }
+            }
+            levels.push_back(next);
+            w = nw;
+            h = nh;
+        }
+        return levels;
+    }
+
+    // Culled boxes have every corner outside one clip plane; a box with a
+    // corner strictly inside is always kept
+    void FrustumTestIsConservative()
+    {
+        OcclusionMatrix proj = CameraProj();
+        CullView view = CullKernel::MakeView(proj, 0);
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> position(-60.0f, 60.0f), extent(0.05f, 4.0f);
+        uint32_t culled = 0, kept = 0;
+        bool keptInside = true, culledSeparated = true;
+        for (int n = 0; n < 20000; ++n)
+        {
+            CullObject object = Box(position(rng), position(rng), position(rng) + 40.0f, extent(rng));
+            bool inFrustum = CullKernel::IsInFrustum(object, view);
+
+            bool anyInside = false;
+            bool separating[6] = { true, true, true, true, true, true };
+            for (int c = 0; c < 8; ++c)
+            {
+                float k[4];
+                Corner(object, c, proj, k);
+                float distance[6] = { k[3] + k[0], k[3] - k[0], k[3] + k[1], k[3] - k[1], k[2], k[3] - k[2] };
+                bool inside = true;
+                for (int p = 0; p < 6; ++p)
+                {
+                    separating[p] &= distance[p] < -1e-4f;
+                    inside &= distance[p] >= 1e-4f;
+                }
+                anyInside |= inside;
+            }
+
+            keptInside &= !anyInside || inFrustum;
+            if (inFrustum)
+            {
+                ++kept;
+                continue;
+            }
+            ++culled;
+            culledSeparated &= std::find(separating, separating + 6, true) != separating + 6;
+        }
+        CHECK(keptInside);
+        CHECK(culledSeparated);
+        CHECK(culled > 1000 && kept > 1000);
+    }
+
+    // Two views by three buckets; the second view only draws dynamic objects
+    void RunCompactsPerViewAndBucket()
+    {
+        CullView view = CullKernel::MakeView(CameraProj(), 0);
+        CullBatch batch;
+        bool bucketIds = true;
+        for (uint32_t b = 0; b < 3; ++b)
+            bucketIds &= batch.AddBucket(36 + b, 0, 0) == b;
+        CHECK(bucketIds);
+
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> position(-30.0f, 30.0f), extent(0.05f, 4.0f);
+        std::vector<CullObject> objects;
+        for (uint32_t n = 0; n < 300; ++n)
+        {
+            CullObject object = Box(position(rng), position(rng), position(rng) + 30.0f, extent(rng), n % 3, (n % 4 == 0) ? (uint32_t)CULL_OBJECT_DYNAMIC : 0u);
+            objects.push_back(object);
+            batch.AddObject(object);
+        }
+
+        CullView views[2] = { view, view };
+        views[1].filterMask = CULL_OBJECT_DYNAMIC;
+        views[1].filterValue = CULL_OBJECT_DYNAMIC;
+        batch.Finalize(2);
+        CHECK(batch.GetArgs().size() == 6);
+        CHECK(batch.GetInstanceCapacity() == 600);
+
+        std::vector<IndirectDrawArgs> args = batch.GetArgs();
+        CHECK(args[0].startInstanceLocation == 0 && args[1].startInstanceLocation == 100);
+        CHECK(args[2].startInstanceLocation == 200 && args[3].startInstanceLocation == 300);
+        CHECK(args[2].indexCountPerInstance == 38);
+        CHECK(std::all_of(args.begin(), args.end(), [](const IndirectDrawArgs& a) { return a.instanceCount == 0; }));
+
+        std::vector<uint32_t> instances(batch.GetInstanceCapacity(), 0xFFFFFFFF);
+        CullKernel::Run(batch, views, 0, 2, nullptr, args.data(), instances.data(), nullptr);
+
+        bool matches = true, filtered = true, anyDrawn = false;
+        for (uint32_t v = 0; v < 2; ++v)
+        {
+            for (uint32_t b = 0; b < 3; ++b)
+            {
+                const IndirectDrawArgs& draw = args[CullBatch::GetDrawIndex(v, b, 3)];
+                std::vector<uint32_t> expected;
+                for (uint32_t i = 0; i < objects.size(); ++i)
+                {
+                    if (objects[i].bucket == b && CullKernel::IsVisible(objects[i], views[v], nullptr))
+                        expected.push_back(i);
+                }
+                std::vector<uint32_t> drawn(instances.begin() + draw.startInstanceLocation,
+                    instances.begin() + draw.startInstanceLocation + draw.instanceCount);
+                matches &= drawn == expected;
+                anyDrawn |= !drawn.empty();
+                for (uint32_t i : drawn)
+                    filtered &= v == 0 || (objects[i].flags & CULL_OBJECT_DYNAMIC) != 0;
+            }
+        }
+        CHECK(matches);
+        CHECK(filtered);
+        CHECK(anyDrawn);
+
+        // Running one view leaves the other's args alone
+        std::vector<IndirectDrawArgs> single = batch.GetArgs();
+        CullKernel::Run(batch, views, 1, 1, nullptr, single.data(), instances.data(), nullptr);
+        bool untouched = true;
+        for (uint32_t b = 0; b < 3; ++b)
+            untouched &= single[b].instanceCount == 0 && single[3 + b].instanceCount == args[3 + b].instanceCount;
+        CHECK(untouched);
+    }
+
+    // Casters between the light and the cascade survive with SKIP_NEAR
+    void ShadowViewsKeepCastersInFront()
+    {
+        OcclusionMatrix ortho = Orthographic(20.0f, 20.0f, 10.0f, 50.0f);
+        CullView shadow = CullKernel::MakeView(ortho, CULL_VIEW_SKIP_NEAR);
+        CullView clipped = CullKernel::MakeView(ortho, 0);
+
+        CHECK(CullKernel::IsInFrustum(Box(0, 0, 2, 1), shadow));
+        CHECK(!CullKernel::IsInFrustum(Box(0, 0, 2, 1), clipped));
+        CHECK(!CullKernel::IsInFrustum(Box(0, 0, 60, 1), shadow));
+        CHECK(!CullKernel::IsInFrustum(Box(30, 0, 20, 1), shadow));
+    }
+
+    void HiZCullsBehindTheWall()
+    {
+        std::vector<std::vector<float>> levels = MakeWallPyramid();
+        std::vector<const float*> levelData;
+        for (const std::vector<float>& level : levels)
+            levelData.push_back(level.data());
+        CullPyramid pyramid;
+        pyramid.levels = levelData.data();
+        pyramid.levelCount = (uint32_t)levelData.size();
+        pyramid.width = HIZ_WIDTH;
+        pyramid.height = HIZ_HEIGHT;
+
+        OcclusionMatrix proj = CameraProj();
+        CullView hiz = CullKernel::MakeView(proj, CULL_VIEW_HIZ);
+        CHECK(CullKernel::IsOccluded(Box(0, 0, 30, 1), hiz, pyramid));
+        CHECK(!CullKernel::IsOccluded(Box(0, 0, 5, 1), hiz, pyramid));
+        CHECK(!CullKernel::IsOccluded(Box(0, 0, 10, 0.5f), hiz, pyramid));     // straddles the wall
+        CHECK(!CullKernel::IsOccluded(Box(25, 0, 30, 1), hiz, pyramid));       // beside it
+        CHECK(!CullKernel::IsOccluded(Box(0, 0, 0.1f, 0.5f), hiz, pyramid));   // crosses the near plane
+        CHECK(!CullKernel::IsVisible(Box(0, 0, 30, 1), hiz, &pyramid));
+        CHECK(CullKernel::IsVisible(Box(0, 0, 30, 1), CullKernel::MakeView(proj, 0), &pyramid));
+
+        // An occluded box never has a level 0 pixel under it at or beyond its nearest depth
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> across(-8.0f, 8.0f), depth(2.0f, 40.0f), extent(0.05f, 3.0f);
+        uint32_t occluded = 0;
+        bool conservative = true;
+        for (int n = 0; n < 20000; ++n)
+        {
+            CullObject object = Box(across(rng), across(rng) * 0.6f, depth(rng), extent(rng));
+            if (!CullKernel::IsInFrustum(object, hiz) || !CullKernel::IsOccluded(object, hiz, pyramid))
+                continue;
+            ++occluded;
+
+            float minX = 1e9f, maxX = -1e9f, minY = 1e9f, maxY = -1e9f, minZ = 1e9f;
+            for (int c = 0; c < 8; ++c)
+            {
+                float k[4];
+                Corner(object, c, proj, k);
+                minX = (std::min)(minX, k[0] / k[3]);
+                maxX = (std::max)(maxX, k[0] / k[3]);
+                minY = (std::min)(minY, k[1] / k[3]);
+                maxY = (std::max)(maxY, k[1] / k[3]);
+                minZ = (std::min)(minZ, k[2] / k[3]);
+            }
+            int x0 = (std::max)(0, (int)floorf((minX * 0.5f + 0.5f) * HIZ_WIDTH));
+            int x1 = (std::min)((int)HIZ_WIDTH - 1, (int)floorf((maxX * 0.5f + 0.5f) * HIZ_WIDTH));
+            int y0 = (std::max)(0, (int)floorf((0.5f - maxY * 0.5f) * HIZ_HEIGHT));
+            int y1 = (std::min)((int)HIZ_HEIGHT - 1, (int)floorf((0.5f - minY * 0.5f) * HIZ_HEIGHT));
+            for (int y = y0; y <= y1; ++y)
+            {
+                for (int x = x0; x <= x1; ++x)
+                    conservative &= levels[0][y * HIZ_WIDTH + x] < minZ;
+            }
+        }
+        CHECK(conservative);
+        CHECK(occluded > 500);
+    }
+}
+
+int main()
+{
+    RUN_TEST(FrustumTestIsConservative);
+    RUN_TEST(RunCompactsPerViewAndBucket);
+    RUN_TEST(ShadowViewsKeepCastersInFront);
+    RUN_TEST(HiZCullsBehindTheWall);
+    return TEST_RESULT();
+}
@@ -0,0 +1,284 @@
+#include "Check.h"
+#include "HiZPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const uint32_t WIDTH = 160;
+    const uint32_t HEIGHT = 90;
+
+    OcclusionMatrix CameraProj()
+    {
+        const float fovY = 0.785398f, aspect = 16.0f / 9.0f, nearZ = 0.1f, farZ = 100.0f;
+        OcclusionMatrix m;
+        float h = 1.0f / tanf(fovY * 0.5f);
+        m.m[0][0] = h / aspect;
+        m.m[1][1] = h;
+        m.m[2][2] = farZ / (farZ - nearZ);
+        m.m[2][3] = 1.0f;
+        m.m[3][2] = -nearZ * farZ / (farZ - nearZ);
+        return m;
+    }
+
+    void Corner(const CullObject& object, int corner, const OcclusionMatrix& m, float clip[4])
+    {
+        float x = (corner & 1) ? object.boundsMax.x : object.boundsMin.x;
+        float y = (corner & 2) ? object.boundsMax.y : object.boundsMin.y;
+        float z = (corner & 4) ? object.boundsMax.z : object.boundsMin.z;
+        for (int j = 0; j < 4; ++j)
+            clip[j] = x * m.m[0][j] + y * m.m[1][j] + z * m.m[2][j] + m.m[3][j];
+    }
+
+    CullObject Box(float x, float y, float z, float ex, float ey, float ez, uint32_t bucket = 0)
+    {
+        CullObject object;
+        object.boundsMin = { x - ex, y - ey, z - ez };
+        object.boundsMax = { x + ex, y + ey, z + ez };
+        object.bucket = bucket;
+        return object;
+    }
+
+    // Stand-in for drawing a box: its farthest depth over the pixel centers
+    // inside its screen rect, or the inner half of it, so it never writes
+    // depth where the real box would not cover
+    void Splat(const CullObject& object, const OcclusionMatrix& proj, std::vector<float>& depth, bool fullRect)
+    {
+        float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, maxZ = -1e30f;
+        for (int c = 0; c < 8; ++c)
+        {
+            float p[4];
+            Corner(object, c, proj, p);
+            if (p[3] <= 1e-5f)
+                return;
+            minX = (std::min)(minX, p[0] / p[3]);
+            maxX = (std::max)(maxX, p[0] / p[3]);
+            minY = (std::min)(minY, p[1] / p[3]);
+            maxY = (std::max)(maxY, p[1] / p[3]);
+            maxZ = (std::max)(maxZ, p[2] / p[3]);
+        }
+
+        float cx = (minX + maxX) * 0.5f, cy = (minY + maxY) * 0.5f;
+        float hx = (maxX - minX) * (fullRect ? 0.5f : 0.25f), hy = (maxY - minY) * (fullRect ? 0.5f : 0.25f);
+        int x0 = (std::max)((int)ceilf(((cx - hx) * 0.5f + 0.5f) * WIDTH - 0.5f), 0);
+        int x1 = (std::min)((int)floorf(((cx + hx) * 0.5f + 0.5f) * WIDTH - 0.5f), (int)WIDTH - 1);
+        int y0 = (std::max)((int)ceilf((0.5f - (cy + hy) * 0.5f) * HEIGHT - 0.5f), 0);
+        int y1 = (std::min)((int)floorf((0.5f - (cy - hy) * 0.5f) * HEIGHT - 0.5f), (int)HEIGHT - 1);
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+                depth[y * WIDTH + x] = (std::min)(depth[y * WIDTH + x], maxZ);
+        }
+    }
+
+    // Brute force: no pixel under the box's screen rect at or beyond its nearest depth
+    bool IsHiddenByDepth(const CullObject& object, const OcclusionMatrix& proj, const std::vector<float>& depth)
+    {
+        float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, minZ = 1e30f;
+        for (int c = 0; c < 8; ++c)
+        {
+            float q[4];
+            Corner(object, c, proj, q);
+            minX = (std::min)(minX, q[0] / q[3]);
+            maxX = (std::max)(maxX, q[0] / q[3]);
+            minY = (std::min)(minY, q[1] / q[3]);
+            maxY = (std::max)(maxY, q[1] / q[3]);
+            minZ = (std::min)(minZ, q[2] / q[3]);
+        }
+        int x0 = (std::max)((int)floorf((minX * 0.5f + 0.5f) * WIDTH), 0);
+        int x1 = (std::min)((int)floorf((maxX * 0.5f + 0.5f) * WIDTH), (int)WIDTH - 1);
+        int y0 = (std::max)((int)floorf((0.5f - maxY * 0.5f) * HEIGHT), 0);
+        int y1 = (std::min)((int)floorf((0.5f - minY * 0.5f) * HEIGHT), (int)HEIGHT - 1);
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                if (depth[y * WIDTH + x] >= minZ)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void LevelCounts()
+    {
+        CHECK(HiZPyramid::GetLevelCount(1, 1) == 1);
+        CHECK(HiZPyramid::GetLevelCount(2, 1) == 2);
+        CHECK(HiZPyramid::GetLevelCount(1280, 720) == 11);
+        CHECK(HiZPyramid::GetLevelCount(1920, 1080) == 11);
+        CHECK(HiZPyramid::GetLevelCount(0, 5) == 0);
+    }
+
+    // Every texel is the farthest of the level 0 pixels that map to it
+    // (x >> k, clamped to the last texel), odd sizes included
+    void LevelsHoldTheFarthestDepth()
+    {
+        const uint32_t sizes[][2] = { { 1, 1 }, { 7, 3 }, { 13, 1 }, { 64, 64 }, { 67, 45 }, { 101, 33 }, { 160, 90 } };
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (const auto& size : sizes)
+        {
+            const uint32_t w = size[0], h = size[1];
+            std::vector<float> depth(w * h);
+            for (float& d : depth)
+                d = unit(rng);
+
+            HiZPyramid hiz;
+            hiz.Build(depth.data(), w, h);
+            CullPyramid pyramid = hiz.GetPyramid();
+            CHECK(hiz.GetLevelCount() == HiZPyramid::GetLevelCount(w, h));
+            CHECK(pyramid.levelCount == hiz.GetLevelCount() && pyramid.width == w && pyramid.height == h);
+
+            bool sizesMatch = true, farthest = true;
+            for (uint32_t k = 0; k < pyramid.levelCount; ++k)
+            {
+                uint32_t lw = (std::max)(w >> k, 1u), lh = (std::max)(h >> k, 1u);
+                sizesMatch &= hiz.GetLevel(k).size() == (size_t)lw * lh;
+
+                std::vector<float> expected(lw * lh, 0.0f);
+                for (uint32_t y = 0; y < h; ++y)
+                {
+                    for (uint32_t x = 0; x < w; ++x)
+                    {
+                        float& texel = expected[(std::min)(y >> k, lh - 1) * lw + (std::min)(x >> k, lw - 1)];
+                        texel = (std::max)(texel, depth[y * w + x]);
+                    }
+                }
+                for (size_t i = 0; i < expected.size(); ++i)
+                    farthest &= pyramid.levels[k][i] == expected[i];
+            }
+            CHECK(sizesMatch);
+            CHECK(farthest);
+            CHECK(pyramid.levels[pyramid.levelCount - 1][0] == *std::max_element(depth.begin(), depth.end()));
+        }
+    }
+
+    void OcclusionIsConservative()
+    {
+        OcclusionMatrix proj = CameraProj();
+        CullView view = CullKernel::MakeView(proj, CULL_VIEW_HIZ);
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> across(-20.0f, 20.0f), distance(1.0f, 60.0f), extent(0.1f, 6.0f);
+
+        uint32_t occluded = 0;
+        bool conservative = true;
+        for (int scene = 0; scene < 40; ++scene)
+        {
+            std::vector<float> depth(WIDTH * HEIGHT, 1.0f);
+            for (int i = 0; i < 30; ++i)
+                Splat(Box(across(rng), across(rng) * 0.5f, distance(rng), extent(rng), extent(rng), 0.2f), proj, depth, true);
+            HiZPyramid hiz;
+            hiz.Build(depth.data(), WIDTH, HEIGHT);
+            CullPyramid pyramid = hiz.GetPyramid();
+
+            for (int t = 0; t < 300; ++t)
+            {
+                CullObject object = Box(across(rng), across(rng) * 0.5f, distance(rng), extent(rng) * 0.3f, extent(rng) * 0.3f, extent(rng) * 0.3f);
+                if (!CullKernel::IsOccluded(object, view, pyramid))
+                    continue;
+                ++occluded;
+                conservative &= IsHiddenByDepth(object, proj, depth);
+            }
+        }
+        CHECK(conservative);
+        CHECK(occluded > 50);
+
+        // A wall hides what is behind it, never what is in front; no pyramid hides nothing
+        std::vector<float> depth(WIDTH * HEIGHT, 1.0f);
+        Splat(Box(0, 0, 10, 30, 30, 0.1f), proj, depth, true);
+        HiZPyramid hiz;
+        hiz.Build(depth.data(), WIDTH, HEIGHT);
+        CHECK(CullKernel::IsOccluded(Box(0, 0, 30, 1, 1, 1), view, hiz.GetPyramid()));
+        CHECK(!CullKernel::IsOccluded(Box(0, 0, 5, 1, 1, 1), view, hiz.GetPyramid()));
+        CHECK(!CullKernel::IsOccluded(Box(0, 0, 30, 1, 1, 1), view, CullPyramid()));
+    }
+
+    // The early phase draws last frame's visible set, the pyramid of that
+    // depth culls the rest in the late phase. Nothing is drawn twice, nothing
+    // visible against the final depth is left out, and the late phase's
+    // visibility becomes next frame's early set
+    void TwoPhaseCullingMissesNothing()
+    {
+        OcclusionMatrix proj = CameraProj();
+        std::mt19937 rng(13);
+        std::uniform_real_distribution<float> across(-20.0f, 20.0f), distance(1.0f, 60.0f), extent(0.1f, 6.0f);
+
+        CullBatch batch;
+        batch.AddBucket(36, 0, 0);
+        batch.AddBucket(36, 36, 0);
+        std::vector<CullObject> objects;
+        objects.push_back(Box(0, 0, 10, 30, 30, 0.1f));
+        for (uint32_t i = 0; i < 200; ++i)
+            objects.push_back(Box(across(rng), across(rng) * 0.5f, distance(rng), extent(rng) * 0.3f, extent(rng) * 0.3f, extent(rng) * 0.3f, i & 1));
+        for (const CullObject& object : objects)
+            batch.AddObject(object);
+        batch.Finalize(2);
+        const uint32_t count = batch.GetObjectCount();
+
+        CullView views[2] = { CullKernel::MakeView(proj, CULL_VIEW_EARLY), CullKernel::MakeView(proj, CULL_VIEW_LATE | CULL_VIEW_HIZ) };
+        std::vector<uint32_t> visibility(count, 0);
+        bool earlyKeepsHistory = true, drawnOnce = true, historyMatches = true, nothingMissed = true;
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            std::vector<IndirectDrawArgs> args = batch.GetArgs();
+            std::vector<uint32_t> instances(batch.GetInstanceCapacity(), ~0u);
+            std::vector<uint32_t> before = visibility;
+            CullKernel::Run(batch, views, 0, 1, nullptr, args.data(), instances.data(), visibility.data());
+            earlyKeepsHistory &= visibility == before;
+
+            std::vector<float> depth(WIDTH * HEIGHT, 1.0f);
+            std::vector<bool> drawn(count, false);
+            auto drawView = [&](uint32_t v)
+            {
+                for (uint32_t b = 0; b < 2; ++b)
+                {
+                    const IndirectDrawArgs& draw = args[CullBatch::GetDrawIndex(v, b, 2)];
+                    for (uint32_t k = 0; k < draw.instanceCount; ++k)
+                    {
+                        uint32_t object = instances[draw.startInstanceLocation + k];
+                        drawnOnce &= !drawn[object];
+                        drawn[object] = true;
+                        Splat(objects[object], proj, depth, object == 0);
+                    }
+                }
+            };
+
+            drawView(0);
+            HiZPyramid early;
+            early.Build(depth.data(), WIDTH, HEIGHT);
+            CullPyramid earlyPyramid = early.GetPyramid();
+            CullKernel::Run(batch, views, 1, 1, &earlyPyramid, args.data(), instances.data(), visibility.data());
+            drawView(1);
+
+            HiZPyramid late;
+            late.Build(depth.data(), WIDTH, HEIGHT);
+            CullPyramid finalPyramid = late.GetPyramid();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                historyMatches &= drawn[i] || !visibility[i];
+                historyMatches &= !before[i] || !CullKernel::IsInFrustum(objects[i], views[0]) || drawn[i];
+                historyMatches &= before[i] || drawn[i] == (visibility[i] != 0);
+                nothingMissed &= drawn[i] || !CullKernel::IsVisible(objects[i], views[1], &finalPyramid);
+            }
+        }
+        CHECK(earlyKeepsHistory);
+        CHECK(drawnOnce);
+        CHECK(historyMatches);
+        CHECK(nothingMissed);
+        CHECK(visibility[0] == 1);
+    }
+}
+
+int main()
+{
+    RUN_TEST(LevelCounts);
+    RUN_TEST(LevelsHoldTheFarthestDepth);
+    RUN_TEST(OcclusionIsConservative);
+    RUN_TEST(TwoPhaseCullingMissesNothing);
+    return TEST_RESULT();
+}
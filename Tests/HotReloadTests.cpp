@@ -0,0 +1,263 @@
+#include "Check.h"
+#include "HotReload.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Engine::Core;
+
+namespace
+{
+    std::filesystem::path TestDirectory()
+    {
+        return FileWatcher::Normalize(std::filesystem::temp_directory_path()) / "HotReloadTests";
+    }
+
+    void WriteText(const std::filesystem::path& path, const std::string& text)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+    }
+
+    std::string ReadText(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    // Builds to its source followed by every "include <file>" line's file
+    // (one level, relative to the test directory). "ERROR" anywhere fails
+    // the build. Builds can be held to land a change mid-build.
+    class FakeAsset : public IReloadable
+    {
+    public:
+        std::string live;
+        std::string staged;
+        std::atomic<uint32_t> builds{ 0 };
+        uint32_t commits = 0;
+        std::atomic<bool> hold{ false };
+
+        FakeAsset(const char* name, const char* file)
+            : m_name(name)
+            , m_path(TestDirectory() / file)
+        {
+            live = Assemble();
+        }
+
+        const char* GetName() const override { return m_name.c_str(); }
+
+        void GetDependencies(std::vector<std::filesystem::path>& outFiles) override
+        {
+            outFiles.push_back(m_path);
+            for (const std::string& include : GetIncludes())
+                outFiles.push_back(TestDirectory() / include);
+        }
+
+        bool Build(std::string& outErrors) override
+        {
+            builds++;
+            while (hold.load())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            staged = Assemble();
+            if (staged.find("ERROR") != std::string::npos)
+            {
+                outErrors = m_name;
+                outErrors += ": syntax error\n";
+                return false;
+            }
+            return true;
+        }
+
+        bool Commit(std::string&) override
+        {
+            live = staged;
+            commits++;
+            return true;
+        }
+
+    private:
+        std::string m_name;
+        std::filesystem::path m_path;
+
+        std::vector<std::string> GetIncludes() const
+        {
+            std::vector<std::string> includes;
+            std::istringstream source(ReadText(m_path));
+            std::string line;
+            while (std::getline(source, line))
+            {
+                if (line.rfind("include ", 0) == 0)
+                    includes.push_back(line.substr(8));
+            }
+            return includes;
+        }
+
+        std::string Assemble() const
+        {
+            std::string text = ReadText(m_path);
+            for (const std::string& include : GetIncludes())
+            {
+                text += '|';
+                text += ReadText(TestDirectory() / include);
+            }
+            return text;
+        }
+    };
+
+    // Runs Update for ms, the way the frame loop would
+    void Pump(HotReloader& reloader, std::string& log, int ms)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (std::chrono::steady_clock::now() < end)
+        {
+            reloader.Update(log);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    struct Fixture
+    {
+        HotReloader reloader;
+        FakeAsset* a = nullptr;     // includes common.txt
+        FakeAsset* b = nullptr;     // stands alone
+        std::string log;
+
+        Fixture()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(TestDirectory(), ec);
+            WriteText(TestDirectory() / "common.txt", "c1");
+            WriteText(TestDirectory() / "a.txt", "A\ninclude common.txt\n");
+            WriteText(TestDirectory() / "b.txt", "B");
+
+            reloader.SetSettleTime(std::chrono::milliseconds(30));
+            a = new FakeAsset("A", "a.txt");
+            b = new FakeAsset("B", "b.txt");
+            reloader.Register(a);
+            reloader.Register(b);
+        }
+    };
+
+    void IncludeEditRebuildsOnlyItsDependents()
+    {
+        Fixture f;
+        WriteText(TestDirectory() / "common.txt", "c2");
+        Pump(f.reloader, f.log, 300);
+
+        CHECK(f.a->builds.load() == 1 && f.a->commits == 1);
+        CHECK(f.a->live.find("c2") != std::string::npos);
+        CHECK(f.b->builds.load() == 0);
+        CHECK(f.reloader.GetStats().reloads == 1 && f.log.find("Reloaded A") != std::string::npos);
+    }
+
+    // A burst of saves settles into one build of the final text
+    void BurstBuildsOnce()
+    {
+        Fixture f;
+        for (int i = 0; i < 5; ++i)
+        {
+            std::string text = "B";
+            text += std::to_string(i);
+            WriteText(TestDirectory() / "b.txt", text);
+            f.reloader.Update(f.log);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        Pump(f.reloader, f.log, 300);
+
+        CHECK(f.b->builds.load() == 1 && f.b->commits == 1);
+        CHECK(f.b->live == "B4");
+    }
+
+    void TempFileRenameIsAnEdit()
+    {
+        Fixture f;
+        WriteText(TestDirectory() / "b.txt.tmp", "B renamed");
+        std::filesystem::rename(TestDirectory() / "b.txt.tmp", TestDirectory() / "b.txt");
+        Pump(f.reloader, f.log, 300);
+
+        CHECK(f.b->builds.load() == 1 && f.b->live == "B renamed");
+        CHECK(f.a->builds.load() == 0);
+    }
+
+    void FailedBuildKeepsTheLiveVersion()
+    {
+        Fixture f;
+        std::string before = f.a->live;
+        WriteText(TestDirectory() / "a.txt", "A ERROR\ninclude common.txt\n");
+        Pump(f.reloader, f.log, 300);
+
+        CHECK(f.a->builds.load() == 1 && f.a->commits == 0);
+        CHECK(f.a->live == before);
+        CHECK(f.reloader.GetStats().failures == 1 && f.reloader.GetStats().reloads == 0);
+        CHECK(f.log.find("Reload of A failed") != std::string::npos);
+        CHECK(f.log.find("A: syntax error") != std::string::npos);
+
+        // The fix goes through as usual
+        WriteText(TestDirectory() / "a.txt", "A fixed\ninclude common.txt\n");
+        Pump(f.reloader, f.log, 300);
+        CHECK(f.a->commits == 1 && f.a->live == "A fixed\ninclude common.txt\n|c1");
+    }
+
+    // An include added by an edit, in a directory nothing watched yet,
+    // is tracked from the next build on
+    void NewIncludeIsTracked()
+    {
+        Fixture f;
+        WriteText(TestDirectory() / "Lib" / "new.txt", "n1");
+        WriteText(TestDirectory() / "a.txt", "A\ninclude common.txt\ninclude Lib/new.txt\n");
+        Pump(f.reloader, f.log, 300);
+        CHECK(f.a->commits == 1 && f.a->live.find("n1") != std::string::npos);
+
+        WriteText(TestDirectory() / "Lib" / "new.txt", "n2");
+        Pump(f.reloader, f.log, 300);
+        CHECK(f.a->commits == 2 && f.a->live.find("n2") != std::string::npos);
+        CHECK(f.b->builds.load() == 0);
+    }
+
+    // A save landing while the asset builds queues exactly one more build
+    void ChangeDuringBuildBuildsOnceMore()
+    {
+        Fixture f;
+        f.b->hold = true;
+        f.reloader.MarkChanged(TestDirectory() / "b.txt");
+        f.reloader.Update(f.log);
+        while (f.b->builds.load() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        WriteText(TestDirectory() / "b.txt", "B2");
+        WriteText(TestDirectory() / "b.txt", "B3");
+        Pump(f.reloader, f.log, 200);
+        CHECK(f.b->builds.load() == 1 && f.b->commits == 0);
+
+        f.b->hold = false;
+        Pump(f.reloader, f.log, 300);
+        CHECK(f.b->builds.load() == 2 && f.b->commits == 2);
+        CHECK(f.b->live == "B3");
+        CHECK(f.a->builds.load() == 0);
+    }
+}
+
+int main()
+{
+    JobSystem::Initialize(2);
+    RUN_TEST(IncludeEditRebuildsOnlyItsDependents);
+    RUN_TEST(BurstBuildsOnce);
+    RUN_TEST(TempFileRenameIsAnEdit);
+    RUN_TEST(FailedBuildKeepsTheLiveVersion);
+    RUN_TEST(NewIncludeIsTracked);
+    RUN_TEST(ChangeDuringBuildBuildsOnceMore);
+    JobSystem::Shutdown();
+
+    std::error_code ec;
+    std::filesystem::remove_all(TestDirectory(), ec);
+    return TEST_RESULT();
+}
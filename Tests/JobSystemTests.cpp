@@ -0,0 +1,125 @@
+#include "Check.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Engine::Core;
+
+namespace
+{
+    void ExecuteRunsInlineWithoutPool()
+    {
+        CHECK(JobSystem::GetWorkerCount() == 0);
+
+        JobContext ctx;
+        std::thread::id runner;
+        JobSystem::Execute(ctx, [&runner] { runner = std::this_thread::get_id(); });
+
+        CHECK(!JobSystem::IsBusy(ctx));
+        CHECK(runner == std::this_thread::get_id());
+    }
+
+    void DispatchCoversEveryIndexOnce()
+    {
+        JobSystem::Initialize(4);
+        CHECK(JobSystem::GetWorkerCount() == 4);
+
+        const uint32_t groupSizes[] = { 1, 7, 64, 5000 };
+        for (uint32_t groupSize : groupSizes)
+        {
+            std::vector<std::atomic<uint32_t>> hits(1000);
+            JobContext ctx;
+            JobSystem::Dispatch(ctx, (uint32_t)hits.size(), groupSize, [&hits](uint32_t i) { hits[i]++; });
+            JobSystem::Wait(ctx);
+
+            bool once = true;
+            for (const std::atomic<uint32_t>& h : hits)
+                once &= h.load() == 1;
+            CHECK(once);
+        }
+
+        JobContext empty;
+        JobSystem::Dispatch(empty, 0, 16, [](uint32_t) {});
+        CHECK(!JobSystem::IsBusy(empty));
+
+        JobSystem::Shutdown();
+        CHECK(JobSystem::GetWorkerCount() == 0);
+    }
+
+    void NestedWaitDoesNotDeadlock()
+    {
+        // One worker blocked in Wait inside a job: the caller helps drain the queue
+        JobSystem::Initialize(1);
+
+        std::atomic<uint32_t> inner{ 0 };
+        JobContext outer;
+        JobSystem::Dispatch(outer, 4, 1, [&inner](uint32_t)
+            {
+                JobContext ctx;
+                JobSystem::Dispatch(ctx, 16, 1, [&inner](uint32_t) { inner++; });
+                JobSystem::Wait(ctx);
+            });
+        JobSystem::Wait(outer);
+        CHECK(inner.load() == 4 * 16);
+
+        JobSystem::Shutdown();
+    }
+
+    void ExecuteRacingShutdownRunsEveryJob()
+    {
+        // Jobs submitted while the pool shuts down run either on a worker or
+        // inline, never get stranded in the queue
+        for (int round = 0; round < 50; ++round)
+        {
+            JobSystem::Initialize(2);
+
+            std::atomic<uint32_t> ran{ 0 };
+            JobContext ctx;
+            const uint32_t jobCount = 2000;
+            std::thread producer([&]
+                {
+                    for (uint32_t i = 0; i < jobCount; ++i)
+                        JobSystem::Execute(ctx, [&ran] { ran++; });
+                });
+
+            JobSystem::Shutdown();
+            producer.join();
+            JobSystem::Wait(ctx);
+
+            CHECK(ran.load() == jobCount);
+            CHECK(JobSystem::GetWorkerCount() == 0);
+        }
+    }
+
+    void ReinitializeAfterShutdown()
+    {
+        JobSystem::Initialize(2);
+        JobSystem::Initialize(8);       // already running, ignored
+        CHECK(JobSystem::GetWorkerCount() == 2);
+        JobSystem::Shutdown();
+        JobSystem::Shutdown();          // second call is a no-op
+
+        JobSystem::Initialize(3);
+        CHECK(JobSystem::GetWorkerCount() == 3);
+
+        std::atomic<uint32_t> ran{ 0 };
+        JobContext ctx;
+        JobSystem::Dispatch(ctx, 100, 10, [&ran](uint32_t) { ran++; });
+        JobSystem::Wait(ctx);
+        CHECK(ran.load() == 100);
+
+        JobSystem::Shutdown();
+    }
+}
+
+int main()
+{
+    RUN_TEST(ExecuteRunsInlineWithoutPool);
+    RUN_TEST(DispatchCoversEveryIndexOnce);
+    RUN_TEST(NestedWaitDoesNotDeadlock);
+    RUN_TEST(ExecuteRacingShutdownRunsEveryJob);
+    RUN_TEST(ReinitializeAfterShutdown);
+    return TEST_RESULT();
+}
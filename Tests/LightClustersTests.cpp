@@ -0,0 +1,162 @@
+#include "Check.h"
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+namespace
+{
+    const float FOV_Y = 0.785398163f;
+    const float ASPECT = 16.0f / 9.0f;
+    const float NEAR_Z = 0.1f;
+    const float FAR_Z = 100.0f;
+
+    // Spread over and a little beyond the frustum, some behind the camera
+    std::vector<LightSphere> MakeLights(uint32_t count, uint32_t seed, float maxRadius)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> side(-1.0f, 1.0f), depth(-5.0f, 110.0f), radius(0.05f, maxRadius);
+
+        std::vector<LightSphere> lights(count);
+        for (LightSphere& light : lights)
+        {
+            light.z = depth(rng);
+            light.x = side(rng) * (std::fabs(light.z) + 2.0f) * 1.2f;
+            light.y = side(rng) * (std::fabs(light.z) + 2.0f) * 0.7f;
+            light.radius = radius(rng);
+        }
+        return lights;
+    }
+
+    bool MatchesReference(const LightClusterGrid& grid, const std::vector<LightSphere>& lights)
+    {
+        std::vector<ClusterCell> cells;
+        std::vector<uint32_t> indices;
+        grid.AssignReference(lights.data(), (uint32_t)lights.size(), cells, indices);
+
+        if (indices != grid.GetIndices() || cells.size() != grid.GetCells().size())
+            return false;
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            if (cells[i].offset != grid.GetCells()[i].offset || cells[i].count != grid.GetCells()[i].count)
+                return false;
+        }
+        return true;
+    }
+
+    // Light counts around the four-wide SIMD step and grids with odd
+    // dimensions, so the padded lanes get exercised
+    void SimdMatchesReference()
+    {
+        const ClusterGridConfig configs[] = { { 16, 9, 24 }, { 1, 1, 1 }, { 7, 5, 3 }, { 32, 18, 32 } };
+        for (const ClusterGridConfig& config : configs)
+        {
+            for (uint32_t count : { 0u, 1u, 3u, 4u, 5u, 63u, 64u, 65u, 1000u })
+            {
+                LightClusterGrid grid(config);
+                grid.SetProjection(FOV_Y, ASPECT, NEAR_Z, FAR_Z);
+                std::vector<LightSphere> lights = MakeLights(count, count * 7 + config.tilesX, 6.0f);
+                grid.Assign(lights.data(), count);
+                CHECK(MatchesReference(grid, lights));
+            }
+        }
+    }
+
+    void ThreadCountDoesNotChangeTheResult()
+    {
+        std::vector<LightSphere> lights = MakeLights(512, 11, 4.0f);
+
+        LightClusterGrid inlineGrid;
+        inlineGrid.SetProjection(FOV_Y, ASPECT, NEAR_Z, FAR_Z);
+        inlineGrid.Assign(lights.data(), (uint32_t)lights.size());
+
+        JobSystem::Initialize(3);
+        LightClusterGrid jobGrid;
+        jobGrid.SetProjection(FOV_Y, ASPECT, NEAR_Z, FAR_Z);
+        jobGrid.Assign(lights.data(), (uint32_t)lights.size());
+        JobSystem::Shutdown();
+
+        CHECK(jobGrid.GetIndices() == inlineGrid.GetIndices());
+        CHECK(MatchesReference(jobGrid, lights));
+        CHECK(jobGrid.GetStats().references == (uint32_t)jobGrid.GetIndices().size());
+    }
+
+    void SliceFollowsTheShaderFormula()
+    {
+        LightClusterGrid grid;
+        grid.SetProjection(FOV_Y, ASPECT, NEAR_Z, FAR_Z);
+        const uint32_t slices = grid.GetConfig().slices;
+
+        CHECK(grid.GetSlice(NEAR_Z) == 0);
+        CHECK(grid.GetSlice(NEAR_Z * 0.5f) == 0);
+        CHECK(grid.GetSlice(FAR_Z * 0.999f) == slices - 1);
+        CHECK(grid.GetSlice(FAR_Z * 2.0f) == slices - 1);
+
+        bool monotonic = true;
+        uint32_t previous = 0;
+        for (float z = NEAR_Z; z < FAR_Z; z *= 1.05f)
+        {
+            uint32_t slice = grid.GetSlice(z);
+            float shader = logf(z) * grid.GetDepthScale() + grid.GetDepthBias();
+            monotonic &= slice >= previous && slice == (uint32_t)std::clamp(shader, 0.0f, (float)(slices - 1));
+            previous = slice;
+        }
+        CHECK(monotonic);
+    }
+
+    // Any view space point inside a light's sphere must find that light in
+    // the cell the pixel shader would look up
+    void EveryLitPointFindsItsLight()
+    {
+        LightClusterGrid grid;
+        grid.SetProjection(FOV_Y, ASPECT, NEAR_Z, FAR_Z);
+        const ClusterGridConfig& config = grid.GetConfig();
+        std::vector<LightSphere> lights = MakeLights(256, 99, 4.0f);
+        grid.Assign(lights.data(), (uint32_t)lights.size());
+
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        const float tanY = tanf(FOV_Y * 0.5f);
+        const float tanX = tanY * ASPECT;
+
+        uint32_t lit = 0, missing = 0;
+        for (int i = 0; i < 20000; ++i)
+        {
+            float u = unit(rng), v = unit(rng);
+            float z = NEAR_Z * powf(FAR_Z / NEAR_Z, unit(rng));
+            float x = (u * 2.0f - 1.0f) * z * tanX;
+            float y = (1.0f - v * 2.0f) * z * tanY;
+
+            uint32_t tileX = (std::min)((uint32_t)(u * config.tilesX), config.tilesX - 1);
+            uint32_t tileY = (std::min)((uint32_t)(v * config.tilesY), config.tilesY - 1);
+            const ClusterCell& cell = grid.GetCells()[(grid.GetSlice(z) * config.tilesY + tileY) * config.tilesX + tileX];
+            const uint32_t* begin = grid.GetIndices().data() + cell.offset;
+
+            for (uint32_t l = 0; l < lights.size(); ++l)
+            {
+                float dx = x - lights[l].x, dy = y - lights[l].y, dz = z - lights[l].z;
+                if (dx * dx + dy * dy + dz * dz >= lights[l].radius * lights[l].radius * 0.999f)
+                    continue;
+
+                lit++;
+                if (std::find(begin, begin + cell.count, l) == begin + cell.count)
+                    missing++;
+            }
+        }
+        CHECK(lit > 1000);
+        CHECK(missing == 0);
+    }
+}
+
+int main()
+{
+    RUN_TEST(SimdMatchesReference);
+    RUN_TEST(ThreadCountDoesNotChangeTheResult);
+    RUN_TEST(SliceFollowsTheShaderFormula);
+    RUN_TEST(EveryLitPointFindsItsLight);
+    return TEST_RESULT();
+}
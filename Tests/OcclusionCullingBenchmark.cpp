@@ -0,0 +1,175 @@
+#include "JobSystem.h"
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+// Software occlusion culling over a street-level city: grid x grid buildings
+// as occluders, chosen largest on screen first the way the renderer does,
+// and as many props again as occludees. Reports raster and test time for
+// the SSE and, where supported, the AVX2 rasterizer.
+//
+//   OcclusionCullingBenchmark [grid] [frames]
+namespace
+{
+    const float SPACING = 20.0f;
+    const float FOV_Y = 3.14159265f / 4.0f;
+
+    // -1..1 cube with clockwise front faces, as Mesh::CreateCube
+    const float CUBE_POSITIONS[] = {
+        -1, -1, -1,  -1, 1, -1,   1, 1, -1,   1, -1, -1,
+         1, -1, 1,    1, 1, 1,   -1, 1, 1,   -1, -1, 1,
+        -1, -1, 1,   -1, 1, 1,   -1, 1, -1,  -1, -1, -1,
+         1, -1, -1,   1, 1, -1,   1, 1, 1,    1, -1, 1,
+        -1, 1, -1,   -1, 1, 1,    1, 1, 1,    1, 1, -1,
+        -1, -1, 1,   -1, -1, -1,  1, -1, -1,  1, -1, 1 };
+    const uint32_t CUBE_INDICES[] = {
+        0, 1, 2, 0, 2, 3,  4, 5, 6, 4, 6, 7,  8, 9, 10, 8, 10, 11,
+        12, 13, 14, 12, 14, 15,  16, 17, 18, 16, 18, 19,  20, 21, 22, 20, 22, 23 };
+
+    OcclusionMatrix World(const ShadowAabb& bounds)
+    {
+        OcclusionMatrix m;
+        m.m[0][0] = 0.5f * (bounds.max.x - bounds.min.x);
+        m.m[1][1] = 0.5f * (bounds.max.y - bounds.min.y);
+        m.m[2][2] = 0.5f * (bounds.max.z - bounds.min.z);
+        m.m[3][0] = 0.5f * (bounds.max.x + bounds.min.x);
+        m.m[3][1] = 0.5f * (bounds.max.y + bounds.min.y);
+        m.m[3][2] = 0.5f * (bounds.max.z + bounds.min.z);
+        m.m[3][3] = 1.0f;
+        return m;
+    }
+
+    // Camera at (0, 2, 0) looking down +z, slightly turned so the streets are not axis aligned on screen
+    OcclusionMatrix StreetViewProj()
+    {
+        const float nearZ = 0.1f, farZ = 2000.0f;
+        const float length = sqrtf(3.0f * 3.0f + 100.0f * 100.0f);
+        const float zx = 3.0f / length, zz = 100.0f / length;
+
+        OcclusionMatrix view;
+        view.m[0][0] = zz;  view.m[0][2] = zx;
+        view.m[1][1] = 1.0f;
+        view.m[2][0] = -zx; view.m[2][2] = zz;
+        view.m[3][1] = -2.0f;
+        view.m[3][3] = 1.0f;
+
+        float h = 1.0f / tanf(0.5f * FOV_Y);
+        OcclusionMatrix proj;
+        proj.m[0][0] = h / (16.0f / 9.0f);
+        proj.m[1][1] = h;
+        proj.m[2][2] = farZ / (farZ - nearZ);
+        proj.m[2][3] = 1.0f;
+        proj.m[3][2] = -nearZ * farZ / (farZ - nearZ);
+
+        OcclusionMatrix r;
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                r.m[i][j] = view.m[i][0] * proj.m[0][j] + view.m[i][1] * proj.m[1][j] + view.m[i][2] * proj.m[2][j] + view.m[i][3] * proj.m[3][j];
+        }
+        return r;
+    }
+
+    // Buildings first, then the props on the streets
+    std::vector<ShadowAabb> MakeCity(uint32_t grid, uint32_t& outBuildings)
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> height(4.0f, 40.0f), jitter(0.7f, 1.0f);
+        std::uniform_real_distribution<float> coord(-0.5f * grid * SPACING, 0.5f * grid * SPACING);
+
+        std::vector<ShadowAabb> bounds;
+        for (uint32_t i = 0; i < grid; ++i)
+        {
+            for (uint32_t j = 0; j < grid; ++j)
+            {
+                float x = ((float)i - grid / 2) * SPACING + 10.0f;
+                float z = ((float)j - grid / 2) * SPACING + 10.0f;
+                float ex = 7.0f * jitter(rng), ez = 7.0f * jitter(rng);
+                bounds.push_back({ { x - ex, 0.0f, z - ez }, { x + ex, height(rng), z + ez } });
+            }
+        }
+        outBuildings = (uint32_t)bounds.size();
+
+        for (uint32_t i = 0; i < grid * grid; ++i)
+        {
+            float x = roundf(coord(rng) / SPACING) * SPACING;
+            float z = coord(rng);
+            bounds.push_back({ { x - 1.0f, 0.0f, z - 1.0f }, { x + 1.0f, 2.0f, z + 1.0f } });
+        }
+        return bounds;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t grid = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+    uint32_t frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 50;
+    if (grid == 0 || frames == 0)
+    {
+        printf("usage: OcclusionCullingBenchmark [grid] [frames]\n");
+        return 1;
+    }
+
+    JobSystem::Initialize();
+    printf("%ux%u city, %u workers, AVX2 %s\n", grid, grid, JobSystem::GetWorkerCount(),
+        OcclusionBuffer::IsAvx2Supported() ? "supported" : "not supported");
+
+    uint32_t buildings = 0;
+    std::vector<ShadowAabb> bounds = MakeCity(grid, buildings);
+    OcclusionMatrix viewProj = StreetViewProj();
+    const ShadowVector eye = { 0.0f, 2.0f, 0.0f };
+
+    std::vector<OcclusionSimd> paths = { OCCLUSION_SIMD_SSE };
+    if (OcclusionBuffer::IsAvx2Supported())
+        paths.push_back(OCCLUSION_SIMD_AVX2);
+
+    for (OcclusionSimd simd : paths)
+    {
+        OcclusionBuffer buffer;
+        buffer.SetSimd(simd);
+        std::vector<uint8_t> visible(bounds.size());
+        std::vector<std::pair<float, uint32_t>> candidates;
+        double rasterizeMs = 0.0, testMs = 0.0;
+
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            buffer.Begin(viewProj);
+            candidates.clear();
+            for (uint32_t i = 0; i < buildings; ++i)
+            {
+                float size = OcclusionBuffer::EstimateScreenSize(bounds[i], eye, FOV_Y);
+                if (size >= buffer.GetSettings().minOccluderSize)
+                    candidates.push_back({ size, i });
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+            size_t occluders = (std::min)(candidates.size(), (size_t)buffer.GetSettings().maxOccluders);
+            for (size_t k = 0; k < occluders; ++k)
+                buffer.AddOccluder(CUBE_POSITIONS, 24, CUBE_INDICES, 36, World(bounds[candidates[k].second]));
+            buffer.Rasterize();
+            buffer.TestVisibility(bounds.data(), bounds.size(), visible.data());
+
+            rasterizeMs += buffer.GetStats().rasterizeMs;
+            testMs += buffer.GetStats().testMs;
+        }
+
+        const OcclusionStats& stats = buffer.GetStats();
+        uint32_t inFrustum = stats.tested - stats.frustumCulled;
+        printf("%s: %u occluders, %u/%u triangles, %u boxes, %u frustum culled, %u occluded (%.1f%% of in-frustum), raster %.3f ms, test %.3f ms\n",
+            simd == OCCLUSION_SIMD_AVX2 ? "AVX2" : "SSE ", stats.occluders, stats.rasterizedTriangles, stats.occluderTriangles,
+            stats.tested, stats.frustumCulled, stats.occlusionCulled, inFrustum ? 100.0 * stats.occlusionCulled / inFrustum : 0.0,
+            rasterizeMs / frames, testMs / frames);
+    }
+
+    JobSystem::Shutdown();
+    return 0;
+}
@@ -0,0 +1,280 @@
+#include "Check.h"
+#include "JobSystem.h"
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+namespace
+{
+    struct Vec3 { float x, y, z; };
+
+    Vec3 Sub(Vec3 a, Vec3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    Vec3 Cross(Vec3 a, Vec3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 Normalize(Vec3 a) { float l = sqrtf(Dot(a, a)); return { a.x / l, a.y / l, a.z / l }; }
+
+    OcclusionMatrix Multiply(const OcclusionMatrix& a, const OcclusionMatrix& b)
+    {
+        OcclusionMatrix r;
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+        }
+        return r;
+    }
+
+    // Row vector, left handed, as XMMatrixLookAtLH and XMMatrixPerspectiveFovLH
+    OcclusionMatrix LookAt(Vec3 eye, Vec3 at)
+    {
+        Vec3 z = Normalize(Sub(at, eye));
+        Vec3 x = Normalize(Cross({ 0, 1, 0 }, z));
+        Vec3 y = Cross(z, x);
+        OcclusionMatrix m;
+        m.m[0][0] = x.x; m.m[1][0] = x.y; m.m[2][0] = x.z; m.m[3][0] = -Dot(x, eye);
+        m.m[0][1] = y.x; m.m[1][1] = y.y; m.m[2][1] = y.z; m.m[3][1] = -Dot(y, eye);
+        m.m[0][2] = z.x; m.m[1][2] = z.y; m.m[2][2] = z.z; m.m[3][2] = -Dot(z, eye);
+        m.m[3][3] = 1;
+        return m;
+    }
+
+    OcclusionMatrix Perspective(float fovY, float aspect, float nearZ, float farZ)
+    {
+        OcclusionMatrix m;
+        float h = 1.0f / tanf(fovY * 0.5f);
+        m.m[0][0] = h / aspect;
+        m.m[1][1] = h;
+        m.m[2][2] = farZ / (farZ - nearZ);
+        m.m[2][3] = 1;
+        m.m[3][2] = -nearZ * farZ / (farZ - nearZ);
+        return m;
+    }
+
+    OcclusionMatrix World(Vec3 position, Vec3 scale)
+    {
+        OcclusionMatrix m;
+        m.m[0][0] = scale.x; m.m[1][1] = scale.y; m.m[2][2] = scale.z;
+        m.m[3][0] = position.x; m.m[3][1] = position.y; m.m[3][2] = position.z;
+        m.m[3][3] = 1;
+        return m;
+    }
+
+    ShadowAabb Box(Vec3 center, Vec3 extents)
+    {
+        return { { center.x - extents.x, center.y - extents.y, center.z - extents.z },
+                 { center.x + extents.x, center.y + extents.y, center.z + extents.z } };
+    }
+
+    // -1..1 cube with clockwise front faces, as Mesh::CreateCube
+    const float CUBE_POSITIONS[] = {
+        -1, -1, -1,  -1, 1, -1,   1, 1, -1,   1, -1, -1,
+         1, -1, 1,    1, 1, 1,   -1, 1, 1,   -1, -1, 1,
+        -1, -1, 1,   -1, 1, 1,   -1, 1, -1,  -1, -1, -1,
+         1, -1, -1,   1, 1, -1,   1, 1, 1,    1, -1, 1,
+        -1, 1, -1,   -1, 1, 1,    1, 1, 1,    1, 1, -1,
+        -1, -1, 1,   -1, -1, -1,  1, -1, -1,  1, -1, 1 };
+    const uint32_t CUBE_INDICES[] = {
+        0, 1, 2, 0, 2, 3,  4, 5, 6, 4, 6, 7,  8, 9, 10, 8, 10, 11,
+        12, 13, 14, 12, 14, 15,  16, 17, 18, 16, 18, 19,  20, 21, 22, 20, 22, 23 };
+
+    OcclusionMatrix CameraViewProj()
+    {
+        return Multiply(LookAt({ 0, 2, -10 }, { 0, 2, 0 }), Perspective(3.14159265f / 4.0f, 16.0f / 9.0f, 0.1f, 500.0f));
+    }
+
+    // Random front facing triangles in front of the camera
+    void MakeTriangles(uint32_t count, std::vector<float>& positions, std::vector<uint32_t>& indices)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> coord(-20.0f, 20.0f);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (int v = 0; v < 3; ++v)
+            {
+                positions.push_back(coord(rng));
+                positions.push_back(coord(rng));
+                positions.push_back(coord(rng) + 25.0f);
+                indices.push_back(i * 3 + v);
+            }
+        }
+    }
+
+    // Nearest z/w over the pixel center among all triangles, 1 where none covers it
+    float ExactDepth(const std::vector<float>& positions, const std::vector<uint32_t>& indices, const OcclusionMatrix& viewProj,
+        uint32_t width, uint32_t height, float sx, float sy)
+    {
+        float best = 1.0f;
+        for (size_t t = 0; t < indices.size(); t += 3)
+        {
+            float s[3][3];
+            bool inFront = true;
+            for (int v = 0; v < 3; ++v)
+            {
+                const float* p = &positions[indices[t + v] * 3];
+                float c[4];
+                for (int k = 0; k < 4; ++k)
+                    c[k] = p[0] * viewProj.m[0][k] + p[1] * viewProj.m[1][k] + p[2] * viewProj.m[2][k] + viewProj.m[3][k];
+                inFront &= c[3] > 0.1f;
+                s[v][0] = (c[0] / c[3] * 0.5f + 0.5f) * width;
+                s[v][1] = (0.5f - c[1] / c[3] * 0.5f) * height;
+                s[v][2] = c[2] / c[3];
+            }
+            float area = (s[1][0] - s[0][0]) * (s[2][1] - s[0][1]) - (s[2][0] - s[0][0]) * (s[1][1] - s[0][1]);
+            if (!inFront || area <= 0.0f)
+                continue;
+
+            float l0 = ((s[1][0] - sx) * (s[2][1] - sy) - (s[2][0] - sx) * (s[1][1] - sy)) / area;
+            float l1 = ((s[2][0] - sx) * (s[0][1] - sy) - (s[0][0] - sx) * (s[2][1] - sy)) / area;
+            float l2 = 1.0f - l0 - l1;
+            if (l0 < -1e-4f || l1 < -1e-4f || l2 < -1e-4f)
+                continue;
+            float z = l0 * s[0][2] + l1 * s[1][2] + l2 * s[2][2];
+            if (z >= 0.0f && z < best)
+                best = z;
+        }
+        return best;
+    }
+
+    void WallHidesWhatIsBehindIt()
+    {
+        OcclusionBuffer buffer;
+        buffer.Begin(CameraViewProj());
+        buffer.AddOccluder(CUBE_POSITIONS, 24, CUBE_INDICES, 36, World({ 0, 0, 0 }, { 10, 3, 0.25f }));
+        buffer.Rasterize();
+        CHECK(buffer.GetStats().rasterizedTriangles > 0);
+
+        CHECK(!buffer.IsVisible(Box({ 0, 1, 5 }, { 1, 1, 1 })));
+        CHECK(buffer.IsVisible(Box({ 0, 2, -3 }, { 1, 1, 1 })));
+        CHECK(buffer.IsVisible(Box({ 0, 0, 0 }, { 10, 3, 0.25f })));
+        CHECK(buffer.IsVisible(Box({ 0, 8, 5 }, { 1, 2, 1 })));
+
+        // Boxes around the camera are kept, those behind it or past far are not
+        CHECK(buffer.IsVisible(Box({ 0, 2, -10 }, { 1, 1, 1 })));
+        CHECK(!buffer.IsVisible(Box({ 0, 2, -20 }, { 1, 1, 1 })));
+        CHECK(!buffer.IsVisible(Box({ 0, 2, 600 }, { 1, 1, 1 })));
+
+        ShadowAabb boxes[] = { Box({ 0, 1, 5 }, { 1, 1, 1 }), Box({ 0, 2, -3 }, { 1, 1, 1 }), Box({ 0, 2, -20 }, { 1, 1, 1 }) };
+        uint8_t visible[3];
+        buffer.TestVisibility(boxes, 3, visible);
+        CHECK(visible[0] == 0 && visible[1] == 1 && visible[2] == 0);
+
+        const OcclusionStats& stats = buffer.GetStats();
+        CHECK(stats.tested == 3 && stats.frustumCulled == 1 && stats.occlusionCulled == 1);
+    }
+
+    // A slab under the camera crosses the near plane and has to be clipped
+    void OccludersCrossingNearAreClipped()
+    {
+        OcclusionBuffer buffer;
+        buffer.Begin(CameraViewProj());
+        buffer.AddOccluder(CUBE_POSITIONS, 24, CUBE_INDICES, 36, World({ 0, 0, -8 }, { 50, 0.5f, 50 }));
+        buffer.Rasterize();
+        CHECK(buffer.GetStats().rasterizedTriangles > 0);
+        CHECK(!buffer.IsVisible(Box({ 0, -5, 10 }, { 1, 1, 1 })));
+        CHECK(buffer.IsVisible(Box({ 0, 3, 10 }, { 1, 1, 1 })));
+    }
+
+    // No stored depth may be nearer than the surface at that pixel center,
+    // or a visible object could be culled
+    void DepthIsConservative()
+    {
+        std::vector<float> positions;
+        std::vector<uint32_t> indices;
+        MakeTriangles(400, positions, indices);
+        OcclusionMatrix viewProj = CameraViewProj();
+
+        OcclusionBuffer buffer;
+        buffer.SetSimd(OCCLUSION_SIMD_SSE);
+        buffer.Begin(viewProj);
+        buffer.AddOccluder(positions.data(), (uint32_t)positions.size() / 3, indices.data(), (uint32_t)indices.size(), World({ 0, 0, 0 }, { 1, 1, 1 }));
+        buffer.Rasterize();
+
+        const uint32_t width = buffer.GetWidth(), height = buffer.GetHeight();
+        const float* depth = buffer.GetDepth();
+        size_t covered = 0, nearer = 0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                float exact = ExactDepth(positions, indices, viewProj, width, height, x + 0.5f, y + 0.5f);
+                if (exact < 1.0f)
+                {
+                    ++covered;
+                    nearer += depth[y * width + x] < exact - 1e-5f;
+                }
+            }
+        }
+        CHECK(covered > 1000);
+        CHECK(nearer == 0);
+
+        bool tilesAreMax = true;
+        const uint32_t tilesX = width / OcclusionBuffer::TILE_SIZE;
+        for (uint32_t ty = 0; ty < height / OcclusionBuffer::TILE_SIZE; ++ty)
+        {
+            for (uint32_t tx = 0; tx < tilesX; ++tx)
+            {
+                float farthest = 0.0f;
+                for (uint32_t y = 0; y < OcclusionBuffer::TILE_SIZE; ++y)
+                {
+                    for (uint32_t x = 0; x < OcclusionBuffer::TILE_SIZE; ++x)
+                        farthest = (std::max)(farthest, depth[(ty * OcclusionBuffer::TILE_SIZE + y) * width + tx * OcclusionBuffer::TILE_SIZE + x]);
+                }
+                tilesAreMax &= buffer.GetTileDepth()[ty * tilesX + tx] == farthest;
+            }
+        }
+        CHECK(tilesAreMax);
+    }
+
+    void Avx2MatchesSse()
+    {
+        if (!OcclusionBuffer::IsAvx2Supported())
+            return;
+
+        std::vector<float> positions;
+        std::vector<uint32_t> indices;
+        MakeTriangles(400, positions, indices);
+
+        OcclusionBuffer sse, avx2;
+        sse.SetSimd(OCCLUSION_SIMD_SSE);
+        avx2.SetSimd(OCCLUSION_SIMD_AVX2);
+        for (OcclusionBuffer* buffer : { &sse, &avx2 })
+        {
+            buffer->Begin(CameraViewProj());
+            buffer->AddOccluder(positions.data(), (uint32_t)positions.size() / 3, indices.data(), (uint32_t)indices.size(), World({ 0, 0, 0 }, { 1, 1, 1 }));
+            buffer->Rasterize();
+        }
+        CHECK(avx2.GetStats().simd == OCCLUSION_SIMD_AVX2);
+
+        size_t pixels = (size_t)sse.GetWidth() * sse.GetHeight();
+        CHECK(memcmp(sse.GetDepth(), avx2.GetDepth(), pixels * sizeof(float)) == 0);
+    }
+
+    void ScreenSizeShrinksWithDistance()
+    {
+        const float fovY = 3.14159265f / 4.0f;
+        ShadowAabb box = Box({ 0, 0, 0 }, { 1, 1, 1 });
+        float nearSize = OcclusionBuffer::EstimateScreenSize(box, { 0, 0, -5 }, fovY);
+        float farSize = OcclusionBuffer::EstimateScreenSize(box, { 0, 0, -50 }, fovY);
+        CHECK(nearSize > farSize && farSize > 0.0f);
+        CHECK(OcclusionBuffer::EstimateScreenSize(box, { 0, 0, 0 }, fovY) >= 1.0f);
+    }
+}
+
+int main()
+{
+    JobSystem::Initialize(4);
+    RUN_TEST(WallHidesWhatIsBehindIt);
+    RUN_TEST(OccludersCrossingNearAreClipped);
+    RUN_TEST(DepthIsConservative);
+    RUN_TEST(Avx2MatchesSse);
+    RUN_TEST(ScreenSizeShrinksWithDistance);
+    JobSystem::Shutdown();
+    return TEST_RESULT();
+}
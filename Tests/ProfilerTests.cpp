@@ -0,0 +1,251 @@
+#include "Check.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace Engine::Core;
+
+namespace
+{
+    void Spin(double ms)
+    {
+        uint64_t end = Profiler::Now() + (uint64_t)(ms * 1e6);
+        while (Profiler::Now() < end)
+        {
+        }
+    }
+
+    void PathsNestAndSumPerFrame()
+    {
+        Profiler::Initialize();
+        Profiler::SetThreadName("Main");
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            {
+                ProfileScope root("Frame");
+                {
+                    ProfileScope shadow("ShadowPass");
+                    Spin(1.0);
+                }
+                for (int i = 0; i < 3; ++i)
+                {
+                    ProfileScope main("MainRenderPass");
+                    ProfileScope draw("Draw");
+                    Spin(0.5);
+                }
+            }
+            Profiler::EndFrame();
+        }
+
+        ProfileScopeStats stats;
+        CHECK(Profiler::GetScopeStats("Frame/ShadowPass", false, stats));
+        CHECK(stats.frames == 10 && stats.callsPerFrame == 1.0);
+        CHECK(stats.averageMs >= 1.0);
+        CHECK(Profiler::GetScopeStats("Frame/MainRenderPass/Draw", false, stats));
+        CHECK(stats.callsPerFrame == 3.0 && stats.averageMs >= 1.5);
+        CHECK(stats.minMs <= stats.averageMs && stats.maxMs >= stats.averageMs);
+        CHECK(Profiler::GetScopeStats("Frame", false, stats) && stats.averageMs >= 2.5);
+
+        // Paths are full, and CPU and GPU scopes do not mix
+        CHECK(!Profiler::GetScopeStats("ShadowPass", false, stats));
+        CHECK(!Profiler::GetScopeStats("Frame/ShadowPass", true, stats));
+        CHECK(!Profiler::GetAllScopeStats().empty());
+    }
+
+    void DisabledRecordsNothing()
+    {
+        Profiler::Initialize();
+        Profiler::SetEnabled(false);
+        {
+            ProfileScope hidden("Hidden");
+        }
+        Profiler::SetEnabled(true);
+        {
+            ProfileScope shown("Shown");
+        }
+        Profiler::EndFrame();
+
+        ProfileScopeStats stats;
+        CHECK(!Profiler::GetScopeStats("Hidden", false, stats));
+        CHECK(Profiler::GetScopeStats("Shown", false, stats));
+    }
+
+    // A scope open across a frame boundary lands in the frame it ends in;
+    // one gone for the whole window drops out
+    void ScopesFollowTheFrames()
+    {
+        Profiler::Initialize();
+        ProfileScopeStats stats;
+        CHECK(Profiler::BeginScope("Long"));
+        Profiler::EndFrame();
+        CHECK(!Profiler::GetScopeStats("Long", false, stats));
+        Profiler::EndScope();
+        Profiler::EndFrame();
+        CHECK(Profiler::GetScopeStats("Long", false, stats) && stats.frames == 1);
+
+        for (uint32_t i = 0; i < PROFILER_AVERAGE_FRAMES; ++i)
+            Profiler::EndFrame();
+        CHECK(!Profiler::GetScopeStats("Long", false, stats));
+    }
+
+    void GpuFramesConvertTicks()
+    {
+        Profiler::Initialize();
+        const GpuScopeTimestamps scopes[] = {
+            { "Frame", 0, 1000, 17000 },
+            { "ShadowPass", 1, 2000, 6000 },
+            { "Cascade", 2, 2000, 3000 },
+            { "MainRenderPass", 1, 6000, 14000 } };
+        for (int i = 0; i < 5; ++i)
+            Profiler::SubmitGpuFrame(scopes, 4, 1000000, 1000, Profiler::Now());
+
+        ProfileScopeStats stats;
+        CHECK(Profiler::GetScopeStats("Frame/ShadowPass", true, stats) && stats.frames == 5);
+        CHECK_NEAR(stats.averageMs, 4.0, 1e-9);
+        CHECK(Profiler::GetScopeStats("Frame/ShadowPass/Cascade", true, stats));
+        CHECK_NEAR(stats.averageMs, 1.0, 1e-9);
+        CHECK(Profiler::GetScopeStats("Frame/MainRenderPass", true, stats));
+        CHECK_NEAR(stats.averageMs, 8.0, 1e-9);
+        CHECK(Profiler::GetScopeStats("Frame", true, stats));
+        CHECK_NEAR(stats.averageMs, 16.0, 1e-9);
+        CHECK(!Profiler::GetScopeStats("Frame/ShadowPass", false, stats));
+    }
+
+    // A full ring drops whole scopes and the pairs that made it stay balanced
+    void FullRingDropsWholeScopes()
+    {
+        Profiler::Initialize();
+        for (uint32_t i = 0; i < PROFILER_RING_CAPACITY; ++i)
+        {
+            ProfileScope outer("A");
+            ProfileScope inner("B");
+        }
+        CHECK(Profiler::GetStats().droppedEvents > 0);
+        Profiler::EndFrame();
+
+        ProfileScopeStats stats;
+        CHECK(Profiler::GetScopeStats("A", false, stats));
+        CHECK(Profiler::GetScopeStats("A/B", false, stats));
+        CHECK(stats.callsPerFrame > 0.0 && stats.callsPerFrame < PROFILER_RING_CAPACITY);
+
+        {
+            ProfileScope after("After");
+        }
+        Profiler::EndFrame();
+        CHECK(Profiler::GetScopeStats("After", false, stats));
+        CHECK(!Profiler::GetScopeStats("B", false, stats));
+    }
+
+    // Threads record while the main thread drains them every frame
+    void ThreadsRecordConcurrently()
+    {
+        Profiler::Initialize();
+        Profiler::SetThreadName("Main");
+        static const char* const names[] = { "Worker 0", "Worker 1", "Worker 2", "Worker 3" };
+
+        std::atomic<bool> stop{ false };
+        std::vector<std::thread> threads;
+        for (const char* name : names)
+        {
+            threads.emplace_back([&stop, name]
+            {
+                Profiler::SetThreadName(name);
+                while (!stop.load())
+                {
+                    ProfileScope job("Job");
+                    ProfileScope inner("Inner");
+                }
+            });
+        }
+        for (int frame = 0; frame < 50; ++frame)
+        {
+            {
+                ProfileScope root("Frame");
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            Profiler::EndFrame();
+        }
+        stop = true;
+        for (std::thread& thread : threads)
+            thread.join();
+        Profiler::EndFrame();
+
+        ProfileScopeStats stats;
+        CHECK(Profiler::GetStats().threads == 5);
+        CHECK(Profiler::GetScopeStats("Frame", false, stats));
+        CHECK(Profiler::GetScopeStats("Job", false, stats));
+        CHECK(Profiler::GetScopeStats("Job/Inner", false, stats));
+        CHECK(!Profiler::GetScopeStats("Inner", false, stats));
+
+        std::string trace = Profiler::WriteChromeTrace();
+        CHECK(trace.find("Worker 3") != std::string::npos);
+    }
+
+    void JobWorkersHaveTracks()
+    {
+        Profiler::Initialize();
+        JobSystem::Initialize(4);
+        for (int frame = 0; frame < 5; ++frame)
+        {
+            {
+                ProfileScope root("Frame");
+                JobContext ctx;
+                JobSystem::Dispatch(ctx, 1000, 16, [](uint32_t)
+                {
+                    ProfileScope work("Work");
+                    volatile int sum = 0;
+                    for (int i = 0; i < 1000; ++i)
+                        sum = sum + i;
+                });
+                JobSystem::Wait(ctx);
+            }
+            Profiler::EndFrame();
+        }
+        JobSystem::Shutdown();
+
+        ProfileScopeStats stats;
+        CHECK(Profiler::GetScopeStats("Job/Work", false, stats) || Profiler::GetScopeStats("Frame/Job/Work", false, stats));
+        CHECK(Profiler::WriteChromeTrace().find("Job worker") != std::string::npos);
+    }
+
+    void ExportMatchesTheTrace()
+    {
+        Profiler::Initialize();
+        {
+            ProfileScope root("Frame");
+        }
+        Profiler::EndFrame();
+
+        std::string trace = Profiler::WriteChromeTrace();
+        CHECK(trace.find("\"Frame\"") != std::string::npos);
+
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "ProfilerTests.json";
+        CHECK(Profiler::ExportChromeTrace(path));
+        std::ifstream file(path);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        file.close();
+        CHECK(contents.str() == trace);
+        std::filesystem::remove(path);
+    }
+}
+
+int main()
+{
+    RUN_TEST(PathsNestAndSumPerFrame);
+    RUN_TEST(DisabledRecordsNothing);
+    RUN_TEST(ScopesFollowTheFrames);
+    RUN_TEST(GpuFramesConvertTicks);
+    RUN_TEST(FullRingDropsWholeScopes);
+    RUN_TEST(ThreadsRecordConcurrently);
+    RUN_TEST(JobWorkersHaveTracks);
+    RUN_TEST(ExportMatchesTheTrace);
+    Profiler::Shutdown();
+    return TEST_RESULT();
+}
@@ -0,0 +1,301 @@
+#include "Check.h"
+#include "ShaderCache.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <fstream>
+#include <functional>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+namespace
+{
+    std::filesystem::path TestDirectory()
+    {
+        return std::filesystem::temp_directory_path() / "ShaderCacheTests";
+    }
+
+    void WriteText(const std::filesystem::path& path, const std::string& text)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+    }
+
+    // "Compiles" to the source followed by every include it resolves through
+    // the snapshot, so the bytecode shows exactly which bytes were built
+    class FakeCompiler : public IShaderCompiler
+    {
+    public:
+        std::atomic<uint32_t> compiles{ 0 };
+        uint64_t version = 1;
+        std::function<void()> duringCompile;
+
+        bool Compile(const ShaderCompileRequest& request, const ShaderSourceSnapshot& source,
+            std::vector<uint8_t>& outBytecode, std::string& outErrors) override
+        {
+            compiles++;
+            if (duringCompile)
+                duringCompile();
+
+            if (source.text.find("error") != std::string::npos)
+            {
+                outErrors = request.path.string() + ": error\n";
+                return false;
+            }
+
+            std::string out = source.text;
+            for (const auto& [path, text] : source.includes)
+                out += "|" + text;
+            outBytecode.assign(out.begin(), out.end());
+            return true;
+        }
+
+        bool Reflect(const std::vector<uint8_t>& bytecode, ShaderReflectionData& outReflection) override
+        {
+            ShaderResourceBindingInfo binding;
+            binding.name = "size" + std::to_string(bytecode.size());
+            binding.type = ShaderBindingType::Texture;
+            outReflection.bindings = { binding };
+            return true;
+        }
+
+        uint64_t GetVersion() const override { return version; }
+    };
+
+    std::string ToString(const std::vector<uint8_t>& bytes)
+    {
+        return std::string(bytes.begin(), bytes.end());
+    }
+
+    ShaderCompileRequest MakeRequest(const char* file)
+    {
+        ShaderCompileRequest request;
+        request.path = TestDirectory() / file;
+        request.target = "ps_5_0";
+        return request;
+    }
+
+    void Reset()
+    {
+        AssetCache::Shutdown();
+        std::error_code ec;
+        std::filesystem::remove_all(TestDirectory(), ec);
+
+        WriteText(TestDirectory() / "Main.hlsl", "#include \"Common.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+        WriteText(TestDirectory() / "Common.hlsli", "#include \"Lib/Math.hlsli\"\n// #include \"Commented.hlsli\"\n");
+        WriteText(TestDirectory() / "Lib/Math.hlsli", "#include \"Shared.hlsli\"\nfloat Square(float x) { return x * x; }\n");
+        WriteText(TestDirectory() / "Shared.hlsli", "static const float PI = 3.14159;\n");
+        WriteText(TestDirectory() / "Unrelated.hlsli", "float Unused;\n");
+
+        AssetCache::Initialize(TestDirectory() / "Cache");
+    }
+
+    void KeyCoversEverythingThatShapesBytecode()
+    {
+        Reset();
+        FakeCompiler compiler;
+        ShaderCache cache(&compiler);
+
+        ShaderCompileRequest request = MakeRequest("Main.hlsl");
+        const uint64_t key = cache.ComputeKey(request);
+        CHECK(key != 0);
+        CHECK(cache.ComputeKey(request) == key);
+        CHECK(cache.ComputeKey(MakeRequest("Missing.hlsl")) == 0);
+
+        // Not included: no effect
+        WriteText(TestDirectory() / "Unrelated.hlsli", "float Changed;\n");
+        CHECK(cache.ComputeKey(request) == key);
+
+        // Two levels down, found next to the root file rather than the includer
+        WriteText(TestDirectory() / "Shared.hlsli", "static const float PI = 3.0;\n");
+        uint64_t sharedEdited = cache.ComputeKey(request);
+        CHECK(sharedEdited != key);
+
+        ShaderCompileRequest variant = request;
+        variant.defines.push_back({ "USE_FOG", "1" });
+        uint64_t withDefine = cache.ComputeKey(variant);
+        CHECK(withDefine != sharedEdited);
+        variant.defines[0].value = "0";
+        CHECK(cache.ComputeKey(variant) != withDefine);
+
+        variant = request;
+        variant.entryPoint = "mainAlt";
+        CHECK(cache.ComputeKey(variant) != sharedEdited);
+        variant = request;
+        variant.target = "vs_5_0";
+        CHECK(cache.ComputeKey(variant) != sharedEdited);
+        variant = request;
+        variant.flags = 1;
+        CHECK(cache.ComputeKey(variant) != sharedEdited);
+
+        compiler.version = 2;
+        CHECK(cache.ComputeKey(request) != sharedEdited);
+    }
+
+    void MissingIncludeCountsWhenCreated()
+    {
+        Reset();
+        FakeCompiler compiler;
+        ShaderCache cache(&compiler);
+
+        WriteText(TestDirectory() / "Optional.hlsl", "#include \"Later.hlsli\"\n");
+        ShaderCompileRequest request = MakeRequest("Optional.hlsl");
+        uint64_t before = cache.ComputeKey(request);
+        CHECK(before != 0);
+
+        WriteText(TestDirectory() / "Later.hlsli", "");
+        CHECK(cache.ComputeKey(request) != before);
+    }
+
+    void SnapshotHoldsTheHashedBytes()
+    {
+        Reset();
+        FakeCompiler compiler;
+        ShaderCache cache(&compiler);
+
+        ShaderSourceSnapshot source;
+        ShaderCompileRequest request = MakeRequest("Main.hlsl");
+        CHECK(cache.ComputeKey(request, &source) != 0);
+        CHECK(source.path == request.path);
+        CHECK(source.text.find("SV_Target") != std::string::npos);
+        CHECK(source.includes.size() == 3);
+
+        // Resolved like the key: next to the includer first, then next to the root file
+        std::filesystem::path resolved;
+        std::filesystem::path math = (TestDirectory() / "Lib/Math.hlsli").lexically_normal();
+        CHECK(source.FindInclude(request.path, "Common.hlsli") != nullptr);
+        CHECK(source.FindInclude(request.path, "Lib/Math.hlsli", &resolved) != nullptr && resolved == math);
+        CHECK(source.FindInclude(math, "Shared.hlsli", &resolved) != nullptr &&
+            resolved == (TestDirectory() / "Shared.hlsli").lexically_normal());
+        CHECK(source.FindInclude(request.path, "Commented.hlsli") == nullptr);
+        CHECK(source.FindInclude(request.path, "Unrelated.hlsli") == nullptr);
+    }
+
+    void SecondCompileIsAHit()
+    {
+        Reset();
+        FakeCompiler compiler;
+        ShaderCache cache(&compiler);
+
+        ShaderCompileRequest request = MakeRequest("Main.hlsl");
+        ShaderCompileResult first, second;
+        CHECK(cache.Compile(request, first));
+        CHECK(!first.fromCache);
+        CHECK(cache.Compile(request, second));
+        CHECK(second.fromCache);
+        CHECK(compiler.compiles.load() == 1);
+        CHECK(second.bytecode == first.bytecode);
+        CHECK(second.key == first.key);
+        CHECK(second.reflection.bindings.size() == 1 && second.reflection.bindings[0].name == first.reflection.bindings[0].name);
+
+        // Failures are never cached
+        WriteText(TestDirectory() / "Broken.hlsl", "error\n");
+        ShaderCompileResult broken;
+        CHECK(!cache.Compile(MakeRequest("Broken.hlsl"), broken));
+        CHECK(!broken.errors.empty());
+        CHECK(!cache.Compile(MakeRequest("Broken.hlsl"), broken));
+        CHECK(compiler.compiles.load() == 3);
+
+        ShaderCacheStats stats = cache.GetStats();
+        CHECK(stats.hits == 1);
+        CHECK(stats.compiled == 1);
+        CHECK(stats.failed == 2);
+    }
+
+    void EditDuringCompileIsNotCachedUnderTheOldKey()
+    {
+        Reset();
+        FakeCompiler compiler;
+        ShaderCache cache(&compiler);
+        ShaderCompileRequest request = MakeRequest("Main.hlsl");
+
+        // The header changes on disk after hashing, before the compiler runs
+        compiler.duringCompile = []
+            {
+                WriteText(TestDirectory() / "Shared.hlsli", "static const float PI = 4.0;\n");
+            };
+        ShaderCompileResult result;
+        CHECK(cache.Compile(request, result));
+        CHECK(ToString(result.bytecode).find("3.14159") != std::string::npos);
+        compiler.duringCompile = nullptr;
+
+        // Back to the hashed text: the entry holds what that text compiles to
+        WriteText(TestDirectory() / "Shared.hlsli", "static const float PI = 3.14159;\n");
+        ShaderCompileResult hit;
+        CHECK(cache.Compile(request, hit));
+        CHECK(hit.fromCache);
+        CHECK(ToString(hit.bytecode).find("3.14159") != std::string::npos);
+        CHECK(ToString(hit.bytecode).find("4.0") == std::string::npos);
+    }
+
+    void CollectIncludesListsEachFileOnce()
+    {
+        Reset();
+        WriteText(TestDirectory() / "Twice.hlsl", "#include \"Common.hlsli\"\n#include \"Shared.hlsli\"\n#include \"Common.hlsli\"\n");
+
+        std::vector<std::filesystem::path> includes;
+        ShaderCache::CollectIncludes(TestDirectory() / "Twice.hlsl", includes);
+        CHECK(includes.size() == 3);
+        CHECK(includes[0] == (TestDirectory() / "Common.hlsli").lexically_normal());
+        CHECK(includes[1] == (TestDirectory() / "Lib/Math.hlsli").lexically_normal());
+        CHECK(includes[2] == (TestDirectory() / "Shared.hlsli").lexically_normal());
+
+        ShaderCache::CollectIncludes(TestDirectory() / "Missing.hlsl", includes);
+        CHECK(includes.empty());
+    }
+
+    void BatchCompilesInParallel()
+    {
+        Reset();
+        JobSystem::Initialize(3);
+        {
+            FakeCompiler compiler;
+            ShaderCache cache(&compiler);
+
+            std::vector<ShaderCompileRequest> requests;
+            for (int i = 0; i < 16; ++i)
+            {
+                ShaderCompileRequest request = MakeRequest("Main.hlsl");
+                request.defines.push_back({ "VARIANT", std::to_string(i % 8) });
+                requests.push_back(request);
+            }
+
+            // Eight distinct keys, each one twice in the batch
+            std::vector<ShaderCompileResult> results;
+            cache.CompileAll(requests.data(), requests.size(), results);
+            CHECK(results.size() == requests.size());
+
+            bool allSucceeded = true;
+            for (size_t i = 0; i < results.size(); ++i)
+                allSucceeded &= results[i].success && results[i].key == results[(i + 8) % 16].key;
+            CHECK(allSucceeded);
+            CHECK(results[0].key != results[1].key);
+
+            cache.CompileAll(requests.data(), requests.size(), results);
+            bool allCached = true;
+            for (const ShaderCompileResult& result : results)
+                allCached &= result.fromCache;
+            CHECK(allCached);
+        }
+        JobSystem::Shutdown();
+    }
+}
+
+int main()
+{
+    RUN_TEST(KeyCoversEverythingThatShapesBytecode);
+    RUN_TEST(MissingIncludeCountsWhenCreated);
+    RUN_TEST(SnapshotHoldsTheHashedBytes);
+    RUN_TEST(SecondCompileIsAHit);
+    RUN_TEST(EditDuringCompileIsNotCachedUnderTheOldKey);
+    RUN_TEST(CollectIncludesListsEachFileOnce);
+    RUN_TEST(BatchCompilesInParallel);
+
+    AssetCache::Shutdown();
+    std::error_code ec;
+    std::filesystem::remove_all(TestDirectory(), ec);
+    return TEST_RESULT();
+}
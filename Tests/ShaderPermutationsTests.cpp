@@ -0,0 +1,182 @@
+#include "Check.h"
+#include "ShaderPermutations.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <fstream>
+#include <set>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+namespace
+{
+    std::filesystem::path TestDirectory()
+    {
+        return std::filesystem::temp_directory_path() / "ShaderPermutationsTests";
+    }
+
+    // Bytecode is the define values in order, so a result shows which variant it is
+    class FakeCompiler : public IShaderCompiler
+    {
+    public:
+        std::atomic<uint32_t> compiles{ 0 };
+
+        bool Compile(const ShaderCompileRequest& request, const ShaderSourceSnapshot&,
+            std::vector<uint8_t>& outBytecode, std::string&) override
+        {
+            compiles++;
+            for (const ShaderDefine& define : request.defines)
+                outBytecode.insert(outBytecode.end(), define.value.begin(), define.value.end());
+            return true;
+        }
+
+        bool Reflect(const std::vector<uint8_t>&, ShaderReflectionData&) override { return true; }
+        uint64_t GetVersion() const override { return 1; }
+    };
+
+    // Lit pixel shader: shadow quality only matters when lights are mixed in
+    struct LitSpace
+    {
+        ShaderPermutationSpace space;
+        uint32_t shadowQuality = space.AddFeature("SHADOW_QUALITY", 3);
+        uint32_t lightMix = space.AddFeature("LIGHT_MIX", 3);
+        uint32_t normalMap = space.AddFeature("NORMAL_MAP", 2);
+        uint32_t alphaTest = space.AddFeature("ALPHA_TEST", 2);
+
+        LitSpace() { space.AddCollapseRule(lightMix, 1, shadowQuality, 0); }
+    };
+
+    void KeysPackEveryFeature()
+    {
+        LitSpace lit;
+        const ShaderPermutationSpace& space = lit.space;
+        CHECK(space.GetFeatureCount() == 4);
+        CHECK(space.GetCombinationCount() == 36);
+
+        ShaderVariantKey key = 0;
+        key = space.Set(key, lit.shadowQuality, 2);
+        key = space.Set(key, lit.lightMix, 1);
+        key = space.Set(key, lit.alphaTest, 1);
+        CHECK(space.Get(key, lit.shadowQuality) == 2);
+        CHECK(space.Get(key, lit.lightMix) == 1);
+        CHECK(space.Get(key, lit.normalMap) == 0);
+        CHECK(space.Get(key, lit.alphaTest) == 1);
+        CHECK(space.IsValid(key));
+
+        // Out of range values and stray bits
+        CHECK(!space.IsValid(space.Set(0, lit.shadowQuality, 3)));
+        CHECK(!space.IsValid(1u << 31));
+
+        std::vector<ShaderDefine> defines;
+        space.GetDefines(key, defines);
+        CHECK(defines.size() == 4);
+        CHECK(defines[0].name == "SHADOW_QUALITY" && defines[0].value == "2");
+        CHECK(space.GetName(key) == "SHADOW_QUALITY=2 LIGHT_MIX=1 NORMAL_MAP=0 ALPHA_TEST=1");
+    }
+
+    void CollapseRulesPruneEquivalentVariants()
+    {
+        LitSpace lit;
+        const ShaderPermutationSpace& space = lit.space;
+
+        ShaderVariantKey key = space.Set(space.Set(0, lit.shadowQuality, 2), lit.lightMix, 1);
+        CHECK(space.Get(space.Canonicalize(key), lit.shadowQuality) == 0);
+        CHECK(space.Canonicalize(space.Canonicalize(key)) == space.Canonicalize(key));
+
+        // 3 light mixes x 3 qualities x 4, minus the two qualities LIGHT_MIX=1 drops
+        std::vector<ShaderVariantKey> variants;
+        space.EnumerateVariants(variants);
+        CHECK(variants.size() == 28);
+
+        std::set<ShaderVariantKey> unique(variants.begin(), variants.end());
+        CHECK(unique.size() == variants.size());
+        bool allCanonical = true;
+        for (ShaderVariantKey variant : variants)
+            allCanonical &= space.IsValid(variant) && space.Canonicalize(variant) == variant;
+        CHECK(allCanonical);
+    }
+
+    void ChainedRulesReachAFixedPoint()
+    {
+        // A=0 pins B to 0, which in turn pins C; rules are added in the worst order
+        ShaderPermutationSpace space;
+        uint32_t a = space.AddFeature("A", 2);
+        uint32_t b = space.AddFeature("B", 2);
+        uint32_t c = space.AddFeature("C", 4);
+        space.AddCollapseRule(b, 0, c, 0);
+        space.AddCollapseRule(a, 0, b, 0);
+
+        ShaderVariantKey key = space.Set(space.Set(space.Set(0, a, 0), b, 1), c, 3);
+        CHECK(space.Canonicalize(key) == 0);
+
+        std::vector<ShaderVariantKey> variants;
+        space.EnumerateVariants(variants);
+        CHECK(variants.size() == 1 + 1 + 4);
+    }
+
+    void VariantCacheCompilesEachCanonicalKeyOnce()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(TestDirectory(), ec);
+        std::filesystem::create_directories(TestDirectory());
+        std::ofstream(TestDirectory() / "Lit.hlsl") << "float4 main() : SV_Target { return 1; }\n";
+
+        JobSystem::Initialize(2);
+        AssetCache::Initialize(TestDirectory() / "Cache");
+        {
+            LitSpace lit;
+            FakeCompiler compiler;
+            ShaderCache cache(&compiler);
+            ShaderCompileRequest base;
+            base.path = TestDirectory() / "Lit.hlsl";
+            base.target = "ps_5_0";
+
+            ShaderVariantCache variants(&cache, lit.space, base);
+            ShaderVariantKey key = lit.space.Set(lit.space.Set(0, lit.shadowQuality, 2), lit.lightMix, 1);
+            const ShaderCompileResult& result = variants.Get(key);
+            CHECK(result.success);
+            CHECK(std::string(result.bytecode.begin(), result.bytecode.end()) == "0100");
+            CHECK(compiler.compiles.load() == 1);
+
+            // Another quality collapses onto the same variant
+            variants.Get(lit.space.Set(key, lit.shadowQuality, 1));
+            CHECK(compiler.compiles.load() == 1);
+            CHECK(variants.GetVariantCount() == 1);
+
+            // Duplicates and already compiled keys are skipped in the batch
+            ShaderVariantKey alpha = lit.space.Set(0, lit.alphaTest, 1);
+            variants.Prewarm({ 0, 1, 2, alpha, alpha, key });
+            CHECK(compiler.compiles.load() == 5);
+            CHECK(variants.GetVariantCount() == 5);
+
+            std::vector<ShaderVariantKey> keys;
+            variants.GetKeys(keys);
+            CHECK(keys.size() == 5);
+
+            // A second cache over the same space hits the bytecode cache
+            ShaderVariantCache again(&cache, lit.space, base);
+            CHECK(again.Get(key).fromCache);
+            CHECK(compiler.compiles.load() == 5);
+
+            ShaderCompileResult replaced;
+            replaced.success = true;
+            replaced.bytecode = { 'x' };
+            variants.Replace(lit.space.Set(key, lit.shadowQuality, 2), std::move(replaced));
+            CHECK(variants.Get(key).bytecode.size() == 1);
+        }
+        AssetCache::Shutdown();
+        JobSystem::Shutdown();
+        std::filesystem::remove_all(TestDirectory(), ec);
+    }
+}
+
+int main()
+{
+    RUN_TEST(KeysPackEveryFeature);
+    RUN_TEST(CollapseRulesPruneEquivalentVariants);
+    RUN_TEST(ChainedRulesReachAFixedPoint);
+    RUN_TEST(VariantCacheCompilesEachCanonicalKeyOnce);
+    return TEST_RESULT();
+}
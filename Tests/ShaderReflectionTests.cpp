@@ -0,0 +1,194 @@
+#include "Check.h"
+#include "ShaderReflection.h"
+#include "AssetCache.h"
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+namespace
+{
+    struct Matrix
+    {
+        float m[16];
+    };
+
+    // Mirrors the startup CBPerObject
+    struct PerObject
+    {
+        Matrix World;
+        Matrix WorldInvTranspose;
+        Matrix View;
+        Matrix Projection;
+        Matrix LightViewProj;
+    };
+
+    const ConstantBufferMember PER_OBJECT_MEMBERS[] =
+    {
+        CB_MEMBER(PerObject, World),
+        CB_MEMBER(PerObject, WorldInvTranspose),
+        CB_MEMBER(PerObject, View),
+        CB_MEMBER(PerObject, Projection),
+        CB_MEMBER(PerObject, LightViewProj),
+    };
+
+    // What the compiler reports for the matching HLSL cbuffer; the last
+    // matrix is declared but unused unless the stage says otherwise
+    ShaderReflectionData MakePerObjectStage(uint32_t slot = 0)
+    {
+        ShaderReflectionData stage;
+        ShaderConstantBufferInfo cb;
+        cb.name = "CBPerObject";
+        cb.slot = slot;
+        cb.size = sizeof(PerObject);
+        const char* names[] = { "World", "WorldInvTranspose", "View", "Projection", "LightViewProj" };
+        for (uint32_t i = 0; i < 5; ++i)
+            cb.variables.push_back({ names[i], i * 64, 64, i != 4 });
+        stage.constantBuffers.push_back(cb);
+        stage.bindings.push_back({ "CBPerObject", ShaderBindingType::ConstantBuffer, slot, 1 });
+        stage.bindings.push_back({ "DiffuseMap", ShaderBindingType::Texture, 0, 1 });
+        return stage;
+    }
+
+    void SerializationRoundTrips()
+    {
+        ShaderReflectionData stage = MakePerObjectStage(2);
+
+        BinaryWriter writer;
+        stage.Serialize(writer);
+
+        ShaderReflectionData loaded;
+        BinaryReader reader(writer.GetData());
+        CHECK(loaded.Deserialize(reader));
+        CHECK(reader.IsAtEnd());
+
+        const ShaderConstantBufferInfo* cb = loaded.FindConstantBuffer("CBPerObject");
+        CHECK(cb != nullptr && cb->slot == 2 && cb->size == sizeof(PerObject));
+        CHECK(cb != nullptr && cb->variables.size() == 5);
+        CHECK(cb != nullptr && cb->variables[3].name == "Projection" && cb->variables[3].offset == 192);
+        CHECK(cb != nullptr && cb->variables[3].used && !cb->variables[4].used);
+        CHECK(loaded.bindings.size() == 2);
+        CHECK(loaded.bindings[1].name == "DiffuseMap" && loaded.bindings[1].type == ShaderBindingType::Texture);
+        CHECK(loaded.FindConstantBuffer("CBMissing") == nullptr);
+
+        // A truncated entry is rejected rather than half read
+        std::vector<uint8_t> truncated(writer.GetData().begin(), writer.GetData().end() - 3);
+        BinaryReader shortReader(truncated);
+        ShaderReflectionData partial;
+        CHECK(!partial.Deserialize(shortReader));
+    }
+
+    void UsedRangesMergeAcrossVariables()
+    {
+        ShaderBindingTable table;
+        table.AddStage(MakePerObjectStage(), SHADER_STAGE_VERTEX);
+
+        const ConstantBufferBinding* cb = table.FindConstantBuffer("CBPerObject");
+        CHECK(cb != nullptr && cb->stages == SHADER_STAGE_VERTEX);
+        CHECK(cb != nullptr && cb->usedRanges.size() == 1);
+        CHECK(cb != nullptr && cb->usedRanges[0].offset == 0 && cb->usedRanges[0].size == 256);
+
+        // Shadow pass: only World and LightViewProj are read
+        ShaderReflectionData shadow = MakePerObjectStage();
+        for (ShaderVariableInfo& variable : shadow.constantBuffers[0].variables)
+            variable.used = variable.name == "World" || variable.name == "LightViewProj";
+
+        ShaderBindingTable shadowTable;
+        shadowTable.AddStage(shadow, SHADER_STAGE_VERTEX);
+        cb = shadowTable.FindConstantBuffer("CBPerObject");
+        CHECK(cb != nullptr && cb->usedRanges.size() == 2);
+        CHECK(cb != nullptr && cb->usedRanges[0].offset == 0 && cb->usedRanges[0].size == 64);
+        CHECK(cb != nullptr && cb->usedRanges[1].offset == 256 && cb->usedRanges[1].size == 64);
+
+        // A second stage reading the rest fills the gap
+        ShaderReflectionData pixel = MakePerObjectStage();
+        for (ShaderVariableInfo& variable : pixel.constantBuffers[0].variables)
+            variable.used = variable.name == "View" || variable.name == "WorldInvTranspose" || variable.name == "Projection";
+        shadowTable.AddStage(pixel, SHADER_STAGE_PIXEL);
+        cb = shadowTable.FindConstantBuffer("CBPerObject");
+        CHECK(cb != nullptr && cb->stages == (SHADER_STAGE_VERTEX | SHADER_STAGE_PIXEL));
+        CHECK(cb != nullptr && cb->usedRanges.size() == 1 && cb->usedRanges[0].size == sizeof(PerObject));
+    }
+
+    void MatchingLayoutValidates()
+    {
+        ShaderBindingTable table;
+        table.AddStage(MakePerObjectStage(), SHADER_STAGE_VERTEX);
+
+        const ConstantBufferLayout layouts[] = { { "CBPerObject", 0, sizeof(PerObject), PER_OBJECT_MEMBERS, 5 } };
+        std::string errors;
+        CHECK(table.Validate(layouts, 1, "Simple", errors));
+        CHECK(errors.empty());
+    }
+
+    void DriftIsReported()
+    {
+        ShaderBindingTable table;
+        table.AddStage(MakePerObjectStage(), SHADER_STAGE_VERTEX);
+
+        // C++ members reordered
+        const ConstantBufferMember swapped[] =
+        {
+            PER_OBJECT_MEMBERS[0], PER_OBJECT_MEMBERS[1],
+            { "View", 192, 64 }, { "Projection", 128, 64 },
+            PER_OBJECT_MEMBERS[4],
+        };
+        const ConstantBufferLayout swappedLayout[] = { { "CBPerObject", 0, sizeof(PerObject), swapped, 5 } };
+        std::string errors;
+        CHECK(!table.Validate(swappedLayout, 1, "Simple", errors));
+        CHECK(errors.find("View") != std::string::npos);
+        CHECK(errors.find("Projection") != std::string::npos);
+
+        // Missing members and the wrong slot
+        const ConstantBufferLayout shortLayout[] = { { "CBPerObject", 3, sizeof(PerObject), PER_OBJECT_MEMBERS, 3 } };
+        errors.clear();
+        CHECK(!table.Validate(shortLayout, 1, "Simple", errors));
+        CHECK(errors.find("LightViewProj") != std::string::npos);
+
+        // No layout at all
+        errors.clear();
+        CHECK(!table.Validate(nullptr, 0, "Simple", errors));
+        CHECK(errors.find("CBPerObject") != std::string::npos);
+    }
+
+    void StagesMustAgree()
+    {
+        ShaderReflectionData pixel = MakePerObjectStage(1);
+        pixel.constantBuffers[0].variables[2].offset = 132;
+
+        ShaderBindingTable table;
+        table.AddStage(MakePerObjectStage(), SHADER_STAGE_VERTEX);
+        table.AddStage(pixel, SHADER_STAGE_PIXEL);
+
+        const ConstantBufferLayout layouts[] = { { "CBPerObject", 0, sizeof(PerObject), PER_OBJECT_MEMBERS, 5 } };
+        std::string errors;
+        CHECK(!table.Validate(layouts, 1, "Simple", errors));
+        CHECK(!errors.empty());
+    }
+
+    void ArrayTailPaddingIsTolerated()
+    {
+        // HLSL float3 values[2] is 28 bytes, the C++ side pads it to 32
+        ShaderReflectionData stage;
+        stage.constantBuffers.push_back({ "CBArray", 0, 32, { { "values", 0, 28, true } } });
+
+        ShaderBindingTable table;
+        table.AddStage(stage, SHADER_STAGE_PIXEL);
+
+        const ConstantBufferMember members[] = { { "values", 0, 32 } };
+        const ConstantBufferLayout layouts[] = { { "CBArray", 0, 32, members, 1 } };
+        std::string errors;
+        CHECK(table.Validate(layouts, 1, "Array", errors));
+        CHECK(errors.empty());
+    }
+}
+
+int main()
+{
+    RUN_TEST(SerializationRoundTrips);
+    RUN_TEST(UsedRangesMergeAcrossVariables);
+    RUN_TEST(MatchingLayoutValidates);
+    RUN_TEST(DriftIsReported);
+    RUN_TEST(StagesMustAgree);
+    RUN_TEST(ArrayTailPaddingIsTolerated);
+    return TEST_RESULT();
+}
@@ -0,0 +1,90 @@
+#include "ShadowAtlas.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace Engine::Graphics;
+
+// Per-frame cost of the point light shadow atlas: Update over a field of
+// lights ranked by screen coverage, with the tile cache warm, and the
+// skyline packer alone on a large atlas.
+//
+//   ShadowAtlasBenchmark [lights] [frames]
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::vector<ShadowLightRequest> MakeLights(uint32_t count)
+    {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        const ShadowVector camera = { 0.0f, 1.0f, -10.0f };
+
+        std::vector<ShadowLightRequest> requests(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ShadowLightRequest& request = requests[i];
+            request.lightId = i;
+            request.faceCount = 6;
+            request.position = { -9.0f + 20.0f * unit(rng), 0.0f, -10.0f + 20.0f * unit(rng) };
+            request.range = 1.0f + unit(rng);
+            request.importance = ShadowAtlas::EstimateImportance(camera, 3.14159265f / 4.0f, request.position, request.range);
+        }
+        return requests;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t lights = argc > 1 ? (uint32_t)atoi(argv[1]) : 1024;
+    uint32_t frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 2000;
+    if (lights == 0 || frames == 0)
+    {
+        printf("usage: ShadowAtlasBenchmark [lights] [frames]\n");
+        return 1;
+    }
+
+    std::vector<ShadowLightRequest> requests = MakeLights(lights);
+    ShadowAtlas atlas{ ShadowAtlasSettings() };
+    atlas.Update(requests.data(), requests.size());
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < frames; ++i)
+        atlas.Update(requests.data(), requests.size());
+    double ms = MillisecondsSince(start) / frames;
+
+    const ShadowAtlasStats& stats = atlas.GetStats();
+    printf("Update: %u requests, %u shadowed, %u dropped, %zu tiles (%u cached), occupancy %.2f: %.4f ms/frame\n",
+        lights, stats.lightsShadowed, stats.lightsDropped, atlas.GetTiles().size(), stats.tilesCached, stats.occupancy, ms);
+
+    // Power-of-two tiles, largest first, the way Update feeds the packer
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> log2Size(6, 9);
+    std::vector<uint32_t> sizes(512);
+    for (uint32_t& size : sizes)
+        size = 1u << log2Size(rng);
+    std::sort(sizes.rbegin(), sizes.rend());
+
+    SkylinePacker packer;
+    AtlasRect rect;
+    const uint32_t packs = 200;
+    start = Clock::now();
+    for (uint32_t i = 0; i < packs; ++i)
+    {
+        packer.Reset(8192, 8192);
+        for (uint32_t size : sizes)
+            packer.Allocate(size, size, rect);
+    }
+    ms = MillisecondsSince(start) / packs;
+    printf("Skyline: %zu tiles into 8192^2: %.4f ms per pack, occupancy %.2f\n", sizes.size(), ms, packer.GetOccupancy());
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include "Check.h"
+#include "ShadowAtlas.h"
+
+#include <cmath>
+#include <random>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    bool Overlap(const AtlasRect& a, const AtlasRect& b)
+    {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    bool ValidLayout(const std::vector<AtlasRect>& rects, uint32_t width, uint32_t height)
+    {
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            if (rects[i].x + rects[i].width > width || rects[i].y + rects[i].height > height)
+                return false;
+            for (size_t j = i + 1; j < rects.size(); ++j)
+            {
+                if (Overlap(rects[i], rects[j]))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    ShadowLightRequest PointLight(uint32_t id, float importance, float x = 0.0f)
+    {
+        ShadowLightRequest request;
+        request.lightId = id;
+        request.faceCount = 6;
+        request.importance = importance;
+        request.position = { x, 0.0f, 0.0f };
+        request.range = 2.0f;
+        return request;
+    }
+
+    void PowerOfTwoSquaresPackWithoutGaps()
+    {
+        SkylinePacker packer;
+        packer.Reset(4096, 4096);
+        std::vector<AtlasRect> rects;
+        AtlasRect rect;
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK(packer.Allocate(1024, 1024, rect));
+            rects.push_back(rect);
+        }
+        CHECK(!packer.Allocate(1024, 1024, rect));
+        CHECK(!packer.Allocate(1, 1, rect));
+        CHECK(packer.GetOccupancy() == 1.0f);
+        CHECK(ValidLayout(rects, 4096, 4096));
+
+        // Mixed sizes, largest first: the leftover takes small tiles exactly
+        packer.Reset(4096, 4096);
+        rects.clear();
+        const uint32_t sizes[] = { 2048, 1024, 1024, 1024, 512, 512, 512, 512, 512, 512, 512, 512, 512, 512, 512, 512, 256, 256, 256, 256 };
+        for (uint32_t size : sizes)
+        {
+            CHECK(packer.Allocate(size, size, rect));
+            rects.push_back(rect);
+        }
+
+        uint64_t left = 4096ull * 4096 - packer.GetUsedArea();
+        uint64_t filled = 0;
+        while (packer.Allocate(256, 256, rect))
+        {
+            rects.push_back(rect);
+            filled += 256ull * 256;
+        }
+        CHECK(filled == left);
+        CHECK(ValidLayout(rects, 4096, 4096));
+    }
+
+    void RandomRectanglesStayInside()
+    {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<uint32_t> size(1, 300);
+
+        SkylinePacker packer;
+        packer.Reset(2048, 1024);
+        std::vector<AtlasRect> rects;
+        AtlasRect rect;
+        for (int i = 0; i < 400; ++i)
+        {
+            if (packer.Allocate(size(rng), size(rng), rect))
+                rects.push_back(rect);
+        }
+        CHECK(!rects.empty());
+        CHECK(ValidLayout(rects, 2048, 1024));
+    }
+
+    void ImportanceSetsTheTileSize()
+    {
+        const float fovY = 3.14159265f / 4.0f;
+        CHECK(ShadowAtlas::EstimateImportance({ 0, 0, 0 }, fovY, { 1, 0, 0 }, 2.0f) == 1.0f);
+
+        float nearLight = ShadowAtlas::EstimateImportance({ 0, 0, 0 }, fovY, { 5, 0, 0 }, 1.0f);
+        float farLight = ShadowAtlas::EstimateImportance({ 0, 0, 0 }, fovY, { 50, 0, 0 }, 1.0f);
+        CHECK(nearLight > farLight && farLight > 0.0f);
+        CHECK_NEAR(farLight, 1.0f / (50.0f * tanf(fovY / 2.0f)), 1e-3f);
+
+        ShadowAtlasSettings settings;
+        CHECK(ShadowAtlas::GetDesiredTileSize(1.0f, settings) == 1024);
+        CHECK(ShadowAtlas::GetDesiredTileSize(0.0f, settings) == 64);
+        CHECK(ShadowAtlas::GetDesiredTileSize(0.3f, settings) == 512);
+        CHECK(ShadowAtlas::GetDesiredTileSize(0.25f, settings) == 256);
+        settings.atlasSize = 512;
+        CHECK(ShadowAtlas::GetDesiredTileSize(1.0f, settings) == 512);
+    }
+
+    void FaceMasksFollowTheCube()
+    {
+        const ShadowVector light = { 0, 0, 0 };
+        CHECK(ShadowAtlas::GetPointLightFaceMask(light, 10, { { 3, -0.5f, -0.5f }, { 4, 0.5f, 0.5f } }) == 1u);
+        CHECK(ShadowAtlas::GetPointLightFaceMask(light, 10, { { -0.5f, -4, -0.5f }, { 0.5f, -3, 0.5f } }) == 8u);
+        CHECK(ShadowAtlas::GetPointLightFaceMask(light, 10, { { -1, -1, -1 }, { 1, 1, 1 } }) == 63u);
+        CHECK(ShadowAtlas::GetPointLightFaceMask(light, 2, { { 3, -0.5f, -0.5f }, { 4, 0.5f, 0.5f } }) == 0u);
+        CHECK(ShadowAtlas::GetPointLightFaceMask(light, 10, { { 2, 2, -0.1f }, { 3, 3, 0.1f } }) == (1u | 4u));
+        CHECK(ShadowAtlas::GetPointLightFaceMask({ 10, 0, 0 }, 10, { { 13, -0.5f, -0.5f }, { 14, 0.5f, 0.5f } }) == 1u);
+    }
+
+    // Least important lights shrink first, then drop; the layout stays valid
+    void BudgetShrinksThenDrops()
+    {
+        ShadowAtlasSettings settings;
+        ShadowAtlas atlas(settings);
+        std::vector<ShadowLightRequest> requests;
+        for (uint32_t i = 0; i < 20; ++i)
+            requests.push_back(PointLight(i, 1.0f - i * 0.04f, (float)i));
+        requests.push_back(PointLight(99, 0.001f));
+        atlas.Update(requests.data(), requests.size());
+
+        const ShadowAtlasStats& stats = atlas.GetStats();
+        CHECK(stats.lightsRequested == 21);
+        CHECK(stats.lightsShadowed == settings.maxLights);
+        CHECK(stats.lightsDropped == 4);
+        CHECK(atlas.GetFirstTile(19) == ShadowAtlas::INVALID_TILE);
+        CHECK(atlas.GetFirstTile(20) == ShadowAtlas::INVALID_TILE);
+        CHECK(atlas.GetTiles().size() == 6 * settings.maxLights);
+        CHECK(stats.occupancy > 0.5f && stats.occupancy <= 1.0f);
+
+        std::vector<AtlasRect> rects;
+        for (const ShadowAtlasTile& tile : atlas.GetTiles())
+            rects.push_back(tile.rect);
+        CHECK(ValidLayout(rects, settings.atlasSize, settings.atlasSize));
+
+        bool ordered = true, facesInOrder = true;
+        for (uint32_t i = 0; i < settings.maxLights; ++i)
+        {
+            ordered &= i == 0 || atlas.GetTileSize(i) <= atlas.GetTileSize(i - 1);
+            uint32_t first = atlas.GetFirstTile(i);
+            if (first == ShadowAtlas::INVALID_TILE)
+            {
+                facesInOrder = false;
+                continue;
+            }
+            for (uint32_t face = 0; face < 6; ++face)
+            {
+                const ShadowAtlasTile& tile = atlas.GetTiles()[first + face];
+                facesInOrder &= tile.request == i && tile.face == face && tile.rect.width == atlas.GetTileSize(i);
+            }
+        }
+        CHECK(ordered);
+        CHECK(facesInOrder);
+
+        // Not even the minimum tile fits for everyone: 256^2 / (6 * 64^2) is 2.67 lights
+        ShadowAtlasSettings tiny;
+        tiny.atlasSize = 256;
+        ShadowAtlas small(tiny);
+        small.Update(requests.data(), requests.size());
+        CHECK(small.GetStats().lightsShadowed == 2);
+        CHECK(small.GetFirstTile(0) != ShadowAtlas::INVALID_TILE);
+        CHECK(small.GetFirstTile(2) == ShadowAtlas::INVALID_TILE);
+    }
+
+    void StaticTilesStayCached()
+    {
+        ShadowAtlasSettings settings;
+        ShadowAtlas atlas(settings);
+        std::vector<ShadowLightRequest> requests = { PointLight(1, 0.5f), PointLight(2, 0.3f, 5.0f) };
+
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 12 && atlas.GetStats().tilesCached == 0);
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 0 && atlas.GetStats().tilesCached == 12);
+
+        // A dynamic caster in face 2 of the second light: that tile now, once more after it leaves
+        requests[1].dynamicFaceMask = 4;
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 1);
+        CHECK(atlas.GetTiles()[atlas.GetFirstTile(1) + 2].render);
+        requests[1].dynamicFaceMask = 0;
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 1);
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 0);
+
+        requests[0].position.y = 0.5f;
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 6);
+
+        // A new size moves the rects
+        requests[0].importance = 1.0f;
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered >= 6);
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 0);
+    }
+
+    void InvalidationAndMovingLightsRedraw()
+    {
+        ShadowAtlasSettings settings;
+        ShadowAtlas atlas(settings);
+        std::vector<ShadowLightRequest> requests = { PointLight(1, 0.5f), PointLight(2, 0.3f, 5.0f) };
+        atlas.Update(requests.data(), requests.size());
+
+        atlas.Invalidate();
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 12);
+
+        requests[1].isStatic = false;
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 6);
+
+        settings.cacheStatic = false;
+        atlas.SetSettings(settings);
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered == 12);
+
+        // A light that left the shadow set lost its tiles
+        settings.cacheStatic = true;
+        atlas.SetSettings(settings);
+        requests[1].isStatic = true;
+        atlas.Update(requests.data(), requests.size());
+        atlas.Update(requests.data(), 1);
+        atlas.Update(requests.data(), requests.size());
+        CHECK(atlas.GetStats().tilesRendered >= 6);
+    }
+}
+
+int main()
+{
+    RUN_TEST(PowerOfTwoSquaresPackWithoutGaps);
+    RUN_TEST(RandomRectanglesStayInside);
+    RUN_TEST(ImportanceSetsTheTileSize);
+    RUN_TEST(FaceMasksFollowTheCube);
+    RUN_TEST(BudgetShrinksThenDrops);
+    RUN_TEST(StaticTilesStayCached);
+    RUN_TEST(InvalidationAndMovingLightsRedraw);
+    return TEST_RESULT();
+}
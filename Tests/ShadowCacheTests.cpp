@@ -0,0 +1,164 @@
+#include "Check.h"
+#include "ShadowCache.h"
+
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const uint32_t CASCADES = 4;
+
+    CascadeCamera MakeCamera(float yaw, const ShadowVector& position)
+    {
+        CascadeCamera camera;
+        camera.position = position;
+        camera.fovY = 0.785398f;
+        camera.aspect = 16.0f / 9.0f;
+        camera.forward = { sinf(yaw), 0.0f, cosf(yaw) };
+        camera.right = { cosf(yaw), 0.0f, -sinf(yaw) };
+        camera.up = { 0.0f, 1.0f, 0.0f };
+        return camera;
+    }
+
+    void FitCascades(const CascadeCamera& camera, const LightBasis& basis, CascadeBounds* outBounds)
+    {
+        float splits[CASCADES];
+        CascadeShadows::ComputeSplits(0.1f, 100.0f, 0.6f, CASCADES, splits);
+        float sliceNear = 0.1f;
+        for (uint32_t c = 0; c < CASCADES; ++c)
+        {
+            outBounds[c] = CascadeShadows::FitStable(camera, basis, sliceNear, splits[c], 2048, 10.0f);
+            sliceNear = splits[c];
+        }
+    }
+
+    struct Fixture
+    {
+        LightBasis basis = CascadeShadows::MakeLightBasis({ 0.3f, -1.0f, 0.4f });
+        ShadowCacheScheduler scheduler{ CASCADES };
+        CascadeBounds bounds[CASCADES];
+        ShadowCascadeUpdate updates[CASCADES];
+
+        void Frame(const CascadeCamera& camera)
+        {
+            FitCascades(camera, basis, bounds);
+            scheduler.Schedule(basis, bounds, updates);
+        }
+    };
+
+    void FirstFrameRendersEverything()
+    {
+        Fixture fixture;
+        fixture.Frame(MakeCamera(0.0f, { 0.0f, 2.0f, -5.0f }));
+
+        bool all = true;
+        for (const ShadowCascadeUpdate& update : fixture.updates)
+            all &= update.update && update.renderStatic;
+        CHECK(all);
+        CHECK(fixture.scheduler.GetStats().cascadesUpdated == CASCADES);
+        CHECK(fixture.scheduler.GetStats().staticRenders == CASCADES);
+        CHECK(fixture.scheduler.GetFrame() == 1);
+    }
+
+    // Near cascades every frame, the far ones take turns, and nothing
+    // redraws its static casters while the camera holds still
+    void StillCameraAlternatesFarCascades()
+    {
+        Fixture fixture;
+        const CascadeCamera camera = MakeCamera(0.3f, { 0.0f, 2.0f, -5.0f });
+        for (int i = 0; i < 3; ++i)
+            fixture.Frame(camera);
+
+        uint32_t farUpdates[CASCADES] = {};
+        bool nearEveryFrame = true, staggered = true, cached = true;
+        for (int frame = 0; frame < 100; ++frame)
+        {
+            fixture.Frame(camera);
+            nearEveryFrame &= fixture.updates[0].update && fixture.updates[1].update;
+            staggered &= fixture.updates[2].update != fixture.updates[3].update;
+            cached &= fixture.scheduler.GetStats().staticRenders == 0;
+            for (uint32_t c = 0; c < CASCADES; ++c)
+                farUpdates[c] += fixture.updates[c].update ? 1 : 0;
+        }
+
+        CHECK(nearEveryFrame);
+        CHECK(staggered);
+        CHECK(cached);
+        CHECK(farUpdates[2] == 50 && farUpdates[3] == 50);
+        CHECK(fixture.scheduler.GetStats().cascadesSkipped == 1);
+    }
+
+    void MovingSeveralTexelsInvalidates()
+    {
+        Fixture fixture;
+        for (int i = 0; i < 3; ++i)
+            fixture.Frame(MakeCamera(0.0f, { 0.0f, 2.0f, -5.0f }));
+
+        fixture.Frame(MakeCamera(0.0f, { 0.5f, 2.0f, -5.0f }));
+        CHECK(fixture.updates[0].renderStatic);
+        CHECK(fixture.updates[1].renderStatic);
+    }
+
+    void InvalidatedCascadesRedrawOnceOnTheirTurn()
+    {
+        Fixture fixture;
+        const CascadeCamera camera = MakeCamera(0.0f, { 0.0f, 2.0f, -5.0f });
+        for (int i = 0; i < 3; ++i)
+            fixture.Frame(camera);
+
+        fixture.scheduler.InvalidateStatic();
+        uint32_t redraws[CASCADES] = {};
+        bool onlyWhenUpdated = true;
+        for (int frame = 0; frame < 4; ++frame)
+        {
+            fixture.Frame(camera);
+            for (uint32_t c = 0; c < CASCADES; ++c)
+            {
+                onlyWhenUpdated &= !fixture.updates[c].renderStatic || fixture.updates[c].update;
+                redraws[c] += fixture.updates[c].renderStatic ? 1 : 0;
+            }
+        }
+
+        CHECK(onlyWhenUpdated);
+        for (uint32_t c = 0; c < CASCADES; ++c)
+            CHECK(redraws[c] == 1);
+    }
+
+    void LightChangeAndDisabledCacheRedrawStatic()
+    {
+        Fixture fixture;
+        const CascadeCamera camera = MakeCamera(0.0f, { 0.0f, 2.0f, -5.0f });
+        for (int i = 0; i < 3; ++i)
+            fixture.Frame(camera);
+
+        ShadowCacheConfig config;
+        config.roundRobinPeriod = 1;
+        fixture.scheduler.SetConfig(config);
+        fixture.basis = CascadeShadows::MakeLightBasis({ 0.31f, -1.0f, 0.4f });
+        fixture.Frame(camera);
+
+        bool all = true;
+        for (const ShadowCascadeUpdate& update : fixture.updates)
+            all &= update.update && update.renderStatic;
+        CHECK(all);
+
+        config.cacheStatic = false;
+        fixture.scheduler.SetConfig(config);
+        fixture.Frame(camera);
+        all = true;
+        for (const ShadowCascadeUpdate& update : fixture.updates)
+            all &= update.renderStatic;
+        CHECK(all);
+    }
+}
+
+int main()
+{
+    RUN_TEST(FirstFrameRendersEverything);
+    RUN_TEST(StillCameraAlternatesFarCascades);
+    RUN_TEST(MovingSeveralTexelsInvalidates);
+    RUN_TEST(InvalidatedCascadesRedrawOnceOnTheirTurn);
+    RUN_TEST(LightChangeAndDisabledCacheRedrawStatic);
+    return TEST_RESULT();
+}
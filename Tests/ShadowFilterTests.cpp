@@ -0,0 +1,148 @@
+#include "Check.h"
+#include "ShadowFilter.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const uint32_t MAP_SIZE = 64;
+    const float RECEIVER = 0.5f;
+
+    // Occluders at 0.3 over a diagonal half plane and a small square, receivers at 0.5
+    std::vector<float> MakeShadowMap()
+    {
+        std::vector<float> depth(MAP_SIZE * MAP_SIZE);
+        for (uint32_t y = 0; y < MAP_SIZE; ++y)
+        {
+            for (uint32_t x = 0; x < MAP_SIZE; ++x)
+            {
+                bool occluded = x + y < MAP_SIZE || (x > 40 && x < 44 && y > 40 && y < 44);
+                depth[y * MAP_SIZE + x] = occluded ? 0.3f : 1.0f;
+            }
+        }
+        return depth;
+    }
+
+    // K x K bilinear taps one texel apart: what GatherPcf must equal
+    float BoxOfBilinear(const ShadowMapSlice& slice, float u, float v, float depth, int kernelSize)
+    {
+        float sum = 0.0f;
+        int half = (kernelSize - 1) / 2;
+        for (int j = -half; j <= half; ++j)
+        {
+            for (int i = -half; i <= half; ++i)
+                sum += ShadowFilter::SampleCmp(slice, u + i / (float)slice.size, v + j / (float)slice.size, depth);
+        }
+        return sum / (kernelSize * kernelSize);
+    }
+
+    void KernelSizing()
+    {
+        CHECK(ShadowFilter::GetKernelSize(0.0f) == 1);
+        CHECK(ShadowFilter::GetKernelSize(1.0f) == 3);
+        CHECK(ShadowFilter::GetKernelSize(2.4f) == 5);
+        CHECK(ShadowFilter::GetKernelSize(9.0f) == ShadowFilter::MAX_KERNEL_SIZE);
+
+        CHECK(ShadowFilter::GetGatherCount(1) == 1);
+        CHECK(ShadowFilter::GetGatherCount(3) == 4);
+        CHECK(ShadowFilter::GetGatherCount(5) == 9);
+        CHECK(ShadowFilter::GetGatherCount(7) == 16);
+
+        // Fine cascades hit the radius cap, coarse ones shrink to keep the world-space penumbra
+        ShadowFilterSettings settings;
+        CHECK(ShadowFilter::GetFilterRadius(0.001f, settings) == settings.maxRadius);
+        CHECK_NEAR(ShadowFilter::GetFilterRadius(0.03f, settings), 1.0f, 1e-5f);
+    }
+
+    void GatherMatchesBilinearBox()
+    {
+        std::vector<float> depth = MakeShadowMap();
+        ShadowMapSlice slice{ depth.data(), MAP_SIZE };
+
+        float maxError = 0.0f;
+        for (uint32_t kernelSize = 1; kernelSize <= ShadowFilter::MAX_KERNEL_SIZE; kernelSize += 2)
+        {
+            for (int i = 0; i < 2000; ++i)
+            {
+                float u = i * 0.6180339f - floorf(i * 0.6180339f);
+                float v = i * 0.7548776f - floorf(i * 0.7548776f);
+                float gather = ShadowFilter::GatherPcf(slice, u, v, RECEIVER, kernelSize, false, nullptr);
+                maxError = fmaxf(maxError, fabsf(gather - BoxOfBilinear(slice, u, v, RECEIVER, (int)kernelSize)));
+            }
+        }
+        CHECK(maxError < 1e-4f);
+    }
+
+    // The corner taps settle fully lit and fully shadowed pixels exactly;
+    // only the penumbra pays for the whole kernel
+    void EarlyOutIsExact()
+    {
+        std::vector<float> depth = MakeShadowMap();
+        ShadowMapSlice slice{ depth.data(), MAP_SIZE };
+
+        ShadowFilterStats umbra;
+        CHECK(ShadowFilter::GatherPcf(slice, 0.1f, 0.1f, RECEIVER, 7, true, &umbra) == 0.0f);
+        CHECK(umbra.fetches == ShadowFilter::EARLY_OUT_TAPS);
+
+        ShadowFilterStats lit;
+        CHECK(ShadowFilter::GatherPcf(slice, 0.95f, 0.4f, RECEIVER, 7, true, &lit) == 1.0f);
+        CHECK(lit.fetches == ShadowFilter::EARLY_OUT_TAPS && lit.earlyOuts == 1);
+
+        ShadowFilterStats penumbra;
+        float shadow = ShadowFilter::GatherPcf(slice, 0.5f, 0.5f, RECEIVER, 7, true, &penumbra);
+        CHECK(shadow > 0.0f && shadow < 1.0f);
+        CHECK(penumbra.fetches == ShadowFilter::EARLY_OUT_TAPS + 16 && penumbra.earlyOuts == 0);
+        CHECK_NEAR(shadow, ShadowFilter::GatherPcf(slice, 0.5f, 0.5f, RECEIVER, 7, false, nullptr), 1e-6f);
+
+        // For 3x3 the corners are the whole kernel
+        ShadowFilterStats small;
+        ShadowFilter::GatherPcf(slice, 0.1f, 0.1f, RECEIVER, 3, true, &small);
+        CHECK(small.fetches == 4 && small.earlyOuts == 0);
+
+        ShadowFilterStats poissonUmbra, poissonPenumbra;
+        CHECK(ShadowFilter::Poisson(slice, 0.1f, 0.1f, RECEIVER, 3.0f, true, &poissonUmbra) == 0.0f);
+        CHECK(poissonUmbra.fetches == ShadowFilter::EARLY_OUT_TAPS);
+        ShadowFilter::Poisson(slice, 0.5f, 0.5f, RECEIVER, 3.0f, true, &poissonPenumbra);
+        CHECK(poissonPenumbra.fetches == ShadowFilter::POISSON_TAPS);
+    }
+
+    void EarlyOutSavesFetchesOverAFrame()
+    {
+        std::vector<float> depth = MakeShadowMap();
+        ShadowMapSlice slice{ depth.data(), MAP_SIZE };
+
+        ShadowFilterStats full, early;
+        for (uint32_t y = 0; y < 256; ++y)
+        {
+            for (uint32_t x = 0; x < 256; ++x)
+            {
+                float u = (x + 0.5f) / 256.0f, v = (y + 0.5f) / 256.0f;
+                ShadowFilter::GatherPcf(slice, u, v, RECEIVER, 7, false, &full);
+                ShadowFilter::GatherPcf(slice, u, v, RECEIVER, 7, true, &early);
+            }
+        }
+        CHECK(full.GetFetchesPerEvaluation() == 16.0);
+        CHECK(early.GetFetchesPerEvaluation() < 10.0);
+        CHECK(early.earlyOuts > early.evaluations / 2);
+    }
+
+    void CascadeBlendBand()
+    {
+        CHECK(ShadowFilter::GetCascadeBlend(5.0f, 0.0f, 10.0f, 0.1f) == 0.0f);
+        CHECK_NEAR(ShadowFilter::GetCascadeBlend(9.5f, 0.0f, 10.0f, 0.1f), 0.5f, 1e-5f);
+        CHECK(ShadowFilter::GetCascadeBlend(9.5f, 0.0f, 10.0f, 0.0f) == 0.0f);
+    }
+}
+
+int main()
+{
+    RUN_TEST(KernelSizing);
+    RUN_TEST(GatherMatchesBilinearBox);
+    RUN_TEST(EarlyOutIsExact);
+    RUN_TEST(EarlyOutSavesFetchesOverAFrame);
+    RUN_TEST(CascadeBlendBand);
+    return TEST_RESULT();
+}
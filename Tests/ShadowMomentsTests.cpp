@@ -0,0 +1,126 @@
+#include "Check.h"
+#include "ShadowMoments.h"
+
+#include <cmath>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // What filtering a texel footprint does: a blend of the moments under it
+    EvsmMoments Mix(const EvsmMoments& a, const EvsmMoments& b, float t)
+    {
+        EvsmMoments m;
+        m.positive = a.positive * (1.0f - t) + b.positive * t;
+        m.positiveSq = a.positiveSq * (1.0f - t) + b.positiveSq * t;
+        m.negative = a.negative * (1.0f - t) + b.negative * t;
+        m.negativeSq = a.negativeSq * (1.0f - t) + b.negativeSq * t;
+        return m;
+    }
+
+    EvsmSettings NoBleedingReduction()
+    {
+        EvsmSettings settings;
+        settings.lightBleedingReduction = 0.0f;
+        return settings;
+    }
+
+    void WarpUsesBothRanges()
+    {
+        EvsmSettings settings = NoBleedingReduction();
+        float positive, negative;
+
+        // Depth 0.5 lands on 0, so both warps are +-1
+        ShadowMoments::WarpDepth(0.5f, settings, positive, negative);
+        CHECK_NEAR(positive, 1.0f, 1e-6f);
+        CHECK_NEAR(negative, -1.0f, 1e-6f);
+
+        ShadowMoments::WarpDepth(1.0f, settings, positive, negative);
+        CHECK_NEAR(positive, expf(40.0f), expf(40.0f) * 1e-5f);
+        CHECK_NEAR(negative, -expf(-5.0f), 1e-6f);
+
+        // Clamped exponent keeps the squared moment finite
+        settings.positiveExponent = 100.0f;
+        CHECK(std::isfinite(ShadowMoments::ComputeMoments(1.0f, settings).positiveSq));
+    }
+
+    void ChebyshevAndBleedingReduction()
+    {
+        // Mean 0, variance 1, two deviations out: 1 / (1 + 4)
+        CHECK_NEAR(ShadowMoments::ChebyshevUpperBound(0.0f, 1.0f, 2.0f, 0.0f), 0.2f, 1e-6f);
+        CHECK(ShadowMoments::ChebyshevUpperBound(0.0f, 1.0f, -1.0f, 0.0f) == 1.0f);
+        CHECK_NEAR(ShadowMoments::ChebyshevUpperBound(1.0f, 1.0f, 2.0f, 0.25f), 0.2f, 1e-6f);
+
+        CHECK_NEAR(ShadowMoments::ReduceLightBleeding(0.2f, 0.2f), 0.0f, 1e-6f);
+        CHECK_NEAR(ShadowMoments::ReduceLightBleeding(0.6f, 0.2f), 0.5f, 1e-6f);
+        CHECK(ShadowMoments::ReduceLightBleeding(1.0f, 0.3f) == 1.0f);
+    }
+
+    void UnfilteredIsAHardShadow()
+    {
+        EvsmSettings settings = NoBleedingReduction();
+        EvsmMoments occluder = ShadowMoments::ComputeMoments(0.4f, settings);
+        CHECK(ShadowMoments::ComputeShadow(occluder, 0.4f, settings) == 1.0f);
+        CHECK(ShadowMoments::ComputeShadow(occluder, 0.3f, settings) == 1.0f);
+        CHECK(ShadowMoments::ComputeShadow(occluder, 0.6f, settings) < 1e-3f);
+    }
+
+    // Chebyshev is an upper bound: filtered edges never come out darker than
+    // the fraction of the footprint that is actually lit
+    void FilteredEdgesBoundTheCoverage()
+    {
+        EvsmSettings settings = NoBleedingReduction();
+        EvsmMoments nearSurface = ShadowMoments::ComputeMoments(0.3f, settings);
+        EvsmMoments farSurface = ShadowMoments::ComputeMoments(0.7f, settings);
+
+        EvsmMoments half = Mix(nearSurface, farSurface, 0.5f);
+        float shadow = ShadowMoments::ComputeShadow(half, 0.7f, settings);
+        CHECK(shadow > 0.45f && shadow <= 0.5f + 1e-4f);
+        CHECK(ShadowMoments::ComputeShadow(half, 0.3f, settings) == 1.0f);
+
+        float quarter = ShadowMoments::ComputeShadow(Mix(nearSurface, farSurface, 0.75f), 0.7f, settings);
+        CHECK(quarter >= 0.75f - 1e-3f && quarter <= 1.0f);
+    }
+
+    void BleedingReductionDarkensLeaks()
+    {
+        // Two stacked occluders leak into the shadow of the front one
+        EvsmSettings settings = NoBleedingReduction();
+        EvsmMoments layered = Mix(ShadowMoments::ComputeMoments(0.2f, settings), ShadowMoments::ComputeMoments(0.5f, settings), 0.5f);
+        float leak = ShadowMoments::ComputeShadow(layered, 0.8f, settings);
+
+        EvsmSettings reduced = settings;
+        reduced.lightBleedingReduction = 0.3f;
+        CHECK(ShadowMoments::ComputeShadow(layered, 0.8f, reduced) <= leak);
+    }
+
+    void BlurWeightsAreNormalized()
+    {
+        for (uint32_t radius = 0; radius <= ShadowMoments::MAX_BLUR_RADIUS; ++radius)
+        {
+            float weights[ShadowMoments::MAX_BLUR_RADIUS + 1];
+            ShadowMoments::ComputeBlurWeights(radius, weights);
+
+            float total = weights[0];
+            bool decreasing = true;
+            for (uint32_t i = 1; i <= radius; ++i)
+            {
+                total += 2.0f * weights[i];
+                decreasing &= weights[i] < weights[i - 1];
+            }
+            CHECK(decreasing);
+            CHECK_NEAR(total, 1.0f, 1e-5f);
+        }
+    }
+}
+
+int main()
+{
+    RUN_TEST(WarpUsesBothRanges);
+    RUN_TEST(ChebyshevAndBleedingReduction);
+    RUN_TEST(UnfilteredIsAHardShadow);
+    RUN_TEST(FilteredEdgesBoundTheCoverage);
+    RUN_TEST(BleedingReductionDarkensLeaks);
+    RUN_TEST(BlurWeightsAreNormalized);
+    return TEST_RESULT();
+}
@@ -0,0 +1,163 @@
+#include "Check.h"
+#include "StateCache.h"
+
+#include <cstring>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Three bytes of padding after a, like most D3D descriptors have somewhere
+    struct Desc
+    {
+        uint8_t a;
+        uint32_t b;
+        float c;
+    };
+
+    struct DescTraits
+    {
+        static void Write(BinaryWriter& writer, const Desc& desc)
+        {
+            writer.WriteValue(desc.a);
+            writer.WriteValue(desc.b);
+            writer.WriteValue(desc.c);
+        }
+    };
+
+    // Every key lands in the same bucket
+    struct CollidingHasher
+    {
+        uint64_t operator()(const std::vector<uint8_t>&) const { return 42; }
+    };
+
+    Desc MakeDesc(uint8_t a, uint32_t b, float c, uint8_t fill = 0)
+    {
+        Desc desc;
+        memset(&desc, fill, sizeof(desc));
+        desc.a = a;
+        desc.b = b;
+        desc.c = c;
+        return desc;
+    }
+
+    // The object is the descriptor's b, and b == 999 fails to create
+    struct Creator
+    {
+        uint32_t creates = 0;
+
+        bool operator()(const Desc& desc, int& outObject)
+        {
+            creates++;
+            outObject = (int)desc.b;
+            return desc.b != 999;
+        }
+    };
+
+    void EqualDescriptorsShareOneObject()
+    {
+        StateCache<Desc, int, DescTraits> cache;
+        Creator create;
+
+        // Same fields, different padding bytes
+        const auto* first = cache.GetOrCreate(MakeDesc(1, 2, 3.0f, 0xAB), create);
+        const auto* second = cache.GetOrCreate(MakeDesc(1, 2, 3.0f, 0x00), create);
+        CHECK(first != nullptr && first == second);
+        CHECK(first != nullptr && first->id == 0 && first->object == 2);
+        CHECK(create.creates == 1);
+        CHECK(cache.GetStats().hits == 1);
+
+        const auto* other = cache.GetOrCreate(MakeDesc(1, 2, 4.0f), create);
+        CHECK(other != nullptr && other != first && other->id == 1);
+        CHECK(create.creates == 2);
+        CHECK(cache.Get(1) == other);
+        CHECK(cache.Get(2) == nullptr);
+    }
+
+    void FailedCreateIsNotCached()
+    {
+        StateCache<Desc, int, DescTraits> cache;
+        Creator create;
+
+        CHECK(cache.GetOrCreate(MakeDesc(1, 999, 0.0f), create) == nullptr);
+        CHECK(cache.GetOrCreate(MakeDesc(1, 999, 0.0f), create) == nullptr);
+        CHECK(create.creates == 2);
+        CHECK(cache.GetStats().failed == 2);
+        CHECK(cache.GetCount() == 0);
+
+        // The failed key left no empty bucket behind to count as a collision
+        CHECK(cache.GetOrCreate(MakeDesc(1, 1, 0.0f), create) != nullptr);
+        CHECK(cache.GetStats().collisions == 0);
+    }
+
+    void CollisionsFallBackToTheFullKey()
+    {
+        StateCache<Desc, int, DescTraits, CollidingHasher> cache;
+        Creator create;
+
+        for (uint32_t i = 0; i < 100; ++i)
+            cache.GetOrCreate(MakeDesc(1, i % 10, 3.0f), create);
+
+        CHECK(cache.GetCount() == 10);
+        CHECK(create.creates == 10);
+        CHECK(cache.GetStats().hits == 90);
+        CHECK(cache.GetStats().collisions == 9);
+
+        bool allFound = true;
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            const auto* entry = cache.GetOrCreate(MakeDesc(1, i, 3.0f), create);
+            allFound &= entry != nullptr && entry->object == (int)i;
+        }
+        CHECK(allFound);
+    }
+
+    void RealHasherKeepsKeysApart()
+    {
+        StateCache<Desc, int, DescTraits> cache;
+        for (uint32_t i = 0; i < 20000; ++i)
+            cache.GetOrCreate(MakeDesc((uint8_t)(i & 7), i, 3.0f), [](const Desc&, int&) { return true; });
+
+        CHECK(cache.GetCount() == 20000);
+        CHECK(cache.GetStats().collisions == 0);
+
+        cache.Clear();
+        CHECK(cache.GetCount() == 0);
+        CHECK(cache.Get(0) == nullptr);
+    }
+
+    void PipelinesGetDenseIds()
+    {
+        StateCache<PipelineKey, int, PipelineKeyTraits> pipelines;
+        auto create = [](const PipelineKey&, int&) { return true; };
+        int programA = 0, programB = 0;
+
+        PipelineKey opaque;
+        opaque.program = &programA;
+        PipelineKey depthOnly = opaque;
+        depthOnly.depthOnly = true;
+        PipelineKey otherProgram = opaque;
+        otherProgram.program = &programB;
+        PipelineKey blended = opaque;
+        blended.blend = 1;
+
+        const auto* p0 = pipelines.GetOrCreate(opaque, create);
+        const auto* p1 = pipelines.GetOrCreate(depthOnly, create);
+        const auto* p2 = pipelines.GetOrCreate(otherProgram, create);
+        const auto* p3 = pipelines.GetOrCreate(blended, create);
+        CHECK(p0->id == 0 && p1->id == 1 && p2->id == 2 && p3->id == 3);
+        CHECK(p0->hash != p1->hash);
+        CHECK(pipelines.GetOrCreate(opaque, create) == p0);
+    }
+}
+
+int main()
+{
+    RUN_TEST(EqualDescriptorsShareOneObject);
+    RUN_TEST(FailedCreateIsNotCached);
+    RUN_TEST(CollisionsFallBackToTheFullKey);
+    RUN_TEST(RealHasherKeepsKeysApart);
+    RUN_TEST(PipelinesGetDenseIds);
+    return TEST_RESULT();
+}
@@ -0,0 +1,207 @@
+#include "BlockCompression.h"
+#include "JobSystem.h"
+#include "TextureMips.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+// Cooker pipeline on synthetic images, no files involved: mip generation with
+// both filters, then every block format encoded on the job system, with the
+// encode throughput, the PSNR of the top level and the VRAM of the chain.
+//
+//   TextureCookerBenchmark [size] [iterations]
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    uint32_t Hash(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // Smooth gradients, hard edges and a bit of grain with a soft alpha mask,
+    // roughly what an albedo map throws at the encoder
+    TextureMipLevel MakeAlbedo(uint32_t size)
+    {
+        TextureMipLevel level;
+        level.width = size;
+        level.height = size;
+        level.pixels.resize((size_t)size * size * 4);
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                float u = x / (float)size;
+                float v = y / (float)size;
+                bool tile = ((x / 64) + (y / 64)) & 1;
+                int grain = (int)(Hash(y * size + x) & 15) - 8;
+
+                uint8_t* p = &level.pixels[((size_t)y * size + x) * 4];
+                p[0] = (uint8_t)std::clamp((int)(255.0f * u) + grain, 0, 255);
+                p[1] = (uint8_t)std::clamp((int)(tile ? 200.0f : 60.0f * v) + grain, 0, 255);
+                p[2] = (uint8_t)std::clamp((int)(128.0f + 100.0f * sinf(u * 20.0f) * cosf(v * 13.0f)) + grain, 0, 255);
+                p[3] = (uint8_t)(255.0f * (0.5f + 0.5f * sinf((u + v) * 6.0f)));
+            }
+        }
+        return level;
+    }
+
+    // Tangent-space normals of a bumpy height field, xy in rg. A fine second
+    // octave and hashed grain keep 4x4 blocks from being exactly representable,
+    // so BC4/BC5 report a real PSNR instead of infinity.
+    TextureMipLevel MakeNormalMap(uint32_t size)
+    {
+        TextureMipLevel level;
+        level.width = size;
+        level.height = size;
+        level.pixels.resize((size_t)size * size * 4);
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                float u = x / (float)size * 40.0f;
+                float v = y / (float)size * 40.0f;
+                float grainX = ((Hash(y * size + x) & 255) / 255.0f - 0.5f) * 0.06f;
+                float grainY = ((Hash(~(y * size + x)) & 255) / 255.0f - 0.5f) * 0.06f;
+                float nx = -0.4f * cosf(u) * cosf(v) - 0.1f * cosf(x * 0.9f) * cosf(y * 0.7f) + grainX;
+                float ny = 0.4f * sinf(u) * sinf(v) + 0.1f * sinf(x * 0.9f) * sinf(y * 0.7f) + grainY;
+                float nz = sqrtf(std::max(0.0f, 1.0f - nx * nx - ny * ny));
+
+                uint8_t* p = &level.pixels[((size_t)y * size + x) * 4];
+                p[0] = (uint8_t)((nx * 0.5f + 0.5f) * 255.0f + 0.5f);
+                p[1] = (uint8_t)((ny * 0.5f + 0.5f) * 255.0f + 0.5f);
+                p[2] = (uint8_t)((nz * 0.5f + 0.5f) * 255.0f + 0.5f);
+                p[3] = 255;
+            }
+        }
+        return level;
+    }
+
+    // Over the channels the format stores, alpha included when it has any
+    double ComputePsnr(BlockFormat format, const TextureMipLevel& a, const TextureMipLevel& b)
+    {
+        bool alpha = format == BlockFormat::BC3 || format == BlockFormat::BC7;
+        int channels = format == BlockFormat::BC4 ? 1 : format == BlockFormat::BC5 ? 2 : 3;
+
+        double sum = 0.0;
+        size_t samples = 0;
+        for (size_t i = 0; i < (size_t)a.width * a.height; ++i)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                if (c < channels || (c == 3 && alpha))
+                {
+                    double d = (double)a.pixels[i * 4 + c] - b.pixels[i * 4 + c];
+                    sum += d * d;
+                    ++samples;
+                }
+            }
+        }
+
+        double mse = sum / samples;
+        return mse <= 0.0 ? INFINITY : 10.0 * log10(255.0 * 255.0 / mse);
+    }
+
+    void BenchmarkMips(const char* label, const TextureMipLevel& source, const MipOptions& options,
+        uint32_t iterations, DecodedTexture& outChain)
+    {
+        Clock::time_point start = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            outChain = DecodedTexture{};
+            TextureMips::Generate(TextureMipLevel(source), outChain, options);
+        }
+        double ms = MillisecondsSince(start) / iterations;
+
+        printf("mips %-22s %8.2f ms  %7.1f Mtexel/s\n", label, ms,
+            (double)source.width * source.height / (ms * 1000.0));
+    }
+
+    void BenchmarkEncode(BlockFormat format, const DecodedTexture& chain, uint32_t iterations)
+    {
+        std::vector<std::vector<uint8_t>> levels(chain.mips.size());
+        size_t texels = 0, rawBytes = 0, blockBytes = 0;
+
+        Clock::time_point start = Clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            texels = rawBytes = blockBytes = 0;
+            for (size_t m = 0; m < chain.mips.size(); ++m)
+            {
+                BlockCompression::EncodeSurface(format, chain.mips[m], levels[m]);
+                texels += (size_t)chain.mips[m].width * chain.mips[m].height;
+                rawBytes += chain.mips[m].pixels.size();
+                blockBytes += levels[m].size();
+            }
+        }
+        double ms = MillisecondsSince(start) / iterations;
+
+        TextureMipLevel decoded;
+        const TextureMipLevel& top = chain.mips[0];
+        BlockCompression::DecodeSurface(format, levels[0].data(), top.width, top.height, decoded);
+
+        const double MB = 1024.0 * 1024.0;
+        printf("%-4s %9.2f ms  %7.2f Mtexel/s  %6.2f dB  %6.2f MB -> %5.2f MB (%.1fx)\n",
+            BlockCompression::GetName(format), ms, texels / (ms * 1000.0), ComputePsnr(format, top, decoded),
+            rawBytes / MB, blockBytes / MB, (double)rawBytes / blockBytes);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t size = argc > 1 ? (uint32_t)atoi(argv[1]) : 1024;
+    uint32_t iterations = argc > 2 ? (uint32_t)atoi(argv[2]) : 3;
+    if (size < 4 || iterations == 0)
+    {
+        printf("usage: TextureCookerBenchmark [size] [iterations]\n");
+        return 1;
+    }
+
+    JobSystem::Initialize();
+    printf("%ux%u synthetic images, %u workers\n", size, size, std::max(1u, JobSystem::GetWorkerCount()));
+
+    TextureMipLevel albedo = MakeAlbedo(size);
+    TextureMipLevel normals = MakeNormalMap(size);
+
+    MipOptions box;
+    box.filter = MipFilter::Box;
+    MipOptions kaiser;
+    MipOptions linear;
+    linear.srgb = false;
+
+    DecodedTexture albedoChain, normalChain;
+    BenchmarkMips("box, gamma-correct", albedo, box, iterations, albedoChain);
+    BenchmarkMips("kaiser, gamma-correct", albedo, kaiser, iterations, albedoChain);
+    BenchmarkMips("kaiser, linear", normals, linear, iterations, normalChain);
+
+    printf("\nalbedo (encode time, throughput, PSNR of mip 0, chain RGBA8 -> blocks)\n");
+    BenchmarkEncode(BlockFormat::BC1, albedoChain, iterations);
+    BenchmarkEncode(BlockFormat::BC3, albedoChain, iterations);
+    BenchmarkEncode(BlockFormat::BC7, albedoChain, iterations);
+
+    printf("\nnormal map\n");
+    BenchmarkEncode(BlockFormat::BC4, normalChain, iterations);
+    BenchmarkEncode(BlockFormat::BC5, normalChain, iterations);
+
+    JobSystem::Shutdown();
+    return 0;
+}
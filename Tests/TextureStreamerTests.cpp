@@ -0,0 +1,347 @@
+#include "AssetCache.h"
+#include "Check.h"
+#include "TextureStreamer.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+using namespace Engine::Core;
+using namespace Engine::Graphics;
+
+namespace
+{
+    // "<size>.png" decodes to a size x size gradient, anything else fails.
+    // From memory, the bytes hold the size as text.
+    class FakeDecoder : public ITextureDecoder
+    {
+    public:
+        std::atomic<uint32_t> decodes{ 0 };
+        std::atomic<uint32_t> memoryDecodes{ 0 };
+
+        bool Decode(const std::filesystem::path& path, TextureMipLevel& outLevel) override
+        {
+            decodes++;
+            return MakeGradient((uint32_t)atoi(path.stem().string().c_str()), outLevel);
+        }
+
+        bool Decode(const std::vector<uint8_t>& bytes, const std::filesystem::path&, TextureMipLevel& outLevel) override
+        {
+            memoryDecodes++;
+            return MakeGradient((uint32_t)atoi(std::string(bytes.begin(), bytes.end()).c_str()), outLevel);
+        }
+
+    private:
+        static bool MakeGradient(uint32_t size, TextureMipLevel& outLevel)
+        {
+            if (size == 0)
+                return false;
+
+            outLevel.width = size;
+            outLevel.height = size;
+            outLevel.pixels.resize((size_t)size * size * 4);
+            for (size_t i = 0; i < outLevel.pixels.size(); ++i)
+                outLevel.pixels[i] = (uint8_t)(i * 7);
+            return true;
+        }
+    };
+
+    // Tracks what each handle holds and checks the upload contract: a level
+    // without pixels must have been resident, at the same size, before
+    class FakeBackend : public ITextureUploadBackend
+    {
+    public:
+        struct Texture
+        {
+            std::vector<uint32_t> widths;
+        };
+
+        std::unordered_map<TextureHandle, Texture> textures;
+        uint32_t uploads = 0;
+        uint32_t contractViolations = 0;
+        bool failUploads = false;
+
+        bool Upload(TextureHandle handle, const TextureMipLevel* mips, uint32_t mipCount) override
+        {
+            if (failUploads)
+                return false;
+
+            Texture& previous = textures[handle];
+            Texture next;
+            for (uint32_t i = 0; i < mipCount; ++i)
+            {
+                if (mips[i].pixels.empty())
+                {
+                    bool wasResident = false;
+                    for (uint32_t width : previous.widths)
+                        wasResident |= width == mips[i].width;
+                    contractViolations += wasResident ? 0 : 1;
+                }
+                else if (mips[i].pixels.size() != (size_t)mips[i].width * mips[i].height * 4)
+                {
+                    contractViolations++;
+                }
+                next.widths.push_back(mips[i].width);
+            }
+            previous = next;
+            uploads++;
+            return true;
+        }
+
+        void Evict(TextureHandle handle) override { textures.erase(handle); }
+    };
+
+    size_t ChainBytesFrom(uint32_t size, uint32_t firstMip)
+    {
+        size_t bytes = 0;
+        for (uint32_t s = size >> firstMip; ; s >>= 1)
+        {
+            bytes += (size_t)s * s * 4;
+            if (s == 1)
+                break;
+        }
+        return bytes;
+    }
+
+    void LowMipFirstThenStreamIn()
+    {
+        FakeDecoder decoder;
+        FakeBackend backend;
+        TextureStreamer streamer(&decoder, &backend);
+        streamer.SetLowMipSize(64);
+
+        TextureHandle handle = streamer.Request("256.png");
+        CHECK(streamer.Request("256.png") == handle);
+        streamer.WaitForDecodes();
+        streamer.Update();
+
+        CHECK(streamer.GetState(handle) == TextureState::Resident);
+        CHECK(streamer.GetMipCount(handle) == 9);
+        CHECK(streamer.GetResidentMip(handle) == 2);        // 64x64
+        CHECK(streamer.GetStats().residentBytes == ChainBytesFrom(256, 2));
+
+        // Nothing asked for detail: the CPU keeps only the low tail
+        CHECK(streamer.GetStats().decodedBytes == ChainBytesFrom(256, 2));
+
+        streamer.RequestMip(handle, 0);
+        streamer.Update();
+        CHECK(streamer.GetStats().pageIns == 1);            // the detail was dropped
+        streamer.WaitForDecodes();
+        streamer.RequestMip(handle, 0);
+        streamer.Update();
+
+        CHECK(streamer.GetResidentMip(handle) == 0);
+        CHECK(streamer.GetStats().residentBytes == ChainBytesFrom(256, 0));
+        CHECK(streamer.GetStats().decodedBytes == ChainBytesFrom(256, 2));
+        CHECK(decoder.decodes.load() == 2);
+        CHECK(backend.contractViolations == 0);
+    }
+
+    void WantedDetailStreamsWithoutPageIn()
+    {
+        FakeDecoder decoder;
+        FakeBackend backend;
+        TextureStreamer streamer(&decoder, &backend);
+        streamer.SetLowMipSize(64);
+        streamer.SetUploadLimit(ChainBytesFrom(256, 1));
+
+        // Feedback before the decode lands keeps the detail it asks for on the CPU
+        TextureHandle handle = streamer.Request("256.png");
+        streamer.WaitForDecodes();
+        streamer.RequestMip(handle, 0);
+        streamer.Update();
+        CHECK(streamer.GetResidentMip(handle) == 1);        // one level per frame under the limit
+
+        streamer.RequestMip(handle, 0);
+        streamer.Update();
+        CHECK(streamer.GetResidentMip(handle) == 0);
+        CHECK(streamer.GetStats().pageIns == 0);
+        CHECK(decoder.decodes.load() == 1);
+        CHECK(backend.contractViolations == 0);
+    }
+
+    void BudgetHoldsWhenAdmittingDecodes()
+    {
+        FakeDecoder decoder;
+        FakeBackend backend;
+        TextureStreamer streamer(&decoder, &backend);
+        streamer.SetLowMipSize(32);
+        const size_t budget = ChainBytesFrom(128, 0) + ChainBytesFrom(128, 2) / 2;
+        streamer.SetBudget(budget);
+
+        TextureHandle a = streamer.Request("128.png");
+        streamer.WaitForDecodes();
+        streamer.RequestMip(a, 0);
+        streamer.Update();
+        CHECK(streamer.GetResidentMip(a) == 0);
+
+        // B's low tail does not fit while A is in use: it waits, decoded
+        TextureHandle b = streamer.Request("b/128.png");
+        streamer.WaitForDecodes();
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            streamer.RequestMip(a, 0);
+            streamer.Update();
+            CHECK(streamer.GetState(b) == TextureState::Decoded);
+            CHECK(streamer.GetStats().pendingUploads == 1);
+            CHECK(streamer.GetStats().residentBytes <= budget);
+        }
+
+        // Once A goes unused it gives up detail and B gets in
+        for (int frame = 0; frame < 3; ++frame)
+            streamer.Update();
+        CHECK(streamer.GetState(b) == TextureState::Resident);
+        CHECK(streamer.GetResidentMip(a) > 0);
+        CHECK(streamer.GetStats().residentBytes <= budget);
+        CHECK(backend.contractViolations == 0);
+    }
+
+    void EvictedDetailPagesBackIn()
+    {
+        JobSystem::Initialize(2);
+        {
+            FakeDecoder decoder;
+            FakeBackend backend;
+            TextureStreamer streamer(&decoder, &backend);
+            streamer.SetLowMipSize(16);
+
+            TextureHandle handle = streamer.Request("128.png");
+            streamer.WaitForDecodes();
+            streamer.RequestMip(handle, 0);
+            streamer.Update();
+            CHECK(streamer.GetResidentMip(handle) == 0);
+
+            // Unused and over a shrunk budget: trimmed to the low tail, one
+            // level at a time, each upload copying the rest from the GPU
+            streamer.Update();
+            streamer.Update();
+            streamer.SetBudget(ChainBytesFrom(128, 3));
+            streamer.Update();
+            CHECK(streamer.GetResidentMip(handle) == 3);
+            CHECK(backend.contractViolations == 0);
+
+            streamer.SetBudget(64ull * 1024 * 1024);
+            uint32_t frames = 0;
+            while (streamer.GetResidentMip(handle) != 0 && frames++ < 100)
+            {
+                streamer.RequestMip(handle, 0);
+                streamer.Update();
+                streamer.WaitForDecodes();
+            }
+            CHECK(streamer.GetResidentMip(handle) == 0);
+            CHECK(decoder.decodes.load() == 2);
+            CHECK(backend.contractViolations == 0);
+        }
+        JobSystem::Shutdown();
+    }
+
+    void ReplaceSwapsTheChain()
+    {
+        FakeDecoder decoder;
+        FakeBackend backend;
+        TextureStreamer streamer(&decoder, &backend);
+        streamer.SetLowMipSize(32);
+
+        TextureHandle handle = streamer.Request("64.png");
+        streamer.WaitForDecodes();
+        streamer.Update();
+        CHECK(streamer.GetResidentMip(handle) == 1);
+
+        DecodedTexture replacement;
+        CHECK(streamer.DecodeSource("64.png", replacement));
+        CHECK(streamer.Replace(handle, std::move(replacement)));
+        CHECK(streamer.GetResidentMip(handle) == 1);
+        CHECK(backend.contractViolations == 0);
+
+        // A failed upload keeps the old chain and GPU copy
+        backend.failUploads = true;
+        DecodedTexture again;
+        CHECK(streamer.DecodeSource("64.png", again));
+        CHECK(!streamer.Replace(handle, std::move(again)));
+        CHECK(streamer.GetResidentMip(handle) == 1);
+        CHECK(streamer.GetMipCount(handle) == 7);
+    }
+
+    void FailedDecode()
+    {
+        FakeDecoder decoder;
+        FakeBackend backend;
+        TextureStreamer streamer(&decoder, &backend);
+
+        TextureHandle handle = streamer.Request("missing.png");
+        streamer.WaitForDecodes();
+        streamer.Update();
+        CHECK(streamer.GetState(handle) == TextureState::Failed);
+        CHECK(streamer.GetResidentMip(handle) == UINT32_MAX);
+        CHECK(streamer.GetStats().decodedBytes == 0);
+    }
+
+    // With the cache on, the source is read once: the key and the decode see the same bytes
+    void CachedDecodeUsesTheHashedBytes()
+    {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / "TextureStreamerTests";
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        std::filesystem::create_directories(dir);
+        AssetCache::Initialize(dir / "Cache");
+
+        auto writeSource = [&dir](const char* text)
+        {
+            std::ofstream file(dir / "albedo.png", std::ios::binary | std::ios::trunc);
+            file << text;
+        };
+
+        FakeDecoder decoder;
+        FakeBackend backend;
+        TextureStreamer streamer(&decoder, &backend);
+
+        writeSource("32");
+        DecodedTexture texture;
+        CHECK(streamer.DecodeSource(dir / "albedo.png", texture));
+        CHECK(texture.mips.size() == 6 && texture.mips[0].width == 32);
+        CHECK(decoder.memoryDecodes.load() == 1 && decoder.decodes.load() == 0);
+
+        // Same bytes: a hit, no decode
+        DecodedTexture cached;
+        CHECK(streamer.DecodeSource(dir / "albedo.png", cached));
+        CHECK(cached.mips.size() == 6 && decoder.memoryDecodes.load() == 1);
+
+        writeSource("16");
+        DecodedTexture edited;
+        CHECK(streamer.DecodeSource(dir / "albedo.png", edited));
+        CHECK(edited.mips[0].width == 16 && decoder.memoryDecodes.load() == 2);
+
+        // A missing source fails before the decoder is asked
+        DecodedTexture missing;
+        CHECK(!streamer.DecodeSource(dir / "missing.png", missing));
+        CHECK(decoder.memoryDecodes.load() == 2 && decoder.decodes.load() == 0);
+
+        AssetCache::Shutdown();
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    void DesiredMipFromTexelDensity()
+    {
+        const float fov = 3.14159265f / 3.0f;
+        CHECK(TextureStreamer::ComputeDesiredMip(1024, 1.0f, 1.0f, fov, 1080.0f) == 0);
+        uint32_t near = TextureStreamer::ComputeDesiredMip(1024, 1.0f, 10.0f, fov, 1080.0f);
+        uint32_t far = TextureStreamer::ComputeDesiredMip(1024, 1.0f, 100.0f, fov, 1080.0f);
+        CHECK(near < far);
+        CHECK(TextureStreamer::ComputeDesiredMip(1024, 1.0f, 1.0e6f, fov, 1080.0f) == 31);
+    }
+}
+
+int main()
+{
+    RUN_TEST(LowMipFirstThenStreamIn);
+    RUN_TEST(WantedDetailStreamsWithoutPageIn);
+    RUN_TEST(BudgetHoldsWhenAdmittingDecodes);
+    RUN_TEST(EvictedDetailPagesBackIn);
+    RUN_TEST(ReplaceSwapsTheChain);
+    RUN_TEST(FailedDecode);
+    RUN_TEST(CachedDecodeUsesTheHashedBytes);
+    RUN_TEST(DesiredMipFromTexelDensity);
+    return TEST_RESULT();
+}
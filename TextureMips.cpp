@@ -0,0 +1,268 @@
+#include "TextureMips.h"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    const uint32_t TO_SRGB_TABLE_SIZE = 16384;
+
+    struct GammaTables
+    {
+        float toLinear[256];
+        uint8_t toSrgb[TO_SRGB_TABLE_SIZE];
+        uint8_t toUnorm[TO_SRGB_TABLE_SIZE];
+
+        GammaTables()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                float c = i / 255.0f;
+                toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            }
+
+            for (uint32_t i = 0; i < TO_SRGB_TABLE_SIZE; ++i)
+            {
+                float l = i / (float)(TO_SRGB_TABLE_SIZE - 1);
+                float s = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+                toSrgb[i] = (uint8_t)(s * 255.0f + 0.5f);
+                toUnorm[i] = (uint8_t)(l * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    const GammaTables& GetGammaTables()
+    {
+        static const GammaTables tables;
+        return tables;
+    }
+
+    // Wrapped so the vector element type keeps the vector's alignment attribute
+    struct Texel
+    {
+        __m128 v;
+    };
+
+    // One float4 (RGBA) per texel
+    struct FloatImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<Texel> texels;
+
+        const __m128& At(uint32_t x, uint32_t y) const { return texels[(size_t)y * width + x].v; }
+    };
+
+    void ToFloat(const TextureMipLevel& src, bool srgb, FloatImage& out)
+    {
+        const GammaTables& g = GetGammaTables();
+
+        out.width = src.width;
+        out.height = src.height;
+        out.texels.resize((size_t)src.width * src.height);
+
+        const uint8_t* p = src.pixels.data();
+        for (size_t i = 0; i < out.texels.size(); ++i, p += 4)
+        {
+            if (srgb)
+                out.texels[i].v = _mm_setr_ps(g.toLinear[p[0]], g.toLinear[p[1]], g.toLinear[p[2]], p[3] / 255.0f);
+            else
+                out.texels[i].v = _mm_setr_ps(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f);
+        }
+    }
+
+    void ToRgba8(const FloatImage& src, bool srgb, TextureMipLevel& out)
+    {
+        const GammaTables& g = GetGammaTables();
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps((float)(TO_SRGB_TABLE_SIZE - 1));
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        out.width = src.width;
+        out.height = src.height;
+        out.pixels.resize((size_t)src.width * src.height * 4);
+
+        uint8_t* p = out.pixels.data();
+        for (size_t i = 0; i < src.texels.size(); ++i, p += 4)
+        {
+            // Sharp filters overshoot, clamp before the table lookup
+            __m128 v = _mm_min_ps(_mm_max_ps(src.texels[i].v, zero), one);
+            __m128i idx = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+
+            alignas(16) int32_t k[4];
+            _mm_store_si128((__m128i*)k, idx);
+
+            const uint8_t* colorTable = srgb ? g.toSrgb : g.toUnorm;
+            p[0] = colorTable[k[0]];
+            p[1] = colorTable[k[1]];
+            p[2] = colorTable[k[2]];
+            p[3] = g.toUnorm[k[3]];
+        }
+    }
+
+    void DownsampleBox(const FloatImage& src, FloatImage& dst)
+    {
+        dst.width = std::max(1u, src.width / 2);
+        dst.height = std::max(1u, src.height / 2);
+        dst.texels.resize((size_t)dst.width * dst.height);
+
+        const __m128 quarter = _mm_set1_ps(0.25f);
+
+        for (uint32_t y = 0; y < dst.height; ++y)
+        {
+            uint32_t y0 = std::min(y * 2, src.height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+
+            for (uint32_t x = 0; x < dst.width; ++x)
+            {
+                uint32_t x0 = std::min(x * 2, src.width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+
+                __m128 sum = _mm_add_ps(_mm_add_ps(src.At(x0, y0), src.At(x1, y0)),
+                    _mm_add_ps(src.At(x0, y1), src.At(x1, y1)));
+                dst.texels[(size_t)y * dst.width + x].v = _mm_mul_ps(sum, quarter);
+            }
+        }
+    }
+
+    // -----------------------------
+    // Kaiser-windowed sinc, 8 taps for a 2:1 reduction
+    // -----------------------------
+    const int KAISER_TAPS = 8;
+
+    double BesselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    const float* GetKaiserWeights()
+    {
+        static float weights[KAISER_TAPS];
+        static bool initialized = [] {
+            const double alpha = 4.0;
+            const double radius = KAISER_TAPS / 2.0;
+            const double pi = 3.14159265358979323846;
+            double total = 0.0;
+
+            for (int i = 0; i < KAISER_TAPS; ++i)
+            {
+                // Source texel centers relative to the destination texel center
+                double t = (i - KAISER_TAPS / 2) + 0.5;
+                double s = t / 2.0;
+                double sinc = fabs(s) < 1e-9 ? 1.0 : sin(pi * s) / (pi * s);
+                double r = t / radius;
+                double window = BesselI0(alpha * sqrt(std::max(0.0, 1.0 - r * r))) / BesselI0(alpha);
+                weights[i] = (float)(sinc * window);
+                total += weights[i];
+            }
+            for (int i = 0; i < KAISER_TAPS; ++i)
+                weights[i] = (float)(weights[i] / total);
+            return true;
+        }();
+        (void)initialized;
+        return weights;
+    }
+
+    void DownsampleKaiser(const FloatImage& src, FloatImage& dst)
+    {
+        // The fixed 2:1 kernel needs at least two texels on an axis
+        if (src.width < 2 || src.height < 2)
+        {
+            DownsampleBox(src, dst);
+            return;
+        }
+
+        const float* w = GetKaiserWeights();
+        __m128 weights[KAISER_TAPS];
+        for (int i = 0; i < KAISER_TAPS; ++i)
+            weights[i] = _mm_set1_ps(w[i]);
+
+        dst.width = src.width / 2;
+        dst.height = src.height / 2;
+        dst.texels.resize((size_t)dst.width * dst.height);
+
+        // Horizontal pass into a half-width temporary, then vertical, edges clamped
+        FloatImage tmp;
+        tmp.width = dst.width;
+        tmp.height = src.height;
+        tmp.texels.resize((size_t)tmp.width * tmp.height);
+
+        for (uint32_t y = 0; y < src.height; ++y)
+        {
+            for (uint32_t x = 0; x < dst.width; ++x)
+            {
+                __m128 sum = _mm_setzero_ps();
+                int base = (int)(x * 2) - KAISER_TAPS / 2 + 1;
+                for (int i = 0; i < KAISER_TAPS; ++i)
+                {
+                    int sx = std::clamp(base + i, 0, (int)src.width - 1);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(src.At((uint32_t)sx, y), weights[i]));
+                }
+                tmp.texels[(size_t)y * tmp.width + x].v = sum;
+            }
+        }
+
+        for (uint32_t y = 0; y < dst.height; ++y)
+        {
+            int base = (int)(y * 2) - KAISER_TAPS / 2 + 1;
+            for (uint32_t x = 0; x < dst.width; ++x)
+            {
+                __m128 sum = _mm_setzero_ps();
+                for (int i = 0; i < KAISER_TAPS; ++i)
+                {
+                    int sy = std::clamp(base + i, 0, (int)src.height - 1);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(tmp.At(x, (uint32_t)sy), weights[i]));
+                }
+                dst.texels[(size_t)y * dst.width + x].v = sum;
+            }
+        }
+    }
+}
+
+uint32_t TextureMips::GetMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+    while (width > 1 || height > 1)
+    {
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        ++count;
+    }
+    return count;
+}
+
+void TextureMips::Generate(TextureMipLevel&& top, DecodedTexture& out, const MipOptions& options)
+{
+    out.mips.clear();
+    out.mips.reserve(GetMipCount(top.width, top.height));
+
+    FloatImage current;
+    ToFloat(top, options.srgb, current);
+    out.mips.push_back(std::move(top));
+
+    while (current.width > 1 || current.height > 1)
+    {
+        FloatImage next;
+        if (options.filter == MipFilter::Kaiser)
+            DownsampleKaiser(current, next);
+        else
+            DownsampleBox(current, next);
+
+        TextureMipLevel level;
+        ToRgba8(next, options.srgb, level);
+        out.mips.push_back(std::move(level));
+
+        current = std::move(next);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "TextureStreamer.h"
+
+namespace Engine::Graphics
+{
+    enum class MipFilter
+    {
+        Box,        // 2x2 average
+        Kaiser      // 8-tap windowed sinc, sharper minification
+    };
+
+    struct MipOptions
+    {
+        MipFilter filter = MipFilter::Kaiser;
+        bool srgb = true;   // color is sRGB encoded: filter in linear space (alpha is always linear)
+    };
+
+    // Builds a full mip chain from an RGBA8 image. Each level is filtered from
+    // the previous level at float precision, so rounding does not accumulate.
+    class TextureMips
+    {
+    public:
+        static void Generate(TextureMipLevel&& top, DecodedTexture& out, const MipOptions& options = MipOptions());
+
+        static uint32_t GetMipCount(uint32_t width, uint32_t height);
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,581 @@
+#include "TextureStreamer.h"
+#include "TextureMips.h"
+#include "AssetCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+using namespace Engine::Graphics;
+using namespace Engine::Core;
+
+namespace
+{
+    // Bump when decoding or mip generation changes, stale cache entries then miss
+    const uint32_t TEXTURE_CACHE_VERSION = 1;
+
+    bool ReadSource(const std::filesystem::path& path, std::vector<uint8_t>& outBytes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        outBytes.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    uint64_t ComputeCacheKey(const std::vector<uint8_t>& bytes, const MipOptions& options)
+    {
+        return ContentHash()
+            .Append("texture")
+            .AppendValue(TEXTURE_CACHE_VERSION)
+            .AppendValue(options.filter)
+            .AppendValue(options.srgb)
+            .Append(bytes)
+            .Get();
+    }
+
+    void StoreMipChain(uint64_t key, const DecodedTexture& texture)
+    {
+        BinaryWriter writer;
+        writer.WriteValue((uint32_t)texture.mips.size());
+        for (const TextureMipLevel& level : texture.mips)
+        {
+            writer.WriteValue(level.width);
+            writer.WriteValue(level.height);
+            writer.WriteVector(level.pixels);
+        }
+        AssetCache::Store(key, writer.GetData().data(), writer.GetData().size());
+    }
+
+    bool LoadMipChain(uint64_t key, DecodedTexture& texture)
+    {
+        std::vector<uint8_t> data;
+        if (!AssetCache::Load(key, data))
+            return false;
+
+        BinaryReader reader(data);
+        uint32_t count = 0;
+        if (!reader.ReadValue(count) || count == 0)
+            return false;
+
+        texture.mips.resize(count);
+        for (TextureMipLevel& level : texture.mips)
+        {
+            if (!reader.ReadValue(level.width) || !reader.ReadValue(level.height) || !reader.ReadVector(level.pixels) ||
+                level.pixels.size() != (size_t)level.width * level.height * 4)
+            {
+                texture.mips.clear();
+                return false;
+            }
+        }
+        return reader.IsAtEnd();
+    }
+}
+
+TextureStreamer::TextureStreamer(ITextureDecoder* decoder, ITextureUploadBackend* backend)
+    : m_decoder(decoder)
+    , m_backend(backend)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // Decode jobs write into entries, they must finish before the entries go away
+    WaitForDecodes();
+
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        if (m_entries[i]->residentMip != UINT32_MAX)
+            m_backend->Evict((TextureHandle)i);
+    }
+}
+
+TextureHandle TextureStreamer::Request(const std::filesystem::path& path)
+{
+    auto it = m_lookup.find(path.wstring());
+    if (it != m_lookup.end())
+        return it->second;
+
+    TextureHandle handle = (TextureHandle)m_entries.size();
+    m_entries.push_back(std::make_unique<Entry>());
+    m_lookup[path.wstring()] = handle;
+
+    Entry* entry = m_entries.back().get();
+    entry->path = path;
+
+    JobSystem::Execute(m_decodeJobs, [this, entry]()
+        {
+            bool ok = DecodeSource(entry->path, entry->decoded);
+            entry->state.store(ok ? TextureState::Decoded : TextureState::Failed, std::memory_order_release);
+        });
+
+    return handle;
+}
+
+bool TextureStreamer::DecodeSource(const std::filesystem::path& path, DecodedTexture& outTexture) const
+{
+    // Cheap gamma-correct box at runtime, cooked textures get the Kaiser filter
+    MipOptions options;
+    options.filter = MipFilter::Box;
+
+    // Without the cache the decoder reads the file itself
+    TextureMipLevel top;
+    if (!AssetCache::IsEnabled())
+    {
+        if (!m_decoder->Decode(path, top) || top.width == 0 || top.height == 0)
+            return false;
+
+        TextureMips::Generate(std::move(top), outTexture, options);
+        return true;
+    }
+
+    // Read once: the key is hashed from these bytes and a miss decodes them,
+    // so a save landing in between cannot be stored under the old key.
+    // A warm cache skips both the decode and the mip generation.
+    std::vector<uint8_t> bytes;
+    if (!ReadSource(path, bytes))
+        return false;
+
+    uint64_t cacheKey = ComputeCacheKey(bytes, options);
+    if (LoadMipChain(cacheKey, outTexture))
+        return true;
+
+    if (!m_decoder->Decode(bytes, path, top) || top.width == 0 || top.height == 0)
+        return false;
+
+    TextureMips::Generate(std::move(top), outTexture, options);
+    StoreMipChain(cacheKey, outTexture);
+    return true;
+}
+
+bool TextureStreamer::Replace(TextureHandle handle, DecodedTexture&& texture)
+{
+    if (handle >= m_entries.size() || texture.mips.empty())
+        return false;
+
+    // The first decode job still owns the chain, or a page-in is decoding the old source
+    Entry& entry = *m_entries[handle];
+    if (entry.state.load(std::memory_order_acquire) == TextureState::Loading ||
+        entry.pageState.load(std::memory_order_acquire) == PAGE_LOADING)
+        return false;
+
+    // Detail paged in from the old source does not belong to the new chain
+    entry.paged = DecodedTexture{};
+    entry.pageState.store(PAGE_IDLE, std::memory_order_relaxed);
+
+    // Nothing on the GPU yet: the next Update uploads it like a fresh decode
+    if (entry.residentMip == UINT32_MAX)
+    {
+        entry.decoded = std::move(texture);
+        entry.state.store(TextureState::Decoded, std::memory_order_release);
+        return true;
+    }
+
+    // Same detail as before (the new chain may be shorter), uploaded in one go.
+    // The backend keeps the old texture if the upload fails, so does the entry.
+    DecodedTexture previous = std::move(entry.decoded);
+    uint32_t previousMip = entry.residentMip;
+    size_t previousBytes = entry.residentBytes;
+
+    entry.decoded = std::move(texture);
+    uint32_t firstMip = std::min(previousMip, (uint32_t)entry.decoded.mips.size() - 1);
+
+    m_stats.residentBytes -= previousBytes;
+    entry.residentMip = UINT32_MAX;
+    entry.residentBytes = 0;
+    if (MakeResident(handle, firstMip))
+    {
+        entry.state.store(TextureState::Resident, std::memory_order_release);
+        return true;
+    }
+
+    entry.decoded = std::move(previous);
+    entry.residentMip = previousMip;
+    entry.residentBytes = previousBytes;
+    m_stats.residentBytes += previousBytes;
+    return false;
+}
+
+const std::filesystem::path& TextureStreamer::GetPath(TextureHandle handle) const
+{
+    static const std::filesystem::path empty;
+    return handle < m_entries.size() ? m_entries[handle]->path : empty;
+}
+
+void TextureStreamer::RequestMip(TextureHandle handle, uint32_t mip)
+{
+    if (handle >= m_entries.size())
+        return;
+
+    Entry& entry = *m_entries[handle];
+    entry.desiredMip = std::min(entry.desiredMip, mip);
+    entry.lastUsedFrame = m_frame;
+}
+
+void TextureStreamer::WaitForDecodes()
+{
+    JobSystem::Wait(m_decodeJobs);
+}
+
+uint32_t TextureStreamer::ComputeDesiredMip(uint32_t textureSize, float objectRadius, float distance,
+    float fovY, float viewportHeight)
+{
+    if (textureSize == 0 || objectRadius <= 0.0f)
+        return 0;
+
+    // Projected diameter of the object in pixels
+    float d = std::max(distance, objectRadius * 0.5f);
+    float pixels = (2.0f * objectRadius) / (2.0f * d * tanf(fovY * 0.5f)) * viewportHeight;
+    if (pixels <= 1.0f)
+        return 31;
+
+    float texelsPerPixel = (float)textureSize / pixels;
+    if (texelsPerPixel <= 1.0f)
+        return 0;
+
+    return (uint32_t)floorf(log2f(texelsPerPixel));
+}
+
+uint32_t TextureStreamer::GetLowMip(const Entry& entry) const
+{
+    // First level that is no bigger than the low-res floor
+    uint32_t count = (uint32_t)entry.decoded.mips.size();
+    for (uint32_t m = 0; m < count; ++m)
+    {
+        const TextureMipLevel& level = entry.decoded.mips[m];
+        if (level.width <= m_lowMipSize && level.height <= m_lowMipSize)
+            return m;
+    }
+    return count - 1;
+}
+
+size_t TextureStreamer::ChainBytes(const Entry& entry, uint32_t firstMip)
+{
+    // From the sizes: dropped levels have no pixels but still count when resident
+    size_t bytes = 0;
+    for (size_t m = firstMip; m < entry.decoded.mips.size(); ++m)
+        bytes += (size_t)entry.decoded.mips[m].width * entry.decoded.mips[m].height * 4;
+    return bytes;
+}
+
+bool TextureStreamer::HasPixels(const Entry& entry, uint32_t firstMip, uint32_t endMip)
+{
+    endMip = std::min(endMip, (uint32_t)entry.decoded.mips.size());
+    for (uint32_t m = firstMip; m < endMip; ++m)
+    {
+        if (entry.decoded.mips[m].pixels.empty())
+            return false;
+    }
+    return true;
+}
+
+bool TextureStreamer::MakeResident(TextureHandle handle, uint32_t firstMip)
+{
+    Entry& entry = *m_entries[handle];
+    uint32_t count = (uint32_t)entry.decoded.mips.size() - firstMip;
+
+    if (!m_backend->Upload(handle, &entry.decoded.mips[firstMip], count))
+        return false;
+
+    size_t newBytes = ChainBytes(entry, firstMip);
+
+    // Only the levels that were not resident before had to be transferred
+    if (entry.residentMip == UINT32_MAX || firstMip < entry.residentMip)
+    {
+        size_t uploaded = newBytes - entry.residentBytes;
+        m_stats.uploadedBytes += uploaded;
+        m_stats.totalUploadedBytes += uploaded;
+        m_stats.uploads++;
+    }
+    else
+    {
+        m_stats.evictedBytes += entry.residentBytes - newBytes;
+        m_stats.evictions++;
+    }
+
+    m_stats.residentBytes = m_stats.residentBytes - entry.residentBytes + newBytes;
+    entry.residentBytes = newBytes;
+    entry.residentMip = firstMip;
+
+    // Resident detail lives on the GPU now, the next upload copies it from there
+    uint32_t lowMip = GetLowMip(entry);
+    for (uint32_t m = firstMip; m < lowMip; ++m)
+        std::vector<uint8_t>().swap(entry.decoded.mips[m].pixels);
+    return true;
+}
+
+bool TextureStreamer::EvictFor(size_t bytesNeeded, TextureHandle exclude)
+{
+    if (m_stats.residentBytes + bytesNeeded <= m_budgetBytes)
+        return true;
+
+    // Least recently used first; textures drawn last frame are left alone
+    std::vector<TextureHandle> candidates;
+    for (TextureHandle h = 0; h < (TextureHandle)m_entries.size(); ++h)
+    {
+        const Entry& e = *m_entries[h];
+        if (h != exclude && e.residentMip != UINT32_MAX && e.residentMip < GetLowMip(e) &&
+            e.lastUsedFrame + 1 < m_frame)
+        {
+            candidates.push_back(h);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](TextureHandle a, TextureHandle b)
+        {
+            return m_entries[a]->lastUsedFrame < m_entries[b]->lastUsedFrame;
+        });
+
+    for (TextureHandle h : candidates)
+    {
+        Entry& e = *m_entries[h];
+        uint32_t lowMip = GetLowMip(e);
+
+        // Drop one level at a time so a texture keeps as much detail as the budget allows
+        while (e.residentMip < lowMip && m_stats.residentBytes + bytesNeeded > m_budgetBytes)
+        {
+            if (!MakeResident(h, e.residentMip + 1))
+                break;
+        }
+
+        if (m_stats.residentBytes + bytesNeeded <= m_budgetBytes)
+            return true;
+    }
+
+    return m_stats.residentBytes + bytesNeeded <= m_budgetBytes;
+}
+
+void TextureStreamer::RequestPageIn(Entry& entry)
+{
+    // Main thread only; the job owns paged until it publishes the state
+    if (entry.pageState.load(std::memory_order_acquire) != PAGE_IDLE)
+        return;
+
+    entry.pageState.store(PAGE_LOADING, std::memory_order_relaxed);
+    m_stats.pageIns++;
+
+    Entry* e = &entry;
+    JobSystem::Execute(m_decodeJobs, [this, e]()
+        {
+            bool ok = DecodeSource(e->path, e->paged);
+            e->pageState.store(ok ? PAGE_READY : PAGE_FAILED, std::memory_order_release);
+        });
+}
+
+void TextureStreamer::FinishPageIn(Entry& entry)
+{
+    // Only levels that are missing and still the same size: the source may
+    // have changed on disk, hot reload swaps that in through Replace
+    DecodedTexture& decoded = entry.decoded;
+    if (entry.paged.mips.size() == decoded.mips.size())
+    {
+        uint32_t endMip = std::min(entry.residentMip, (uint32_t)decoded.mips.size());
+        for (uint32_t m = 0; m < endMip; ++m)
+        {
+            TextureMipLevel& level = decoded.mips[m];
+            TextureMipLevel& paged = entry.paged.mips[m];
+            if (level.pixels.empty() && paged.width == level.width && paged.height == level.height)
+                level.pixels = std::move(paged.pixels);
+        }
+    }
+
+    entry.paged = DecodedTexture{};
+    entry.pageState.store(PAGE_IDLE, std::memory_order_relaxed);
+}
+
+void TextureStreamer::DropDetail(Entry& entry)
+{
+    if (entry.decoded.mips.empty())
+        return;
+
+    // Keep the low-res tail and the levels still waiting for upload
+    uint32_t lowMip = GetLowMip(entry);
+    for (uint32_t m = 0; m < lowMip; ++m)
+    {
+        bool pending = m >= entry.desiredMip && m < entry.residentMip;
+        if (!pending)
+            std::vector<uint8_t>().swap(entry.decoded.mips[m].pixels);
+    }
+}
+
+void TextureStreamer::Update()
+{
+    m_stats.uploadedBytes = 0;
+    m_stats.evictedBytes = 0;
+    m_stats.uploads = 0;
+    m_stats.evictions = 0;
+    m_stats.pendingDecodes = 0;
+    m_stats.pendingUploads = 0;
+    m_stats.pageIns = 0;
+    m_stats.decodedBytes = 0;
+
+    // -----------------------------
+    // Newly decoded: low mips first
+    // -----------------------------
+    for (TextureHandle h = 0; h < (TextureHandle)m_entries.size(); ++h)
+    {
+        Entry& e = *m_entries[h];
+        TextureState state = e.state.load(std::memory_order_acquire);
+
+        if (state == TextureState::Loading)
+        {
+            m_stats.pendingDecodes++;
+            continue;
+        }
+
+        if (e.pageState.load(std::memory_order_acquire) == PAGE_READY)
+            FinishPageIn(e);
+
+        if (state != TextureState::Decoded)
+            continue;
+
+        // Over budget even after eviction: stays decoded, retried next frame
+        uint32_t lowMip = GetLowMip(e);
+        if (!EvictFor(ChainBytes(e, lowMip), h))
+        {
+            m_stats.pendingUploads++;
+            continue;
+        }
+
+        if (MakeResident(h, lowMip))
+            e.state.store(TextureState::Resident, std::memory_order_relaxed);
+        else
+            e.state.store(TextureState::Failed, std::memory_order_relaxed);
+    }
+
+    // -----------------------------
+    // Stream in detail, largest deficit first
+    // -----------------------------
+    std::vector<TextureHandle> wants;
+    for (TextureHandle h = 0; h < (TextureHandle)m_entries.size(); ++h)
+    {
+        const Entry& e = *m_entries[h];
+        if (e.state.load(std::memory_order_relaxed) == TextureState::Resident &&
+            e.desiredMip < e.residentMip)
+        {
+            wants.push_back(h);
+        }
+    }
+
+    std::sort(wants.begin(), wants.end(), [this](TextureHandle a, TextureHandle b)
+        {
+            const Entry& ea = *m_entries[a];
+            const Entry& eb = *m_entries[b];
+            return (ea.residentMip - ea.desiredMip) > (eb.residentMip - eb.desiredMip);
+        });
+
+    for (TextureHandle h : wants)
+    {
+        Entry& e = *m_entries[h];
+
+        // Jump straight to the desired level if the per-frame upload limit allows,
+        // otherwise refine one level per frame
+        uint32_t target = e.desiredMip;
+        size_t extra = ChainBytes(e, target) - e.residentBytes;
+        if (m_stats.uploadedBytes + extra > m_uploadLimitBytes)
+        {
+            target = e.residentMip - 1;
+            extra = ChainBytes(e, target) - e.residentBytes;
+            if (m_stats.uploadedBytes > 0 && m_stats.uploadedBytes + extra > m_uploadLimitBytes)
+                continue;
+        }
+
+        // Detail dropped earlier is decoded again first, uploaded in a later frame
+        if (!HasPixels(e, target, e.residentMip))
+        {
+            RequestPageIn(e);
+            continue;
+        }
+
+        if (!EvictFor(extra, h))
+            continue;
+
+        MakeResident(h, target);
+    }
+
+    // Anything still over budget (e.g. after SetBudget) gets trimmed
+    EvictFor(0, INVALID_TEXTURE_HANDLE);
+
+    // -----------------------------
+    // Drop CPU detail nothing waits for, reset feedback for the next frame
+    // -----------------------------
+    for (auto& e : m_entries)
+    {
+        if (e->state.load(std::memory_order_relaxed) != TextureState::Loading)
+        {
+            DropDetail(*e);
+            for (const TextureMipLevel& level : e->decoded.mips)
+                m_stats.decodedBytes += level.pixels.size();
+        }
+        e->desiredMip = UINT32_MAX;
+    }
+
+    ++m_frame;
+}
+
+TextureState TextureStreamer::GetState(TextureHandle handle) const
+{
+    if (handle >= m_entries.size())
+        return TextureState::Failed;
+    return m_entries[handle]->state.load(std::memory_order_acquire);
+}
+
+uint32_t TextureStreamer::GetResidentMip(TextureHandle handle) const
+{
+    return handle < m_entries.size() ? m_entries[handle]->residentMip : UINT32_MAX;
+}
+
+uint32_t TextureStreamer::GetMipCount(TextureHandle handle) const
+{
+    if (GetState(handle) != TextureState::Resident)
+        return 0;
+    return (uint32_t)m_entries[handle]->decoded.mips.size();
+}
+
+uint32_t TextureStreamer::GetWidth(TextureHandle handle) const
+{
+    if (GetState(handle) != TextureState::Resident)
+        return 0;
+    return m_entries[handle]->decoded.mips[0].width;
+}
+
+uint32_t TextureStreamer::GetHeight(TextureHandle handle) const
+{
+    if (GetState(handle) != TextureState::Resident)
+        return 0;
+    return m_entries[handle]->decoded.mips[0].height;
+}
+
+// -----------------------------
+// StreamedTextureReloadable
+// -----------------------------
+StreamedTextureReloadable::StreamedTextureReloadable(TextureStreamer* streamer, TextureHandle handle)
+    : m_streamer(streamer)
+    , m_handle(handle)
+    , m_path(streamer->GetPath(handle))
+    , m_name(m_path.string())
+{
+}
+
+bool StreamedTextureReloadable::Build(std::string& outErrors)
+{
+    m_staged = DecodedTexture{};
+    if (!m_streamer->DecodeSource(m_path, m_staged))
+    {
+        outErrors += "cannot decode " + m_name + "\n";
+        return false;
+    }
+    return true;
+}
+
+bool StreamedTextureReloadable::Commit(std::string& outErrors)
+{
+    if (!m_streamer->Replace(m_handle, std::move(m_staged)))
+    {
+        outErrors += m_name + " is still loading or failed to upload\n";
+        return false;
+    }
+    return true;
+}
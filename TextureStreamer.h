@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.h"
+#include "HotReload.h"
+
+namespace Engine::Graphics
+{
+    using TextureHandle = uint32_t;
+    static const TextureHandle INVALID_TEXTURE_HANDLE = 0xFFFFFFFF;
+
+    // One RGBA8 level, rows tightly packed
+    struct TextureMipLevel
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    // Full chain, mips[0] is the full resolution image. In a streamer entry
+    // only the levels waiting for upload and the low-res tail keep their
+    // pixels; the rest have width and height only.
+    struct DecodedTexture
+    {
+        std::vector<TextureMipLevel> mips;
+    };
+
+    // Decodes a source file into RGBA8. Called on worker threads.
+    class ITextureDecoder
+    {
+    public:
+        virtual ~ITextureDecoder() = default;
+        virtual bool Decode(const std::filesystem::path& path, TextureMipLevel& outLevel) = 0;
+
+        // Same, from the file's bytes already in memory (the ones the asset
+        // cache key was hashed from). path is only for messages.
+        virtual bool Decode(const std::vector<uint8_t>& bytes, const std::filesystem::path& path,
+            TextureMipLevel& outLevel) = 0;
+    };
+
+    // GPU side of the streamer. Called on the thread that runs TextureStreamer::Update.
+    class ITextureUploadBackend
+    {
+    public:
+        virtual ~ITextureUploadBackend() = default;
+
+        // Replace the GPU copy of handle with a texture holding exactly these levels
+        // (mips[0] is the most detailed resident level). A level without pixels
+        // was resident before: it is copied over from the current GPU copy.
+        virtual bool Upload(TextureHandle handle, const TextureMipLevel* mips, uint32_t mipCount) = 0;
+        virtual void Evict(TextureHandle handle) = 0;
+    };
+
+    enum class TextureState : uint32_t
+    {
+        Loading,
+        Decoded,
+        Resident,
+        Failed
+    };
+
+    struct TextureStreamerStats
+    {
+        size_t residentBytes = 0;
+        size_t uploadedBytes = 0;        // this frame
+        size_t evictedBytes = 0;         // this frame
+        size_t totalUploadedBytes = 0;
+        uint32_t uploads = 0;            // this frame
+        uint32_t evictions = 0;          // this frame
+        uint32_t pendingDecodes = 0;
+        uint32_t pendingUploads = 0;     // decoded, waiting for room in the budget
+        uint32_t pageIns = 0;            // this frame: detail decoded again after it was dropped
+        size_t decodedBytes = 0;         // CPU copies held, after this frame's drops
+    };
+
+    // Async texture pipeline: decode and mip generation run on the job system,
+    // the smallest mips are uploaded first and detail is streamed in from
+    // per-frame usage feedback. Resident memory is kept under a budget by
+    // dropping the top mips of the least recently used textures.
+    //
+    // The CPU keeps only the low-res tail of each chain. Detail levels are
+    // dropped once uploaded or no longer wanted, and decoded again (a cache
+    // read when the asset cache is warm) when the feedback asks for them.
+    class TextureStreamer
+    {
+    public:
+        TextureStreamer(ITextureDecoder* decoder, ITextureUploadBackend* backend);
+        ~TextureStreamer();
+
+        // Starts decoding on a worker. Requesting the same path twice returns the same handle.
+        TextureHandle Request(const std::filesystem::path& path);
+
+        // Usage feedback for the current frame: the most detailed mip a draw needs.
+        void RequestMip(TextureHandle handle, uint32_t mip);
+
+        // Main thread, once per frame: first uploads, stream-in and eviction.
+        void Update();
+
+        // Blocks until all outstanding decodes have finished.
+        void WaitForDecodes();
+
+        // Decode + mip chain through the asset cache, as the streamer does it.
+        // Thread safe, used by the decode jobs and by hot reload.
+        bool DecodeSource(const std::filesystem::path& path, DecodedTexture& outTexture) const;
+
+        // Main thread: swap in a new chain for handle (e.g. the source changed
+        // on disk) and re-upload the levels that were resident. Returns false,
+        // keeping the old chain and GPU copy, if the texture is still loading
+        // or paging in, or the upload fails.
+        bool Replace(TextureHandle handle, DecodedTexture&& texture);
+
+        void SetBudget(size_t bytes) { m_budgetBytes = bytes; }
+        void SetUploadLimit(size_t bytesPerFrame) { m_uploadLimitBytes = bytesPerFrame; }
+        void SetLowMipSize(uint32_t size) { m_lowMipSize = size; }
+
+        TextureState GetState(TextureHandle handle) const;
+        uint32_t GetResidentMip(TextureHandle handle) const;   // UINT32_MAX when nothing is resident
+        uint32_t GetMipCount(TextureHandle handle) const;
+        uint32_t GetWidth(TextureHandle handle) const;
+        uint32_t GetHeight(TextureHandle handle) const;
+        const std::filesystem::path& GetPath(TextureHandle handle) const;
+        const TextureStreamerStats& GetStats() const { return m_stats; }
+
+        // Mip whose texel density roughly matches one texel per pixel for an object
+        // of the given world radius and distance (uv assumed to span the object once).
+        static uint32_t ComputeDesiredMip(uint32_t textureSize, float objectRadius, float distance,
+            float fovY, float viewportHeight);
+
+    private:
+        enum PageState : uint32_t
+        {
+            PAGE_IDLE = 0,
+            PAGE_LOADING,       // a job is decoding the chain into paged
+            PAGE_READY,
+            PAGE_FAILED         // the source no longer decodes, detail stays as it is
+        };
+
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::atomic<TextureState> state{ TextureState::Loading };
+            DecodedTexture decoded;            // written once by the decode job
+            uint32_t residentMip = UINT32_MAX; // first resident level
+            uint32_t desiredMip = UINT32_MAX;  // feedback gathered for the next Update
+            uint64_t lastUsedFrame = 0;
+            size_t residentBytes = 0;
+
+            std::atomic<uint32_t> pageState{ PAGE_IDLE };
+            DecodedTexture paged;              // written by the page-in job
+        };
+
+        ITextureDecoder* m_decoder = nullptr;
+        ITextureUploadBackend* m_backend = nullptr;
+
+        std::vector<std::unique_ptr<Entry>> m_entries;
+        std::unordered_map<std::wstring, TextureHandle> m_lookup;
+        Engine::Core::JobContext m_decodeJobs;
+
+        size_t m_budgetBytes = 256ull * 1024 * 1024;
+        size_t m_uploadLimitBytes = 16ull * 1024 * 1024;
+        uint32_t m_lowMipSize = 64;
+        uint64_t m_frame = 1;
+
+        TextureStreamerStats m_stats;
+
+        uint32_t GetLowMip(const Entry& entry) const;
+        static size_t ChainBytes(const Entry& entry, uint32_t firstMip);
+        static bool HasPixels(const Entry& entry, uint32_t firstMip, uint32_t endMip);
+        bool MakeResident(TextureHandle handle, uint32_t firstMip);
+        bool EvictFor(size_t bytesNeeded, TextureHandle exclude);
+        void RequestPageIn(Entry& entry);
+        void FinishPageIn(Entry& entry);
+        void DropDetail(Entry& entry);
+    };
+
+    // A streamed texture whose source file changed: decoded on a worker,
+    // swapped in by TextureStreamer::Replace at the commit
+    class StreamedTextureReloadable : public Engine::Core::IReloadable
+    {
+    public:
+        StreamedTextureReloadable(TextureStreamer* streamer, TextureHandle handle);
+
+        const char* GetName() const override { return m_name.c_str(); }
+        void GetDependencies(std::vector<std::filesystem::path>& outFiles) override { outFiles.push_back(m_path); }
+        bool Build(std::string& outErrors) override;
+        bool Commit(std::string& outErrors) override;
+
+    private:
+        TextureStreamer* m_streamer = nullptr;
+        TextureHandle m_handle = INVALID_TEXTURE_HANDLE;
+        std::filesystem::path m_path;
+        std::string m_name;
+        DecodedTexture m_staged;
+    };
+
+} // namespace Engine::Graphics
@@ -0,0 +1,177 @@
+#include "TextureStreamerD3D11.h"
+
+#include <wincodec.h>
+#include <algorithm>
+
+using namespace Engine::Graphics;
+
+namespace
+{
+    // Runs on job system workers, each needs COM. open creates the WIC decoder
+    // from whatever holds the image.
+    template <typename Open>
+    bool DecodeWithWic(const std::filesystem::path& path, TextureMipLevel& outLevel, Open&& open)
+    {
+        HRESULT coInit = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        bool ok = false;
+        {
+            ComPtr<IWICImagingFactory> factory;
+            ComPtr<IWICBitmapDecoder> decoder;
+            ComPtr<IWICBitmapFrameDecode> frame;
+            ComPtr<IWICFormatConverter> converter;
+            UINT width = 0;
+            UINT height = 0;
+
+            if (SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                    IID_PPV_ARGS(factory.GetAddressOf()))) &&
+                SUCCEEDED(open(factory.Get(), decoder.GetAddressOf())) &&
+                SUCCEEDED(decoder->GetFrame(0, frame.GetAddressOf())) &&
+                SUCCEEDED(frame->GetSize(&width, &height)) &&
+                SUCCEEDED(factory->CreateFormatConverter(converter.GetAddressOf())) &&
+                SUCCEEDED(converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA,
+                    WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)))
+            {
+                outLevel.width = width;
+                outLevel.height = height;
+                outLevel.pixels.resize((size_t)width * height * 4);
+
+                ok = SUCCEEDED(converter->CopyPixels(nullptr, width * 4,
+                    (UINT)outLevel.pixels.size(), outLevel.pixels.data()));
+            }
+        }
+
+        if (SUCCEEDED(coInit))
+            CoUninitialize();
+
+        if (!ok)
+        {
+            std::string msg = "Failed to decode texture: " + path.string() + "\n";
+            OutputDebugStringA(msg.c_str());
+        }
+        return ok;
+    }
+}
+
+bool WicTextureDecoder::Decode(const std::filesystem::path& path, TextureMipLevel& outLevel)
+{
+    return DecodeWithWic(path, outLevel, [&path](IWICImagingFactory* factory, IWICBitmapDecoder** outDecoder)
+        {
+            return factory->CreateDecoderFromFilename(path.wstring().c_str(), nullptr, GENERIC_READ,
+                WICDecodeMetadataCacheOnDemand, outDecoder);
+        });
+}
+
+bool WicTextureDecoder::Decode(const std::vector<uint8_t>& bytes, const std::filesystem::path& path,
+    TextureMipLevel& outLevel)
+{
+    // The stream wraps bytes without copying; the decoder is done with it before we return
+    return DecodeWithWic(path, outLevel, [&bytes](IWICImagingFactory* factory, IWICBitmapDecoder** outDecoder)
+        {
+            ComPtr<IWICStream> stream;
+            HRESULT hr = factory->CreateStream(stream.GetAddressOf());
+            if (SUCCEEDED(hr))
+                hr = stream->InitializeFromMemory(const_cast<BYTE*>(bytes.data()), (DWORD)bytes.size());
+            if (SUCCEEDED(hr))
+                hr = factory->CreateDecoderFromStream(stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, outDecoder);
+            return hr;
+        });
+}
+
+D3D11TextureUploader::D3D11TextureUploader(ID3D11Device* device, ID3D11DeviceContext* context)
+    : m_device(device)
+    , m_context(context)
+{
+}
+
+bool D3D11TextureUploader::Upload(TextureHandle handle, const TextureMipLevel* mips, uint32_t mipCount)
+{
+    if (!m_device || !m_context || !mips || mipCount == 0)
+        return false;
+
+    // Levels without pixels come from the current texture, matched by size
+    ID3D11Texture2D* previous = handle < m_textures.size() ? m_textures[handle].Get() : nullptr;
+    D3D11_TEXTURE2D_DESC previousDesc = {};
+    if (previous)
+        previous->GetDesc(&previousDesc);
+
+    std::vector<UINT> sourceLevels(mipCount, UINT32_MAX);
+    for (uint32_t i = 0; i < mipCount; ++i)
+    {
+        if (!mips[i].pixels.empty())
+            continue;
+
+        for (UINT level = 0; previous && level < previousDesc.MipLevels; ++level)
+        {
+            if ((std::max)(1u, previousDesc.Width >> level) == mips[i].width &&
+                (std::max)(1u, previousDesc.Height >> level) == mips[i].height)
+            {
+                sourceLevels[i] = level;
+                break;
+            }
+        }
+
+        if (sourceLevels[i] == UINT32_MAX)
+        {
+            OutputDebugStringA("Streamed texture level is neither on the CPU nor resident\n");
+            return false;
+        }
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = mips[0].width;
+    desc.Height = mips[0].height;
+    desc.MipLevels = mipCount;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    ComPtr<ID3D11Texture2D> texture;
+    if (FAILED(m_device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf())))
+    {
+        OutputDebugStringA("Failed to create streamed texture\n");
+        return false;
+    }
+
+    ComPtr<ID3D11ShaderResourceView> srv;
+    if (FAILED(m_device->CreateShaderResourceView(texture.Get(), nullptr, srv.GetAddressOf())))
+    {
+        OutputDebugStringA("Failed to create streamed texture SRV\n");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < mipCount; ++i)
+    {
+        if (sourceLevels[i] == UINT32_MAX)
+            m_context->UpdateSubresource(texture.Get(), i, nullptr, mips[i].pixels.data(), mips[i].width * 4, 0);
+        else
+            m_context->CopySubresourceRegion(texture.Get(), i, 0, 0, 0, previous, sourceLevels[i], nullptr);
+    }
+
+    if (handle >= m_views.size())
+    {
+        m_textures.resize(handle + 1);
+        m_views.resize(handle + 1);
+    }
+
+    // The old texture dies with its view once the context is done with it
+    m_textures[handle] = texture;
+    m_views[handle] = srv;
+    return true;
+}
+
+void D3D11TextureUploader::Evict(TextureHandle handle)
+{
+    if (handle < m_views.size())
+    {
+        m_textures[handle].Reset();
+        m_views[handle].Reset();
+    }
+}
+
+ID3D11ShaderResourceView* D3D11TextureUploader::GetShaderResourceView(TextureHandle handle) const
+{
+    return handle < m_views.size() ? m_views[handle].Get() : nullptr;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+#include "TextureStreamer.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace Engine::Graphics
+{
+    // Decodes PNG/JPEG/BMP/... through WIC into RGBA8
+    class WicTextureDecoder : public ITextureDecoder
+    {
+    public:
+        bool Decode(const std::filesystem::path& path, TextureMipLevel& outLevel) override;
+        bool Decode(const std::vector<uint8_t>& bytes, const std::filesystem::path& path,
+            TextureMipLevel& outLevel) override;
+    };
+
+    // Keeps one texture + SRV per streamed handle. A residency change creates a
+    // new texture with the resident mip range, levels the streamer no longer
+    // holds on the CPU are copied from the previous one; views are looked up
+    // every frame.
+    class D3D11TextureUploader : public ITextureUploadBackend
+    {
+    public:
+        D3D11TextureUploader(ID3D11Device* device, ID3D11DeviceContext* context);
+
+        bool Upload(TextureHandle handle, const TextureMipLevel* mips, uint32_t mipCount) override;
+        void Evict(TextureHandle handle) override;
+
+        ID3D11ShaderResourceView* GetShaderResourceView(TextureHandle handle) const;
+
+    private:
+        ComPtr<ID3D11Device> m_device;
+        ComPtr<ID3D11DeviceContext> m_context;
+        std::vector<ComPtr<ID3D11Texture2D>> m_textures;
+        std::vector<ComPtr<ID3D11ShaderResourceView>> m_views;
+    };
+
+} // namespace Engine::Graphics
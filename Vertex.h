@@ -0,0 +1,17 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+namespace Engine::Graphics
+{
+    // Layout of every mesh vertex buffer, shared by the importers and Mesh
+    struct Vertex
+    {
+		XMFLOAT3 Position;
+		XMFLOAT3 Normal;
+        XMFLOAT2 UV;
+    };
+
+} // namespace Engine::Graphics
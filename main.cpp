@@ -4,6 +4,11 @@
 #include "DeviceResources.h"
 #include "Renderer.h"
 #include "Input.h"
+#include "JobSystem.h"
+#include "AssetCache.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstdio>
 
 using namespace Engine::Core;
 
@@ -35,23 +40,56 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
             deviceResources.Resize(w, h);
         });
 
-    Engine::Graphics::Renderer renderer;
-    if (!renderer.Initialize(&deviceResources))
-    {
-        MessageBox(nullptr, L"Failed to initialize renderer", L"Error", MB_OK);
-        return -1;
-    }
+    // Before the workers start, so their tracks are named
+    Profiler::Initialize();
+    Profiler::SetThreadName("Main");
+    JobSystem::Initialize();
+
+    // Cooked shaders, textures and meshes persist here between runs
+    if (!AssetCache::Initialize(L"Cache"))
+        OutputDebugStringA("AssetCache: cache directory unavailable, running uncached\n");
 
-    renderer.SetClearColor(0.247f, 0.557f, 0.651f, 1.0f);
+    auto startupBegin = std::chrono::steady_clock::now();
 
-    while (!window.ShouldClose())
+    int exitCode = 0;
     {
-        window.ProcessEvents();
-        input.Update();
-        renderer.Render();
+        // Scoped so the renderer is gone before the subsystems below shut
+        // down: its streamer waits for decodes, its reloader and passes profile
+        Engine::Graphics::Renderer renderer;
+        if (renderer.Initialize(&deviceResources))
+        {
+            {
+                // Texture decodes are still in flight here, the renderer reports when they land
+                double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+                AssetCacheStats cacheStats = AssetCache::GetStats();
+                char msg[256];
+                sprintf_s(msg, "Startup: renderer ready in %.1f ms (%s cache: %u hits, %u misses, %u stored, %.1f MB on disk)\n",
+                    startupMs, cacheStats.misses == 0 && cacheStats.hits > 0 ? "warm" : "cold",
+                    cacheStats.hits, cacheStats.misses, cacheStats.stores, cacheStats.totalBytes / (1024.0 * 1024.0));
+                OutputDebugStringA(msg);
+            }
+
+            renderer.SetClearColor(0.247f, 0.557f, 0.651f, 1.0f);
 
-        // Sleep(1); // optional, to reduce CPU usage
+            while (!window.ShouldClose())
+            {
+                window.ProcessEvents();
+                input.Update();
+                renderer.Render();
+
+                // Sleep(1); // optional, to reduce CPU usage
+            }
+        }
+        else
+        {
+            MessageBox(nullptr, L"Failed to initialize renderer", L"Error", MB_OK);
+            exitCode = -1;
+        }
     }
 
-    return 0;
+    // Drain decode jobs first so their cache writes land
+    JobSystem::Shutdown();
+    AssetCache::Shutdown();
+    Profiler::Shutdown();
+    return exitCode;
 }